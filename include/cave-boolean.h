@@ -0,0 +1,68 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_BOOLEAN_H
+#define CAVE_BOOLEAN_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include <stddef.h>
+
+/// \file
+/// Boolean operations on polygons: union, intersection, difference and exclusive or, for combining outlines
+/// before they are triangulated, eg merging overlapping islands of a slice or cutting holes out of them.
+///
+/// Polygons are `cave_2d_Polygon`s, just as PolyTri takes them, and the result is one too, so it can go
+/// straight to `cave_polytri_triangulate_polygon()`. A point is inside a polygon when the rings around it wind
+/// counter-clockwise more often than clockwise, so counter-clockwise rings are outlines, clockwise ones are
+/// holes, outlines that overlap each other merge, and a hole outside of every outline takes nothing away.
+/// Rings may cross themselves and each other.
+///
+/// The rings of both polygons are swept together from left to right, finding where edges cross and splitting
+/// them there (Martinez, Rueda and Feito, "A new algorithm for computing Boolean operations on polygons"),
+/// which takes O((n + k) log n) time for `n` edges crossing each other `k` times. Whether points are on one
+/// side of an edge or the other is decided exactly, by robust predicates, and edges that overlap are merged
+/// rather than compared by how they happened to round. An edge that a point of the other polygon lies on, or
+/// that another edge touches or crosses, is split there, so rings that only touch or share edges combine as
+/// they should. Where edges cross is worked out in double precision from the input edges, with one rounding
+/// when the coordinates are small integers, so that crossings of three edges through one point agree.
+
+typedef enum cave_Boolean_Operation {
+    /// Inside either polygon.
+    CAVE_BOOLEAN_UNION = 0,
+    /// Inside both polygons.
+    CAVE_BOOLEAN_INTERSECTION,
+    /// Inside the subject and not the clip.
+    CAVE_BOOLEAN_DIFFERENCE,
+    /// Inside one polygon but not the other.
+    CAVE_BOOLEAN_XOR,
+} cave_Boolean_Operation;
+
+/// \brief Combines two polygons.
+///
+/// The result's outlines are wound counter-clockwise and its holes clockwise. No ring crosses itself or any
+/// other, though rings may touch at a point, and points where a ring runs straight on are left out. Points
+/// where edges crossed are rounded to the nearest float.
+///
+/// \param[out] dest - Filled in with malloc'ed `points` and `ring_offsets` of its own, which the caller frees.
+///                    Its `ring_offsets` are set even when there are no rings.
+/// \param subject - The polygon operated on.
+/// \param clip - The polygon it is combined with.
+/// \param operation - Which combination to take.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest`, `subject` or `clip` is NULL, ring offsets decrease, a coordinate is infinite
+///   or NaN, `operation` isn't one of `cave_Boolean_Operation`, or there are too many edges to index (2^29
+///   or more between the two polygons).
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails. `dest` is left empty.
+CaveError cave_polygon_boolean(cave_2d_Polygon* dest, cave_2d_Polygon const* subject, cave_2d_Polygon const* clip,
+                               cave_Boolean_Operation operation);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_BOOLEAN_H
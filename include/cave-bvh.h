@@ -0,0 +1,167 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_BVH_H
+#define CAVE_BVH_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include "cave-mesh.h"
+#include "cave-writer.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// \file
+/// A bounding volume hierarchy over a triangle mesh, for casting rays at it and finding the nearest point on it
+/// without testing every triangle.
+///
+/// Trees are built top down with the surface area heuristic, evaluated over up to 16 bins of triangle centroids
+/// per axis. The top of the tree is split on the calling thread, with the binning of large ranges spread across
+/// threads, and the ranges left over are then built into subtrees in parallel. Where the ranges are cut doesn't
+/// depend on the number of threads, so neither does the tree.
+///
+/// The binary tree that comes out is collapsed into nodes of four children each, whose boxes are stored
+/// coordinate by coordinate so that a ray or point is tested against all four at once. Nodes are laid out depth
+/// first, and the triangles are copied into the order their leaves visit them, so a query walks through memory
+/// mostly forwards.
+
+/// The most triangles in a leaf.
+#define CAVE_BVH_LEAF_TRIS (4)
+/// Marks a `cave_BVH_Node` child slot with nothing in it.
+#define CAVE_BVH_EMPTY (UINT32_MAX)
+
+/// A node of a `cave_BVH`, with the boxes of up to four children.
+///
+/// Child `i` is empty if `child[i]` is `CAVE_BVH_EMPTY`, a leaf holding `count[i]` triangles from
+/// `tris[child[i]]` on if `count[i]` isn't 0, and otherwise the node `nodes[child[i]]`. Empty children have
+/// inside out boxes, from infinity to minus infinity.
+typedef struct cave_BVH_Node {
+    float min_x[4];
+    float min_y[4];
+    float min_z[4];
+    float max_x[4];
+    float max_y[4];
+    float max_z[4];
+    uint32_t child[4];
+    uint32_t count[4];
+} cave_BVH_Node;
+
+/// A built hierarchy. Its members may be read freely but should not be modified.
+typedef struct cave_BVH {
+    /// The nodes, the root first, or NULL if there are no triangles.
+    cave_BVH_Node* nodes;
+    size_t node_count;
+    /// The triangles, in the order the leaves refer to them.
+    cave_3d_Triangle* tris;
+    /// For each of `tris`, its index in the triangles the tree was built from.
+    uint32_t* tri_ids;
+    size_t tri_count;
+} cave_BVH;
+
+/// A ray, the points `origin + t * dir` for `t_min <= t <= t_max`. `dir` needn't be unit length, in which case
+/// `t` isn't a distance.
+typedef struct cave_Ray {
+    cave_3Point origin;
+    cave_3Point dir;
+    float t_min;
+    float t_max;
+} cave_Ray;
+
+/// Where a ray first hits.
+typedef struct cave_Ray_Hit {
+    /// The index of the triangle hit, in the triangles the tree was built from, or `SIZE_MAX` for a miss.
+    size_t tri;
+    /// How far along the ray the hit is.
+    float t;
+    /// The barycentric coordinates of the hit. It is at `a + u * (b - a) + v * (c - a)`.
+    float u;
+    float v;
+} cave_Ray_Hit;
+
+/// The nearest point on the mesh to a query point.
+typedef struct cave_Closest_Hit {
+    /// The index of the triangle the point is on, in the triangles the tree was built from, or `SIZE_MAX` if
+    /// nothing is within range.
+    size_t tri;
+    cave_3Point point;
+    float distance;
+} cave_Closest_Hit;
+
+/// \brief Builds a hierarchy over `tri_count` triangles.
+///
+/// \param[out] dest - The hierarchy to build. Release it with `cave_BVH_release()`.
+/// \param tris - The triangles. They are copied, and may be freed once this returns.
+/// \param tri_count - The number of triangles, which may be 0.
+/// \param threads - The most threads to use, counting the calling thread, or 0 for one per hardware thread.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` is NULL, `tris` is NULL while `tri_count` isn't 0, or there are 2^32 or more
+///   triangles.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+/// If any error is returned, `*dest` is left empty and need not be released.
+CaveError cave_BVH_build(cave_BVH* dest, cave_3d_Triangle const* tris, size_t tri_count, size_t threads);
+
+/// \brief Builds a hierarchy over the triangles of an indexed mesh. Triangle ids are indexes into `mesh->tris`.
+/// \return Errors as `cave_BVH_build()`, and CAVE_DATA_ERROR if a triangle refers to a vertex past
+/// `mesh->vert_count`.
+CaveError cave_BVH_build_Mesh(cave_BVH* dest, cave_Mesh const* mesh, size_t threads);
+
+/// \brief Builds a hierarchy over the triangles of STL data. Their normals are ignored.
+/// \return Errors as `cave_BVH_build()`.
+CaveError cave_BVH_build_STL(cave_BVH* dest, cave_STL_Data const* data, size_t threads);
+
+/// \brief Frees the memory held by `bvh`, and sets its members to NULL and 0. `bvh` may be NULL.
+void cave_BVH_release(cave_BVH* bvh);
+
+/// \brief Finds where `ray` first hits the mesh, from either side of a triangle.
+///
+/// \param[out] hit - Set to the hit, or to a miss.
+/// \return Whether the ray hits anything. False if `bvh`, `ray` or `hit` is NULL.
+bool cave_BVH_first_hit(cave_BVH const* bvh, cave_Ray const* ray, cave_Ray_Hit* hit);
+
+/// \brief Finds whether `ray` hits the mesh anywhere, which can stop at the first triangle it finds.
+/// \return Whether the ray hits anything. False if `bvh` or `ray` is NULL.
+bool cave_BVH_any_hit(cave_BVH const* bvh, cave_Ray const* ray);
+
+/// \brief Finds the nearest point on the mesh to `point`.
+///
+/// \param max_distance - How far to look. Pass `INFINITY` to always find a point, if there are triangles.
+/// \param[out] hit - Set to the nearest point, or to nothing found.
+/// \return Whether a point was found within `max_distance`. False if `bvh` or `hit` is NULL.
+bool cave_BVH_closest_point(cave_BVH const* bvh, cave_3Point point, float max_distance, cave_Closest_Hit* hit);
+
+/// \brief Casts `count` rays, spread across threads, as `cave_BVH_first_hit()` does.
+///
+/// \param[out] hits - Set to where each ray first hits, `count` of them.
+/// \param threads - The most threads to use, counting the calling thread, or 0 for one per hardware thread.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `bvh` is NULL, or `rays` or `hits` is NULL while `count` isn't 0.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+CaveError cave_BVH_first_hits(cave_BVH const* bvh, cave_Ray const* rays, size_t count, cave_Ray_Hit* hits,
+                              size_t threads);
+
+/// \brief Checks `count` rays for any hit, spread across threads, as `cave_BVH_any_hit()` does.
+///
+/// \param[out] hit - Set to whether each ray hits anything, `count` of them.
+/// \return Errors as `cave_BVH_first_hits()`.
+CaveError cave_BVH_any_hits(cave_BVH const* bvh, cave_Ray const* rays, size_t count, bool* hit, size_t threads);
+
+/// \brief Finds the nearest points to `count` query points, spread across threads, as
+/// `cave_BVH_closest_point()` does.
+///
+/// \param[out] hits - Set to the nearest point to each query point, `count` of them.
+/// \return Errors as `cave_BVH_first_hits()`.
+CaveError cave_BVH_closest_points(cave_BVH const* bvh, cave_3Point const* points, size_t count,
+                                  float max_distance, cave_Closest_Hit* hits, size_t threads);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_BVH_H
@@ -0,0 +1,128 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_CACHE_H
+#define CAVE_CACHE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-mesh.h"
+#include "cave-bedrock.h"
+#include "cave-error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// \file
+/// An opt-in, on-disk cache of processed meshes, so that loading the same STL file over and
+/// over only pays for decoding, welding and normal generation once.
+///
+/// Entries are keyed by `cave_hash64()` of the raw file bytes and stored as one file per entry
+/// in the cache directory. An entry file holds a `cave_Mesh` exactly as it is laid out in
+/// memory (positions, normals, then `cave_Index_Triangle`s, each section 64 byte aligned), so a
+/// hit is served with a few reads and no parsing at all, and an entry file can also be `mmap`ed
+/// and used in place through `cave_Mesh_Cache_entry_view()`. Entries written on a host with a
+/// different `size_t` are treated as misses.
+///
+/// The cache keeps an index file in the directory recording each entry's size and when it was
+/// last used, and evicts least recently used entries once the total size passes the limit.
+/// Several processes may serve hits from the same directory, but only one cache handle per
+/// directory should be open for writing at a time, or their indexes will overwrite each other.
+
+/// The name of the index file kept inside a cache directory.
+#define CAVE_MESH_CACHE_INDEX_NAME "cave-mesh-cache.index"
+/// The file extension used for entry files.
+#define CAVE_MESH_CACHE_ENTRY_EXT ".cvmc"
+
+/// One entry of a `cave_Mesh_Cache`.
+typedef struct cave_Mesh_Cache_Entry {
+    uint64_t key;
+    uint64_t size;
+    uint64_t last_used;
+} cave_Mesh_Cache_Entry;
+
+/// A handle to a cache directory.
+///
+/// `hits`, `misses` and `evictions` count what has happened through this handle since it was
+/// opened and may be read freely. No member should be modified directly.
+typedef struct cave_Mesh_Cache {
+    char* dir;
+    uint64_t max_bytes;
+    uint64_t total_bytes;
+    uint64_t clock;
+    CaveVec entries;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+} cave_Mesh_Cache;
+
+/// \brief Opens the cache kept in `dir`, reading its index if there is one.
+///
+/// \param cache - The handle to initialize.
+/// \param dir - An existing directory to keep the cache in. Cave does not create it.
+/// \param max_bytes - Once the entries add up to more than this many bytes, the least recently
+///                    used ones are deleted. 0 means no limit.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `cache` or `dir` is NULL.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+/// A missing or unreadable index is not an error; the cache just starts out empty.
+CaveError cave_Mesh_Cache_open(cave_Mesh_Cache* cache, char const* dir, uint64_t max_bytes);
+
+/// \brief Writes the index back to the cache directory and frees `cache`.
+///
+/// \param cache - The cache to close. May be NULL.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_FILE_ERROR - If the index could not be written. `cache` is still freed.
+CaveError cave_Mesh_Cache_close(cave_Mesh_Cache* cache);
+
+/// \brief Writes the index to the cache directory without closing the cache.
+///
+/// The index is replaced atomically, so a crash never leaves a half written index behind.
+///
+/// \param cache - The cache to sync.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `cache` is NULL.
+/// * CAVE_FILE_ERROR - If the index could not be written.
+CaveError cave_Mesh_Cache_sync(cave_Mesh_Cache* cache);
+
+/// \brief Loads the binary STL file held in `bytes` as a welded mesh with vertex normals,
+/// going through the cache.
+///
+/// On a hit, the mesh is read straight out of the entry file. On a miss, `bytes` is decoded
+/// with `cave_bytes_to_STL_Data()`, welded with `cave_STL_Data_to_Mesh()`, given normals with
+/// `cave_Mesh_compute_vertex_normals()`, and then written to the cache. Failing to write the
+/// entry is not an error, as the caller still gets their mesh.
+///
+/// \param cache - The cache to go through.
+/// \param[out] dest - The loaded mesh. Release it with `cave_Mesh_release()`.
+/// \param bytes - The contents of a binary STL file.
+/// \param bytes_len - The number of bytes in `bytes`.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If an argument is NULL or `bytes` is not a valid STL file.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_Mesh_Cache_load_STL(cave_Mesh_Cache* cache, cave_Mesh* dest, uint8_t const* bytes, size_t bytes_len);
+
+/// \brief Makes `view` refer to the mesh stored in an entry file's bytes, without copying.
+///
+/// This is meant for entry files that have been `mmap`ed. `view` points into `bytes` and must
+/// NOT be released with `cave_Mesh_release()`; it is valid for as long as `bytes` is.
+///
+/// \param[out] view - The mesh to point into `bytes`.
+/// \param bytes - The contents of an entry file. Must be 8 byte aligned.
+/// \param bytes_len - The number of bytes in `bytes`.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If an argument is NULL, `bytes` is misaligned, or `bytes` is not an entry
+///   file written on a host with the same `size_t`.
+CaveError cave_Mesh_Cache_entry_view(cave_Mesh* view, uint8_t const* bytes, size_t bytes_len);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_CACHE_H
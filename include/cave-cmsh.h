@@ -0,0 +1,85 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_CMSH_H
+#define CAVE_CMSH_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-mesh.h"
+#include "cave-error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// \file
+/// CMSH is CaveWriter's native binary mesh format. It is meant as a preprocessed, cache-able
+/// form of a mesh that is much smaller than STL and much cheaper to load.
+///
+/// A CMSH file holds a `cave_Mesh` with quantized positions, optional octahedral encoded
+/// normals, and its triangle indexes. Every stream is delta coded and then compressed with the
+/// codec from `cave-lz.h` in independent blocks of at most `CAVE_CMSH_BLOCK_SIZE` bytes, so a
+/// decoder only ever needs one block of scratch memory.
+///
+/// Layout (all values little endian, like STL):
+/// * a 64 byte header: the magic "CMSH", version, flags, quantization bits, the block size,
+///   vertex and triangle counts, and the bounding box that positions are quantized against.
+/// * a stream table of three (offset, stored length, decoded length) `uint64_t` triples, for
+///   positions, normals and indexes, in that order.
+/// * the streams themselves, each starting on a 16 byte boundary. A stream is a list of blocks,
+///   each a `uint32_t` decoded length and `uint32_t` stored length followed by the payload,
+///   padded to 4 bytes. If the top bit of the stored length is set, the payload is stored raw.
+///
+/// Because every offset is aligned, a CMSH file can be `mmap`ed and handed straight to
+/// `cave_CMSH_Bytes_to_Mesh()`.
+
+#define CAVE_CMSH_VERSION (1)
+/// The largest decoded size of any one block.
+#define CAVE_CMSH_BLOCK_SIZE (65536)
+/// The position quantization used by `cave_Mesh_to_CMSH_Bytes()` when asked for 0 bits.
+#define CAVE_CMSH_DEFAULT_POSITION_BITS (16)
+/// The per-component octahedral normal quantization used when asked for 0 bits.
+#define CAVE_CMSH_DEFAULT_NORMAL_BITS (12)
+
+/// \brief Encodes `src` as a CMSH file.
+///
+/// Positions are quantized to `position_bits` bits per component across the mesh's bounding
+/// box, so the error on each component is at most half of the box's extent divided by
+/// `(2^position_bits) - 1`. Normals, if `src->normals` is not NULL, are stored with
+/// `normal_bits` bits for each of the two octahedral components. Zero length normals decode
+/// as (0, 0, 1). Triangle indexes are stored exactly.
+///
+/// \param[out] dest - Set to a malloc'ed buffer holding the encoded file. The caller frees it.
+/// \param[out] dest_len - Set to the number of bytes in `*dest`.
+/// \param src - The mesh to encode.
+/// \param position_bits - Bits per position component, 1 to 16. 0 means `CAVE_CMSH_DEFAULT_POSITION_BITS`.
+/// \param normal_bits - Bits per octahedral normal component, 2 to 16. 0 means `CAVE_CMSH_DEFAULT_NORMAL_BITS`.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If a pointer argument is NULL, a bit count is out of range, or `src` refers
+///   to a vertex past `src->vert_count`.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_Mesh_to_CMSH_Bytes(uint8_t** dest, size_t* dest_len, cave_Mesh const* src,
+                                  unsigned position_bits, unsigned normal_bits);
+
+/// \brief Decodes a CMSH file into `dest`.
+///
+/// Blocks are decoded one at a time straight into the arrays of `dest`, so apart from the mesh
+/// itself only a single block of scratch memory is used.
+///
+/// \param[out] dest - The mesh to fill in. Release it with `cave_Mesh_release()`. If any error is
+///                    returned, `dest` is left released.
+/// \param bytes - The encoded file, for example a `mmap`ed CMSH file.
+/// \param bytes_len - The number of bytes in `bytes`.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If an argument is NULL, or `bytes` is not a well-formed CMSH file.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_CMSH_Bytes_to_Mesh(cave_Mesh* dest, uint8_t const* bytes, size_t bytes_len);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_CMSH_H
@@ -0,0 +1,83 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_CPU_H
+#define CAVE_CPU_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-error.h"
+
+/// \file
+/// Which instruction sets Cave's hot kernels use. Cave is built with default compiler flags, so one library
+/// runs on any host of its architecture, and kernels for newer instruction sets are built alongside the
+/// plain ones with target attributes. The host is checked with `cpuid` the first time a kernel is needed,
+/// and the best path it supports is bound from then on: vector math (cave-vecmath.h) and decoding and
+/// encoding STL triangles.
+///
+/// The path can be forced lower for testing or benchmarking, either by setting the environment variable
+/// `CAVE_CPU_PATH` to one of "scalar", "sse2", "sse4.1", "avx2" or "avx512" before the first kernel runs, or
+/// with `cave_cpu_set_path()`. Every path gives exactly the same results.
+
+/// Instruction sets the host was found to support, as bits. Ones that need the operating system to save
+/// wider registers (AVX and up) are only reported if it does.
+typedef enum cave_Cpu_Feature {
+    CAVE_CPU_SSE2 = 1 << 0,
+    CAVE_CPU_SSE41 = 1 << 1,
+    CAVE_CPU_AVX = 1 << 2,
+    CAVE_CPU_AVX2 = 1 << 3,
+    CAVE_CPU_FMA = 1 << 4,
+    CAVE_CPU_AVX512F = 1 << 5,
+    CAVE_CPU_AVX512VL = 1 << 6,
+    CAVE_CPU_AVX512DQ = 1 << 7,
+    CAVE_CPU_AVX512BW = 1 << 8,
+} cave_Cpu_Feature;
+
+/// Sets of kernels, each needing the features of the one before it and more. A path without kernels of its
+/// own for something uses those of the path below it.
+typedef enum cave_Cpu_Path {
+    /// Plain C, on any host.
+    CAVE_CPU_PATH_SCALAR = 0,
+    /// Needs SSE2.
+    CAVE_CPU_PATH_SSE2,
+    /// Needs SSE4.1 too.
+    CAVE_CPU_PATH_SSE41,
+    /// Needs AVX, AVX2 and FMA too.
+    CAVE_CPU_PATH_AVX2,
+    /// Needs AVX-512 F, VL, DQ and BW too.
+    CAVE_CPU_PATH_AVX512,
+} cave_Cpu_Path;
+
+/// \brief The `cave_Cpu_Feature`s of the host, ORed together. 0 on hosts other than x86.
+unsigned cave_cpu_features(void);
+
+/// \brief The best path the host supports.
+cave_Cpu_Path cave_cpu_best_path(void);
+
+/// \brief The path in use: the best one, unless it has been forced lower.
+cave_Cpu_Path cave_cpu_path(void);
+
+/// \brief Forces the kernels of a path to be used from now on, or with `cave_cpu_best_path()`, goes back to
+/// the best ones.
+///
+/// Meant for tests and benchmarks. Kernels already running aren't affected, but it must not race with any
+/// other Cave call that may run a kernel, on any thread, including the workers of a call that spreads its
+/// work across threads: call it while nothing else in Cave is running. Checking the host the first time a
+/// kernel is needed is safe from any number of threads at once.
+///
+/// \param path - The path to use.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `path` isn't one of `cave_Cpu_Path`, or the host doesn't support it. The path in use
+///   is left as it was.
+CaveError cave_cpu_set_path(cave_Cpu_Path path);
+
+/// \brief Names a path, as `CAVE_CPU_PATH` would, eg "avx2", or returns "unknown".
+char const* cave_cpu_path_name(cave_Cpu_Path path);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_CPU_H
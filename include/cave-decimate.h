@@ -0,0 +1,84 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_DECIMATE_H
+#define CAVE_DECIMATE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include "cave-mesh.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+/// \file
+/// Decimating indexed triangle meshes by collapsing edges, cheapest first by the quadric error metric (Garland
+/// and Heckbert), to make levels of detail of scans far denser than a viewer needs.
+///
+/// Each vertex carries a quadric, the sum of the squared distances to the planes of the triangles around it,
+/// weighed by their areas. Collapsing an edge merges its two vertexes into one, placed where the sum of their
+/// quadrics is least, and its error is that sum there, divided by the area it covers, so that it reads as a
+/// mean squared distance from the surface as it was. Open boundaries add planes at right angles to the
+/// triangles along them, weighed more heavily, so that holes and edges keep their outline.
+///
+/// Every vertex's cheapest collapse is kept in a binary min-heap. The triangles around each vertex are linked
+/// through their corners, each corner being the start of a half-edge, so a collapse just relinks the triangles
+/// of the vertex that goes onto the one that stays, in time proportional to how many there are. A collapse is
+/// only made if it leaves the mesh as manifold as it was, the two vertexes having no neighbours in common
+/// besides the corners opposite their edge, and if it turns no triangle near or past edge-on.
+///
+/// Per-vertex normals can be weighed into the quadrics too (Hoppe), so that creases in shading hold on to their
+/// vertexes, and the normal of a merged vertex is the one that fits the normals it replaced best.
+
+/// How to decimate.
+typedef struct cave_Decimate_Options {
+    /// Collapsing stops once the mesh has no more than this many triangles.
+    size_t target_tri_count;
+    /// Collapsing stops before a collapse whose error, as a distance, would be more than this. 0 means no limit.
+    float max_error;
+    /// Whether to keep every vertex on an open boundary where it is. Otherwise boundaries are kept close to
+    /// their outline, but not exactly.
+    bool preserve_boundary;
+    /// How much per-vertex normals count, as the distance worth turning a normal by a unit of length, about 60
+    /// degrees. 0 leaves them out of the error, and they are then only interpolated. Ignored if the mesh has
+    /// no normals.
+    float normal_weight;
+    /// Whether to decimate in parallel, cutting the mesh into clusters of nearby triangles that are decimated
+    /// on their own, with the vertexes they share kept where they are, before the seams between them are
+    /// decimated with the rest of what's left. Much faster for huge meshes, at some cost in quality. The
+    /// clusters don't depend on the number of threads, so neither does the result.
+    bool approximate;
+    /// The most threads to use, counting the calling thread, or 0 for one per hardware thread. Only
+    /// approximate decimation uses more than one.
+    size_t threads;
+} cave_Decimate_Options;
+
+/// \brief Decimates an indexed mesh.
+///
+/// Triangles whose corners aren't three different vertexes are dropped. Vertexes are numbered in the order in
+/// which they are first used by a triangle, as in `cave_STL_Data_to_Mesh()`, and those no longer used are
+/// dropped. `dest->normals` is set only if `src->normals` is. The result can be written out with
+/// `cave_Mesh_to_STL_Data()` and `cave_STL_Data_to_bytes()`.
+///
+/// \param[out] dest - Set to the decimated mesh. Release it with `cave_Mesh_release()`.
+/// \param src - The mesh to decimate.
+/// \param options - How to decimate.
+/// \param[out] error - Set to the largest error of any collapse made, as a distance. May be NULL.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest`, `src` or `options` is NULL, `src->positions` or `src->tris` is NULL while
+///   there are vertexes or triangles, there are 2^32 or more vertexes or corners of triangles, a triangle refers
+///   to a vertex past `src->vert_count`, or `options->max_error` or `options->normal_weight` is negative or NaN.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+/// If any error is returned, `*dest` is left empty and need not be released.
+CaveError cave_Mesh_decimate(cave_Mesh* dest, cave_Mesh const* src, cave_Decimate_Options const* options,
+                             float* error);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_DECIMATE_H
@@ -0,0 +1,162 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_GRID_H
+#define CAVE_GRID_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// \file
+/// A uniform grid over a cloud of points, hashed into a table, for finding every point within some distance of
+/// another, or the nearest one, without testing them all. Welding, cleaning up point clouds and checking for
+/// collisions all come down to these.
+///
+/// Space is cut into cubes of a chosen size, and each cube's cell is hashed to one of a power of two slots, at
+/// least as many as there are points. The points are then counting sorted by slot, in two passes: one counting
+/// how many fall in each slot, and, once those counts are summed into where each slot starts, one copying every
+/// point into place. No slot gets an allocation of its own, so a slot is just where its points start and how
+/// many there are. Only a row of cells' y and z are hashed, and its cells take the slots after the first, so
+/// the points of a row of cells are all in one run of the points, and a query reads a few such runs.
+///
+/// Building takes time linear in the number of points, and a grid that is built again reuses its memory when
+/// it's large enough, so a grid can be rebuilt every frame over points that move. The grid copies the points,
+/// so it has to be rebuilt for changes to them to be seen.
+///
+/// Cells are best about as large as the distance most queries look within. Queries that would visit more cells
+/// than there are slots test every point instead, so large distances cost no more than that.
+
+/// Where the points hashed to a slot of a `cave_Point_Grid` are.
+typedef struct cave_Grid_Slot {
+    uint32_t start;
+    uint32_t count;
+} cave_Grid_Slot;
+
+/// A grid over points. Its members may be read freely but should not be modified.
+///
+/// Start from a zeroed grid, `cave_Point_Grid grid = {0};`, and release it with `cave_Point_Grid_release()`.
+typedef struct cave_Point_Grid {
+    /// The size of a cell along each axis, and its inverse.
+    float cell_size;
+    float inv_cell_size;
+    /// The points, sorted by slot.
+    cave_3Point* points;
+    /// For each of `points`, its index in the points the grid was built from.
+    uint32_t* ids;
+    size_t point_count;
+    /// The number of slots, a power of two.
+    size_t slot_count;
+    /// Slot `s` holds `slots[s].count` points, from `points[slots[s].start]` on. More than one cell can hash to
+    /// a slot.
+    cave_Grid_Slot* slots;
+    /// How many points and slots the memory held can take without reallocating.
+    size_t point_capacity;
+    size_t slot_capacity;
+} cave_Point_Grid;
+
+/// The points found near each of a batch of query points, by `cave_Point_Grid_neighbors()`.
+///
+/// Start from a zeroed one, and release it with `cave_Grid_Neighbors_release()`.
+typedef struct cave_Grid_Neighbors {
+    /// The points near query `i` are `ids[offsets[i]]` up to `ids[offsets[i + 1]]`, `query_count + 1` of these.
+    size_t* offsets;
+    /// The indexes of points found, in the points the grid was built from.
+    uint32_t* ids;
+    size_t query_count;
+    size_t id_count;
+    /// How many offsets and ids the memory held can take without reallocating.
+    size_t offset_capacity;
+    size_t id_capacity;
+} cave_Grid_Neighbors;
+
+/// The nearest point to a query point.
+typedef struct cave_Grid_Nearest {
+    /// The index of the nearest point, in the points the grid was built from, or `SIZE_MAX` if none is in range.
+    size_t id;
+    /// How far away it is, or infinity if none is in range.
+    float distance;
+} cave_Grid_Nearest;
+
+/// \brief Builds a grid over `point_count` points, or rebuilds it.
+///
+/// \param[in,out] grid - A zeroed grid, or one built before, whose memory is reused if it's large enough.
+/// \param points - The points. They are copied, and may be freed once this returns.
+/// \param point_count - The number of points, which may be 0.
+/// \param cell_size - The size of a cell. It must be positive and finite, with a finite inverse.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `grid` is NULL, `points` is NULL while `point_count` isn't 0, there are 2^32 or more
+///   points, or `cell_size` is out of range. `grid` is left as it was.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails, in which case `grid` is released.
+CaveError cave_Point_Grid_build(cave_Point_Grid* grid, cave_3Point const* points, size_t point_count,
+                                float cell_size);
+
+/// \brief Frees the memory held by `grid`, and sets its members to NULL and 0. `grid` may be NULL.
+void cave_Point_Grid_release(cave_Point_Grid* grid);
+
+/// \brief Finds the points within `radius` of `point`, those whose squared distance in floats is at most
+/// `radius * radius`.
+///
+/// \param[out] ids - Set to the indexes of up to `capacity` of the points found, in the points the grid was built
+/// from. They come in no particular order, but always in the same one. May be NULL if `capacity` is 0.
+/// \param capacity - How many indexes `ids` can take.
+/// \return How many points were found, which may be more than `capacity`. 0 if `grid` is NULL or `radius` is
+/// negative.
+size_t cave_Point_Grid_within(cave_Point_Grid const* grid, cave_3Point point, float radius, uint32_t* ids,
+                              size_t capacity);
+
+/// \brief Finds the nearest point to `point`. Of points as near as each other, the one with the lowest index.
+///
+/// \param max_distance - How far to look. Pass `INFINITY` to always find a point, if there are any.
+/// \param[out] nearest - Set to the nearest point, or to nothing found.
+/// \return Whether a point was found within `max_distance`. False if `grid` or `nearest` is NULL.
+bool cave_Point_Grid_nearest(cave_Point_Grid const* grid, cave_3Point point, float max_distance,
+                             cave_Grid_Nearest* nearest);
+
+/// \brief Finds the points within `radius` of each of `query_count` query points, spread across threads, as
+/// `cave_Point_Grid_within()` does.
+///
+/// Each query is run twice, once counting what it finds and once, after the counts are summed into offsets,
+/// writing it down, so that the results are packed into one array, the same whatever the number of threads.
+/// Nothing is allocated once `dest` is large enough.
+///
+/// Queries near each other are best run one after another, so that they find the grid's memory cached. To find
+/// the neighbors of every point in the grid, passing `grid->points` as the queries does that, query `i` then
+/// being the point `grid->ids[i]`.
+///
+/// \param[in,out] dest - A zeroed `cave_Grid_Neighbors`, or one filled before, whose memory is reused if it's
+/// large enough. Set to the points found.
+/// \param threads - The most threads to use, counting the calling thread, or 0 for one per hardware thread.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `grid` or `dest` is NULL, or `queries` is NULL while `query_count` isn't 0.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails, in which case `dest` is released.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+CaveError cave_Point_Grid_neighbors(cave_Point_Grid const* grid, cave_3Point const* queries, size_t query_count,
+                                    float radius, cave_Grid_Neighbors* dest, size_t threads);
+
+/// \brief Frees the memory held by `neighbors`, and sets its members to NULL and 0. `neighbors` may be NULL.
+void cave_Grid_Neighbors_release(cave_Grid_Neighbors* neighbors);
+
+/// \brief Finds the nearest points to `query_count` query points, spread across threads, as
+/// `cave_Point_Grid_nearest()` does.
+///
+/// \param[out] nearest - Set to the nearest point to each query point, `query_count` of them.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `grid` is NULL, or `queries` or `nearest` is NULL while `query_count` isn't 0.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+CaveError cave_Point_Grid_nearests(cave_Point_Grid const* grid, cave_3Point const* queries, size_t query_count,
+                                   float max_distance, cave_Grid_Nearest* nearest, size_t threads);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_GRID_H
@@ -0,0 +1,63 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_LZ_H
+#define CAVE_LZ_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// \file
+/// A small LZ77-style byte codec used by CaveWriter's native formats, so Cave can compress
+/// its own files without depending on zlib or similar. The block format is LZ4-like: a
+/// sequence of (literal run, back-reference) pairs with 16-bit offsets, always ending in a
+/// literal-only sequence. Blocks are self-contained; there is no framing or checksum, so the
+/// caller is expected to record both the compressed and the decompressed length of a block.
+
+/// The farthest back a match may reference, in bytes.
+#define CAVE_LZ_MAX_OFFSET (65535)
+
+/// \brief The largest number of bytes `cave_lz_compress` can produce for `src_len` input bytes.
+///
+/// Incompressible input grows by a little under 0.5%, plus a few bytes of overhead.
+size_t cave_lz_compress_bound(size_t src_len);
+
+/// \brief Compresses `src_len` bytes from `src` into `dst`.
+///
+/// \param dst - Destination buffer. Must hold at least `dst_cap` bytes.
+/// \param dst_cap - The capacity of `dst`. `cave_lz_compress_bound(src_len)` is always enough.
+/// \param[out] dst_len - The number of bytes written to `dst` on success.
+/// \param src - The bytes to compress. May be NULL only if `src_len` is 0.
+/// \param src_len - The number of bytes in `src`. Must be less than 4 GiB.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dst` or `dst_len` is NULL, `src` is NULL with a non-zero length,
+///   or `src_len` is 4 GiB or more.
+/// * CAVE_INDEX_ERROR - If the compressed output would not fit in `dst_cap` bytes.
+CaveError cave_lz_compress(uint8_t* dst, size_t dst_cap, size_t* dst_len, uint8_t const* src, size_t src_len);
+
+/// \brief Decompresses a block produced by `cave_lz_compress`.
+///
+/// The block must decompress to exactly `dst_len` bytes. Every read and write is bounds
+/// checked, so corrupt or hostile input results in an error rather than memory unsafety.
+///
+/// \param dst - Destination buffer of `dst_len` bytes.
+/// \param dst_len - The exact decompressed size of the block.
+/// \param src - The compressed block.
+/// \param src_len - The size of the compressed block in bytes.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If an argument is NULL, the block is malformed, or does not decompress
+///   to exactly `dst_len` bytes.
+CaveError cave_lz_decompress(uint8_t* dst, size_t dst_len, uint8_t const* src, size_t src_len);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_LZ_H
@@ -0,0 +1,74 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_MEASURE_H
+#define CAVE_MEASURE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include "cave-writer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// \file
+/// Measurements of a triangle soup: its bounding box, surface area, enclosed volume and center of mass, all
+/// taken in a single pass over the triangles, either decoded or still in the bytes of a binary STL file.
+///
+/// The pass is split into fixed chunks of triangles spread across threads, each summed with compensation, and
+/// the chunks' sums are then added up in order. Since the chunks don't depend on the number of threads, and the
+/// vector kernels doing the per-triangle work agree bit for bit (see cave-vecmath.h), the results are the same
+/// however many threads there are and whichever instruction set is in use.
+
+/// What `cave_STL_Data_measure()` and `cave_STL_Bytes_measure()` find.
+typedef struct cave_Mesh_Measures {
+    /// The smallest x, y and z of any corner, or infinity if there are no triangles.
+    cave_3Point min;
+    /// The largest x, y and z of any corner, or minus infinity if there are no triangles.
+    cave_3Point max;
+    /// The total area of the triangles.
+    double area;
+    /// The volume the triangles enclose, by the divergence theorem. Positive when they are wound
+    /// counter-clockwise seen from outside, as STL files should be. Only meaningful for closed surfaces.
+    double volume;
+    /// The center of mass of the enclosed solid, taken as uniformly dense. If `volume` is 0, the center of
+    /// the surface instead, its triangles weighed by area, and if `area` is 0 as well, the origin.
+    cave_3Point centroid;
+} cave_Mesh_Measures;
+
+/// \brief Measures the triangles of `data`. Their normals are ignored.
+///
+/// \param[out] dest - Set to the measurements.
+/// \param data - The triangles to measure.
+/// \param threads - The most threads to use, counting the calling thread, or 0 for one per hardware thread.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `data` is NULL, or `data->tris` is NULL while `data->tri_count` isn't 0.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+CaveError cave_STL_Data_measure(cave_Mesh_Measures* dest, cave_STL_Data const* data, size_t threads);
+
+/// \brief Measures the triangles of a binary STL file without decoding the whole of it.
+///
+/// This is meant for files that have been `mmap`ed. Triangle records are decoded a small block at a time into
+/// a buffer on the stack, so no memory is allocated in proportion to the file.
+///
+/// \param[out] dest - Set to the measurements.
+/// \param bytes - The whole file.
+/// \param bytes_len - The number of bytes in `bytes`.
+/// \param threads - As `cave_STL_Data_measure()`.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `bytes` is NULL, or `bytes` isn't a binary STL file of exactly
+///   `bytes_len` bytes, as `cave_bytes_to_STL_Data()` checks.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+CaveError cave_STL_Bytes_measure(cave_Mesh_Measures* dest, uint8_t const* bytes, size_t bytes_len, size_t threads);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_MEASURE_H
@@ -0,0 +1,147 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_MESH_H
+#define CAVE_MESH_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include "cave-writer.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+/// \file
+/// An indexed triangle mesh, and conversions between it and the triangle soup that file
+/// formats like STL store. Where `cave_STL_Data` repeats every corner of every triangle,
+/// `cave_Mesh` stores each distinct position once and refers to it by index.
+
+/// An indexed triangle mesh.
+///
+/// `positions` (and `normals`, if not NULL) hold `vert_count` elements each. `tris` holds
+/// `tri_count` triangles, whose `a`, `b` and `c` members are indexes into `positions`.
+/// `normals` are per-vertex normals and are optional.
+///
+/// A mesh that has been filled in by a Cave function should be released with `cave_Mesh_release()`.
+typedef struct cave_Mesh {
+    cave_3Point* positions;
+    cave_3Point* normals;
+    size_t vert_count;
+    cave_Index_Triangle* tris;
+    size_t tri_count;
+} cave_Mesh;
+
+/// \brief Frees the memory held by `mesh`, and sets its members to NULL and 0.
+///
+/// \param mesh - The mesh to release. May be NULL.
+void cave_Mesh_release(cave_Mesh* mesh);
+
+/// \brief Builds an indexed mesh out of STL data by welding corners with identical positions.
+///
+/// Two corners are welded only if their positions are bitwise identical; no tolerance is
+/// applied. Vertexes are numbered in the order in which they are first used by a triangle, which
+/// keeps neighbouring vertexes close together in memory. The STL normals are not carried over,
+/// `dest->normals` is set to NULL. See `cave_Mesh_compute_vertex_normals()`.
+///
+/// \param[out] dest - The mesh to fill in. Its prior contents are ignored.
+/// \param src - The STL data to weld.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `src` is NULL.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails. `dest` is left released.
+CaveError cave_STL_Data_to_Mesh(cave_Mesh* dest, cave_STL_Data const* src);
+
+/// \brief Expands an indexed mesh into STL data.
+///
+/// Face normals are computed from the winding of each triangle. The header is zeroed and
+/// every attribute is set to 0.
+///
+/// \param[out] dest - The STL data to fill in. Release it with `cave_STL_Data_release()`.
+/// \param src - The mesh to expand.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `src` is NULL, `src` has more triangles than STL can
+///   count, or `src` refers to a vertex past `src->vert_count`.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_Mesh_to_STL_Data(cave_STL_Data* dest, cave_Mesh const* src);
+
+/// \brief Computes area weighted per-vertex normals for `mesh`.
+///
+/// Each vertex normal is the normalized sum of the (unnormalized) face normals of the triangles
+/// that use it, so larger triangles pull harder. Vertexes that are unused, or only used by
+/// degenerate triangles, get a zero normal. If `mesh->normals` is NULL it is allocated,
+/// otherwise it is overwritten.
+///
+/// \param mesh - The mesh to compute normals for.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `mesh` is NULL or refers to a vertex past `mesh->vert_count`.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If `mesh->normals` could not be allocated.
+CaveError cave_Mesh_compute_vertex_normals(cave_Mesh* mesh);
+
+/// How a vertex normal weighs the faces around the vertex.
+typedef enum cave_Normal_Weighting {
+    /// By each face's area, so larger faces pull harder. Lopsided where one side of a vertex has been cut into
+    /// more triangles than the other.
+    CAVE_NORMAL_WEIGHT_AREA = 0,
+    /// By the angle each face makes at the vertex, which doesn't depend on how the faces around it were cut
+    /// into triangles (Thurmer and Wuthrich).
+    CAVE_NORMAL_WEIGHT_ANGLE,
+} cave_Normal_Weighting;
+
+/// How to compute or repair normals. Zeroed, or a NULL pointer in its place, replaces every STL normal,
+/// weighs vertex normals by area, and uses a thread per hardware thread.
+typedef struct cave_Normal_Options {
+    /// STL normals within this many radians of the way their triangle faces are kept. 0 replaces them all.
+    float tolerance;
+    /// Only count the STL normals that would be replaced, and leave them be.
+    bool check_only;
+    /// How vertex normals weigh faces.
+    cave_Normal_Weighting weighting;
+    /// The number of threads, counting the calling thread. 0 means one per hardware thread.
+    size_t threads;
+} cave_Normal_Options;
+
+/// \brief Checks the normals stored in STL data against the triangles, and replaces those that are wrong.
+///
+/// `cave_bytes_to_STL_Data()` takes normals as written, and plenty of files have zero or stale ones. A
+/// triangle faces the way its corners wind counter-clockwise, and its normal is the unit vector that way, or
+/// zero for a degenerate triangle. A stored normal is replaced when it is more than `options->tolerance` off
+/// that, or is zero, infinite or NaN, or its triangle is degenerate and it isn't zero. Normals are worked out
+/// with the SIMD kernels of cave-vecmath.h, spread across threads, and come out the same however many there
+/// are.
+///
+/// \param data - The STL data to repair.
+/// \param options - May be NULL to replace every normal.
+/// \param[out] replaced - Set to how many normals were replaced, or would have been. May be NULL.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `data` is NULL, its `tris` are NULL while its `tri_count` isn't 0, or the tolerance is
+///   negative or NaN.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated. Some normals may have been replaced.
+CaveError cave_STL_Data_repair_normals(cave_STL_Data* data, cave_Normal_Options const* options, size_t* replaced);
+
+/// \brief Computes smooth per-vertex normals for `mesh`, weighing faces by area or by angle.
+///
+/// As `cave_Mesh_compute_vertex_normals()`, which is this with area weighting. Face normals are worked out
+/// with the SIMD kernels of cave-vecmath.h, spread across threads, and then summed per vertex in face order,
+/// so the results are the same however many threads there are.
+///
+/// \param mesh - The mesh to compute normals for.
+/// \param options - May be NULL to weigh by area. Only `weighting` and `threads` apply.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `mesh` is NULL or refers to a vertex past `mesh->vert_count`, or `options->weighting`
+///   isn't one of `cave_Normal_Weighting`.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+CaveError cave_Mesh_compute_weighted_normals(cave_Mesh* mesh, cave_Normal_Options const* options);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_MESH_H
@@ -9,10 +9,361 @@ extern "C" {
 #endif
 
 #include "cave-primities.h"
+#include "cave-error.h"
+#include <stddef.h>
+#include <stdbool.h>
 
+/// \file
+/// PolyTri divides polygons into triangles.
+///
+/// A polygon is given as a ring of `cave_2Point`s, where the last point connects back to the first;
+/// the first point should not be repeated at the end. Either winding is accepted. Triangles come out
+/// as `cave_Index_Triangle`s whose members index into the points that were passed in, so no point
+/// data is copied, and they are always wound counter-clockwise (positive signed area, with y up).
+/// `cave_polytri_to_2d_Triangles()` turns them into `cave_2d_Triangle`s when the points themselves
+/// are wanted.
+///
+/// Polygons with holes, or several separate outlines, are given as a `cave_2d_Polygon`. Its rings are told
+/// apart by winding: counter-clockwise rings are outlines and clockwise rings are holes. Triangles index
+/// into `points` of the whole polygon, not into the ring they came from.
+///
+/// Flat polygons in 3D, like the faces of a CAD model, are given as a `cave_3d_Polygon`. They are projected
+/// onto the axis plane they face most squarely and triangulated there, and their triangles index into the
+/// 3D points.
 
+/// Polygons with more points than this have their ear tests accelerated by a z-order hash.
+/// Below it, checking every remaining point is faster than building the hash.
+#define CAVE_POLYTRI_HASH_THRESHOLD (80)
+
+/// \brief Triangulates a simple polygon by ear clipping.
+///
+/// The points are kept in a doubly linked ring, and ears (convex corners whose triangle holds no other
+/// point of the ring) are clipped off one at a time. For polygons with more than
+/// `CAVE_POLYTRI_HASH_THRESHOLD` points, every point is also given a z-order (Morton) code and listed
+/// in order of that code, so checking whether a candidate ear is empty only visits the points near it
+/// rather than the whole ring. Reflex corners are also skipped until a neighbour is clipped. Together
+/// these keep polygons of 100k+ points in the milliseconds, where plain ear clipping is O(n^2).
+///
+/// Repeated points and zero length edges are tolerated. If the polygon
+/// intersects itself, small self intersections are cut off and the rest is split along a diagonal
+/// and triangulated piecewise, so some triangulation is still produced, but it is not guaranteed to
+/// cover the polygon exactly.
+///
+/// A simple polygon with `point_count` points produces at most `point_count - 2` triangles.
+///
+/// \param[out] dest - Set to a malloc'ed array of the triangles, or NULL if there are none.
+///                    The caller frees it.
+/// \param[out] tri_count - Set to the number of triangles in `*dest`.
+/// \param points - The ring of points.
+/// \param point_count - The number of points in `points`. Fewer than 3 produces no triangles.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `tri_count` is NULL, `points` is NULL while `point_count` isn't 0,
+///   a coordinate is infinite or NaN, or there are too many points to index (over 2^29).
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_polytri_triangulate(cave_Index_Triangle** dest, size_t* tri_count,
+                                   cave_2Point const* points, size_t point_count);
+
+/// \brief Triangulates a simple polygon by splitting it into monotone pieces, in O(n log n) time.
+///
+/// A sweep line moves down the polygon, keeping the edges it crosses in a balanced tree, and adds
+/// diagonals at the vertexes where the boundary turns back on itself, until every piece is y-monotone.
+/// Each piece is then triangulated in linear time. Unlike ear clipping, the running time depends only on
+/// the number of points and not on the shape, so this is the one to use when worst case latency matters,
+/// eg for large, highly concave polygons. Ear clipping tends to give better shaped triangles.
+///
+/// Repeated consecutive points are tolerated. The polygon must otherwise be simple: if it intersects or
+/// touches itself the output is some set of triangles, but it won't cover the polygon.
+/// The output is the same as that of `cave_polytri_triangulate()`.
+///
+/// \param[out] dest - Set to a malloc'ed array of the triangles, or NULL if there are none.
+///                    The caller frees it.
+/// \param[out] tri_count - Set to the number of triangles in `*dest`.
+/// \param points - The ring of points.
+/// \param point_count - The number of points in `points`. Fewer than 3 produces no triangles.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `tri_count` is NULL, `points` is NULL while `point_count` isn't 0,
+///   a coordinate is infinite or NaN, or there are too many points to index (over 2^29).
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_polytri_triangulate_monotone(cave_Index_Triangle** dest, size_t* tri_count,
+                                            cave_2Point const* points, size_t point_count);
+
+/// \brief Triangulates a polygon with holes, or several of them, by ear clipping.
+///
+/// Each hole is joined to the outline around it by a bridge, a pair of edges running from the hole's
+/// leftmost point to a visible point of the outline and back, which leaves a single ring to ear clip as
+/// `cave_polytri_triangulate()` does. Holes are bridged left to right, after sorting them by their
+/// leftmost point, and the outline's edges are kept in a uniform grid, so finding each bridge only visits
+/// the edges near it. Thousands of holes take about as long as the same number of points in one ring.
+///
+/// A hole is assigned to the smallest outline containing its first point, and is dropped if there is none.
+/// Rings with fewer than 3 points, or no area, are ignored. Rings that touch or cross are tolerated in the
+/// same way as a self intersecting ring is by `cave_polytri_triangulate()`.
+///
+/// A polygon with `n` points and `h` holes produces at most `n + 2h - 2` triangles per outline.
+///
+/// \param[out] dest - Set to a malloc'ed array of the triangles, or NULL if there are none.
+///                    The caller frees it.
+/// \param[out] tri_count - Set to the number of triangles in `*dest`.
+/// \param polygon - The rings, outlines counter-clockwise and holes clockwise.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest`, `tri_count` or `polygon` is NULL, the ring offsets decrease, a coordinate
+///   is infinite or NaN, or there are too many points to index (over 2^29).
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_polytri_triangulate_polygon(cave_Index_Triangle** dest, size_t* tri_count,
+                                           cave_2d_Polygon const* polygon);
+
+/// \brief Triangulates a polygon with holes, or several of them, by splitting it into monotone pieces.
+///
+/// The sweep of `cave_polytri_triangulate_monotone()` handles holes as they are: the top of each hole is a
+/// split vertex, so it is joined to the rest of the polygon by the diagonals the sweep adds anyway, and the
+/// running time stays O(n log n) however many holes there are.
+///
+/// Unlike `cave_polytri_triangulate_polygon()`, the rings are used as given, so they have to be wound as
+/// `cave_2d_Polygon` describes, holes have to lie inside outlines, and no two rings may touch or cross.
+/// Otherwise the output is some set of triangles, but it won't cover the polygon.
+///
+/// \param[out] dest - Set to a malloc'ed array of the triangles, or NULL if there are none.
+///                    The caller frees it.
+/// \param[out] tri_count - Set to the number of triangles in `*dest`.
+/// \param polygon - The rings, outlines counter-clockwise and holes clockwise.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest`, `tri_count` or `polygon` is NULL, the ring offsets decrease, a coordinate
+///   is infinite or NaN, or there are too many points to index (over 2^29).
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_polytri_triangulate_polygon_monotone(cave_Index_Triangle** dest, size_t* tri_count,
+                                                    cave_2d_Polygon const* polygon);
+
+/// \brief Builds the constrained Delaunay triangulation of a set of points.
+///
+/// The triangles are as close to equilateral as the points allow: no point lies inside the circle through
+/// any triangle, except where a constraint edge stands between them. That makes this the one to use where
+/// slivers hurt, eg for finite element meshes, texture mapping or terrain.
+///
+/// Points are inserted one at a time in Hilbert curve order, each found by walking from the last, and
+/// edges are flipped until the triangulation is Delaunay again, which takes expected O(n log n) time
+/// overall. Constraint edges are then forced in by flipping away the edges that cross them. Memory is
+/// allocated once up front, at about 100 bytes per point, apart from what long constraints need.
+///
+/// Every point becomes a vertex, apart from exact repeats of an earlier point, which are merged into it.
+/// Constraints may run through points, which splits them there, and may share ends, but mustn't cross each
+/// other. Without `fill`, the triangles cover the convex hull of the points, less any very thin triangles
+/// along nearly straight stretches of it. With `fill`, only the triangles inside the constraints are kept:
+/// those reached from outside by crossing an odd number of them, so closed rings of constraints outline
+/// the shape and the rings inside them cut holes, whichever way they are wound.
+///
+/// \param[out] dest - Set to a malloc'ed array of the triangles, or NULL if there are none.
+///                    The caller frees it.
+/// \param[out] tri_count - Set to the number of triangles in `*dest`.
+/// \param points - The points to triangulate.
+/// \param point_count - The number of points in `points`.
+/// \param edges - The constraint edges, as indexes into `points`. May be NULL if `edge_count` is 0.
+/// \param edge_count - The number of edges in `edges`.
+/// \param fill - Whether to keep only the triangles inside the constraints.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `tri_count` is NULL, `points` or `edges` is NULL while its count isn't 0,
+///   a coordinate is infinite or NaN, there are too many points to index (over 2^29), or two constraints
+///   cross.
+/// * CAVE_INDEX_ERROR - If an edge refers to a point past `point_count`.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_polytri_triangulate_cdt(cave_Index_Triangle** dest, size_t* tri_count,
+                                       cave_2Point const* points, size_t point_count,
+                                       cave_Index_Edge const* edges, size_t edge_count, bool fill);
+
+/// \brief Fills a polygon with holes with a constrained Delaunay triangulation.
+///
+/// As `cave_polytri_triangulate_cdt()` with `fill`, with every edge of every ring as a constraint. Unlike
+/// ear clipping, this adds no bridges, and the triangles are well shaped. Rings are told apart by nesting
+/// rather than winding, so they may be wound either way, but they mustn't cross.
+///
+/// \param[out] dest - Set to a malloc'ed array of the triangles, or NULL if there are none.
+///                    The caller frees it.
+/// \param[out] tri_count - Set to the number of triangles in `*dest`.
+/// \param polygon - The rings.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest`, `tri_count` or `polygon` is NULL, the ring offsets decrease, a coordinate
+///   is infinite or NaN, there are too many points to index (over 2^29), or two rings cross.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_polytri_triangulate_polygon_cdt(cave_Index_Triangle** dest, size_t* tri_count,
+                                               cave_2d_Polygon const* polygon);
+
+/// Polygons are handed to threads in chunks of about this many points.
+#define CAVE_POLYTRI_BATCH_DEFAULT_CHUNK_POINTS (16384)
+
+/// Tuning for `cave_polytri_triangulate_batch()`. Any member left as 0 gets its default.
+typedef struct cave_PolyTri_Batch_Options {
+    /// The number of threads triangulating, counting the calling thread. Defaults to the number of hardware
+    /// threads.
+    size_t threads;
+    /// Roughly how many points' worth of polygons a thread takes at a time. Defaults to
+    /// `CAVE_POLYTRI_BATCH_DEFAULT_CHUNK_POINTS`.
+    size_t chunk_points;
+} cave_PolyTri_Batch_Options;
+
+/// \brief Triangulates many polygons in one call, spread across threads.
+///
+/// Meant for large numbers of small polygons, eg map tiles or the faces of a CAD model, where the cost of a
+/// call and its allocations would outweigh the triangulation itself. Each polygon is ear clipped as by
+/// `cave_polytri_triangulate_polygon()`. Threads take chunks of polygons as they finish the last, and each
+/// keeps its working memory from one polygon to the next, so apart from the output only a handful of
+/// allocations are made per thread, however many polygons there are.
+///
+/// All the polygons' rings are given as one `cave_2d_Polygon`, and polygon `i` is made of rings
+/// `polygon_rings[i]` up to but not including `polygon_rings[i + 1]`. Triangles index into `rings->points`.
+/// The triangles of polygon `i` are `(*dest)[(*tri_offsets)[i]]` up to but not including
+/// `(*dest)[(*tri_offsets)[i + 1]]`.
+///
+/// \param[out] dest - Set to a malloc'ed array of every polygon's triangles, or NULL if there are none.
+///                    The caller frees it.
+/// \param[out] tri_offsets - Set to a malloc'ed array of `polygon_count + 1` offsets into `*dest`.
+///                           The caller frees it.
+/// \param rings - The rings of every polygon, outlines counter-clockwise and holes clockwise.
+/// \param polygon_rings - `polygon_count + 1` offsets into the rings of `rings`, one polygon after another.
+/// \param polygon_count - The number of polygons.
+/// \param options - May be NULL to use the defaults.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest`, `tri_offsets`, `rings` or `polygon_rings` is NULL, either set of offsets
+///   decreases, a polygon refers to rings past `rings->ring_count`, a coordinate is infinite or NaN, or a
+///   polygon has too many points to index (over 2^29). Nothing is returned.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails. Nothing is returned.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated. Nothing is returned.
+CaveError cave_polytri_triangulate_batch(cave_Index_Triangle** dest, size_t** tri_offsets,
+                                         cave_2d_Polygon const* rings, size_t const* polygon_rings,
+                                         size_t polygon_count, cave_PolyTri_Batch_Options const* options);
+
+/// \brief Triangulates a flat polygon in 3D, such as a face of a CAD model.
+///
+/// The polygon's normal is found by Newell's method, summed over the edges of every ring, which stays
+/// accurate when neighbouring points are nearly collinear or the face isn't quite planar. The polygon is
+/// then projected onto whichever of the xy, yz or zx planes faces the normal most squarely and ear clipped
+/// as by `cave_polytri_triangulate_polygon()`. Triangles index into `polygon->points`, so no point data is
+/// copied, and are wound the same way as the polygon's outlines, so a face wound counter-clockwise seen from
+/// outside a solid gives triangles that are too.
+///
+/// A polygon that isn't close to planar is projected all the same, and may come out with overlapping
+/// triangles wherever the projection folds it over itself.
+///
+/// \param[out] dest - Set to a malloc'ed array of the triangles, or NULL if there are none.
+///                    The caller frees it.
+/// \param[out] tri_count - Set to the number of triangles in `*dest`.
+/// \param polygon - The rings.
+/// \return
+/// * CAVE_NO_ERROR - On success. A polygon whose points are all on one line produces no triangles.
+/// * CAVE_DATA_ERROR - If `dest`, `tri_count` or `polygon` is NULL, the ring offsets decrease, a coordinate
+///   is infinite or NaN, or there are too many points to index (over 2^29).
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_polytri_triangulate_3d(cave_Index_Triangle** dest, size_t* tri_count, cave_3d_Polygon const* polygon);
+
+/// \brief Triangulates many flat polygons in 3D in one call, spread across threads.
+///
+/// As `cave_polytri_triangulate_batch()`, with each polygon triangulated as by `cave_polytri_triangulate_3d()`.
+/// Each face's points are projected into memory its thread keeps from one face to the next, so a mesh of a
+/// million faces costs no more allocations than one of a hundred. Face `i` is made of rings `face_rings[i]` up
+/// to but not including `face_rings[i + 1]`, and its triangles are `(*dest)[(*tri_offsets)[i]]` up to but
+/// not including `(*dest)[(*tri_offsets)[i + 1]]`. Triangles index into `rings->points`.
+///
+/// \param[out] dest - Set to a malloc'ed array of every face's triangles, or NULL if there are none.
+///                    The caller frees it.
+/// \param[out] tri_offsets - Set to a malloc'ed array of `face_count + 1` offsets into `*dest`.
+///                           The caller frees it.
+/// \param rings - The rings of every face.
+/// \param face_rings - `face_count + 1` offsets into the rings of `rings`, one face after another.
+/// \param face_count - The number of faces.
+/// \param options - May be NULL to use the defaults.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest`, `tri_offsets`, `rings` or `face_rings` is NULL, either set of offsets
+///   decreases, a face refers to rings past `rings->ring_count`, a coordinate is infinite or NaN, or a
+///   face has too many points to index (over 2^29). Nothing is returned.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails. Nothing is returned.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated. Nothing is returned.
+CaveError cave_polytri_triangulate_3d_batch(cave_Index_Triangle** dest, size_t** tri_offsets,
+                                            cave_3d_Polygon const* rings, size_t const* face_rings,
+                                            size_t face_count, cave_PolyTri_Batch_Options const* options);
+
+/// Memory owned by the caller that PolyTri takes its working memory from in place of malloc, for callers who
+/// triangulate every frame and can't afford the allocator's jitter. Set `memory` and `capacity`, and `used`
+/// and `peak` to 0. Each call hands back what it took before returning, so one arena serves any number of
+/// calls, though only one at a time.
+typedef struct cave_PolyTri_Arena {
+    void* memory;
+    /// The size of `memory`, in bytes.
+    size_t capacity;
+    /// How many bytes of `memory` are taken. Only nonzero during a call.
+    size_t used;
+    /// The most bytes any call has taken, or tried to. Above `capacity` after a call ran out, in which case an
+    /// arena at least that big gets further next time, and one big enough to get through once is big enough
+    /// for the same polygon every time after.
+    size_t peak;
+} cave_PolyTri_Arena;
+
+/// Receives triangles a batch at a time, returning `CAVE_NO_ERROR` to carry on. Anything else is handed
+/// back by the call that made the triangles, once it finishes, and no more triangles are passed on.
+typedef CaveError (*cave_PolyTri_Emit)(void* user, cave_Index_Triangle const* tris, size_t tri_count);
+
+/// Triangles are handed to a callback in batches of this many, the last batch aside.
+#define CAVE_POLYTRI_SINK_BATCH (256)
+
+/// Where triangles go, in place of a malloc'ed array: a callback, or a buffer the caller owns. A polygon of
+/// `n` points in `r` rings makes fewer than `n + 2r` triangles, so a buffer that big never overflows.
+typedef struct cave_PolyTri_Sink {
+    /// If set, triangles are handed to it in batches, with `user`, and `buffer` is ignored.
+    cave_PolyTri_Emit emit;
+    void* user;
+    /// Otherwise triangles are written here, up to `capacity` of them.
+    cave_Index_Triangle* buffer;
+    size_t capacity;
+    /// Set to the number of triangles made, which is more than `capacity` when `buffer` overflowed.
+    size_t tri_count;
+} cave_PolyTri_Sink;
+
+/// \brief Triangulates a polygon with holes, as `cave_polytri_triangulate_polygon()` does, without allocating.
+///
+/// Triangles are written to `sink`, and working memory comes from `arena`, so a caller with a big enough
+/// buffer, or a callback, and an arena never has malloc called for them.
+///
+/// \param sink - Where the triangles go. Its `tri_count` is set whatever happens.
+/// \param polygon - The rings, outlines counter-clockwise and holes clockwise.
+/// \param arena - May be NULL to use malloc for working memory.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `sink` or `polygon` is NULL, `sink` has neither `emit` nor `buffer` but has a
+///   capacity, the ring offsets decrease, a coordinate is infinite or NaN, or there are too many points to index
+///   (over 2^29).
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If `sink->buffer` overflowed, in which case it holds the first
+///   `capacity` triangles, or `arena` ran out, or, without one, an allocation failed.
+/// * Whatever `sink->emit` returned, if it wasn't `CAVE_NO_ERROR`.
+CaveError cave_polytri_triangulate_to_sink(cave_PolyTri_Sink* sink, cave_2d_Polygon const* polygon,
+                                           cave_PolyTri_Arena* arena);
+
+/// \brief Triangulates a flat polygon in 3D, as `cave_polytri_triangulate_3d()` does, without allocating.
+///
+/// As `cave_polytri_triangulate_to_sink()`, and with the same returns. The projected points are kept in
+/// `arena` too.
+CaveError cave_polytri_triangulate_3d_to_sink(cave_PolyTri_Sink* sink, cave_3d_Polygon const* polygon,
+                                              cave_PolyTri_Arena* arena);
+
+/// \brief Expands index triangles into the triangles of points they refer to.
+///
+/// \param[out] dest - Where to write `tri_count` triangles.
+/// \param tris - The index triangles, as produced by the other PolyTri functions.
+/// \param tri_count - The number of triangles in `tris`.
+/// \param points - The points `tris` indexes into.
+/// \param point_count - The number of points in `points`.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest`, `tris` or `points` is NULL while `tri_count` isn't 0.
+/// * CAVE_INDEX_ERROR - If a triangle refers to a point past `point_count`. `dest` is left partly written.
+CaveError cave_polytri_to_2d_Triangles(cave_2d_Triangle* dest, cave_Index_Triangle const* tris, size_t tri_count,
+                                       cave_2Point const* points, size_t point_count);
 
 #ifdef __cplusplus
 }
 #endif
-#endif //CAVE_CAVE_PRIMITIES_H
\ No newline at end of file
+#endif //CAVE_CAVE_PRIMITIES_H
@@ -0,0 +1,80 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_PREDICATES_H
+#define CAVE_PREDICATES_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include <stddef.h>
+
+/// \file
+/// Robust geometric predicates, after Shewchuk's "Adaptive Precision Floating-Point Arithmetic and Fast
+/// Robust Geometric Predicates". Each predicate is a determinant whose sign answers a geometric question.
+/// It is first evaluated in plain double precision alongside a bound on its rounding error, and the sign is
+/// returned straight away if the result is further from zero than that bound, which is almost always.
+/// Only when it isn't is the determinant recomputed with exact expansion arithmetic, which is slow but
+/// only ever as precise as it needs to be to settle the sign.
+///
+/// The returned value's sign is always correct, and 0 exactly when the points are degenerate. Its magnitude
+/// only approximates the determinant. Results are meaningless if a coordinate is infinite or NaN.
+
+/// \brief Whether `c` is left of, right of, or on the line through `a` and `b`.
+///
+/// \return Positive if `a`, `b` and `c` turn counter-clockwise (with y up), negative if they turn clockwise,
+///         and 0 if they are collinear. Approximately twice the signed area of the triangle they make.
+double cave_orient2d(cave_2Point a, cave_2Point b, cave_2Point c);
+
+/// \brief Whether `d` is inside, outside, or on the circle through `a`, `b` and `c`.
+///
+/// \return Positive if `d` is inside the circle, negative if it is outside, and 0 if all four points lie on
+///         one circle. The signs are reversed if `a`, `b` and `c` turn clockwise.
+double cave_incircle(cave_2Point a, cave_2Point b, cave_2Point c, cave_2Point d);
+
+/// \brief Whether `d` is above, below, or on the plane through `a`, `b` and `c`.
+///
+/// \return Positive if `d` is below the plane, where "above" is the side from which `a`, `b` and `c` appear
+///         counter-clockwise, negative if it is above, and 0 if the four points are coplanar. Approximately
+///         six times the signed volume of the tetrahedron they make.
+double cave_orient3d(cave_3Point a, cave_3Point b, cave_3Point c, cave_3Point d);
+
+/// \brief Evaluates `cave_orient2d()` over arrays of points.
+///
+/// `dest[i]` is set to `cave_orient2d(a[i], b[i], c[i])`. The error filter runs over blocks of points in
+/// branch-free loops the compiler can vectorize, and only the few results it can't vouch for are recomputed
+/// exactly afterwards.
+///
+/// \param[out] dest - Set to the `count` results.
+/// \param a, b, c - `count` points each.
+/// \param count - The number of triples.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `count` isn't 0 and any array is NULL.
+CaveError cave_orient2d_batch(double* dest, cave_2Point const* a, cave_2Point const* b, cave_2Point const* c,
+                              size_t count);
+
+/// \brief Evaluates `cave_incircle()` over arrays of points, as `cave_orient2d_batch()` does.
+///
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `count` isn't 0 and any array is NULL.
+CaveError cave_incircle_batch(double* dest, cave_2Point const* a, cave_2Point const* b, cave_2Point const* c,
+                              cave_2Point const* d, size_t count);
+
+/// \brief Evaluates `cave_orient3d()` over arrays of points, as `cave_orient2d_batch()` does.
+///
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `count` isn't 0 and any array is NULL.
+CaveError cave_orient3d_batch(double* dest, cave_3Point const* a, cave_3Point const* b, cave_3Point const* c,
+                              cave_3Point const* d, size_t count);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_PREDICATES_H
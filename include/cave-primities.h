@@ -67,6 +67,31 @@ typedef struct cave_Index_Triangle {
     size_t c;
 } cave_Index_Triangle ;
 
+// An edge between two points, given by their indexes into some array of points.
+typedef struct cave_Index_Edge {
+    size_t a;
+    size_t b;
+} cave_Index_Edge;
+
+// A polygon made of one or more rings, eg an outline with holes in it, or several separate outlines.
+// Ring `i` is the points from `points[ring_offsets[i]]` up to but not including `points[ring_offsets[i + 1]]`,
+// so `ring_offsets` holds `ring_count + 1` offsets. Each ring closes back on its first point.
+// Counter-clockwise rings (positive signed area, with y up) are outlines, and clockwise rings are holes.
+typedef struct cave_2d_Polygon {
+    cave_2Point* points;
+    size_t* ring_offsets;
+    size_t ring_count;
+} cave_2d_Polygon;
+
+// As `cave_2d_Polygon`, for a flat polygon in 3D, like a face of a CAD model. With no "up" to wind around,
+// rings are told apart by winding relative to each other: outlines all turn one way and holes the other,
+// and the outlines are the rings that, taken together, enclose more area.
+typedef struct cave_3d_Polygon {
+    cave_3Point* points;
+    size_t* ring_offsets;
+    size_t ring_count;
+} cave_3d_Polygon;
+
 
 
 
@@ -0,0 +1,96 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_SIMPLIFY_H
+#define CAVE_SIMPLIFY_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+/// \file
+/// Simplification of polylines and polygon rings: dropping the points that contribute least to their shape,
+/// so that scanned contours and slice outlines with far more points than their detail needs are cheaper to
+/// triangulate and store.
+///
+/// Both methods drop points one at a time, least important first, until every point left matters more than
+/// the tolerance. A point's importance is fixed up front for Douglas-Peucker and updated as its neighbours go
+/// for Visvalingam-Whyatt. Dropping a point replaces its two edges with one between its neighbours, sweeping
+/// over the triangle the three make. With topology preservation, a point is only dropped if no other point
+/// still in play is in that triangle, which is exactly what it takes for rings that didn't cross each other,
+/// or themselves, not to start doing so, and for holes to stay on the same side of their outline. Points
+/// held back this way are tried again when a neighbour is dropped.
+
+typedef enum cave_Simplify_Method {
+    /// Douglas-Peucker. The tolerance is a distance: every point dropped is within it of the simplified line.
+    /// Points are ranked by the classic recursive splitting, done with an explicit stack.
+    CAVE_SIMPLIFY_DOUGLAS_PEUCKER = 0,
+    /// Visvalingam-Whyatt. The tolerance is an area: the point whose triangle with its neighbours is smallest
+    /// is dropped, until none is smaller than the tolerance. Tends to keep shapes smoother than Douglas-Peucker.
+    CAVE_SIMPLIFY_VISVALINGAM,
+} cave_Simplify_Method;
+
+/// How to simplify. Zeroed, or a NULL pointer in its place, drops only points that are exactly in line with
+/// their neighbours, from an open polyline, by Douglas-Peucker.
+typedef struct cave_Simplify_Options {
+    cave_Simplify_Method method;
+    /// A distance for Douglas-Peucker or an area for Visvalingam-Whyatt. Points that matter no more than this
+    /// are dropped.
+    double tolerance;
+    /// Whether the last point connects back to the first. The ends of an open polyline are always kept, and a
+    /// closed ring keeps at least three points.
+    bool closed;
+    /// Whether to hold back points whose removal would make rings cross. Only applies in 2D.
+    bool preserve_topology;
+} cave_Simplify_Options;
+
+/// \brief Simplifies a polyline or ring of 2D points.
+///
+/// \param[out] kept - Set to a malloc'ed array of the indexes of the points kept, in order, or NULL if
+///                    `point_count` is 0. The caller frees it.
+/// \param[out] kept_count - Set to the number of indexes in `*kept`.
+/// \param points - The polyline.
+/// \param point_count - The number of points in `points`.
+/// \param options - May be NULL to use the defaults.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `kept` or `kept_count` is NULL, `points` is NULL while `point_count` isn't 0, the
+///   tolerance is negative or NaN, a coordinate is infinite or NaN, or there are 2^32 points or more.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+CaveError cave_simplify_2d(size_t** kept, size_t* kept_count, cave_2Point const* points, size_t point_count,
+                           cave_Simplify_Options const* options);
+
+/// \brief Simplifies a polyline or ring of 3D points, as `cave_simplify_2d()` does.
+///
+/// Distances and areas are measured in 3D. `preserve_topology` is ignored, since lines in 3D almost never
+/// cross in the first place.
+CaveError cave_simplify_3d(size_t** kept, size_t* kept_count, cave_3Point const* points, size_t point_count,
+                           cave_Simplify_Options const* options);
+
+/// \brief Simplifies every ring of a polygon, ready to be triangulated.
+///
+/// Every ring is closed, whatever `options->closed` says, and topology preservation looks across rings, so
+/// a simplified outline can't cut through one of its holes. Rings keep their winding.
+///
+/// \param[out] dest - Filled in with malloc'ed `points` and `ring_offsets` of its own, which the caller frees.
+///                    Its rings are those of `polygon`, in order.
+/// \param polygon - The polygon to simplify.
+/// \param options - May be NULL to use the defaults.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `polygon` is NULL, the ring offsets decrease, the tolerance is negative or
+///   NaN, a coordinate is infinite or NaN, or there are 2^32 points or more.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails. `dest` is left empty.
+CaveError cave_simplify_polygon(cave_2d_Polygon* dest, cave_2d_Polygon const* polygon,
+                                cave_Simplify_Options const* options);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_SIMPLIFY_H
@@ -0,0 +1,79 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_SLICE_H
+#define CAVE_SLICE_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include "cave-mesh.h"
+#include "cave-writer.h"
+#include <stddef.h>
+
+/// \file
+/// Slicing a triangle mesh with horizontal planes into the closed outlines where they cut it, layer by layer,
+/// as 3D printing does.
+///
+/// Each triangle's span in z is first turned into the span of layers it crosses, and the triangles are counting
+/// sorted by layer, so that each is visited only for the layers it crosses. The layers are then sliced in
+/// parallel. A triangle crossed by a plane gives a segment between the two edges the plane cuts, and segments
+/// are stitched into loops by a hash on those edges: the edge one segment leaves through is the edge the next
+/// one comes in by, in the triangle on the other side of it.
+///
+/// Corners exactly at a plane's height are taken to be above it, as if the plane were a hair lower, so a plane
+/// only ever cuts edges, never passes through corners, and every triangle it crosses gives exactly one segment.
+/// An edge is cut at a point worked out from its two ends the same way in both triangles that share it, so the
+/// loops come out closed without any tolerance, as long as the mesh is. Edges are told apart by the positions
+/// of their ends, so STL data needs no welding first, and vertexes of an indexed mesh that share a position are
+/// treated as one.
+
+/// The outlines of every layer of a sliced mesh.
+typedef struct cave_Slices {
+    /// One polygon per height, in the order the heights were given, each with malloc'ed `points` and
+    /// `ring_offsets` of its own.
+    ///
+    /// If the mesh is closed and its triangles are wound counter-clockwise seen from outside, as STL files
+    /// should be, outlines come out counter-clockwise seen from above and holes clockwise, just as
+    /// `cave_polytri_triangulate_polygon()` and `cave_polygon_boolean()` take them. A ring's points are where
+    /// it crosses the mesh's edges, so it has one per triangle it passes through.
+    cave_2d_Polygon* layers;
+    size_t layer_count;
+    /// How many rings, across every layer, couldn't be closed, because the mesh has holes or edges shared by
+    /// more than two triangles. They are kept, as if their ends were joined.
+    size_t open_rings;
+} cave_Slices;
+
+/// \brief Slices the triangles of STL data at each of `height_count` heights. Their normals are ignored.
+///
+/// \param[out] dest - Set to the outlines. Release it with `cave_Slices_release()`.
+/// \param data - The triangles to slice.
+/// \param heights - The heights of the planes, in any order, which needn't be distinct.
+/// \param height_count - The number of heights, which may be 0.
+/// \param threads - The most threads to use, counting the calling thread, or 0 for one per hardware thread.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `data` is NULL, `data->tris` or `heights` is NULL while there are triangles
+///   or heights, a height is NaN, or there are 2^32 or more heights.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+/// If any error is returned, `*dest` is left empty and need not be released.
+CaveError cave_STL_Data_slice(cave_Slices* dest, cave_STL_Data const* data, float const* heights,
+                              size_t height_count, size_t threads);
+
+/// \brief Slices the triangles of an indexed mesh at each of `height_count` heights, as `cave_STL_Data_slice()`.
+/// \return Errors as `cave_STL_Data_slice()`, and CAVE_DATA_ERROR if a triangle refers to a vertex past
+/// `mesh->vert_count`, or there are 2^32 or more triangles.
+CaveError cave_Mesh_slice(cave_Slices* dest, cave_Mesh const* mesh, float const* heights, size_t height_count,
+                          size_t threads);
+
+/// \brief Frees the memory held by `slices`, and sets its members to NULL and 0. `slices` may be NULL.
+void cave_Slices_release(cave_Slices* slices);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_SLICE_H
@@ -10,9 +10,16 @@ extern "C" {
 
 #include "cave-error.h"
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
 
 long cave_file_len(FILE* file);
 
+//Computes a fast, non-cryptographic 64 bit hash of `len` bytes starting at `bytes`.
+//The result is identical to XXH64 with the same seed, so it can be checked against other
+//xxHash implementations. `bytes` may be NULL only if `len` is 0.
+uint64_t cave_hash64(void const* bytes, size_t len, uint64_t seed);
+
 
 #ifdef __cplusplus
 }
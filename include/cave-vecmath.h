@@ -0,0 +1,190 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_VECMATH_H
+#define CAVE_VECMATH_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include <stddef.h>
+
+/// \file
+/// Batch vector math over arrays of points: adding, elementwise minimums and maximums, scaling, dot and cross
+/// products, normalizing, bounds and affine or projective transforms, so callers don't each roll their own scalar
+/// loops.
+///
+/// Every kernel comes in scalar, SSE2 and AVX2 flavours, and the fastest one the host supports is used, unless
+/// a lower one has been forced (see cave-cpu.h). The flavours agree bit for bit: none of them fuses multiplies
+/// and adds, and sums are taken in the same order, so results don't depend on the machine they were computed on.
+///
+/// Arrays of `cave_3Point`s and `cave_2Point`s can be passed as they are. Points stored any other way, as
+/// separate x, y and z streams, or as the corners of `cave_STL_Tri`s, are described by a `cave_Vec3_Array`.
+/// A destination may be the same array as a source, but may not otherwise overlap one.
+
+/// Where the coordinates of an array of 3D vectors are. Element `i` is
+/// `(x[i * stride], y[i * stride], z[i * stride])`.
+///
+/// * Separate streams of floats (SoA) - `{xs, ys, zs, 1}`.
+/// * An array of `cave_3Point`s (AoS) - `{&points->x, &points->y, &points->z, 3}`.
+/// * The first corners of an array of `cave_STL_Tri`s - `{&tris->a.x, &tris->a.y, &tris->a.z,
+///   sizeof(cave_STL_Tri) / sizeof(float)}`.
+///
+/// Streams and packed `cave_3Point`s are the fast cases; other strides are gathered a float at a time.
+/// Arrays passed as sources are only read, despite their pointers not being const.
+typedef struct cave_Vec3_Array {
+    float* x;
+    float* y;
+    float* z;
+    /// The number of floats from one element to the next. Not 0.
+    size_t stride;
+} cave_Vec3_Array;
+
+/// \brief Sets `dest[i] = a[i] + b[i]` for each of `count` vectors.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If an array is NULL while `count` isn't 0.
+CaveError cave_vec3_add(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count);
+
+/// \brief Sets `dest[i] = a[i] - b[i]` for each of `count` vectors. Errors as `cave_vec3_add()`.
+CaveError cave_vec3_sub(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count);
+
+/// \brief Sets each coordinate of `dest[i]` to the smaller of those of `a[i]` and `b[i]`, for each of `count`
+/// vectors. Where either is NaN, or they are zeros of opposite sign, `b[i]`'s is taken.
+/// Errors as `cave_vec3_add()`.
+CaveError cave_vec3_min(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count);
+
+/// \brief As `cave_vec3_min()`, taking the larger of each coordinate.
+CaveError cave_vec3_max(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count);
+
+/// \brief Sets `dest[i] = src[i] * scale` for each of `count` vectors. Errors as `cave_vec3_add()`.
+CaveError cave_vec3_scale(cave_3Point* dest, cave_3Point const* src, float scale, size_t count);
+
+/// \brief Sets `dest[i]` to the dot product of `a[i]` and `b[i]` for each of `count` vectors.
+/// Errors as `cave_vec3_add()`.
+CaveError cave_vec3_dot(float* dest, cave_3Point const* a, cave_3Point const* b, size_t count);
+
+/// \brief Sets `dest[i]` to the cross product of `a[i]` and `b[i]` for each of `count` vectors.
+/// Errors as `cave_vec3_add()`.
+CaveError cave_vec3_cross(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count);
+
+/// \brief Scales each of `count` vectors to unit length. Zero vectors stay zero.
+/// Errors as `cave_vec3_add()`.
+CaveError cave_vec3_normalize(cave_3Point* dest, cave_3Point const* src, size_t count);
+
+/// \brief Finds the smallest box around `count` points.
+///
+/// \param[out] min - Set to the smallest x, y and z of the points, or to infinity if `count` is 0.
+/// \param[out] max - Set to the largest x, y and z of the points, or to minus infinity if `count` is 0.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `min` or `max` is NULL, or `points` is NULL while `count` isn't 0.
+CaveError cave_vec3_bounds(cave_3Point* min, cave_3Point* max, cave_3Point const* points, size_t count);
+
+/// \brief Transforms `count` points by an affine transform.
+///
+/// \param matrix - A row major 3x4 matrix, as `cave_STL_Transform` holds. A point p maps to
+///                 `(m[0..2] . p + m[3], m[4..6] . p + m[7], m[8..10] . p + m[11])`.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `matrix` is NULL, or an array is NULL while `count` isn't 0.
+CaveError cave_vec3_transform_affine(cave_3Point* dest, cave_3Point const* src, float const* matrix,
+                                     size_t count);
+
+/// \brief Transforms `count` points by a projective transform, dividing through by w.
+///
+/// \param matrix - A row major 4x4 matrix. A point p maps to `(m[0..3] . p', m[4..7] . p', m[8..11] . p')`
+///                 divided by `m[12..15] . p'`, where p' is p with a w of 1. Points that map to a w of 0
+///                 come out infinite or NaN.
+/// \return Errors as `cave_vec3_transform_affine()`.
+CaveError cave_vec3_transform(cave_3Point* dest, cave_3Point const* src, float const* matrix, size_t count);
+
+/// \brief As `cave_vec3_add()`, for arrays laid out any way.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If an array, or one of its pointers, is NULL while `count` isn't 0, or has a stride
+///   of 0.
+CaveError cave_vec3_array_add(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                              size_t count);
+
+/// \brief As `cave_vec3_sub()`, for arrays laid out any way. Errors as `cave_vec3_array_add()`.
+CaveError cave_vec3_array_sub(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                              size_t count);
+
+/// \brief As `cave_vec3_min()`, for arrays laid out any way. Errors as `cave_vec3_array_add()`.
+CaveError cave_vec3_array_min(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                              size_t count);
+
+/// \brief As `cave_vec3_max()`, for arrays laid out any way. Errors as `cave_vec3_array_add()`.
+CaveError cave_vec3_array_max(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                              size_t count);
+
+/// \brief As `cave_vec3_scale()`, for arrays laid out any way. Errors as `cave_vec3_array_add()`.
+CaveError cave_vec3_array_scale(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, float scale,
+                                size_t count);
+
+/// \brief As `cave_vec3_dot()`, for arrays laid out any way. `dest` is a plain array of `count` floats.
+/// Errors as `cave_vec3_array_add()`.
+CaveError cave_vec3_array_dot(float* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b, size_t count);
+
+/// \brief As `cave_vec3_cross()`, for arrays laid out any way. Errors as `cave_vec3_array_add()`.
+CaveError cave_vec3_array_cross(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                                size_t count);
+
+/// \brief As `cave_vec3_normalize()`, for arrays laid out any way. Errors as `cave_vec3_array_add()`.
+CaveError cave_vec3_array_normalize(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, size_t count);
+
+/// \brief As `cave_vec3_bounds()`, for arrays laid out any way. Errors as `cave_vec3_array_add()`, and if
+/// `min` or `max` is NULL.
+CaveError cave_vec3_array_bounds(cave_3Point* min, cave_3Point* max, cave_Vec3_Array const* points, size_t count);
+
+/// \brief As `cave_vec3_transform_affine()`, for arrays laid out any way. Errors as `cave_vec3_array_add()`,
+/// and if `matrix` is NULL.
+CaveError cave_vec3_array_transform_affine(cave_Vec3_Array const* dest, cave_Vec3_Array const* src,
+                                           float const* matrix, size_t count);
+
+/// \brief As `cave_vec3_transform()`, for arrays laid out any way. Errors as `cave_vec3_array_add()`, and if
+/// `matrix` is NULL.
+CaveError cave_vec3_array_transform(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, float const* matrix,
+                                    size_t count);
+
+/// \brief Sets `dest[i] = a[i] + b[i]` for each of `count` 2D vectors. Errors as `cave_vec3_add()`.
+CaveError cave_vec2_add(cave_2Point* dest, cave_2Point const* a, cave_2Point const* b, size_t count);
+
+/// \brief Sets `dest[i] = a[i] - b[i]` for each of `count` 2D vectors. Errors as `cave_vec3_add()`.
+CaveError cave_vec2_sub(cave_2Point* dest, cave_2Point const* a, cave_2Point const* b, size_t count);
+
+/// \brief As `cave_vec3_min()`, for `count` 2D vectors.
+CaveError cave_vec2_min(cave_2Point* dest, cave_2Point const* a, cave_2Point const* b, size_t count);
+
+/// \brief As `cave_vec3_max()`, for `count` 2D vectors.
+CaveError cave_vec2_max(cave_2Point* dest, cave_2Point const* a, cave_2Point const* b, size_t count);
+
+/// \brief Sets `dest[i] = src[i] * scale` for each of `count` 2D vectors. Errors as `cave_vec3_add()`.
+CaveError cave_vec2_scale(cave_2Point* dest, cave_2Point const* src, float scale, size_t count);
+
+/// \brief Sets `dest[i]` to the dot product of `a[i]` and `b[i]` for each of `count` 2D vectors.
+/// Errors as `cave_vec3_add()`.
+CaveError cave_vec2_dot(float* dest, cave_2Point const* a, cave_2Point const* b, size_t count);
+
+/// \brief Finds the smallest rectangle around `count` 2D points, as `cave_vec3_bounds()` does.
+CaveError cave_vec2_bounds(cave_2Point* min, cave_2Point* max, cave_2Point const* points, size_t count);
+
+/// \brief Transforms `count` 2D points by an affine transform.
+///
+/// \param matrix - A row major 2x3 matrix. A point p maps to `(m[0..1] . p + m[2], m[3..4] . p + m[5])`.
+/// \return Errors as `cave_vec3_transform_affine()`.
+CaveError cave_vec2_transform_affine(cave_2Point* dest, cave_2Point const* src, float const* matrix,
+                                     size_t count);
+
+/// \brief Names the flavour of kernels in use: "scalar", "sse2" or "avx2". Paths without vector kernels of their
+/// own use those of the path below, so eg the "sse4.1" path uses "sse2".
+char const* cave_vecmath_path(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_VECMATH_H
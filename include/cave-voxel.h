@@ -0,0 +1,122 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_VOXEL_H
+#define CAVE_VOXEL_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "cave-primities.h"
+#include "cave-error.h"
+#include "cave-writer.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/// \file
+/// Voxelizing a triangle mesh into a grid of occupied cubes, for printability checks and collision proxies.
+///
+/// A voxel is occupied if any triangle touches it, tested exactly with the separating axis theorem, so the
+/// surface is rasterized conservatively and never has gaps. For closed meshes, the interior can be filled as
+/// well: along each row of voxels in x, a voxel is inside if a ray from its center towards minus x crosses the
+/// surface an odd number of times. A ray through an edge or corner shared by several triangles is counted as
+/// crossing just one of them, by the same top-left rule rasterizers use, so rows don't streak.
+///
+/// The grid is cut into slabs `CAVE_VOXEL_BRICK` voxels thick in z, and triangles are counting sorted by the
+/// slabs they reach, so that slabs can be voxelized on separate threads, each only looking at its own
+/// triangles and writing only its own voxels.
+///
+/// The result is either a dense bitset, one bit per voxel, or a sparse map of bricks of `CAVE_VOXEL_BRICK`
+/// voxels a side, in which empty and completely full bricks take no memory beyond their entry in the map. A
+/// filled grid of a large domain then takes memory in proportion to the bricks its surface passes through.
+
+/// The width of a brick, and the thickness of the slabs work is split into, in voxels.
+#define CAVE_VOXEL_BRICK (8)
+/// Marks a brick of a sparse `cave_Voxels` with no voxel occupied.
+#define CAVE_VOXEL_EMPTY (UINT32_MAX)
+/// Marks a brick of a sparse `cave_Voxels` with every voxel occupied.
+#define CAVE_VOXEL_FULL (UINT32_MAX - 1)
+
+/// How to voxelize.
+typedef struct cave_Voxel_Options {
+    /// The corner of the grid with the lowest x, y and z.
+    cave_3Point origin;
+    /// The width of a voxel.
+    float voxel_size;
+    /// How many voxels the grid has along each axis. Voxel (x, y, z) spans from `origin + voxel_size * (x, y, z)`
+    /// to `origin + voxel_size * (x + 1, y + 1, z + 1)`.
+    size_t size_x;
+    size_t size_y;
+    size_t size_z;
+    /// Whether to fill the inside of the mesh, which should then be closed, as well as its surface.
+    bool fill;
+    /// Whether to make a sparse brick map rather than a dense bitset.
+    bool sparse;
+    /// The most threads to use, counting the calling thread, or 0 for one per hardware thread.
+    size_t threads;
+} cave_Voxel_Options;
+
+/// A voxelized mesh. Its members may be read freely but should not be modified. Read single voxels with
+/// `cave_Voxels_get()`.
+typedef struct cave_Voxels {
+    cave_3Point origin;
+    float voxel_size;
+    size_t size_x;
+    size_t size_y;
+    size_t size_z;
+
+    /// For a dense grid, a bit per voxel, or NULL for a sparse one. Each row of voxels along x starts a new word,
+    /// taking `words_per_row` words, and voxel (x, y, z) is bit `x % 64` of word
+    /// `(z * size_y + y) * words_per_row + x / 64`.
+    uint64_t* bits;
+    size_t words_per_row;
+
+    /// For a sparse grid, how many bricks there are along each axis, or 0 for a dense one.
+    size_t bricks_x;
+    size_t bricks_y;
+    size_t bricks_z;
+    /// For each brick, `CAVE_VOXEL_EMPTY`, `CAVE_VOXEL_FULL`, or else which of `bricks` holds its voxels. Brick
+    /// (x, y, z) is entry `(z * bricks_y + y) * bricks_x + x`.
+    uint32_t* brick_map;
+    /// The bricks with some voxels occupied and some not, `CAVE_VOXEL_BRICK` words each. Voxel (x, y, z) within
+    /// a brick is bit `x + 8 * y` of its word `z`.
+    uint64_t* bricks;
+    size_t brick_count;
+} cave_Voxels;
+
+/// \brief Voxelizes `tri_count` triangles. Parts of them outside the grid are clipped away.
+///
+/// \param[out] dest - Set to the voxels. Release it with `cave_Voxels_release()`.
+/// \param tris - The triangles.
+/// \param tri_count - The number of triangles, which may be 0.
+/// \param options - The grid to voxelize into, and how.
+/// \return
+/// * CAVE_NO_ERROR - On success.
+/// * CAVE_DATA_ERROR - If `dest` or `options` is NULL, `tris` is NULL while `tri_count` isn't 0, there are 2^32
+///   or more triangles, `options->voxel_size` isn't positive and finite, or the grid has no voxels or more than
+///   2^31 along an axis.
+/// * CAVE_INSUFFICIENT_MEMORY_ERROR - If an allocation fails.
+/// * CAVE_UNKNOWN_ERROR - If the threads couldn't be coordinated.
+/// If any error is returned, `*dest` is left empty and need not be released.
+CaveError cave_voxelize(cave_Voxels* dest, cave_3d_Triangle const* tris, size_t tri_count,
+                        cave_Voxel_Options const* options);
+
+/// \brief Voxelizes the triangles of STL data, as `cave_voxelize()`. Their normals are ignored.
+/// \return Errors as `cave_voxelize()`.
+CaveError cave_STL_Data_voxelize(cave_Voxels* dest, cave_STL_Data const* data, cave_Voxel_Options const* options);
+
+/// \brief Frees the memory held by `voxels`, and sets its members to NULL and 0. `voxels` may be NULL.
+void cave_Voxels_release(cave_Voxels* voxels);
+
+/// \brief Whether voxel (x, y, z) is occupied. False if `voxels` is NULL or the voxel is outside the grid.
+bool cave_Voxels_get(cave_Voxels const* voxels, size_t x, size_t y, size_t z);
+
+/// \brief How many voxels are occupied. 0 if `voxels` is NULL.
+size_t cave_Voxels_count(cave_Voxels const* voxels);
+
+#ifdef __cplusplus
+}
+#endif
+#endif //CAVE_VOXEL_H
@@ -12,6 +12,7 @@ extern "C" {
 #include "cave-error.h"
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 typedef struct cave_STL_Tri {
     cave_3Point normal;
@@ -47,10 +48,92 @@ size_t cave_Sizeof_STL_Data(cave_STL_Data* data);
 //assumed `*dest` can properly have the appropriate number of bytes written to it.
 CaveError cave_STL_Data_to_Bytes(uint8_t** dest, cave_STL_Data* src);
 
+#define CAVE_STL_LOAD_DEFAULT_BUFFER_SIZE (1 << 20)
+#define CAVE_STL_LOAD_DEFAULT_BUFFER_COUNT (4)
+
+//Tuning for `cave_file_to_STL_Data()`. Any member left as 0 gets its default.
+//`buffer_size` is the number of bytes read at a time, rounded down to a whole number of triangles.
+//`buffer_count` is the number of buffers in the ring, ie how far reading may run ahead of decoding.
+//`decode_threads` is the number of threads decoding, counting the calling thread. Defaults to one
+//less than the number of hardware threads, leaving one for the reader.
+typedef struct cave_STL_Load_Options {
+    size_t buffer_size;
+    size_t buffer_count;
+    size_t decode_threads;
+} cave_STL_Load_Options;
+
+//Reads the binary STL file at `path` into `dest`, overlapping reading with decoding.
+//A reader thread reads the file in `buffer_size` chunks into a ring of buffers, while decoder threads
+//decode filled buffers straight into `dest->tris`, so loading takes about as long as the slower of the
+//two rather than their sum. Only one whole-file allocation is made, for `dest->tris`.
+//If Cave is built without threads, the file is read and decoded one chunk at a time on the calling thread.
+//`options` may be NULL to use the defaults. The same validation as `cave_bytes_to_STL_Data` applies, and
+//as there, if any error is returned `*dest` is not valid but need not be released.
+//Returns `CAVE_FILE_ERROR` if the file can't be opened or read, and `CAVE_DATA_ERROR` if it is malformed.
+CaveError cave_file_to_STL_Data(cave_STL_Data* dest, char const* path, cave_STL_Load_Options const* options);
+
+//The number of triangles a `cave_STL_Appender` buffers before writing them out.
+#define CAVE_STL_APPENDER_BUFFER_TRIS (4096)
+
+//A binary STL file that triangles can be appended to a batch at a time, for meshes that are generated
+//piece by piece and never held in memory all at once. Triangles are encoded into a small write buffer
+//and written straight to the file. The `tri_count` field in the file header is only brought up to date
+//by `cave_STL_Appender_flush()` and `cave_STL_Appender_close()`. Once a write fails, the appender has
+//failed for good: what reached the disk isn't known, so every later append, flush or close returns
+//`CAVE_FILE_ERROR` without touching the header.
+//Members should not be modified directly. `tri_count` is the number of triangles written to the file so far,
+//not counting the `buffered` ones.
+typedef struct cave_STL_Appender {
+    FILE* fp;
+    uint32_t tri_count;
+    uint8_t* buffer;
+    size_t buffered;
+    bool failed;
+} cave_STL_Appender;
+
+//Opens `path` for appending triangles.
+//If `resume` is true and `path` is an existing binary STL file, new triangles go after its existing ones.
+//The triangle count is taken from the file's length rather than its header, which recovers every whole
+//triangle written by an appender that was never closed. Otherwise `path` is created (or truncated) and
+//given `header`, or an all zero header if `header` is NULL. `header` must be 80 bytes.
+//Returns `CAVE_FILE_ERROR` if the file can't be opened or written, and `CAVE_DATA_ERROR` if resuming a
+//file whose length isn't that of a binary STL file.
+CaveError cave_STL_Appender_open(cave_STL_Appender* app, char const* path, uint8_t const* header, bool resume);
+
+//Appends `count` triangles from `tris`.
+//Returns `CAVE_DATA_ERROR` if the file would hold more triangles than STL can count, and `CAVE_FILE_ERROR`
+//if writing fails.
+CaveError cave_STL_Appender_append(cave_STL_Appender* app, cave_STL_Tri const* tris, size_t count);
+
+//Writes out buffered triangles, and then patches the triangle count at bytes 80-83 of the file.
+//After a flush, the file on disk is a complete and valid STL file.
+CaveError cave_STL_Appender_flush(cave_STL_Appender* app);
+
+//Flushes and closes the file, and frees the write buffer. `app` may not be used again until reopened.
+//The file is closed and the buffer freed even if the appender has failed.
+CaveError cave_STL_Appender_close(cave_STL_Appender* app);
+
+//A row major 3x4 affine transform. A point p maps to (m[0..2] . p + m[3], m[4..6] . p + m[7], m[8..10] . p + m[11]).
+typedef struct cave_STL_Transform {
+    float m[12];
+} cave_STL_Transform;
+
+//Concatenates the binary STL files in `src_paths` into one file at `dest_path`.
+//Every input's header and `tri_count` are validated before the output is created. Triangle records
+//are then copied verbatim without being decoded, using `copy_file_range` where the platform has it.
+//`transforms` may be NULL, and so may any of its `src_count` entries. Only the inputs that have a
+//transform are decoded, transformed (normals included) by the vector kernels, and re-encoded. `header`
+//is the 80 byte header for the output, or NULL for all zeros.
+//Returns `CAVE_FILE_ERROR` if a file can't be opened, read or written, and `CAVE_DATA_ERROR` if an
+//input is not a binary STL file, `dest_path` names one of the inputs, or the inputs together hold more
+//triangles than STL can count. On error the output file is removed, unless it is an input.
+CaveError cave_STL_merge_files(char const* dest_path, char const* const* src_paths, size_t src_count,
+                               cave_STL_Transform const* const* transforms, uint8_t const* header);
+
 
 
 
 #ifdef __cplusplus
 }
 #endif
-#endif //CAVE_CAVE_PRIMITIES_H
\ No newline at end of file
+#endif //CAVE_WRITER_H
\ No newline at end of file
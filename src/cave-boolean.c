@@ -0,0 +1,916 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-boolean.h"
+#include "cave-polytri-internal.h"
+#include "cave-predicates-internal.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+//Every edge of both polygons is a segment with an event at each end, and the events are swept in order of
+//x and then y. The segments crossing the sweep line are kept in a treap, ordered from bottom to top. When a
+//segment goes in, it is checked against the segments either side of it, and when one comes out, the two it
+//separated are checked against each other. Segments that cross are split where they do, so by the end no
+//two segments cross, and two that overlapped have become identical pieces. Before each event is swept, any
+//segment whose inside its point lies on, as decided exactly, is split there too, so that an end touching
+//another segment part way along is ordered against the pieces of it rather than against the whole.
+//
+//Each segment carries how many times the subject and the clip wind around the region just below it and the
+//region just above it. Above is below plus the segment's own winding, and below is what is above the segment
+//under it, so they are worked out as each goes into the treap. A vertical segment stands in the sweep line
+//rather than across it, and taking the sweep line as leaning very slightly makes "below" it its right side.
+//Segments starting the same way are cut to the shortest and folded into one as they go in, which winds as all
+//of them do, and of a stack of identical segments made by splitting, only the top one is kept, with the windings
+//of the whole stack.
+//
+//A segment is in the result if the operation is true on one side of it and not the other. Result edges are
+//turned to run with the result on their left, which makes outlines counter-clockwise and holes clockwise, and
+//chained into rings by always taking the sharpest turn available, so rings that touch at a point stay apart.
+
+#define CAVE_BOOLEAN_NIL (UINT32_MAX)
+
+typedef struct hidden_cave_Bool_Event {
+    double x;
+    double y;
+    uint32_t other; //the event at the other end of the segment
+    uint32_t edge; //the left end of the input edge the segment is a piece of, whose right end is the event after it
+    //the status is a treap of the left ends of the segments crossing the sweep line
+    uint32_t tree_left;
+    uint32_t tree_right;
+    uint32_t parent;
+    uint32_t priority;
+    int32_t below[2]; //of a left end, the windings of the subject and clip just below the segment
+    int32_t above[2];
+    //how many more times the rings of the subject and of the clip run from this end of the segment to the other
+    //than the other way
+    int32_t wind[2];
+    bool left;
+    bool subject;
+    bool in_status;
+    bool merged; //of a left end, an identical segment speaks for this one
+} hidden_cave_Bool_Event;
+
+typedef struct hidden_cave_Boolean {
+    hidden_cave_Bool_Event* events;
+    uint32_t event_count;
+    uint32_t event_cap;
+    uint32_t* queue; //a min-heap of the events yet to be swept
+    uint32_t queue_len;
+    uint32_t root;
+    uint32_t seed;
+    cave_Boolean_Operation operation;
+    CaveError err; //set if splitting a segment couldn't allocate
+} hidden_cave_Boolean;
+
+//a result edge, running with the result on its left
+typedef struct hidden_cave_Bool_Edge {
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+    uint32_t next;
+    bool visited;
+} hidden_cave_Bool_Edge;
+
+#define E(idx) (b->events + (idx))
+
+static double hidden_cave_bool_orient(hidden_cave_Bool_Event const* p, hidden_cave_Bool_Event const* q,
+                                      hidden_cave_Bool_Event const* r) {
+    double pa[2] = {p->x, p->y}, pb[2] = {q->x, q->y}, pc[2] = {r->x, r->y};
+    return hidden_cave_orient2d(pa, pb, pc);
+}
+
+static bool hidden_cave_bool_same_point(hidden_cave_Bool_Event const* p, hidden_cave_Bool_Event const* q) {
+    return p->x == q->x && p->y == q->y;
+}
+
+//whether `p` is above the segment `e` is an end of
+static bool hidden_cave_bool_below(hidden_cave_Boolean const* b, uint32_t e, hidden_cave_Bool_Event const* p) {
+    hidden_cave_Bool_Event const* start = E(e)->left ? E(e) : E(E(e)->other);
+    hidden_cave_Bool_Event const* end = E(e)->left ? E(E(e)->other) : E(e);
+    return hidden_cave_bool_orient(start, end, p) > 0;
+}
+
+static bool hidden_cave_bool_identical(hidden_cave_Boolean const* b, uint32_t i, uint32_t j) {
+    return hidden_cave_bool_same_point(E(i), E(j)) && hidden_cave_bool_same_point(E(E(i)->other), E(E(j)->other));
+}
+
+//whether the segments of events `i` and `j`, which are at the same point, run along one line, either exactly or as
+//pieces of input edges on one line that were rounded off of it where they were split
+static bool hidden_cave_bool_along(hidden_cave_Boolean const* b, uint32_t i, uint32_t j) {
+    hidden_cave_Bool_Event const* p0 = E(E(i)->edge);
+    hidden_cave_Bool_Event const* p1 = E(E(i)->edge + 1);
+    if(hidden_cave_bool_orient(E(i), E(E(i)->other), E(E(j)->other)) == 0) {
+        return true;
+    }
+    return hidden_cave_bool_orient(p0, p1, E(E(j)->edge)) == 0 &&
+           hidden_cave_bool_orient(p0, p1, E(E(j)->edge + 1)) == 0;
+}
+
+static bool hidden_cave_bool_vertical(hidden_cave_Boolean const* b, uint32_t e) {
+    return E(e)->x == E(E(e)->other)->x;
+}
+
+//the order events are swept in: by x, then y, then right ends before left ones, then lower segments first
+static int hidden_cave_bool_compare_events(hidden_cave_Boolean const* b, uint32_t i, uint32_t j) {
+    if(i == j) {
+        return 0;
+    }
+    hidden_cave_Bool_Event const* p = E(i);
+    hidden_cave_Bool_Event const* q = E(j);
+    if(p->x != q->x) {
+        return p->x > q->x ? 1 : -1;
+    }
+    if(p->y != q->y) {
+        return p->y > q->y ? 1 : -1;
+    }
+    if(p->left != q->left) {
+        return p->left ? 1 : -1;
+    }
+    if(!hidden_cave_bool_along(b, i, j)) {
+        return hidden_cave_bool_below(b, i, E(q->other)) ? -1 : 1;
+    }
+    //on one line, nearer other ends first, so identical segments come one after another
+    if(E(p->other)->x != E(q->other)->x) {
+        return E(p->other)->x > E(q->other)->x ? 1 : -1;
+    }
+    if(E(p->other)->y != E(q->other)->y) {
+        return E(p->other)->y > E(q->other)->y ? 1 : -1;
+    }
+    if(p->subject != q->subject) {
+        return p->subject ? -1 : 1;
+    }
+    return i < j ? -1 : 1;
+}
+
+//the order segments, given by their left ends, cross the sweep line, from bottom to top
+static int hidden_cave_bool_compare_segments(hidden_cave_Boolean const* b, uint32_t i, uint32_t j) {
+    if(i == j) {
+        return 0;
+    }
+    hidden_cave_Bool_Event const* p = E(i);
+    hidden_cave_Bool_Event const* q = E(j);
+    if(hidden_cave_bool_orient(p, E(p->other), q) != 0 || hidden_cave_bool_orient(p, E(p->other), E(q->other)) != 0) {
+        if(hidden_cave_bool_same_point(p, q)) {
+            return hidden_cave_bool_below(b, i, E(q->other)) ? -1 : 1;
+        }
+        if(p->x == q->x) {
+            return p->y < q->y ? -1 : 1;
+        }
+        //compared where the one that went in later starts
+        if(hidden_cave_bool_compare_events(b, i, j) > 0) {
+            return hidden_cave_bool_below(b, j, p) ? 1 : -1;
+        }
+        return hidden_cave_bool_below(b, i, q) ? -1 : 1;
+    }
+    if(p->subject != q->subject) {
+        return p->subject ? -1 : 1;
+    }
+    return hidden_cave_bool_compare_events(b, i, j) > 0 ? 1 : -1;
+}
+
+static void hidden_cave_bool_queue_push(hidden_cave_Boolean* b, uint32_t e) {
+    uint32_t at = b->queue_len++;
+    while(at > 0) {
+        uint32_t parent = (at - 1) / 2;
+        if(hidden_cave_bool_compare_events(b, b->queue[parent], e) <= 0) {
+            break;
+        }
+        b->queue[at] = b->queue[parent];
+        at = parent;
+    }
+    b->queue[at] = e;
+}
+
+static uint32_t hidden_cave_bool_queue_pop(hidden_cave_Boolean* b) {
+    uint32_t top = b->queue[0];
+    uint32_t e = b->queue[--b->queue_len];
+    uint32_t at = 0;
+    for(;;) {
+        uint32_t child = 2 * at + 1;
+        if(child >= b->queue_len) {
+            break;
+        }
+        if(child + 1 < b->queue_len && hidden_cave_bool_compare_events(b, b->queue[child + 1], b->queue[child]) < 0) {
+            child++;
+        }
+        if(hidden_cave_bool_compare_events(b, e, b->queue[child]) <= 0) {
+            break;
+        }
+        b->queue[at] = b->queue[child];
+        at = child;
+    }
+    b->queue[at] = e;
+    return top;
+}
+
+//adds an event, growing the events and the queue if need be, with `wind` the winding of the polygon it is
+//from. Returns CAVE_BOOLEAN_NIL if they can't grow.
+static uint32_t hidden_cave_bool_add_event(hidden_cave_Boolean* b, double x, double y, bool left, bool subject,
+                                           int32_t wind, uint32_t other) {
+    if(b->event_count == b->event_cap) {
+        if(b->event_cap >= CAVE_BOOLEAN_NIL / 2) {
+            return CAVE_BOOLEAN_NIL;
+        }
+        uint32_t cap = 2 * b->event_cap;
+        hidden_cave_Bool_Event* events = realloc(b->events, sizeof(hidden_cave_Bool_Event) * cap);
+        if(!events) {
+            return CAVE_BOOLEAN_NIL;
+        }
+        b->events = events;
+        uint32_t* queue = realloc(b->queue, sizeof(uint32_t) * cap);
+        if(!queue) {
+            return CAVE_BOOLEAN_NIL;
+        }
+        b->queue = queue;
+        b->event_cap = cap;
+    }
+    hidden_cave_Bool_Event* e = E(b->event_count);
+    hidden_cave_Bool_Event blank = {0};
+    *e = blank;
+    e->x = x;
+    e->y = y;
+    e->other = other;
+    e->left = left;
+    e->subject = subject;
+    e->wind[subject ? 0 : 1] = wind;
+    return b->event_count++;
+}
+
+static bool hidden_cave_bool_at(hidden_cave_Bool_Event const* e, double x, double y) {
+    return e->x == x && e->y == y;
+}
+
+//the segment directly below `e` in the status
+static uint32_t hidden_cave_bool_status_prev(hidden_cave_Boolean const* b, uint32_t e) {
+    if(E(e)->tree_left != CAVE_BOOLEAN_NIL) {
+        e = E(e)->tree_left;
+        while(E(e)->tree_right != CAVE_BOOLEAN_NIL) {
+            e = E(e)->tree_right;
+        }
+        return e;
+    }
+    uint32_t p = E(e)->parent;
+    while(p != CAVE_BOOLEAN_NIL && E(p)->tree_left == e) {
+        e = p;
+        p = E(p)->parent;
+    }
+    return p;
+}
+
+//the segment directly above `e` in the status
+static uint32_t hidden_cave_bool_status_next(hidden_cave_Boolean const* b, uint32_t e) {
+    if(E(e)->tree_right != CAVE_BOOLEAN_NIL) {
+        e = E(e)->tree_right;
+        while(E(e)->tree_left != CAVE_BOOLEAN_NIL) {
+            e = E(e)->tree_left;
+        }
+        return e;
+    }
+    uint32_t p = E(e)->parent;
+    while(p != CAVE_BOOLEAN_NIL && E(p)->tree_right == e) {
+        e = p;
+        p = E(p)->parent;
+    }
+    return p;
+}
+
+//splits the segment whose left end is `se` at (x, y), which is strictly between its ends. Returns whether it
+//was split.
+static bool hidden_cave_bool_divide(hidden_cave_Boolean* b, uint32_t se, double x, double y) {
+    hidden_cave_Bool_Event const* start = E(se);
+    hidden_cave_Bool_Event const* end = E(start->other);
+    //a crossing rounded onto or past an end would leave a piece that runs backwards, so it isn't split there
+    if(x < start->x || (x == start->x && y <= start->y) || x > end->x || (x == end->x && y >= end->y)) {
+        return false;
+    }
+    uint32_t other = start->other;
+    bool subject = start->subject;
+    uint32_t r = hidden_cave_bool_add_event(b, x, y, false, subject, 0, se);
+    uint32_t l = r == CAVE_BOOLEAN_NIL ? r : hidden_cave_bool_add_event(b, x, y, true, subject, 0, other);
+    if(l == CAVE_BOOLEAN_NIL) {
+        b->err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+        return false;
+    }
+    for(int k = 0; k < 2; k++) {
+        E(l)->wind[k] = E(se)->wind[k];
+        E(r)->wind[k] = -E(se)->wind[k];
+    }
+    E(other)->other = l;
+    E(se)->other = r;
+    E(l)->edge = E(se)->edge;
+    E(r)->edge = E(se)->edge;
+    hidden_cave_bool_queue_push(b, l);
+    hidden_cave_bool_queue_push(b, r);
+    return true;
+}
+
+//splits the segment whose left end is `se` at (x, y) like `hidden_cave_bool_divide()`, along with those next to it
+//in the status that are identical to it, which stand for the same stretch of edge and have to stay identical
+//even where (x, y) was rounded off of it
+static void hidden_cave_bool_divide_stack(hidden_cave_Boolean* b, uint32_t se, double x, double y) {
+    double x0 = E(se)->x, y0 = E(se)->y, x1 = E(E(se)->other)->x, y1 = E(E(se)->other)->y;
+    uint32_t at = se;
+    for(uint32_t prev = hidden_cave_bool_status_prev(b, at); prev != CAVE_BOOLEAN_NIL &&
+        hidden_cave_bool_at(E(prev), x0, y0) && hidden_cave_bool_at(E(E(prev)->other), x1, y1);
+        prev = hidden_cave_bool_status_prev(b, at)) {
+        at = prev;
+    }
+    for(; at != CAVE_BOOLEAN_NIL && hidden_cave_bool_at(E(at), x0, y0) && hidden_cave_bool_at(E(E(at)->other), x1, y1);
+          at = hidden_cave_bool_status_next(b, at)) {
+        hidden_cave_bool_divide(b, at, x, y);
+    }
+}
+
+//whether `x`, `y` lies within the span of the segment whose left end is `s`, in the order of the sweep
+static bool hidden_cave_bool_within(hidden_cave_Boolean const* b, uint32_t s, double x, double y) {
+    hidden_cave_Bool_Event const* start = E(s);
+    hidden_cave_Bool_Event const* end = E(start->other);
+    return !(x < start->x || (x == start->x && y < start->y) || x > end->x || (x == end->x && y > end->y));
+}
+
+//whether `p` lies exactly on the input edge that the segment whose left end is `s` is a piece of, within the piece
+static bool hidden_cave_bool_on_edge(hidden_cave_Boolean const* b, uint32_t s, hidden_cave_Bool_Event const* p) {
+    hidden_cave_Bool_Event const* start = E(s);
+    return hidden_cave_bool_within(b, s, p->x, p->y)
+        && hidden_cave_bool_orient(E(start->edge), E(start->edge + 1), p) == 0;
+}
+
+//where the lines through the input edges that segments `s1` and `s2` are pieces of cross, with a single rounding
+//when their products are exact, as they are for points on a grid, so that the crossings of three edges through
+//one point all round to the same point. Returns false if the lines are too near parallel for it to be finite.
+static bool hidden_cave_bool_edge_crossing(hidden_cave_Boolean const* b, uint32_t s1, uint32_t s2, double* x,
+                                           double* y) {
+    hidden_cave_Bool_Event const* p0 = E(E(s1)->edge);
+    hidden_cave_Bool_Event const* p1 = E(E(s1)->edge + 1);
+    hidden_cave_Bool_Event const* q0 = E(E(s2)->edge);
+    hidden_cave_Bool_Event const* q1 = E(E(s2)->edge + 1);
+    double pc = p0->x * p1->y - p0->y * p1->x, qc = q0->x * q1->y - q0->y * q1->x;
+    double d = (p0->x - p1->x) * (q0->y - q1->y) - (p0->y - p1->y) * (q0->x - q1->x);
+    *x = (pc * (q0->x - q1->x) - (p0->x - p1->x) * qc) / d;
+    *y = (pc * (q0->y - q1->y) - (p0->y - p1->y) * qc) / d;
+    return isfinite(*x) && isfinite(*y);
+}
+
+//finds where segments `s1` and `s2`, given by their left ends, meet. Sets `at` to one point, or to the two
+//ends of the stretch they share if they overlap, and returns how many points it set.
+static int hidden_cave_bool_intersect(hidden_cave_Boolean const* b, uint32_t s1, uint32_t s2, double* at) {
+    hidden_cave_Bool_Event const* a0 = E(s1);
+    hidden_cave_Bool_Event const* a1 = E(a0->other);
+    hidden_cave_Bool_Event const* b0 = E(s2);
+    hidden_cave_Bool_Event const* b1 = E(b0->other);
+    double o1 = hidden_cave_bool_orient(a0, a1, b0), o2 = hidden_cave_bool_orient(a0, a1, b1);
+    if(o1 == 0 && o2 == 0) {
+        //on one line, where left ends come first, so they share from the later start to the earlier end
+        hidden_cave_Bool_Event const* from = a0->x > b0->x || (a0->x == b0->x && a0->y > b0->y) ? a0 : b0;
+        hidden_cave_Bool_Event const* to = a1->x < b1->x || (a1->x == b1->x && a1->y < b1->y) ? a1 : b1;
+        if(from->x > to->x || (from->x == to->x && from->y > to->y)) {
+            return 0;
+        }
+        at[0] = from->x;
+        at[1] = from->y;
+        if(hidden_cave_bool_same_point(from, to)) {
+            return 1;
+        }
+        at[2] = to->x;
+        at[3] = to->y;
+        return 2;
+    }
+    double o3 = hidden_cave_bool_orient(b0, b1, a0), o4 = hidden_cave_bool_orient(b0, b1, a1);
+    bool cross = !((o1 > 0 && o2 > 0) || (o1 < 0 && o2 < 0) || (o3 > 0 && o4 > 0) || (o3 < 0 && o4 < 0));
+    hidden_cave_Bool_Event const* touch = !cross ? NULL : o1 == 0 ? b0 : o2 == 0 ? b1 : o3 == 0 ? a0 : o4 == 0 ? a1
+                                                                                                              : NULL;
+    //a piece rounded off of its input edge where it was split may only nearly reach an end on that edge
+    if(!touch) {
+        touch = hidden_cave_bool_on_edge(b, s2, a0) ? a0 : hidden_cave_bool_on_edge(b, s2, a1) ? a1
+              : hidden_cave_bool_on_edge(b, s1, b0) ? b0 : hidden_cave_bool_on_edge(b, s1, b1) ? b1 : NULL;
+    }
+    double x, y;
+    bool crossing = hidden_cave_bool_edge_crossing(b, s1, s2, &x, &y);
+    //nor may a piece split where a third edge crossed its input edge reach one it crossed at the same point
+    if(!touch && !cross && crossing) {
+        touch = hidden_cave_bool_at(a1, x, y) && hidden_cave_bool_within(b, s2, x, y) ? a1
+              : hidden_cave_bool_at(b1, x, y) && hidden_cave_bool_within(b, s1, x, y) ? b1
+              : hidden_cave_bool_at(a0, x, y) && hidden_cave_bool_within(b, s2, x, y) ? a0
+              : hidden_cave_bool_at(b0, x, y) && hidden_cave_bool_within(b, s1, x, y) ? b0 : NULL;
+    }
+    if(touch) {
+        at[0] = touch->x;
+        at[1] = touch->y;
+        return 1;
+    }
+    if(!cross) {
+        return 0;
+    }
+    //the exact signs put the crossing strictly inside both pieces, and it is kept inside both boxes when rounded
+    if(!crossing) {
+        double t = o3 / (o3 - o4);
+        x = a0->x + t * (a1->x - a0->x);
+        y = a0->y + t * (a1->y - a0->y);
+    }
+    x = fmax(x, fmax(fmin(a0->x, a1->x), fmin(b0->x, b1->x)));
+    x = fmin(x, fmin(fmax(a0->x, a1->x), fmax(b0->x, b1->x)));
+    y = fmax(y, fmax(fmin(a0->y, a1->y), fmin(b0->y, b1->y)));
+    y = fmin(y, fmin(fmax(a0->y, a1->y), fmax(b0->y, b1->y)));
+    at[0] = x;
+    at[1] = y;
+    return 1;
+}
+
+//splits segments `s1` and `s2`, given by their left ends, wherever they meet. Returns 2 if they were left
+//identical, or sharing a left end, with the windings of both to work out again, and otherwise 1 if they met
+//and 0 if not.
+static int hidden_cave_bool_split(hidden_cave_Boolean* b, uint32_t s1, uint32_t s2) {
+    double at[4];
+    int count = hidden_cave_bool_intersect(b, s1, s2, at);
+    if(count == 0) {
+        return 0;
+    }
+    uint32_t o1 = E(s1)->other, o2 = E(s2)->other;
+    bool left_coincide = hidden_cave_bool_same_point(E(s1), E(s2));
+    bool right_coincide = hidden_cave_bool_same_point(E(o1), E(o2));
+    if(count == 1) {
+        if(left_coincide || right_coincide) {
+            return 0;
+        }
+        if(!hidden_cave_bool_at(E(s1), at[0], at[1]) && !hidden_cave_bool_at(E(o1), at[0], at[1])) {
+            hidden_cave_bool_divide_stack(b, s1, at[0], at[1]);
+        }
+        if(!hidden_cave_bool_at(E(s2), at[0], at[1]) && !hidden_cave_bool_at(E(o2), at[0], at[1])) {
+            hidden_cave_bool_divide_stack(b, s2, at[0], at[1]);
+        }
+        return 1;
+    }
+
+    //they overlap. Cut them where the other starts and ends, so the shared stretch is the same in both.
+    uint32_t first = hidden_cave_bool_compare_events(b, s1, s2) > 0 ? s2 : s1;
+    uint32_t second = first == s1 ? s2 : s1;
+    uint32_t near = hidden_cave_bool_compare_events(b, o1, o2) > 0 ? o2 : o1;
+    uint32_t far = near == o1 ? o2 : o1;
+    double second_x = E(second)->x, second_y = E(second)->y;
+    double near_x = E(near)->x, near_y = E(near)->y;
+    if(left_coincide) {
+        if(!right_coincide) {
+            hidden_cave_bool_divide_stack(b, E(far)->other, near_x, near_y);
+        }
+        return 2;
+    }
+    if(right_coincide) {
+        hidden_cave_bool_divide_stack(b, first, second_x, second_y);
+        return 1;
+    }
+    if(first != E(far)->other) {
+        hidden_cave_bool_divide_stack(b, first, second_x, second_y);
+        hidden_cave_bool_divide_stack(b, second, near_x, near_y);
+        return 1;
+    }
+    //one holds the other, and after the first cut `far` ends the piece holding the rest
+    hidden_cave_bool_divide_stack(b, first, second_x, second_y);
+    hidden_cave_bool_divide_stack(b, E(far)->other, near_x, near_y);
+    return 1;
+}
+
+//works out the windings either side of segment `e`, with `prev` the segment directly below it, if any
+static void hidden_cave_bool_windings(hidden_cave_Boolean* b, uint32_t e, uint32_t prev) {
+    hidden_cave_Bool_Event* p = E(e);
+    p->merged = false;
+    p->below[0] = 0;
+    p->below[1] = 0;
+    if(prev != CAVE_BOOLEAN_NIL) {
+        hidden_cave_Bool_Event* q = E(prev);
+        bool identical = hidden_cave_bool_identical(b, e, prev);
+        bool under = identical || hidden_cave_bool_vertical(b, prev);
+        p->below[0] = under ? q->below[0] : q->above[0];
+        p->below[1] = under ? q->below[1] : q->above[1];
+        if(identical) {
+            q->merged = true;
+            p->above[0] = q->above[0] + p->wind[0];
+            p->above[1] = q->above[1] + p->wind[1];
+            return;
+        }
+    }
+    p->above[0] = p->below[0] + p->wind[0];
+    p->above[1] = p->below[1] + p->wind[1];
+}
+
+static bool hidden_cave_bool_inside(cave_Boolean_Operation operation, int32_t const* winding) {
+    bool subject = winding[0] > 0, clip = winding[1] > 0;
+    switch(operation) {
+        case CAVE_BOOLEAN_UNION: {
+            return subject || clip;
+        }
+        case CAVE_BOOLEAN_INTERSECTION: {
+            return subject && clip;
+        }
+        case CAVE_BOOLEAN_DIFFERENCE: {
+            return subject && !clip;
+        }
+        default: {
+            return subject != clip;
+        }
+    }
+}
+
+static void hidden_cave_bool_rotate_up(hidden_cave_Boolean* b, uint32_t x) {
+    uint32_t p = E(x)->parent;
+    uint32_t g = E(p)->parent;
+    if(E(p)->tree_left == x) {
+        E(p)->tree_left = E(x)->tree_right;
+        if(E(x)->tree_right != CAVE_BOOLEAN_NIL) {
+            E(E(x)->tree_right)->parent = p;
+        }
+        E(x)->tree_right = p;
+    } else {
+        E(p)->tree_right = E(x)->tree_left;
+        if(E(x)->tree_left != CAVE_BOOLEAN_NIL) {
+            E(E(x)->tree_left)->parent = p;
+        }
+        E(x)->tree_left = p;
+    }
+    E(p)->parent = x;
+    E(x)->parent = g;
+    if(g == CAVE_BOOLEAN_NIL) {
+        b->root = x;
+    } else if(E(g)->tree_left == p) {
+        E(g)->tree_left = x;
+    } else {
+        E(g)->tree_right = x;
+    }
+}
+
+static void hidden_cave_bool_status_insert(hidden_cave_Boolean* b, uint32_t e) {
+    b->seed ^= b->seed << 13;
+    b->seed ^= b->seed >> 17;
+    b->seed ^= b->seed << 5;
+    E(e)->priority = b->seed;
+    E(e)->tree_left = CAVE_BOOLEAN_NIL;
+    E(e)->tree_right = CAVE_BOOLEAN_NIL;
+    E(e)->parent = CAVE_BOOLEAN_NIL;
+    E(e)->in_status = true;
+    if(b->root == CAVE_BOOLEAN_NIL) {
+        b->root = e;
+        return;
+    }
+    uint32_t at = b->root;
+    for(;;) {
+        bool right = hidden_cave_bool_compare_segments(b, e, at) > 0;
+        uint32_t child = right ? E(at)->tree_right : E(at)->tree_left;
+        if(child == CAVE_BOOLEAN_NIL) {
+            if(right) {
+                E(at)->tree_right = e;
+            } else {
+                E(at)->tree_left = e;
+            }
+            E(e)->parent = at;
+            break;
+        }
+        at = child;
+    }
+    while(E(e)->parent != CAVE_BOOLEAN_NIL && E(E(e)->parent)->priority < E(e)->priority) {
+        hidden_cave_bool_rotate_up(b, e);
+    }
+}
+
+static void hidden_cave_bool_status_remove(hidden_cave_Boolean* b, uint32_t e) {
+    //rotate it down until it has at most one child, then splice it out
+    while(E(e)->tree_left != CAVE_BOOLEAN_NIL && E(e)->tree_right != CAVE_BOOLEAN_NIL) {
+        uint32_t l = E(e)->tree_left, r = E(e)->tree_right;
+        hidden_cave_bool_rotate_up(b, E(l)->priority > E(r)->priority ? l : r);
+    }
+    uint32_t child = E(e)->tree_left != CAVE_BOOLEAN_NIL ? E(e)->tree_left : E(e)->tree_right;
+    uint32_t p = E(e)->parent;
+    if(child != CAVE_BOOLEAN_NIL) {
+        E(child)->parent = p;
+    }
+    if(p == CAVE_BOOLEAN_NIL) {
+        b->root = child;
+    } else if(E(p)->tree_left == e) {
+        E(p)->tree_left = child;
+    } else {
+        E(p)->tree_right = child;
+    }
+    E(e)->in_status = false;
+}
+
+//whether the point of event `e` lies on the segment `s` in the status, other than at its ends, either exactly or
+//on the input edge it is a piece of, which it may have been rounded off of where it was split
+static bool hidden_cave_bool_through(hidden_cave_Boolean const* b, uint32_t s, uint32_t e) {
+    if(hidden_cave_bool_same_point(E(s), E(e)) || hidden_cave_bool_same_point(E(E(s)->other), E(e))) {
+        return false;
+    }
+    return hidden_cave_bool_orient(E(s), E(E(s)->other), E(e)) == 0 ||
+           hidden_cave_bool_orient(E(E(s)->edge), E(E(s)->edge + 1), E(e)) == 0;
+}
+
+//whether the segment `s` in the status meets the point of event `e`, through it or at one of its ends
+static bool hidden_cave_bool_touches(hidden_cave_Boolean const* b, uint32_t s, uint32_t e) {
+    return hidden_cave_bool_same_point(E(s), E(e)) || hidden_cave_bool_same_point(E(E(s)->other), E(e)) ||
+           hidden_cave_bool_through(b, s, e);
+}
+
+//splits every segment in the status that the point of event `e` lies on, there, so that the segments starting
+//and ending at the point are ordered among the pieces rather than against a segment running through it. Returns
+//whether any was split.
+static bool hidden_cave_bool_split_through(hidden_cave_Boolean* b, uint32_t e) {
+    //find where the point goes in the status, between the segments just below and above it
+    uint32_t below = CAVE_BOOLEAN_NIL, above = CAVE_BOOLEAN_NIL, at = b->root;
+    while(at != CAVE_BOOLEAN_NIL) {
+        double o = hidden_cave_bool_orient(E(at), E(E(at)->other), E(e));
+        if(o == 0) {
+            break;
+        }
+        if(o > 0) {
+            below = at;
+            at = E(at)->tree_right;
+        } else {
+            above = at;
+            at = E(at)->tree_left;
+        }
+    }
+    //the segments meeting the point are together in the status, around there
+    uint32_t lowest = CAVE_BOOLEAN_NIL;
+    for(uint32_t s = at != CAVE_BOOLEAN_NIL ? at : below; s != CAVE_BOOLEAN_NIL && hidden_cave_bool_touches(b, s, e);
+        s = hidden_cave_bool_status_prev(b, s)) {
+        lowest = s;
+    }
+    double x = E(e)->x, y = E(e)->y;
+    bool split = false;
+    for(at = lowest != CAVE_BOOLEAN_NIL ? lowest : above; at != CAVE_BOOLEAN_NIL && b->err == CAVE_NO_ERROR &&
+        hidden_cave_bool_touches(b, at, e); at = hidden_cave_bool_status_next(b, at)) {
+        if(hidden_cave_bool_through(b, at, e)) {
+            split = hidden_cave_bool_divide(b, at, x, y) || split;
+        }
+    }
+    return split;
+}
+
+static void hidden_cave_bool_sweep(hidden_cave_Boolean* b) {
+    b->root = CAVE_BOOLEAN_NIL;
+    while(b->queue_len > 0 && b->err == CAVE_NO_ERROR) {
+        uint32_t e = hidden_cave_bool_queue_pop(b);
+        //the pieces ending at the point are swept out before `e` comes round again
+        if(hidden_cave_bool_split_through(b, e)) {
+            hidden_cave_bool_queue_push(b, e);
+            continue;
+        }
+        if(E(e)->left) {
+            //segments waiting to go in that start the same way, which come after this one as they are no shorter,
+            //are cut where it ends and folded into it, so that no crossing can split them apart
+            while(b->queue_len > 0 && b->err == CAVE_NO_ERROR && E(b->queue[0])->left &&
+                  hidden_cave_bool_same_point(E(b->queue[0]), E(e)) &&
+                  hidden_cave_bool_along(b, e, b->queue[0])) {
+                uint32_t folded = hidden_cave_bool_queue_pop(b);
+                if(!hidden_cave_bool_identical(b, folded, e)) {
+                    hidden_cave_bool_divide(b, folded, E(E(e)->other)->x, E(E(e)->other)->y);
+                }
+                E(e)->wind[0] += E(folded)->wind[0];
+                E(e)->wind[1] += E(folded)->wind[1];
+                E(folded)->merged = true;
+            }
+            hidden_cave_bool_status_insert(b, e);
+            uint32_t prev = hidden_cave_bool_status_prev(b, e);
+            uint32_t next = hidden_cave_bool_status_next(b, e);
+            hidden_cave_bool_windings(b, e, prev);
+            if(next != CAVE_BOOLEAN_NIL && hidden_cave_bool_split(b, e, next) == 2) {
+                hidden_cave_bool_windings(b, e, prev);
+                hidden_cave_bool_windings(b, next, e);
+            }
+            if(prev != CAVE_BOOLEAN_NIL && hidden_cave_bool_split(b, prev, e) == 2) {
+                hidden_cave_bool_windings(b, prev, hidden_cave_bool_status_prev(b, prev));
+                hidden_cave_bool_windings(b, e, prev);
+            }
+            //a neighbour only found to pass through the start of `e` as it was rounded has been split there, and
+            //`e` is swept again once the piece ending there is out of the way
+            if((prev != CAVE_BOOLEAN_NIL && hidden_cave_bool_same_point(E(E(prev)->other), E(e))) ||
+               (next != CAVE_BOOLEAN_NIL && hidden_cave_bool_same_point(E(E(next)->other), E(e)))) {
+                prev = hidden_cave_bool_status_prev(b, e);
+                next = hidden_cave_bool_status_next(b, e);
+                hidden_cave_bool_status_remove(b, e);
+                hidden_cave_bool_queue_push(b, e);
+                if(prev != CAVE_BOOLEAN_NIL && next != CAVE_BOOLEAN_NIL) {
+                    hidden_cave_bool_split(b, prev, next);
+                }
+            }
+        } else {
+            uint32_t left = E(e)->other;
+            if(!E(left)->in_status) {
+                continue;
+            }
+            uint32_t prev = hidden_cave_bool_status_prev(b, left);
+            uint32_t next = hidden_cave_bool_status_next(b, left);
+            hidden_cave_bool_status_remove(b, left);
+            if(prev != CAVE_BOOLEAN_NIL && next != CAVE_BOOLEAN_NIL) {
+                hidden_cave_bool_split(b, prev, next);
+            }
+        }
+    }
+}
+
+//adds the edges of every ring of `polygon` as segments
+static CaveError hidden_cave_bool_add_polygon(hidden_cave_Boolean* b, cave_2d_Polygon const* polygon, bool subject) {
+    for(size_t r = 0; r < polygon->ring_count; r++) {
+        size_t start = polygon->ring_offsets[r], end = polygon->ring_offsets[r + 1];
+        for(size_t i = start; end - start >= 2 && i < end; i++) {
+            cave_2Point p = polygon->points[i], q = polygon->points[i + 1 < end ? i + 1 : start];
+            if(p.x == q.x && p.y == q.y) {
+                continue;
+            }
+            bool forwards = p.x < q.x || (p.x == q.x && p.y < q.y);
+            cave_2Point lo = forwards ? p : q, hi = forwards ? q : p;
+            uint32_t l = hidden_cave_bool_add_event(b, lo.x, lo.y, true, subject, forwards ? 1 : -1, CAVE_BOOLEAN_NIL);
+            uint32_t h = l == CAVE_BOOLEAN_NIL ? l : hidden_cave_bool_add_event(b, hi.x, hi.y, false, subject,
+                                                                                  forwards ? -1 : 1, l);
+            if(h == CAVE_BOOLEAN_NIL) {
+                return CAVE_INSUFFICIENT_MEMORY_ERROR;
+            }
+            E(l)->other = h;
+            E(l)->edge = l;
+            E(h)->edge = l;
+            hidden_cave_bool_queue_push(b, l);
+            hidden_cave_bool_queue_push(b, h);
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+static int hidden_cave_bool_compare_edges(void const* a, void const* b) {
+    hidden_cave_Bool_Edge const* p = a;
+    hidden_cave_Bool_Edge const* q = b;
+    if(p->x0 != q->x0) {
+        return p->x0 < q->x0 ? -1 : 1;
+    }
+    return p->y0 < q->y0 ? -1 : p->y0 > q->y0;
+}
+
+//how far clockwise, from just past 0 up to a full turn, it is from the direction of (dx0, dy0) to that of
+//(dx1, dy1). Only the order matters, so turns past a half are put above every other rather than taken exactly.
+static double hidden_cave_bool_turn(double dx0, double dy0, double dx1, double dy1) {
+    double angle = atan2(dx1 * dy0 - dy1 * dx0, dx0 * dx1 + dy0 * dy1);
+    return angle > 0 ? angle : angle + 8;
+}
+
+//links each edge to the one it runs on into: of those leaving where it ends, the first clockwise from the way
+//back, which keeps the result on the left, and its rings as tight as they can be
+static void hidden_cave_bool_link(hidden_cave_Bool_Edge* edges, size_t edge_count) {
+    qsort(edges, edge_count, sizeof(hidden_cave_Bool_Edge), hidden_cave_bool_compare_edges);
+    for(size_t i = 0; i < edge_count; i++) {
+        hidden_cave_Bool_Edge* e = edges + i;
+        hidden_cave_Bool_Edge end = {e->x1, e->y1, 0, 0, 0, false};
+        size_t lo = 0, hi = edge_count;
+        while(lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if(hidden_cave_bool_compare_edges(edges + mid, &end) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        e->next = CAVE_BOOLEAN_NIL;
+        double best = INFINITY;
+        for(size_t j = lo; j < edge_count && hidden_cave_bool_compare_edges(edges + j, &end) == 0; j++) {
+            double turn = hidden_cave_bool_turn(e->x0 - e->x1, e->y0 - e->y1,
+                                                edges[j].x1 - edges[j].x0, edges[j].y1 - edges[j].y0);
+            if(turn < best) {
+                best = turn;
+                e->next = (uint32_t) j;
+            }
+        }
+    }
+}
+
+//whether (bx, by) lies on the way from (ax, ay) to (cx, cy), so a ring through all three needn't keep it
+static bool hidden_cave_bool_straight(double ax, double ay, double bx, double by, double cx, double cy) {
+    double pa[2] = {ax, ay}, pb[2] = {bx, by}, pc[2] = {cx, cy};
+    return hidden_cave_orient2d(pa, pb, pc) == 0 && (bx - ax) * (cx - bx) + (by - ay) * (cy - by) > 0;
+}
+
+//traces the rings out of the linked edges into `dest`, which has room for every edge's start
+static void hidden_cave_bool_trace(hidden_cave_Bool_Edge* edges, size_t edge_count, cave_2d_Polygon* dest) {
+    size_t count = 0;
+    dest->ring_count = 0;
+    dest->ring_offsets[0] = 0;
+    for(size_t s = 0; s < edge_count; s++) {
+        if(edges[s].visited) {
+            continue;
+        }
+        size_t start = count;
+        uint32_t e = (uint32_t) s;
+        while(e != CAVE_BOOLEAN_NIL && !edges[e].visited) {
+            edges[e].visited = true;
+            //points the ring runs straight through are dropped, and so are points that round onto the last
+            hidden_cave_Bool_Edge const* in = edges + e;
+            uint32_t next = in->next;
+            bool straight = next != CAVE_BOOLEAN_NIL &&
+                            hidden_cave_bool_straight(in->x0, in->y0, in->x1, in->y1, edges[next].x1, edges[next].y1);
+            cave_2Point p = {(float) in->x1, (float) in->y1};
+            if(!straight && (count == start || p.x != dest->points[count - 1].x ||
+                             p.y != dest->points[count - 1].y)) {
+                dest->points[count++] = p;
+            }
+            e = next;
+        }
+        while(count - start > 1 && dest->points[count - 1].x == dest->points[start].x &&
+              dest->points[count - 1].y == dest->points[start].y) {
+            count--;
+        }
+        if(count - start < 3) {
+            count = start;
+            continue;
+        }
+        dest->ring_offsets[++dest->ring_count] = count;
+    }
+}
+
+static CaveError hidden_cave_bool_check(cave_2d_Polygon const* polygon, size_t* edge_count) {
+    if(!polygon) {
+        return CAVE_DATA_ERROR;
+    }
+    CaveError err = hidden_cave_polytri_validate_polygon(polygon);
+    if(err == CAVE_NO_ERROR && polygon->ring_count > 0) {
+        *edge_count += polygon->ring_offsets[polygon->ring_count] - polygon->ring_offsets[0];
+    }
+    return err;
+}
+
+CaveError cave_polygon_boolean(cave_2d_Polygon* dest, cave_2d_Polygon const* subject, cave_2d_Polygon const* clip,
+                               cave_Boolean_Operation operation) {
+    if(!dest) {
+        return CAVE_DATA_ERROR;
+    }
+    *dest = (cave_2d_Polygon) {NULL, NULL, 0};
+    size_t edge_count = 0;
+    CaveError err = hidden_cave_bool_check(subject, &edge_count);
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_bool_check(clip, &edge_count);
+    }
+    if(err == CAVE_NO_ERROR && (edge_count >= CAVE_POLYTRI_MAX_POINTS || operation < CAVE_BOOLEAN_UNION ||
+                                operation > CAVE_BOOLEAN_XOR)) {
+        err = CAVE_DATA_ERROR;
+    }
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    hidden_cave_Boolean b = {0};
+    b.operation = operation;
+    b.seed = 2463534242u;
+    b.event_cap = (uint32_t) (2 * edge_count + 16);
+    b.events = malloc(sizeof(hidden_cave_Bool_Event) * b.event_cap);
+    b.queue = malloc(sizeof(uint32_t) * b.event_cap);
+    err = b.events && b.queue ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_bool_add_polygon(&b, subject, true);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_bool_add_polygon(&b, clip, false);
+    }
+    if(err == CAVE_NO_ERROR) {
+        hidden_cave_bool_sweep(&b);
+        err = b.err;
+    }
+    free(b.queue);
+
+    //every left end still holding its segment is a piece of some edge, which is in the result if the
+    //operation changes across it
+    size_t result_count = 0;
+    for(uint32_t i = 0; err == CAVE_NO_ERROR && i < b.event_count; i++) {
+        hidden_cave_Bool_Event const* e = b.events + i;
+        result_count += e->left && !e->merged &&
+                        hidden_cave_bool_inside(operation, e->below) != hidden_cave_bool_inside(operation, e->above);
+    }
+    hidden_cave_Bool_Edge* edges = NULL;
+    if(err == CAVE_NO_ERROR) {
+        edges = malloc(sizeof(hidden_cave_Bool_Edge) * (result_count > 0 ? result_count : 1));
+        dest->points = malloc(sizeof(cave_2Point) * (result_count > 0 ? result_count : 1));
+        dest->ring_offsets = malloc(sizeof(size_t) * (result_count / 3 + 1));
+        if(!edges || !dest->points || !dest->ring_offsets) {
+            err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+        }
+    }
+    if(err == CAVE_NO_ERROR) {
+        size_t k = 0;
+        for(uint32_t i = 0; i < b.event_count; i++) {
+            hidden_cave_Bool_Event const* e = b.events + i;
+            bool inside_above = hidden_cave_bool_inside(operation, e->above);
+            if(!e->left || e->merged || hidden_cave_bool_inside(operation, e->below) == inside_above) {
+                continue;
+            }
+            hidden_cave_Bool_Event const* from = inside_above ? e : b.events + e->other;
+            hidden_cave_Bool_Event const* to = inside_above ? b.events + e->other : e;
+            hidden_cave_Bool_Edge edge = {from->x, from->y, to->x, to->y, CAVE_BOOLEAN_NIL, false};
+            edges[k++] = edge;
+        }
+        hidden_cave_bool_link(edges, result_count);
+        hidden_cave_bool_trace(edges, result_count, dest);
+    } else {
+        free(dest->points);
+        free(dest->ring_offsets);
+        *dest = (cave_2d_Polygon) {NULL, NULL, 0};
+    }
+    free(edges);
+    free(b.events);
+    return err;
+}
@@ -0,0 +1,1003 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-bvh.h"
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+//the most bins per axis. Small ranges get fewer, as many as half their triangles but at least 4, since clearing and
+//sweeping bins costs the same however few triangles are in them.
+#define CAVE_BVH_BINS (16)
+//what visiting a node costs, relative to testing a triangle
+#define CAVE_BVH_TRAVERSAL_COST (1.0f)
+//ranges at least this big have their binning spread across threads, this many triangles at a time
+#define CAVE_BVH_PARALLEL_GRAIN (1 << 15)
+//the top of the tree is split until ranges are no bigger than a 64th of the triangles, or this, whichever is
+//bigger, and what's left is built into subtrees in parallel
+#define CAVE_BVH_SUBTREE_MIN (4096)
+//past this depth, ranges are halved instead of split by cost. That bounds how deep trees get, so that queries
+//can walk them with a fixed stack: no more than 40 + 32 binary levels, and each node pushes at most 3 more
+//entries than it pops.
+#define CAVE_BVH_COST_DEPTH (40)
+#define CAVE_BVH_STACK (256)
+//queries handed out to each thread at a time
+#define CAVE_BVH_QUERY_GRAIN (1024)
+
+typedef struct hidden_cave_Box {
+    float min[3];
+    float max[3];
+} hidden_cave_Box;
+
+static hidden_cave_Box hidden_cave_box_empty(void) {
+    hidden_cave_Box box = {{INFINITY, INFINITY, INFINITY}, {-INFINITY, -INFINITY, -INFINITY}};
+    return box;
+}
+
+static void hidden_cave_box_grow(hidden_cave_Box* box, hidden_cave_Box const* other) {
+    for(int k = 0; k < 3; k++) {
+        box->min[k] = other->min[k] < box->min[k] ? other->min[k] : box->min[k];
+        box->max[k] = other->max[k] > box->max[k] ? other->max[k] : box->max[k];
+    }
+}
+
+static void hidden_cave_box_add(hidden_cave_Box* box, float const* p) {
+    for(int k = 0; k < 3; k++) {
+        box->min[k] = p[k] < box->min[k] ? p[k] : box->min[k];
+        box->max[k] = p[k] > box->max[k] ? p[k] : box->max[k];
+    }
+}
+
+//half the surface area, which is all the heuristic needs
+static float hidden_cave_box_area(hidden_cave_Box const* box) {
+    if(box->min[0] > box->max[0]) {
+        return 0.0f;
+    }
+    float dx = box->max[0] - box->min[0], dy = box->max[1] - box->min[1], dz = box->max[2] - box->min[2];
+    return dx * dy + dy * dz + dz * dx;
+}
+
+/*
+ * Building
+ */
+
+//a node of the binary tree built first. A leaf has a `count`. An inner node has `left` and `right` children in
+//the same tree, unless `left` is CAVE_BVH_EMPTY, in which case it stands for subtree number `right`.
+typedef struct hidden_cave_BVH_Binary {
+    hidden_cave_Box box;
+    uint32_t left;
+    uint32_t right;
+    uint32_t first;
+    uint32_t count;
+} hidden_cave_BVH_Binary;
+
+typedef struct hidden_cave_BVH_Tree {
+    hidden_cave_BVH_Binary* nodes;
+    size_t count;
+    size_t capacity;
+} hidden_cave_BVH_Tree;
+
+typedef struct hidden_cave_BVH_Subtree {
+    uint32_t begin;
+    uint32_t end;
+    uint32_t depth;
+    hidden_cave_Box box;
+    hidden_cave_BVH_Tree tree;
+} hidden_cave_BVH_Subtree;
+
+typedef struct hidden_cave_BVH_Bins {
+    hidden_cave_Box box[3][CAVE_BVH_BINS];
+    uint32_t count[3][CAVE_BVH_BINS];
+    //how many of the bins are in use
+    int used;
+} hidden_cave_BVH_Bins;
+
+//a triangle as the builder sees it. These are moved rather than indexes to them, so that every pass over a range
+//reads memory in order.
+typedef struct hidden_cave_BVH_Prim {
+    hidden_cave_Box box;
+    uint32_t id;
+} hidden_cave_BVH_Prim;
+
+typedef struct hidden_cave_BVH_Build {
+    cave_3d_Triangle const* tris;
+    //the triangles, reordered as ranges are split
+    hidden_cave_BVH_Prim* prims;
+    size_t threads;
+    //ranges no bigger than this are left for subtrees, or 0 when building a subtree
+    uint32_t subtree_size;
+    hidden_cave_BVH_Subtree* subtrees;
+    size_t subtree_count;
+    size_t subtree_capacity;
+    //scratch for each worker of a parallel pass
+    hidden_cave_BVH_Bins* worker_bins;
+    hidden_cave_Box* worker_boxes;
+    CaveError err;
+} hidden_cave_BVH_Build;
+
+static uint32_t hidden_cave_bvh_push(hidden_cave_BVH_Build* build, hidden_cave_BVH_Tree* tree,
+                                     hidden_cave_Box const* box) {
+    if(tree->count == tree->capacity) {
+        size_t capacity = tree->capacity ? tree->capacity * 2 : 64;
+        hidden_cave_BVH_Binary* nodes = realloc(tree->nodes, sizeof(hidden_cave_BVH_Binary) * capacity);
+        if(!nodes) {
+            build->err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+            return 0;
+        }
+        tree->nodes = nodes;
+        tree->capacity = capacity;
+    }
+    hidden_cave_BVH_Binary node = {*box, 0, 0, 0, 0};
+    tree->nodes[tree->count] = node;
+    return (uint32_t) tree->count++;
+}
+
+//twice the centroid of the triangle's box, which bins just as well as the centroid itself
+static void hidden_cave_bvh_centroid(hidden_cave_Box const* box, float* c) {
+    for(int k = 0; k < 3; k++) {
+        c[k] = box->min[k] + box->max[k];
+    }
+}
+
+static int hidden_cave_bvh_bin_of(float c, float min, float scale, int used) {
+    int k = (int) ((c - min) * scale);
+    return k < 0 ? 0 : (k >= used ? used - 1 : k);
+}
+
+static void hidden_cave_bvh_bins_clear(hidden_cave_BVH_Bins* bins, int used) {
+    bins->used = used;
+    for(int axis = 0; axis < 3; axis++) {
+        for(int k = 0; k < used; k++) {
+            bins->box[axis][k] = hidden_cave_box_empty();
+            bins->count[axis][k] = 0;
+        }
+    }
+}
+
+typedef struct hidden_cave_BVH_Pass {
+    hidden_cave_BVH_Build* build;
+    uint32_t begin;
+    hidden_cave_Box const* centroid_box;
+    float const* scale;
+} hidden_cave_BVH_Pass;
+
+static void hidden_cave_bvh_centroid_bounds(hidden_cave_BVH_Build const* build, uint32_t begin, uint32_t end,
+                                            hidden_cave_Box* box) {
+    for(uint32_t i = begin; i < end; i++) {
+        float c[3];
+        hidden_cave_bvh_centroid(&build->prims[i].box, c);
+        hidden_cave_box_add(box, c);
+    }
+}
+
+static void hidden_cave_bvh_bin(hidden_cave_BVH_Build const* build, uint32_t begin, uint32_t end,
+                                hidden_cave_Box const* centroid_box, float const* scale, hidden_cave_BVH_Bins* bins) {
+    for(uint32_t i = begin; i < end; i++) {
+        hidden_cave_Box const* box = &build->prims[i].box;
+        float c[3];
+        hidden_cave_bvh_centroid(box, c);
+        for(int axis = 0; axis < 3; axis++) {
+            int k = hidden_cave_bvh_bin_of(c[axis], centroid_box->min[axis], scale[axis], bins->used);
+            hidden_cave_box_grow(&bins->box[axis][k], box);
+            bins->count[axis][k] += 1;
+        }
+    }
+}
+
+static CaveError hidden_cave_bvh_centroid_bounds_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    hidden_cave_BVH_Pass* pass = arg;
+    hidden_cave_bvh_centroid_bounds(pass->build, pass->begin + (uint32_t) begin, pass->begin + (uint32_t) end,
+                                    &pass->build->worker_boxes[worker]);
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_bvh_bin_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    hidden_cave_BVH_Pass* pass = arg;
+    hidden_cave_bvh_bin(pass->build, pass->begin + (uint32_t) begin, pass->begin + (uint32_t) end,
+                        pass->centroid_box, pass->scale, &pass->build->worker_bins[worker]);
+    return CAVE_NO_ERROR;
+}
+
+//bins [begin, end) by centroid along each axis, spreading big ranges across threads. Merging the workers' bins
+//takes mins, maxes and counts, which come out the same whichever worker binned what.
+static void hidden_cave_bvh_bin_range(hidden_cave_BVH_Build* build, uint32_t begin, uint32_t end,
+                                      hidden_cave_Box* centroid_box, float* scale, hidden_cave_BVH_Bins* bins) {
+    bool parallel = build->threads > 1 && end - begin >= 2 * CAVE_BVH_PARALLEL_GRAIN;
+    uint32_t half = (end - begin) / 2;
+    int used = half >= CAVE_BVH_BINS ? CAVE_BVH_BINS : (half > 4 ? (int) half : 4);
+    hidden_cave_BVH_Pass pass = {build, begin, centroid_box, scale};
+    *centroid_box = hidden_cave_box_empty();
+    if(parallel) {
+        for(size_t w = 0; w < build->threads; w++) {
+            build->worker_boxes[w] = hidden_cave_box_empty();
+        }
+        CaveError err = cave_parallel_for(end - begin, CAVE_BVH_PARALLEL_GRAIN, build->threads,
+                                          hidden_cave_bvh_centroid_bounds_chunk, &pass);
+        build->err = err != CAVE_NO_ERROR ? err : build->err;
+        for(size_t w = 0; w < build->threads; w++) {
+            hidden_cave_box_grow(centroid_box, &build->worker_boxes[w]);
+        }
+    } else {
+        hidden_cave_bvh_centroid_bounds(build, begin, end, centroid_box);
+    }
+    for(int axis = 0; axis < 3; axis++) {
+        float extent = centroid_box->max[axis] - centroid_box->min[axis];
+        scale[axis] = extent > 0.0f ? (float) used / extent : 0.0f;
+    }
+
+    hidden_cave_bvh_bins_clear(bins, used);
+    if(parallel) {
+        for(size_t w = 0; w < build->threads; w++) {
+            hidden_cave_bvh_bins_clear(&build->worker_bins[w], used);
+        }
+        CaveError err = cave_parallel_for(end - begin, CAVE_BVH_PARALLEL_GRAIN, build->threads,
+                                          hidden_cave_bvh_bin_chunk, &pass);
+        build->err = err != CAVE_NO_ERROR ? err : build->err;
+        for(size_t w = 0; w < build->threads; w++) {
+            for(int axis = 0; axis < 3; axis++) {
+                for(int k = 0; k < used; k++) {
+                    hidden_cave_box_grow(&bins->box[axis][k], &build->worker_bins[w].box[axis][k]);
+                    bins->count[axis][k] += build->worker_bins[w].count[axis][k];
+                }
+            }
+        }
+    } else {
+        hidden_cave_bvh_bin(build, begin, end, centroid_box, scale, bins);
+    }
+}
+
+//splits [begin, end) in the middle, for when cost can't or shouldn't decide
+static uint32_t hidden_cave_bvh_halve(hidden_cave_BVH_Build const* build, uint32_t begin, uint32_t end,
+                                      hidden_cave_Box* left, hidden_cave_Box* right) {
+    uint32_t mid = begin + (end - begin) / 2;
+    *left = hidden_cave_box_empty();
+    *right = hidden_cave_box_empty();
+    for(uint32_t i = begin; i < end; i++) {
+        hidden_cave_box_grow(i < mid ? left : right, &build->prims[i].box);
+    }
+    return mid;
+}
+
+//decides how to split [begin, end), whose triangles fit in `box`, and reorders `prims` to match. Returns where the
+//right side starts, with the sides' boxes in `left` and `right`, or `begin` if the range should be a leaf.
+static uint32_t hidden_cave_bvh_split(hidden_cave_BVH_Build* build, uint32_t begin, uint32_t end,
+                                      hidden_cave_Box const* box, uint32_t depth, hidden_cave_Box* left,
+                                      hidden_cave_Box* right) {
+    uint32_t n = end - begin;
+    if(n <= 1) {
+        return begin;
+    }
+    if(depth >= CAVE_BVH_COST_DEPTH) {
+        return n <= CAVE_BVH_LEAF_TRIS ? begin : hidden_cave_bvh_halve(build, begin, end, left, right);
+    }
+    hidden_cave_Box centroid_box;
+    float scale[3];
+    hidden_cave_BVH_Bins bins;
+    hidden_cave_bvh_bin_range(build, begin, end, &centroid_box, scale, &bins);
+
+    //sweeps each axis from the right to find the cost of everything past each bin, then from the left
+    float best_cost = INFINITY;
+    int best_axis = -1, best_bin = 0;
+    for(int axis = 0; axis < 3; axis++) {
+        if(scale[axis] == 0.0f) {
+            continue;
+        }
+        float right_cost[CAVE_BVH_BINS];
+        hidden_cave_Box sweep = hidden_cave_box_empty();
+        uint32_t count = 0;
+        for(int k = bins.used - 1; k > 0; k--) {
+            hidden_cave_box_grow(&sweep, &bins.box[axis][k]);
+            count += bins.count[axis][k];
+            right_cost[k] = hidden_cave_box_area(&sweep) * (float) count;
+        }
+        sweep = hidden_cave_box_empty();
+        count = 0;
+        for(int k = 1; k < bins.used; k++) {
+            hidden_cave_box_grow(&sweep, &bins.box[axis][k - 1]);
+            count += bins.count[axis][k - 1];
+            float cost = hidden_cave_box_area(&sweep) * (float) count + right_cost[k];
+            if(count > 0 && count < n && cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin = k;
+            }
+        }
+    }
+    float area = hidden_cave_box_area(box);
+    if(n <= CAVE_BVH_LEAF_TRIS && (float) n * area <= CAVE_BVH_TRAVERSAL_COST * area + best_cost) {
+        return begin;
+    }
+    if(best_axis < 0) {
+        //every centroid is in the same place
+        return n <= CAVE_BVH_LEAF_TRIS ? begin : hidden_cave_bvh_halve(build, begin, end, left, right);
+    }
+
+    uint32_t i = begin, j = end;
+    while(i < j) {
+        float c[3];
+        hidden_cave_bvh_centroid(&build->prims[i].box, c);
+        int k = hidden_cave_bvh_bin_of(c[best_axis], centroid_box.min[best_axis], scale[best_axis], bins.used);
+        if(k < best_bin) {
+            i++;
+        } else {
+            j--;
+            hidden_cave_BVH_Prim swap = build->prims[i];
+            build->prims[i] = build->prims[j];
+            build->prims[j] = swap;
+        }
+    }
+    *left = hidden_cave_box_empty();
+    *right = hidden_cave_box_empty();
+    for(int k = 0; k < bins.used; k++) {
+        hidden_cave_box_grow(k < best_bin ? left : right, &bins.box[best_axis][k]);
+    }
+    return i;
+}
+
+static uint32_t hidden_cave_bvh_build_node(hidden_cave_BVH_Build* build, hidden_cave_BVH_Tree* tree,
+                                           uint32_t begin, uint32_t end, hidden_cave_Box const* box, uint32_t depth) {
+    uint32_t index = hidden_cave_bvh_push(build, tree, box);
+    if(build->err != CAVE_NO_ERROR) {
+        return index;
+    }
+    if(end - begin <= build->subtree_size) {
+        if(build->subtree_count == build->subtree_capacity) {
+            size_t capacity = build->subtree_capacity ? build->subtree_capacity * 2 : 64;
+            hidden_cave_BVH_Subtree* subtrees = realloc(build->subtrees, sizeof(hidden_cave_BVH_Subtree) * capacity);
+            if(!subtrees) {
+                build->err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+                return index;
+            }
+            build->subtrees = subtrees;
+            build->subtree_capacity = capacity;
+        }
+        hidden_cave_BVH_Subtree subtree = {begin, end, depth, *box, {NULL, 0, 0}};
+        build->subtrees[build->subtree_count] = subtree;
+        tree->nodes[index].left = CAVE_BVH_EMPTY;
+        tree->nodes[index].right = (uint32_t) build->subtree_count++;
+        return index;
+    }
+    hidden_cave_Box left_box, right_box;
+    uint32_t mid = hidden_cave_bvh_split(build, begin, end, box, depth, &left_box, &right_box);
+    if(mid == begin) {
+        tree->nodes[index].first = begin;
+        tree->nodes[index].count = end - begin;
+        return index;
+    }
+    uint32_t left = hidden_cave_bvh_build_node(build, tree, begin, mid, &left_box, depth + 1);
+    uint32_t right = hidden_cave_bvh_build_node(build, tree, mid, end, &right_box, depth + 1);
+    if(build->err == CAVE_NO_ERROR) {
+        tree->nodes[index].left = left;
+        tree->nodes[index].right = right;
+    }
+    return index;
+}
+
+static CaveError hidden_cave_bvh_subtree_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    (void) worker;
+    hidden_cave_BVH_Build const* top = arg;
+    for(size_t s = begin; s < end; s++) {
+        hidden_cave_BVH_Subtree* subtree = top->subtrees + s;
+        hidden_cave_BVH_Build build = *top;
+        build.threads = 1;
+        build.subtree_size = 0;
+        build.err = CAVE_NO_ERROR;
+        hidden_cave_bvh_build_node(&build, &subtree->tree, subtree->begin, subtree->end, &subtree->box,
+                                   subtree->depth);
+        if(build.err != CAVE_NO_ERROR) {
+            return build.err;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_bvh_prepare_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    (void) worker;
+    hidden_cave_BVH_Build* build = arg;
+    for(size_t i = begin; i < end; i++) {
+        cave_3d_Triangle const* t = build->tris + i;
+        hidden_cave_Box box = hidden_cave_box_empty();
+        hidden_cave_box_add(&box, &t->a.x);
+        hidden_cave_box_add(&box, &t->b.x);
+        hidden_cave_box_add(&box, &t->c.x);
+        hidden_cave_BVH_Prim prim = {box, (uint32_t) i};
+        build->prims[i] = prim;
+    }
+    return CAVE_NO_ERROR;
+}
+
+/*
+ * Collapsing the binary tree into one of four children per node
+ */
+
+typedef struct hidden_cave_BVH_Ref {
+    hidden_cave_BVH_Tree const* tree;
+    uint32_t index;
+} hidden_cave_BVH_Ref;
+
+typedef struct hidden_cave_BVH_Collapse {
+    hidden_cave_BVH_Build const* build;
+    cave_BVH_Node* nodes;
+    size_t count;
+} hidden_cave_BVH_Collapse;
+
+static hidden_cave_BVH_Binary const* hidden_cave_bvh_node(hidden_cave_BVH_Ref ref) {
+    return ref.tree->nodes + ref.index;
+}
+
+//follows a node standing for a subtree to the subtree's root
+static hidden_cave_BVH_Ref hidden_cave_bvh_resolve(hidden_cave_BVH_Collapse const* collapse, hidden_cave_BVH_Ref ref) {
+    hidden_cave_BVH_Binary const* node = hidden_cave_bvh_node(ref);
+    if(node->count == 0 && node->left == CAVE_BVH_EMPTY) {
+        hidden_cave_BVH_Ref root = {&collapse->build->subtrees[node->right].tree, 0};
+        return root;
+    }
+    return ref;
+}
+
+static hidden_cave_BVH_Ref hidden_cave_bvh_child(hidden_cave_BVH_Collapse const* collapse, hidden_cave_BVH_Ref ref,
+                                                 bool right) {
+    hidden_cave_BVH_Binary const* node = hidden_cave_bvh_node(ref);
+    hidden_cave_BVH_Ref child = {ref.tree, right ? node->right : node->left};
+    return hidden_cave_bvh_resolve(collapse, child);
+}
+
+//opens up inner node `ref` into its biggest descendants, up to four of them, always opening the widest
+static int hidden_cave_bvh_open(hidden_cave_BVH_Collapse const* collapse, hidden_cave_BVH_Ref ref,
+                                hidden_cave_BVH_Ref* children) {
+    children[0] = hidden_cave_bvh_child(collapse, ref, false);
+    children[1] = hidden_cave_bvh_child(collapse, ref, true);
+    int count = 2;
+    while(count < 4) {
+        int widest = -1;
+        float widest_area = -1.0f;
+        for(int c = 0; c < count; c++) {
+            hidden_cave_BVH_Binary const* node = hidden_cave_bvh_node(children[c]);
+            float area = hidden_cave_box_area(&node->box);
+            if(node->count == 0 && area > widest_area) {
+                widest = c;
+                widest_area = area;
+            }
+        }
+        if(widest < 0) {
+            break;
+        }
+        hidden_cave_BVH_Ref opened = children[widest];
+        children[widest] = hidden_cave_bvh_child(collapse, opened, false);
+        children[count++] = hidden_cave_bvh_child(collapse, opened, true);
+    }
+    return count;
+}
+
+//emits the node with `slots` as its children, and then the nodes of its inner children, depth first
+static uint32_t hidden_cave_bvh_emit(hidden_cave_BVH_Collapse* collapse, hidden_cave_BVH_Ref const* slots,
+                                     int used) {
+    uint32_t index = (uint32_t) collapse->count++;
+    cave_BVH_Node* out = collapse->nodes + index;
+    for(int lane = 0; lane < 4; lane++) {
+        hidden_cave_Box box = hidden_cave_box_empty();
+        out->child[lane] = CAVE_BVH_EMPTY;
+        out->count[lane] = 0;
+        if(lane < used) {
+            hidden_cave_BVH_Binary const* node = hidden_cave_bvh_node(slots[lane]);
+            box = node->box;
+            out->child[lane] = node->first;
+            out->count[lane] = node->count;
+        }
+        out->min_x[lane] = box.min[0];
+        out->min_y[lane] = box.min[1];
+        out->min_z[lane] = box.min[2];
+        out->max_x[lane] = box.max[0];
+        out->max_y[lane] = box.max[1];
+        out->max_z[lane] = box.max[2];
+    }
+    for(int lane = 0; lane < used; lane++) {
+        if(hidden_cave_bvh_node(slots[lane])->count == 0) {
+            hidden_cave_BVH_Ref children[4];
+            int count = hidden_cave_bvh_open(collapse, slots[lane], children);
+            uint32_t child = hidden_cave_bvh_emit(collapse, children, count);
+            collapse->nodes[index].child[lane] = child;
+        }
+    }
+    return index;
+}
+
+static void hidden_cave_bvh_free_build(hidden_cave_BVH_Build* build, hidden_cave_BVH_Tree* top) {
+    for(size_t s = 0; s < build->subtree_count; s++) {
+        free(build->subtrees[s].tree.nodes);
+    }
+    free(build->subtrees);
+    free(build->prims);
+    free(build->worker_bins);
+    free(build->worker_boxes);
+    free(top->nodes);
+}
+
+//builds `dest` over `tris`, which it takes ownership of
+static CaveError hidden_cave_bvh_build(cave_BVH* dest, cave_3d_Triangle* tris, size_t tri_count, size_t threads) {
+    memset(dest, 0, sizeof(cave_BVH));
+    if(tri_count == 0) {
+        free(tris);
+        return CAVE_NO_ERROR;
+    }
+    threads = threads > 0 ? threads : cave_thread_hardware_count();
+    hidden_cave_BVH_Build build = {tris, NULL, threads, 0, NULL, 0, 0, NULL, NULL, CAVE_NO_ERROR};
+    build.subtree_size = (uint32_t) (tri_count / 64 > CAVE_BVH_SUBTREE_MIN ? tri_count / 64 : CAVE_BVH_SUBTREE_MIN);
+    build.prims = malloc(sizeof(hidden_cave_BVH_Prim) * tri_count);
+    uint32_t* ids = malloc(sizeof(uint32_t) * tri_count);
+    build.worker_bins = malloc(sizeof(hidden_cave_BVH_Bins) * threads);
+    build.worker_boxes = malloc(sizeof(hidden_cave_Box) * threads);
+    hidden_cave_BVH_Tree top = {NULL, 0, 0};
+    if(!build.prims || !ids || !build.worker_bins || !build.worker_boxes) {
+        build.err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(build.err == CAVE_NO_ERROR) {
+        build.err = cave_parallel_for(tri_count, CAVE_BVH_PARALLEL_GRAIN, threads, hidden_cave_bvh_prepare_chunk,
+                                      &build);
+    }
+    if(build.err == CAVE_NO_ERROR) {
+        hidden_cave_Box box = hidden_cave_box_empty();
+        for(size_t i = 0; i < tri_count; i++) {
+            hidden_cave_box_grow(&box, &build.prims[i].box);
+        }
+        hidden_cave_bvh_build_node(&build, &top, 0, (uint32_t) tri_count, &box, 0);
+    }
+    if(build.err == CAVE_NO_ERROR) {
+        build.err = cave_parallel_for(build.subtree_count, 1, threads, hidden_cave_bvh_subtree_chunk, &build);
+    }
+
+    //there are fewer inner nodes than leaves, and each node of the collapsed tree takes the place of at least one
+    hidden_cave_BVH_Collapse collapse = {&build, NULL, 0};
+    if(build.err == CAVE_NO_ERROR) {
+        collapse.nodes = malloc(sizeof(cave_BVH_Node) * tri_count);
+        dest->tris = malloc(sizeof(cave_3d_Triangle) * tri_count);
+        build.err = collapse.nodes && dest->tris ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(build.err == CAVE_NO_ERROR) {
+        hidden_cave_BVH_Ref root = {&top, 0};
+        root = hidden_cave_bvh_resolve(&collapse, root);
+        if(hidden_cave_bvh_node(root)->count > 0) {
+            hidden_cave_bvh_emit(&collapse, &root, 1);
+        } else {
+            hidden_cave_BVH_Ref children[4];
+            int count = hidden_cave_bvh_open(&collapse, root, children);
+            hidden_cave_bvh_emit(&collapse, children, count);
+        }
+    }
+    if(build.err == CAVE_NO_ERROR) {
+        for(size_t i = 0; i < tri_count; i++) {
+            ids[i] = build.prims[i].id;
+            dest->tris[i] = tris[ids[i]];
+        }
+    }
+    hidden_cave_bvh_free_build(&build, &top);
+    free(tris);
+    if(build.err != CAVE_NO_ERROR) {
+        free(collapse.nodes);
+        free(dest->tris);
+        free(ids);
+        memset(dest, 0, sizeof(cave_BVH));
+        return build.err;
+    }
+    cave_BVH_Node* nodes = realloc(collapse.nodes, sizeof(cave_BVH_Node) * collapse.count);
+    dest->nodes = nodes ? nodes : collapse.nodes;
+    dest->node_count = collapse.count;
+    dest->tri_ids = ids;
+    dest->tri_count = tri_count;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_BVH_build(cave_BVH* dest, cave_3d_Triangle const* tris, size_t tri_count, size_t threads) {
+    if(!dest || (!tris && tri_count > 0) || tri_count >= UINT32_MAX) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_3d_Triangle* copy = malloc(sizeof(cave_3d_Triangle) * (tri_count > 0 ? tri_count : 1));
+    if(!copy) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(tri_count > 0) {
+        memcpy(copy, tris, sizeof(cave_3d_Triangle) * tri_count);
+    }
+    return hidden_cave_bvh_build(dest, copy, tri_count, threads);
+}
+
+CaveError cave_BVH_build_Mesh(cave_BVH* dest, cave_Mesh const* mesh, size_t threads) {
+    if(!dest || !mesh || mesh->tri_count >= UINT32_MAX) {
+        return CAVE_DATA_ERROR;
+    }
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        if(t.a >= mesh->vert_count || t.b >= mesh->vert_count || t.c >= mesh->vert_count) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+    cave_3d_Triangle* tris = malloc(sizeof(cave_3d_Triangle) * (mesh->tri_count > 0 ? mesh->tri_count : 1));
+    if(!tris) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        cave_3d_Triangle tri = {mesh->positions[t.a], mesh->positions[t.b], mesh->positions[t.c]};
+        tris[i] = tri;
+    }
+    return hidden_cave_bvh_build(dest, tris, mesh->tri_count, threads);
+}
+
+CaveError cave_BVH_build_STL(cave_BVH* dest, cave_STL_Data const* data, size_t threads) {
+    if(!dest || !data || (!data->tris && data->tri_count > 0) || data->tri_count == UINT32_MAX) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_3d_Triangle* tris = malloc(sizeof(cave_3d_Triangle) * (data->tri_count > 0 ? data->tri_count : 1));
+    if(!tris) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < data->tri_count; i++) {
+        cave_3d_Triangle tri = {data->tris[i].a, data->tris[i].b, data->tris[i].c};
+        tris[i] = tri;
+    }
+    return hidden_cave_bvh_build(dest, tris, data->tri_count, threads);
+}
+
+void cave_BVH_release(cave_BVH* bvh) {
+    if(!bvh) { return; }
+    free(bvh->nodes);
+    free(bvh->tris);
+    free(bvh->tri_ids);
+    memset(bvh, 0, sizeof(cave_BVH));
+}
+
+/*
+ * Queries
+ */
+
+//fminf and fmaxf handle NaNs in a way SSE's min and max don't, so compilers call them rather than inline them
+static float hidden_cave_min(float a, float b) {
+    return a < b ? a : b;
+}
+
+static float hidden_cave_max(float a, float b) {
+    return a > b ? a : b;
+}
+
+typedef struct hidden_cave_Ray_Setup {
+    float origin[3];
+    float inv_dir[3];
+} hidden_cave_Ray_Setup;
+
+static hidden_cave_Ray_Setup hidden_cave_ray_setup(cave_Ray const* ray) {
+    hidden_cave_Ray_Setup setup = {{ray->origin.x, ray->origin.y, ray->origin.z}, {0.0f, 0.0f, 0.0f}};
+    float const dir[3] = {ray->dir.x, ray->dir.y, ray->dir.z};
+    for(int k = 0; k < 3; k++) {
+        //an enormous but finite reciprocal keeps 0 * (1 / 0) from making NaNs of rays parallel to a slab
+        setup.inv_dir[k] = dir[k] != 0.0f ? 1.0f / dir[k] : copysignf(FLT_MAX, dir[k]);
+    }
+    return setup;
+}
+
+//tests the ray against the four boxes of `node` at once, with their coordinates side by side. Returns a bit per
+//child hit within [t_min, t_max], with how far along the ray each box starts in `t_near`.
+static int hidden_cave_bvh_ray_boxes(cave_BVH_Node const* node, hidden_cave_Ray_Setup const* ray, float t_min,
+                                     float t_max, float* t_near) {
+    int mask = 0;
+    for(int lane = 0; lane < 4; lane++) {
+        float x0 = (node->min_x[lane] - ray->origin[0]) * ray->inv_dir[0];
+        float x1 = (node->max_x[lane] - ray->origin[0]) * ray->inv_dir[0];
+        float y0 = (node->min_y[lane] - ray->origin[1]) * ray->inv_dir[1];
+        float y1 = (node->max_y[lane] - ray->origin[1]) * ray->inv_dir[1];
+        float z0 = (node->min_z[lane] - ray->origin[2]) * ray->inv_dir[2];
+        float z1 = (node->max_z[lane] - ray->origin[2]) * ray->inv_dir[2];
+        float near = hidden_cave_max(hidden_cave_max(hidden_cave_min(x0, x1), hidden_cave_min(y0, y1)),
+                                     hidden_cave_max(hidden_cave_min(z0, z1), t_min));
+        float far = hidden_cave_min(hidden_cave_min(hidden_cave_max(x0, x1), hidden_cave_max(y0, y1)),
+                                    hidden_cave_min(hidden_cave_max(z0, z1), t_max));
+        t_near[lane] = near;
+        mask |= (near <= far && node->child[lane] != CAVE_BVH_EMPTY) << lane;
+    }
+    return mask;
+}
+
+//the squared distances from `p` to the four boxes of `node`
+static void hidden_cave_bvh_point_boxes(cave_BVH_Node const* node, float const* p, float* dist2) {
+    for(int lane = 0; lane < 4; lane++) {
+        float dx = hidden_cave_max(hidden_cave_max(node->min_x[lane] - p[0], p[0] - node->max_x[lane]), 0.0f);
+        float dy = hidden_cave_max(hidden_cave_max(node->min_y[lane] - p[1], p[1] - node->max_y[lane]), 0.0f);
+        float dz = hidden_cave_max(hidden_cave_max(node->min_z[lane] - p[2], p[2] - node->max_z[lane]), 0.0f);
+        dist2[lane] = node->child[lane] != CAVE_BVH_EMPTY ? dx * dx + dy * dy + dz * dz : INFINITY;
+    }
+}
+
+//sorts the lanes in `mask` by `key`, nearest first, and returns how many there are
+static int hidden_cave_bvh_order(int mask, float const* key, int* lanes) {
+    int count = 0;
+    for(int lane = 0; lane < 4; lane++) {
+        if(!(mask >> lane & 1)) {
+            continue;
+        }
+        int at = count++;
+        while(at > 0 && key[lanes[at - 1]] > key[lane]) {
+            lanes[at] = lanes[at - 1];
+            at--;
+        }
+        lanes[at] = lane;
+    }
+    return count;
+}
+
+//Moller-Trumbore, from either side
+static bool hidden_cave_ray_triangle(cave_3d_Triangle const* tri, cave_Ray const* ray, float t_max, float* t,
+                                     float* u, float* v) {
+    float e1[3] = {tri->b.x - tri->a.x, tri->b.y - tri->a.y, tri->b.z - tri->a.z};
+    float e2[3] = {tri->c.x - tri->a.x, tri->c.y - tri->a.y, tri->c.z - tri->a.z};
+    float d[3] = {ray->dir.x, ray->dir.y, ray->dir.z};
+    float p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+    float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if(det == 0.0f) {
+        return false;
+    }
+    float inv_det = 1.0f / det;
+    float s[3] = {ray->origin.x - tri->a.x, ray->origin.y - tri->a.y, ray->origin.z - tri->a.z};
+    float hit_u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv_det;
+    if(!(hit_u >= 0.0f && hit_u <= 1.0f)) {
+        return false;
+    }
+    float q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+    float hit_v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv_det;
+    if(!(hit_v >= 0.0f && hit_u + hit_v <= 1.0f)) {
+        return false;
+    }
+    float hit_t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv_det;
+    if(!(hit_t >= ray->t_min && hit_t <= t_max)) {
+        return false;
+    }
+    *t = hit_t;
+    *u = hit_u;
+    *v = hit_v;
+    return true;
+}
+
+//walks the tree for the first hit, or for any hit if `hit` is NULL
+static bool hidden_cave_bvh_cast(cave_BVH const* bvh, cave_Ray const* ray, cave_Ray_Hit* hit) {
+    if(bvh->node_count == 0) {
+        return false;
+    }
+    hidden_cave_Ray_Setup setup = hidden_cave_ray_setup(ray);
+    float t_max = ray->t_max;
+    bool found = false;
+    //entries remember where their box starts, so ones beyond a hit found since are skipped
+    uint32_t stack[CAVE_BVH_STACK];
+    float stack_t[CAVE_BVH_STACK];
+    int top = 0;
+    stack[top] = 0;
+    stack_t[top++] = ray->t_min;
+    while(top > 0) {
+        top--;
+        if(stack_t[top] > t_max) {
+            continue;
+        }
+        cave_BVH_Node const* node = bvh->nodes + stack[top];
+        float t_near[4];
+        int lanes[4];
+        int mask = hidden_cave_bvh_ray_boxes(node, &setup, ray->t_min, t_max, t_near);
+        int count = hidden_cave_bvh_order(mask, t_near, lanes);
+        //leaves are tested nearest first, which shortens the ray for the rest, and inner nodes are pushed
+        //farthest first so that the nearest comes off the stack next
+        for(int i = count - 1; i >= 0; i--) {
+            int lane = lanes[i];
+            if(node->count[lane] == 0) {
+                stack[top] = node->child[lane];
+                stack_t[top++] = t_near[lane];
+            }
+        }
+        for(int i = 0; i < count; i++) {
+            int lane = lanes[i];
+            if(node->count[lane] == 0 || t_near[lane] > t_max) {
+                continue;
+            }
+            for(uint32_t k = node->child[lane]; k < node->child[lane] + node->count[lane]; k++) {
+                float t, u, v;
+                if(!hidden_cave_ray_triangle(bvh->tris + k, ray, t_max, &t, &u, &v)) {
+                    continue;
+                }
+                if(!hit) {
+                    return true;
+                }
+                found = true;
+                t_max = t;
+                hit->tri = bvh->tri_ids[k];
+                hit->t = t;
+                hit->u = u;
+                hit->v = v;
+            }
+        }
+    }
+    return found;
+}
+
+bool cave_BVH_first_hit(cave_BVH const* bvh, cave_Ray const* ray, cave_Ray_Hit* hit) {
+    if(!hit) {
+        return false;
+    }
+    cave_Ray_Hit miss = {SIZE_MAX, INFINITY, 0.0f, 0.0f};
+    *hit = miss;
+    if(!bvh || !ray) {
+        return false;
+    }
+    return hidden_cave_bvh_cast(bvh, ray, hit);
+}
+
+bool cave_BVH_any_hit(cave_BVH const* bvh, cave_Ray const* ray) {
+    if(!bvh || !ray) {
+        return false;
+    }
+    return hidden_cave_bvh_cast(bvh, ray, NULL);
+}
+
+//the nearest point to `p` on triangle abc, by which of its regions p is in (Ericson, Real-Time Collision
+//Detection, 5.1.5)
+static cave_3Point hidden_cave_closest_on_triangle(cave_3Point p, cave_3d_Triangle const* tri) {
+    cave_3Point a = tri->a, b = tri->b, c = tri->c;
+    float ab[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+    float ac[3] = {c.x - a.x, c.y - a.y, c.z - a.z};
+    float ap[3] = {p.x - a.x, p.y - a.y, p.z - a.z};
+    float d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+    float d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+    if(d1 <= 0.0f && d2 <= 0.0f) {
+        return a;
+    }
+    float bp[3] = {p.x - b.x, p.y - b.y, p.z - b.z};
+    float d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+    float d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+    if(d3 >= 0.0f && d4 <= d3) {
+        return b;
+    }
+    float vc = d1 * d4 - d3 * d2;
+    if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        float v = d1 / (d1 - d3);
+        return (cave_3Point) {a.x + v * ab[0], a.y + v * ab[1], a.z + v * ab[2]};
+    }
+    float cp[3] = {p.x - c.x, p.y - c.y, p.z - c.z};
+    float d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+    float d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+    if(d6 >= 0.0f && d5 <= d6) {
+        return c;
+    }
+    float vb = d5 * d2 - d1 * d6;
+    if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        float w = d2 / (d2 - d6);
+        return (cave_3Point) {a.x + w * ac[0], a.y + w * ac[1], a.z + w * ac[2]};
+    }
+    float va = d3 * d6 - d5 * d4;
+    if(va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) {
+        float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return (cave_3Point) {b.x + w * (c.x - b.x), b.y + w * (c.y - b.y), b.z + w * (c.z - b.z)};
+    }
+    float denom = va + vb + vc;
+    if(!(denom != 0.0f)) {
+        //degenerate, and p is off the end of none of its edges
+        return a;
+    }
+    float v = vb / denom, w = vc / denom;
+    return (cave_3Point) {a.x + ab[0] * v + ac[0] * w, a.y + ab[1] * v + ac[1] * w, a.z + ab[2] * v + ac[2] * w};
+}
+
+bool cave_BVH_closest_point(cave_BVH const* bvh, cave_3Point point, float max_distance, cave_Closest_Hit* hit) {
+    if(!hit) {
+        return false;
+    }
+    cave_Closest_Hit none = {SIZE_MAX, {0.0f, 0.0f, 0.0f}, INFINITY};
+    *hit = none;
+    if(!bvh || bvh->node_count == 0 || !(max_distance >= 0.0f)) {
+        return false;
+    }
+    float const p[3] = {point.x, point.y, point.z};
+    float best = max_distance * max_distance;
+    bool found = false;
+    //entries remember how far their box was, so ones that a closer point has since ruled out are skipped
+    uint32_t stack[CAVE_BVH_STACK];
+    float stack_dist2[CAVE_BVH_STACK];
+    int top = 0;
+    stack[top] = 0;
+    stack_dist2[top++] = 0.0f;
+    while(top > 0) {
+        top--;
+        if(stack_dist2[top] > best) {
+            continue;
+        }
+        cave_BVH_Node const* node = bvh->nodes + stack[top];
+        float dist2[4];
+        int lanes[4];
+        hidden_cave_bvh_point_boxes(node, p, dist2);
+        int mask = 0;
+        for(int lane = 0; lane < 4; lane++) {
+            mask |= (dist2[lane] <= best) << lane;
+        }
+        int count = hidden_cave_bvh_order(mask, dist2, lanes);
+        for(int i = count - 1; i >= 0; i--) {
+            int lane = lanes[i];
+            if(node->count[lane] == 0) {
+                stack[top] = node->child[lane];
+                stack_dist2[top++] = dist2[lane];
+            }
+        }
+        for(int i = 0; i < count; i++) {
+            int lane = lanes[i];
+            if(node->count[lane] == 0 || dist2[lane] > best) {
+                continue;
+            }
+            for(uint32_t k = node->child[lane]; k < node->child[lane] + node->count[lane]; k++) {
+                cave_3Point q = hidden_cave_closest_on_triangle(point, bvh->tris + k);
+                float dx = q.x - p[0], dy = q.y - p[1], dz = q.z - p[2];
+                float d2 = dx * dx + dy * dy + dz * dz;
+                if(d2 <= best && (!found || d2 < best)) {
+                    found = true;
+                    best = d2;
+                    hit->tri = bvh->tri_ids[k];
+                    hit->point = q;
+                }
+            }
+        }
+    }
+    if(found) {
+        hit->distance = sqrtf(best);
+    }
+    return found;
+}
+
+typedef struct hidden_cave_BVH_Batch {
+    cave_BVH const* bvh;
+    cave_Ray const* rays;
+    cave_3Point const* points;
+    float max_distance;
+    cave_Ray_Hit* hits;
+    bool* any;
+    cave_Closest_Hit* closest;
+} hidden_cave_BVH_Batch;
+
+static CaveError hidden_cave_bvh_batch_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    (void) worker;
+    hidden_cave_BVH_Batch const* batch = arg;
+    for(size_t i = begin; i < end; i++) {
+        if(batch->hits) {
+            cave_BVH_first_hit(batch->bvh, batch->rays + i, batch->hits + i);
+        } else if(batch->any) {
+            batch->any[i] = cave_BVH_any_hit(batch->bvh, batch->rays + i);
+        } else {
+            cave_BVH_closest_point(batch->bvh, batch->points[i], batch->max_distance, batch->closest + i);
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_bvh_batch(hidden_cave_BVH_Batch* batch, size_t count, size_t threads) {
+    threads = threads > 0 ? threads : cave_thread_hardware_count();
+    return cave_parallel_for(count, CAVE_BVH_QUERY_GRAIN, threads, hidden_cave_bvh_batch_chunk, batch);
+}
+
+CaveError cave_BVH_first_hits(cave_BVH const* bvh, cave_Ray const* rays, size_t count, cave_Ray_Hit* hits,
+                              size_t threads) {
+    if(!bvh || ((!rays || !hits) && count > 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_BVH_Batch batch = {bvh, rays, NULL, 0.0f, hits, NULL, NULL};
+    return hidden_cave_bvh_batch(&batch, count, threads);
+}
+
+CaveError cave_BVH_any_hits(cave_BVH const* bvh, cave_Ray const* rays, size_t count, bool* hit, size_t threads) {
+    if(!bvh || ((!rays || !hit) && count > 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_BVH_Batch batch = {bvh, rays, NULL, 0.0f, NULL, hit, NULL};
+    return hidden_cave_bvh_batch(&batch, count, threads);
+}
+
+CaveError cave_BVH_closest_points(cave_BVH const* bvh, cave_3Point const* points, size_t count,
+                                  float max_distance, cave_Closest_Hit* hits, size_t threads) {
+    if(!bvh || ((!points || !hits) && count > 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_BVH_Batch batch = {bvh, NULL, points, max_distance, NULL, NULL, hits};
+    return hidden_cave_bvh_batch(&batch, count, threads);
+}
@@ -0,0 +1,472 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-cache.h"
+#include "cave-utilities.h"
+#include "cave-writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <limits.h>
+
+#define CAVE_MESH_CACHE_VERSION (1)
+#define CAVE_MESH_CACHE_HEADER_SIZE (64)
+#define CAVE_MESH_CACHE_ALIGN (64)
+//the second hash guards against two different files that happen to share a key
+#define CAVE_MESH_CACHE_CHECK_SEED (0x9E3779B97F4A7C15ull)
+
+typedef struct hidden_cave_Entry_Layout {
+    uint64_t normals_offset;
+    uint64_t tris_offset;
+    uint64_t size;
+} hidden_cave_Entry_Layout;
+
+static uint64_t hidden_cave_align_up(uint64_t v) {
+    return (v + CAVE_MESH_CACHE_ALIGN - 1) & ~(uint64_t) (CAVE_MESH_CACHE_ALIGN - 1);
+}
+
+static hidden_cave_Entry_Layout hidden_cave_entry_layout(uint64_t vert_count, uint64_t tri_count, int has_normals) {
+    hidden_cave_Entry_Layout layout;
+    uint64_t end = CAVE_MESH_CACHE_HEADER_SIZE + vert_count * sizeof(cave_3Point);
+    layout.normals_offset = hidden_cave_align_up(end);
+    if(has_normals) {
+        end = layout.normals_offset + vert_count * sizeof(cave_3Point);
+    }
+    layout.tris_offset = hidden_cave_align_up(end);
+    layout.size = layout.tris_offset + tri_count * sizeof(cave_Index_Triangle);
+    return layout;
+}
+
+//mallocs the path of a file within the cache directory. `name` may be NULL to use the key.
+static char* hidden_cave_cache_path(cave_Mesh_Cache const* cache, uint64_t key, char const* name, char const* suffix) {
+    size_t len = strlen(cache->dir) + 64 + (name ? strlen(name) : 0);
+    char* path = malloc(len);
+    if(!path) {
+        return NULL;
+    }
+    if(name) {
+        snprintf(path, len, "%s/%s%s", cache->dir, name, suffix);
+    } else {
+        snprintf(path, len, "%s/%016" PRIx64 CAVE_MESH_CACHE_ENTRY_EXT "%s", cache->dir, key, suffix);
+    }
+    return path;
+}
+
+static cave_Mesh_Cache_Entry* hidden_cave_cache_find(cave_Mesh_Cache* cache, uint64_t key, size_t* index) {
+    for(size_t i = 0; i < cache->entries.len; i++) {
+        cave_Mesh_Cache_Entry* entry = cave_vec_at_unchecked(&cache->entries, i);
+        if(entry->key == key) {
+            if(index) { *index = i; }
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Index file
+ */
+
+static void hidden_cave_cache_read_index(cave_Mesh_Cache* cache) {
+    char* path = hidden_cave_cache_path(cache, 0, CAVE_MESH_CACHE_INDEX_NAME, "");
+    FILE* fp = path ? fopen(path, "rb") : NULL;
+    free(path);
+    if(!fp) {
+        return;
+    }
+    uint8_t header[24];
+    uint32_t version;
+    uint64_t count;
+    if(fread(header, 1, 24, fp) == 24 && memcmp(header, "CVCI", 4) == 0) {
+        memcpy(&version, header + 4, 4);
+        memcpy(&cache->clock, header + 8, 8);
+        memcpy(&count, header + 16, 8);
+        CaveError err = CAVE_NO_ERROR;
+        for(uint64_t i = 0; i < count && version == CAVE_MESH_CACHE_VERSION; i++) {
+            cave_Mesh_Cache_Entry entry;
+            if(fread(&entry, sizeof(entry), 1, fp) != 1) {
+                break;
+            }
+            cave_vec_push(&cache->entries, &entry, &err);
+            if(err != CAVE_NO_ERROR) {
+                break;
+            }
+            cache->total_bytes += entry.size;
+        }
+    }
+    fclose(fp);
+}
+
+CaveError cave_Mesh_Cache_sync(cave_Mesh_Cache* cache) {
+    if(!cache) {
+        return CAVE_DATA_ERROR;
+    }
+    char* tmp_path = hidden_cave_cache_path(cache, 0, CAVE_MESH_CACHE_INDEX_NAME, ".tmp");
+    char* path = hidden_cave_cache_path(cache, 0, CAVE_MESH_CACHE_INDEX_NAME, "");
+    if(!tmp_path || !path) {
+        free(tmp_path);
+        free(path);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+
+    CaveError result = CAVE_FILE_ERROR;
+    FILE* fp = fopen(tmp_path, "wb");
+    if(fp) {
+        uint8_t header[24];
+        uint32_t version = CAVE_MESH_CACHE_VERSION;
+        uint64_t count = cache->entries.len;
+        memcpy(header, "CVCI", 4);
+        memcpy(header + 4, &version, 4);
+        memcpy(header + 8, &cache->clock, 8);
+        memcpy(header + 16, &count, 8);
+        int ok = fwrite(header, 1, 24, fp) == 24;
+        if(ok && count > 0) {
+            ok = fwrite(cache->entries.data, sizeof(cave_Mesh_Cache_Entry), count, fp) == count;
+        }
+        ok = (fclose(fp) == 0) && ok;
+        //rename() won't replace an existing file everywhere, so clear the way first
+        if(ok && rename(tmp_path, path) != 0) {
+            remove(path);
+            ok = rename(tmp_path, path) == 0;
+        }
+        if(ok) {
+            result = CAVE_NO_ERROR;
+        } else {
+            remove(tmp_path);
+        }
+    }
+    free(tmp_path);
+    free(path);
+    return result;
+}
+
+CaveError cave_Mesh_Cache_open(cave_Mesh_Cache* cache, char const* dir, uint64_t max_bytes) {
+    if(!cache || !dir) {
+        return CAVE_DATA_ERROR;
+    }
+    memset(cache, 0, sizeof(cave_Mesh_Cache));
+    cache->max_bytes = max_bytes;
+    cache->dir = malloc(strlen(dir) + 1);
+    CaveError err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    if(!cache->dir || !cave_vec_init(&cache->entries, sizeof(cave_Mesh_Cache_Entry), 0, &err)) {
+        free(cache->dir);
+        return err;
+    }
+    strcpy(cache->dir, dir);
+    hidden_cave_cache_read_index(cache);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_Mesh_Cache_close(cave_Mesh_Cache* cache) {
+    if(!cache) {
+        return CAVE_NO_ERROR;
+    }
+    CaveError err = cave_Mesh_Cache_sync(cache);
+    free(cache->dir);
+    cave_vec_release(&cache->entries);
+    memset(cache, 0, sizeof(cave_Mesh_Cache));
+    return err;
+}
+
+/*
+ * Eviction
+ */
+
+static void hidden_cave_cache_forget(cave_Mesh_Cache* cache, size_t index) {
+    CaveError err;
+    cave_Mesh_Cache_Entry* entry = cave_vec_at_unchecked(&cache->entries, index);
+    cache->total_bytes -= entry->size < cache->total_bytes ? entry->size : cache->total_bytes;
+    cave_vec_remove_at(&cache->entries, NULL, index, &err);
+}
+
+static void hidden_cave_cache_evict(cave_Mesh_Cache* cache) {
+    if(cache->max_bytes == 0) {
+        return;
+    }
+    while(cache->total_bytes > cache->max_bytes && cache->entries.len > 0) {
+        size_t oldest = 0;
+        for(size_t i = 1; i < cache->entries.len; i++) {
+            cave_Mesh_Cache_Entry* a = cave_vec_at_unchecked(&cache->entries, i);
+            cave_Mesh_Cache_Entry* b = cave_vec_at_unchecked(&cache->entries, oldest);
+            if(a->last_used < b->last_used) {
+                oldest = i;
+            }
+        }
+        cave_Mesh_Cache_Entry* victim = cave_vec_at_unchecked(&cache->entries, oldest);
+        char* path = hidden_cave_cache_path(cache, victim->key, NULL, "");
+        if(path) {
+            remove(path);
+            free(path);
+        }
+        hidden_cave_cache_forget(cache, oldest);
+        cache->evictions += 1;
+    }
+}
+
+//marks `key` as just used, adding it to the index if it isn't there yet
+static void hidden_cave_cache_touch(cave_Mesh_Cache* cache, uint64_t key, uint64_t size) {
+    cache->clock += 1;
+    cave_Mesh_Cache_Entry* entry = hidden_cave_cache_find(cache, key, NULL);
+    if(entry) {
+        cache->total_bytes = cache->total_bytes - entry->size + size;
+        entry->size = size;
+        entry->last_used = cache->clock;
+        return;
+    }
+    CaveError err;
+    cave_Mesh_Cache_Entry new_entry = {key, size, cache->clock};
+    if(cave_vec_push(&cache->entries, &new_entry, &err)) {
+        cache->total_bytes += size;
+    }
+}
+
+/*
+ * Entry files
+ */
+
+static void hidden_cave_entry_header(uint8_t* header, cave_Mesh const* mesh, uint64_t key, uint64_t check, uint64_t source_len) {
+    uint32_t version = CAVE_MESH_CACHE_VERSION;
+    uint32_t size_t_size = sizeof(size_t);
+    uint32_t flags = mesh->normals ? 1 : 0;
+    uint64_t vert_count = mesh->vert_count;
+    uint64_t tri_count = mesh->tri_count;
+    memset(header, 0, CAVE_MESH_CACHE_HEADER_SIZE);
+    memcpy(header, "CVMC", 4);
+    memcpy(header + 4, &version, 4);
+    memcpy(header + 8, &size_t_size, 4);
+    memcpy(header + 12, &flags, 4);
+    memcpy(header + 16, &key, 8);
+    memcpy(header + 24, &check, 8);
+    memcpy(header + 32, &source_len, 8);
+    memcpy(header + 40, &vert_count, 8);
+    memcpy(header + 48, &tri_count, 8);
+}
+
+typedef struct hidden_cave_Entry_Header {
+    uint32_t flags;
+    uint64_t key;
+    uint64_t check;
+    uint64_t source_len;
+    uint64_t vert_count;
+    uint64_t tri_count;
+} hidden_cave_Entry_Header;
+
+static CaveError hidden_cave_entry_parse_header(hidden_cave_Entry_Header* dest, uint8_t const* header) {
+    uint32_t version, size_t_size;
+    if(memcmp(header, "CVMC", 4) != 0) {
+        return CAVE_DATA_ERROR;
+    }
+    memcpy(&version, header + 4, 4);
+    memcpy(&size_t_size, header + 8, 4);
+    memcpy(&dest->flags, header + 12, 4);
+    memcpy(&dest->key, header + 16, 8);
+    memcpy(&dest->check, header + 24, 8);
+    memcpy(&dest->source_len, header + 32, 8);
+    memcpy(&dest->vert_count, header + 40, 8);
+    memcpy(&dest->tri_count, header + 48, 8);
+    if(version != CAVE_MESH_CACHE_VERSION || size_t_size != sizeof(size_t) ||
+       dest->vert_count > SIZE_MAX / sizeof(cave_3Point) || dest->tri_count > SIZE_MAX / sizeof(cave_Index_Triangle)) {
+        return CAVE_DATA_ERROR;
+    }
+    return CAVE_NO_ERROR;
+}
+
+static int hidden_cave_write_padded(FILE* fp, void const* data, size_t len, uint64_t* offset, uint64_t target) {
+    static uint8_t const zeros[CAVE_MESH_CACHE_ALIGN] = {0};
+    if(target > *offset && fwrite(zeros, 1, (size_t) (target - *offset), fp) != target - *offset) {
+        return 0;
+    }
+    *offset = target;
+    if(len > 0 && fwrite(data, 1, len, fp) != len) {
+        return 0;
+    }
+    *offset += len;
+    return 1;
+}
+
+//writes the entry to a temporary file and then moves it into place, so readers never see a
+//partial entry. Returns the size of the entry, or 0 if it couldn't be written.
+static uint64_t hidden_cave_entry_write(cave_Mesh_Cache* cache, cave_Mesh const* mesh,
+                                        uint64_t key, uint64_t check, uint64_t source_len) {
+    char* tmp_path = hidden_cave_cache_path(cache, key, NULL, ".tmp");
+    char* path = hidden_cave_cache_path(cache, key, NULL, "");
+    FILE* fp = (tmp_path && path) ? fopen(tmp_path, "wb") : NULL;
+    if(!fp) {
+        free(tmp_path);
+        free(path);
+        return 0;
+    }
+
+    hidden_cave_Entry_Layout layout = hidden_cave_entry_layout(mesh->vert_count, mesh->tri_count, mesh->normals != NULL);
+    uint8_t header[CAVE_MESH_CACHE_HEADER_SIZE];
+    hidden_cave_entry_header(header, mesh, key, check, source_len);
+    uint64_t offset = 0;
+    int ok = hidden_cave_write_padded(fp, header, CAVE_MESH_CACHE_HEADER_SIZE, &offset, 0) &&
+             hidden_cave_write_padded(fp, mesh->positions, mesh->vert_count * sizeof(cave_3Point),
+                                      &offset, CAVE_MESH_CACHE_HEADER_SIZE);
+    if(ok && mesh->normals) {
+        ok = hidden_cave_write_padded(fp, mesh->normals, mesh->vert_count * sizeof(cave_3Point),
+                                      &offset, layout.normals_offset);
+    }
+    ok = ok && hidden_cave_write_padded(fp, mesh->tris, mesh->tri_count * sizeof(cave_Index_Triangle),
+                                        &offset, layout.tris_offset);
+    ok = (fclose(fp) == 0) && ok;
+    if(ok && rename(tmp_path, path) != 0) {
+        remove(path);
+        ok = rename(tmp_path, path) == 0;
+    }
+    if(!ok) {
+        remove(tmp_path);
+    }
+    free(tmp_path);
+    free(path);
+    return ok ? layout.size : 0;
+}
+
+static int hidden_cave_read_at(FILE* fp, void* dest, size_t len, uint64_t offset) {
+    if(len == 0) {
+        return 1;
+    }
+    if(offset > LONG_MAX || fseek(fp, (long) offset, SEEK_SET) != 0) {
+        return 0;
+    }
+    return fread(dest, 1, len, fp) == len;
+}
+
+//tries to serve `dest` from the entry file for `key`. Returns the entry's size on a hit and 0 on a miss.
+static uint64_t hidden_cave_entry_read(cave_Mesh_Cache* cache, cave_Mesh* dest,
+                                       uint64_t key, uint64_t check, uint64_t source_len) {
+    char* path = hidden_cave_cache_path(cache, key, NULL, "");
+    FILE* fp = path ? fopen(path, "rb") : NULL;
+    free(path);
+    if(!fp) {
+        return 0;
+    }
+    uint8_t header_bytes[CAVE_MESH_CACHE_HEADER_SIZE];
+    hidden_cave_Entry_Header header;
+    if(fread(header_bytes, 1, CAVE_MESH_CACHE_HEADER_SIZE, fp) != CAVE_MESH_CACHE_HEADER_SIZE ||
+       hidden_cave_entry_parse_header(&header, header_bytes) != CAVE_NO_ERROR ||
+       header.key != key || header.check != check || header.source_len != source_len) {
+        fclose(fp);
+        return 0;
+    }
+    //the counts must describe this very file before anything is allocated from them
+    long file_len = cave_file_len(fp);
+    if(file_len < 0 || header.vert_count > (uint64_t) file_len || header.tri_count > (uint64_t) file_len) {
+        fclose(fp);
+        return 0;
+    }
+    hidden_cave_Entry_Layout layout = hidden_cave_entry_layout(header.vert_count, header.tri_count, header.flags & 1);
+    if(layout.size != (uint64_t) file_len) {
+        fclose(fp);
+        return 0;
+    }
+
+    memset(dest, 0, sizeof(cave_Mesh));
+    dest->vert_count = (size_t) header.vert_count;
+    dest->tri_count = (size_t) header.tri_count;
+    size_t positions_len = dest->vert_count * sizeof(cave_3Point);
+    size_t tris_len = dest->tri_count * sizeof(cave_Index_Triangle);
+    int ok = 1;
+    if(dest->vert_count) {
+        dest->positions = malloc(positions_len);
+        dest->normals = (header.flags & 1) ? malloc(positions_len) : NULL;
+        ok = dest->positions && (dest->normals || !(header.flags & 1));
+    }
+    if(ok && dest->tri_count) {
+        dest->tris = malloc(tris_len);
+        ok = dest->tris != NULL;
+    }
+    ok = ok && hidden_cave_read_at(fp, dest->positions, positions_len, CAVE_MESH_CACHE_HEADER_SIZE);
+    if(ok && dest->normals) {
+        ok = hidden_cave_read_at(fp, dest->normals, positions_len, layout.normals_offset);
+    }
+    ok = ok && hidden_cave_read_at(fp, dest->tris, tris_len, layout.tris_offset);
+    fclose(fp);
+
+    if(ok) {
+        for(size_t i = 0; i < dest->tri_count; i++) {
+            cave_Index_Triangle t = dest->tris[i];
+            if(t.a >= dest->vert_count || t.b >= dest->vert_count || t.c >= dest->vert_count) {
+                ok = 0;
+                break;
+            }
+        }
+    }
+    if(!ok) {
+        cave_Mesh_release(dest);
+        return 0;
+    }
+    return layout.size;
+}
+
+CaveError cave_Mesh_Cache_load_STL(cave_Mesh_Cache* cache, cave_Mesh* dest, uint8_t const* bytes, size_t bytes_len) {
+    if(!cache || !dest || !bytes) {
+        return CAVE_DATA_ERROR;
+    }
+    uint64_t key = cave_hash64(bytes, bytes_len, 0);
+    uint64_t check = cave_hash64(bytes, bytes_len, CAVE_MESH_CACHE_CHECK_SEED);
+
+    uint64_t size = hidden_cave_entry_read(cache, dest, key, check, bytes_len);
+    if(size) {
+        cache->hits += 1;
+        hidden_cave_cache_touch(cache, key, size);
+        return CAVE_NO_ERROR;
+    }
+    cache->misses += 1;
+
+    //a stale or corrupt entry may still be in the index
+    size_t stale;
+    if(hidden_cave_cache_find(cache, key, &stale)) {
+        hidden_cave_cache_forget(cache, stale);
+    }
+
+    cave_STL_Data stl;
+    //`cave_bytes_to_STL_Data` only reads from `bytes`
+    CaveError err = cave_bytes_to_STL_Data(&stl, (uint8_t*) bytes, bytes_len);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    err = cave_STL_Data_to_Mesh(dest, &stl);
+    cave_STL_Data_release(&stl);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    err = cave_Mesh_compute_vertex_normals(dest);
+    if(err != CAVE_NO_ERROR) {
+        cave_Mesh_release(dest);
+        return err;
+    }
+
+    size = hidden_cave_entry_write(cache, dest, key, check, bytes_len);
+    if(size) {
+        hidden_cave_cache_touch(cache, key, size);
+        hidden_cave_cache_evict(cache);
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_Mesh_Cache_entry_view(cave_Mesh* view, uint8_t const* bytes, size_t bytes_len) {
+    if(!view || !bytes || ((uintptr_t) bytes) % 8 != 0 || bytes_len < CAVE_MESH_CACHE_HEADER_SIZE) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_Entry_Header header;
+    if(hidden_cave_entry_parse_header(&header, bytes) != CAVE_NO_ERROR ||
+       header.vert_count > bytes_len || header.tri_count > bytes_len) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_Entry_Layout layout = hidden_cave_entry_layout(header.vert_count, header.tri_count, header.flags & 1);
+    if(layout.size > bytes_len) {
+        return CAVE_DATA_ERROR;
+    }
+    //the mesh is only borrowed, but `cave_Mesh` has no const members
+    view->positions = (cave_3Point*) (bytes + CAVE_MESH_CACHE_HEADER_SIZE);
+    view->normals = (header.flags & 1) ? (cave_3Point*) (bytes + layout.normals_offset) : NULL;
+    view->tris = (cave_Index_Triangle*) (bytes + layout.tris_offset);
+    view->vert_count = (size_t) header.vert_count;
+    view->tri_count = (size_t) header.tri_count;
+    return CAVE_NO_ERROR;
+}
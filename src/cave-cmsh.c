@@ -0,0 +1,688 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-cmsh.h"
+#include "cave-lz.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+#define CAVE_CMSH_HEADER_SIZE (64)
+#define CAVE_CMSH_STREAM_COUNT (3)
+#define CAVE_CMSH_TABLE_SIZE (CAVE_CMSH_STREAM_COUNT * 24)
+#define CAVE_CMSH_FLAG_NORMALS (1u)
+//set on a block's stored length when the payload did not compress and is stored as is
+#define CAVE_CMSH_RAW_BLOCK (0x80000000u)
+
+enum {
+    CAVE_CMSH_POSITIONS = 0,
+    CAVE_CMSH_NORMALS = 1,
+    CAVE_CMSH_INDEXES = 2,
+};
+
+//like the STL code, these assume a little endian host.
+static void hidden_cave_put_u32(uint8_t* dest, uint32_t v) { memcpy(dest, &v, 4); }
+static void hidden_cave_put_u64(uint8_t* dest, uint64_t v) { memcpy(dest, &v, 8); }
+static uint32_t hidden_cave_get_u32(uint8_t const* src) { uint32_t v; memcpy(&v, src, 4); return v; }
+static uint64_t hidden_cave_get_u64(uint8_t const* src) { uint64_t v; memcpy(&v, src, 8); return v; }
+
+static uint16_t hidden_cave_zigzag16(uint16_t delta) {
+    int16_t d = (int16_t) delta;
+    return (uint16_t) (((uint16_t) d << 1) ^ (uint16_t) (d >> 15));
+}
+
+static uint16_t hidden_cave_unzigzag16(uint16_t z) {
+    return (uint16_t) ((z >> 1) ^ (uint16_t) -(int16_t) (z & 1));
+}
+
+/*
+ * Growable output buffer
+ */
+
+typedef struct hidden_cave_Out_Buffer {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+} hidden_cave_Out_Buffer;
+
+static CaveError hidden_cave_out_reserve(hidden_cave_Out_Buffer* out, size_t extra) {
+    if(out->cap - out->len >= extra) {
+        return CAVE_NO_ERROR;
+    }
+    size_t cap = out->cap ? out->cap : 4096;
+    while(cap - out->len < extra) {
+        cap *= 2;
+    }
+    uint8_t* ret = realloc(out->data, cap);
+    if(!ret) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    out->data = ret;
+    out->cap = cap;
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_out_pad(hidden_cave_Out_Buffer* out, size_t alignment) {
+    size_t padding = (alignment - (out->len % alignment)) % alignment;
+    CaveError err = hidden_cave_out_reserve(out, padding);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    memset(out->data + out->len, 0, padding);
+    out->len += padding;
+    return CAVE_NO_ERROR;
+}
+
+/*
+ * Stream writer: gathers whole items into a block, and compresses the block when the next item
+ * would not fit.
+ */
+
+typedef struct hidden_cave_Stream_Writer {
+    hidden_cave_Out_Buffer* out;
+    //if true, the block is made of uint16_t values that get split into a low and high byte plane
+    bool shuffle16;
+    uint8_t raw[CAVE_CMSH_BLOCK_SIZE];
+    uint8_t planes[CAVE_CMSH_BLOCK_SIZE];
+    size_t raw_len;
+    uint64_t total_raw;
+    size_t start;
+} hidden_cave_Stream_Writer;
+
+static CaveError hidden_cave_stream_flush(hidden_cave_Stream_Writer* sw) {
+    if(sw->raw_len == 0) {
+        return CAVE_NO_ERROR;
+    }
+    uint8_t const* block = sw->raw;
+    if(sw->shuffle16) {
+        size_t count = sw->raw_len / 2;
+        for(size_t i = 0; i < count; i++) {
+            sw->planes[i] = sw->raw[2 * i];
+            sw->planes[count + i] = sw->raw[2 * i + 1];
+        }
+        block = sw->planes;
+    }
+
+    CaveError err = hidden_cave_out_reserve(sw->out, 8 + cave_lz_compress_bound(sw->raw_len) + 4);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    uint8_t* header = sw->out->data + sw->out->len;
+    uint8_t* payload = header + 8;
+    size_t stored_len = 0;
+    uint32_t stored_field;
+    err = cave_lz_compress(payload, sw->raw_len, &stored_len, block, sw->raw_len);
+    if(err == CAVE_NO_ERROR) {
+        stored_field = (uint32_t) stored_len;
+    } else {
+        //didn't shrink, so store the block as is
+        memcpy(payload, block, sw->raw_len);
+        stored_len = sw->raw_len;
+        stored_field = (uint32_t) stored_len | CAVE_CMSH_RAW_BLOCK;
+    }
+    hidden_cave_put_u32(header, (uint32_t) sw->raw_len);
+    hidden_cave_put_u32(header + 4, stored_field);
+    sw->out->len += 8 + stored_len;
+
+    sw->total_raw += sw->raw_len;
+    sw->raw_len = 0;
+    return hidden_cave_out_pad(sw->out, 4);
+}
+
+static CaveError hidden_cave_stream_write(hidden_cave_Stream_Writer* sw, void const* item, size_t len) {
+    if(sw->raw_len + len > CAVE_CMSH_BLOCK_SIZE) {
+        CaveError err = hidden_cave_stream_flush(sw);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+    }
+    memcpy(sw->raw + sw->raw_len, item, len);
+    sw->raw_len += len;
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_stream_begin(hidden_cave_Stream_Writer* sw, hidden_cave_Out_Buffer* out, bool shuffle16) {
+    sw->out = out;
+    sw->shuffle16 = shuffle16;
+    sw->raw_len = 0;
+    sw->total_raw = 0;
+    CaveError err = hidden_cave_out_pad(out, 16);
+    sw->start = out->len;
+    return err;
+}
+
+//records the finished stream in the stream table at the start of the output
+static CaveError hidden_cave_stream_end(hidden_cave_Stream_Writer* sw, int stream) {
+    CaveError err = hidden_cave_stream_flush(sw);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    uint8_t* entry = sw->out->data + CAVE_CMSH_HEADER_SIZE + (stream * 24);
+    hidden_cave_put_u64(entry, sw->start);
+    hidden_cave_put_u64(entry + 8, sw->out->len - sw->start);
+    hidden_cave_put_u64(entry + 16, sw->total_raw);
+    return CAVE_NO_ERROR;
+}
+
+/*
+ * Octahedral normal encoding
+ */
+
+static float hidden_cave_sign_not_zero(float v) {
+    return v < 0.0f ? -1.0f : 1.0f;
+}
+
+static void hidden_cave_octahedral_encode(cave_3Point n, unsigned bits, uint16_t* out) {
+    float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+    float x = 0.0f, y = 0.0f;
+    if(l1 > 0.0f) {
+        x = n.x / l1;
+        y = n.y / l1;
+        if(n.z < 0.0f) {
+            float fx = (1.0f - fabsf(y)) * hidden_cave_sign_not_zero(x);
+            float fy = (1.0f - fabsf(x)) * hidden_cave_sign_not_zero(y);
+            x = fx;
+            y = fy;
+        }
+    }
+    float max_q = (float) ((1u << bits) - 1);
+    float qx = roundf((x * 0.5f + 0.5f) * max_q);
+    float qy = roundf((y * 0.5f + 0.5f) * max_q);
+    out[0] = (uint16_t) (qx < 0.0f ? 0.0f : (qx > max_q ? max_q : qx));
+    out[1] = (uint16_t) (qy < 0.0f ? 0.0f : (qy > max_q ? max_q : qy));
+}
+
+static cave_3Point hidden_cave_octahedral_decode(uint16_t const* q, unsigned bits) {
+    float max_q = (float) ((1u << bits) - 1);
+    float x = ((float) q[0] / max_q) * 2.0f - 1.0f;
+    float y = ((float) q[1] / max_q) * 2.0f - 1.0f;
+    float z = 1.0f - fabsf(x) - fabsf(y);
+    if(z < 0.0f) {
+        float fx = (1.0f - fabsf(y)) * hidden_cave_sign_not_zero(x);
+        float fy = (1.0f - fabsf(x)) * hidden_cave_sign_not_zero(y);
+        x = fx;
+        y = fy;
+    }
+    float len = sqrtf(x * x + y * y + z * z);
+    cave_3Point n = {x / len, y / len, z / len};
+    return n;
+}
+
+/*
+ * Encoding
+ */
+
+static size_t hidden_cave_write_varint(uint8_t* dest, uint64_t v) {
+    size_t i = 0;
+    while(v >= 0x80) {
+        dest[i++] = (uint8_t) (v | 0x80);
+        v >>= 7;
+    }
+    dest[i++] = (uint8_t) v;
+    return i;
+}
+
+//every index is coded relative to the "high water mark", the next vertex that has not been used
+//yet. Meshes welded by `cave_STL_Data_to_Mesh()` number vertexes in order of first use, so a
+//new vertex codes as 0 and recently used vertexes code as small numbers.
+static uint64_t hidden_cave_index_code(size_t index, size_t* high_water) {
+    int64_t d = (int64_t) *high_water - (int64_t) index;
+    if(index + 1 > *high_water) {
+        *high_water = index + 1;
+    }
+    return ((uint64_t) d << 1) ^ (uint64_t) (d >> 63);
+}
+
+static void hidden_cave_mesh_bounds(cave_Mesh const* src, float* min, float* max) {
+    if(src->vert_count == 0) {
+        for(int k = 0; k < 3; k++) {
+            min[k] = 0.0f;
+            max[k] = 0.0f;
+        }
+        return;
+    }
+    min[0] = max[0] = src->positions[0].x;
+    min[1] = max[1] = src->positions[0].y;
+    min[2] = max[2] = src->positions[0].z;
+    for(size_t i = 1; i < src->vert_count; i++) {
+        float p[3] = {src->positions[i].x, src->positions[i].y, src->positions[i].z};
+        for(int k = 0; k < 3; k++) {
+            if(p[k] < min[k]) { min[k] = p[k]; }
+            if(p[k] > max[k]) { max[k] = p[k]; }
+        }
+    }
+}
+
+CaveError cave_Mesh_to_CMSH_Bytes(uint8_t** dest, size_t* dest_len, cave_Mesh const* src,
+                                  unsigned position_bits, unsigned normal_bits) {
+    if(!dest || !dest_len || !src) {
+        return CAVE_DATA_ERROR;
+    }
+    if(position_bits == 0) { position_bits = CAVE_CMSH_DEFAULT_POSITION_BITS; }
+    if(normal_bits == 0) { normal_bits = CAVE_CMSH_DEFAULT_NORMAL_BITS; }
+    if(position_bits > 16 || normal_bits < 2 || normal_bits > 16) {
+        return CAVE_DATA_ERROR;
+    }
+    for(size_t i = 0; i < src->tri_count; i++) {
+        cave_Index_Triangle t = src->tris[i];
+        if(t.a >= src->vert_count || t.b >= src->vert_count || t.c >= src->vert_count) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+
+    hidden_cave_Stream_Writer* sw = malloc(sizeof(hidden_cave_Stream_Writer));
+    hidden_cave_Out_Buffer out = {NULL, 0, 0};
+    CaveError err = sw ? hidden_cave_out_reserve(&out, CAVE_CMSH_HEADER_SIZE + CAVE_CMSH_TABLE_SIZE)
+                       : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    if(err != CAVE_NO_ERROR) {
+        free(sw);
+        return err;
+    }
+
+    float min[3], max[3];
+    hidden_cave_mesh_bounds(src, min, max);
+
+    uint8_t* header = out.data;
+    memset(header, 0, CAVE_CMSH_HEADER_SIZE + CAVE_CMSH_TABLE_SIZE);
+    memcpy(header, "CMSH", 4);
+    hidden_cave_put_u32(header + 4, CAVE_CMSH_VERSION);
+    hidden_cave_put_u32(header + 8, src->normals ? CAVE_CMSH_FLAG_NORMALS : 0);
+    hidden_cave_put_u32(header + 12, position_bits);
+    hidden_cave_put_u32(header + 16, normal_bits);
+    hidden_cave_put_u32(header + 20, CAVE_CMSH_BLOCK_SIZE);
+    hidden_cave_put_u64(header + 24, src->vert_count);
+    hidden_cave_put_u64(header + 32, src->tri_count);
+    memcpy(header + 40, min, 12);
+    memcpy(header + 52, max, 12);
+    out.len = CAVE_CMSH_HEADER_SIZE + CAVE_CMSH_TABLE_SIZE;
+
+    //positions: quantize across the bounding box, then delta code against the previous vertex
+    float max_q = (float) ((1u << position_bits) - 1);
+    float scale[3];
+    for(int k = 0; k < 3; k++) {
+        float extent = max[k] - min[k];
+        scale[k] = extent > 0.0f ? max_q / extent : 0.0f;
+    }
+    uint16_t prev[3] = {0, 0, 0};
+    err = hidden_cave_stream_begin(sw, &out, true);
+    for(size_t i = 0; i < src->vert_count && err == CAVE_NO_ERROR; i++) {
+        float p[3] = {src->positions[i].x, src->positions[i].y, src->positions[i].z};
+        uint16_t coded[3];
+        for(int k = 0; k < 3; k++) {
+            float q = roundf((p[k] - min[k]) * scale[k]);
+            uint16_t qi = (uint16_t) (q < 0.0f ? 0.0f : (q > max_q ? max_q : q));
+            coded[k] = hidden_cave_zigzag16((uint16_t) (qi - prev[k]));
+            prev[k] = qi;
+        }
+        err = hidden_cave_stream_write(sw, coded, sizeof(coded));
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_stream_end(sw, CAVE_CMSH_POSITIONS);
+    }
+
+    //normals: octahedral encode, then delta code the same way
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_stream_begin(sw, &out, true);
+    }
+    if(src->normals) {
+        uint16_t prev_n[2] = {0, 0};
+        for(size_t i = 0; i < src->vert_count && err == CAVE_NO_ERROR; i++) {
+            uint16_t q[2];
+            hidden_cave_octahedral_encode(src->normals[i], normal_bits, q);
+            uint16_t coded[2] = {
+                    hidden_cave_zigzag16((uint16_t) (q[0] - prev_n[0])),
+                    hidden_cave_zigzag16((uint16_t) (q[1] - prev_n[1]))
+            };
+            prev_n[0] = q[0];
+            prev_n[1] = q[1];
+            err = hidden_cave_stream_write(sw, coded, sizeof(coded));
+        }
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_stream_end(sw, CAVE_CMSH_NORMALS);
+    }
+
+    //indexes: varints relative to the high water mark, one triangle per item
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_stream_begin(sw, &out, false);
+    }
+    size_t high_water = 0;
+    for(size_t i = 0; i < src->tri_count && err == CAVE_NO_ERROR; i++) {
+        uint8_t item[30];
+        size_t item_len = 0;
+        item_len += hidden_cave_write_varint(item + item_len, hidden_cave_index_code(src->tris[i].a, &high_water));
+        item_len += hidden_cave_write_varint(item + item_len, hidden_cave_index_code(src->tris[i].b, &high_water));
+        item_len += hidden_cave_write_varint(item + item_len, hidden_cave_index_code(src->tris[i].c, &high_water));
+        err = hidden_cave_stream_write(sw, item, item_len);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_stream_end(sw, CAVE_CMSH_INDEXES);
+    }
+
+    free(sw);
+    if(err != CAVE_NO_ERROR) {
+        free(out.data);
+        return err;
+    }
+    *dest = out.data;
+    *dest_len = out.len;
+    return CAVE_NO_ERROR;
+}
+
+/*
+ * Decoding
+ */
+
+typedef struct hidden_cave_Stream_Reader {
+    uint8_t const* pos;
+    uint8_t const* end;
+    bool shuffle16;
+    uint8_t block[CAVE_CMSH_BLOCK_SIZE];
+    uint8_t planes[CAVE_CMSH_BLOCK_SIZE];
+} hidden_cave_Stream_Reader;
+
+static CaveError hidden_cave_stream_open(hidden_cave_Stream_Reader* sr, uint8_t const* bytes, size_t bytes_len,
+                                         int stream, bool shuffle16, uint64_t* raw_len) {
+    uint8_t const* entry = bytes + CAVE_CMSH_HEADER_SIZE + (stream * 24);
+    uint64_t offset = hidden_cave_get_u64(entry);
+    uint64_t stored = hidden_cave_get_u64(entry + 8);
+    *raw_len = hidden_cave_get_u64(entry + 16);
+    if(offset % 16 != 0 || offset > bytes_len || stored > bytes_len - offset) {
+        return CAVE_DATA_ERROR;
+    }
+    sr->pos = bytes + offset;
+    sr->end = sr->pos + stored;
+    sr->shuffle16 = shuffle16;
+    return CAVE_NO_ERROR;
+}
+
+//reads how long the stream table says `stream` decodes to. The block headers are walked without decoding
+//anything, and the length is only accepted if it is what the blocks add up to, so it can't be more than the
+//number of blocks actually stored times `CAVE_CMSH_BLOCK_SIZE`.
+static bool hidden_cave_stream_decoded_len(uint8_t const* bytes, size_t bytes_len, int stream, uint64_t* raw_len) {
+    uint8_t const* entry = bytes + CAVE_CMSH_HEADER_SIZE + (stream * 24);
+    uint64_t offset = hidden_cave_get_u64(entry);
+    uint64_t stored = hidden_cave_get_u64(entry + 8);
+    *raw_len = hidden_cave_get_u64(entry + 16);
+    if(offset > bytes_len || stored > bytes_len - offset) {
+        return false;
+    }
+    uint8_t const* pos = bytes + offset;
+    uint8_t const* end = pos + stored;
+    uint64_t total = 0;
+    while(end - pos >= 8 && total < *raw_len) {
+        uint32_t block_raw = hidden_cave_get_u32(pos);
+        size_t block_stored = hidden_cave_get_u32(pos + 4) & ~CAVE_CMSH_RAW_BLOCK;
+        pos += 8;
+        if(block_raw > CAVE_CMSH_BLOCK_SIZE || block_stored > (size_t) (end - pos)) {
+            return false;
+        }
+        total += block_raw;
+        size_t advance = (block_stored + 3) & ~(size_t) 3;
+        pos += advance < (size_t) (end - pos) ? advance : (size_t) (end - pos);
+    }
+    return total == *raw_len;
+}
+
+//decodes the next block of the stream. `*block_out` points at the decoded bytes afterwards.
+static CaveError hidden_cave_stream_next(hidden_cave_Stream_Reader* sr, uint8_t const** block_out, size_t* block_len) {
+    if(sr->end - sr->pos < 8) {
+        return CAVE_DATA_ERROR;
+    }
+    uint32_t raw_len = hidden_cave_get_u32(sr->pos);
+    uint32_t stored_field = hidden_cave_get_u32(sr->pos + 4);
+    uint32_t stored_len = stored_field & ~CAVE_CMSH_RAW_BLOCK;
+    sr->pos += 8;
+    if(raw_len > CAVE_CMSH_BLOCK_SIZE || stored_len > (size_t) (sr->end - sr->pos)) {
+        return CAVE_DATA_ERROR;
+    }
+    uint8_t* decoded = sr->shuffle16 ? sr->planes : sr->block;
+    if(stored_field & CAVE_CMSH_RAW_BLOCK) {
+        if(stored_len != raw_len) {
+            return CAVE_DATA_ERROR;
+        }
+        memcpy(decoded, sr->pos, raw_len);
+    } else {
+        CaveError err = cave_lz_decompress(decoded, raw_len, sr->pos, stored_len);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+    }
+    //skip the payload and its padding
+    size_t advance = ((size_t) stored_len + 3) & ~(size_t) 3;
+    sr->pos += advance < (size_t) (sr->end - sr->pos) ? advance : (size_t) (sr->end - sr->pos);
+
+    if(sr->shuffle16) {
+        if(raw_len % 2 != 0) {
+            return CAVE_DATA_ERROR;
+        }
+        size_t count = raw_len / 2;
+        for(size_t i = 0; i < count; i++) {
+            sr->block[2 * i] = sr->planes[i];
+            sr->block[2 * i + 1] = sr->planes[count + i];
+        }
+    }
+    *block_out = sr->block;
+    *block_len = raw_len;
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_decode_positions(cave_Mesh* dest, hidden_cave_Stream_Reader* sr,
+                                              uint8_t const* bytes, size_t bytes_len,
+                                              unsigned position_bits, float const* min, float const* max) {
+    uint64_t raw_len;
+    CaveError err = hidden_cave_stream_open(sr, bytes, bytes_len, CAVE_CMSH_POSITIONS, true, &raw_len);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    if(raw_len != (uint64_t) dest->vert_count * 6) {
+        return CAVE_DATA_ERROR;
+    }
+    float max_q = (float) ((1u << position_bits) - 1);
+    float step[3];
+    for(int k = 0; k < 3; k++) {
+        step[k] = (max[k] - min[k]) / max_q;
+    }
+    uint16_t prev[3] = {0, 0, 0};
+    size_t vert = 0;
+    while(vert < dest->vert_count) {
+        uint8_t const* block;
+        size_t block_len;
+        err = hidden_cave_stream_next(sr, &block, &block_len);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+        if(block_len % 6 != 0 || block_len / 6 > dest->vert_count - vert) {
+            return CAVE_DATA_ERROR;
+        }
+        for(size_t i = 0; i < block_len; i += 6, vert++) {
+            float p[3];
+            for(int k = 0; k < 3; k++) {
+                uint16_t coded;
+                memcpy(&coded, block + i + (2 * k), 2);
+                prev[k] = (uint16_t) (prev[k] + hidden_cave_unzigzag16(coded));
+                p[k] = min[k] + ((float) prev[k] * step[k]);
+            }
+            dest->positions[vert].x = p[0];
+            dest->positions[vert].y = p[1];
+            dest->positions[vert].z = p[2];
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_decode_normals(cave_Mesh* dest, hidden_cave_Stream_Reader* sr,
+                                            uint8_t const* bytes, size_t bytes_len, unsigned normal_bits) {
+    uint64_t raw_len;
+    CaveError err = hidden_cave_stream_open(sr, bytes, bytes_len, CAVE_CMSH_NORMALS, true, &raw_len);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    if(raw_len != (uint64_t) dest->vert_count * 4) {
+        return CAVE_DATA_ERROR;
+    }
+    uint16_t prev[2] = {0, 0};
+    size_t vert = 0;
+    while(vert < dest->vert_count) {
+        uint8_t const* block;
+        size_t block_len;
+        err = hidden_cave_stream_next(sr, &block, &block_len);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+        if(block_len % 4 != 0 || block_len / 4 > dest->vert_count - vert) {
+            return CAVE_DATA_ERROR;
+        }
+        for(size_t i = 0; i < block_len; i += 4, vert++) {
+            uint16_t coded[2];
+            memcpy(coded, block + i, 4);
+            prev[0] = (uint16_t) (prev[0] + hidden_cave_unzigzag16(coded[0]));
+            prev[1] = (uint16_t) (prev[1] + hidden_cave_unzigzag16(coded[1]));
+            if(prev[0] >= (1u << normal_bits) || prev[1] >= (1u << normal_bits)) {
+                return CAVE_DATA_ERROR;
+            }
+            dest->normals[vert] = hidden_cave_octahedral_decode(prev, normal_bits);
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+static bool hidden_cave_read_varint(uint8_t const** pos, uint8_t const* end, uint64_t* v) {
+    uint64_t result = 0;
+    for(unsigned shift = 0; shift < 64; shift += 7) {
+        if(*pos >= end) {
+            return false;
+        }
+        uint8_t b = **pos;
+        *pos += 1;
+        result |= (uint64_t) (b & 0x7F) << shift;
+        if(!(b & 0x80)) {
+            *v = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static CaveError hidden_cave_decode_indexes(cave_Mesh* dest, hidden_cave_Stream_Reader* sr,
+                                            uint8_t const* bytes, size_t bytes_len) {
+    uint64_t raw_len;
+    CaveError err = hidden_cave_stream_open(sr, bytes, bytes_len, CAVE_CMSH_INDEXES, false, &raw_len);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    size_t high_water = 0;
+    size_t corner = 0;
+    size_t corner_count = dest->tri_count * 3;
+    while(corner < corner_count) {
+        uint8_t const* block;
+        size_t block_len;
+        err = hidden_cave_stream_next(sr, &block, &block_len);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+        uint8_t const* pos = block;
+        uint8_t const* end = block + block_len;
+        while(pos < end) {
+            uint64_t code;
+            if(corner >= corner_count || !hidden_cave_read_varint(&pos, end, &code)) {
+                return CAVE_DATA_ERROR;
+            }
+            //no delta can reach further than the vertex count, and checking that first keeps the
+            //subtraction below from overflowing on a hostile code
+            if((code >> 1) > dest->vert_count) {
+                return CAVE_DATA_ERROR;
+            }
+            int64_t d = (int64_t) (code >> 1) ^ -(int64_t) (code & 1);
+            int64_t index = (int64_t) high_water - d;
+            if(index < 0 || (uint64_t) index >= dest->vert_count) {
+                return CAVE_DATA_ERROR;
+            }
+            if((size_t) index + 1 > high_water) {
+                high_water = (size_t) index + 1;
+            }
+            cave_Index_Triangle* tri = dest->tris + (corner / 3);
+            switch(corner % 3) {
+                case 0: tri->a = (size_t) index; break;
+                case 1: tri->b = (size_t) index; break;
+                default: tri->c = (size_t) index; break;
+            }
+            corner += 1;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_CMSH_Bytes_to_Mesh(cave_Mesh* dest, uint8_t const* bytes, size_t bytes_len) {
+    if(!dest || !bytes) {
+        return CAVE_DATA_ERROR;
+    }
+    memset(dest, 0, sizeof(cave_Mesh));
+    if(bytes_len < CAVE_CMSH_HEADER_SIZE + CAVE_CMSH_TABLE_SIZE || memcmp(bytes, "CMSH", 4) != 0) {
+        return CAVE_DATA_ERROR;
+    }
+    uint32_t version = hidden_cave_get_u32(bytes + 4);
+    uint32_t flags = hidden_cave_get_u32(bytes + 8);
+    uint32_t position_bits = hidden_cave_get_u32(bytes + 12);
+    uint32_t normal_bits = hidden_cave_get_u32(bytes + 16);
+    uint32_t block_size = hidden_cave_get_u32(bytes + 20);
+    uint64_t vert_count = hidden_cave_get_u64(bytes + 24);
+    uint64_t tri_count = hidden_cave_get_u64(bytes + 32);
+    float min[3], max[3];
+    memcpy(min, bytes + 40, 12);
+    memcpy(max, bytes + 52, 12);
+
+    if(version != CAVE_CMSH_VERSION || position_bits < 1 || position_bits > 16 ||
+       normal_bits < 2 || normal_bits > 16 || block_size > CAVE_CMSH_BLOCK_SIZE) {
+        return CAVE_DATA_ERROR;
+    }
+    //the counts have to agree with how long the stream table says each stream decodes to, and those lengths are
+    //bounded by the blocks actually stored, so nothing is allocated on the say-so of the header alone.
+    uint64_t positions_len, normals_len, indexes_len;
+    if(!hidden_cave_stream_decoded_len(bytes, bytes_len, CAVE_CMSH_POSITIONS, &positions_len) ||
+       !hidden_cave_stream_decoded_len(bytes, bytes_len, CAVE_CMSH_NORMALS, &normals_len) ||
+       !hidden_cave_stream_decoded_len(bytes, bytes_len, CAVE_CMSH_INDEXES, &indexes_len)) {
+        return CAVE_DATA_ERROR;
+    }
+    //a vertex is 6 bytes of positions and 4 of normals, if there are any, and every index at least 1 byte
+    uint64_t normal_size = (flags & CAVE_CMSH_FLAG_NORMALS) ? 4 : 0;
+    if(positions_len % 6 != 0 || positions_len / 6 != vert_count || normals_len != (positions_len / 6) * normal_size ||
+       tri_count > indexes_len / 3 || vert_count > SIZE_MAX / sizeof(cave_3Point) ||
+       tri_count > SIZE_MAX / sizeof(cave_Index_Triangle)) {
+        return CAVE_DATA_ERROR;
+    }
+    dest->vert_count = (size_t) (positions_len / 6);
+    dest->tri_count = (size_t) tri_count;
+
+    hidden_cave_Stream_Reader* sr = malloc(sizeof(hidden_cave_Stream_Reader));
+    if(vert_count) {
+        dest->positions = malloc(sizeof(cave_3Point) * dest->vert_count);
+        if(flags & CAVE_CMSH_FLAG_NORMALS) {
+            dest->normals = malloc(sizeof(cave_3Point) * dest->vert_count);
+        }
+    }
+    if(tri_count) {
+        dest->tris = malloc(sizeof(cave_Index_Triangle) * dest->tri_count);
+    }
+    if(!sr || (vert_count && !dest->positions) || ((flags & CAVE_CMSH_FLAG_NORMALS) && vert_count && !dest->normals) ||
+       (tri_count && !dest->tris)) {
+        free(sr);
+        cave_Mesh_release(dest);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+
+    CaveError err = hidden_cave_decode_positions(dest, sr, bytes, bytes_len, position_bits, min, max);
+    if(err == CAVE_NO_ERROR && dest->normals) {
+        err = hidden_cave_decode_normals(dest, sr, bytes, bytes_len, normal_bits);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_decode_indexes(dest, sr, bytes, bytes_len);
+    }
+    free(sr);
+    if(err != CAVE_NO_ERROR) {
+        cave_Mesh_release(dest);
+    }
+    return err;
+}
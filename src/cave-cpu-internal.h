@@ -0,0 +1,45 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_CPU_INTERNAL_H
+#define CAVE_CPU_INTERNAL_H
+
+#include "cave-cpu.h"
+#include "cave-writer.h"
+#include <stddef.h>
+#include <stdint.h>
+
+//The kernels bound for the path in use. There is one of these for each cave_Cpu_Path, built at compile time,
+//so switching paths just swaps which one `hidden_cave_dispatch()` points at.
+
+//x86 kernels are built with target attributes, so the library as a whole still runs on any x86 host
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define CAVE_CPU_X86
+#endif
+
+struct hidden_cave_Vecmath_Kernels;
+
+typedef struct hidden_cave_Dispatch {
+    cave_Cpu_Path path;
+    struct hidden_cave_Vecmath_Kernels const* vecmath;
+    //decodes `count` consecutive 50 byte STL triangle records from `bytes` into `dest`
+    void (*decode_STL_tris)(cave_STL_Tri* dest, uint8_t const* bytes, size_t count);
+    //encodes `count` triangles from `src` as consecutive 50 byte STL triangle records into `dest`
+    void (*encode_STL_tris)(uint8_t* dest, cave_STL_Tri const* src, size_t count);
+} hidden_cave_Dispatch;
+
+//checks the host the first time it's called
+hidden_cave_Dispatch const* hidden_cave_dispatch(void);
+
+//STL kernels, in cave-writer.c and cave-writer-x86.c
+void hidden_cave_scalar_decode_STL_tris(cave_STL_Tri* dest, uint8_t const* bytes, size_t count);
+void hidden_cave_scalar_encode_STL_tris(uint8_t* dest, cave_STL_Tri const* src, size_t count);
+#ifdef CAVE_CPU_X86
+void hidden_cave_sse2_decode_STL_tris(cave_STL_Tri* dest, uint8_t const* bytes, size_t count);
+void hidden_cave_sse2_encode_STL_tris(uint8_t* dest, cave_STL_Tri const* src, size_t count);
+void hidden_cave_avx2_decode_STL_tris(cave_STL_Tri* dest, uint8_t const* bytes, size_t count);
+void hidden_cave_avx2_encode_STL_tris(uint8_t* dest, cave_STL_Tri const* src, size_t count);
+#endif
+
+#endif //CAVE_CPU_INTERNAL_H
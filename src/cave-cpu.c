@@ -0,0 +1,139 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-cpu.h"
+#include "cave-cpu-internal.h"
+#include "cave-vecmath-internal.h"
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#ifdef CAVE_CPU_X86
+#include <cpuid.h>
+#endif
+
+//Hashing isn't dispatched. cave_hash64() is XXH64, whose four lanes are each a chain of dependent 64 bit
+//multiplies, so SIMD only trades four scalar multiplies for one vector multiply with several times their
+//latency, and AVX-512's vpmullq measured a third slower than the scalar loop.
+
+static char const* const hidden_cave_path_names[] = {"scalar", "sse2", "sse4.1", "avx2", "avx512"};
+
+static hidden_cave_Dispatch const hidden_cave_dispatches[] = {
+        {CAVE_CPU_PATH_SCALAR, &hidden_cave_vecmath_scalar, hidden_cave_scalar_decode_STL_tris,
+         hidden_cave_scalar_encode_STL_tris},
+#ifdef CAVE_CPU_X86
+        {CAVE_CPU_PATH_SSE2, &hidden_cave_vecmath_sse2, hidden_cave_sse2_decode_STL_tris,
+         hidden_cave_sse2_encode_STL_tris},
+        {CAVE_CPU_PATH_SSE41, &hidden_cave_vecmath_sse2, hidden_cave_sse2_decode_STL_tris,
+         hidden_cave_sse2_encode_STL_tris},
+        {CAVE_CPU_PATH_AVX2, &hidden_cave_vecmath_avx2, hidden_cave_avx2_decode_STL_tris,
+         hidden_cave_avx2_encode_STL_tris},
+        {CAVE_CPU_PATH_AVX512, &hidden_cave_vecmath_avx2, hidden_cave_avx2_decode_STL_tris,
+         hidden_cave_avx2_encode_STL_tris},
+#endif
+};
+
+//The host is checked once, under `hidden_cave_checked`, which also makes what was found visible to every thread
+//that asks after it. Only `cave_cpu_set_path()` changes `hidden_cave_bound` afterwards.
+static cave_Once hidden_cave_checked = CAVE_ONCE_INIT;
+static unsigned hidden_cave_features = 0;
+static cave_Cpu_Path hidden_cave_best = CAVE_CPU_PATH_SCALAR;
+static hidden_cave_Dispatch const* hidden_cave_bound = NULL;
+
+static unsigned hidden_cave_detect_features(void) {
+    unsigned features = 0;
+#ifdef CAVE_CPU_X86
+    unsigned int a, b, c, d;
+    if(!__get_cpuid(1, &a, &b, &c, &d)) {
+        return 0;
+    }
+    features |= (d >> 26 & 1) ? CAVE_CPU_SSE2 : 0;
+    features |= (c >> 19 & 1) ? CAVE_CPU_SSE41 : 0;
+    //AVX and up also need the operating system to save their registers, which it says in XCR0
+    uint64_t xcr0 = 0;
+    if(c >> 27 & 1) {
+        uint32_t lo, hi;
+        __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        xcr0 = (uint64_t) hi << 32 | lo;
+    }
+    bool ymm = (xcr0 & 0x6) == 0x6;
+    bool zmm = (xcr0 & 0xe6) == 0xe6;
+    features |= ymm && (c >> 28 & 1) ? CAVE_CPU_AVX : 0;
+    features |= ymm && (c >> 12 & 1) ? CAVE_CPU_FMA : 0;
+    if(__get_cpuid_max(0, NULL) >= 7) {
+        __cpuid_count(7, 0, a, b, c, d);
+        features |= ymm && (b >> 5 & 1) ? CAVE_CPU_AVX2 : 0;
+        features |= zmm && (b >> 16 & 1) ? CAVE_CPU_AVX512F : 0;
+        features |= zmm && (b >> 17 & 1) ? CAVE_CPU_AVX512DQ : 0;
+        features |= zmm && (b >> 30 & 1) ? CAVE_CPU_AVX512BW : 0;
+        features |= zmm && (b >> 31 & 1) ? CAVE_CPU_AVX512VL : 0;
+    }
+#endif
+    return features;
+}
+
+static cave_Cpu_Path hidden_cave_path_for(unsigned features) {
+    unsigned const needs[] = {
+            0,
+            CAVE_CPU_SSE2,
+            CAVE_CPU_SSE41,
+            CAVE_CPU_AVX | CAVE_CPU_AVX2 | CAVE_CPU_FMA,
+            CAVE_CPU_AVX512F | CAVE_CPU_AVX512VL | CAVE_CPU_AVX512DQ | CAVE_CPU_AVX512BW,
+    };
+    size_t path = 0;
+    size_t path_count = sizeof(hidden_cave_dispatches) / sizeof(hidden_cave_dispatches[0]);
+    while(path + 1 < path_count && (features & needs[path + 1]) == needs[path + 1]) {
+        path++;
+    }
+    return (cave_Cpu_Path) path;
+}
+
+static void hidden_cave_check_host(void) {
+    hidden_cave_features = hidden_cave_detect_features();
+    hidden_cave_best = hidden_cave_path_for(hidden_cave_features);
+    cave_Cpu_Path path = hidden_cave_best;
+    //the environment can only choose a lower path, lest a typo crash the program
+    char const* forced = getenv("CAVE_CPU_PATH");
+    for(int p = 0; forced && p <= (int) hidden_cave_best; p++) {
+        if(strcmp(forced, hidden_cave_path_names[p]) == 0) {
+            path = (cave_Cpu_Path) p;
+        }
+    }
+    hidden_cave_bound = &hidden_cave_dispatches[path];
+}
+
+hidden_cave_Dispatch const* hidden_cave_dispatch(void) {
+    cave_once(&hidden_cave_checked, hidden_cave_check_host);
+    return hidden_cave_bound;
+}
+
+unsigned cave_cpu_features(void) {
+    hidden_cave_dispatch();
+    return hidden_cave_features;
+}
+
+cave_Cpu_Path cave_cpu_best_path(void) {
+    hidden_cave_dispatch();
+    return hidden_cave_best;
+}
+
+cave_Cpu_Path cave_cpu_path(void) {
+    return hidden_cave_dispatch()->path;
+}
+
+CaveError cave_cpu_set_path(cave_Cpu_Path path) {
+    hidden_cave_dispatch();
+    if((int) path < 0 || path > hidden_cave_best) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_bound = &hidden_cave_dispatches[path];
+    return CAVE_NO_ERROR;
+}
+
+char const* cave_cpu_path_name(cave_Cpu_Path path) {
+    if((int) path < 0 || path > CAVE_CPU_PATH_AVX512) {
+        return "unknown";
+    }
+    return hidden_cave_path_names[path];
+}
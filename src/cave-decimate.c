@@ -0,0 +1,1080 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-decimate.h"
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+//Triangles are kept as three vertex indexes each, the first set to CAVE_DECIMATE_NIL once the triangle is
+//gone. Each corner links to the next corner of the same vertex, so a vertex's triangles are a list threaded
+//through the corners, and corners of triangles that are gone are unlinked lazily, the next time the list is
+//walked. A collapse rewrites the corners of the vertex that goes and splices its list onto the other's.
+//
+//The heap holds vertexes rather than edges, each with the cheapest collapse it can make: a vertex has about
+//half as many entries as edges, and after a collapse, only the vertex left and its neighbours need theirs
+//looked at again. A neighbour whose cheapest collapse didn't involve either vertex only has its collapse with
+//the one left worked out again, and its own is checked once more when it comes off the heap, since a
+//neighbour moving may have made it fold a triangle over.
+//
+//Quadrics are taken around the middle of the mesh, in doubles, so their terms stay small. With normals
+//weighed in, each vertex also keeps, for each component of the normal, the area weighed sum of its gradient
+//across the triangles and its value at the origin, which is all it takes to work out the best normal for any
+//position, and to fold that into a quadric over position alone.
+//
+//Approximate decimation counting sorts triangles by the Morton code of their centroid, coarsely, and takes
+//runs of codes with enough triangles between them as clusters. Each cluster is decimated alone, to the same
+//ratio as the whole, its vertexes shared with other clusters locked, and what they leave is decimated again
+//as a whole.
+
+#define CAVE_DECIMATE_NIL (UINT32_MAX)
+//for vertexes used by more than one cluster
+#define CAVE_DECIMATE_SHARED (UINT32_MAX - 1)
+//how much more the planes along open boundaries count than the triangles'
+#define CAVE_DECIMATE_BORDER_WEIGHT (10.0)
+//a collapse may turn no triangle by more than the angle with this cosine, about 78 degrees
+#define CAVE_DECIMATE_MIN_COS (0.2)
+//how many of a vertex's cheapest collapses are tried before it's given up on until a neighbour changes
+#define CAVE_DECIMATE_TRIES (4)
+//how many triangles a cluster has, at least, for approximate decimation
+#define CAVE_DECIMATE_CLUSTER (1u << 16)
+//bits per axis of the Morton codes clusters are cut from
+#define CAVE_DECIMATE_MORTON_BITS (6)
+
+enum {
+    CAVE_DECIMATE_BORDER = 1, //on an open boundary or an edge of more than two triangles
+    CAVE_DECIMATE_LOCKED = 2, //never moves, and only other vertexes are merged into it
+    CAVE_DECIMATE_STALE = 4, //has corners of triangles that are gone in its list
+};
+
+typedef struct hidden_cave_Quadric {
+    double a[6]; //the symmetric matrix, as xx, xy, xz, yy, yz and zz
+    double b[3];
+    double c;
+    double area;
+} hidden_cave_Quadric;
+
+//a vertex in the heap, with the cost of its cheapest collapse kept alongside so that sifting reads nothing else
+typedef struct hidden_cave_Heap_Entry {
+    float cost;
+    uint32_t vertex;
+} hidden_cave_Heap_Entry;
+
+typedef struct hidden_cave_Decimator {
+    //the mesh, changed in place, owned by the caller
+    cave_3Point* positions;
+    cave_3Point* normals; //NULL if there are none
+    uint32_t* tris;
+    uint8_t* flags; //with CAVE_DECIMATE_LOCKED set as the caller wants it
+    uint32_t vert_count;
+    uint32_t tri_count;
+
+    uint32_t live_tris;
+    double center[3];
+    double normal_weight; //0 if normals aren't weighed
+    double max_cost; //the squared max error
+    double worst; //the highest cost of a collapse made
+    uint32_t* first; //each vertex's first corner
+    uint32_t* next; //each corner's next corner of the same vertex
+    hidden_cave_Quadric* quadrics;
+    double* attributes; //12 per vertex when normals are weighed, a gradient and an offset per component
+    uint32_t* partner; //the vertex each vertex in the heap collapses with
+    hidden_cave_Heap_Entry* heap;
+    uint32_t* heap_pos; //CAVE_DECIMATE_NIL when not in the heap
+    uint32_t heap_len;
+    uint32_t* mark; //for gathering neighbours without repeats
+    uint32_t epoch;
+    uint32_t* seen; //for visiting the neighbours of a collapse once each
+    uint32_t collapses;
+} hidden_cave_Decimator;
+
+static bool hidden_cave_decimate_less(hidden_cave_Heap_Entry a, hidden_cave_Heap_Entry b) {
+    return a.cost < b.cost || (a.cost == b.cost && a.vertex < b.vertex);
+}
+
+static void hidden_cave_decimate_place(hidden_cave_Decimator* d, uint32_t at, hidden_cave_Heap_Entry entry) {
+    d->heap[at] = entry;
+    d->heap_pos[entry.vertex] = at;
+}
+
+static void hidden_cave_decimate_up(hidden_cave_Decimator* d, uint32_t at) {
+    hidden_cave_Heap_Entry entry = d->heap[at];
+    while(at > 0) {
+        uint32_t parent = (at - 1) / 2;
+        if(!hidden_cave_decimate_less(entry, d->heap[parent])) {
+            break;
+        }
+        hidden_cave_decimate_place(d, at, d->heap[parent]);
+        at = parent;
+    }
+    hidden_cave_decimate_place(d, at, entry);
+}
+
+static void hidden_cave_decimate_down(hidden_cave_Decimator* d, uint32_t at) {
+    hidden_cave_Heap_Entry entry = d->heap[at];
+    while(true) {
+        uint32_t child = 2 * at + 1;
+        if(child >= d->heap_len) {
+            break;
+        }
+        if(child + 1 < d->heap_len && hidden_cave_decimate_less(d->heap[child + 1], d->heap[child])) {
+            child++;
+        }
+        if(!hidden_cave_decimate_less(d->heap[child], entry)) {
+            break;
+        }
+        hidden_cave_decimate_place(d, at, d->heap[child]);
+        at = child;
+    }
+    hidden_cave_decimate_place(d, at, entry);
+}
+
+static void hidden_cave_decimate_unqueue(hidden_cave_Decimator* d, uint32_t v) {
+    uint32_t at = d->heap_pos[v];
+    if(at == CAVE_DECIMATE_NIL) {
+        return;
+    }
+    d->heap_pos[v] = CAVE_DECIMATE_NIL;
+    if(at == --d->heap_len) {
+        return;
+    }
+    hidden_cave_Heap_Entry moved = d->heap[d->heap_len];
+    hidden_cave_decimate_place(d, at, moved);
+    hidden_cave_decimate_up(d, at);
+    hidden_cave_decimate_down(d, d->heap_pos[moved.vertex]);
+}
+
+//sets the cheapest collapse of `v`, or takes it out of the heap if `partner` is CAVE_DECIMATE_NIL
+static void hidden_cave_decimate_queue(hidden_cave_Decimator* d, uint32_t v, uint32_t partner, double cost) {
+    if(partner == CAVE_DECIMATE_NIL) {
+        hidden_cave_decimate_unqueue(d, v);
+        return;
+    }
+    d->partner[v] = partner;
+    hidden_cave_Heap_Entry entry = {(float) cost, v};
+    if(d->heap_pos[v] == CAVE_DECIMATE_NIL) {
+        hidden_cave_decimate_place(d, d->heap_len++, entry);
+        hidden_cave_decimate_up(d, d->heap_len - 1);
+    } else {
+        uint32_t at = d->heap_pos[v];
+        hidden_cave_decimate_place(d, at, entry);
+        hidden_cave_decimate_up(d, at);
+        hidden_cave_decimate_down(d, d->heap_pos[v]);
+    }
+}
+
+//a fresh pair of marks, `epoch` and `epoch + 1`
+static uint32_t hidden_cave_decimate_epoch(hidden_cave_Decimator* d) {
+    if(d->epoch >= UINT32_MAX - 4) {
+        memset(d->mark, 0, sizeof(uint32_t) * d->vert_count);
+        d->epoch = 0;
+    }
+    d->epoch += 2;
+    return d->epoch;
+}
+
+static void hidden_cave_decimate_point(hidden_cave_Decimator const* d, uint32_t v, double* p) {
+    p[0] = d->positions[v].x - d->center[0];
+    p[1] = d->positions[v].y - d->center[1];
+    p[2] = d->positions[v].z - d->center[2];
+}
+
+//unlinks the corners of triangles that are gone from the list of `v`
+static void hidden_cave_decimate_prune(hidden_cave_Decimator* d, uint32_t v) {
+    if(!(d->flags[v] & CAVE_DECIMATE_STALE)) {
+        return;
+    }
+    d->flags[v] &= (uint8_t) ~CAVE_DECIMATE_STALE;
+    uint32_t* link = d->first + v;
+    while(*link != CAVE_DECIMATE_NIL) {
+        uint32_t c = *link;
+        if(d->tris[c - c % 3] == CAVE_DECIMATE_NIL) {
+            *link = d->next[c];
+        } else {
+            link = d->next + c;
+        }
+    }
+}
+
+static void hidden_cave_quadric_add_plane(hidden_cave_Quadric* q, double const* n, double offset, double weight) {
+    q->a[0] += weight * n[0] * n[0];
+    q->a[1] += weight * n[0] * n[1];
+    q->a[2] += weight * n[0] * n[2];
+    q->a[3] += weight * n[1] * n[1];
+    q->a[4] += weight * n[1] * n[2];
+    q->a[5] += weight * n[2] * n[2];
+    q->b[0] += weight * n[0] * offset;
+    q->b[1] += weight * n[1] * offset;
+    q->b[2] += weight * n[2] * offset;
+    q->c += weight * offset * offset;
+}
+
+static void hidden_cave_quadric_add(hidden_cave_Quadric* q, hidden_cave_Quadric const* r) {
+    for(int i = 0; i < 6; i++) {
+        q->a[i] += r->a[i];
+    }
+    for(int i = 0; i < 3; i++) {
+        q->b[i] += r->b[i];
+    }
+    q->c += r->c;
+    q->area += r->area;
+}
+
+static double hidden_cave_quadric_eval(hidden_cave_Quadric const* q, double const* p) {
+    double const* a = q->a;
+    double e = a[0] * p[0] * p[0] + a[3] * p[1] * p[1] + a[5] * p[2] * p[2]
+               + 2 * (a[1] * p[0] * p[1] + a[2] * p[0] * p[2] + a[4] * p[1] * p[2])
+               + 2 * (q->b[0] * p[0] + q->b[1] * p[1] + q->b[2] * p[2]) + q->c;
+    return e > 0 ? e : 0;
+}
+
+//where `q` is least, unless it's too close to flat along some direction to tell
+static bool hidden_cave_quadric_solve(hidden_cave_Quadric const* q, double* p) {
+    double const* a = q->a;
+    double c00 = a[3] * a[5] - a[4] * a[4];
+    double c01 = a[2] * a[4] - a[1] * a[5];
+    double c02 = a[1] * a[4] - a[2] * a[3];
+    double c11 = a[0] * a[5] - a[2] * a[2];
+    double c12 = a[1] * a[2] - a[0] * a[4];
+    double c22 = a[0] * a[3] - a[1] * a[1];
+    double det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+    double trace = a[0] + a[3] + a[5];
+    if(!(fabs(det) > 1e-9 * trace * trace * trace)) {
+        return false;
+    }
+    double const* b = q->b;
+    p[0] = -(c00 * b[0] + c01 * b[1] + c02 * b[2]) / det;
+    p[1] = -(c01 * b[0] + c11 * b[1] + c12 * b[2]) / det;
+    p[2] = -(c02 * b[0] + c12 * b[1] + c22 * b[2]) / det;
+    return true;
+}
+
+//the quadrics of `w` and `x` summed, with the normals that fit best at each position folded in
+static void hidden_cave_decimate_sum(hidden_cave_Decimator const* d, uint32_t w, uint32_t x,
+                                     hidden_cave_Quadric* q) {
+    *q = d->quadrics[w];
+    hidden_cave_quadric_add(q, d->quadrics + x);
+    if(!d->attributes || !(q->area > 0)) {
+        return;
+    }
+    double const* aw = d->attributes + 12 * (size_t) w;
+    double const* ax = d->attributes + 12 * (size_t) x;
+    for(int j = 0; j < 3; j++) {
+        double g[3] = {aw[4 * j] + ax[4 * j], aw[4 * j + 1] + ax[4 * j + 1], aw[4 * j + 2] + ax[4 * j + 2]};
+        double off = aw[4 * j + 3] + ax[4 * j + 3];
+        //the component's best value is `(g . p + off) / area`, which leaves this much less error
+        hidden_cave_quadric_add_plane(q, g, off, -1.0 / q->area);
+    }
+}
+
+//the error of merging `w` and `x`, as a mean squared distance, and where the merged vertex goes, or INFINITY
+//if both are locked
+static double hidden_cave_decimate_edge(hidden_cave_Decimator const* d, uint32_t w, uint32_t x, double* p) {
+    bool lock_w = d->flags[w] & CAVE_DECIMATE_LOCKED, lock_x = d->flags[x] & CAVE_DECIMATE_LOCKED;
+    if(lock_w && lock_x) {
+        return INFINITY;
+    }
+    hidden_cave_Quadric q;
+    hidden_cave_decimate_sum(d, w, x, &q);
+    double pw[3], px[3];
+    hidden_cave_decimate_point(d, w, pw);
+    hidden_cave_decimate_point(d, x, px);
+    double e[3] = {px[0] - pw[0], px[1] - pw[1], px[2] - pw[2]};
+    if(lock_w || lock_x) {
+        memcpy(p, lock_w ? pw : px, sizeof(double) * 3);
+    } else {
+        bool solved = hidden_cave_quadric_solve(&q, p);
+        if(solved) {
+            //a best point far off the edge means the surface is nearly flat along some direction, and is best
+            //not trusted
+            double m[3] = {p[0] - (pw[0] + px[0]) / 2, p[1] - (pw[1] + px[1]) / 2, p[2] - (pw[2] + px[2]) / 2};
+            solved = m[0] * m[0] + m[1] * m[1] + m[2] * m[2] <= 4 * (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+        }
+        if(!solved) {
+            //the best point along the edge instead
+            double const* a = q.a;
+            double ae[3] = {a[0] * e[0] + a[1] * e[1] + a[2] * e[2], a[1] * e[0] + a[3] * e[1] + a[4] * e[2],
+                            a[2] * e[0] + a[4] * e[1] + a[5] * e[2]};
+            double curve = e[0] * ae[0] + e[1] * ae[1] + e[2] * ae[2];
+            double slope = pw[0] * ae[0] + pw[1] * ae[1] + pw[2] * ae[2] + q.b[0] * e[0] + q.b[1] * e[1]
+                           + q.b[2] * e[2];
+            double t = curve > 0 ? -slope / curve : 0.5;
+            t = t < 0 ? 0 : (t > 1 ? 1 : t);
+            for(int i = 0; i < 3; i++) {
+                p[i] = pw[i] + t * e[i];
+            }
+        }
+    }
+    double cost = hidden_cave_quadric_eval(&q, p);
+    return q.area > 0 ? cost / q.area : cost;
+}
+
+//whether a triangle around `v`, without `other`, turns too far with `v` moved to `p`
+static bool hidden_cave_decimate_flips(hidden_cave_Decimator const* d, uint32_t v, uint32_t other,
+                                       double const* p) {
+    for(uint32_t c = d->first[v]; c != CAVE_DECIMATE_NIL; c = d->next[c]) {
+        uint32_t const* t = d->tris + (c - c % 3);
+        if(t[0] == CAVE_DECIMATE_NIL || t[0] == other || t[1] == other || t[2] == other) {
+            continue;
+        }
+        uint32_t k = c % 3;
+        double a[3], b[3], o[3];
+        hidden_cave_decimate_point(d, v, o);
+        hidden_cave_decimate_point(d, t[(k + 1) % 3], a);
+        hidden_cave_decimate_point(d, t[(k + 2) % 3], b);
+        double u[3] = {a[0] - o[0], a[1] - o[1], a[2] - o[2]}, w[3] = {b[0] - o[0], b[1] - o[1], b[2] - o[2]};
+        double before[3] = {u[1] * w[2] - u[2] * w[1], u[2] * w[0] - u[0] * w[2], u[0] * w[1] - u[1] * w[0]};
+        double u2[3] = {a[0] - p[0], a[1] - p[1], a[2] - p[2]}, w2[3] = {b[0] - p[0], b[1] - p[1], b[2] - p[2]};
+        double after[3] = {u2[1] * w2[2] - u2[2] * w2[1], u2[2] * w2[0] - u2[0] * w2[2],
+                           u2[0] * w2[1] - u2[1] * w2[0]};
+        double len_before = before[0] * before[0] + before[1] * before[1] + before[2] * before[2];
+        if(len_before == 0) {
+            continue;
+        }
+        double len_after = after[0] * after[0] + after[1] * after[1] + after[2] * after[2];
+        double dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+        if(dot <= CAVE_DECIMATE_MIN_COS * sqrt(len_before * len_after)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+//whether merging `w` and `x` at `p` keeps the mesh manifold and folds no triangle over
+static bool hidden_cave_decimate_valid(hidden_cave_Decimator* d, uint32_t w, uint32_t x, double const* p) {
+    hidden_cave_decimate_prune(d, w);
+    hidden_cave_decimate_prune(d, x);
+    uint32_t e = hidden_cave_decimate_epoch(d);
+    uint32_t around_w = 0, around_x = 0, shared = 0, common = 0;
+    for(uint32_t c = d->first[w]; c != CAVE_DECIMATE_NIL; c = d->next[c]) {
+        uint32_t const* t = d->tris + (c - c % 3);
+        shared += t[0] == x || t[1] == x || t[2] == x;
+        for(int k = 0; k < 3; k++) {
+            if(t[k] != w && d->mark[t[k]] != e) {
+                d->mark[t[k]] = e;
+                around_w++;
+            }
+        }
+    }
+    for(uint32_t c = d->first[x]; c != CAVE_DECIMATE_NIL; c = d->next[c]) {
+        uint32_t const* t = d->tris + (c - c % 3);
+        for(int k = 0; k < 3; k++) {
+            uint32_t v = t[k];
+            if(v == w || v == x || d->mark[v] == e + 1) {
+                continue;
+            }
+            common += d->mark[v] == e;
+            d->mark[v] = e + 1;
+            around_x++;
+        }
+    }
+    bool border_w = d->flags[w] & CAVE_DECIMATE_BORDER, border_x = d->flags[x] & CAVE_DECIMATE_BORDER;
+    //joining two boundaries through the inside pinches the mesh
+    if(border_w && border_x && shared != 1) {
+        return false;
+    }
+    //any other neighbour in common would end up with a doubled edge, and too few neighbours left means a
+    //piece folded flat onto itself
+    if(common != shared || around_w - 1 + around_x - common < (border_w || border_x ? 2u : 3u)) {
+        return false;
+    }
+    return !hidden_cave_decimate_flips(d, w, x, p) && !hidden_cave_decimate_flips(d, x, w, p);
+}
+
+//works out the cheapest collapse `w` can make, and queues it
+static void hidden_cave_decimate_best(hidden_cave_Decimator* d, uint32_t w) {
+    hidden_cave_decimate_prune(d, w);
+    uint32_t rejected[CAVE_DECIMATE_TRIES];
+    uint32_t best = CAVE_DECIMATE_NIL;
+    double best_cost = INFINITY;
+    for(int attempt = 0; attempt < CAVE_DECIMATE_TRIES; attempt++) {
+        uint32_t e = hidden_cave_decimate_epoch(d);
+        double best_p[3];
+        best = CAVE_DECIMATE_NIL;
+        best_cost = INFINITY;
+        for(uint32_t c = d->first[w]; c != CAVE_DECIMATE_NIL; c = d->next[c]) {
+            uint32_t const* t = d->tris + (c - c % 3);
+            for(int k = 0; k < 3; k++) {
+                uint32_t x = t[k];
+                if(x == w || d->mark[x] == e) {
+                    continue;
+                }
+                d->mark[x] = e;
+                bool skip = false;
+                for(int r = 0; r < attempt; r++) {
+                    skip |= rejected[r] == x;
+                }
+                double p[3];
+                double cost = skip ? INFINITY : hidden_cave_decimate_edge(d, w, x, p);
+                if(cost < best_cost) {
+                    best = x;
+                    best_cost = cost;
+                    memcpy(best_p, p, sizeof(best_p));
+                }
+            }
+        }
+        if(best == CAVE_DECIMATE_NIL || best_cost > d->max_cost) {
+            best = CAVE_DECIMATE_NIL;
+            break;
+        }
+        if(hidden_cave_decimate_valid(d, w, best, best_p)) {
+            break;
+        }
+        rejected[attempt] = best;
+        best = CAVE_DECIMATE_NIL;
+    }
+    hidden_cave_decimate_queue(d, w, best, best_cost);
+}
+
+static void hidden_cave_normalize(double* n, cave_3Point* dest) {
+    double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if(len > 0) {
+        *dest = (cave_3Point) {(float) (n[0] / len), (float) (n[1] / len), (float) (n[2] / len)};
+    }
+}
+
+//merges `w` and `x` at `p`
+static void hidden_cave_decimate_collapse(hidden_cave_Decimator* d, uint32_t w, uint32_t x, double const* p,
+                                          double cost) {
+    uint32_t keep = d->flags[w] & CAVE_DECIMATE_LOCKED ? w : x, gone = keep == w ? x : w;
+    if(d->normals && d->attributes) {
+        double const* aw = d->attributes + 12 * (size_t) w;
+        double const* ax = d->attributes + 12 * (size_t) x;
+        double n[3];
+        for(int j = 0; j < 3; j++) {
+            n[j] = (aw[4 * j] + ax[4 * j]) * p[0] + (aw[4 * j + 1] + ax[4 * j + 1]) * p[1]
+                   + (aw[4 * j + 2] + ax[4 * j + 2]) * p[2] + aw[4 * j + 3] + ax[4 * j + 3];
+        }
+        hidden_cave_normalize(n, d->normals + keep);
+    } else if(d->normals) {
+        double pw[3], px[3];
+        hidden_cave_decimate_point(d, w, pw);
+        hidden_cave_decimate_point(d, x, px);
+        double e[3] = {px[0] - pw[0], px[1] - pw[1], px[2] - pw[2]};
+        double len2 = e[0] * e[0] + e[1] * e[1] + e[2] * e[2];
+        double t = len2 > 0 ? ((p[0] - pw[0]) * e[0] + (p[1] - pw[1]) * e[1] + (p[2] - pw[2]) * e[2]) / len2 : 0.5;
+        t = t < 0 ? 0 : (t > 1 ? 1 : t);
+        cave_3Point nw = d->normals[w], nx = d->normals[x];
+        double n[3] = {nw.x + t * (nx.x - nw.x), nw.y + t * (nx.y - nw.y), nw.z + t * (nx.z - nw.z)};
+        hidden_cave_normalize(n, d->normals + keep);
+    }
+
+    uint32_t last = CAVE_DECIMATE_NIL;
+    for(uint32_t c = d->first[gone]; c != CAVE_DECIMATE_NIL; c = d->next[c]) {
+        last = c;
+        uint32_t* t = d->tris + (c - c % 3);
+        if(t[0] == CAVE_DECIMATE_NIL) {
+            continue;
+        }
+        if(t[0] == keep || t[1] == keep || t[2] == keep) {
+            for(int k = 0; k < 3; k++) {
+                d->flags[t[k]] |= CAVE_DECIMATE_STALE;
+            }
+            t[0] = CAVE_DECIMATE_NIL;
+            d->live_tris--;
+        } else {
+            d->tris[c] = keep;
+        }
+    }
+    if(last != CAVE_DECIMATE_NIL) {
+        d->next[last] = d->first[keep];
+        d->first[keep] = d->first[gone];
+        d->first[gone] = CAVE_DECIMATE_NIL;
+    }
+    hidden_cave_quadric_add(d->quadrics + keep, d->quadrics + gone);
+    if(d->attributes) {
+        for(int i = 0; i < 12; i++) {
+            d->attributes[12 * (size_t) keep + i] += d->attributes[12 * (size_t) gone + i];
+        }
+    }
+    d->flags[keep] |= d->flags[gone] & (CAVE_DECIMATE_BORDER | CAVE_DECIMATE_STALE);
+    d->positions[keep] = (cave_3Point) {(float) (p[0] + d->center[0]), (float) (p[1] + d->center[1]),
+                                        (float) (p[2] + d->center[2])};
+    hidden_cave_decimate_unqueue(d, gone);
+    d->worst = cost > d->worst ? cost : d->worst;
+
+    uint32_t stamp = ++d->collapses;
+    hidden_cave_decimate_best(d, keep);
+    d->seen[keep] = stamp;
+    for(uint32_t c = d->first[keep]; c != CAVE_DECIMATE_NIL; c = d->next[c]) {
+        uint32_t const* t = d->tris + (c - c % 3);
+        for(int k = 0; k < 3; k++) {
+            uint32_t y = t[k];
+            if(d->seen[y] == stamp) {
+                continue;
+            }
+            d->seen[y] = stamp;
+            if(d->heap_pos[y] == CAVE_DECIMATE_NIL || d->partner[y] == gone || d->partner[y] == keep) {
+                hidden_cave_decimate_best(d, y);
+                continue;
+            }
+            double q[3];
+            double cost_y = hidden_cave_decimate_edge(d, y, keep, q);
+            if(cost_y < d->heap[d->heap_pos[y]].cost && hidden_cave_decimate_valid(d, y, keep, q)) {
+                hidden_cave_decimate_queue(d, y, keep, cost_y);
+            }
+        }
+    }
+}
+
+//the quadrics of every vertex, from its triangles, and for open boundaries, from planes along them
+static void hidden_cave_decimate_quadrics(hidden_cave_Decimator* d) {
+    for(uint32_t i = 0; i < d->tri_count; i++) {
+        uint32_t const* t = d->tris + 3 * (size_t) i;
+        if(t[0] == CAVE_DECIMATE_NIL) {
+            continue;
+        }
+        double p[3][3];
+        for(int k = 0; k < 3; k++) {
+            hidden_cave_decimate_point(d, t[k], p[k]);
+        }
+        double u[3] = {p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2]};
+        double v[3] = {p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]};
+        double n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+        double len = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if(!(len > 0)) {
+            continue;
+        }
+        double area = len / 2;
+        n[0] /= len;
+        n[1] /= len;
+        n[2] /= len;
+        hidden_cave_Quadric q = {{0}, {0}, 0, area};
+        hidden_cave_quadric_add_plane(&q, n, -(n[0] * p[0][0] + n[1] * p[0][1] + n[2] * p[0][2]), area);
+        double attributes[12] = {0};
+        if(d->attributes) {
+            //each component of the normal, as a linear function across the triangle
+            double uu = u[0] * u[0] + u[1] * u[1] + u[2] * u[2], uv = u[0] * v[0] + u[1] * v[1] + u[2] * v[2];
+            double vv = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+            double det = uu * vv - uv * uv;
+            for(int j = 0; j < 3; j++) {
+                double s[3];
+                for(int k = 0; k < 3; k++) {
+                    cave_3Point nk = d->normals[t[k]];
+                    s[k] = d->normal_weight * (j == 0 ? nk.x : (j == 1 ? nk.y : nk.z));
+                }
+                double g[3] = {0, 0, 0};
+                if(det > 1e-12 * uu * vv) {
+                    double alpha = (vv * (s[1] - s[0]) - uv * (s[2] - s[0])) / det;
+                    double beta = (uu * (s[2] - s[0]) - uv * (s[1] - s[0])) / det;
+                    for(int i2 = 0; i2 < 3; i2++) {
+                        g[i2] = alpha * u[i2] + beta * v[i2];
+                    }
+                }
+                double off = det > 1e-12 * uu * vv ? s[0] - (g[0] * p[0][0] + g[1] * p[0][1] + g[2] * p[0][2])
+                                                   : (s[0] + s[1] + s[2]) / 3;
+                hidden_cave_quadric_add_plane(&q, g, off, area);
+                for(int i2 = 0; i2 < 3; i2++) {
+                    attributes[4 * j + i2] = area * g[i2];
+                }
+                attributes[4 * j + 3] = area * off;
+            }
+        }
+        for(int k = 0; k < 3; k++) {
+            hidden_cave_quadric_add(d->quadrics + t[k], &q);
+            if(d->attributes) {
+                for(int i2 = 0; i2 < 12; i2++) {
+                    d->attributes[12 * (size_t) t[k] + i2] += attributes[i2];
+                }
+            }
+        }
+    }
+
+    //each half-edge is looked for among the other triangles of its vertex
+    for(uint32_t w = 0; w < d->vert_count; w++) {
+        for(uint32_t c = d->first[w]; c != CAVE_DECIMATE_NIL; c = d->next[c]) {
+            uint32_t const* t = d->tris + (c - c % 3);
+            uint32_t k = c % 3, x = t[(k + 1) % 3];
+            uint32_t count = 0;
+            for(uint32_t c2 = d->first[w]; c2 != CAVE_DECIMATE_NIL; c2 = d->next[c2]) {
+                uint32_t const* t2 = d->tris + (c2 - c2 % 3);
+                count += t2[0] == x || t2[1] == x || t2[2] == x;
+            }
+            if(count > 2) {
+                d->flags[w] |= CAVE_DECIMATE_BORDER | CAVE_DECIMATE_LOCKED;
+                d->flags[x] |= CAVE_DECIMATE_BORDER | CAVE_DECIMATE_LOCKED;
+            }
+            if(count != 1) {
+                continue;
+            }
+            d->flags[w] |= CAVE_DECIMATE_BORDER;
+            d->flags[x] |= CAVE_DECIMATE_BORDER;
+            double p[3][3];
+            for(int i = 0; i < 3; i++) {
+                hidden_cave_decimate_point(d, t[i], p[i]);
+            }
+            double u[3] = {p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2]};
+            double v[3] = {p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2]};
+            double n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+            double const* a = p[k];
+            double const* b = p[(k + 1) % 3];
+            double e[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            double m[3] = {e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0]};
+            double len = sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+            if(!(len > 0)) {
+                continue;
+            }
+            m[0] /= len;
+            m[1] /= len;
+            m[2] /= len;
+            hidden_cave_Quadric q = {{0}, {0}, 0, 0};
+            double weight = CAVE_DECIMATE_BORDER_WEIGHT * (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]);
+            hidden_cave_quadric_add_plane(&q, m, -(m[0] * a[0] + m[1] * a[1] + m[2] * a[2]), weight);
+            hidden_cave_quadric_add(d->quadrics + w, &q);
+            hidden_cave_quadric_add(d->quadrics + x, &q);
+        }
+    }
+}
+
+static void hidden_cave_decimate_release(hidden_cave_Decimator* d) {
+    free(d->first);
+    free(d->next);
+    free(d->quadrics);
+    free(d->attributes);
+    free(d->partner);
+    free(d->heap);
+    free(d->heap_pos);
+    free(d->mark);
+    free(d->seen);
+}
+
+//decimates the mesh the caller set `d` up with, down to `target` triangles
+static CaveError hidden_cave_decimate_run(hidden_cave_Decimator* d, cave_Decimate_Options const* options,
+                                          size_t target) {
+    size_t n = d->vert_count > 0 ? d->vert_count : 1;
+    d->first = malloc(sizeof(uint32_t) * n);
+    d->next = malloc(sizeof(uint32_t) * 3 * (d->tri_count > 0 ? (size_t) d->tri_count : 1));
+    d->quadrics = calloc(n, sizeof(hidden_cave_Quadric));
+    d->partner = malloc(sizeof(uint32_t) * n);
+    d->heap = malloc(sizeof(hidden_cave_Heap_Entry) * n);
+    d->heap_pos = malloc(sizeof(uint32_t) * n);
+    d->mark = calloc(n, sizeof(uint32_t));
+    d->seen = calloc(n, sizeof(uint32_t));
+    d->normal_weight = d->normals ? options->normal_weight : 0.0;
+    if(d->normal_weight > 0) {
+        d->attributes = calloc(12 * n, sizeof(double));
+    }
+    if(!d->first || !d->next || !d->quadrics || !d->partner || !d->heap || !d->heap_pos || !d->mark
+       || !d->seen || (d->normal_weight > 0 && !d->attributes)) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    d->max_cost = options->max_error > 0 ? (double) options->max_error * options->max_error : INFINITY;
+
+    float lo[3] = {INFINITY, INFINITY, INFINITY}, hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+    for(uint32_t v = 0; v < d->vert_count; v++) {
+        float p[3] = {d->positions[v].x, d->positions[v].y, d->positions[v].z};
+        for(int i = 0; i < 3; i++) {
+            lo[i] = p[i] < lo[i] ? p[i] : lo[i];
+            hi[i] = p[i] > hi[i] ? p[i] : hi[i];
+        }
+        d->first[v] = CAVE_DECIMATE_NIL;
+        d->heap_pos[v] = CAVE_DECIMATE_NIL;
+    }
+    for(int i = 0; i < 3; i++) {
+        d->center[i] = d->vert_count > 0 ? ((double) lo[i] + hi[i]) / 2 : 0.0;
+    }
+    //linked last to first, so that each vertex's list comes out in order
+    d->live_tris = 0;
+    for(uint32_t i = d->tri_count; i-- > 0;) {
+        uint32_t* t = d->tris + 3 * (size_t) i;
+        if(t[0] == t[1] || t[1] == t[2] || t[0] == t[2]) {
+            t[0] = CAVE_DECIMATE_NIL;
+            continue;
+        }
+        d->live_tris++;
+        for(uint32_t k = 3; k-- > 0;) {
+            d->next[3 * i + k] = d->first[t[k]];
+            d->first[t[k]] = 3 * i + k;
+        }
+    }
+    hidden_cave_decimate_quadrics(d);
+    if(options->preserve_boundary) {
+        for(uint32_t v = 0; v < d->vert_count; v++) {
+            d->flags[v] |= d->flags[v] & CAVE_DECIMATE_BORDER ? CAVE_DECIMATE_LOCKED : 0;
+        }
+    }
+    if(d->live_tris <= target) {
+        return CAVE_NO_ERROR;
+    }
+
+    for(uint32_t v = 0; v < d->vert_count; v++) {
+        if(d->first[v] != CAVE_DECIMATE_NIL) {
+            hidden_cave_decimate_best(d, v);
+        }
+    }
+    while(d->heap_len > 0 && d->live_tris > target) {
+        uint32_t w = d->heap[0].vertex;
+        if(d->heap[0].cost > d->max_cost) {
+            break;
+        }
+        uint32_t x = d->partner[w];
+        double p[3];
+        double cost = hidden_cave_decimate_edge(d, w, x, p);
+        if(!hidden_cave_decimate_valid(d, w, x, p)) {
+            hidden_cave_decimate_best(d, w);
+            continue;
+        }
+        hidden_cave_decimate_collapse(d, w, x, p, cost);
+    }
+    return CAVE_NO_ERROR;
+}
+
+//fills in `dest` with the triangles of `tris` that aren't gone, numbering vertexes in the order they're first
+//used
+static CaveError hidden_cave_decimate_output(cave_Mesh* dest, cave_3Point const* positions,
+                                             cave_3Point const* normals, size_t vert_count, uint32_t const* tris,
+                                             size_t tri_count) {
+    memset(dest, 0, sizeof(cave_Mesh));
+    size_t live = 0;
+    for(size_t i = 0; i < tri_count; i++) {
+        live += tris[3 * i] != CAVE_DECIMATE_NIL;
+    }
+    if(live == 0) {
+        return CAVE_NO_ERROR;
+    }
+    uint32_t* remap = malloc(sizeof(uint32_t) * vert_count);
+    dest->positions = malloc(sizeof(cave_3Point) * (live * 3 < vert_count ? live * 3 : vert_count));
+    dest->tris = malloc(sizeof(cave_Index_Triangle) * live);
+    if(normals) {
+        dest->normals = malloc(sizeof(cave_3Point) * (live * 3 < vert_count ? live * 3 : vert_count));
+    }
+    if(!remap || !dest->positions || !dest->tris || (normals && !dest->normals)) {
+        free(remap);
+        cave_Mesh_release(dest);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    memset(remap, 0xFF, sizeof(uint32_t) * vert_count);
+    size_t count = 0;
+    for(size_t i = 0; i < tri_count; i++) {
+        uint32_t const* t = tris + 3 * i;
+        if(t[0] == CAVE_DECIMATE_NIL) {
+            continue;
+        }
+        size_t indexes[3];
+        for(int k = 0; k < 3; k++) {
+            if(remap[t[k]] == CAVE_DECIMATE_NIL) {
+                remap[t[k]] = (uint32_t) dest->vert_count;
+                dest->positions[dest->vert_count] = positions[t[k]];
+                if(normals) {
+                    dest->normals[dest->vert_count] = normals[t[k]];
+                }
+                dest->vert_count++;
+            }
+            indexes[k] = remap[t[k]];
+        }
+        dest->tris[count++] = (cave_Index_Triangle) {indexes[0], indexes[1], indexes[2]};
+    }
+    dest->tri_count = count;
+    free(remap);
+    cave_3Point* shrunk = realloc(dest->positions, sizeof(cave_3Point) * dest->vert_count);
+    if(shrunk) {
+        dest->positions = shrunk;
+    }
+    if(normals) {
+        shrunk = realloc(dest->normals, sizeof(cave_3Point) * dest->vert_count);
+        if(shrunk) {
+            dest->normals = shrunk;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_decimate_exact(cave_Mesh* dest, cave_Mesh const* src,
+                                            cave_Decimate_Options const* options, double* worst) {
+    size_t n = src->vert_count > 0 ? src->vert_count : 1;
+    hidden_cave_Decimator d = {0};
+    d.positions = malloc(sizeof(cave_3Point) * n);
+    d.normals = src->normals ? malloc(sizeof(cave_3Point) * n) : NULL;
+    d.tris = malloc(sizeof(uint32_t) * 3 * (src->tri_count > 0 ? src->tri_count : 1));
+    d.flags = calloc(n, 1);
+    d.vert_count = (uint32_t) src->vert_count;
+    d.tri_count = (uint32_t) src->tri_count;
+    CaveError err = CAVE_NO_ERROR;
+    if(!d.positions || (src->normals && !d.normals) || !d.tris || !d.flags) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    } else {
+        memcpy(d.positions, src->positions, sizeof(cave_3Point) * src->vert_count);
+        if(src->normals) {
+            memcpy(d.normals, src->normals, sizeof(cave_3Point) * src->vert_count);
+        }
+        for(size_t i = 0; i < src->tri_count; i++) {
+            d.tris[3 * i] = (uint32_t) src->tris[i].a;
+            d.tris[3 * i + 1] = (uint32_t) src->tris[i].b;
+            d.tris[3 * i + 2] = (uint32_t) src->tris[i].c;
+        }
+        err = hidden_cave_decimate_run(&d, options, options->target_tri_count);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_decimate_output(dest, d.positions, d.normals, d.vert_count, d.tris, d.tri_count);
+        *worst = d.worst > *worst ? d.worst : *worst;
+    }
+    hidden_cave_decimate_release(&d);
+    free(d.positions);
+    free(d.normals);
+    free(d.tris);
+    free(d.flags);
+    return err;
+}
+
+typedef struct hidden_cave_Cluster_Pass {
+    cave_Mesh const* src;
+    cave_Decimate_Options const* options;
+    uint32_t const* order; //the triangles, cluster by cluster
+    size_t const* cluster_start; //where each cluster's triangles start in `order`
+    uint32_t const* owner; //the cluster using each vertex, or CAVE_DECIMATE_SHARED
+    double ratio;
+    //the positions and normals the clusters leave their vertexes at
+    cave_3Point* positions;
+    cave_3Point* normals;
+    uint32_t* tris; //what each cluster leaves of its triangles, from where they start in `order`
+    size_t* kept; //how many triangles each cluster leaves
+    double* worst; //per cluster
+} hidden_cave_Cluster_Pass;
+
+static CaveError hidden_cave_decimate_clusters(void* arg, size_t worker, size_t begin, size_t end) {
+    (void) worker;
+    hidden_cave_Cluster_Pass* pass = arg;
+    cave_Mesh const* src = pass->src;
+    for(size_t k = begin; k < end; k++) {
+        size_t start = pass->cluster_start[k], count = pass->cluster_start[k + 1] - start;
+        //numbers the cluster's vertexes through a table, kept at most half full
+        size_t table_len = 16;
+        while(table_len < count * 6) {
+            table_len *= 2;
+        }
+        uint32_t* table = malloc(sizeof(uint32_t) * table_len);
+        uint32_t* global = malloc(sizeof(uint32_t) * count * 3);
+        hidden_cave_Decimator d = {0};
+        d.positions = malloc(sizeof(cave_3Point) * count * 3);
+        d.normals = src->normals ? malloc(sizeof(cave_3Point) * count * 3) : NULL;
+        d.tris = malloc(sizeof(uint32_t) * count * 3);
+        d.flags = malloc(count * 3);
+        CaveError err = CAVE_NO_ERROR;
+        if(!table || !global || !d.positions || (src->normals && !d.normals) || !d.tris || !d.flags) {
+            err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+        } else {
+            memset(table, 0xFF, sizeof(uint32_t) * table_len);
+            for(size_t i = 0; i < count; i++) {
+                cave_Index_Triangle t = src->tris[pass->order[start + i]];
+                size_t corners[3] = {t.a, t.b, t.c};
+                for(int c = 0; c < 3; c++) {
+                    uint32_t v = (uint32_t) corners[c];
+                    size_t slot = (v * (size_t) 0x9E3779B1u) & (table_len - 1);
+                    while(table[slot] != CAVE_DECIMATE_NIL && global[table[slot]] != v) {
+                        slot = (slot + 1) & (table_len - 1);
+                    }
+                    if(table[slot] == CAVE_DECIMATE_NIL) {
+                        table[slot] = d.vert_count;
+                        global[d.vert_count] = v;
+                        d.positions[d.vert_count] = src->positions[v];
+                        if(d.normals) {
+                            d.normals[d.vert_count] = src->normals[v];
+                        }
+                        d.flags[d.vert_count] = pass->owner[v] == CAVE_DECIMATE_SHARED ? CAVE_DECIMATE_LOCKED : 0;
+                        d.vert_count++;
+                    }
+                    d.tris[3 * i + c] = table[slot];
+                }
+            }
+            d.tri_count = (uint32_t) count;
+            //triangles at the seams can't go far, so the rest are taken down to the ratio, not past it
+            size_t seam = 0;
+            for(size_t i = 0; i < count; i++) {
+                seam += (d.flags[d.tris[3 * i]] | d.flags[d.tris[3 * i + 1]] | d.flags[d.tris[3 * i + 2]]) != 0;
+            }
+            size_t target = (size_t) ceil(pass->ratio * (double) (count - seam)) + seam;
+            err = hidden_cave_decimate_run(&d, pass->options, target);
+        }
+        if(err == CAVE_NO_ERROR) {
+            //vertexes are owned by one cluster unless locked, so no two clusters write the same one
+            for(uint32_t v = 0; v < d.vert_count; v++) {
+                if(!(d.flags[v] & CAVE_DECIMATE_LOCKED)) {
+                    pass->positions[global[v]] = d.positions[v];
+                    if(d.normals) {
+                        pass->normals[global[v]] = d.normals[v];
+                    }
+                }
+            }
+            uint32_t* out = pass->tris + 3 * start;
+            size_t kept = 0;
+            for(size_t i = 0; i < count; i++) {
+                if(d.tris[3 * i] != CAVE_DECIMATE_NIL) {
+                    for(int c = 0; c < 3; c++) {
+                        out[3 * kept + c] = global[d.tris[3 * i + c]];
+                    }
+                    kept++;
+                }
+            }
+            pass->kept[k] = kept;
+            pass->worst[k] = d.worst;
+        }
+        hidden_cave_decimate_release(&d);
+        free(d.positions);
+        free(d.normals);
+        free(d.tris);
+        free(d.flags);
+        free(table);
+        free(global);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+//spreads the low bits of `v` out to every third bit
+static uint32_t hidden_cave_decimate_spread(uint32_t v) {
+    v = (v | (v << 16)) & 0x030000FFu;
+    v = (v | (v << 8)) & 0x0300F00Fu;
+    v = (v | (v << 4)) & 0x030C30C3u;
+    v = (v | (v << 2)) & 0x09249249u;
+    return v;
+}
+
+//decimates clusters on their own, then what they leave as a whole
+static CaveError hidden_cave_decimate_approximate(cave_Mesh* dest, cave_Mesh const* src,
+                                                  cave_Decimate_Options const* options, double* worst) {
+    size_t tri_count = src->tri_count, vert_count = src->vert_count;
+    size_t bucket_count = (size_t) 1 << (3 * CAVE_DECIMATE_MORTON_BITS);
+    uint32_t* codes = malloc(sizeof(uint32_t) * tri_count);
+    uint32_t* order = malloc(sizeof(uint32_t) * tri_count);
+    size_t* buckets = calloc(bucket_count + 1, sizeof(size_t));
+    size_t* cluster_start = malloc(sizeof(size_t) * (tri_count / CAVE_DECIMATE_CLUSTER + 2));
+    uint32_t* owner = malloc(sizeof(uint32_t) * vert_count);
+    hidden_cave_Cluster_Pass pass = {src, options, order, cluster_start, owner, 0.0, NULL, NULL, NULL, NULL, NULL};
+    pass.positions = malloc(sizeof(cave_3Point) * vert_count);
+    pass.normals = src->normals ? malloc(sizeof(cave_3Point) * vert_count) : NULL;
+    pass.tris = malloc(sizeof(uint32_t) * 3 * tri_count);
+    pass.kept = malloc(sizeof(size_t) * (tri_count / CAVE_DECIMATE_CLUSTER + 1));
+    pass.worst = malloc(sizeof(double) * (tri_count / CAVE_DECIMATE_CLUSTER + 1));
+    CaveError err = CAVE_NO_ERROR;
+    if(!codes || !order || !buckets || !cluster_start || !owner || !pass.positions || (src->normals && !pass.normals)
+       || !pass.tris || !pass.kept || !pass.worst) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+
+    size_t cluster_count = 0;
+    if(err == CAVE_NO_ERROR) {
+        float lo[3] = {INFINITY, INFINITY, INFINITY}, hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+        for(size_t v = 0; v < vert_count; v++) {
+            float p[3] = {src->positions[v].x, src->positions[v].y, src->positions[v].z};
+            for(int i = 0; i < 3; i++) {
+                lo[i] = p[i] < lo[i] ? p[i] : lo[i];
+                hi[i] = p[i] > hi[i] ? p[i] : hi[i];
+            }
+        }
+        double scale[3];
+        for(int i = 0; i < 3; i++) {
+            double extent = (double) hi[i] - lo[i];
+            scale[i] = extent > 0 ? (double) (1u << CAVE_DECIMATE_MORTON_BITS) / extent : 0.0;
+        }
+        uint32_t cell_max = (1u << CAVE_DECIMATE_MORTON_BITS) - 1;
+        for(size_t i = 0; i < tri_count; i++) {
+            cave_Index_Triangle t = src->tris[i];
+            cave_3Point a = src->positions[t.a], b = src->positions[t.b], c = src->positions[t.c];
+            double centroid[3] = {((double) a.x + b.x + c.x) / 3, ((double) a.y + b.y + c.y) / 3,
+                                  ((double) a.z + b.z + c.z) / 3};
+            uint32_t code = 0;
+            for(int k = 0; k < 3; k++) {
+                double cell = (centroid[k] - lo[k]) * scale[k];
+                uint32_t q = cell > 0 ? (cell < cell_max ? (uint32_t) cell : cell_max) : 0;
+                code |= hidden_cave_decimate_spread(q) << k;
+            }
+            codes[i] = code;
+            buckets[code + 1]++;
+        }
+        for(size_t i = 0; i < bucket_count; i++) {
+            buckets[i + 1] += buckets[i];
+        }
+        for(size_t i = 0; i < tri_count; i++) {
+            order[buckets[codes[i]]++] = (uint32_t) i;
+        }
+        //each bucket's count has been added to where it starts, so it now holds where the next one starts
+        cluster_start[0] = 0;
+        for(size_t i = 0; i < bucket_count; i++) {
+            size_t end = buckets[i];
+            if(end - cluster_start[cluster_count] >= CAVE_DECIMATE_CLUSTER && end < tri_count) {
+                cluster_start[++cluster_count] = end;
+            }
+        }
+        cluster_start[++cluster_count] = tri_count;
+
+        memset(owner, 0xFF, sizeof(uint32_t) * vert_count);
+        for(size_t k = 0; k < cluster_count; k++) {
+            for(size_t i = cluster_start[k]; i < cluster_start[k + 1]; i++) {
+                cave_Index_Triangle t = src->tris[order[i]];
+                size_t corners[3] = {t.a, t.b, t.c};
+                for(int c = 0; c < 3; c++) {
+                    uint32_t* o = owner + corners[c];
+                    *o = *o == CAVE_DECIMATE_NIL || *o == k ? (uint32_t) k : CAVE_DECIMATE_SHARED;
+                }
+            }
+        }
+        memcpy(pass.positions, src->positions, sizeof(cave_3Point) * vert_count);
+        if(src->normals) {
+            memcpy(pass.normals, src->normals, sizeof(cave_3Point) * vert_count);
+        }
+        pass.ratio = (double) options->target_tri_count / (double) tri_count;
+        size_t threads = options->threads > 0 ? options->threads : cave_thread_hardware_count();
+        err = cave_parallel_for(cluster_count, 1, threads, hidden_cave_decimate_clusters, &pass);
+    }
+    free(codes);
+    free(buckets);
+    free(owner);
+
+    cave_Mesh merged = {0};
+    if(err == CAVE_NO_ERROR) {
+        //gathers what the clusters left, packed, into what `order` held
+        uint32_t* packed = pass.tris;
+        size_t count = 0;
+        for(size_t k = 0; k < cluster_count; k++) {
+            memmove(packed + 3 * count, pass.tris + 3 * cluster_start[k], sizeof(uint32_t) * 3 * pass.kept[k]);
+            count += pass.kept[k];
+            *worst = pass.worst[k] > *worst ? pass.worst[k] : *worst;
+        }
+        err = hidden_cave_decimate_output(&merged, pass.positions, pass.normals, vert_count, packed, count);
+    }
+    free(order);
+    free(cluster_start);
+    free(pass.positions);
+    free(pass.normals);
+    free(pass.tris);
+    free(pass.kept);
+    free(pass.worst);
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_decimate_exact(dest, &merged, options, worst);
+    }
+    cave_Mesh_release(&merged);
+    return err;
+}
+
+CaveError cave_Mesh_decimate(cave_Mesh* dest, cave_Mesh const* src, cave_Decimate_Options const* options,
+                             float* error) {
+    if(!dest || !src || !options || (!src->positions && src->vert_count > 0) || (!src->tris && src->tri_count > 0)
+       || src->vert_count >= UINT32_MAX - 1 || src->tri_count >= UINT32_MAX / 3
+       || !(options->max_error >= 0) || !(options->normal_weight >= 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    for(size_t i = 0; i < src->tri_count; i++) {
+        cave_Index_Triangle t = src->tris[i];
+        if(t.a >= src->vert_count || t.b >= src->vert_count || t.c >= src->vert_count) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+    memset(dest, 0, sizeof(cave_Mesh));
+    double worst = 0.0;
+    CaveError err;
+    bool clustered = options->approximate && src->tri_count >= 2 * CAVE_DECIMATE_CLUSTER;
+    if(clustered && options->target_tri_count < src->tri_count) {
+        err = hidden_cave_decimate_approximate(dest, src, options, &worst);
+    } else {
+        err = hidden_cave_decimate_exact(dest, src, options, &worst);
+    }
+    if(error) {
+        *error = err == CAVE_NO_ERROR ? (float) sqrt(worst) : 0.0f;
+    }
+    return err;
+}
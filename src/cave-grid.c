@@ -0,0 +1,372 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-grid.h"
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//cell coordinates are clamped to this, so far away points share the outermost cells rather than overflow
+#define CAVE_GRID_LIMIT (1 << 30)
+//queries per chunk, when a batch is spread across threads
+#define CAVE_GRID_QUERY_GRAIN (1024)
+
+typedef struct hidden_cave_Cell {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+} hidden_cave_Cell;
+
+static int32_t hidden_cave_grid_coord(float v, float inv_cell_size) {
+    float f = floorf(v * inv_cell_size);
+    //written so that NaN ends up at the limit too
+    f = f < (float) CAVE_GRID_LIMIT ? f : (float) CAVE_GRID_LIMIT;
+    f = f > (float) -CAVE_GRID_LIMIT ? f : (float) -CAVE_GRID_LIMIT;
+    return (int32_t) f;
+}
+
+static hidden_cave_Cell hidden_cave_grid_cell(cave_Point_Grid const* grid, cave_3Point p) {
+    hidden_cave_Cell cell = {hidden_cave_grid_coord(p.x, grid->inv_cell_size),
+                             hidden_cave_grid_coord(p.y, grid->inv_cell_size),
+                             hidden_cave_grid_coord(p.z, grid->inv_cell_size)};
+    return cell;
+}
+
+//the slot of cell (x, y, z). Only y and z are hashed, so the cells along a row take consecutive slots.
+static size_t hidden_cave_grid_slot(cave_Point_Grid const* grid, int32_t x, int32_t y, int32_t z) {
+    uint64_t h = (uint64_t) (uint32_t) y * 0x9E3779B97F4A7C15u;
+    h ^= (uint64_t) (uint32_t) z * 0xC2B2AE3D27D4EB4Fu;
+    h ^= h >> 32;
+    return (size_t) ((h + (uint32_t) x) & (grid->slot_count - 1));
+}
+
+static float hidden_cave_grid_dist2(cave_3Point a, cave_3Point b) {
+    float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+void cave_Point_Grid_release(cave_Point_Grid* grid) {
+    if(!grid) { return; }
+    free(grid->points);
+    free(grid->ids);
+    free(grid->slots);
+    memset(grid, 0, sizeof(cave_Point_Grid));
+}
+
+//makes sure `*a`, and `*b` unless it's NULL, can hold `count` items of `a_size` and `b_size` bytes, sharing a
+//`capacity` between them. What they held isn't kept.
+static bool hidden_cave_grid_reserve(void** a, void** b, size_t* capacity, size_t count, size_t a_size,
+                                     size_t b_size) {
+    if(*capacity >= count) {
+        return true;
+    }
+    free(*a);
+    *a = malloc(count * a_size);
+    bool ok = *a != NULL;
+    if(b) {
+        free(*b);
+        *b = malloc(count * b_size);
+        ok = ok && *b != NULL;
+    }
+    *capacity = ok ? count : 0;
+    return ok;
+}
+
+CaveError cave_Point_Grid_build(cave_Point_Grid* grid, cave_3Point const* points, size_t point_count,
+                                float cell_size) {
+    if(!grid || (!points && point_count > 0) || point_count >= UINT32_MAX || !(cell_size > 0.0f)
+       || !isfinite(cell_size) || !isfinite(1.0f / cell_size)) {
+        return CAVE_DATA_ERROR;
+    }
+    size_t slot_count = 1;
+    while(slot_count < point_count) {
+        slot_count *= 2;
+    }
+    if(!hidden_cave_grid_reserve((void**) &grid->points, (void**) &grid->ids, &grid->point_capacity, point_count,
+                                 sizeof(cave_3Point), sizeof(uint32_t))
+       || !hidden_cave_grid_reserve((void**) &grid->slots, NULL, &grid->slot_capacity, slot_count,
+                                    sizeof(cave_Grid_Slot), 0)) {
+        cave_Point_Grid_release(grid);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    grid->cell_size = cell_size;
+    grid->inv_cell_size = 1.0f / cell_size;
+    grid->point_count = point_count;
+    grid->slot_count = slot_count;
+
+    //counts the points in each slot
+    cave_Grid_Slot* slots = grid->slots;
+    memset(slots, 0, sizeof(cave_Grid_Slot) * slot_count);
+    for(size_t i = 0; i < point_count; i++) {
+        hidden_cave_Cell cell = hidden_cave_grid_cell(grid, points[i]);
+        slots[hidden_cave_grid_slot(grid, cell.x, cell.y, cell.z)].count++;
+    }
+    uint32_t start = 0;
+    for(size_t s = 0; s < slot_count; s++) {
+        slots[s].start = start;
+        start += slots[s].count;
+        slots[s].count = 0;
+    }
+    //then copies them into place, counting each slot back up as it fills
+    for(size_t i = 0; i < point_count; i++) {
+        hidden_cave_Cell cell = hidden_cave_grid_cell(grid, points[i]);
+        cave_Grid_Slot* slot = slots + hidden_cave_grid_slot(grid, cell.x, cell.y, cell.z);
+        uint32_t at = slot->start + slot->count++;
+        grid->points[at] = points[i];
+        grid->ids[at] = (uint32_t) i;
+    }
+    return CAVE_NO_ERROR;
+}
+
+/*
+ * Queries
+ */
+
+//the cells of the points within `radius` of `p`, by each axis
+static void hidden_cave_grid_box(cave_Point_Grid const* grid, cave_3Point p, float radius, hidden_cave_Cell* lo,
+                                 hidden_cave_Cell* hi) {
+    *lo = hidden_cave_grid_cell(grid, (cave_3Point) {p.x - radius, p.y - radius, p.z - radius});
+    *hi = hidden_cave_grid_cell(grid, (cave_3Point) {p.x + radius, p.y + radius, p.z + radius});
+}
+
+//whether there are more cells from `lo` to `hi` than slots, in which case testing every point is quicker
+static bool hidden_cave_grid_box_too_big(cave_Point_Grid const* grid, hidden_cave_Cell lo, hidden_cave_Cell hi) {
+    double cells = ((double) hi.x - lo.x + 1.0) * ((double) hi.y - lo.y + 1.0) * ((double) hi.z - lo.z + 1.0);
+    return cells > (double) grid->slot_count;
+}
+
+//the points in the slots of cells `x_lo` to `x_hi` along row (y, z), which run on from each other unless they
+//wrap around the end of the slots. Sets `runs` to the one or two ranges of points, and returns how many.
+static int hidden_cave_grid_row(cave_Point_Grid const* grid, int32_t x_lo, int32_t x_hi, int32_t y, int32_t z,
+                                uint32_t runs[4]) {
+    size_t first = hidden_cave_grid_slot(grid, x_lo, y, z), last = hidden_cave_grid_slot(grid, x_hi, y, z);
+    cave_Grid_Slot const* slots = grid->slots;
+    uint32_t end = slots[last].start + slots[last].count;
+    if(first <= last) {
+        runs[0] = slots[first].start;
+        runs[1] = end;
+        return 1;
+    }
+    runs[0] = slots[first].start;
+    runs[1] = (uint32_t) grid->point_count;
+    runs[2] = 0;
+    runs[3] = end;
+    return 2;
+}
+
+size_t cave_Point_Grid_within(cave_Point_Grid const* grid, cave_3Point point, float radius, uint32_t* ids,
+                              size_t capacity) {
+    if(!grid || grid->point_count == 0 || !(radius >= 0.0f)) {
+        return 0;
+    }
+    float r2 = radius * radius;
+    size_t found = 0;
+    hidden_cave_Cell lo, hi;
+    hidden_cave_grid_box(grid, point, radius, &lo, &hi);
+    if(hidden_cave_grid_box_too_big(grid, lo, hi)) {
+        for(size_t i = 0; i < grid->point_count; i++) {
+            if(hidden_cave_grid_dist2(grid->points[i], point) <= r2) {
+                if(found < capacity) {
+                    ids[found] = grid->ids[i];
+                }
+                found++;
+            }
+        }
+        return found;
+    }
+    for(int32_t z = lo.z; z <= hi.z; z++) {
+        for(int32_t y = lo.y; y <= hi.y; y++) {
+            uint32_t runs[4];
+            int run_count = hidden_cave_grid_row(grid, lo.x, hi.x, y, z, runs);
+            for(int r = 0; r < run_count; r++) {
+                for(uint32_t i = runs[2 * r]; i < runs[2 * r + 1]; i++) {
+                    if(hidden_cave_grid_dist2(grid->points[i], point) > r2) {
+                        continue;
+                    }
+                    //other cells can hash into the row's slots, including cells of other rows being looked
+                    //through, so only points of this row's cells count here
+                    hidden_cave_Cell cell = hidden_cave_grid_cell(grid, grid->points[i]);
+                    if(cell.y != y || cell.z != z || cell.x < lo.x || cell.x > hi.x) {
+                        continue;
+                    }
+                    if(found < capacity) {
+                        ids[found] = grid->ids[i];
+                    }
+                    found++;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+typedef struct hidden_cave_Grid_Best {
+    size_t id;
+    float dist2;
+    //only points at most this far, squared, count
+    float limit2;
+} hidden_cave_Grid_Best;
+
+static void hidden_cave_grid_consider(cave_Point_Grid const* grid, cave_3Point p, uint32_t i,
+                                      hidden_cave_Grid_Best* best) {
+    float d2 = hidden_cave_grid_dist2(grid->points[i], p);
+    if(d2 <= best->limit2 && (d2 < best->dist2 || (d2 == best->dist2 && grid->ids[i] < best->id))) {
+        best->id = grid->ids[i];
+        best->dist2 = d2;
+    }
+}
+
+bool cave_Point_Grid_nearest(cave_Point_Grid const* grid, cave_3Point point, float max_distance,
+                             cave_Grid_Nearest* nearest) {
+    if(!nearest) {
+        return false;
+    }
+    nearest->id = SIZE_MAX;
+    nearest->distance = INFINITY;
+    if(!grid || grid->point_count == 0 || !(max_distance >= 0.0f)) {
+        return false;
+    }
+    hidden_cave_Grid_Best best = {SIZE_MAX, INFINITY, max_distance * max_distance};
+
+    //looks through boxes of cells reaching further out each time, each visiting only the cells the last didn't.
+    //Every point within `reach` of `point` has been seen once a box is done, so once the best is that near
+    //there's no need to look further.
+    hidden_cave_Cell prev_lo = {0, 0, 0}, prev_hi = {-1, -1, -1};
+    for(size_t ring = 0;; ring++) {
+        float reach = (float) ring * grid->cell_size;
+        reach = reach < max_distance ? reach : max_distance;
+        hidden_cave_Cell lo, hi;
+        hidden_cave_grid_box(grid, point, reach, &lo, &hi);
+        //boxes stop growing where cells are clamped, so how far out they've gone is checked as well
+        double span = 2.0 * (double) ring + 1.0;
+        if(hidden_cave_grid_box_too_big(grid, lo, hi) || span * span * span > (double) grid->slot_count) {
+            for(uint32_t i = 0; i < (uint32_t) grid->point_count; i++) {
+                hidden_cave_grid_consider(grid, point, i, &best);
+            }
+            break;
+        }
+        for(int32_t z = lo.z; z <= hi.z; z++) {
+            for(int32_t y = lo.y; y <= hi.y; y++) {
+                //rows through the last box only need the cells either side of it
+                bool inner_row = z >= prev_lo.z && z <= prev_hi.z && y >= prev_lo.y && y <= prev_hi.y;
+                int32_t spans[4] = {lo.x, hi.x, prev_hi.x + 1, hi.x};
+                if(inner_row) {
+                    spans[1] = prev_lo.x - 1;
+                }
+                for(int span = 0; span < (inner_row ? 2 : 1); span++) {
+                    if(spans[2 * span] > spans[2 * span + 1]) {
+                        continue;
+                    }
+                    uint32_t runs[4];
+                    int run_count = hidden_cave_grid_row(grid, spans[2 * span], spans[2 * span + 1], y, z, runs);
+                    for(int r = 0; r < run_count; r++) {
+                        for(uint32_t i = runs[2 * r]; i < runs[2 * r + 1]; i++) {
+                            hidden_cave_grid_consider(grid, point, i, &best);
+                        }
+                    }
+                }
+            }
+        }
+        if(reach >= max_distance || (best.id != SIZE_MAX && best.dist2 <= reach * reach)) {
+            break;
+        }
+        prev_lo = lo;
+        prev_hi = hi;
+    }
+    if(best.id == SIZE_MAX) {
+        return false;
+    }
+    nearest->id = best.id;
+    nearest->distance = sqrtf(best.dist2);
+    return true;
+}
+
+/*
+ * Batches
+ */
+
+typedef struct hidden_cave_Grid_Batch {
+    cave_Point_Grid const* grid;
+    cave_3Point const* queries;
+    float distance;
+    //set while counting neighbors, when each query's count is written to the offset after its own
+    size_t* counts;
+    //set while writing neighbors down
+    cave_Grid_Neighbors* neighbors;
+    cave_Grid_Nearest* nearest;
+} hidden_cave_Grid_Batch;
+
+static CaveError hidden_cave_grid_batch_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    (void) worker;
+    hidden_cave_Grid_Batch const* batch = arg;
+    for(size_t i = begin; i < end; i++) {
+        if(batch->counts) {
+            batch->counts[i + 1] = cave_Point_Grid_within(batch->grid, batch->queries[i], batch->distance, NULL, 0);
+        } else if(batch->neighbors) {
+            size_t at = batch->neighbors->offsets[i], len = batch->neighbors->offsets[i + 1] - at;
+            cave_Point_Grid_within(batch->grid, batch->queries[i], batch->distance, batch->neighbors->ids + at, len);
+        } else {
+            cave_Point_Grid_nearest(batch->grid, batch->queries[i], batch->distance, batch->nearest + i);
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+void cave_Grid_Neighbors_release(cave_Grid_Neighbors* neighbors) {
+    if(!neighbors) { return; }
+    free(neighbors->offsets);
+    free(neighbors->ids);
+    memset(neighbors, 0, sizeof(cave_Grid_Neighbors));
+}
+
+CaveError cave_Point_Grid_neighbors(cave_Point_Grid const* grid, cave_3Point const* queries, size_t query_count,
+                                    float radius, cave_Grid_Neighbors* dest, size_t threads) {
+    if(!grid || !dest || (!queries && query_count > 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    if(!hidden_cave_grid_reserve((void**) &dest->offsets, NULL, &dest->offset_capacity, query_count + 1,
+                                 sizeof(size_t), 0)) {
+        cave_Grid_Neighbors_release(dest);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    dest->query_count = query_count;
+    dest->id_count = 0;
+    dest->offsets[0] = 0;
+    threads = threads > 0 ? threads : cave_thread_hardware_count();
+    hidden_cave_Grid_Batch batch = {grid, queries, radius, dest->offsets, NULL, NULL};
+    CaveError err = cave_parallel_for(query_count, CAVE_GRID_QUERY_GRAIN, threads, hidden_cave_grid_batch_chunk,
+                                      &batch);
+    if(err != CAVE_NO_ERROR) {
+        dest->query_count = 0;
+        return err;
+    }
+    for(size_t i = 0; i < query_count; i++) {
+        dest->offsets[i + 1] += dest->offsets[i];
+    }
+    size_t id_count = dest->offsets[query_count];
+    if(!hidden_cave_grid_reserve((void**) &dest->ids, NULL, &dest->id_capacity, id_count, sizeof(uint32_t), 0)) {
+        cave_Grid_Neighbors_release(dest);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    batch.counts = NULL;
+    batch.neighbors = dest;
+    err = cave_parallel_for(query_count, CAVE_GRID_QUERY_GRAIN, threads, hidden_cave_grid_batch_chunk, &batch);
+    if(err != CAVE_NO_ERROR) {
+        dest->query_count = 0;
+        return err;
+    }
+    dest->id_count = id_count;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_Point_Grid_nearests(cave_Point_Grid const* grid, cave_3Point const* queries, size_t query_count,
+                                   float max_distance, cave_Grid_Nearest* nearest, size_t threads) {
+    if(!grid || ((!queries || !nearest) && query_count > 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    threads = threads > 0 ? threads : cave_thread_hardware_count();
+    hidden_cave_Grid_Batch batch = {grid, queries, max_distance, NULL, NULL, nearest};
+    return cave_parallel_for(query_count, CAVE_GRID_QUERY_GRAIN, threads, hidden_cave_grid_batch_chunk, &batch);
+}
@@ -0,0 +1,191 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-lz.h"
+#include <string.h>
+
+//matches shorter than this are not worth the 3 byte cost of a back-reference.
+#define CAVE_LZ_MIN_MATCH (4)
+#define CAVE_LZ_HASH_BITS (14)
+
+static uint32_t hidden_cave_lz_read32(uint8_t const* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static uint32_t hidden_cave_lz_hash(uint32_t sequence) {
+    //Knuth's multiplicative hash, keeping the top bits
+    return (sequence * 2654435761u) >> (32 - CAVE_LZ_HASH_BITS);
+}
+
+//writes the 255-run length extension used for both literal and match lengths.
+static uint8_t* hidden_cave_lz_write_len(uint8_t* op, size_t len) {
+    while(len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (uint8_t) len;
+    return op;
+}
+
+//emits one sequence. If `match_len` is 0, this is the final literal-only sequence.
+static uint8_t* hidden_cave_lz_emit(uint8_t* op, uint8_t const* literals, size_t lit_len,
+                                    size_t offset, size_t match_len) {
+    uint8_t* token = op++;
+    size_t match_code = match_len ? match_len - CAVE_LZ_MIN_MATCH : 0;
+    *token = (uint8_t) (((lit_len < 15 ? lit_len : 15) << 4) | (match_code < 15 ? match_code : 15));
+    if(lit_len >= 15) {
+        op = hidden_cave_lz_write_len(op, lit_len - 15);
+    }
+    memcpy(op, literals, lit_len);
+    op += lit_len;
+    if(match_len) {
+        *op++ = (uint8_t) (offset & 0xFF);
+        *op++ = (uint8_t) (offset >> 8);
+        if(match_code >= 15) {
+            op = hidden_cave_lz_write_len(op, match_code - 15);
+        }
+    }
+    return op;
+}
+
+size_t cave_lz_compress_bound(size_t src_len) {
+    return src_len + (src_len / 255) + 16;
+}
+
+CaveError cave_lz_compress(uint8_t* dst, size_t dst_cap, size_t* dst_len, uint8_t const* src, size_t src_len) {
+    if(!dst || !dst_len || (!src && src_len != 0)) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //the match table stores 32 bit positions
+    if(src_len >= UINT32_MAX) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //positions are stored +1 so that 0 means "empty slot"
+    uint32_t table[1 << CAVE_LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + dst_cap;
+    uint8_t const* ip = src;
+    uint8_t const* anchor = src;
+    uint8_t const* const iend = src + src_len;
+    size_t misses = 0;
+
+    while(src_len >= CAVE_LZ_MIN_MATCH && ip + CAVE_LZ_MIN_MATCH <= iend) {
+        uint32_t seq = hidden_cave_lz_read32(ip);
+        uint32_t h = hidden_cave_lz_hash(seq);
+        size_t candidate_pos = table[h];
+        table[h] = (uint32_t) (ip - src) + 1;
+
+        if(candidate_pos != 0) {
+            uint8_t const* candidate = src + candidate_pos - 1;
+            size_t offset = (size_t) (ip - candidate);
+            if(offset <= CAVE_LZ_MAX_OFFSET && hidden_cave_lz_read32(candidate) == seq) {
+                size_t match_len = CAVE_LZ_MIN_MATCH;
+                while(ip + match_len < iend && candidate[match_len] == ip[match_len]) {
+                    match_len += 1;
+                }
+                size_t lit_len = (size_t) (ip - anchor);
+                //token + length extensions + literals + offset
+                size_t worst = 1 + (lit_len / 255 + 1) + lit_len + 2 + (match_len / 255 + 1);
+                if((size_t) (oend - op) < worst) {
+                    return CAVE_INDEX_ERROR;
+                }
+                op = hidden_cave_lz_emit(op, anchor, lit_len, offset, match_len);
+                ip += match_len;
+                anchor = ip;
+                misses = 0;
+                continue;
+            }
+        }
+        //skip ahead faster through incompressible data
+        misses += 1;
+        ip += 1 + (misses >> 6);
+    }
+
+    size_t lit_len = (size_t) (iend - anchor);
+    if((size_t) (oend - op) < 1 + (lit_len / 255 + 1) + lit_len) {
+        return CAVE_INDEX_ERROR;
+    }
+    op = hidden_cave_lz_emit(op, anchor, lit_len, 0, 0);
+    *dst_len = (size_t) (op - dst);
+    return CAVE_NO_ERROR;
+}
+
+//reads a 255-run length extension. returns false if the input runs out.
+static int hidden_cave_lz_read_len(uint8_t const** ip, uint8_t const* iend, size_t* len) {
+    uint8_t b;
+    do {
+        if(*ip >= iend) {
+            return 0;
+        }
+        b = **ip;
+        *ip += 1;
+        *len += b;
+    } while(b == 255);
+    return 1;
+}
+
+CaveError cave_lz_decompress(uint8_t* dst, size_t dst_len, uint8_t const* src, size_t src_len) {
+    if((!dst && dst_len != 0) || !src) {
+        return CAVE_DATA_ERROR;
+    }
+    uint8_t const* ip = src;
+    uint8_t const* const iend = src + src_len;
+    uint8_t* op = dst;
+    uint8_t* const oend = dst + dst_len;
+
+    while(ip < iend) {
+        uint8_t token = *ip++;
+        size_t lit_len = token >> 4;
+        if(lit_len == 15 && !hidden_cave_lz_read_len(&ip, iend, &lit_len)) {
+            return CAVE_DATA_ERROR;
+        }
+        if((size_t) (iend - ip) < lit_len || (size_t) (oend - op) < lit_len) {
+            return CAVE_DATA_ERROR;
+        }
+        memcpy(op, ip, lit_len);
+        op += lit_len;
+        ip += lit_len;
+
+        if(ip == iend) {
+            //final, literal-only sequence
+            break;
+        }
+
+        if(iend - ip < 2) {
+            return CAVE_DATA_ERROR;
+        }
+        size_t offset = (size_t) ip[0] | ((size_t) ip[1] << 8);
+        ip += 2;
+        size_t match_len = token & 0x0F;
+        if(match_len == 15 && !hidden_cave_lz_read_len(&ip, iend, &match_len)) {
+            return CAVE_DATA_ERROR;
+        }
+        match_len += CAVE_LZ_MIN_MATCH;
+
+        if(offset == 0 || offset > (size_t) (op - dst) || (size_t) (oend - op) < match_len) {
+            return CAVE_DATA_ERROR;
+        }
+        uint8_t const* match = op - offset;
+        if(offset >= match_len) {
+            memcpy(op, match, match_len);
+            op += match_len;
+        } else {
+            //overlapping copy is how runs are encoded, so copy forwards one byte at a time
+            for(size_t i = 0; i < match_len; i++) {
+                *op++ = match[i];
+            }
+        }
+    }
+
+    if(op != oend) {
+        return CAVE_DATA_ERROR;
+    }
+    return CAVE_NO_ERROR;
+}
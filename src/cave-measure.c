@@ -0,0 +1,199 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-measure.h"
+#include "cave-vecmath-internal.h"
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//Triangles are summed in chunks of this many, whatever the number of threads, so the sums come out the same.
+//Each chunk is worked through in blocks small enough to keep on the stack.
+#define CAVE_MEASURE_GRAIN (16384)
+#define CAVE_MEASURE_BLOCK (256)
+
+//a compensated running sum (Neumaier's take on Kahan's), good to about twice the precision of a double
+typedef struct hidden_cave_Sum {
+    double sum;
+    double carry;
+} hidden_cave_Sum;
+
+static void hidden_cave_sum_add(hidden_cave_Sum* s, double x) {
+    double t = s->sum + x;
+    if(fabs(s->sum) >= fabs(x)) {
+        s->carry += (s->sum - t) + x;
+    } else {
+        s->carry += (x - t) + s->sum;
+    }
+    s->sum = t;
+}
+
+static double hidden_cave_sum_total(hidden_cave_Sum const* s) {
+    return s->sum + s->carry;
+}
+
+//what's summed per triangle, with n = (b - a) x (c - a), s = a + b + c, and corners taken from the origin
+enum {
+    CAVE_MEASURE_AREA, //|n|, twice the area
+    CAVE_MEASURE_VOLUME, //a . n, six times the volume of the tetrahedron the triangle makes with the origin
+    CAVE_MEASURE_MOMENT, //(a . n) s, three of them
+    CAVE_MEASURE_SURFACE = CAVE_MEASURE_MOMENT + 3, //|n| s, three of them
+    CAVE_MEASURE_SUMS = CAVE_MEASURE_SURFACE + 3,
+};
+
+typedef struct hidden_cave_Measure_Chunk {
+    float min[3];
+    float max[3];
+    hidden_cave_Sum sums[CAVE_MEASURE_SUMS];
+} hidden_cave_Measure_Chunk;
+
+typedef struct hidden_cave_Measure_Pass {
+    //one of these is set
+    cave_STL_Tri const* tris;
+    uint8_t const* records;
+    //taken off every corner before summing, so that meshes far from (0, 0, 0) don't lose their precision
+    cave_3Point origin;
+    hidden_cave_Measure_Chunk* chunks;
+} hidden_cave_Measure_Pass;
+
+static void hidden_cave_measure_block(hidden_cave_Measure_Chunk* chunk, cave_3Point origin,
+                                      hidden_cave_Vecmath_Kernels const* kernels, cave_STL_Tri* tris, size_t len) {
+    size_t const stride = sizeof(cave_STL_Tri) / sizeof(float);
+    cave_Vec3_Array va = {&tris->a.x, &tris->a.y, &tris->a.z, stride};
+    cave_Vec3_Array vb = {&tris->b.x, &tris->b.y, &tris->b.z, stride};
+    cave_Vec3_Array vc = {&tris->c.x, &tris->c.y, &tris->c.z, stride};
+    kernels->bounds3(chunk->min, chunk->max, &va, len);
+    kernels->bounds3(chunk->min, chunk->max, &vb, len);
+    kernels->bounds3(chunk->min, chunk->max, &vc, len);
+
+    cave_3Point normals[CAVE_MEASURE_BLOCK];
+    cave_Vec3_Array vn = {&normals->x, &normals->y, &normals->z, 3};
+    kernels->tri_cross3(&vn, &va, &vb, &vc, len);
+    for(size_t i = 0; i < len; i++) {
+        cave_STL_Tri const* t = tris + i;
+        double nx = normals[i].x, ny = normals[i].y, nz = normals[i].z;
+        double ax = (double) t->a.x - origin.x, ay = (double) t->a.y - origin.y, az = (double) t->a.z - origin.z;
+        double s[3] = {ax + ((double) t->b.x - origin.x) + ((double) t->c.x - origin.x),
+                       ay + ((double) t->b.y - origin.y) + ((double) t->c.y - origin.y),
+                       az + ((double) t->b.z - origin.z) + ((double) t->c.z - origin.z)};
+        double area = sqrt(nx * nx + ny * ny + nz * nz);
+        double volume = ax * nx + ay * ny + az * nz;
+        hidden_cave_sum_add(&chunk->sums[CAVE_MEASURE_AREA], area);
+        hidden_cave_sum_add(&chunk->sums[CAVE_MEASURE_VOLUME], volume);
+        for(int k = 0; k < 3; k++) {
+            hidden_cave_sum_add(&chunk->sums[CAVE_MEASURE_MOMENT + k], volume * s[k]);
+            hidden_cave_sum_add(&chunk->sums[CAVE_MEASURE_SURFACE + k], area * s[k]);
+        }
+    }
+}
+
+static CaveError hidden_cave_measure_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    (void) worker;
+    hidden_cave_Measure_Pass* pass = arg;
+    hidden_cave_Measure_Chunk* chunk = pass->chunks + begin / CAVE_MEASURE_GRAIN;
+    for(int k = 0; k < 3; k++) {
+        chunk->min[k] = INFINITY;
+        chunk->max[k] = -INFINITY;
+    }
+    hidden_cave_Dispatch const* dispatch = hidden_cave_dispatch();
+    cave_STL_Tri decoded[CAVE_MEASURE_BLOCK];
+    for(size_t start = begin; start < end; start += CAVE_MEASURE_BLOCK) {
+        size_t len = end - start < CAVE_MEASURE_BLOCK ? end - start : CAVE_MEASURE_BLOCK;
+        //the kernels only read, but take their arrays as non-const
+        cave_STL_Tri* tris = (cave_STL_Tri*) pass->tris + start;
+        if(pass->records) {
+            dispatch->decode_STL_tris(decoded, pass->records + 50 * start, len);
+            tris = decoded;
+        }
+        hidden_cave_measure_block(chunk, pass->origin, dispatch->vecmath, tris, len);
+    }
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_measure(cave_Mesh_Measures* dest, hidden_cave_Measure_Pass* pass, size_t tri_count,
+                                     size_t threads) {
+    *dest = (cave_Mesh_Measures) {{INFINITY, INFINITY, INFINITY}, {-INFINITY, -INFINITY, -INFINITY}, 0.0, 0.0,
+                                  {0.0f, 0.0f, 0.0f}};
+    if(tri_count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    size_t chunk_count = (tri_count + CAVE_MEASURE_GRAIN - 1) / CAVE_MEASURE_GRAIN;
+    pass->chunks = calloc(chunk_count, sizeof(hidden_cave_Measure_Chunk));
+    if(!pass->chunks) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    threads = threads > 0 ? threads : cave_thread_hardware_count();
+    CaveError err = cave_parallel_for(tri_count, CAVE_MEASURE_GRAIN, threads, hidden_cave_measure_chunk, pass);
+    if(err != CAVE_NO_ERROR) {
+        free(pass->chunks);
+        return err;
+    }
+
+    //the chunks are added up in order, on this thread
+    float min[3] = {INFINITY, INFINITY, INFINITY}, max[3] = {-INFINITY, -INFINITY, -INFINITY};
+    hidden_cave_Sum sums[CAVE_MEASURE_SUMS] = {{0}};
+    for(size_t c = 0; c < chunk_count; c++) {
+        hidden_cave_Measure_Chunk const* chunk = pass->chunks + c;
+        for(int k = 0; k < 3; k++) {
+            min[k] = chunk->min[k] < min[k] ? chunk->min[k] : min[k];
+            max[k] = chunk->max[k] > max[k] ? chunk->max[k] : max[k];
+        }
+        for(int k = 0; k < CAVE_MEASURE_SUMS; k++) {
+            hidden_cave_sum_add(&sums[k], chunk->sums[k].sum);
+            hidden_cave_sum_add(&sums[k], chunk->sums[k].carry);
+        }
+    }
+    free(pass->chunks);
+
+    dest->min = (cave_3Point) {min[0], min[1], min[2]};
+    dest->max = (cave_3Point) {max[0], max[1], max[2]};
+    double area = hidden_cave_sum_total(&sums[CAVE_MEASURE_AREA]);
+    double volume = hidden_cave_sum_total(&sums[CAVE_MEASURE_VOLUME]);
+    dest->area = area / 2.0;
+    dest->volume = volume / 6.0;
+    //the solid's centroid is the tetrahedra's, (origin + a + b + c) / 4, weighed by volume, and the surface's
+    //is the triangles', (a + b + c) / 3, weighed by area
+    double center[3] = {0.0, 0.0, 0.0};
+    for(int k = 0; k < 3; k++) {
+        if(volume != 0.0) {
+            center[k] = hidden_cave_sum_total(&sums[CAVE_MEASURE_MOMENT + k]) / (4.0 * volume);
+        } else if(area != 0.0) {
+            center[k] = hidden_cave_sum_total(&sums[CAVE_MEASURE_SURFACE + k]) / (3.0 * area);
+        }
+    }
+    if(volume != 0.0 || area != 0.0) {
+        dest->centroid = (cave_3Point) {(float) (pass->origin.x + center[0]), (float) (pass->origin.y + center[1]),
+                                        (float) (pass->origin.z + center[2])};
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_STL_Data_measure(cave_Mesh_Measures* dest, cave_STL_Data const* data, size_t threads) {
+    if(!dest || !data || (!data->tris && data->tri_count > 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_Measure_Pass pass = {data->tris, NULL, {0.0f, 0.0f, 0.0f}, NULL};
+    if(data->tri_count > 0) {
+        pass.origin = data->tris[0].a;
+    }
+    return hidden_cave_measure(dest, &pass, data->tri_count, threads);
+}
+
+CaveError cave_STL_Bytes_measure(cave_Mesh_Measures* dest, uint8_t const* bytes, size_t bytes_len, size_t threads) {
+    if(!dest || !bytes || bytes_len < 84 || (bytes_len - 84) % 50 != 0) {
+        return CAVE_DATA_ERROR;
+    }
+    uint32_t tri_count;
+    memcpy(&tri_count, bytes + 80, 4);
+    if(tri_count != (bytes_len - 84) / 50) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_Measure_Pass pass = {NULL, bytes + 84, {0.0f, 0.0f, 0.0f}, NULL};
+    if(tri_count > 0) {
+        //the first record's normal is 12 bytes, and its first corner comes right after
+        memcpy(&pass.origin, bytes + 84 + 12, 12);
+    }
+    return hidden_cave_measure(dest, &pass, tri_count, threads);
+}
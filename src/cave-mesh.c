@@ -0,0 +1,358 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-mesh.h"
+#include "cave-vecmath-internal.h"
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+void cave_Mesh_release(cave_Mesh* mesh) {
+    if(!mesh) { return; }
+    free(mesh->positions);
+    free(mesh->normals);
+    free(mesh->tris);
+    mesh->positions = NULL;
+    mesh->normals = NULL;
+    mesh->tris = NULL;
+    mesh->vert_count = 0;
+    mesh->tri_count = 0;
+}
+
+static uint64_t hidden_cave_hash_3point(cave_3Point const* p) {
+    uint32_t bits[3];
+    memcpy(bits, p, 12);
+    //FNV-1a style mixing over the three words, followed by a final avalanche
+    uint64_t h = 1469598103934665603ull;
+    for(int i = 0; i < 3; i++) {
+        h ^= bits[i];
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 29;
+    h *= 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 32;
+    return h;
+}
+
+CaveError cave_STL_Data_to_Mesh(cave_Mesh* dest, cave_STL_Data const* src) {
+    if(!dest || !src) {
+        return CAVE_DATA_ERROR;
+    }
+    memset(dest, 0, sizeof(cave_Mesh));
+    if(src->tri_count == 0) {
+        return CAVE_NO_ERROR;
+    }
+
+    size_t corner_count = (size_t) src->tri_count * 3;
+    //open addressing table, kept at most half full
+    size_t table_len = 16;
+    while(table_len < corner_count * 2) {
+        table_len *= 2;
+    }
+    size_t* table = malloc(sizeof(size_t) * table_len);
+    dest->positions = malloc(sizeof(cave_3Point) * corner_count);
+    dest->tris = malloc(sizeof(cave_Index_Triangle) * src->tri_count);
+    if(!table || !dest->positions || !dest->tris) {
+        free(table);
+        cave_Mesh_release(dest);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    memset(table, 0xFF, sizeof(size_t) * table_len);
+
+    size_t vert_count = 0;
+    for(size_t i = 0; i < src->tri_count; i++) {
+        cave_STL_Tri const* tri = src->tris + i;
+        cave_3Point const* corners[3] = {&tri->a, &tri->b, &tri->c};
+        size_t indexes[3];
+        for(int k = 0; k < 3; k++) {
+            size_t slot = hidden_cave_hash_3point(corners[k]) & (table_len - 1);
+            while(table[slot] != SIZE_MAX &&
+                  memcmp(dest->positions + table[slot], corners[k], sizeof(cave_3Point)) != 0) {
+                slot = (slot + 1) & (table_len - 1);
+            }
+            if(table[slot] == SIZE_MAX) {
+                table[slot] = vert_count;
+                dest->positions[vert_count] = *corners[k];
+                vert_count += 1;
+            }
+            indexes[k] = table[slot];
+        }
+        dest->tris[i].a = indexes[0];
+        dest->tris[i].b = indexes[1];
+        dest->tris[i].c = indexes[2];
+    }
+    free(table);
+
+    //give back the slack from the corners that were welded away
+    cave_3Point* shrunk = realloc(dest->positions, sizeof(cave_3Point) * vert_count);
+    if(shrunk) {
+        dest->positions = shrunk;
+    }
+    dest->vert_count = vert_count;
+    dest->tri_count = src->tri_count;
+    return CAVE_NO_ERROR;
+}
+
+static cave_3Point hidden_cave_face_normal(cave_3Point a, cave_3Point b, cave_3Point c) {
+    float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+    float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+    cave_3Point n = {uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx};
+    return n;
+}
+
+static bool hidden_cave_mesh_indexes_valid(cave_Mesh const* mesh) {
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        if(t.a >= mesh->vert_count || t.b >= mesh->vert_count || t.c >= mesh->vert_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CaveError cave_Mesh_to_STL_Data(cave_STL_Data* dest, cave_Mesh const* src) {
+    if(!dest || !src || src->tri_count > UINT32_MAX || !hidden_cave_mesh_indexes_valid(src)) {
+        return CAVE_DATA_ERROR;
+    }
+    memset(dest->header, 0, 80);
+    dest->tri_count = (uint32_t) src->tri_count;
+    if(src->tri_count == 0) {
+        dest->tris = NULL;
+        return CAVE_NO_ERROR;
+    }
+    dest->tris = malloc(sizeof(cave_STL_Tri) * src->tri_count);
+    if(!dest->tris) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < src->tri_count; i++) {
+        cave_STL_Tri* out = dest->tris + i;
+        out->a = src->positions[src->tris[i].a];
+        out->b = src->positions[src->tris[i].b];
+        out->c = src->positions[src->tris[i].c];
+        cave_3Point n = hidden_cave_face_normal(out->a, out->b, out->c);
+        float len = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+        if(len > 0.0f) {
+            n.x /= len;
+            n.y /= len;
+            n.z /= len;
+        }
+        out->normal = n;
+        out->attribute = 0;
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_Mesh_compute_vertex_normals(cave_Mesh* mesh) {
+    return cave_Mesh_compute_weighted_normals(mesh, NULL);
+}
+
+/*
+ * Normals, in parallel
+ */
+
+//Triangles are handed to threads this many at a time, and worked through in blocks small enough for the
+//stack, which the vector kernels take in one go.
+#define CAVE_NORMALS_GRAIN (16384)
+#define CAVE_NORMALS_BLOCK (256)
+
+typedef struct hidden_cave_Normal_Repair {
+    cave_STL_Tri* tris;
+    bool replace_all;
+    bool check_only;
+    float cos_tolerance;
+    size_t* replaced; //one count per worker
+} hidden_cave_Normal_Repair;
+
+//whether `stored` is too far off `n`, the unit normal of its triangle, or zero if the triangle is degenerate
+static bool hidden_cave_normal_deviates(cave_3Point stored, cave_3Point n, float cos_tolerance) {
+    bool stored_zero = stored.x == 0.0f && stored.y == 0.0f && stored.z == 0.0f;
+    if(n.x == 0.0f && n.y == 0.0f && n.z == 0.0f) {
+        return !stored_zero;
+    }
+    float len2 = stored.x * stored.x + stored.y * stored.y + stored.z * stored.z;
+    if(stored_zero || !isfinite(len2)) {
+        return true;
+    }
+    //written so that NaNs count as deviating
+    float cosine = (stored.x * n.x + stored.y * n.y + stored.z * n.z) / sqrtf(len2);
+    return !(cosine >= cos_tolerance);
+}
+
+static CaveError hidden_cave_repair_normals_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    hidden_cave_Normal_Repair* repair = arg;
+    hidden_cave_Vecmath_Kernels const* kernels = hidden_cave_vecmath_kernels();
+    cave_3Point normals[CAVE_NORMALS_BLOCK];
+    cave_Vec3_Array vn = {&normals->x, &normals->y, &normals->z, 3};
+    size_t const stride = sizeof(cave_STL_Tri) / sizeof(float);
+    size_t replaced = 0;
+    for(size_t start = begin; start < end; start += CAVE_NORMALS_BLOCK) {
+        size_t len = end - start < CAVE_NORMALS_BLOCK ? end - start : CAVE_NORMALS_BLOCK;
+        cave_STL_Tri* tris = repair->tris + start;
+        cave_Vec3_Array va = {&tris->a.x, &tris->a.y, &tris->a.z, stride};
+        cave_Vec3_Array vb = {&tris->b.x, &tris->b.y, &tris->b.z, stride};
+        cave_Vec3_Array vc = {&tris->c.x, &tris->c.y, &tris->c.z, stride};
+        kernels->tri_cross3(&vn, &va, &vb, &vc, len);
+        kernels->normalize3(&vn, &vn, len);
+        for(size_t i = 0; i < len; i++) {
+            if(repair->replace_all || hidden_cave_normal_deviates(tris[i].normal, normals[i], repair->cos_tolerance)) {
+                replaced += 1;
+                if(!repair->check_only) {
+                    tris[i].normal = normals[i];
+                }
+            }
+        }
+    }
+    repair->replaced[worker] += replaced;
+    return CAVE_NO_ERROR;
+}
+
+static size_t hidden_cave_normal_threads(cave_Normal_Options const* options) {
+    return options->threads > 0 ? options->threads : cave_thread_hardware_count();
+}
+
+CaveError cave_STL_Data_repair_normals(cave_STL_Data* data, cave_Normal_Options const* options, size_t* replaced) {
+    cave_Normal_Options opts = {0.0f, false, CAVE_NORMAL_WEIGHT_AREA, 0};
+    if(options) {
+        opts = *options;
+    }
+    if(!data || (!data->tris && data->tri_count > 0) || !(opts.tolerance >= 0.0f)) {
+        return CAVE_DATA_ERROR;
+    }
+    if(replaced) {
+        *replaced = 0;
+    }
+    size_t threads = hidden_cave_normal_threads(&opts);
+    size_t* counts = calloc(threads, sizeof(size_t));
+    if(!counts) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    hidden_cave_Normal_Repair repair = {data->tris, opts.tolerance == 0.0f, opts.check_only,
+                                        cosf(opts.tolerance), counts};
+    CaveError err = cave_parallel_for(data->tri_count, CAVE_NORMALS_GRAIN, threads,
+                                      hidden_cave_repair_normals_chunk, &repair);
+    for(size_t w = 0; replaced && w < threads; w++) {
+        *replaced += counts[w];
+    }
+    free(counts);
+    return err;
+}
+
+typedef struct hidden_cave_Face_Normals {
+    cave_Mesh const* mesh;
+    //per face, its normal as long as twice its area when weighing by area, or its unit normal otherwise
+    cave_3Point* normals;
+    //per face when weighing by angle, the angles at its corners a, b and c, as x, y and z
+    cave_3Point* angles;
+} hidden_cave_Face_Normals;
+
+static float hidden_cave_corner_angle(cave_3Point at, cave_3Point p, cave_3Point q, float cross_len) {
+    float dot = (p.x - at.x) * (q.x - at.x) + (p.y - at.y) * (q.y - at.y) + (p.z - at.z) * (q.z - at.z);
+    return atan2f(cross_len, dot);
+}
+
+static CaveError hidden_cave_face_normals_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    (void) worker;
+    hidden_cave_Face_Normals* faces = arg;
+    cave_Mesh const* mesh = faces->mesh;
+    hidden_cave_Vecmath_Kernels const* kernels = hidden_cave_vecmath_kernels();
+    //the corners are gathered into blocks, since the kernels can't follow indexes
+    cave_3Point corners[3][CAVE_NORMALS_BLOCK];
+    cave_Vec3_Array va = {&corners[0]->x, &corners[0]->y, &corners[0]->z, 3};
+    cave_Vec3_Array vb = {&corners[1]->x, &corners[1]->y, &corners[1]->z, 3};
+    cave_Vec3_Array vc = {&corners[2]->x, &corners[2]->y, &corners[2]->z, 3};
+    for(size_t start = begin; start < end; start += CAVE_NORMALS_BLOCK) {
+        size_t len = end - start < CAVE_NORMALS_BLOCK ? end - start : CAVE_NORMALS_BLOCK;
+        for(size_t i = 0; i < len; i++) {
+            cave_Index_Triangle t = mesh->tris[start + i];
+            corners[0][i] = mesh->positions[t.a];
+            corners[1][i] = mesh->positions[t.b];
+            corners[2][i] = mesh->positions[t.c];
+        }
+        cave_3Point* normals = faces->normals + start;
+        cave_Vec3_Array vn = {&normals->x, &normals->y, &normals->z, 3};
+        kernels->tri_cross3(&vn, &va, &vb, &vc, len);
+        if(!faces->angles) {
+            continue;
+        }
+        for(size_t i = 0; i < len; i++) {
+            cave_3Point n = normals[i];
+            float cross_len = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+            cave_3Point a = corners[0][i], b = corners[1][i], c = corners[2][i];
+            faces->angles[start + i] = (cave_3Point) {hidden_cave_corner_angle(a, b, c, cross_len),
+                                                      hidden_cave_corner_angle(b, c, a, cross_len),
+                                                      hidden_cave_corner_angle(c, a, b, cross_len)};
+        }
+        kernels->normalize3(&vn, &vn, len);
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_Mesh_compute_weighted_normals(cave_Mesh* mesh, cave_Normal_Options const* options) {
+    cave_Normal_Options opts = {0.0f, false, CAVE_NORMAL_WEIGHT_AREA, 0};
+    if(options) {
+        opts = *options;
+    }
+    if(!mesh || !hidden_cave_mesh_indexes_valid(mesh)
+       || (opts.weighting != CAVE_NORMAL_WEIGHT_AREA && opts.weighting != CAVE_NORMAL_WEIGHT_ANGLE)) {
+        return CAVE_DATA_ERROR;
+    }
+    if(mesh->vert_count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    bool by_angle = opts.weighting == CAVE_NORMAL_WEIGHT_ANGLE;
+    size_t face_count = mesh->tri_count > 0 ? mesh->tri_count : 1;
+    hidden_cave_Face_Normals faces = {mesh, malloc(sizeof(cave_3Point) * face_count), NULL};
+    if(by_angle) {
+        faces.angles = malloc(sizeof(cave_3Point) * face_count);
+    }
+    if(!mesh->normals) {
+        mesh->normals = malloc(sizeof(cave_3Point) * mesh->vert_count);
+    }
+    if(!faces.normals || (by_angle && !faces.angles) || !mesh->normals) {
+        free(faces.normals);
+        free(faces.angles);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    CaveError err = cave_parallel_for(mesh->tri_count, CAVE_NORMALS_GRAIN, hidden_cave_normal_threads(&opts),
+                                      hidden_cave_face_normals_chunk, &faces);
+    if(err != CAVE_NO_ERROR) {
+        free(faces.normals);
+        free(faces.angles);
+        return err;
+    }
+
+    //summed in face order, on this thread, so the sums don't depend on how the faces were divided up
+    memset(mesh->normals, 0, sizeof(cave_3Point) * mesh->vert_count);
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        cave_3Point n = faces.normals[i];
+        size_t corners[3] = {t.a, t.b, t.c};
+        float weights[3] = {1.0f, 1.0f, 1.0f};
+        if(by_angle) {
+            weights[0] = faces.angles[i].x;
+            weights[1] = faces.angles[i].y;
+            weights[2] = faces.angles[i].z;
+        }
+        for(int k = 0; k < 3; k++) {
+            cave_3Point* vn = mesh->normals + corners[k];
+            if(by_angle) {
+                vn->x += n.x * weights[k];
+                vn->y += n.y * weights[k];
+                vn->z += n.z * weights[k];
+            } else {
+                vn->x += n.x;
+                vn->y += n.y;
+                vn->z += n.z;
+            }
+        }
+    }
+    free(faces.normals);
+    free(faces.angles);
+    cave_Vec3_Array vn = {&mesh->normals->x, &mesh->normals->y, &mesh->normals->z, 3};
+    hidden_cave_vecmath_kernels()->normalize3(&vn, &vn, mesh->vert_count);
+    return CAVE_NO_ERROR;
+}
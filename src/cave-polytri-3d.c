@@ -0,0 +1,172 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-polytri.h"
+#include "cave-polytri-internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//A planar face is triangulated in 2D by dropping the axis its normal leans along most, which keeps the
+//projection from flattening it. The two axes kept are ordered so that the face's outlines, which turn
+//counter-clockwise around its normal, turn counter-clockwise in 2D too, and its holes clockwise. The
+//ear clipper then sorts them out as it would any 2D polygon, and the triangles it makes wind the same way
+//as the face did.
+
+//the normal of the points from `start` up to `end` by Newell's method, which averages over every edge and so
+//isn't thrown by collinear or slightly non-planar points. Taken relative to `origin`, to keep the products
+//small when the face is far from the origin.
+static void hidden_cave_newell(cave_3Point const* points, size_t start, size_t end, cave_3Point origin,
+                               double* normal) {
+    for(size_t i = start, j = end - 1; i < end; j = i++) {
+        double jx = (double) points[j].x - origin.x, jy = (double) points[j].y - origin.y;
+        double jz = (double) points[j].z - origin.z;
+        double ix = (double) points[i].x - origin.x, iy = (double) points[i].y - origin.y;
+        double iz = (double) points[i].z - origin.z;
+        normal[0] += (jy - iy) * (jz + iz);
+        normal[1] += (jz - iz) * (jx + ix);
+        normal[2] += (jx - ix) * (jy + iy);
+    }
+}
+
+static float hidden_cave_axis(cave_3Point p, int axis) {
+    return axis == 0 ? p.x : (axis == 1 ? p.y : p.z);
+}
+
+CaveError hidden_cave_polytri_validate_polygon_3d(cave_3d_Polygon const* polygon) {
+    if(!polygon || (polygon->ring_count != 0 && !polygon->ring_offsets)) {
+        return CAVE_DATA_ERROR;
+    }
+    if(polygon->ring_count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    size_t const* offsets = polygon->ring_offsets;
+    for(size_t r = 0; r < polygon->ring_count; r++) {
+        if(offsets[r] > offsets[r + 1]) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+    //points are clipped from a copy of their own, so only how many there are is bounded, not where they are
+    if(offsets[polygon->ring_count] - offsets[0] > CAVE_POLYTRI_MAX_POINTS) {
+        return CAVE_DATA_ERROR;
+    }
+    if(!polygon->points && offsets[polygon->ring_count] != offsets[0]) {
+        return CAVE_DATA_ERROR;
+    }
+    for(size_t i = offsets[0]; i < offsets[polygon->ring_count]; i++) {
+        cave_3Point p = polygon->points[i];
+        if(!isfinite(p.x) || !isfinite(p.y) || !isfinite(p.z)) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError hidden_cave_polytri_ear_clip_3d(hidden_cave_PolyTri_Scratch* scratch, cave_3d_Polygon const* polygon,
+                                          hidden_cave_PolyTri_Out* out) {
+    size_t ring_count = polygon->ring_count;
+    size_t first = ring_count > 0 ? polygon->ring_offsets[0] : 0;
+    size_t point_count = ring_count > 0 ? polygon->ring_offsets[ring_count] - first : 0;
+    if(point_count < 3) {
+        return CAVE_NO_ERROR;
+    }
+
+    double normal[3] = {0.0, 0.0, 0.0};
+    for(size_t r = 0; r < ring_count; r++) {
+        if(polygon->ring_offsets[r + 1] > polygon->ring_offsets[r]) {
+            hidden_cave_newell(polygon->points, polygon->ring_offsets[r], polygon->ring_offsets[r + 1],
+                               polygon->points[first], normal);
+        }
+    }
+    int drop = 2;
+    if(fabs(normal[0]) > fabs(normal[1]) && fabs(normal[0]) > fabs(normal[2])) {
+        drop = 0;
+    } else if(fabs(normal[1]) > fabs(normal[2])) {
+        drop = 1;
+    }
+    if(normal[drop] == 0.0) {
+        //every point is on one line, so there is nothing to fill
+        return CAVE_NO_ERROR;
+    }
+    //(y, z), (z, x) and (x, y) turn counter-clockwise around +x, +y and +z, and swapping them mirrors that
+    int u = (drop + 1) % 3, v = (drop + 2) % 3;
+    if(normal[drop] < 0) {
+        int swap = u;
+        u = v;
+        v = swap;
+    }
+
+    cave_2Point* projected = hidden_cave_polytri_reserve(scratch, CAVE_POLYTRI_SCRATCH_PROJECTED,
+                                                         sizeof(cave_2Point) * point_count);
+    size_t* offsets = hidden_cave_polytri_reserve(scratch, CAVE_POLYTRI_SCRATCH_PROJECTED_RINGS,
+                                                  sizeof(size_t) * (ring_count + 1));
+    if(!projected || !offsets) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < point_count; i++) {
+        projected[i].x = hidden_cave_axis(polygon->points[first + i], u);
+        projected[i].y = hidden_cave_axis(polygon->points[first + i], v);
+    }
+    for(size_t r = 0; r <= ring_count; r++) {
+        offsets[r] = polygon->ring_offsets[r] - first;
+    }
+    cave_2d_Polygon flat = {projected, offsets, ring_count};
+    out->offset += first;
+    CaveError err = hidden_cave_polytri_ear_clip(scratch, &flat, out);
+    out->offset -= first;
+    return err;
+}
+
+CaveError cave_polytri_triangulate_3d(cave_Index_Triangle** dest, size_t* tri_count, cave_3d_Polygon const* polygon) {
+    if(!dest || !tri_count) {
+        return CAVE_DATA_ERROR;
+    }
+    *dest = NULL;
+    *tri_count = 0;
+    CaveError err = hidden_cave_polytri_validate_polygon_3d(polygon);
+    if(err != CAVE_NO_ERROR || polygon->ring_count == 0) {
+        return err;
+    }
+    cave_2d_Polygon layout = {NULL, polygon->ring_offsets, polygon->ring_count};
+    size_t bound = hidden_cave_polytri_tri_bound(&layout);
+    hidden_cave_PolyTri_Out out = {malloc(sizeof(cave_Index_Triangle) * bound), bound, 0, 0, 0, NULL, NULL,
+                                   CAVE_NO_ERROR};
+    if(!out.tris) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    hidden_cave_PolyTri_Scratch scratch;
+    memset(&scratch, 0, sizeof(scratch));
+    err = hidden_cave_polytri_ear_clip_3d(&scratch, polygon, &out);
+    hidden_cave_polytri_release(&scratch);
+    if(err != CAVE_NO_ERROR || out.count == 0) {
+        free(out.tris);
+        return err;
+    }
+    *dest = out.tris;
+    *tri_count = out.count;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_polytri_triangulate_3d_to_sink(cave_PolyTri_Sink* sink, cave_3d_Polygon const* polygon,
+                                              cave_PolyTri_Arena* arena) {
+    cave_Index_Triangle batch[CAVE_POLYTRI_SINK_BATCH];
+    hidden_cave_PolyTri_Out out;
+    CaveError err = hidden_cave_polytri_sink_start(sink, &out, batch);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    err = hidden_cave_polytri_validate_polygon_3d(polygon);
+    if(err == CAVE_NO_ERROR && polygon->ring_count > 0) {
+        size_t mark = arena ? arena->used : 0;
+        hidden_cave_PolyTri_Scratch scratch;
+        memset(&scratch, 0, sizeof(scratch));
+        scratch.arena = arena;
+        err = hidden_cave_polytri_ear_clip_3d(&scratch, polygon, &out);
+        hidden_cave_polytri_release(&scratch);
+        if(arena) {
+            arena->used = mark;
+        }
+    }
+    return hidden_cave_polytri_sink_finish(sink, &out, err);
+}
@@ -0,0 +1,164 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-polytri.h"
+#include "cave-polytri-internal.h"
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+
+//Every polygon is given a slot in the output big enough for the most triangles it could produce, so threads
+//write straight into the output without coordinating. Once all are done the slots are closed up in order,
+//which is a single pass of memmove over the triangles. Polygons in 2D and planar ones in 3D share all of this,
+//and only differ in how each polygon is clipped.
+
+typedef struct hidden_cave_PolyTri_Batch {
+    cave_2d_Polygon const* rings; //exactly one of these two is set
+    cave_3d_Polygon const* rings_3d;
+    size_t const* polygon_rings;
+    size_t const* slots; //where each polygon's triangles are written, polygon_count + 1 of them
+    size_t* counts; //how many each polygon wrote
+    cave_Index_Triangle* tris;
+    hidden_cave_PolyTri_Scratch* scratch; //one per worker
+} hidden_cave_PolyTri_Batch;
+
+static CaveError hidden_cave_polytri_batch_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    hidden_cave_PolyTri_Batch const* batch = arg;
+    for(size_t i = begin; i < end; i++) {
+        size_t first = batch->polygon_rings[i];
+        size_t ring_count = batch->polygon_rings[i + 1] - first;
+        batch->counts[i] = 0;
+        if(ring_count == 0) {
+            continue;
+        }
+        CaveError err;
+        hidden_cave_PolyTri_Out out = {batch->tris + batch->slots[i], batch->slots[i + 1] - batch->slots[i],
+                                       0, 0, 0, NULL, NULL, CAVE_NO_ERROR};
+        if(batch->rings_3d) {
+            cave_3d_Polygon polygon = {batch->rings_3d->points, batch->rings_3d->ring_offsets + first, ring_count};
+            err = hidden_cave_polytri_validate_polygon_3d(&polygon);
+            if(err == CAVE_NO_ERROR) {
+                err = hidden_cave_polytri_ear_clip_3d(batch->scratch + worker, &polygon, &out);
+            }
+        } else {
+            cave_2d_Polygon polygon = {batch->rings->points, batch->rings->ring_offsets + first, ring_count};
+            size_t const* offsets = polygon.ring_offsets;
+            err = hidden_cave_polytri_validate_points(polygon.points ? polygon.points + offsets[0] : NULL,
+                                                      offsets[ring_count] - offsets[0]);
+            if(err == CAVE_NO_ERROR) {
+                err = hidden_cave_polytri_ear_clip(batch->scratch + worker, &polygon, &out);
+            }
+        }
+        batch->counts[i] = out.count;
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+//triangulates the polygons `batch` is set up with, whose rings are laid out by `ring_offsets`
+static CaveError hidden_cave_polytri_run_batch(cave_Index_Triangle** dest, size_t** tri_offsets,
+                                               hidden_cave_PolyTri_Batch* batch, size_t const* ring_offsets,
+                                               size_t ring_count, size_t polygon_count,
+                                               cave_PolyTri_Batch_Options const* options) {
+    *dest = NULL;
+    *tri_offsets = NULL;
+    cave_PolyTri_Batch_Options opts = {0, 0};
+    if(options) {
+        opts = *options;
+    }
+    if(opts.threads == 0) { opts.threads = cave_thread_hardware_count(); }
+    if(opts.chunk_points == 0) { opts.chunk_points = CAVE_POLYTRI_BATCH_DEFAULT_CHUNK_POINTS; }
+
+    //checking the offsets up front, while laying out the slots, leaves the workers only the points to check
+    size_t const* polygon_rings = batch->polygon_rings;
+    size_t* slots = malloc(sizeof(size_t) * (polygon_count + 1));
+    if(!slots) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    size_t const* offsets = ring_offsets;
+    size_t total_points = 0;
+    slots[0] = 0;
+    for(size_t i = 0; i < polygon_count; i++) {
+        size_t first = polygon_rings[i], last = polygon_rings[i + 1];
+        bool valid = first <= last && last <= ring_count;
+        for(size_t r = first; valid && r < last; r++) {
+            valid = offsets[r] <= offsets[r + 1];
+        }
+        if(!valid) {
+            free(slots);
+            return CAVE_DATA_ERROR;
+        }
+        cave_2d_Polygon layout = {NULL, (size_t*) ring_offsets + first, last - first};
+        slots[i + 1] = slots[i] + hidden_cave_polytri_tri_bound(&layout);
+        total_points += last > first ? offsets[last] - offsets[first] : 0;
+    }
+
+    batch->slots = slots;
+    size_t grain = total_points > 0 ? (size_t) ((double) opts.chunk_points * polygon_count / total_points) : 1;
+    grain = grain > 0 ? grain : 1;
+    size_t chunks = (polygon_count + grain - 1) / grain;
+    size_t workers = opts.threads < chunks ? opts.threads : (chunks > 0 ? chunks : 1);
+    batch->counts = malloc(sizeof(size_t) * (polygon_count > 0 ? polygon_count : 1));
+    batch->tris = malloc(sizeof(cave_Index_Triangle) * (slots[polygon_count] > 0 ? slots[polygon_count] : 1));
+    batch->scratch = calloc(workers, sizeof(hidden_cave_PolyTri_Scratch));
+    CaveError err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    if(batch->counts && batch->tris && batch->scratch) {
+        err = cave_parallel_for(polygon_count, grain, workers, hidden_cave_polytri_batch_chunk, batch);
+    }
+    for(size_t w = 0; batch->scratch && w < workers; w++) {
+        hidden_cave_polytri_release(batch->scratch + w);
+    }
+    free(batch->scratch);
+    if(err != CAVE_NO_ERROR) {
+        free(slots);
+        free(batch->counts);
+        free(batch->tris);
+        return err;
+    }
+
+    //close up the slots, reusing them as the offsets handed back
+    size_t tri_count = 0;
+    for(size_t i = 0; i < polygon_count; i++) {
+        if(tri_count != slots[i]) {
+            memmove(batch->tris + tri_count, batch->tris + slots[i],
+                    sizeof(cave_Index_Triangle) * batch->counts[i]);
+        }
+        slots[i] = tri_count;
+        tri_count += batch->counts[i];
+    }
+    slots[polygon_count] = tri_count;
+    free(batch->counts);
+    if(tri_count == 0) {
+        free(batch->tris);
+    } else {
+        cave_Index_Triangle* fitted = realloc(batch->tris, sizeof(cave_Index_Triangle) * tri_count);
+        *dest = fitted ? fitted : batch->tris;
+    }
+    *tri_offsets = slots;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_polytri_triangulate_batch(cave_Index_Triangle** dest, size_t** tri_offsets,
+                                         cave_2d_Polygon const* rings, size_t const* polygon_rings,
+                                         size_t polygon_count, cave_PolyTri_Batch_Options const* options) {
+    if(!dest || !tri_offsets || !rings || !polygon_rings || (rings->ring_count != 0 && !rings->ring_offsets)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_PolyTri_Batch batch = {rings, NULL, polygon_rings, NULL, NULL, NULL, NULL};
+    return hidden_cave_polytri_run_batch(dest, tri_offsets, &batch, rings->ring_offsets, rings->ring_count,
+                                         polygon_count, options);
+}
+
+CaveError cave_polytri_triangulate_3d_batch(cave_Index_Triangle** dest, size_t** tri_offsets,
+                                            cave_3d_Polygon const* rings, size_t const* face_rings,
+                                            size_t face_count, cave_PolyTri_Batch_Options const* options) {
+    if(!dest || !tri_offsets || !rings || !face_rings || (rings->ring_count != 0 && !rings->ring_offsets)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_PolyTri_Batch batch = {NULL, rings, face_rings, NULL, NULL, NULL, NULL};
+    return hidden_cave_polytri_run_batch(dest, tri_offsets, &batch, rings->ring_offsets, rings->ring_count,
+                                         face_count, options);
+}
@@ -0,0 +1,766 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-polytri.h"
+#include "cave-polytri-internal.h"
+#include "cave-predicates-internal.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+//Constrained Delaunay triangulation by incremental insertion, after Lawson and Sloan.
+//Points go into a triangle around all of them one at a time, in Hilbert curve order, so the walk to the
+//triangle holding each new point starts from the one holding the last and is usually a few steps long.
+//Each new point splits its triangle, and edges that fail the circle test are flipped until none do.
+//Constraint edges are added afterwards: the edges crossing one are flipped out of its way (Sloan's method),
+//and the edges that made are flipped back towards Delaunay, leaving the constraint alone.
+//
+//Triangles are kept counter-clockwise. Neighbour `i` of a triangle is across the edge opposite vertex `i`,
+//and bit `i` of `constrained` marks that edge as a constraint.
+
+#define CAVE_CDT_NIL (UINT32_MAX)
+
+typedef struct hidden_cave_CDT_Tri {
+    uint32_t v[3];
+    uint32_t nb[3];
+    uint8_t constrained;
+} hidden_cave_CDT_Tri;
+
+typedef struct hidden_cave_CDT_Edge {
+    uint32_t a;
+    uint32_t b;
+} hidden_cave_CDT_Edge;
+
+typedef struct hidden_cave_CDT {
+    uint32_t point_count; //vertexes past this are corners of the outer triangle
+    double* xy; //vertex coordinates, the caller's points and then the three corners of the outer triangle
+    uint32_t vert_count;
+    uint32_t* vtri; //a triangle touching each vertex
+    hidden_cave_CDT_Tri* tris;
+    uint32_t tri_count;
+    uint32_t last; //where the last walk ended, and so where the next begins
+    uint32_t seed;
+    //edges waiting for the circle test, as (triangle, vertex opposite the edge)
+    uint32_t* flips;
+    size_t flip_len;
+    size_t flip_cap;
+    //edges crossing a constraint, waiting to be flipped away, as a ring buffer
+    hidden_cave_CDT_Edge* crossing;
+    size_t crossing_cap;
+    hidden_cave_CDT_Edge* made; //edges made while inserting a constraint
+    size_t made_len;
+    size_t made_cap;
+} hidden_cave_CDT;
+
+#define T(idx) (cdt->tris + (idx))
+#define NEXT3(i) ((i) == 2 ? 0 : (i) + 1)
+#define PREV3(i) ((i) == 0 ? 2 : (i) - 1)
+
+//positive when (a, b, c) turn counter-clockwise, negative when clockwise, and exactly 0 when collinear
+static double hidden_cave_cdt_orient(hidden_cave_CDT const* cdt, uint32_t a, uint32_t b, uint32_t c) {
+    return hidden_cave_orient2d(cdt->xy + 2 * (size_t) a, cdt->xy + 2 * (size_t) b, cdt->xy + 2 * (size_t) c);
+}
+
+//positive when `d` is inside the circle through the counter-clockwise triangle (a, b, c)
+static double hidden_cave_cdt_incircle(hidden_cave_CDT const* cdt, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    return hidden_cave_incircle(cdt->xy + 2 * (size_t) a, cdt->xy + 2 * (size_t) b, cdt->xy + 2 * (size_t) c,
+                                cdt->xy + 2 * (size_t) d);
+}
+
+static void hidden_cave_cdt_set(hidden_cave_CDT* cdt, uint32_t t, uint32_t a, uint32_t b, uint32_t c,
+                                uint32_t na, uint32_t nb, uint32_t nc, uint8_t constrained) {
+    hidden_cave_CDT_Tri* tri = T(t);
+    tri->v[0] = a;
+    tri->v[1] = b;
+    tri->v[2] = c;
+    tri->nb[0] = na;
+    tri->nb[1] = nb;
+    tri->nb[2] = nc;
+    tri->constrained = constrained;
+    cdt->vtri[a] = t;
+    cdt->vtri[b] = t;
+    cdt->vtri[c] = t;
+}
+
+//the index in `t` of the vertex that is neither `a` nor `b`, ie of the edge (a, b)
+static int hidden_cave_cdt_opposite(hidden_cave_CDT const* cdt, uint32_t t, uint32_t a, uint32_t b) {
+    hidden_cave_CDT_Tri const* tri = T(t);
+    for(int i = 0; i < 2; i++) {
+        if(tri->v[i] != a && tri->v[i] != b) {
+            return i;
+        }
+    }
+    return 2;
+}
+
+//points the neighbour across (a, b), if there is one, back at `t`
+static void hidden_cave_cdt_relink(hidden_cave_CDT* cdt, uint32_t neighbour, uint32_t a, uint32_t b, uint32_t t) {
+    if(neighbour != CAVE_CDT_NIL) {
+        T(neighbour)->nb[hidden_cave_cdt_opposite(cdt, neighbour, a, b)] = t;
+    }
+}
+
+static uint8_t hidden_cave_cdt_flag(hidden_cave_CDT_Tri const* tri, int i, int to) {
+    return (uint8_t) (((tri->constrained >> i) & 1) << to);
+}
+
+static CaveError hidden_cave_cdt_push_flip(hidden_cave_CDT* cdt, uint32_t t, uint32_t i) {
+    if(cdt->flip_len + 2 > cdt->flip_cap) {
+        size_t cap = cdt->flip_cap * 2 + 64;
+        uint32_t* flips = realloc(cdt->flips, sizeof(uint32_t) * cap);
+        if(!flips) {
+            return CAVE_INSUFFICIENT_MEMORY_ERROR;
+        }
+        cdt->flips = flips;
+        cdt->flip_cap = cap;
+    }
+    cdt->flips[cdt->flip_len++] = t;
+    cdt->flips[cdt->flip_len++] = i;
+    return CAVE_NO_ERROR;
+}
+
+//flips the edge opposite vertex `i` of `t`. With `t` as (a, b, c) and the neighbour's far vertex `d`, the
+//triangles become (a, b, d), kept in `t`, and (a, d, c), kept in the neighbour.
+static void hidden_cave_cdt_flip(hidden_cave_CDT* cdt, uint32_t t, int i) {
+    hidden_cave_CDT_Tri ti = *T(t);
+    uint32_t u = ti.nb[i];
+    uint32_t a = ti.v[i], b = ti.v[NEXT3(i)], c = ti.v[PREV3(i)];
+    hidden_cave_CDT_Tri tu = *T(u);
+    int j = hidden_cave_cdt_opposite(cdt, u, b, c);
+    uint32_t d = tu.v[j];
+    //in u, which is (d, c, b) in some rotation, the edge b-d is opposite c and d-c is opposite b
+    int uc = tu.v[NEXT3(j)] == c ? NEXT3(j) : PREV3(j);
+    int ub = tu.v[NEXT3(j)] == b ? NEXT3(j) : PREV3(j);
+    uint32_t across_bd = tu.nb[uc], across_dc = tu.nb[ub];
+    uint32_t across_ab = ti.nb[PREV3(i)], across_ca = ti.nb[NEXT3(i)];
+    hidden_cave_cdt_set(cdt, t, a, b, d, across_bd, u, across_ab,
+                        (uint8_t) (hidden_cave_cdt_flag(&tu, uc, 0) | hidden_cave_cdt_flag(&ti, PREV3(i), 2)));
+    hidden_cave_cdt_set(cdt, u, a, d, c, across_dc, across_ca, t,
+                        (uint8_t) (hidden_cave_cdt_flag(&tu, ub, 0) | hidden_cave_cdt_flag(&ti, NEXT3(i), 1)));
+    hidden_cave_cdt_relink(cdt, across_bd, b, d, t);
+    hidden_cave_cdt_relink(cdt, across_ca, c, a, u);
+}
+
+//flips every edge waiting for the circle test that fails it, and the edges that flipping exposes, until the
+//triangulation is Delaunay again outside of the constraints
+static CaveError hidden_cave_cdt_legalize(hidden_cave_CDT* cdt) {
+    while(cdt->flip_len > 0) {
+        cdt->flip_len -= 2;
+        uint32_t t = cdt->flips[cdt->flip_len];
+        int i = (int) cdt->flips[cdt->flip_len + 1];
+        hidden_cave_CDT_Tri const* tri = T(t);
+        uint32_t u = tri->nb[i];
+        if(u == CAVE_CDT_NIL || (tri->constrained >> i) & 1) {
+            continue;
+        }
+        uint32_t d = T(u)->v[hidden_cave_cdt_opposite(cdt, u, tri->v[NEXT3(i)], tri->v[PREV3(i)])];
+        if(hidden_cave_cdt_incircle(cdt, tri->v[0], tri->v[1], tri->v[2], d) <= 0) {
+            continue;
+        }
+        hidden_cave_cdt_flip(cdt, t, i);
+        //the two edges beyond `d` are the ones that might now fail
+        CaveError err = hidden_cave_cdt_push_flip(cdt, t, 0);
+        if(err == CAVE_NO_ERROR) {
+            err = hidden_cave_cdt_push_flip(cdt, u, 0);
+        }
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+//finds the triangle holding vertex `p`, walking from the last one found. The walk steps across an edge with
+//`p` on the far side, trying the edges from a random one each time so it can't circle forever.
+static uint32_t hidden_cave_cdt_locate(hidden_cave_CDT* cdt, uint32_t p) {
+    uint32_t t = cdt->last;
+    for(size_t steps = 0; steps < 4 * (size_t) cdt->tri_count + 64; steps++) {
+        cdt->seed ^= cdt->seed << 13;
+        cdt->seed ^= cdt->seed >> 17;
+        cdt->seed ^= cdt->seed << 5;
+        int r = (int) (cdt->seed % 3);
+        hidden_cave_CDT_Tri const* tri = T(t);
+        uint32_t next = CAVE_CDT_NIL;
+        for(int k = 0; k < 3 && next == CAVE_CDT_NIL; k++) {
+            int i = (r + k) % 3;
+            if(tri->nb[i] != CAVE_CDT_NIL && hidden_cave_cdt_orient(cdt, tri->v[NEXT3(i)], tri->v[PREV3(i)], p) < 0) {
+                next = tri->nb[i];
+            }
+        }
+        if(next == CAVE_CDT_NIL) {
+            return t;
+        }
+        t = next;
+    }
+    //with exact predicates the walk always gets there, but should it take this long, look everywhere instead
+    for(t = 0; t < cdt->tri_count; t++) {
+        hidden_cave_CDT_Tri const* tri = T(t);
+        if(hidden_cave_cdt_orient(cdt, tri->v[0], tri->v[1], p) >= 0 &&
+           hidden_cave_cdt_orient(cdt, tri->v[1], tri->v[2], p) >= 0 &&
+           hidden_cave_cdt_orient(cdt, tri->v[2], tri->v[0], p) >= 0) {
+            return t;
+        }
+    }
+    return cdt->last;
+}
+
+//adds vertex `p`, returning the vertex already there if `p` repeats one
+static uint32_t hidden_cave_cdt_insert(hidden_cave_CDT* cdt, uint32_t p, CaveError* err) {
+    uint32_t t = hidden_cave_cdt_locate(cdt, p);
+    cdt->last = t;
+    hidden_cave_CDT_Tri ti = *T(t);
+    double const* pp = cdt->xy + 2 * (size_t) p;
+    int on_edge = -1;
+    for(int i = 0; i < 3; i++) {
+        double const* pv = cdt->xy + 2 * (size_t) ti.v[i];
+        if(pv[0] == pp[0] && pv[1] == pp[1]) {
+            return ti.v[i];
+        }
+        if(hidden_cave_cdt_orient(cdt, ti.v[NEXT3(i)], ti.v[PREV3(i)], p) == 0 && ti.nb[i] != CAVE_CDT_NIL) {
+            on_edge = i;
+        }
+    }
+    uint32_t a = ti.v[0], b = ti.v[1], c = ti.v[2];
+    if(on_edge < 0) {
+        //split into (p, b, c), (p, c, a) and (p, a, b)
+        uint32_t t1 = cdt->tri_count, t2 = cdt->tri_count + 1;
+        cdt->tri_count += 2;
+        hidden_cave_cdt_set(cdt, t, p, b, c, ti.nb[0], t1, t2, hidden_cave_cdt_flag(&ti, 0, 0));
+        hidden_cave_cdt_set(cdt, t1, p, c, a, ti.nb[1], t2, t, hidden_cave_cdt_flag(&ti, 1, 0));
+        hidden_cave_cdt_set(cdt, t2, p, a, b, ti.nb[2], t, t1, hidden_cave_cdt_flag(&ti, 2, 0));
+        hidden_cave_cdt_relink(cdt, ti.nb[1], c, a, t1);
+        hidden_cave_cdt_relink(cdt, ti.nb[2], a, b, t2);
+        *err = hidden_cave_cdt_push_flip(cdt, t, 0);
+        if(*err == CAVE_NO_ERROR) {
+            *err = hidden_cave_cdt_push_flip(cdt, t1, 0);
+        }
+        if(*err == CAVE_NO_ERROR) {
+            *err = hidden_cave_cdt_push_flip(cdt, t2, 0);
+        }
+    } else {
+        //split the edge, and with it both triangles either side of it
+        int i = on_edge;
+        a = ti.v[i];
+        b = ti.v[NEXT3(i)];
+        c = ti.v[PREV3(i)];
+        uint32_t u = ti.nb[i];
+        hidden_cave_CDT_Tri tu = *T(u);
+        int j = hidden_cave_cdt_opposite(cdt, u, b, c);
+        uint32_t d = tu.v[j];
+        int uc = tu.v[NEXT3(j)] == c ? NEXT3(j) : PREV3(j);
+        int ub = tu.v[NEXT3(j)] == b ? NEXT3(j) : PREV3(j);
+        uint32_t t2 = cdt->tri_count, u2 = cdt->tri_count + 1;
+        cdt->tri_count += 2;
+        //(a, b, p) and (a, p, c) on this side, (d, c, p) and (d, p, b) on the other
+        uint8_t split = hidden_cave_cdt_flag(&ti, i, 0);
+        hidden_cave_cdt_set(cdt, t, a, b, p, u2, t2, ti.nb[PREV3(i)],
+                            (uint8_t) (split | hidden_cave_cdt_flag(&ti, PREV3(i), 2)));
+        hidden_cave_cdt_set(cdt, t2, a, p, c, u, ti.nb[NEXT3(i)], t,
+                            (uint8_t) (split | hidden_cave_cdt_flag(&ti, NEXT3(i), 1)));
+        hidden_cave_cdt_set(cdt, u, d, c, p, t2, u2, tu.nb[ub],
+                            (uint8_t) (split | hidden_cave_cdt_flag(&tu, ub, 2)));
+        hidden_cave_cdt_set(cdt, u2, d, p, b, t, tu.nb[uc], u,
+                            (uint8_t) (split | hidden_cave_cdt_flag(&tu, uc, 1)));
+        hidden_cave_cdt_relink(cdt, ti.nb[NEXT3(i)], c, a, t2);
+        hidden_cave_cdt_relink(cdt, tu.nb[uc], b, d, u2);
+        *err = hidden_cave_cdt_push_flip(cdt, t, 2);
+        if(*err == CAVE_NO_ERROR) {
+            *err = hidden_cave_cdt_push_flip(cdt, t2, 1);
+        }
+        if(*err == CAVE_NO_ERROR) {
+            *err = hidden_cave_cdt_push_flip(cdt, u, 2);
+        }
+        if(*err == CAVE_NO_ERROR) {
+            *err = hidden_cave_cdt_push_flip(cdt, u2, 1);
+        }
+    }
+    if(*err == CAVE_NO_ERROR) {
+        *err = hidden_cave_cdt_legalize(cdt);
+    }
+    return p;
+}
+
+//finds the triangle holding the edge (p, q), setting `*i` to the vertex opposite it. Returns NIL if there is
+//no such edge. `p` mustn't be a corner of the outer triangle, whose triangles don't close around it.
+static uint32_t hidden_cave_cdt_find_edge(hidden_cave_CDT const* cdt, uint32_t p, uint32_t q, int* i) {
+    uint32_t start = cdt->vtri[p], t = start;
+    do {
+        hidden_cave_CDT_Tri const* tri = T(t);
+        int k = tri->v[0] == p ? 0 : tri->v[1] == p ? 1 : 2;
+        if(tri->v[NEXT3(k)] == q) {
+            *i = PREV3(k);
+            return t;
+        }
+        if(tri->v[PREV3(k)] == q) {
+            *i = NEXT3(k);
+            return t;
+        }
+        t = tri->nb[NEXT3(k)];
+    } while(t != start && t != CAVE_CDT_NIL);
+    return CAVE_CDT_NIL;
+}
+
+static void hidden_cave_cdt_mark(hidden_cave_CDT* cdt, uint32_t t, int i) {
+    hidden_cave_CDT_Tri* tri = T(t);
+    tri->constrained |= (uint8_t) (1 << i);
+    uint32_t u = tri->nb[i];
+    if(u != CAVE_CDT_NIL) {
+        T(u)->constrained |= (uint8_t) (1 << hidden_cave_cdt_opposite(cdt, u, tri->v[NEXT3(i)], tri->v[PREV3(i)]));
+    }
+}
+
+static bool hidden_cave_cdt_ahead(hidden_cave_CDT const* cdt, uint32_t a, uint32_t b, uint32_t p) {
+    double const* pa = cdt->xy + 2 * (size_t) a;
+    double const* pb = cdt->xy + 2 * (size_t) b;
+    double const* pp = cdt->xy + 2 * (size_t) p;
+    return (pp[0] - pa[0]) * (pb[0] - pa[0]) + (pp[1] - pa[1]) * (pb[1] - pa[1]) > 0;
+}
+
+//like `hidden_cave_cdt_find_edge()`, for an edge that may have one end on the outer triangle
+static uint32_t hidden_cave_cdt_find_any_edge(hidden_cave_CDT const* cdt, uint32_t p, uint32_t q, int* i) {
+    return p < cdt->point_count ? hidden_cave_cdt_find_edge(cdt, p, q, i) : hidden_cave_cdt_find_edge(cdt, q, p, i);
+}
+
+static bool hidden_cave_cdt_grow(void** buffer, size_t* cap, size_t need, size_t size) {
+    if(need <= *cap) {
+        return true;
+    }
+    size_t grown = *cap * 2 > need ? *cap * 2 : need;
+    void* bigger = realloc(*buffer, grown * size);
+    if(!bigger) {
+        return false;
+    }
+    *buffer = bigger;
+    *cap = grown;
+    return true;
+}
+
+//flips the `count` edges crossing the segment from `a` to `b`, which are at the start of `crossing`, until
+//none do. An edge that can't be flipped yet, as its quadrilateral isn't convex, goes to the back of the queue.
+static CaveError hidden_cave_cdt_flip_crossings(hidden_cave_CDT* cdt, uint32_t a, uint32_t b, size_t count) {
+    size_t head = 0, len = count, cap = cdt->crossing_cap;
+    //Sloan shows each lap of the queue flips at least one edge, which is what this bounds
+    size_t budget = count * count + 64;
+    cdt->made_len = 0;
+    while(len > 0) {
+        if(budget-- == 0) {
+            return CAVE_DATA_ERROR;
+        }
+        hidden_cave_CDT_Edge e = cdt->crossing[head];
+        head = head + 1 == cap ? 0 : head + 1;
+        len--;
+        int i;
+        uint32_t t = hidden_cave_cdt_find_any_edge(cdt, e.a, e.b, &i);
+        if(t == CAVE_CDT_NIL) {
+            return CAVE_DATA_ERROR;
+        }
+        hidden_cave_CDT_Tri const* tri = T(t);
+        uint32_t r = tri->v[i];
+        uint32_t u = tri->nb[i];
+        uint32_t s = T(u)->v[hidden_cave_cdt_opposite(cdt, u, tri->v[NEXT3(i)], tri->v[PREV3(i)])];
+        double op = hidden_cave_cdt_orient(cdt, r, s, e.a), oq = hidden_cave_cdt_orient(cdt, r, s, e.b);
+        if((op > 0 && oq < 0) || (op < 0 && oq > 0)) {
+            hidden_cave_cdt_flip(cdt, t, i);
+            double orr = hidden_cave_cdt_orient(cdt, a, b, r), os = hidden_cave_cdt_orient(cdt, a, b, s);
+            e = (hidden_cave_CDT_Edge) {r, s};
+            if((orr > 0 && os < 0) || (orr < 0 && os > 0)) {
+                cdt->crossing[(head + len) % cap] = e;
+                len++;
+            } else {
+                if(!hidden_cave_cdt_grow((void**) &cdt->made, &cdt->made_cap, cdt->made_len + 1,
+                                         sizeof(hidden_cave_CDT_Edge))) {
+                    return CAVE_INSUFFICIENT_MEMORY_ERROR;
+                }
+                cdt->made[cdt->made_len++] = e;
+            }
+        } else {
+            cdt->crossing[(head + len) % cap] = e;
+            len++;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+//makes (a, b) an edge and marks it as a constraint. Fails with `CAVE_DATA_ERROR` if it would cross another
+//constraint.
+static CaveError hidden_cave_cdt_constrain(hidden_cave_CDT* cdt, uint32_t a, uint32_t b) {
+    while(a != b) {
+        int i;
+        uint32_t t = hidden_cave_cdt_find_edge(cdt, a, b, &i);
+        if(t != CAVE_CDT_NIL) {
+            hidden_cave_cdt_mark(cdt, t, i);
+            return CAVE_NO_ERROR;
+        }
+
+        //find the triangle the segment leaves `a` through, or a vertex it runs into on the way
+        uint32_t start = cdt->vtri[a];
+        uint32_t right = CAVE_CDT_NIL, left = CAVE_CDT_NIL, through = CAVE_CDT_NIL;
+        t = start;
+        do {
+            hidden_cave_CDT_Tri const* tri = T(t);
+            int k = tri->v[0] == a ? 0 : tri->v[1] == a ? 1 : 2;
+            uint32_t p = tri->v[NEXT3(k)], q = tri->v[PREV3(k)];
+            double op = hidden_cave_cdt_orient(cdt, a, p, b), oq = hidden_cave_cdt_orient(cdt, a, q, b);
+            if(op == 0 && hidden_cave_cdt_ahead(cdt, a, b, p)) {
+                through = p;
+                break;
+            }
+            if(oq == 0 && hidden_cave_cdt_ahead(cdt, a, b, q)) {
+                through = q;
+                break;
+            }
+            if(op > 0 && oq < 0) {
+                right = p;
+                left = q;
+                break;
+            }
+            t = tri->nb[NEXT3(k)];
+        } while(t != start && t != CAVE_CDT_NIL);
+        if(through != CAVE_CDT_NIL) {
+            t = hidden_cave_cdt_find_edge(cdt, a, through, &i);
+            hidden_cave_cdt_mark(cdt, t, i);
+            a = through;
+            continue;
+        }
+        if(right == CAVE_CDT_NIL) {
+            return CAVE_DATA_ERROR;
+        }
+
+        //list the edges the segment crosses, stopping early at a vertex it passes through
+        uint32_t end = b;
+        size_t count = 0;
+        while(true) {
+            int e = hidden_cave_cdt_opposite(cdt, t, right, left);
+            if((T(t)->constrained >> e) & 1) {
+                return CAVE_DATA_ERROR;
+            }
+            if(!hidden_cave_cdt_grow((void**) &cdt->crossing, &cdt->crossing_cap, count + 1,
+                                     sizeof(hidden_cave_CDT_Edge))) {
+                return CAVE_INSUFFICIENT_MEMORY_ERROR;
+            }
+            cdt->crossing[count++] = (hidden_cave_CDT_Edge) {right, left};
+            uint32_t u = T(t)->nb[e];
+            uint32_t r = T(u)->v[hidden_cave_cdt_opposite(cdt, u, right, left)];
+            if(r == b) {
+                break;
+            }
+            double o = hidden_cave_cdt_orient(cdt, a, b, r);
+            if(o == 0) {
+                end = r;
+                break;
+            }
+            if(o > 0) {
+                left = r;
+            } else {
+                right = r;
+            }
+            t = u;
+        }
+
+        CaveError err = hidden_cave_cdt_flip_crossings(cdt, a, end, count);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+        t = hidden_cave_cdt_find_edge(cdt, a, end, &i);
+        if(t == CAVE_CDT_NIL) {
+            return CAVE_DATA_ERROR;
+        }
+        hidden_cave_cdt_mark(cdt, t, i);
+        //the edges made along the way can now be flipped back towards Delaunay, on their own side
+        for(size_t m = 0; m < cdt->made_len && err == CAVE_NO_ERROR; m++) {
+            t = hidden_cave_cdt_find_any_edge(cdt, cdt->made[m].a, cdt->made[m].b, &i);
+            if(t != CAVE_CDT_NIL) {
+                err = hidden_cave_cdt_push_flip(cdt, t, (uint32_t) i);
+            }
+        }
+        if(err == CAVE_NO_ERROR) {
+            err = hidden_cave_cdt_legalize(cdt);
+        }
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+        a = end;
+    }
+    return CAVE_NO_ERROR;
+}
+
+//the distance along a Hilbert curve filling a 2^16 by 2^16 grid
+static uint32_t hidden_cave_hilbert(uint32_t x, uint32_t y) {
+    uint32_t d = 0;
+    for(uint32_t s = 1u << 15; s > 0; s >>= 1) {
+        uint32_t rx = (x & s) > 0, ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if(ry == 0) {
+            if(rx == 1) {
+                x = 0xFFFFu - x;
+                y = 0xFFFFu - y;
+            }
+            uint32_t swap = x;
+            x = y;
+            y = swap;
+        }
+    }
+    return d;
+}
+
+typedef struct hidden_cave_CDT_Key {
+    uint32_t key;
+    uint32_t point;
+} hidden_cave_CDT_Key;
+
+//sorts by key with a four pass radix sort on bytes, leaving the result in `keys`
+static void hidden_cave_cdt_sort_keys(hidden_cave_CDT_Key* keys, hidden_cave_CDT_Key* scratch, size_t count) {
+    for(int shift = 0; shift < 32; shift += 8) {
+        size_t starts[257] = {0};
+        for(size_t i = 0; i < count; i++) {
+            starts[((keys[i].key >> shift) & 0xFF) + 1]++;
+        }
+        for(int b = 0; b < 256; b++) {
+            starts[b + 1] += starts[b];
+        }
+        for(size_t i = 0; i < count; i++) {
+            scratch[starts[(keys[i].key >> shift) & 0xFF]++] = keys[i];
+        }
+        hidden_cave_CDT_Key* swap = keys;
+        keys = scratch;
+        scratch = swap;
+    }
+}
+
+//inserts the points, in Hilbert order, into a triangle around them all. Sets `remap[i]` to the vertex point
+//`i` became, which is an earlier point if it repeats one.
+static CaveError hidden_cave_cdt_insert_points(hidden_cave_CDT* cdt, cave_2Point const* points, uint32_t* remap) {
+    uint32_t n = cdt->point_count;
+    double min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+    for(uint32_t i = 0; i < n; i++) {
+        cdt->xy[2 * (size_t) i] = points[i].x;
+        cdt->xy[2 * (size_t) i + 1] = points[i].y;
+        min_x = fmin(min_x, points[i].x);
+        min_y = fmin(min_y, points[i].y);
+        max_x = fmax(max_x, points[i].x);
+        max_y = fmax(max_y, points[i].y);
+    }
+    double size = fmax(max_x - min_x, max_y - min_y);
+    size = size > 0 ? size : 1.0;
+    double cx = (min_x + max_x) / 2, cy = (min_y + max_y) / 2;
+    //far enough out that only the circles of very thin triangles along the hull reach it
+    double* corners = cdt->xy + 2 * (size_t) n;
+    corners[0] = cx - 64 * size;
+    corners[1] = cy - 32 * size;
+    corners[2] = cx + 64 * size;
+    corners[3] = cy - 32 * size;
+    corners[4] = cx;
+    corners[5] = cy + 64 * size;
+    cdt->tri_count = 1;
+    hidden_cave_cdt_set(cdt, 0, n, n + 1, n + 2, CAVE_CDT_NIL, CAVE_CDT_NIL, CAVE_CDT_NIL, 0);
+
+    hidden_cave_CDT_Key* keys = malloc(sizeof(hidden_cave_CDT_Key) * 2 * (size_t) n);
+    if(!keys) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    double scale = 65535.0 / size;
+    for(uint32_t i = 0; i < n; i++) {
+        keys[i].key = hidden_cave_hilbert((uint32_t) ((points[i].x - min_x) * scale),
+                                          (uint32_t) ((points[i].y - min_y) * scale));
+        keys[i].point = i;
+    }
+    hidden_cave_cdt_sort_keys(keys, keys + n, n);
+    CaveError err = CAVE_NO_ERROR;
+    for(uint32_t k = 0; k < n && err == CAVE_NO_ERROR; k++) {
+        uint32_t p = keys[k].point;
+        remap[p] = hidden_cave_cdt_insert(cdt, p, &err);
+    }
+    free(keys);
+    return err;
+}
+
+//marks the triangles inside the constraints, as those reached from outside by crossing an odd number of them
+static CaveError hidden_cave_cdt_mark_inside(hidden_cave_CDT const* cdt, uint8_t* inside) {
+    uint32_t* depth = malloc(sizeof(uint32_t) * cdt->tri_count);
+    //a depth's triangles, plus up to three candidates for the next depth from each of them
+    uint32_t* queue = malloc(sizeof(uint32_t) * 4 * (size_t) cdt->tri_count);
+    if(!depth || !queue) {
+        free(depth);
+        free(queue);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(uint32_t t = 0; t < cdt->tri_count; t++) {
+        depth[t] = CAVE_CDT_NIL;
+    }
+    //the queue holds this depth's triangles from the front, and the next depth's candidates from the back
+    size_t head = 0, tail = 0, far = 4 * (size_t) cdt->tri_count, far_end = far;
+    uint32_t seed = cdt->vtri[cdt->point_count];
+    depth[seed] = 0;
+    queue[tail++] = seed;
+    for(uint32_t d = 0; head < tail; d++) {
+        while(head < tail) {
+            hidden_cave_CDT_Tri const* tri = T(queue[head++]);
+            for(int i = 0; i < 3; i++) {
+                uint32_t u = tri->nb[i];
+                if(u == CAVE_CDT_NIL || depth[u] != CAVE_CDT_NIL) {
+                    continue;
+                }
+                if((tri->constrained >> i) & 1) {
+                    queue[--far] = u;
+                } else {
+                    depth[u] = d;
+                    queue[tail++] = u;
+                }
+            }
+        }
+        head = tail = 0;
+        for(size_t k = far; k < far_end; k++) {
+            if(depth[queue[k]] == CAVE_CDT_NIL) {
+                depth[queue[k]] = d + 1;
+                queue[tail++] = queue[k];
+            }
+        }
+        far = far_end;
+    }
+    for(uint32_t t = 0; t < cdt->tri_count; t++) {
+        inside[t] = depth[t] != CAVE_CDT_NIL && (depth[t] & 1);
+    }
+    free(depth);
+    free(queue);
+    return CAVE_NO_ERROR;
+}
+
+static void hidden_cave_cdt_release(hidden_cave_CDT* cdt) {
+    free(cdt->xy);
+    free(cdt->vtri);
+    free(cdt->tris);
+    free(cdt->flips);
+    free(cdt->crossing);
+    free(cdt->made);
+}
+
+static CaveError hidden_cave_cdt_run(hidden_cave_CDT* cdt, cave_2Point const* points, cave_Index_Edge const* edges,
+                                     size_t edge_count, size_t base, bool fill, cave_Index_Triangle** dest,
+                                     size_t* tri_count) {
+    uint32_t n = cdt->point_count;
+    uint32_t* remap = malloc(sizeof(uint32_t) * n);
+    if(!remap) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    CaveError err = hidden_cave_cdt_insert_points(cdt, points, remap);
+    for(size_t e = 0; e < edge_count && err == CAVE_NO_ERROR; e++) {
+        err = hidden_cave_cdt_constrain(cdt, remap[edges[e].a - base], remap[edges[e].b - base]);
+    }
+    free(remap);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    //the triangles with a corner of the outer triangle are outside, whatever the constraints
+    uint8_t* keep = malloc(cdt->tri_count);
+    if(!keep) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(fill) {
+        err = hidden_cave_cdt_mark_inside(cdt, keep);
+    }
+    size_t count = 0;
+    for(uint32_t t = 0; t < cdt->tri_count && err == CAVE_NO_ERROR; t++) {
+        hidden_cave_CDT_Tri const* tri = T(t);
+        if(!fill) {
+            keep[t] = tri->v[0] < n && tri->v[1] < n && tri->v[2] < n;
+        }
+        count += keep[t];
+    }
+    cave_Index_Triangle* out = count > 0 && err == CAVE_NO_ERROR ? malloc(sizeof(cave_Index_Triangle) * count) : NULL;
+    if(count > 0 && !out) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(err == CAVE_NO_ERROR && out) {
+        size_t k = 0;
+        for(uint32_t t = 0; t < cdt->tri_count; t++) {
+            if(keep[t]) {
+                out[k++] = (cave_Index_Triangle) {base + T(t)->v[0], base + T(t)->v[1], base + T(t)->v[2]};
+            }
+        }
+        *dest = out;
+        *tri_count = count;
+    }
+    free(keep);
+    return err;
+}
+
+//triangulates `points[base..base + point_count)` with `edges`, whose indexes count from `points`
+static CaveError hidden_cave_cdt(cave_Index_Triangle** dest, size_t* tri_count, cave_2Point const* points,
+                                 size_t base, size_t point_count, cave_Index_Edge const* edges, size_t edge_count,
+                                 bool fill) {
+    hidden_cave_CDT cdt = {0};
+    cdt.point_count = (uint32_t) point_count;
+    cdt.seed = 0x9E3779B9u;
+    //each point adds two triangles to the one it starts with
+    size_t tri_cap = 2 * point_count + 1;
+    cdt.xy = malloc(sizeof(double) * 2 * (point_count + 3));
+    cdt.vtri = malloc(sizeof(uint32_t) * (point_count + 3));
+    cdt.tris = malloc(sizeof(hidden_cave_CDT_Tri) * tri_cap);
+    CaveError err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    if(cdt.xy && cdt.vtri && cdt.tris) {
+        err = hidden_cave_cdt_run(&cdt, points + base, edges, edge_count, base, fill, dest, tri_count);
+    }
+    hidden_cave_cdt_release(&cdt);
+    return err;
+}
+
+CaveError cave_polytri_triangulate_cdt(cave_Index_Triangle** dest, size_t* tri_count,
+                                       cave_2Point const* points, size_t point_count,
+                                       cave_Index_Edge const* edges, size_t edge_count, bool fill) {
+    if(!dest || !tri_count || (!edges && edge_count != 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    *dest = NULL;
+    *tri_count = 0;
+    CaveError err = hidden_cave_polytri_validate_points(points, point_count);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    for(size_t e = 0; e < edge_count; e++) {
+        if(edges[e].a >= point_count || edges[e].b >= point_count) {
+            return CAVE_INDEX_ERROR;
+        }
+    }
+    if(point_count < 3) {
+        return CAVE_NO_ERROR;
+    }
+    return hidden_cave_cdt(dest, tri_count, points, 0, point_count, edges, edge_count, fill);
+}
+
+CaveError cave_polytri_triangulate_polygon_cdt(cave_Index_Triangle** dest, size_t* tri_count,
+                                               cave_2d_Polygon const* polygon) {
+    if(!dest || !tri_count) {
+        return CAVE_DATA_ERROR;
+    }
+    *dest = NULL;
+    *tri_count = 0;
+    CaveError err = hidden_cave_polytri_validate_polygon(polygon);
+    if(err != CAVE_NO_ERROR || polygon->ring_count == 0) {
+        return err;
+    }
+    size_t const* offsets = polygon->ring_offsets;
+    size_t base = offsets[0], point_count = offsets[polygon->ring_count] - base;
+    if(point_count < 3) {
+        return CAVE_NO_ERROR;
+    }
+    //every ring is a loop of constraints
+    cave_Index_Edge* edges = malloc(sizeof(cave_Index_Edge) * point_count);
+    if(!edges) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    size_t edge_count = 0;
+    for(size_t r = 0; r < polygon->ring_count; r++) {
+        size_t start = offsets[r], end = offsets[r + 1];
+        for(size_t i = start; end - start > 1 && i < end; i++) {
+            if(end - start > 2 || i + 1 < end) {
+                edges[edge_count++] = (cave_Index_Edge) {i, i + 1 < end ? i + 1 : start};
+            }
+        }
+    }
+    err = hidden_cave_cdt(dest, tri_count, polygon->points, base, point_count, edges, edge_count, true);
+    free(edges);
+    return err;
+}
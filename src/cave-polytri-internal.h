@@ -0,0 +1,103 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_POLYTRI_INTERNAL_H
+#define CAVE_POLYTRI_INTERNAL_H
+
+#include "cave-polytri.h"
+
+/*
+ * Internal pieces shared between the PolyTri triangulators.
+ */
+
+//the most points a single call will take. Keeps every node index, duplicates and hole
+//bridges included, within 32 bits.
+#define CAVE_POLYTRI_MAX_POINTS ((size_t) 1 << 29)
+
+//checks that `points` is usable input: not NULL unless empty, no more than `CAVE_POLYTRI_MAX_POINTS`,
+//and every coordinate finite. Returns `CAVE_DATA_ERROR` if not.
+CaveError hidden_cave_polytri_validate_points(cave_2Point const* points, size_t point_count);
+
+//checks that `polygon` is usable input: its ring offsets never decrease, and the points they cover pass
+//`hidden_cave_polytri_validate_points()`. Returns `CAVE_DATA_ERROR` if not.
+CaveError hidden_cave_polytri_validate_polygon(cave_2d_Polygon const* polygon);
+
+enum {
+    CAVE_POLYTRI_SCRATCH_NODES,
+    CAVE_POLYTRI_SCRATCH_Z_ENTRIES,
+    CAVE_POLYTRI_SCRATCH_Z_SORTING,
+    CAVE_POLYTRI_SCRATCH_GRID_HEADS,
+    CAVE_POLYTRI_SCRATCH_GRID_ENTRIES,
+    CAVE_POLYTRI_SCRATCH_HOLES,
+    CAVE_POLYTRI_SCRATCH_HOLE_STARTS,
+    CAVE_POLYTRI_SCRATCH_RINGS,
+    CAVE_POLYTRI_SCRATCH_RING_OWNERS,
+    CAVE_POLYTRI_SCRATCH_PROJECTED,
+    CAVE_POLYTRI_SCRATCH_PROJECTED_RINGS,
+    CAVE_POLYTRI_SCRATCH_COUNT,
+};
+
+//Working memory for the ear clipper, kept from one polygon to the next so that triangulating many small
+//polygons doesn't allocate for each of them. Each slot only ever grows. Zero it before first use. Slots come
+//from `arena` if it is set, and from malloc otherwise.
+typedef struct hidden_cave_PolyTri_Scratch {
+    void* buffers[CAVE_POLYTRI_SCRATCH_COUNT];
+    size_t caps[CAVE_POLYTRI_SCRATCH_COUNT];
+    cave_PolyTri_Arena* arena;
+} hidden_cave_PolyTri_Scratch;
+
+//returns slot `slot` of `scratch` with room for at least `bytes` bytes, keeping what it held, or NULL if it
+//can't be grown.
+void* hidden_cave_polytri_reserve(hidden_cave_PolyTri_Scratch* scratch, int slot, size_t bytes);
+
+//frees everything `scratch` holds, leaving it zeroed. Slots from an arena are left to it, and its owner.
+void hidden_cave_polytri_release(hidden_cave_PolyTri_Scratch* scratch);
+
+//Where the ear clipper puts its triangles: into `tris`, which has room for `cap` of them. When that fills,
+//they are handed to `emit`, if set, and `tris` is written over from the start. Without `emit`, triangles past
+//`cap` are only counted. `offset` is added to every index on the way out.
+typedef struct hidden_cave_PolyTri_Out {
+    cave_Index_Triangle* tris;
+    size_t cap;
+    size_t count; //in `tris`, not yet handed on
+    size_t total; //made in all
+    size_t offset;
+    cave_PolyTri_Emit emit;
+    void* user;
+    CaveError err; //the first error `emit` returned, after which nothing more is handed on
+} hidden_cave_PolyTri_Out;
+
+//adds the triangle (a, b, c) to `out`.
+void hidden_cave_polytri_put(hidden_cave_PolyTri_Out* out, size_t a, size_t b, size_t c);
+
+//hands whatever `out` holds to its `emit`, if it has one. Returns the first error `emit` returned.
+CaveError hidden_cave_polytri_flush(hidden_cave_PolyTri_Out* out);
+
+//the most triangles ear clipping `polygon` can produce: at most `n + 2h - 2` for each outline, for `n`
+//points and `h` holes, which is always less than the points plus twice the rings.
+size_t hidden_cave_polytri_tri_bound(cave_2d_Polygon const* polygon);
+
+//sets up `out` to write to `sink`, through `batch`, which has room for `CAVE_POLYTRI_SINK_BATCH` triangles, if
+//the sink has a callback. Returns `CAVE_DATA_ERROR` if `sink` is unusable.
+CaveError hidden_cave_polytri_sink_start(cave_PolyTri_Sink* sink, hidden_cave_PolyTri_Out* out,
+                                         cave_Index_Triangle* batch);
+
+//flushes `out` and reports to `sink` what it got, given `err` from making the triangles. Returns what the
+//`*_to_sink()` functions do.
+CaveError hidden_cave_polytri_sink_finish(cave_PolyTri_Sink* sink, hidden_cave_PolyTri_Out* out, CaveError err);
+
+//ear clips `polygon`, which has to have passed `hidden_cave_polytri_validate_polygon()`, into `out`, without
+//flushing it. Returns `CAVE_INSUFFICIENT_MEMORY_ERROR` if `scratch` can't be grown.
+CaveError hidden_cave_polytri_ear_clip(hidden_cave_PolyTri_Scratch* scratch, cave_2d_Polygon const* polygon,
+                                       hidden_cave_PolyTri_Out* out);
+
+//as `hidden_cave_polytri_validate_polygon()`, for a polygon in 3D.
+CaveError hidden_cave_polytri_validate_polygon_3d(cave_3d_Polygon const* polygon);
+
+//as `hidden_cave_polytri_ear_clip()`, for a planar polygon in 3D that has passed
+//`hidden_cave_polytri_validate_polygon_3d()`. It is projected into `scratch` and clipped there.
+CaveError hidden_cave_polytri_ear_clip_3d(hidden_cave_PolyTri_Scratch* scratch, cave_3d_Polygon const* polygon,
+                                          hidden_cave_PolyTri_Out* out);
+
+#endif //CAVE_POLYTRI_INTERNAL_H
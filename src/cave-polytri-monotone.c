@@ -0,0 +1,617 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-polytri.h"
+#include "cave-polytri-internal.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+//Triangulation by monotone partition, following de Berg et al., "Computational Geometry", chapter 3.
+//A sweep line moves down the polygon, adding diagonals at split and merge vertices so that every piece
+//left is y-monotone. The pieces are then traced out of the polygon and its diagonals, and each is
+//triangulated in linear time with a stack.
+//
+//"Above" is lexicographic, by y and then by smaller x, so that no two vertices are level.
+//Every edge is stored with the vertex it starts from; edge `v` runs from `v` to `next`.
+
+#define CAVE_MONOTONE_NIL (UINT32_MAX)
+
+enum {
+    CAVE_MONOTONE_START,
+    CAVE_MONOTONE_END,
+    CAVE_MONOTONE_SPLIT,
+    CAVE_MONOTONE_MERGE,
+    CAVE_MONOTONE_REGULAR_LEFT, //on the left boundary, with the interior to its right
+    CAVE_MONOTONE_REGULAR_RIGHT,
+};
+
+typedef struct hidden_cave_Sweep_Vertex {
+    double x;
+    double y;
+    uint32_t id; //index of the point in the caller's array
+    uint32_t prev;
+    uint32_t next;
+    uint32_t helper; //of the edge starting here, while it is in the status
+    //the status is a treap of edges, ordered left to right along the sweep line
+    uint32_t left;
+    uint32_t right;
+    uint32_t parent;
+    uint32_t priority;
+    uint8_t type;
+} hidden_cave_Sweep_Vertex;
+
+//an edge leaving a vertex, when tracing out the monotone pieces
+typedef struct hidden_cave_Out_Edge {
+    double angle; //counter-clockwise from the polygon edge leaving the vertex
+    uint32_t to;
+    uint32_t twin; //the diagonal this is one direction of, times two, plus the direction
+    uint8_t kind;
+    bool visited;
+} hidden_cave_Out_Edge;
+
+enum {
+    CAVE_MONOTONE_OUT_NEXT, //the polygon edge leaving the vertex
+    CAVE_MONOTONE_OUT_PREV, //the polygon edge arriving at the vertex, backwards. Never traced, only sorted.
+    CAVE_MONOTONE_OUT_DIAGONAL,
+};
+
+typedef struct hidden_cave_Sweep_Key {
+    double y;
+    double x;
+    uint32_t v;
+} hidden_cave_Sweep_Key;
+
+typedef struct hidden_cave_Monotone {
+    hidden_cave_Sweep_Vertex* verts;
+    uint32_t vert_count;
+    uint32_t root;
+    hidden_cave_Sweep_Key* order; //vertexes from top to bottom
+    uint32_t* diagonals; //pairs of vertexes
+    uint32_t diagonal_count;
+    cave_Index_Triangle* tris;
+    size_t tri_count;
+    size_t tri_cap;
+} hidden_cave_Monotone;
+
+#define V(idx) (m->verts + (idx))
+
+//coincident vertexes are ordered by their place in the array, matching `hidden_cave_compare_sweep_keys`
+static bool hidden_cave_above(hidden_cave_Sweep_Vertex const* a, hidden_cave_Sweep_Vertex const* b) {
+    if(a->y != b->y) {
+        return a->y > b->y;
+    }
+    return a->x != b->x ? a->x < b->x : a < b;
+}
+
+//twice the signed area of (a, b, c), positive when they turn counter-clockwise
+static double hidden_cave_cross(hidden_cave_Sweep_Vertex const* a, hidden_cave_Sweep_Vertex const* b,
+                                hidden_cave_Sweep_Vertex const* c) {
+    return (b->x - a->x) * (c->y - a->y) - (b->y - a->y) * (c->x - a->x);
+}
+
+//sorts vertexes top to bottom
+static int hidden_cave_compare_sweep_keys(void const* a, void const* b) {
+    hidden_cave_Sweep_Key const* ka = a;
+    hidden_cave_Sweep_Key const* kb = b;
+    if(ka->y != kb->y) {
+        return ka->y > kb->y ? -1 : 1;
+    }
+    if(ka->x != kb->x) {
+        return ka->x < kb->x ? -1 : 1;
+    }
+    return ka->v < kb->v ? -1 : ka->v > kb->v;
+}
+
+//where edge `e` crosses the horizontal line at `y`. Horizontal edges only sit in the status while the sweep
+//is at their left end, so that is where they are taken to be.
+static double hidden_cave_edge_x(hidden_cave_Monotone const* m, uint32_t e, double y) {
+    hidden_cave_Sweep_Vertex const* a = V(e);
+    hidden_cave_Sweep_Vertex const* b = V(a->next);
+    if(a->y == b->y) {
+        return a->x < b->x ? a->x : b->x;
+    }
+    double t = (y - a->y) / (b->y - a->y);
+    t = t < 0 ? 0 : t > 1 ? 1 : t;
+    return a->x + t * (b->x - a->x);
+}
+
+//whether edge `e`, which starts at the sweep vertex, lies to the right of edge `other` in the status
+static bool hidden_cave_edge_right_of(hidden_cave_Monotone const* m, uint32_t e, uint32_t other) {
+    hidden_cave_Sweep_Vertex const* p = V(e);
+    double other_x = hidden_cave_edge_x(m, other, p->y);
+    if(other_x != p->x) {
+        return other_x < p->x;
+    }
+    //they meet at the sweep line, so compare them a little further down
+    double low_e = V(p->next)->y;
+    double low_o = fmin(V(other)->y, V(V(other)->next)->y);
+    double y = (p->y + fmax(low_e, low_o)) / 2;
+    return hidden_cave_edge_x(m, other, y) < hidden_cave_edge_x(m, e, y);
+}
+
+static void hidden_cave_rotate_up(hidden_cave_Monotone* m, uint32_t x) {
+    uint32_t p = V(x)->parent;
+    uint32_t g = V(p)->parent;
+    if(V(p)->left == x) {
+        V(p)->left = V(x)->right;
+        if(V(x)->right != CAVE_MONOTONE_NIL) {
+            V(V(x)->right)->parent = p;
+        }
+        V(x)->right = p;
+    } else {
+        V(p)->right = V(x)->left;
+        if(V(x)->left != CAVE_MONOTONE_NIL) {
+            V(V(x)->left)->parent = p;
+        }
+        V(x)->left = p;
+    }
+    V(p)->parent = x;
+    V(x)->parent = g;
+    if(g == CAVE_MONOTONE_NIL) {
+        m->root = x;
+    } else if(V(g)->left == p) {
+        V(g)->left = x;
+    } else {
+        V(g)->right = x;
+    }
+}
+
+static void hidden_cave_status_insert(hidden_cave_Monotone* m, uint32_t e) {
+    V(e)->left = CAVE_MONOTONE_NIL;
+    V(e)->right = CAVE_MONOTONE_NIL;
+    V(e)->parent = CAVE_MONOTONE_NIL;
+    if(m->root == CAVE_MONOTONE_NIL) {
+        m->root = e;
+        return;
+    }
+    uint32_t at = m->root;
+    for(;;) {
+        bool right = hidden_cave_edge_right_of(m, e, at);
+        uint32_t child = right ? V(at)->right : V(at)->left;
+        if(child == CAVE_MONOTONE_NIL) {
+            if(right) {
+                V(at)->right = e;
+            } else {
+                V(at)->left = e;
+            }
+            V(e)->parent = at;
+            break;
+        }
+        at = child;
+    }
+    while(V(e)->parent != CAVE_MONOTONE_NIL && V(V(e)->parent)->priority < V(e)->priority) {
+        hidden_cave_rotate_up(m, e);
+    }
+}
+
+static void hidden_cave_status_remove(hidden_cave_Monotone* m, uint32_t e) {
+    //rotate it down until it has at most one child, then splice it out
+    while(V(e)->left != CAVE_MONOTONE_NIL && V(e)->right != CAVE_MONOTONE_NIL) {
+        uint32_t l = V(e)->left, r = V(e)->right;
+        hidden_cave_rotate_up(m, V(l)->priority > V(r)->priority ? l : r);
+    }
+    uint32_t child = V(e)->left != CAVE_MONOTONE_NIL ? V(e)->left : V(e)->right;
+    uint32_t p = V(e)->parent;
+    if(child != CAVE_MONOTONE_NIL) {
+        V(child)->parent = p;
+    }
+    if(p == CAVE_MONOTONE_NIL) {
+        m->root = child;
+    } else if(V(p)->left == e) {
+        V(p)->left = child;
+    } else {
+        V(p)->right = child;
+    }
+}
+
+//the edge of the status directly to the left of vertex `v`
+static uint32_t hidden_cave_status_left_of(hidden_cave_Monotone const* m, uint32_t v) {
+    uint32_t found = CAVE_MONOTONE_NIL;
+    uint32_t at = m->root;
+    while(at != CAVE_MONOTONE_NIL) {
+        if(hidden_cave_edge_x(m, at, V(v)->y) <= V(v)->x) {
+            found = at;
+            at = V(at)->right;
+        } else {
+            at = V(at)->left;
+        }
+    }
+    return found;
+}
+
+static void hidden_cave_add_diagonal(hidden_cave_Monotone* m, uint32_t a, uint32_t b) {
+    m->diagonals[2 * m->diagonal_count] = a;
+    m->diagonals[2 * m->diagonal_count + 1] = b;
+    m->diagonal_count++;
+}
+
+//connects `v` to the helper of `e` if that helper is a merge vertex
+static void hidden_cave_fix_up(hidden_cave_Monotone* m, uint32_t v, uint32_t e) {
+    if(e != CAVE_MONOTONE_NIL && V(V(e)->helper)->type == CAVE_MONOTONE_MERGE) {
+        hidden_cave_add_diagonal(m, v, V(e)->helper);
+    }
+}
+
+static void hidden_cave_classify(hidden_cave_Monotone* m, uint32_t v) {
+    hidden_cave_Sweep_Vertex* p = V(v);
+    hidden_cave_Sweep_Vertex const* prev = V(p->prev);
+    hidden_cave_Sweep_Vertex const* next = V(p->next);
+    bool prev_below = hidden_cave_above(p, prev);
+    bool next_below = hidden_cave_above(p, next);
+    bool convex = hidden_cave_cross(prev, p, next) > 0;
+    if(prev_below && next_below) {
+        p->type = convex ? CAVE_MONOTONE_START : CAVE_MONOTONE_SPLIT;
+    } else if(!prev_below && !next_below) {
+        p->type = convex ? CAVE_MONOTONE_END : CAVE_MONOTONE_MERGE;
+    } else {
+        p->type = prev_below ? CAVE_MONOTONE_REGULAR_RIGHT : CAVE_MONOTONE_REGULAR_LEFT;
+    }
+}
+
+//sweeps down the polygon adding the diagonals that split it into monotone pieces
+static void hidden_cave_sweep(hidden_cave_Monotone* m) {
+    m->root = CAVE_MONOTONE_NIL;
+    for(uint32_t k = 0; k < m->vert_count; k++) {
+        uint32_t v = m->order[k].v;
+        uint32_t prev_edge = V(v)->prev;
+        uint32_t left;
+        switch(V(v)->type) {
+            case CAVE_MONOTONE_START:
+                V(v)->helper = v;
+                hidden_cave_status_insert(m, v);
+                break;
+            case CAVE_MONOTONE_END:
+                hidden_cave_fix_up(m, v, prev_edge);
+                hidden_cave_status_remove(m, prev_edge);
+                break;
+            case CAVE_MONOTONE_SPLIT:
+                left = hidden_cave_status_left_of(m, v);
+                if(left != CAVE_MONOTONE_NIL) {
+                    hidden_cave_add_diagonal(m, v, V(left)->helper);
+                    V(left)->helper = v;
+                }
+                V(v)->helper = v;
+                hidden_cave_status_insert(m, v);
+                break;
+            case CAVE_MONOTONE_MERGE:
+                hidden_cave_fix_up(m, v, prev_edge);
+                hidden_cave_status_remove(m, prev_edge);
+                left = hidden_cave_status_left_of(m, v);
+                if(left != CAVE_MONOTONE_NIL) {
+                    hidden_cave_fix_up(m, v, left);
+                    V(left)->helper = v;
+                }
+                break;
+            case CAVE_MONOTONE_REGULAR_LEFT:
+                hidden_cave_fix_up(m, v, prev_edge);
+                hidden_cave_status_remove(m, prev_edge);
+                V(v)->helper = v;
+                hidden_cave_status_insert(m, v);
+                break;
+            default:
+                left = hidden_cave_status_left_of(m, v);
+                if(left != CAVE_MONOTONE_NIL) {
+                    hidden_cave_fix_up(m, v, left);
+                    V(left)->helper = v;
+                }
+                break;
+        }
+    }
+}
+
+static void hidden_cave_monotone_emit(hidden_cave_Monotone* m, uint32_t a, uint32_t b, uint32_t c) {
+    if(m->tri_count >= m->tri_cap) {
+        return;
+    }
+    if(hidden_cave_cross(V(a), V(b), V(c)) < 0) {
+        uint32_t t = b;
+        b = c;
+        c = t;
+    }
+    cave_Index_Triangle* tri = m->tris + m->tri_count++;
+    tri->a = V(a)->id;
+    tri->b = V(b)->id;
+    tri->c = V(c)->id;
+}
+
+//triangulates the monotone piece `face`, given counter-clockwise, in linear time. `sorted`, `on_left` and
+//`stack` are scratch space of at least `len` elements each.
+static void hidden_cave_triangulate_monotone_piece(hidden_cave_Monotone* m, uint32_t const* face, uint32_t len,
+                                                   uint32_t* sorted, bool* on_left, uint32_t* stack) {
+    if(len < 3) {
+        return;
+    }
+    uint32_t top = 0, bottom = 0;
+    for(uint32_t i = 1; i < len; i++) {
+        if(hidden_cave_above(V(face[i]), V(face[top]))) {
+            top = i;
+        }
+        if(hidden_cave_above(V(face[bottom]), V(face[i]))) {
+            bottom = i;
+        }
+    }
+    //going forwards from the top runs down the left chain, and backwards down the right one.
+    //Merging the two sorts the piece top to bottom.
+    uint32_t l = (top + 1) % len;
+    uint32_t r = (top + len - 1) % len;
+    uint32_t count = 0;
+    sorted[count] = face[top];
+    on_left[count++] = true;
+    while(l != bottom || r != bottom) {
+        bool take_left = r == bottom || (l != bottom && hidden_cave_above(V(face[l]), V(face[r])));
+        if(take_left) {
+            sorted[count] = face[l];
+            on_left[count++] = true;
+            l = (l + 1) % len;
+        } else {
+            sorted[count] = face[r];
+            on_left[count++] = false;
+            r = (r + len - 1) % len;
+        }
+    }
+    sorted[count++] = face[bottom];
+
+    uint32_t depth = 0;
+    bool top_on_left = on_left[1];
+    stack[depth++] = 0;
+    stack[depth++] = 1;
+    for(uint32_t j = 2; j + 1 < count; j++) {
+        uint32_t u = sorted[j];
+        if(on_left[j] != top_on_left) {
+            //opposite chains: everything on the stack can see `u`
+            for(uint32_t i = 0; i + 1 < depth; i++) {
+                hidden_cave_monotone_emit(m, u, sorted[stack[i]], sorted[stack[i + 1]]);
+            }
+            depth = 0;
+            stack[depth++] = j - 1;
+            stack[depth++] = j;
+        } else {
+            //same chain: clip while the corner at the top of the stack is convex
+            uint32_t last = stack[--depth];
+            while(depth > 0) {
+                uint32_t s = stack[depth - 1];
+                double turn = hidden_cave_cross(V(sorted[s]), V(sorted[last]), V(u));
+                if(on_left[j] ? turn <= 0 : turn >= 0) {
+                    break;
+                }
+                hidden_cave_monotone_emit(m, u, sorted[last], sorted[s]);
+                last = s;
+                depth--;
+            }
+            stack[depth++] = last;
+            stack[depth++] = j;
+        }
+        top_on_left = on_left[j];
+    }
+    uint32_t u = sorted[count - 1];
+    for(uint32_t i = 0; i + 1 < depth; i++) {
+        hidden_cave_monotone_emit(m, u, sorted[stack[i]], sorted[stack[i + 1]]);
+    }
+}
+
+static int hidden_cave_compare_out_edges(void const* a, void const* b) {
+    double da = ((hidden_cave_Out_Edge const*) a)->angle;
+    double db = ((hidden_cave_Out_Edge const*) b)->angle;
+    return da < db ? -1 : da > db;
+}
+
+static double hidden_cave_out_angle(hidden_cave_Monotone const* m, uint32_t v, uint32_t to) {
+    hidden_cave_Sweep_Vertex const* p = V(v);
+    double rx = V(p->next)->x - p->x, ry = V(p->next)->y - p->y;
+    double dx = V(to)->x - p->x, dy = V(to)->y - p->y;
+    double angle = atan2(rx * dy - ry * dx, rx * dx + ry * dy);
+    return angle < 0 ? angle + 6.283185307179586 : angle;
+}
+
+//traces the pieces the diagonals cut the polygon into, and triangulates each
+static CaveError hidden_cave_triangulate_pieces(hidden_cave_Monotone* m) {
+    uint32_t n = m->vert_count;
+    size_t edge_count = 2 * (size_t) n + 2 * (size_t) m->diagonal_count;
+    uint32_t* first = calloc((size_t) n + 1, sizeof(uint32_t));
+    hidden_cave_Out_Edge* out = malloc(sizeof(hidden_cave_Out_Edge) * edge_count);
+    uint32_t* prev_pos = malloc(sizeof(uint32_t) * n);
+    uint32_t* diagonal_pos = malloc(sizeof(uint32_t) * (2 * (size_t) m->diagonal_count + 1));
+    //a piece can't visit more vertexes than there are edges leaving them
+    uint32_t* scratch = malloc(sizeof(uint32_t) * 3 * edge_count);
+    bool* on_left = malloc(sizeof(bool) * edge_count);
+    if(!first || !out || !prev_pos || !diagonal_pos || !scratch || !on_left) {
+        free(first);
+        free(out);
+        free(prev_pos);
+        free(diagonal_pos);
+        free(scratch);
+        free(on_left);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+
+    //lay out the edges leaving each vertex contiguously, sorted counter-clockwise from its polygon edge
+    for(uint32_t v = 0; v < n; v++) {
+        first[v + 1] = 2;
+    }
+    for(uint32_t d = 0; d < m->diagonal_count; d++) {
+        first[m->diagonals[2 * d] + 1]++;
+        first[m->diagonals[2 * d + 1] + 1]++;
+    }
+    for(uint32_t v = 0; v < n; v++) {
+        first[v + 1] += first[v];
+    }
+    uint32_t* fill = scratch;
+    for(uint32_t v = 0; v < n; v++) {
+        hidden_cave_Out_Edge* e = out + first[v];
+        e[0] = (hidden_cave_Out_Edge) {0.0, V(v)->next, 0, CAVE_MONOTONE_OUT_NEXT, false};
+        e[1] = (hidden_cave_Out_Edge) {hidden_cave_out_angle(m, v, V(v)->prev), V(v)->prev, 0,
+                                       CAVE_MONOTONE_OUT_PREV, true};
+        fill[v] = first[v] + 2;
+    }
+    for(uint32_t d = 0; d < m->diagonal_count; d++) {
+        for(uint32_t dir = 0; dir < 2; dir++) {
+            uint32_t from = m->diagonals[2 * d + dir];
+            uint32_t to = m->diagonals[2 * d + (dir ^ 1)];
+            out[fill[from]++] = (hidden_cave_Out_Edge) {hidden_cave_out_angle(m, from, to), to, 2 * d + dir,
+                                                        CAVE_MONOTONE_OUT_DIAGONAL, false};
+        }
+    }
+    for(uint32_t v = 0; v < n; v++) {
+        uint32_t deg = first[v + 1] - first[v];
+        if(deg > 2) {
+            qsort(out + first[v], deg, sizeof(hidden_cave_Out_Edge), hidden_cave_compare_out_edges);
+        }
+        for(uint32_t i = first[v]; i < first[v + 1]; i++) {
+            if(out[i].kind == CAVE_MONOTONE_OUT_PREV) {
+                prev_pos[v] = i;
+            } else if(out[i].kind == CAVE_MONOTONE_OUT_DIAGONAL) {
+                diagonal_pos[out[i].twin] = i;
+            }
+        }
+    }
+
+    //walking a piece counter-clockwise, the edge to leave a vertex by is the first one clockwise from the
+    //edge arrived by
+    uint32_t* face = scratch;
+    uint32_t* sorted = scratch + edge_count;
+    uint32_t* stack = scratch + 2 * edge_count;
+    for(uint32_t v = 0; v < n; v++) {
+        for(uint32_t start = first[v]; start < first[v + 1]; start++) {
+            if(out[start].visited) {
+                continue;
+            }
+            uint32_t len = 0;
+            uint32_t e = start;
+            uint32_t at = v;
+            do {
+                out[e].visited = true;
+                face[len++] = at;
+                uint32_t to = out[e].to;
+                uint32_t back = out[e].kind == CAVE_MONOTONE_OUT_NEXT ? prev_pos[to] : diagonal_pos[out[e].twin ^ 1];
+                e = back == first[to] ? first[to + 1] - 1 : back - 1;
+                at = to;
+            } while(e != start && len < edge_count);
+            hidden_cave_triangulate_monotone_piece(m, face, len, sorted, on_left, stack);
+        }
+    }
+
+    free(first);
+    free(out);
+    free(prev_pos);
+    free(diagonal_pos);
+    free(scratch);
+    free(on_left);
+    return CAVE_NO_ERROR;
+}
+
+//links the rings of `polygon` for the sweep, which wants the interior on the left of every edge. If `orient`,
+//each ring is wound counter-clockwise; otherwise the rings are taken to be wound that way already, with
+//holes clockwise.
+static CaveError hidden_cave_monotone_run(hidden_cave_Monotone* m, cave_2d_Polygon const* polygon, bool orient) {
+    cave_2Point const* points = polygon->points;
+    uint32_t n = 0;
+    uint32_t seed = 0x9E3779B9u;
+    for(size_t r = 0; r < polygon->ring_count; r++) {
+        //repeated points would make zero length edges, which have no direction to sweep along
+        uint32_t start = n;
+        for(size_t i = polygon->ring_offsets[r]; i < polygon->ring_offsets[r + 1]; i++) {
+            if(n > start && points[i].x == V(n - 1)->x && points[i].y == V(n - 1)->y) {
+                continue;
+            }
+            V(n)->x = points[i].x;
+            V(n)->y = points[i].y;
+            V(n)->id = (uint32_t) i;
+            n++;
+        }
+        while(n > start + 1 && V(n - 1)->x == V(start)->x && V(n - 1)->y == V(start)->y) {
+            n--;
+        }
+        double area = 0.0;
+        for(uint32_t i = start, j = n - 1; i < n; j = i++) {
+            area += V(j)->x * V(i)->y - V(i)->x * V(j)->y;
+        }
+        if(n - start < 3 || area == 0.0) {
+            n = start;
+            continue;
+        }
+        bool forwards = !orient || area > 0;
+        for(uint32_t i = start; i < n; i++) {
+            uint32_t after = i + 1 == n ? start : i + 1;
+            uint32_t before = i == start ? n - 1 : i - 1;
+            V(i)->next = forwards ? after : before;
+            V(i)->prev = forwards ? before : after;
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            V(i)->priority = seed;
+        }
+        //every ring after the first can be bridged to another, taking two more triangles
+        m->tri_cap += m->tri_cap == 0 ? n - start - 2 : n - start + 2;
+    }
+    m->vert_count = n;
+    if(n < 3) {
+        return CAVE_NO_ERROR;
+    }
+    for(uint32_t i = 0; i < n; i++) {
+        hidden_cave_classify(m, i);
+        m->order[i] = (hidden_cave_Sweep_Key) {V(i)->y, V(i)->x, i};
+    }
+    qsort(m->order, n, sizeof(hidden_cave_Sweep_Key), hidden_cave_compare_sweep_keys);
+    hidden_cave_sweep(m);
+    return hidden_cave_triangulate_pieces(m);
+}
+
+static CaveError hidden_cave_triangulate_monotone_polygon(cave_Index_Triangle** dest, size_t* tri_count,
+                                                          cave_2d_Polygon const* polygon, bool orient) {
+    size_t point_count = polygon->ring_offsets[polygon->ring_count];
+    hidden_cave_Monotone mono = {0};
+    mono.verts = malloc(sizeof(hidden_cave_Sweep_Vertex) * point_count);
+    mono.order = malloc(sizeof(hidden_cave_Sweep_Key) * point_count);
+    //each vertex adds at most two diagonals, and only merge vertexes add two
+    mono.diagonals = malloc(sizeof(uint32_t) * 4 * point_count);
+    mono.tris = malloc(sizeof(cave_Index_Triangle) * (point_count + 2 * polygon->ring_count));
+    CaveError err;
+    if(!mono.verts || !mono.order || !mono.diagonals || !mono.tris) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    } else {
+        err = hidden_cave_monotone_run(&mono, polygon, orient);
+    }
+    free(mono.verts);
+    free(mono.order);
+    free(mono.diagonals);
+    if(err != CAVE_NO_ERROR || mono.tri_count == 0) {
+        free(mono.tris);
+        return err;
+    }
+    *dest = mono.tris;
+    *tri_count = mono.tri_count;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_polytri_triangulate_monotone(cave_Index_Triangle** dest, size_t* tri_count,
+                                            cave_2Point const* points, size_t point_count) {
+    if(!dest || !tri_count) {
+        return CAVE_DATA_ERROR;
+    }
+    *dest = NULL;
+    *tri_count = 0;
+    CaveError err = hidden_cave_polytri_validate_points(points, point_count);
+    if(err != CAVE_NO_ERROR || point_count < 3) {
+        return err;
+    }
+    size_t offsets[2] = {0, point_count};
+    cave_2d_Polygon polygon = {(cave_2Point*) points, offsets, 1};
+    return hidden_cave_triangulate_monotone_polygon(dest, tri_count, &polygon, true);
+}
+
+CaveError cave_polytri_triangulate_polygon_monotone(cave_Index_Triangle** dest, size_t* tri_count,
+                                                    cave_2d_Polygon const* polygon) {
+    if(!dest || !tri_count) {
+        return CAVE_DATA_ERROR;
+    }
+    *dest = NULL;
+    *tri_count = 0;
+    CaveError err = hidden_cave_polytri_validate_polygon(polygon);
+    if(err != CAVE_NO_ERROR || polygon->ring_count == 0) {
+        return err;
+    }
+    return hidden_cave_triangulate_monotone_polygon(dest, tri_count, polygon, false);
+}
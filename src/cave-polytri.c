@@ -2,4 +2,1367 @@
 // Created by David Sullivan on 11/17/22.
 //
 
-#include "cave-polytri.h"
\ No newline at end of file
+#include "cave-polytri.h"
+#include "cave-polytri-internal.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+//The ear clipper works on a doubly linked ring of nodes, one per polygon point. Links are indexes into one
+//node array rather than pointers. When the polygon is large enough to hash, the nodes are also listed in an
+//array sorted by z-order code, which ear tests search for the points that could be inside the ear.
+
+#define CAVE_POLYTRI_NIL (UINT32_MAX)
+
+typedef struct hidden_cave_PolyTri_Node {
+    float x;
+    float y;
+    uint32_t i; //index of the point in the caller's array
+    uint32_t prev;
+    uint32_t next;
+    uint32_t prev_cand; //neighbours in the list of corners that may be ears
+    uint32_t next_cand;
+    bool candidate;
+    bool removed;
+    bool bridged; //part of the outline, rather than a hole not yet joined to it
+    bool steiner;
+} hidden_cave_PolyTri_Node;
+
+typedef struct hidden_cave_Z_Entry {
+    uint32_t z;
+    uint32_t node;
+} hidden_cave_Z_Entry;
+
+typedef struct hidden_cave_Ear_Clipper {
+    hidden_cave_PolyTri_Node* nodes;
+    uint32_t node_count;
+    uint32_t node_cap;
+    hidden_cave_PolyTri_Out* out;
+    size_t cand_count;
+    hidden_cave_Z_Entry* z_entries; //sorted by z, including removed nodes until they're compacted away
+    hidden_cave_Z_Entry* z_scratch;
+    size_t z_len;
+    size_t z_removed;
+    bool hashed;
+    double min_x;
+    double min_y;
+    double inv_size;
+    hidden_cave_PolyTri_Scratch* scratch;
+} hidden_cave_Ear_Clipper;
+
+#define N(idx) (ec->nodes + (idx))
+
+//twice the signed area of (p, q, r), negated: negative when p, q, r turn counter-clockwise.
+//Products are taken in double, where the float inputs can't lose precision to rounding.
+static double hidden_cave_area(hidden_cave_PolyTri_Node const* p, hidden_cave_PolyTri_Node const* q,
+                               hidden_cave_PolyTri_Node const* r) {
+    return ((double) q->y - p->y) * ((double) r->x - q->x) - ((double) q->x - p->x) * ((double) r->y - q->y);
+}
+
+static bool hidden_cave_equals(hidden_cave_PolyTri_Node const* a, hidden_cave_PolyTri_Node const* b) {
+    return a->x == b->x && a->y == b->y;
+}
+
+static bool hidden_cave_point_in_triangle(double ax, double ay, double bx, double by, double cx, double cy,
+                                          double px, double py) {
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+           (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+           (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+//interleaves the bits of the coordinates, scaled to 15 bits each, so points close together in the plane
+//get codes close together
+static uint32_t hidden_cave_z_order(hidden_cave_Ear_Clipper const* ec, double fx, double fy) {
+    uint32_t x = (uint32_t) ((fx - ec->min_x) * ec->inv_size);
+    uint32_t y = (uint32_t) ((fy - ec->min_y) * ec->inv_size);
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    y = (y | (y << 8)) & 0x00FF00FF;
+    y = (y | (y << 4)) & 0x0F0F0F0F;
+    y = (y | (y << 2)) & 0x33333333;
+    y = (y | (y << 1)) & 0x55555555;
+    return x | (y << 1);
+}
+
+static uint32_t hidden_cave_create_node(hidden_cave_Ear_Clipper* ec, uint32_t i, float x, float y) {
+    uint32_t idx = ec->node_count++;
+    hidden_cave_PolyTri_Node* p = N(idx);
+    p->x = x;
+    p->y = y;
+    p->i = i;
+    p->prev = CAVE_POLYTRI_NIL;
+    p->next = CAVE_POLYTRI_NIL;
+    p->candidate = false;
+    p->removed = false;
+    p->bridged = false;
+    p->steiner = false;
+    return idx;
+}
+
+//creates a node and links it in after `last`, or into a ring of its own if `last` is NIL
+static uint32_t hidden_cave_insert_node(hidden_cave_Ear_Clipper* ec, uint32_t i, float x, float y, uint32_t last) {
+    uint32_t idx = hidden_cave_create_node(ec, i, x, y);
+    if(last == CAVE_POLYTRI_NIL) {
+        N(idx)->prev = idx;
+        N(idx)->next = idx;
+    } else {
+        N(idx)->next = N(last)->next;
+        N(idx)->prev = last;
+        N(N(last)->next)->prev = idx;
+        N(last)->next = idx;
+    }
+    return idx;
+}
+
+static void hidden_cave_remove_node(hidden_cave_Ear_Clipper* ec, uint32_t idx) {
+    hidden_cave_PolyTri_Node* p = N(idx);
+    N(p->next)->prev = p->prev;
+    N(p->prev)->next = p->next;
+    p->removed = true;
+    ec->z_removed++;
+}
+
+static void hidden_cave_emit(hidden_cave_Ear_Clipper* ec, uint32_t a, uint32_t b, uint32_t c) {
+    hidden_cave_polytri_put(ec->out, N(a)->i, N(b)->i, N(c)->i);
+}
+
+//twice the signed area of the ring, positive for counter-clockwise
+static double hidden_cave_signed_area(cave_2Point const* points, size_t start, size_t end) {
+    double sum = 0.0;
+    for(size_t i = start, j = end - 1; i < end; j = i++) {
+        sum += ((double) points[j].x - points[i].x) * ((double) points[i].y + points[j].y);
+    }
+    return sum;
+}
+
+//links `points[start..end)` into a ring, wound counter-clockwise if `ccw` and clockwise otherwise.
+//Returns the last node, or NIL for an empty range.
+static uint32_t hidden_cave_linked_ring(hidden_cave_Ear_Clipper* ec, cave_2Point const* points, size_t start,
+                                        size_t end, bool ccw) {
+    uint32_t last = CAVE_POLYTRI_NIL;
+    if(ccw == (hidden_cave_signed_area(points, start, end) > 0)) {
+        for(size_t i = start; i < end; i++) {
+            last = hidden_cave_insert_node(ec, (uint32_t) i, points[i].x, points[i].y, last);
+        }
+    } else {
+        for(size_t i = end; i-- > start;) {
+            last = hidden_cave_insert_node(ec, (uint32_t) i, points[i].x, points[i].y, last);
+        }
+    }
+    if(last != CAVE_POLYTRI_NIL && hidden_cave_equals(N(last), N(N(last)->next))) {
+        uint32_t next = N(last)->next;
+        hidden_cave_remove_node(ec, last);
+        last = next;
+    }
+    return last;
+}
+
+//removes repeated and collinear points between `start` and `end`. Returns a node still in the ring.
+static uint32_t hidden_cave_filter_points(hidden_cave_Ear_Clipper* ec, uint32_t start, uint32_t end) {
+    if(start == CAVE_POLYTRI_NIL) {
+        return start;
+    }
+    if(end == CAVE_POLYTRI_NIL) {
+        end = start;
+    }
+    uint32_t p = start;
+    bool again;
+    do {
+        again = false;
+        if(!N(p)->steiner &&
+           (hidden_cave_equals(N(p), N(N(p)->next)) || hidden_cave_area(N(N(p)->prev), N(p), N(N(p)->next)) == 0)) {
+            hidden_cave_remove_node(ec, p);
+            p = end = N(p)->prev;
+            if(p == N(p)->next) {
+                break;
+            }
+            again = true;
+        } else {
+            p = N(p)->next;
+        }
+    } while(again || p != end);
+    return end;
+}
+
+//sorts the z entries by z with a three pass radix sort on 10 bit digits, as z codes are 30 bits
+static void hidden_cave_sort_z_entries(hidden_cave_Ear_Clipper* ec) {
+    hidden_cave_Z_Entry* src = ec->z_entries;
+    hidden_cave_Z_Entry* dst = ec->z_scratch;
+    for(unsigned shift = 0; shift < 30; shift += 10) {
+        size_t counts[1024] = {0};
+        for(size_t i = 0; i < ec->z_len; i++) {
+            counts[(src[i].z >> shift) & 1023]++;
+        }
+        size_t total = 0;
+        for(size_t d = 0; d < 1024; d++) {
+            size_t c = counts[d];
+            counts[d] = total;
+            total += c;
+        }
+        for(size_t i = 0; i < ec->z_len; i++) {
+            dst[counts[(src[i].z >> shift) & 1023]++] = src[i];
+        }
+        hidden_cave_Z_Entry* t = src;
+        src = dst;
+        dst = t;
+    }
+    //three passes leave the result in the scratch array
+    ec->z_scratch = ec->z_entries;
+    ec->z_entries = src;
+}
+
+//lists the nodes of the ring containing `start` by z code
+static void hidden_cave_index_curve(hidden_cave_Ear_Clipper* ec, uint32_t start) {
+    uint32_t p = start;
+    ec->z_len = 0;
+    ec->z_removed = 0;
+    do {
+        hidden_cave_Z_Entry* e = ec->z_entries + ec->z_len++;
+        e->z = hidden_cave_z_order(ec, N(p)->x, N(p)->y);
+        e->node = p;
+        p = N(p)->next;
+    } while(p != start);
+    hidden_cave_sort_z_entries(ec);
+}
+
+//drops the entries of removed nodes once they make up half the list, so searches don't keep wading through them
+static void hidden_cave_compact_z_entries(hidden_cave_Ear_Clipper* ec) {
+    if(ec->z_removed * 2 < ec->z_len) {
+        return;
+    }
+    size_t len = 0;
+    for(size_t i = 0; i < ec->z_len; i++) {
+        if(!N(ec->z_entries[i].node)->removed) {
+            ec->z_entries[len++] = ec->z_entries[i];
+        }
+    }
+    ec->z_len = len;
+    ec->z_removed = 0;
+}
+
+#define CAVE_POLYTRI_Z_EVEN (0x55555555u)
+#define CAVE_POLYTRI_Z_ODD (0xAAAAAAAAu)
+
+//whether the cell with code `z` lies in the box of cells with corners `min_z` and `max_z`. The bits of one
+//coordinate compare in the same order as the coordinate, so each can be checked on its own.
+static bool hidden_cave_z_in_box(uint32_t z, uint32_t min_z, uint32_t max_z) {
+    uint32_t x = z & CAVE_POLYTRI_Z_EVEN, y = z & CAVE_POLYTRI_Z_ODD;
+    return x >= (min_z & CAVE_POLYTRI_Z_EVEN) && x <= (max_z & CAVE_POLYTRI_Z_EVEN) &&
+           y >= (min_z & CAVE_POLYTRI_Z_ODD) && y <= (max_z & CAVE_POLYTRI_Z_ODD);
+}
+
+//the smallest code greater than `z` whose cell lies in the box of cells between `min_z` and `max_z`
+//(Tropf and Herzog's BIGMIN). Lets a search over a range of codes jump over the stretches that leave the box.
+static uint32_t hidden_cave_z_bigmin(uint32_t z, uint32_t min_z, uint32_t max_z) {
+    uint32_t bigmin = max_z;
+    for(int bit = 31; bit >= 0; bit--) {
+        uint32_t mask = (uint32_t) 1 << bit;
+        //the lower bits belonging to the same coordinate as `bit`
+        uint32_t below = (bit & 1 ? CAVE_POLYTRI_Z_ODD : CAVE_POLYTRI_Z_EVEN) & (mask - 1);
+        unsigned state = ((z & mask) ? 4 : 0) | ((min_z & mask) ? 2 : 0) | ((max_z & mask) ? 1 : 0);
+        if(state == 1) {
+            bigmin = (min_z & ~below) | mask;
+            max_z = (max_z & ~mask) | below;
+        } else if(state == 3) {
+            return min_z;
+        } else if(state == 4) {
+            return bigmin;
+        } else if(state == 5) {
+            min_z = (min_z & ~below) | mask;
+        }
+    }
+    return bigmin;
+}
+
+//the index of the first entry at or after `from` whose code is at least `z`
+static size_t hidden_cave_z_lower_bound(hidden_cave_Ear_Clipper const* ec, size_t from, uint32_t z) {
+    size_t lo = from, hi = ec->z_len;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(ec->z_entries[mid].z < z) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+//whether the reflex corner `p` lies in the candidate ear (a, b, c), which would block clipping it
+static bool hidden_cave_blocks_ear(hidden_cave_Ear_Clipper const* ec, hidden_cave_PolyTri_Node const* a,
+                                   hidden_cave_PolyTri_Node const* b, hidden_cave_PolyTri_Node const* c,
+                                   hidden_cave_PolyTri_Node const* p) {
+    if(p->x == a->x && p->y == a->y) {
+        return false;
+    }
+    return hidden_cave_point_in_triangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+           hidden_cave_area(N(p->prev), p, N(p->next)) >= 0;
+}
+
+static bool hidden_cave_is_ear(hidden_cave_Ear_Clipper const* ec, uint32_t ear) {
+    hidden_cave_PolyTri_Node const* a = N(N(ear)->prev);
+    hidden_cave_PolyTri_Node const* b = N(ear);
+    hidden_cave_PolyTri_Node const* c = N(N(ear)->next);
+    if(hidden_cave_area(a, b, c) >= 0) {
+        return false; //reflex, can't be an ear
+    }
+    float x0 = fminf(a->x, fminf(b->x, c->x));
+    float y0 = fminf(a->y, fminf(b->y, c->y));
+    float x1 = fmaxf(a->x, fmaxf(b->x, c->x));
+    float y1 = fmaxf(a->y, fmaxf(b->y, c->y));
+
+    uint32_t stop = N(ear)->prev;
+    for(uint32_t pi = c->next; pi != stop; pi = N(pi)->next) {
+        hidden_cave_PolyTri_Node const* p = N(pi);
+        if(p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && hidden_cave_blocks_ear(ec, a, b, c, p)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//like `hidden_cave_is_ear`, but only visits the points whose z codes fall within the ear's bounding box,
+//jumping over the stretches of codes between the ear's corners that leave the box
+static bool hidden_cave_is_ear_hashed(hidden_cave_Ear_Clipper const* ec, uint32_t ear) {
+    uint32_t ai = N(ear)->prev;
+    uint32_t ci = N(ear)->next;
+    hidden_cave_PolyTri_Node const* a = N(ai);
+    hidden_cave_PolyTri_Node const* b = N(ear);
+    hidden_cave_PolyTri_Node const* c = N(ci);
+    if(hidden_cave_area(a, b, c) >= 0) {
+        return false;
+    }
+    float x0 = fminf(a->x, fminf(b->x, c->x));
+    float y0 = fminf(a->y, fminf(b->y, c->y));
+    float x1 = fmaxf(a->x, fmaxf(b->x, c->x));
+    float y1 = fmaxf(a->y, fmaxf(b->y, c->y));
+    uint32_t min_z = hidden_cave_z_order(ec, x0, y0);
+    uint32_t max_z = hidden_cave_z_order(ec, x1, y1);
+
+    size_t i = hidden_cave_z_lower_bound(ec, 0, min_z);
+    while(i < ec->z_len && ec->z_entries[i].z <= max_z) {
+        hidden_cave_Z_Entry e = ec->z_entries[i];
+        if(!hidden_cave_z_in_box(e.z, min_z, max_z)) {
+            i = hidden_cave_z_lower_bound(ec, i + 1, hidden_cave_z_bigmin(e.z, min_z, max_z));
+            continue;
+        }
+        hidden_cave_PolyTri_Node const* p = N(e.node);
+        if(!p->removed && e.node != ai && e.node != ci &&
+           p->x >= x0 && p->x <= x1 && p->y >= y0 && p->y <= y1 && hidden_cave_blocks_ear(ec, a, b, c, p)) {
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+static int hidden_cave_sign(double v) {
+    return v > 0 ? 1 : v < 0 ? -1 : 0;
+}
+
+//whether q lies within the bounding box of segment pr, for collinear p, q, r
+static bool hidden_cave_on_segment(hidden_cave_PolyTri_Node const* p, hidden_cave_PolyTri_Node const* q,
+                                   hidden_cave_PolyTri_Node const* r) {
+    return q->x <= fmaxf(p->x, r->x) && q->x >= fminf(p->x, r->x) &&
+           q->y <= fmaxf(p->y, r->y) && q->y >= fminf(p->y, r->y);
+}
+
+static bool hidden_cave_intersects(hidden_cave_PolyTri_Node const* p1, hidden_cave_PolyTri_Node const* q1,
+                                   hidden_cave_PolyTri_Node const* p2, hidden_cave_PolyTri_Node const* q2) {
+    int o1 = hidden_cave_sign(hidden_cave_area(p1, q1, p2));
+    int o2 = hidden_cave_sign(hidden_cave_area(p1, q1, q2));
+    int o3 = hidden_cave_sign(hidden_cave_area(p2, q2, p1));
+    int o4 = hidden_cave_sign(hidden_cave_area(p2, q2, q1));
+    if(o1 != o2 && o3 != o4) {
+        return true;
+    }
+    return (o1 == 0 && hidden_cave_on_segment(p1, p2, q1)) ||
+           (o2 == 0 && hidden_cave_on_segment(p1, q2, q1)) ||
+           (o3 == 0 && hidden_cave_on_segment(p2, p1, q2)) ||
+           (o4 == 0 && hidden_cave_on_segment(p2, q1, q2));
+}
+
+//whether the diagonal ab crosses any edge of the ring
+static bool hidden_cave_intersects_polygon(hidden_cave_Ear_Clipper const* ec, uint32_t a, uint32_t b) {
+    uint32_t p = a;
+    do {
+        uint32_t n = N(p)->next;
+        if(N(p)->i != N(a)->i && N(n)->i != N(a)->i && N(p)->i != N(b)->i && N(n)->i != N(b)->i &&
+           hidden_cave_intersects(N(p), N(n), N(a), N(b))) {
+            return true;
+        }
+        p = n;
+    } while(p != a);
+    return false;
+}
+
+//whether the diagonal ab starts off inside the polygon at a
+static bool hidden_cave_locally_inside(hidden_cave_Ear_Clipper const* ec, uint32_t ai, uint32_t bi) {
+    hidden_cave_PolyTri_Node const* a = N(ai);
+    hidden_cave_PolyTri_Node const* b = N(bi);
+    hidden_cave_PolyTri_Node const* prev = N(a->prev);
+    hidden_cave_PolyTri_Node const* next = N(a->next);
+    return hidden_cave_area(prev, a, next) < 0 ?
+           hidden_cave_area(a, b, next) >= 0 && hidden_cave_area(a, prev, b) >= 0 :
+           hidden_cave_area(a, b, prev) < 0 || hidden_cave_area(a, next, b) < 0;
+}
+
+//whether the midpoint of ab is inside the polygon, by counting crossings of a horizontal ray
+static bool hidden_cave_middle_inside(hidden_cave_Ear_Clipper const* ec, uint32_t a, uint32_t b) {
+    uint32_t p = a;
+    bool inside = false;
+    double px = ((double) N(a)->x + N(b)->x) / 2;
+    double py = ((double) N(a)->y + N(b)->y) / 2;
+    do {
+        hidden_cave_PolyTri_Node const* s = N(p);
+        hidden_cave_PolyTri_Node const* t = N(s->next);
+        if(((s->y > py) != (t->y > py)) && t->y != s->y &&
+           (px < ((double) t->x - s->x) * (py - s->y) / ((double) t->y - s->y) + s->x)) {
+            inside = !inside;
+        }
+        p = s->next;
+    } while(p != a);
+    return inside;
+}
+
+static bool hidden_cave_is_valid_diagonal(hidden_cave_Ear_Clipper const* ec, uint32_t a, uint32_t b) {
+    hidden_cave_PolyTri_Node const* na = N(a);
+    hidden_cave_PolyTri_Node const* nb = N(b);
+    if(N(na->next)->i == nb->i || N(na->prev)->i == nb->i || hidden_cave_intersects_polygon(ec, a, b)) {
+        return false;
+    }
+    //locally visible, and not creating opposite facing sectors
+    if(hidden_cave_locally_inside(ec, a, b) && hidden_cave_locally_inside(ec, b, a) &&
+       hidden_cave_middle_inside(ec, a, b) &&
+       (hidden_cave_area(N(na->prev), na, N(nb->prev)) != 0 || hidden_cave_area(na, N(nb->prev), nb) != 0)) {
+        return true;
+    }
+    //the special case of a zero length diagonal between two convex corners
+    return hidden_cave_equals(na, nb) && hidden_cave_area(N(na->prev), na, N(na->next)) > 0 &&
+           hidden_cave_area(N(nb->prev), nb, N(nb->next)) > 0;
+}
+
+//links a to b with a diagonal, splitting the ring in two. Returns the duplicate of b that starts the
+//second ring.
+static uint32_t hidden_cave_split_polygon(hidden_cave_Ear_Clipper* ec, uint32_t a, uint32_t b) {
+    uint32_t a2 = hidden_cave_create_node(ec, N(a)->i, N(a)->x, N(a)->y);
+    uint32_t b2 = hidden_cave_create_node(ec, N(b)->i, N(b)->x, N(b)->y);
+    uint32_t an = N(a)->next;
+    uint32_t bp = N(b)->prev;
+
+    N(a)->next = b;
+    N(b)->prev = a;
+    N(a2)->next = an;
+    N(an)->prev = a2;
+    N(b2)->next = a2;
+    N(a2)->prev = b2;
+    N(bp)->next = b2;
+    N(b2)->prev = bp;
+    return b2;
+}
+
+//clips off small self intersections: where a, p, p.next, b has edges ap and (p.next)b crossing,
+//the triangle a, p, b is emitted and p and p.next removed
+static uint32_t hidden_cave_cure_local_intersections(hidden_cave_Ear_Clipper* ec, uint32_t start) {
+    uint32_t p = start;
+    do {
+        uint32_t a = N(p)->prev;
+        uint32_t b = N(N(p)->next)->next;
+        if(!hidden_cave_equals(N(a), N(b)) && hidden_cave_intersects(N(a), N(p), N(N(p)->next), N(b)) &&
+           hidden_cave_locally_inside(ec, a, b) && hidden_cave_locally_inside(ec, b, a)) {
+            hidden_cave_emit(ec, a, p, b);
+            hidden_cave_remove_node(ec, p);
+            hidden_cave_remove_node(ec, N(p)->next);
+            p = start = b;
+        }
+        p = N(p)->next;
+    } while(p != start);
+    return hidden_cave_filter_points(ec, p, CAVE_POLYTRI_NIL);
+}
+
+static void hidden_cave_ear_clip_linked(hidden_cave_Ear_Clipper* ec, uint32_t ear, int pass);
+
+//the last resort: finds any valid diagonal, splits the ring along it and clips each half separately
+static void hidden_cave_split_ear_clip(hidden_cave_Ear_Clipper* ec, uint32_t start) {
+    uint32_t a = start;
+    do {
+        uint32_t b = N(N(a)->next)->next;
+        while(b != N(a)->prev) {
+            if(N(a)->i != N(b)->i && hidden_cave_is_valid_diagonal(ec, a, b)) {
+                uint32_t c = hidden_cave_split_polygon(ec, a, b);
+                a = hidden_cave_filter_points(ec, a, N(a)->next);
+                c = hidden_cave_filter_points(ec, c, N(c)->next);
+                hidden_cave_ear_clip_linked(ec, a, 0);
+                hidden_cave_ear_clip_linked(ec, c, 0);
+                return;
+            }
+            b = N(b)->next;
+        }
+        a = N(a)->next;
+    } while(a != start);
+}
+
+//links `node` into the candidate list just before (or after) `at`
+static void hidden_cave_add_candidate(hidden_cave_Ear_Clipper* ec, uint32_t node, uint32_t at, bool before) {
+    if(N(node)->candidate) {
+        return;
+    }
+    uint32_t prev = before ? N(at)->prev_cand : at;
+    uint32_t next = before ? at : N(at)->next_cand;
+    N(node)->prev_cand = prev;
+    N(node)->next_cand = next;
+    N(prev)->next_cand = node;
+    N(next)->prev_cand = node;
+    N(node)->candidate = true;
+    ec->cand_count++;
+}
+
+static void hidden_cave_remove_candidate(hidden_cave_Ear_Clipper* ec, uint32_t node) {
+    N(N(node)->prev_cand)->next_cand = N(node)->next_cand;
+    N(N(node)->next_cand)->prev_cand = N(node)->prev_cand;
+    N(node)->candidate = false;
+    ec->cand_count--;
+}
+
+//clips ears off the ring containing `ear` until a single triangle is left. When a full lap finds no ear,
+//the ring is cleaned up and retried, then self intersections are cured, and finally it is split in two.
+//
+//Laps run over a second list of candidate corners in ring order. A reflex corner can only become an
+//ear once one of its neighbours is clipped, so reflex corners drop out of the list until then. Without
+//this, a long concave stretch gets walked on every lap while being eaten from its ends one corner at a time.
+static void hidden_cave_ear_clip_linked(hidden_cave_Ear_Clipper* ec, uint32_t ear, int pass) {
+    if(ear == CAVE_POLYTRI_NIL) {
+        return;
+    }
+    if(pass == 0 && ec->hashed) {
+        hidden_cave_index_curve(ec, ear);
+    }
+    uint32_t p = ear;
+    ec->cand_count = 0;
+    do {
+        N(p)->prev_cand = N(p)->prev;
+        N(p)->next_cand = N(p)->next;
+        N(p)->candidate = true;
+        ec->cand_count++;
+        p = N(p)->next;
+    } while(p != ear);
+
+    //the number of candidates looked at since an ear was last clipped
+    size_t fruitless = 0;
+    while(N(ear)->prev != N(ear)->next) {
+        uint32_t prev = N(ear)->prev;
+        uint32_t next = N(ear)->next;
+        uint32_t following = N(ear)->next_cand;
+        if(hidden_cave_area(N(prev), N(ear), N(next)) >= 0) {
+            hidden_cave_remove_candidate(ec, ear);
+        } else if(ec->hashed ? hidden_cave_is_ear_hashed(ec, ear) : hidden_cave_is_ear(ec, ear)) {
+            hidden_cave_emit(ec, prev, ear, next);
+            hidden_cave_add_candidate(ec, prev, ear, true);
+            hidden_cave_add_candidate(ec, next, ear, false);
+            hidden_cave_remove_candidate(ec, ear);
+            hidden_cave_remove_node(ec, ear);
+            if(ec->hashed) {
+                hidden_cave_compact_z_entries(ec);
+            }
+            //skipping the next vertex leads to fewer sliver triangles
+            ear = N(next)->next_cand;
+            fruitless = 0;
+            continue;
+        } else {
+            fruitless++;
+        }
+        ear = following;
+        if(ec->cand_count == 0 || fruitless >= ec->cand_count) {
+            if(pass == 0) {
+                hidden_cave_ear_clip_linked(ec, hidden_cave_filter_points(ec, ear, CAVE_POLYTRI_NIL), 1);
+            } else if(pass == 1) {
+                ear = hidden_cave_cure_local_intersections(
+                        ec, hidden_cave_filter_points(ec, ear, CAVE_POLYTRI_NIL));
+                hidden_cave_ear_clip_linked(ec, ear, 2);
+            } else {
+                hidden_cave_split_ear_clip(ec, ear);
+            }
+            break;
+        }
+    }
+}
+
+CaveError hidden_cave_polytri_validate_points(cave_2Point const* points, size_t point_count) {
+    if(!points && point_count != 0) {
+        return CAVE_DATA_ERROR;
+    }
+    if(point_count > CAVE_POLYTRI_MAX_POINTS) {
+        return CAVE_DATA_ERROR;
+    }
+    for(size_t i = 0; i < point_count; i++) {
+        if(!isfinite(points[i].x) || !isfinite(points[i].y)) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError hidden_cave_polytri_validate_polygon(cave_2d_Polygon const* polygon) {
+    if(!polygon || (polygon->ring_count != 0 && !polygon->ring_offsets)) {
+        return CAVE_DATA_ERROR;
+    }
+    if(polygon->ring_count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    size_t const* offsets = polygon->ring_offsets;
+    for(size_t r = 0; r < polygon->ring_count; r++) {
+        if(offsets[r] > offsets[r + 1]) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+    //indexes into `points` have to fit the same bound as a single ring
+    if(offsets[polygon->ring_count] > CAVE_POLYTRI_MAX_POINTS) {
+        return CAVE_DATA_ERROR;
+    }
+    size_t first = offsets[0];
+    return hidden_cave_polytri_validate_points(polygon->points ? polygon->points + first : NULL,
+                                               offsets[polygon->ring_count] - first);
+}
+
+//sets up hashing over the bounding box of `points`, if `total_count` points are enough to be worth it
+static void hidden_cave_setup_hash(hidden_cave_Ear_Clipper* ec, cave_2Point const* points, size_t point_count,
+                                   size_t total_count) {
+    ec->hashed = false;
+    if(total_count <= CAVE_POLYTRI_HASH_THRESHOLD || point_count == 0) {
+        return;
+    }
+    double min_x = points[0].x, min_y = points[0].y;
+    double max_x = min_x, max_y = min_y;
+    for(size_t i = 1; i < point_count; i++) {
+        min_x = points[i].x < min_x ? points[i].x : min_x;
+        min_y = points[i].y < min_y ? points[i].y : min_y;
+        max_x = points[i].x > max_x ? points[i].x : max_x;
+        max_y = points[i].y > max_y ? points[i].y : max_y;
+    }
+    double size = max_x - min_x > max_y - min_y ? max_x - min_x : max_y - min_y;
+    ec->min_x = min_x;
+    ec->min_y = min_y;
+    ec->inv_size = size != 0 ? 32767.0 / size : 0.0;
+    ec->hashed = size != 0;
+}
+
+//Holes are joined to the outline one at a time, from left to right, by a bridge from the hole's leftmost
+//point to a visible point of the outline (which by then includes every hole joined before it). Finding that
+//point means casting a ray left from the hole and looking for outline points near where it lands. Rather
+//than walk the whole outline for every hole, the outline's edges are kept in a uniform grid, so both
+//searches only visit the cells around the bridge, and the cost over all holes is dominated by sorting them.
+
+typedef struct hidden_cave_Bridge_Grid {
+    double min_x;
+    double min_y;
+    double cell;
+    double inv_cell;
+    uint32_t cols;
+    uint32_t rows;
+    uint32_t* heads; //first entry of each cell's list
+    uint32_t* entries; //pairs of (node starting an edge, next entry in the cell)
+    size_t entry_count;
+    size_t entry_cap;
+    hidden_cave_PolyTri_Scratch* scratch;
+} hidden_cave_Bridge_Grid;
+
+static uint32_t hidden_cave_grid_col(hidden_cave_Bridge_Grid const* g, double x) {
+    double c = floor((x - g->min_x) * g->inv_cell);
+    return c < 0 ? 0 : c >= g->cols ? g->cols - 1 : (uint32_t) c;
+}
+
+static uint32_t hidden_cave_grid_row(hidden_cave_Bridge_Grid const* g, double y) {
+    double r = floor((y - g->min_y) * g->inv_cell);
+    return r < 0 ? 0 : r >= g->rows ? g->rows - 1 : (uint32_t) r;
+}
+
+static CaveError hidden_cave_grid_add(hidden_cave_Bridge_Grid* g, uint32_t cell, uint32_t node) {
+    if(g->entry_count == g->entry_cap) {
+        size_t cap = g->entry_cap * 2;
+        uint32_t* entries = hidden_cave_polytri_reserve(g->scratch, CAVE_POLYTRI_SCRATCH_GRID_ENTRIES,
+                                                        sizeof(uint32_t) * 2 * cap);
+        if(!entries) {
+            return CAVE_INSUFFICIENT_MEMORY_ERROR;
+        }
+        g->entries = entries;
+        g->entry_cap = cap;
+    }
+    g->entries[2 * g->entry_count] = node;
+    g->entries[2 * g->entry_count + 1] = g->heads[cell];
+    g->heads[cell] = (uint32_t) g->entry_count++;
+    return CAVE_NO_ERROR;
+}
+
+//registers the edge from `node` to its next node in every cell the edge passes through
+static CaveError hidden_cave_grid_insert_edge(hidden_cave_Bridge_Grid* g, hidden_cave_Ear_Clipper const* ec,
+                                              uint32_t node) {
+    hidden_cave_PolyTri_Node const* a = N(node);
+    hidden_cave_PolyTri_Node const* b = N(a->next);
+    double lo_y = fmin(a->y, b->y), hi_y = fmax(a->y, b->y);
+    uint32_t row_lo = hidden_cave_grid_row(g, lo_y), row_hi = hidden_cave_grid_row(g, hi_y);
+    //a little slack, so rounding never leaves out a cell the edge touches
+    double slack = g->cell * 1e-3;
+    for(uint32_t row = row_lo; row <= row_hi; row++) {
+        double x0 = a->x, x1 = b->x;
+        if(a->y != b->y) {
+            double band_lo = fmax(lo_y, g->min_y + row * g->cell);
+            double band_hi = fmin(hi_y, g->min_y + (row + 1) * g->cell);
+            double inv_dy = 1.0 / ((double) b->y - a->y);
+            x0 = a->x + (band_lo - a->y) * inv_dy * ((double) b->x - a->x);
+            x1 = a->x + (band_hi - a->y) * inv_dy * ((double) b->x - a->x);
+        }
+        uint32_t col_lo = hidden_cave_grid_col(g, fmin(x0, x1) - slack);
+        uint32_t col_hi = hidden_cave_grid_col(g, fmax(x0, x1) + slack);
+        for(uint32_t col = col_lo; col <= col_hi; col++) {
+            CaveError err = hidden_cave_grid_add(g, row * g->cols + col, node);
+            if(err != CAVE_NO_ERROR) {
+                return err;
+            }
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+//grid entries aren't updated as points are filtered out. A removed node's edge was merged into the edge of
+//the node before it, so that is the edge the entry stands for now.
+static uint32_t hidden_cave_grid_resolve(hidden_cave_Ear_Clipper const* ec, uint32_t node) {
+    while(N(node)->removed) {
+        node = N(node)->prev;
+    }
+    return node;
+}
+
+static bool hidden_cave_sector_contains_sector(hidden_cave_Ear_Clipper const* ec, uint32_t m, uint32_t p) {
+    return hidden_cave_area(N(N(m)->prev), N(m), N(N(p)->prev)) < 0 &&
+           hidden_cave_area(N(N(p)->next), N(m), N(N(m)->next)) < 0;
+}
+
+//finds the outline point to bridge `hole` to, or NIL if there is none
+static uint32_t hidden_cave_find_hole_bridge(hidden_cave_Ear_Clipper const* ec, hidden_cave_Bridge_Grid const* g,
+                                             uint32_t hole) {
+    double hx = N(hole)->x, hy = N(hole)->y;
+    uint32_t row = hidden_cave_grid_row(g, hy);
+
+    //a point of the outline right on the hole's leftmost point is the bridge
+    for(uint32_t e = g->heads[row * g->cols + hidden_cave_grid_col(g, hx)]; e != CAVE_POLYTRI_NIL;
+        e = g->entries[2 * e + 1]) {
+        uint32_t p = g->entries[2 * e];
+        if(!N(p)->removed && N(p)->bridged && hidden_cave_equals(N(p), N(hole))) {
+            return p;
+        }
+    }
+
+    //cast a ray left, finding the closest edge it crosses and that edge's leftmost end
+    double qx = -INFINITY;
+    uint32_t m = CAVE_POLYTRI_NIL;
+    for(uint32_t col = hidden_cave_grid_col(g, hx) + 1; col-- > 0;) {
+        for(uint32_t e = g->heads[row * g->cols + col]; e != CAVE_POLYTRI_NIL; e = g->entries[2 * e + 1]) {
+            uint32_t pi = hidden_cave_grid_resolve(ec, g->entries[2 * e]);
+            hidden_cave_PolyTri_Node const* p = N(pi);
+            hidden_cave_PolyTri_Node const* pn = N(p->next);
+            if(!p->bridged || !(hy <= p->y && hy >= pn->y && pn->y != p->y)) {
+                continue;
+            }
+            double x = p->x + (hy - p->y) * ((double) pn->x - p->x) / ((double) pn->y - p->y);
+            if(x <= hx && x > qx) {
+                qx = x;
+                m = p->x < pn->x ? pi : p->next;
+                if(x == hx) {
+                    //the hole touches the edge, at `m` or on its way there
+                    return m;
+                }
+            }
+        }
+        //edges in cells further left cross the ray further left
+        if(m != CAVE_POLYTRI_NIL && qx >= g->min_x + col * g->cell) {
+            break;
+        }
+    }
+    if(m == CAVE_POLYTRI_NIL) {
+        return m;
+    }
+
+    //look for points of the outline inside the triangle between the hole, the crossing and `m`, which
+    //could block the bridge. If there are any, the one making the smallest angle with the ray is the
+    //bridge instead.
+    double mx = N(m)->x, my = N(m)->y;
+    double tan_min = INFINITY;
+    uint32_t row_lo = hidden_cave_grid_row(g, fmin(hy, my)), row_hi = hidden_cave_grid_row(g, fmax(hy, my));
+    uint32_t col_lo = hidden_cave_grid_col(g, mx), col_hi = hidden_cave_grid_col(g, hx);
+    uint32_t best = m;
+    for(uint32_t r = row_lo; r <= row_hi; r++) {
+        for(uint32_t c = col_lo; c <= col_hi; c++) {
+            for(uint32_t e = g->heads[r * g->cols + c]; e != CAVE_POLYTRI_NIL; e = g->entries[2 * e + 1]) {
+                uint32_t pi = g->entries[2 * e];
+                hidden_cave_PolyTri_Node const* p = N(pi);
+                if(p->removed || !p->bridged || !(hx >= p->x && p->x >= mx && hx != p->x) ||
+                   !hidden_cave_point_in_triangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy,
+                                                  p->x, p->y)) {
+                    continue;
+                }
+                double tan = fabs(hy - p->y) / (hx - p->x);
+                if(hidden_cave_locally_inside(ec, pi, hole) &&
+                   (tan < tan_min || (tan == tan_min && (p->x > N(best)->x ||
+                                                         (p->x == N(best)->x &&
+                                                          hidden_cave_sector_contains_sector(ec, best, pi)))))) {
+                    best = pi;
+                    tan_min = tan;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+//removes repeated and collinear points around `p`. Unlike `hidden_cave_filter_points()`, which walks the
+//whole ring, this only goes as far as removals reach, so joining each hole costs the same however many
+//were joined before it. Returns a node still in the ring.
+static uint32_t hidden_cave_filter_near(hidden_cave_Ear_Clipper* ec, uint32_t p) {
+    uint32_t at = N(p)->prev;
+    //the node before `p`, `p` and the one after it all have to pass in a row
+    int clean = 0;
+    while(clean < 3 && N(at)->next != N(at)->prev) {
+        if(!N(at)->steiner && (hidden_cave_equals(N(at), N(N(at)->next)) ||
+                               hidden_cave_area(N(N(at)->prev), N(at), N(N(at)->next)) == 0)) {
+            uint32_t prev = N(at)->prev;
+            hidden_cave_remove_node(ec, at);
+            at = N(prev)->prev;
+            clean = 0;
+        } else {
+            at = N(at)->next;
+            clean++;
+        }
+    }
+    return at;
+}
+
+typedef struct hidden_cave_Hole_Start {
+    double x;
+    double y;
+    double slope;
+    uint32_t node;
+} hidden_cave_Hole_Start;
+
+//orders holes by their leftmost point, and where that's shared, by the slope of the edge leaving it
+static int hidden_cave_compare_hole_starts(void const* a, void const* b) {
+    hidden_cave_Hole_Start const* ha = a;
+    hidden_cave_Hole_Start const* hb = b;
+    if(ha->x != hb->x) {
+        return ha->x < hb->x ? -1 : 1;
+    }
+    if(ha->y != hb->y) {
+        return ha->y < hb->y ? -1 : 1;
+    }
+    return ha->slope < hb->slope ? -1 : ha->slope > hb->slope;
+}
+
+static uint32_t hidden_cave_leftmost(hidden_cave_Ear_Clipper const* ec, uint32_t start) {
+    uint32_t p = start, leftmost = start;
+    do {
+        if(N(p)->x < N(leftmost)->x || (N(p)->x == N(leftmost)->x && N(p)->y < N(leftmost)->y)) {
+            leftmost = p;
+        }
+        p = N(p)->next;
+    } while(p != start);
+    return leftmost;
+}
+
+//joins every hole in `holes` to the ring holding `*outer`, leaving `*outer` on the joined ring
+static CaveError hidden_cave_eliminate_holes(hidden_cave_Ear_Clipper* ec, uint32_t* outer, uint32_t const* holes,
+                                             size_t hole_count, size_t point_count) {
+    if(hole_count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    hidden_cave_Hole_Start* queue = hidden_cave_polytri_reserve(ec->scratch, CAVE_POLYTRI_SCRATCH_HOLE_STARTS,
+                                                                sizeof(hidden_cave_Hole_Start) * hole_count);
+    hidden_cave_Bridge_Grid g = {0};
+    g.scratch = ec->scratch;
+    //about two points per cell
+    size_t target_cells = point_count / 2 + 1;
+    double min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+    for(uint32_t i = 0; i < ec->node_count; i++) {
+        min_x = fmin(min_x, N(i)->x);
+        min_y = fmin(min_y, N(i)->y);
+        max_x = fmax(max_x, N(i)->x);
+        max_y = fmax(max_y, N(i)->y);
+    }
+    double w = max_x - min_x, h = max_y - min_y;
+    double cell = w > 0 && h > 0 ? sqrt(w * h / (double) target_cells) : fmax(w, h) / (double) target_cells;
+    if(!(cell > 0)) {
+        cell = 1.0;
+    }
+    g.min_x = min_x;
+    g.min_y = min_y;
+    g.cell = cell;
+    g.inv_cell = 1.0 / cell;
+    g.cols = (uint32_t) fmin(floor(w / cell) + 1, (double) target_cells);
+    g.rows = (uint32_t) fmin(floor(h / cell) + 1, (double) target_cells);
+    g.heads = hidden_cave_polytri_reserve(ec->scratch, CAVE_POLYTRI_SCRATCH_GRID_HEADS,
+                                          sizeof(uint32_t) * (size_t) g.cols * g.rows);
+    g.entry_cap = 2 * point_count + 16;
+    g.entries = hidden_cave_polytri_reserve(ec->scratch, CAVE_POLYTRI_SCRATCH_GRID_ENTRIES,
+                                            sizeof(uint32_t) * 2 * g.entry_cap);
+    if(!queue || !g.heads || !g.entries) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    //the slot may already be bigger than asked for
+    g.entry_cap = ec->scratch->caps[CAVE_POLYTRI_SCRATCH_GRID_ENTRIES] / (2 * sizeof(uint32_t));
+    for(size_t c = 0; c < (size_t) g.cols * g.rows; c++) {
+        g.heads[c] = CAVE_POLYTRI_NIL;
+    }
+    CaveError err = CAVE_NO_ERROR;
+    for(uint32_t i = 0; i < ec->node_count && err == CAVE_NO_ERROR; i++) {
+        if(!N(i)->removed) {
+            err = hidden_cave_grid_insert_edge(&g, ec, i);
+        }
+    }
+
+    for(size_t i = 0; i < hole_count; i++) {
+        uint32_t leftmost = hidden_cave_leftmost(ec, holes[i]);
+        hidden_cave_PolyTri_Node const* l = N(leftmost);
+        hidden_cave_PolyTri_Node const* n = N(l->next);
+        double dx = (double) n->x - l->x, dy = (double) n->y - l->y;
+        double slope = dx != 0 ? dy / dx : dy > 0 ? INFINITY : dy < 0 ? -INFINITY : 0.0;
+        queue[i] = (hidden_cave_Hole_Start) {l->x, l->y, slope, leftmost};
+    }
+    qsort(queue, hole_count, sizeof(hidden_cave_Hole_Start), hidden_cave_compare_hole_starts);
+
+    for(size_t i = 0; i < hole_count && err == CAVE_NO_ERROR; i++) {
+        uint32_t hole = queue[i].node;
+        uint32_t bridge = hidden_cave_find_hole_bridge(ec, &g, hole);
+        if(bridge == CAVE_POLYTRI_NIL) {
+            continue;
+        }
+        uint32_t p = hole;
+        do {
+            N(p)->bridged = true;
+            p = N(p)->next;
+        } while(p != hole);
+        //the hole's own edges went into the grid with everything else, and count from here on
+        uint32_t bridge_reverse = hidden_cave_split_polygon(ec, bridge, hole);
+        uint32_t bridge_copy = N(bridge_reverse)->next;
+        N(bridge_reverse)->bridged = true;
+        N(bridge_copy)->bridged = true;
+        //the bridge itself, both ways, and the outline edge that now leaves the copy of `bridge`
+        err = hidden_cave_grid_insert_edge(&g, ec, bridge);
+        if(err == CAVE_NO_ERROR) {
+            err = hidden_cave_grid_insert_edge(&g, ec, bridge_reverse);
+        }
+        if(err == CAVE_NO_ERROR) {
+            err = hidden_cave_grid_insert_edge(&g, ec, bridge_copy);
+        }
+        hidden_cave_filter_near(ec, bridge_reverse);
+        *outer = hidden_cave_filter_near(ec, bridge);
+    }
+    return err;
+}
+
+//ear clips the outline `outer`, a ring of `polygon`, with the rings in `holes` cut out of it
+static CaveError hidden_cave_ear_clip_outline(hidden_cave_Ear_Clipper* ec, cave_2d_Polygon const* polygon,
+                                              size_t outer, size_t const* holes, size_t hole_count) {
+    size_t const* offsets = polygon->ring_offsets;
+    size_t start = offsets[outer], end = offsets[outer + 1];
+    size_t total = end - start;
+    for(size_t i = 0; i < hole_count; i++) {
+        total += offsets[holes[i] + 1] - offsets[holes[i]];
+    }
+    hidden_cave_setup_hash(ec, polygon->points + start, end - start, total);
+    ec->node_count = 0;
+
+    uint32_t outer_node = hidden_cave_linked_ring(ec, polygon->points, start, end, true);
+    if(outer_node == CAVE_POLYTRI_NIL || N(outer_node)->next == N(outer_node)->prev) {
+        return CAVE_NO_ERROR;
+    }
+    for(uint32_t i = 0; i < ec->node_count; i++) {
+        N(i)->bridged = true;
+    }
+    if(hole_count > 0) {
+        uint32_t* hole_nodes = hidden_cave_polytri_reserve(ec->scratch, CAVE_POLYTRI_SCRATCH_HOLES,
+                                                           sizeof(uint32_t) * hole_count);
+        if(!hole_nodes) {
+            return CAVE_INSUFFICIENT_MEMORY_ERROR;
+        }
+        size_t linked = 0;
+        for(size_t i = 0; i < hole_count; i++) {
+            uint32_t list = hidden_cave_linked_ring(ec, polygon->points, offsets[holes[i]], offsets[holes[i] + 1], false);
+            if(list == CAVE_POLYTRI_NIL) {
+                continue;
+            }
+            if(list == N(list)->next) {
+                N(list)->steiner = true;
+            }
+            hole_nodes[linked++] = list;
+        }
+        CaveError err = hidden_cave_eliminate_holes(ec, &outer_node, hole_nodes, linked, total);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+    }
+    hidden_cave_ear_clip_linked(ec, outer_node, 0);
+    return CAVE_NO_ERROR;
+}
+
+//twice the signed area of ring `r` of `polygon`, and its bounding box
+static double hidden_cave_ring_area(cave_2d_Polygon const* polygon, size_t r, double* box) {
+    cave_2Point const* points = polygon->points;
+    size_t start = polygon->ring_offsets[r], end = polygon->ring_offsets[r + 1];
+    box[0] = box[1] = INFINITY;
+    box[2] = box[3] = -INFINITY;
+    if(end - start < 3) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for(size_t i = start, j = end - 1; i < end; j = i++) {
+        sum += (double) points[j].x * points[i].y - (double) points[i].x * points[j].y;
+        box[0] = fmin(box[0], points[i].x);
+        box[1] = fmin(box[1], points[i].y);
+        box[2] = fmax(box[2], points[i].x);
+        box[3] = fmax(box[3], points[i].y);
+    }
+    return sum;
+}
+
+static bool hidden_cave_ring_contains(cave_2d_Polygon const* polygon, size_t r, cave_2Point q) {
+    cave_2Point const* points = polygon->points;
+    size_t start = polygon->ring_offsets[r], end = polygon->ring_offsets[r + 1];
+    bool inside = false;
+    for(size_t i = start, j = end - 1; i < end; j = i++) {
+        cave_2Point a = points[i], b = points[j];
+        if((a.y > q.y) != (b.y > q.y) &&
+           q.x < ((double) b.x - a.x) * ((double) q.y - a.y) / ((double) b.y - a.y) + a.x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+//takes `bytes` bytes from the end of what `arena` has handed out, aligned for any type the ear clipper keeps,
+//or returns NULL if they don't fit
+static void* hidden_cave_arena_take(cave_PolyTri_Arena* arena, size_t bytes) {
+    size_t misalign = ((uintptr_t) arena->memory + arena->used) % 16;
+    size_t start = arena->used + (misalign > 0 ? 16 - misalign : 0);
+    size_t end = bytes <= SIZE_MAX - start ? start + bytes : SIZE_MAX;
+    arena->peak = end > arena->peak ? end : arena->peak;
+    if(!arena->memory || end > arena->capacity) {
+        return NULL;
+    }
+    arena->used = end;
+    return (char*) arena->memory + start;
+}
+
+void* hidden_cave_polytri_reserve(hidden_cave_PolyTri_Scratch* scratch, int slot, size_t bytes) {
+    if(bytes > scratch->caps[slot] || !scratch->buffers[slot]) {
+        size_t cap = scratch->caps[slot] * 2;
+        cap = cap > bytes ? cap : bytes;
+        cap = cap > 0 ? cap : 1;
+        void* buffer;
+        if(scratch->arena) {
+            //what the slot held is left behind in the arena, which gets it all back at the end of the call
+            buffer = hidden_cave_arena_take(scratch->arena, cap);
+            if(buffer && scratch->buffers[slot]) {
+                memcpy(buffer, scratch->buffers[slot], scratch->caps[slot]);
+            }
+        } else {
+            buffer = realloc(scratch->buffers[slot], cap);
+        }
+        if(!buffer) {
+            return NULL;
+        }
+        scratch->buffers[slot] = buffer;
+        scratch->caps[slot] = cap;
+    }
+    return scratch->buffers[slot];
+}
+
+void hidden_cave_polytri_release(hidden_cave_PolyTri_Scratch* scratch) {
+    for(int slot = 0; slot < CAVE_POLYTRI_SCRATCH_COUNT; slot++) {
+        if(!scratch->arena) {
+            free(scratch->buffers[slot]);
+        }
+        scratch->buffers[slot] = NULL;
+        scratch->caps[slot] = 0;
+    }
+}
+
+void hidden_cave_polytri_put(hidden_cave_PolyTri_Out* out, size_t a, size_t b, size_t c) {
+    if(out->count == out->cap && out->emit) {
+        hidden_cave_polytri_flush(out);
+    }
+    out->total++;
+    if(out->count < out->cap) {
+        cave_Index_Triangle* t = out->tris + out->count++;
+        t->a = a + out->offset;
+        t->b = b + out->offset;
+        t->c = c + out->offset;
+    }
+}
+
+CaveError hidden_cave_polytri_flush(hidden_cave_PolyTri_Out* out) {
+    if(out->emit && out->count > 0) {
+        if(out->err == CAVE_NO_ERROR) {
+            out->err = out->emit(out->user, out->tris, out->count);
+        }
+        out->count = 0;
+    }
+    return out->err;
+}
+
+CaveError hidden_cave_polytri_sink_start(cave_PolyTri_Sink* sink, hidden_cave_PolyTri_Out* out,
+                                         cave_Index_Triangle* batch) {
+    if(!sink) {
+        return CAVE_DATA_ERROR;
+    }
+    sink->tri_count = 0;
+    if(!sink->emit && !sink->buffer && sink->capacity > 0) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_PolyTri_Out blank = {0};
+    *out = blank;
+    if(sink->emit) {
+        out->tris = batch;
+        out->cap = CAVE_POLYTRI_SINK_BATCH;
+        out->emit = sink->emit;
+        out->user = sink->user;
+    } else {
+        out->tris = sink->buffer;
+        out->cap = sink->capacity;
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError hidden_cave_polytri_sink_finish(cave_PolyTri_Sink* sink, hidden_cave_PolyTri_Out* out, CaveError err) {
+    sink->tri_count = out->total;
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    err = hidden_cave_polytri_flush(out);
+    if(err == CAVE_NO_ERROR && !out->emit && out->total > out->cap) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    return err;
+}
+
+size_t hidden_cave_polytri_tri_bound(cave_2d_Polygon const* polygon) {
+    if(polygon->ring_count == 0) {
+        return 0;
+    }
+    size_t point_count = polygon->ring_offsets[polygon->ring_count] - polygon->ring_offsets[0];
+    return point_count + 2 * polygon->ring_count;
+}
+
+//sets up `ec` to clip `point_count` points, `hole_count` of them in holes, into `out`.
+//Returns false if `scratch` can't be grown to fit.
+static bool hidden_cave_ear_clipper_start(hidden_cave_Ear_Clipper* ec, hidden_cave_PolyTri_Scratch* scratch,
+                                          hidden_cave_PolyTri_Out* out, size_t point_count, size_t hole_count) {
+    //each bridge adds two nodes, and every split adds two more to a ring of at least four, so splits can
+    //at most double the count after that
+    size_t nodes = 3 * (point_count + 2 * hole_count);
+    ec->scratch = scratch;
+    ec->out = out;
+    ec->node_cap = (uint32_t) nodes;
+    ec->nodes = hidden_cave_polytri_reserve(scratch, CAVE_POLYTRI_SCRATCH_NODES,
+                                            sizeof(hidden_cave_PolyTri_Node) * nodes);
+    if(!ec->nodes) {
+        return false;
+    }
+    if(point_count > CAVE_POLYTRI_HASH_THRESHOLD) {
+        ec->z_entries = hidden_cave_polytri_reserve(scratch, CAVE_POLYTRI_SCRATCH_Z_ENTRIES,
+                                                    sizeof(hidden_cave_Z_Entry) * nodes);
+        ec->z_scratch = hidden_cave_polytri_reserve(scratch, CAVE_POLYTRI_SCRATCH_Z_SORTING,
+                                                    sizeof(hidden_cave_Z_Entry) * nodes);
+        return ec->z_entries && ec->z_scratch;
+    }
+    return true;
+}
+
+CaveError hidden_cave_polytri_ear_clip(hidden_cave_PolyTri_Scratch* scratch, cave_2d_Polygon const* polygon,
+                                       hidden_cave_PolyTri_Out* out) {
+    size_t ring_count = polygon->ring_count;
+    size_t point_count = ring_count > 0 ? polygon->ring_offsets[ring_count] - polygon->ring_offsets[0] : 0;
+    if(point_count < 3) {
+        return CAVE_NO_ERROR;
+    }
+
+    //sort the rings into outlines and holes, and find the outline each hole is in
+    double* areas = hidden_cave_polytri_reserve(scratch, CAVE_POLYTRI_SCRATCH_RINGS, sizeof(double) * 5 * ring_count);
+    size_t* owner = hidden_cave_polytri_reserve(scratch, CAVE_POLYTRI_SCRATCH_RING_OWNERS,
+                                                sizeof(size_t) * (3 * ring_count + 1));
+    if(!areas || !owner) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    double* boxes = areas + ring_count;
+    size_t* by_owner = owner + ring_count;
+    size_t* owner_start = by_owner + ring_count;
+    size_t outline_count = 0, last_outline = 0, hole_count = 0;
+    for(size_t r = 0; r < ring_count; r++) {
+        areas[r] = hidden_cave_ring_area(polygon, r, boxes + 4 * r);
+        owner_start[r] = 0;
+        if(areas[r] > 0) {
+            outline_count++;
+            last_outline = r;
+        }
+    }
+    owner_start[ring_count] = 0;
+    for(size_t r = 0; r < ring_count; r++) {
+        owner[r] = SIZE_MAX;
+        if(areas[r] >= 0) {
+            continue;
+        }
+        if(outline_count == 1) {
+            owner[r] = last_outline;
+        } else {
+            //the smallest outline around the hole's first point
+            cave_2Point q = polygon->points[polygon->ring_offsets[r]];
+            for(size_t o = 0; o < ring_count; o++) {
+                double const* box = boxes + 4 * o;
+                if(areas[o] <= 0 || q.x < box[0] || q.y < box[1] || q.x > box[2] || q.y > box[3] ||
+                   (owner[r] != SIZE_MAX && areas[o] >= areas[owner[r]]) || !hidden_cave_ring_contains(polygon, o, q)) {
+                    continue;
+                }
+                owner[r] = o;
+            }
+        }
+        if(owner[r] != SIZE_MAX) {
+            owner_start[owner[r] + 1]++;
+            hole_count++;
+        }
+    }
+    for(size_t r = 0; r < ring_count; r++) {
+        owner_start[r + 1] += owner_start[r];
+    }
+    for(size_t r = 0; r < ring_count; r++) {
+        if(owner[r] != SIZE_MAX) {
+            by_owner[owner_start[owner[r]]++] = r;
+        }
+    }
+    //filling in shifted every start along by one slot
+    for(size_t r = ring_count; r > 0; r--) {
+        owner_start[r] = owner_start[r - 1];
+    }
+    owner_start[0] = 0;
+
+    hidden_cave_Ear_Clipper ec = {0};
+    if(!hidden_cave_ear_clipper_start(&ec, scratch, out, point_count, hole_count)) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    CaveError err = CAVE_NO_ERROR;
+    for(size_t r = 0; r < ring_count && err == CAVE_NO_ERROR; r++) {
+        if(areas[r] > 0) {
+            err = hidden_cave_ear_clip_outline(&ec, polygon, r, by_owner + owner_start[r],
+                                               owner_start[r + 1] - owner_start[r]);
+        }
+    }
+    return err;
+}
+
+CaveError cave_polytri_triangulate(cave_Index_Triangle** dest, size_t* tri_count,
+                                   cave_2Point const* points, size_t point_count) {
+    if(!dest || !tri_count) {
+        return CAVE_DATA_ERROR;
+    }
+    *dest = NULL;
+    *tri_count = 0;
+    CaveError err = hidden_cave_polytri_validate_points(points, point_count);
+    if(err != CAVE_NO_ERROR || point_count < 3) {
+        return err;
+    }
+    //a lone ring is an outline whichever way it's wound, so it skips sorting rings into outlines and holes
+    size_t offsets[2] = {0, point_count};
+    cave_2d_Polygon polygon = {(cave_2Point*) points, offsets, 1};
+    size_t bound = hidden_cave_polytri_tri_bound(&polygon);
+    hidden_cave_PolyTri_Out out = {malloc(sizeof(cave_Index_Triangle) * bound), bound, 0, 0, 0, NULL, NULL,
+                                   CAVE_NO_ERROR};
+    hidden_cave_PolyTri_Scratch scratch;
+    memset(&scratch, 0, sizeof(scratch));
+    hidden_cave_Ear_Clipper ec = {0};
+    if(!out.tris || !hidden_cave_ear_clipper_start(&ec, &scratch, &out, point_count, 0)) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    } else {
+        err = hidden_cave_ear_clip_outline(&ec, &polygon, 0, NULL, 0);
+    }
+    hidden_cave_polytri_release(&scratch);
+    if(err != CAVE_NO_ERROR || out.count == 0) {
+        free(out.tris);
+        return err;
+    }
+    *dest = out.tris;
+    *tri_count = out.count;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_polytri_triangulate_polygon(cave_Index_Triangle** dest, size_t* tri_count,
+                                           cave_2d_Polygon const* polygon) {
+    if(!dest || !tri_count) {
+        return CAVE_DATA_ERROR;
+    }
+    *dest = NULL;
+    *tri_count = 0;
+    CaveError err = hidden_cave_polytri_validate_polygon(polygon);
+    if(err != CAVE_NO_ERROR || polygon->ring_count == 0) {
+        return err;
+    }
+    size_t bound = hidden_cave_polytri_tri_bound(polygon);
+    hidden_cave_PolyTri_Out out = {malloc(sizeof(cave_Index_Triangle) * bound), bound, 0, 0, 0, NULL, NULL,
+                                   CAVE_NO_ERROR};
+    if(!out.tris) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    hidden_cave_PolyTri_Scratch scratch;
+    memset(&scratch, 0, sizeof(scratch));
+    err = hidden_cave_polytri_ear_clip(&scratch, polygon, &out);
+    hidden_cave_polytri_release(&scratch);
+    if(err != CAVE_NO_ERROR || out.count == 0) {
+        free(out.tris);
+        return err;
+    }
+    *dest = out.tris;
+    *tri_count = out.count;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_polytri_triangulate_to_sink(cave_PolyTri_Sink* sink, cave_2d_Polygon const* polygon,
+                                           cave_PolyTri_Arena* arena) {
+    cave_Index_Triangle batch[CAVE_POLYTRI_SINK_BATCH];
+    hidden_cave_PolyTri_Out out;
+    CaveError err = hidden_cave_polytri_sink_start(sink, &out, batch);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    err = hidden_cave_polytri_validate_polygon(polygon);
+    if(err == CAVE_NO_ERROR && polygon->ring_count > 0) {
+        size_t mark = arena ? arena->used : 0;
+        hidden_cave_PolyTri_Scratch scratch;
+        memset(&scratch, 0, sizeof(scratch));
+        scratch.arena = arena;
+        err = hidden_cave_polytri_ear_clip(&scratch, polygon, &out);
+        hidden_cave_polytri_release(&scratch);
+        if(arena) {
+            arena->used = mark;
+        }
+    }
+    return hidden_cave_polytri_sink_finish(sink, &out, err);
+}
+
+CaveError cave_polytri_to_2d_Triangles(cave_2d_Triangle* dest, cave_Index_Triangle const* tris, size_t tri_count,
+                                       cave_2Point const* points, size_t point_count) {
+    if(tri_count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    if(!dest || !tris || !points) {
+        return CAVE_DATA_ERROR;
+    }
+    for(size_t i = 0; i < tri_count; i++) {
+        cave_Index_Triangle const* t = tris + i;
+        if(t->a >= point_count || t->b >= point_count || t->c >= point_count) {
+            return CAVE_INDEX_ERROR;
+        }
+        dest[i].a = points[t->a];
+        dest[i].b = points[t->b];
+        dest[i].c = points[t->c];
+    }
+    return CAVE_NO_ERROR;
+}
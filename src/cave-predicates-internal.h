@@ -0,0 +1,15 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_PREDICATES_INTERNAL_H
+#define CAVE_PREDICATES_INTERNAL_H
+
+//The predicates of cave-predicates.h over points given as pairs or triples of doubles, for code that keeps
+//its own coordinates, like the constrained Delaunay triangulator's outer triangle.
+
+double hidden_cave_orient2d(double const* pa, double const* pb, double const* pc);
+double hidden_cave_incircle(double const* pa, double const* pb, double const* pc, double const* pd);
+double hidden_cave_orient3d(double const* pa, double const* pb, double const* pc, double const* pd);
+
+#endif //CAVE_PREDICATES_INTERNAL_H
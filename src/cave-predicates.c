@@ -0,0 +1,511 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-predicates.h"
+#include "cave-predicates-internal.h"
+#include <float.h>
+#include <math.h>
+
+//Each predicate first evaluates its determinant in doubles and compares it against a bound on the rounding
+//error, which is a small multiple of the "permanent": the same sum with every term made positive. Past the
+//bound, the sign is right. Otherwise the determinant is rebuilt out of expansions: sums of doubles that
+//don't overlap, kept from smallest to largest, which represent a value exactly no matter how many bits it
+//needs. The error free transformations below produce them, and none of it works if the compiler fuses a
+//multiply and an add, which is why this file is built with contraction off.
+//
+//orient2d gets all of Shewchuk's adaptive stages, since it is the one called most, and on the hardest
+//inputs. incircle and orient3d go straight from the filter to the exact determinant, which is already cheap
+//for float input: the differences of floats are nearly always exact doubles, so every expansion stays short.
+
+#define CAVE_PREDICATES_EPSILON (DBL_EPSILON / 2)
+#define CAVE_PREDICATES_SPLITTER (134217729.0) //2^27 + 1, splits a double into two halves of 26 bits
+
+static double const hidden_cave_result_bound = (3.0 + 8.0 * CAVE_PREDICATES_EPSILON) * CAVE_PREDICATES_EPSILON;
+static double const hidden_cave_ccw_bound_a = (3.0 + 16.0 * CAVE_PREDICATES_EPSILON) * CAVE_PREDICATES_EPSILON;
+static double const hidden_cave_ccw_bound_b = (2.0 + 12.0 * CAVE_PREDICATES_EPSILON) * CAVE_PREDICATES_EPSILON;
+static double const hidden_cave_ccw_bound_c =
+        (9.0 + 64.0 * CAVE_PREDICATES_EPSILON) * CAVE_PREDICATES_EPSILON * CAVE_PREDICATES_EPSILON;
+static double const hidden_cave_o3d_bound_a = (7.0 + 56.0 * CAVE_PREDICATES_EPSILON) * CAVE_PREDICATES_EPSILON;
+static double const hidden_cave_icc_bound_a = (10.0 + 96.0 * CAVE_PREDICATES_EPSILON) * CAVE_PREDICATES_EPSILON;
+
+//results are worked out a block at a time by the batch functions, so the filter loops have no branches in them
+#define CAVE_PREDICATES_BLOCK (64)
+
+//x + y = a + b exactly, with x the rounded sum
+static void hidden_cave_two_sum(double a, double b, double* x, double* y) {
+    double sum = a + b;
+    double b_virtual = sum - a;
+    double a_virtual = sum - b_virtual;
+    *x = sum;
+    *y = (a - a_virtual) + (b - b_virtual);
+}
+
+//as `hidden_cave_two_sum()`, when |a| >= |b|
+static void hidden_cave_fast_two_sum(double a, double b, double* x, double* y) {
+    double sum = a + b;
+    *x = sum;
+    *y = b - (sum - a);
+}
+
+//the rounding error of x = a - b
+static double hidden_cave_two_diff_tail(double a, double b, double x) {
+    double b_virtual = a - x;
+    double a_virtual = x + b_virtual;
+    return (a - a_virtual) + (b_virtual - b);
+}
+
+static void hidden_cave_two_diff(double a, double b, double* x, double* y) {
+    *x = a - b;
+    *y = hidden_cave_two_diff_tail(a, b, *x);
+}
+
+static void hidden_cave_split(double a, double* hi, double* lo) {
+    double c = CAVE_PREDICATES_SPLITTER * a;
+    double big = c - a;
+    *hi = c - big;
+    *lo = a - *hi;
+}
+
+//x + y = a * b exactly, with x the rounded product
+static void hidden_cave_two_product(double a, double b, double* x, double* y) {
+    double a_hi, a_lo, b_hi, b_lo;
+    double product = a * b;
+    hidden_cave_split(a, &a_hi, &a_lo);
+    hidden_cave_split(b, &b_hi, &b_lo);
+    double err1 = product - a_hi * b_hi;
+    double err2 = err1 - a_lo * b_hi;
+    double err3 = err2 - a_hi * b_lo;
+    *x = product;
+    *y = a_lo * b_lo - err3;
+}
+
+//e = (a1 + a0) - (b1 + b0), as a four part expansion
+static void hidden_cave_two_two_diff(double a1, double a0, double b1, double b0, double* e) {
+    double i, j, zero;
+    hidden_cave_two_diff(a0, b0, &i, e);
+    hidden_cave_two_sum(a1, i, &j, &zero);
+    hidden_cave_two_diff(zero, b1, &i, e + 1);
+    hidden_cave_two_sum(j, i, e + 3, e + 2);
+}
+
+//h = e + f, dropping zero parts. h has room for elen + flen parts and is neither e nor f.
+static int hidden_cave_expansion_sum(int elen, double const* e, int flen, double const* f, double* h) {
+    int ei = 0, fi = 0, hi = 0;
+    double e_now = e[0], f_now = f[0];
+    double q, q_new, part;
+    if((f_now > e_now) == (f_now > -e_now)) {
+        q = e_now;
+        e_now = ++ei < elen ? e[ei] : 0.0;
+    } else {
+        q = f_now;
+        f_now = ++fi < flen ? f[fi] : 0.0;
+    }
+    if(ei < elen && fi < flen) {
+        if((f_now > e_now) == (f_now > -e_now)) {
+            hidden_cave_fast_two_sum(e_now, q, &q_new, &part);
+            e_now = ++ei < elen ? e[ei] : 0.0;
+        } else {
+            hidden_cave_fast_two_sum(f_now, q, &q_new, &part);
+            f_now = ++fi < flen ? f[fi] : 0.0;
+        }
+        q = q_new;
+        if(part != 0.0) {
+            h[hi++] = part;
+        }
+        while(ei < elen && fi < flen) {
+            if((f_now > e_now) == (f_now > -e_now)) {
+                hidden_cave_two_sum(q, e_now, &q_new, &part);
+                e_now = ++ei < elen ? e[ei] : 0.0;
+            } else {
+                hidden_cave_two_sum(q, f_now, &q_new, &part);
+                f_now = ++fi < flen ? f[fi] : 0.0;
+            }
+            q = q_new;
+            if(part != 0.0) {
+                h[hi++] = part;
+            }
+        }
+    }
+    while(ei < elen) {
+        hidden_cave_two_sum(q, e_now, &q_new, &part);
+        e_now = ++ei < elen ? e[ei] : 0.0;
+        q = q_new;
+        if(part != 0.0) {
+            h[hi++] = part;
+        }
+    }
+    while(fi < flen) {
+        hidden_cave_two_sum(q, f_now, &q_new, &part);
+        f_now = ++fi < flen ? f[fi] : 0.0;
+        q = q_new;
+        if(part != 0.0) {
+            h[hi++] = part;
+        }
+    }
+    if(q != 0.0 || hi == 0) {
+        h[hi++] = q;
+    }
+    return hi;
+}
+
+//h = e * b, dropping zero parts. h has room for 2 * elen parts and isn't e.
+static int hidden_cave_expansion_scale(int elen, double const* e, double b, double* h) {
+    int hi = 0;
+    double q, part, product1, product0, sum;
+    hidden_cave_two_product(e[0], b, &q, &part);
+    if(part != 0.0) {
+        h[hi++] = part;
+    }
+    for(int ei = 1; ei < elen; ei++) {
+        hidden_cave_two_product(e[ei], b, &product1, &product0);
+        hidden_cave_two_sum(q, product0, &sum, &part);
+        if(part != 0.0) {
+            h[hi++] = part;
+        }
+        hidden_cave_fast_two_sum(product1, sum, &q, &part);
+        if(part != 0.0) {
+            h[hi++] = part;
+        }
+    }
+    if(q != 0.0 || hi == 0) {
+        h[hi++] = q;
+    }
+    return hi;
+}
+
+//h = e * f. h has room for 2 * elen * flen parts, and so does `swap`, while `scaled` has room for 2 * elen.
+static int hidden_cave_expansion_product(int elen, double const* e, int flen, double const* f, double* h,
+                                         double* swap, double* scaled) {
+    int hlen = hidden_cave_expansion_scale(elen, e, f[0], h);
+    for(int fi = 1; fi < flen; fi++) {
+        int scaled_len = hidden_cave_expansion_scale(elen, e, f[fi], scaled);
+        int sum_len = hidden_cave_expansion_sum(hlen, h, scaled_len, scaled, swap);
+        for(int i = 0; i < sum_len; i++) {
+            h[i] = swap[i];
+        }
+        hlen = sum_len;
+    }
+    return hlen;
+}
+
+static void hidden_cave_expansion_negate(int elen, double* e) {
+    for(int i = 0; i < elen; i++) {
+        e[i] = -e[i];
+    }
+}
+
+//e = a - b, in one part when the difference is exact, which it usually is
+static int hidden_cave_expansion_diff(double a, double b, double* e) {
+    hidden_cave_two_diff(a, b, e + 1, e);
+    if(e[0] == 0.0) {
+        e[0] = e[1];
+        return 1;
+    }
+    return 2;
+}
+
+//h = p * q - r * s, for expansions of up to 2 parts. h has room for 16 parts.
+static int hidden_cave_expansion_minor(int plen, double const* p, int qlen, double const* q, int rlen,
+                                       double const* r, int slen, double const* s, double* h) {
+    double pq[8], rs[8], swap[8], scaled[4];
+    int pq_len = hidden_cave_expansion_product(plen, p, qlen, q, pq, swap, scaled);
+    int rs_len = hidden_cave_expansion_product(rlen, r, slen, s, rs, swap, scaled);
+    hidden_cave_expansion_negate(rs_len, rs);
+    return hidden_cave_expansion_sum(pq_len, pq, rs_len, rs, h);
+}
+
+static double hidden_cave_orient2d_adapt(double const* pa, double const* pb, double const* pc, double detsum) {
+    double acx = pa[0] - pc[0];
+    double bcx = pb[0] - pc[0];
+    double acy = pa[1] - pc[1];
+    double bcy = pb[1] - pc[1];
+
+    double det_left, det_left_tail, det_right, det_right_tail;
+    double b[4];
+    hidden_cave_two_product(acx, bcy, &det_left, &det_left_tail);
+    hidden_cave_two_product(acy, bcx, &det_right, &det_right_tail);
+    hidden_cave_two_two_diff(det_left, det_left_tail, det_right, det_right_tail, b);
+    double det = b[0] + b[1] + b[2] + b[3];
+    double bound = hidden_cave_ccw_bound_b * detsum;
+    if(det >= bound || -det >= bound) {
+        return det;
+    }
+
+    double acx_tail = hidden_cave_two_diff_tail(pa[0], pc[0], acx);
+    double bcx_tail = hidden_cave_two_diff_tail(pb[0], pc[0], bcx);
+    double acy_tail = hidden_cave_two_diff_tail(pa[1], pc[1], acy);
+    double bcy_tail = hidden_cave_two_diff_tail(pb[1], pc[1], bcy);
+    if(acx_tail == 0.0 && acy_tail == 0.0 && bcx_tail == 0.0 && bcy_tail == 0.0) {
+        return det;
+    }
+    bound = hidden_cave_ccw_bound_c * detsum + hidden_cave_result_bound * fabs(det);
+    det += (acx * bcy_tail + bcy * acx_tail) - (acy * bcx_tail + bcx * acy_tail);
+    if(det >= bound || -det >= bound) {
+        return det;
+    }
+
+    double s1, s0, t1, t0, u[4], c1[8], c2[12], d[16];
+    hidden_cave_two_product(acx_tail, bcy, &s1, &s0);
+    hidden_cave_two_product(acy_tail, bcx, &t1, &t0);
+    hidden_cave_two_two_diff(s1, s0, t1, t0, u);
+    int c1_len = hidden_cave_expansion_sum(4, b, 4, u, c1);
+    hidden_cave_two_product(acx, bcy_tail, &s1, &s0);
+    hidden_cave_two_product(acy, bcx_tail, &t1, &t0);
+    hidden_cave_two_two_diff(s1, s0, t1, t0, u);
+    int c2_len = hidden_cave_expansion_sum(c1_len, c1, 4, u, c2);
+    hidden_cave_two_product(acx_tail, bcy_tail, &s1, &s0);
+    hidden_cave_two_product(acy_tail, bcx_tail, &t1, &t0);
+    hidden_cave_two_two_diff(s1, s0, t1, t0, u);
+    int d_len = hidden_cave_expansion_sum(c2_len, c2, 4, u, d);
+    return d[d_len - 1];
+}
+
+//the exact sign of the incircle determinant, with every difference taken relative to `pd`
+static double hidden_cave_incircle_exact(double const* pa, double const* pb, double const* pc, double const* pd) {
+    double d[3][2][2];
+    int lens[3][2];
+    double const* points[3] = {pa, pb, pc};
+    for(int k = 0; k < 3; k++) {
+        for(int axis = 0; axis < 2; axis++) {
+            lens[k][axis] = hidden_cave_expansion_diff(points[k][axis], pd[axis], d[k][axis]);
+        }
+    }
+
+    //each term is the lift of one point times the minor of the other two
+    double minor[16], lift[16], xx[8], yy[8], swap[512], scaled[32];
+    double terms[3][512];
+    int term_lens[3];
+    for(int k = 0; k < 3; k++) {
+        int n = (k + 1) % 3, m = (k + 2) % 3;
+        int minor_len = hidden_cave_expansion_minor(lens[n][0], d[n][0], lens[m][1], d[m][1],
+                                                    lens[m][0], d[m][0], lens[n][1], d[n][1], minor);
+        int xx_len = hidden_cave_expansion_product(lens[k][0], d[k][0], lens[k][0], d[k][0], xx, swap, scaled);
+        int yy_len = hidden_cave_expansion_product(lens[k][1], d[k][1], lens[k][1], d[k][1], yy, swap, scaled);
+        int lift_len = hidden_cave_expansion_sum(xx_len, xx, yy_len, yy, lift);
+        term_lens[k] = hidden_cave_expansion_product(lift_len, lift, minor_len, minor, terms[k], swap, scaled);
+    }
+    double ab[1024], det[1536];
+    int ab_len = hidden_cave_expansion_sum(term_lens[0], terms[0], term_lens[1], terms[1], ab);
+    int det_len = hidden_cave_expansion_sum(ab_len, ab, term_lens[2], terms[2], det);
+    return det[det_len - 1];
+}
+
+//the exact sign of the orient3d determinant, with every difference taken relative to `pd`
+static double hidden_cave_orient3d_exact(double const* pa, double const* pb, double const* pc, double const* pd) {
+    double d[3][3][2];
+    int lens[3][3];
+    double const* points[3] = {pa, pb, pc};
+    for(int k = 0; k < 3; k++) {
+        for(int axis = 0; axis < 3; axis++) {
+            lens[k][axis] = hidden_cave_expansion_diff(points[k][axis], pd[axis], d[k][axis]);
+        }
+    }
+
+    //each term is the z of one point times the xy minor of the other two
+    double minor[16], swap[64], scaled[32];
+    double terms[3][64];
+    int term_lens[3];
+    for(int k = 0; k < 3; k++) {
+        int n = (k + 1) % 3, m = (k + 2) % 3;
+        int minor_len = hidden_cave_expansion_minor(lens[n][0], d[n][0], lens[m][1], d[m][1],
+                                                    lens[m][0], d[m][0], lens[n][1], d[n][1], minor);
+        term_lens[k] = hidden_cave_expansion_product(minor_len, minor, lens[k][2], d[k][2], terms[k], swap, scaled);
+    }
+    double ab[128], det[192];
+    int ab_len = hidden_cave_expansion_sum(term_lens[0], terms[0], term_lens[1], terms[1], ab);
+    int det_len = hidden_cave_expansion_sum(ab_len, ab, term_lens[2], terms[2], det);
+    return det[det_len - 1];
+}
+
+double hidden_cave_orient2d(double const* pa, double const* pb, double const* pc) {
+    double det_left = (pa[0] - pc[0]) * (pb[1] - pc[1]);
+    double det_right = (pa[1] - pc[1]) * (pb[0] - pc[0]);
+    double det = det_left - det_right;
+    double detsum;
+    //when the two products differ in sign, the subtraction can't cancel and the sign is already right
+    if(det_left > 0.0) {
+        if(det_right <= 0.0) {
+            return det;
+        }
+        detsum = det_left + det_right;
+    } else if(det_left < 0.0) {
+        if(det_right >= 0.0) {
+            return det;
+        }
+        detsum = -det_left - det_right;
+    } else {
+        return det;
+    }
+    double bound = hidden_cave_ccw_bound_a * detsum;
+    if(det >= bound || -det >= bound) {
+        return det;
+    }
+    return hidden_cave_orient2d_adapt(pa, pb, pc, detsum);
+}
+
+double hidden_cave_incircle(double const* pa, double const* pb, double const* pc, double const* pd) {
+    double adx = pa[0] - pd[0], ady = pa[1] - pd[1];
+    double bdx = pb[0] - pd[0], bdy = pb[1] - pd[1];
+    double cdx = pc[0] - pd[0], cdy = pc[1] - pd[1];
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+    double alift = adx * adx + ady * ady;
+    double blift = bdx * bdx + bdy * bdy;
+    double clift = cdx * cdx + cdy * cdy;
+
+    double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+    double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * alift + (fabs(cdxady) + fabs(adxcdy)) * blift +
+                       (fabs(adxbdy) + fabs(bdxady)) * clift;
+    double bound = hidden_cave_icc_bound_a * permanent;
+    if(det > bound || -det > bound) {
+        return det;
+    }
+    return hidden_cave_incircle_exact(pa, pb, pc, pd);
+}
+
+double hidden_cave_orient3d(double const* pa, double const* pb, double const* pc, double const* pd) {
+    double adx = pa[0] - pd[0], ady = pa[1] - pd[1], adz = pa[2] - pd[2];
+    double bdx = pb[0] - pd[0], bdy = pb[1] - pd[1], bdz = pb[2] - pd[2];
+    double cdx = pc[0] - pd[0], cdy = pc[1] - pd[1], cdz = pc[2] - pd[2];
+
+    double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    double cdxady = cdx * ady, adxcdy = adx * cdy;
+    double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+    double permanent = (fabs(bdxcdy) + fabs(cdxbdy)) * fabs(adz) + (fabs(cdxady) + fabs(adxcdy)) * fabs(bdz) +
+                       (fabs(adxbdy) + fabs(bdxady)) * fabs(cdz);
+    double bound = hidden_cave_o3d_bound_a * permanent;
+    if(det > bound || -det > bound) {
+        return det;
+    }
+    return hidden_cave_orient3d_exact(pa, pb, pc, pd);
+}
+
+double cave_orient2d(cave_2Point a, cave_2Point b, cave_2Point c) {
+    double pa[2] = {a.x, a.y}, pb[2] = {b.x, b.y}, pc[2] = {c.x, c.y};
+    return hidden_cave_orient2d(pa, pb, pc);
+}
+
+double cave_incircle(cave_2Point a, cave_2Point b, cave_2Point c, cave_2Point d) {
+    double pa[2] = {a.x, a.y}, pb[2] = {b.x, b.y}, pc[2] = {c.x, c.y}, pd[2] = {d.x, d.y};
+    return hidden_cave_incircle(pa, pb, pc, pd);
+}
+
+double cave_orient3d(cave_3Point a, cave_3Point b, cave_3Point c, cave_3Point d) {
+    double pa[3] = {a.x, a.y, a.z}, pb[3] = {b.x, b.y, b.z}, pc[3] = {c.x, c.y, c.z}, pd[3] = {d.x, d.y, d.z};
+    return hidden_cave_orient3d(pa, pb, pc, pd);
+}
+
+//The batch functions run the filter over a block, keeping each bound, and then go back over the block for
+//the results that didn't clear theirs. The filter loops are the single point versions with the early returns
+//folded into the bound: when orient2d's products differ in sign, |det| is their permanent, which clears it.
+
+CaveError cave_orient2d_batch(double* dest, cave_2Point const* a, cave_2Point const* b, cave_2Point const* c,
+                              size_t count) {
+    if(count != 0 && (!dest || !a || !b || !c)) {
+        return CAVE_DATA_ERROR;
+    }
+    double bound[CAVE_PREDICATES_BLOCK];
+    for(size_t start = 0; start < count; start += CAVE_PREDICATES_BLOCK) {
+        size_t n = count - start < CAVE_PREDICATES_BLOCK ? count - start : CAVE_PREDICATES_BLOCK;
+        double* out = dest + start;
+        cave_2Point const* pa = a + start;
+        cave_2Point const* pb = b + start;
+        cave_2Point const* pc = c + start;
+        for(size_t i = 0; i < n; i++) {
+            double det_left = ((double) pa[i].x - pc[i].x) * ((double) pb[i].y - pc[i].y);
+            double det_right = ((double) pa[i].y - pc[i].y) * ((double) pb[i].x - pc[i].x);
+            out[i] = det_left - det_right;
+            bound[i] = hidden_cave_ccw_bound_a * (fabs(det_left) + fabs(det_right));
+        }
+        for(size_t i = 0; i < n; i++) {
+            if(!(fabs(out[i]) >= bound[i])) {
+                double xa[2] = {pa[i].x, pa[i].y}, xb[2] = {pb[i].x, pb[i].y}, xc[2] = {pc[i].x, pc[i].y};
+                out[i] = hidden_cave_orient2d_adapt(xa, xb, xc, bound[i] / hidden_cave_ccw_bound_a);
+            }
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_incircle_batch(double* dest, cave_2Point const* a, cave_2Point const* b, cave_2Point const* c,
+                              cave_2Point const* d, size_t count) {
+    if(count != 0 && (!dest || !a || !b || !c || !d)) {
+        return CAVE_DATA_ERROR;
+    }
+    double bound[CAVE_PREDICATES_BLOCK];
+    for(size_t start = 0; start < count; start += CAVE_PREDICATES_BLOCK) {
+        size_t n = count - start < CAVE_PREDICATES_BLOCK ? count - start : CAVE_PREDICATES_BLOCK;
+        double* out = dest + start;
+        cave_2Point const* pa = a + start;
+        cave_2Point const* pb = b + start;
+        cave_2Point const* pc = c + start;
+        cave_2Point const* pd = d + start;
+        for(size_t i = 0; i < n; i++) {
+            double adx = (double) pa[i].x - pd[i].x, ady = (double) pa[i].y - pd[i].y;
+            double bdx = (double) pb[i].x - pd[i].x, bdy = (double) pb[i].y - pd[i].y;
+            double cdx = (double) pc[i].x - pd[i].x, cdy = (double) pc[i].y - pd[i].y;
+            double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+            double cdxady = cdx * ady, adxcdy = adx * cdy;
+            double adxbdy = adx * bdy, bdxady = bdx * ady;
+            double alift = adx * adx + ady * ady;
+            double blift = bdx * bdx + bdy * bdy;
+            double clift = cdx * cdx + cdy * cdy;
+            out[i] = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+            bound[i] = hidden_cave_icc_bound_a * ((fabs(bdxcdy) + fabs(cdxbdy)) * alift +
+                                                  (fabs(cdxady) + fabs(adxcdy)) * blift +
+                                                  (fabs(adxbdy) + fabs(bdxady)) * clift);
+        }
+        for(size_t i = 0; i < n; i++) {
+            if(!(fabs(out[i]) > bound[i])) {
+                double xa[2] = {pa[i].x, pa[i].y}, xb[2] = {pb[i].x, pb[i].y};
+                double xc[2] = {pc[i].x, pc[i].y}, xd[2] = {pd[i].x, pd[i].y};
+                out[i] = hidden_cave_incircle_exact(xa, xb, xc, xd);
+            }
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_orient3d_batch(double* dest, cave_3Point const* a, cave_3Point const* b, cave_3Point const* c,
+                              cave_3Point const* d, size_t count) {
+    if(count != 0 && (!dest || !a || !b || !c || !d)) {
+        return CAVE_DATA_ERROR;
+    }
+    double bound[CAVE_PREDICATES_BLOCK];
+    for(size_t start = 0; start < count; start += CAVE_PREDICATES_BLOCK) {
+        size_t n = count - start < CAVE_PREDICATES_BLOCK ? count - start : CAVE_PREDICATES_BLOCK;
+        double* out = dest + start;
+        cave_3Point const* pa = a + start;
+        cave_3Point const* pb = b + start;
+        cave_3Point const* pc = c + start;
+        cave_3Point const* pd = d + start;
+        for(size_t i = 0; i < n; i++) {
+            double adx = (double) pa[i].x - pd[i].x, ady = (double) pa[i].y - pd[i].y;
+            double adz = (double) pa[i].z - pd[i].z;
+            double bdx = (double) pb[i].x - pd[i].x, bdy = (double) pb[i].y - pd[i].y;
+            double bdz = (double) pb[i].z - pd[i].z;
+            double cdx = (double) pc[i].x - pd[i].x, cdy = (double) pc[i].y - pd[i].y;
+            double cdz = (double) pc[i].z - pd[i].z;
+            double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+            double cdxady = cdx * ady, adxcdy = adx * cdy;
+            double adxbdy = adx * bdy, bdxady = bdx * ady;
+            out[i] = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+            bound[i] = hidden_cave_o3d_bound_a * ((fabs(bdxcdy) + fabs(cdxbdy)) * fabs(adz) +
+                                                  (fabs(cdxady) + fabs(adxcdy)) * fabs(bdz) +
+                                                  (fabs(adxbdy) + fabs(bdxady)) * fabs(cdz));
+        }
+        for(size_t i = 0; i < n; i++) {
+            if(!(fabs(out[i]) > bound[i])) {
+                double xa[3] = {pa[i].x, pa[i].y, pa[i].z}, xb[3] = {pb[i].x, pb[i].y, pb[i].z};
+                double xc[3] = {pc[i].x, pc[i].y, pc[i].z}, xd[3] = {pd[i].x, pd[i].y, pd[i].z};
+                out[i] = hidden_cave_orient3d_exact(xa, xb, xc, xd);
+            }
+        }
+    }
+    return CAVE_NO_ERROR;
+}
@@ -0,0 +1,328 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-reorder.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+//Each vertex lists the triangles it still has to draw, all vertexes' lists packed one after another, and each
+//triangle keeps where it is in the list of each of its corners, so a triangle drawn is swapped out of them in
+//constant time. A triangle's score is kept as the sum of its corners' scores, and when a corner's score changes
+//only the difference is added to the triangles it has left. Only the vertexes that were or are in the modelled
+//cache change score with each triangle drawn. A vertex with more than `CAVE_REORDER_VALENCE_CAP` triangles left
+//scores the same wherever it is, so it is never rescored, and only that many of the triangles of each vertex in
+//the cache are looked at for the next one. Each step is then bounded by the cache size however many triangles
+//share a vertex, as at the middle of a fan, and the whole order takes linear time.
+//
+//The statistics model a first-in first-out cache by when each vertex last missed it: a vertex is still in
+//the cache if fewer than `cache_size` misses have happened since.
+
+#define CAVE_REORDER_NIL (UINT32_MAX)
+//Forsyth's weights: how a vertex scores for how recently it was used, and for how few triangles it has left
+#define CAVE_REORDER_DECAY_POWER (1.5f)
+#define CAVE_REORDER_LAST_TRI_SCORE (0.75f)
+#define CAVE_REORDER_VALENCE_SCALE (2.0f)
+#define CAVE_REORDER_VALENCE_POWER (0.5f)
+//how many triangles left a vertex is scored for at most
+#define CAVE_REORDER_VALENCE_CAP (32)
+//the cache vertex fetches are measured through
+#define CAVE_REORDER_FETCH_LINES (256)
+#define CAVE_REORDER_LINE_BYTES (64)
+
+static bool hidden_cave_reorder_valid(cave_Mesh const* mesh) {
+    if(!mesh || (!mesh->tris && mesh->tri_count > 0) || mesh->tri_count >= UINT32_MAX / 3
+       || mesh->vert_count >= UINT32_MAX) {
+        return false;
+    }
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        if(t.a >= mesh->vert_count || t.b >= mesh->vert_count || t.c >= mesh->vert_count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+typedef struct hidden_cave_Forsyth {
+    float cache_scores[CAVE_VERTEX_CACHE_MAX];
+    float valence_scores[CAVE_REORDER_VALENCE_CAP + 1];
+    size_t cache_size;
+    uint32_t* offsets; //where each vertex's triangles start in `adjacency`
+    uint32_t* left; //how many triangles each vertex has left to draw, the first of its list
+    uint32_t* adjacency;
+    uint32_t* slots; //where each triangle's corners are in their vertexes' lists, three to a triangle
+    float* vertex_scores;
+    float* tri_scores;
+} hidden_cave_Forsyth;
+
+//the score of a vertex at `position` in the cache, or past its end, with `left` triangles left
+static float hidden_cave_forsyth_score(hidden_cave_Forsyth const* f, size_t position, uint32_t left) {
+    if(left == 0) {
+        return -1.0f;
+    }
+    if(left > CAVE_REORDER_VALENCE_CAP) {
+        return f->valence_scores[CAVE_REORDER_VALENCE_CAP];
+    }
+    return (position < f->cache_size ? f->cache_scores[position] : 0.0f) + f->valence_scores[left];
+}
+
+//scores vertex `v` again at `position`, and passes the difference on to its triangles. Past the cap there is
+//no difference to pass on.
+static void hidden_cave_forsyth_rescore(hidden_cave_Forsyth* f, uint32_t v, size_t position) {
+    if(f->left[v] > CAVE_REORDER_VALENCE_CAP) {
+        return;
+    }
+    float score = hidden_cave_forsyth_score(f, position, f->left[v]);
+    float delta = score - f->vertex_scores[v];
+    f->vertex_scores[v] = score;
+    if(delta != 0.0f) {
+        uint32_t const* tris = f->adjacency + f->offsets[v];
+        for(uint32_t i = 0; i < f->left[v]; i++) {
+            f->tri_scores[tris[i]] += delta;
+        }
+    }
+}
+
+CaveError cave_Mesh_optimize_vertex_cache(cave_Mesh* mesh, size_t cache_size) {
+    cache_size = cache_size == 0 ? CAVE_VERTEX_CACHE_DEFAULT : cache_size;
+    if(!hidden_cave_reorder_valid(mesh) || cache_size < 3 || cache_size > CAVE_VERTEX_CACHE_MAX) {
+        return CAVE_DATA_ERROR;
+    }
+    size_t tri_count = mesh->tri_count, vert_count = mesh->vert_count;
+    if(tri_count < 2) {
+        return CAVE_NO_ERROR;
+    }
+    hidden_cave_Forsyth f = {{0}, {0}, cache_size, NULL, NULL, NULL, NULL, NULL, NULL};
+    f.offsets = calloc(vert_count + 1, sizeof(uint32_t));
+    f.left = calloc(vert_count, sizeof(uint32_t));
+    f.adjacency = malloc(sizeof(uint32_t) * 3 * tri_count);
+    f.slots = malloc(sizeof(uint32_t) * 3 * tri_count);
+    f.vertex_scores = malloc(sizeof(float) * vert_count);
+    f.tri_scores = malloc(sizeof(float) * tri_count);
+    uint8_t* drawn = calloc(tri_count, 1);
+    cave_Index_Triangle* order = malloc(sizeof(cave_Index_Triangle) * tri_count);
+    if(!f.offsets || !f.left || !f.adjacency || !f.slots || !f.vertex_scores || !f.tri_scores || !drawn || !order) {
+        free(f.offsets);
+        free(f.left);
+        free(f.adjacency);
+        free(f.slots);
+        free(f.vertex_scores);
+        free(f.tri_scores);
+        free(drawn);
+        free(order);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+
+    for(size_t i = 0; i < cache_size; i++) {
+        //the last triangle's corners score the same whatever order they went in
+        if(i < 3) {
+            f.cache_scores[i] = CAVE_REORDER_LAST_TRI_SCORE;
+        } else {
+            float decay = 1.0f - (float) (i - 3) / (float) (cache_size - 3);
+            f.cache_scores[i] = powf(decay, CAVE_REORDER_DECAY_POWER);
+        }
+    }
+    for(size_t i = 1; i <= CAVE_REORDER_VALENCE_CAP; i++) {
+        f.valence_scores[i] = CAVE_REORDER_VALENCE_SCALE * powf((float) i, -CAVE_REORDER_VALENCE_POWER);
+    }
+    for(size_t i = 0; i < tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        f.offsets[t.a + 1]++;
+        f.offsets[t.b + 1]++;
+        f.offsets[t.c + 1]++;
+    }
+    for(size_t v = 0; v < vert_count; v++) {
+        f.offsets[v + 1] += f.offsets[v];
+    }
+    for(size_t i = 0; i < tri_count; i++) {
+        size_t corners[3] = {mesh->tris[i].a, mesh->tris[i].b, mesh->tris[i].c};
+        for(int k = 0; k < 3; k++) {
+            size_t v = corners[k];
+            f.slots[3 * i + k] = f.left[v];
+            f.adjacency[f.offsets[v] + f.left[v]++] = (uint32_t) i;
+        }
+    }
+    for(size_t v = 0; v < vert_count; v++) {
+        f.vertex_scores[v] = hidden_cave_forsyth_score(&f, cache_size, f.left[v]);
+    }
+    uint32_t best = 0;
+    for(size_t i = 0; i < tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        f.tri_scores[i] = f.vertex_scores[t.a] + f.vertex_scores[t.b] + f.vertex_scores[t.c];
+        best = f.tri_scores[i] > f.tri_scores[best] ? (uint32_t) i : best;
+    }
+
+    //three more than fit, for the corners of the triangle just drawn to push the oldest out
+    uint32_t cache[CAVE_VERTEX_CACHE_MAX + 3];
+    uint32_t next_cache[CAVE_VERTEX_CACHE_MAX + 3];
+    size_t cache_len = 0;
+    size_t cursor = 0;
+    for(size_t n = 0; n < tri_count; n++) {
+        //nothing drawable is left around the cache, so it's started again on the next triangle not yet drawn
+        if(best == CAVE_REORDER_NIL) {
+            while(drawn[cursor]) {
+                cursor++;
+            }
+            best = (uint32_t) cursor;
+        }
+        drawn[best] = 1;
+        cave_Index_Triangle t = mesh->tris[best];
+        order[n] = t;
+        uint32_t corners[3] = {(uint32_t) t.a, (uint32_t) t.b, (uint32_t) t.c};
+        size_t next_len = 0;
+        for(int k = 0; k < 3; k++) {
+            uint32_t v = corners[k];
+            //the last triangle in the list takes the place of the one drawn, and is told where it went
+            uint32_t* tris = f.adjacency + f.offsets[v];
+            uint32_t at = f.slots[3 * best + k];
+            uint32_t last = tris[--f.left[v]];
+            tris[at] = last;
+            cave_Index_Triangle moved = mesh->tris[last];
+            size_t moved_corners[3] = {moved.a, moved.b, moved.c};
+            for(int j = 0; j < 3; j++) {
+                if(moved_corners[j] == v && f.slots[3 * last + j] == f.left[v]) {
+                    f.slots[3 * last + j] = at;
+                    break;
+                }
+            }
+            if(k == 0 || (v != corners[0] && (k == 1 || v != corners[1]))) {
+                next_cache[next_len++] = v;
+            }
+        }
+        for(size_t i = 0; i < cache_len; i++) {
+            uint32_t v = cache[i];
+            if(v != corners[0] && v != corners[1] && v != corners[2]) {
+                next_cache[next_len++] = v;
+            }
+        }
+        //those pushed past the end of the cache score as if out of it
+        for(size_t i = 0; i < next_len; i++) {
+            hidden_cave_forsyth_rescore(&f, next_cache[i], i);
+        }
+        cache_len = next_len < cache_size ? next_len : cache_size;
+        memcpy(cache, next_cache, sizeof(uint32_t) * cache_len);
+
+        best = CAVE_REORDER_NIL;
+        float best_score = -INFINITY;
+        for(size_t i = 0; i < cache_len; i++) {
+            uint32_t v = cache[i];
+            uint32_t const* tris = f.adjacency + f.offsets[v];
+            uint32_t candidates = f.left[v] < CAVE_REORDER_VALENCE_CAP ? f.left[v] : CAVE_REORDER_VALENCE_CAP;
+            for(uint32_t j = 0; j < candidates; j++) {
+                if(f.tri_scores[tris[j]] > best_score) {
+                    best = tris[j];
+                    best_score = f.tri_scores[best];
+                }
+            }
+        }
+    }
+    memcpy(mesh->tris, order, sizeof(cave_Index_Triangle) * tri_count);
+    free(f.offsets);
+    free(f.left);
+    free(f.adjacency);
+    free(f.slots);
+    free(f.vertex_scores);
+    free(f.tri_scores);
+    free(drawn);
+    free(order);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_Mesh_optimize_vertex_fetch(cave_Mesh* mesh, size_t* remap) {
+    if(!mesh || (!mesh->positions && mesh->vert_count > 0) || !hidden_cave_reorder_valid(mesh)) {
+        return CAVE_DATA_ERROR;
+    }
+    size_t vert_count = mesh->vert_count;
+    if(vert_count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    size_t* order = malloc(sizeof(size_t) * vert_count);
+    cave_3Point* positions = malloc(sizeof(cave_3Point) * vert_count);
+    cave_3Point* normals = mesh->normals ? malloc(sizeof(cave_3Point) * vert_count) : NULL;
+    if(!order || !positions || (mesh->normals && !normals)) {
+        free(order);
+        free(positions);
+        free(normals);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    memset(order, 0xFF, sizeof(size_t) * vert_count);
+    size_t next = 0;
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        size_t* corners[3] = {&mesh->tris[i].a, &mesh->tris[i].b, &mesh->tris[i].c};
+        for(int k = 0; k < 3; k++) {
+            if(order[*corners[k]] == SIZE_MAX) {
+                order[*corners[k]] = next++;
+            }
+            *corners[k] = order[*corners[k]];
+        }
+    }
+    for(size_t v = 0; v < vert_count; v++) {
+        if(order[v] == SIZE_MAX) {
+            order[v] = next++;
+        }
+        positions[order[v]] = mesh->positions[v];
+        if(normals) {
+            normals[order[v]] = mesh->normals[v];
+        }
+    }
+    free(mesh->positions);
+    free(mesh->normals);
+    mesh->positions = positions;
+    mesh->normals = normals;
+    if(remap) {
+        memcpy(remap, order, sizeof(size_t) * vert_count);
+    }
+    free(order);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_Mesh_vertex_cache_stats(cave_Vertex_Cache_Stats* dest, cave_Mesh const* mesh, size_t cache_size) {
+    if(!dest || !hidden_cave_reorder_valid(mesh) || cache_size == 0) {
+        return CAVE_DATA_ERROR;
+    }
+    memset(dest, 0, sizeof(cave_Vertex_Cache_Stats));
+    if(mesh->tri_count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    //when each vertex last missed, counting misses from 1, or 0 if it never has
+    uint32_t* missed = calloc(mesh->vert_count, sizeof(uint32_t));
+    if(!missed) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    size_t lines[CAVE_REORDER_FETCH_LINES];
+    memset(lines, 0xFF, sizeof(lines));
+    uint32_t misses = 0;
+    size_t fetched = 0;
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        size_t corners[3] = {mesh->tris[i].a, mesh->tris[i].b, mesh->tris[i].c};
+        for(int k = 0; k < 3; k++) {
+            size_t v = corners[k];
+            if(missed[v] != 0 && misses - missed[v] < cache_size) {
+                continue;
+            }
+            missed[v] = ++misses;
+            size_t first = v * sizeof(cave_3Point) / CAVE_REORDER_LINE_BYTES;
+            size_t last = ((v + 1) * sizeof(cave_3Point) - 1) / CAVE_REORDER_LINE_BYTES;
+            for(size_t line = first; line <= last; line++) {
+                if(lines[line % CAVE_REORDER_FETCH_LINES] != line) {
+                    lines[line % CAVE_REORDER_FETCH_LINES] = line;
+                    fetched += CAVE_REORDER_LINE_BYTES;
+                }
+            }
+        }
+    }
+    size_t used = 0;
+    for(size_t v = 0; v < mesh->vert_count; v++) {
+        used += missed[v] != 0;
+    }
+    free(missed);
+    dest->misses = misses;
+    dest->acmr = (float) ((double) misses / (double) mesh->tri_count);
+    dest->atvr = (float) ((double) misses / (double) used);
+    dest->overfetch = (float) ((double) fetched / (double) (used * sizeof(cave_3Point)));
+    return CAVE_NO_ERROR;
+}
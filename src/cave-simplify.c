@@ -0,0 +1,640 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-simplify.h"
+#include "cave-predicates-internal.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+//Every point is linked to its neighbours in its ring or polyline, and the points that may go are kept in a
+//binary min-heap on their cost, with each point's place in the heap tracked so its cost can be changed.
+//Douglas-Peucker costs are worked out once, up front. Visvalingam-Whyatt costs are the areas of the triangles
+//points make with their neighbours, so they are worked out again whenever a neighbour goes, never dropping
+//below the cost of the point that just went, so that points go in order of importance.
+//
+//For topology preservation, every point is also filed in a hashed grid, which is searched for points in the
+//triangle a removal would sweep over. Its cells are a couple of edges wide, since the points of a
+//contour run along lines rather than filling an area, and it is filed again each time half the points in it
+//have gone, so that cells keep pace with the edges as they lengthen.
+
+#define CAVE_SIMPLIFY_NIL (UINT32_MAX)
+
+enum {
+    CAVE_SIMPLIFY_LIVE,
+    CAVE_SIMPLIFY_HELD, //its removal was blocked, and it is tried again whenever a neighbour goes
+    CAVE_SIMPLIFY_FIXED, //the end of an open polyline, which always stays
+    CAVE_SIMPLIFY_REMOVED,
+};
+
+typedef struct hidden_cave_DP_Range {
+    uint32_t start; //ring-local indexes, where `end` may be the ring's length, meaning its first point
+    uint32_t end;
+    double cost;
+} hidden_cave_DP_Range;
+
+typedef struct hidden_cave_Simplifier {
+    cave_2Point const* points2; //exactly one of these two is set
+    cave_3Point const* points3;
+    uint32_t count;
+    cave_Simplify_Method method;
+    double tolerance; //squared, for Douglas-Peucker
+    bool closed;
+    bool topology;
+    uint32_t* prev;
+    uint32_t* next;
+    uint32_t* ring; //which ring each point is in
+    uint32_t* ring_left; //how many points each ring still has
+    uint8_t* state;
+    double* cost;
+    uint32_t* heap;
+    uint32_t* heap_pos; //CAVE_SIMPLIFY_NIL when not in the heap
+    uint32_t heap_len;
+    uint32_t* blocker; //for a held point, the point found in the way of its removal
+    //the topology grid, as the points in each bucket of cells one bucket after another
+    uint32_t* cell_start;
+    uint32_t* cell_points;
+    uint32_t cell_mask; //one less than the number of buckets, a power of two
+    uint32_t grid_live; //how many points were in play when the grid was filed
+    double min_x;
+    double min_y;
+    double inv_cell;
+} hidden_cave_Simplifier;
+
+static void hidden_cave_simplify_point(hidden_cave_Simplifier const* s, uint32_t i, double* p) {
+    if(s->points2) {
+        p[0] = s->points2[i].x;
+        p[1] = s->points2[i].y;
+        p[2] = 0.0;
+    } else {
+        p[0] = s->points3[i].x;
+        p[1] = s->points3[i].y;
+        p[2] = s->points3[i].z;
+    }
+}
+
+//the squared distance from `p` to the segment from `a` to `b`
+static double hidden_cave_segment_distance2(double const* p, double const* a, double const* b) {
+    double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    double ap[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+    double len2 = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+    double t = len2 > 0 ? (ap[0] * ab[0] + ap[1] * ab[1] + ap[2] * ab[2]) / len2 : 0.0;
+    t = t < 0 ? 0 : (t > 1 ? 1 : t);
+    double d[3] = {ap[0] - t * ab[0], ap[1] - t * ab[1], ap[2] - t * ab[2]};
+    return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+}
+
+//the area of the triangle a point makes with its neighbours
+static double hidden_cave_simplify_area(hidden_cave_Simplifier const* s, uint32_t p) {
+    double a[3], b[3], c[3];
+    hidden_cave_simplify_point(s, s->prev[p], a);
+    hidden_cave_simplify_point(s, p, b);
+    hidden_cave_simplify_point(s, s->next[p], c);
+    double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    double v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    double cross[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+    return sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]) / 2;
+}
+
+static bool hidden_cave_heap_less(hidden_cave_Simplifier const* s, uint32_t a, uint32_t b) {
+    return s->cost[a] < s->cost[b] || (s->cost[a] == s->cost[b] && a < b);
+}
+
+static void hidden_cave_heap_place(hidden_cave_Simplifier* s, uint32_t at, uint32_t p) {
+    s->heap[at] = p;
+    s->heap_pos[p] = at;
+}
+
+static void hidden_cave_heap_up(hidden_cave_Simplifier* s, uint32_t at) {
+    uint32_t p = s->heap[at];
+    while(at > 0) {
+        uint32_t parent = (at - 1) / 2;
+        if(!hidden_cave_heap_less(s, p, s->heap[parent])) {
+            break;
+        }
+        hidden_cave_heap_place(s, at, s->heap[parent]);
+        at = parent;
+    }
+    hidden_cave_heap_place(s, at, p);
+}
+
+static void hidden_cave_heap_down(hidden_cave_Simplifier* s, uint32_t at) {
+    uint32_t p = s->heap[at];
+    for(;;) {
+        uint32_t child = 2 * at + 1;
+        if(child >= s->heap_len) {
+            break;
+        }
+        if(child + 1 < s->heap_len && hidden_cave_heap_less(s, s->heap[child + 1], s->heap[child])) {
+            child++;
+        }
+        if(!hidden_cave_heap_less(s, s->heap[child], p)) {
+            break;
+        }
+        hidden_cave_heap_place(s, at, s->heap[child]);
+        at = child;
+    }
+    hidden_cave_heap_place(s, at, p);
+}
+
+static void hidden_cave_heap_push(hidden_cave_Simplifier* s, uint32_t p) {
+    hidden_cave_heap_place(s, s->heap_len++, p);
+    hidden_cave_heap_up(s, s->heap_len - 1);
+}
+
+static uint32_t hidden_cave_heap_pop(hidden_cave_Simplifier* s) {
+    uint32_t top = s->heap[0];
+    s->heap_pos[top] = CAVE_SIMPLIFY_NIL;
+    if(--s->heap_len > 0) {
+        hidden_cave_heap_place(s, 0, s->heap[s->heap_len]);
+        hidden_cave_heap_down(s, 0);
+    }
+    return top;
+}
+
+//after the cost of `p`, which is in the heap, has changed
+static void hidden_cave_heap_update(hidden_cave_Simplifier* s, uint32_t p) {
+    hidden_cave_heap_up(s, s->heap_pos[p]);
+    hidden_cave_heap_down(s, s->heap_pos[p]);
+}
+
+//ranks the `len` points from `first` by Douglas-Peucker. A point's cost is its distance from the segment
+//across the range it split, capped by the cost of the point that split off that range, since it can only be
+//kept if that one is too. `stack` has room for `len` ranges.
+static void hidden_cave_rank_douglas_peucker(hidden_cave_Simplifier* s, uint32_t first, uint32_t len,
+                                             hidden_cave_DP_Range* stack) {
+    size_t top = 0;
+    if(s->closed) {
+        //a ring splits first at the point farthest from its first point
+        double a[3], p[3];
+        hidden_cave_simplify_point(s, first, a);
+        uint32_t far = 0;
+        double far_d = -1.0;
+        for(uint32_t i = 1; i < len; i++) {
+            hidden_cave_simplify_point(s, first + i, p);
+            double d = (p[0] - a[0]) * (p[0] - a[0]) + (p[1] - a[1]) * (p[1] - a[1]) + (p[2] - a[2]) * (p[2] - a[2]);
+            if(d > far_d) {
+                far_d = d;
+                far = i;
+            }
+        }
+        s->cost[first] = INFINITY;
+        s->cost[first + far] = INFINITY;
+        stack[top++] = (hidden_cave_DP_Range) {0, far, INFINITY};
+        stack[top++] = (hidden_cave_DP_Range) {far, len, INFINITY};
+    } else {
+        s->cost[first] = INFINITY;
+        s->cost[first + len - 1] = INFINITY;
+        stack[top++] = (hidden_cave_DP_Range) {0, len - 1, INFINITY};
+    }
+    while(top > 0) {
+        hidden_cave_DP_Range range = stack[--top];
+        if(range.end - range.start < 2) {
+            continue;
+        }
+        double a[3], b[3], p[3];
+        hidden_cave_simplify_point(s, first + range.start, a);
+        hidden_cave_simplify_point(s, first + range.end % len, b);
+        uint32_t far = range.start + 1;
+        double far_d = -1.0;
+        for(uint32_t i = range.start + 1; i < range.end; i++) {
+            hidden_cave_simplify_point(s, first + i, p);
+            double d = hidden_cave_segment_distance2(p, a, b);
+            if(d > far_d) {
+                far_d = d;
+                far = i;
+            }
+        }
+        double cost = far_d < range.cost ? far_d : range.cost;
+        s->cost[first + far] = cost;
+        stack[top++] = (hidden_cave_DP_Range) {range.start, far, cost};
+        stack[top++] = (hidden_cave_DP_Range) {far, range.end, cost};
+    }
+}
+
+static uint32_t hidden_cave_cell_col(hidden_cave_Simplifier const* s, double x) {
+    return (uint32_t) ((x - s->min_x) * s->inv_cell);
+}
+
+static uint32_t hidden_cave_cell_row(hidden_cave_Simplifier const* s, double y) {
+    return (uint32_t) ((y - s->min_y) * s->inv_cell);
+}
+
+static uint32_t hidden_cave_cell_bucket(hidden_cave_Simplifier const* s, uint32_t col, uint32_t row) {
+    return (col * 73856093u ^ row * 19349663u) & s->cell_mask;
+}
+
+//files every point still in play, sizing cells by the edges between them
+static void hidden_cave_build_grid(hidden_cave_Simplifier* s) {
+    double min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY, length = 0;
+    uint32_t live = 0, edges = 0;
+    for(uint32_t i = 0; i < s->count; i++) {
+        if(s->state[i] == CAVE_SIMPLIFY_REMOVED) {
+            continue;
+        }
+        live++;
+        min_x = fmin(min_x, s->points2[i].x);
+        min_y = fmin(min_y, s->points2[i].y);
+        max_x = fmax(max_x, s->points2[i].x);
+        max_y = fmax(max_y, s->points2[i].y);
+        if(s->next[i] != CAVE_SIMPLIFY_NIL) {
+            length += hypot((double) s->points2[s->next[i]].x - s->points2[i].x,
+                            (double) s->points2[s->next[i]].y - s->points2[i].y);
+            edges++;
+        }
+    }
+    //two edges to a cell keeps most sweeps to a few cells, and no more than 2^20 cells across keeps cell
+    //coordinates well within range
+    double cell = fmax(edges > 0 ? 2 * length / edges : 0, fmax(max_x - min_x, max_y - min_y) / 1048576.0);
+    s->min_x = min_x;
+    s->min_y = min_y;
+    s->inv_cell = cell > 0 ? 1.0 / cell : 1.0;
+    s->grid_live = live;
+    s->cell_mask = 1;
+    while(s->cell_mask < live) {
+        s->cell_mask *= 2;
+    }
+    s->cell_mask--;
+
+    uint32_t buckets = s->cell_mask + 1;
+    for(uint32_t c = 0; c <= buckets; c++) {
+        s->cell_start[c] = 0;
+    }
+    for(uint32_t i = 0; i < s->count; i++) {
+        if(s->state[i] != CAVE_SIMPLIFY_REMOVED) {
+            s->cell_start[hidden_cave_cell_bucket(s, hidden_cave_cell_col(s, s->points2[i].x),
+                                                  hidden_cave_cell_row(s, s->points2[i].y)) + 1]++;
+        }
+    }
+    for(uint32_t c = 0; c < buckets; c++) {
+        s->cell_start[c + 1] += s->cell_start[c];
+    }
+    for(uint32_t i = 0; i < s->count; i++) {
+        if(s->state[i] != CAVE_SIMPLIFY_REMOVED) {
+            uint32_t bucket = hidden_cave_cell_bucket(s, hidden_cave_cell_col(s, s->points2[i].x),
+                                                      hidden_cave_cell_row(s, s->points2[i].y));
+            s->cell_points[s->cell_start[bucket]++] = i;
+        }
+    }
+    //filling in shifted every start along by one bucket
+    for(uint32_t c = buckets; c > 0; c--) {
+        s->cell_start[c] = s->cell_start[c - 1];
+    }
+    s->cell_start[0] = 0;
+}
+
+//true if `q` is neither a corner of the triangle (a, p, b) nor gone, and is in it, corners given as `pa`, `pp`
+//and `pb`, with `box` their bounds and `winding` their orientation
+static bool hidden_cave_sweep_hits(hidden_cave_Simplifier const* s, uint32_t a, uint32_t p, uint32_t b, uint32_t q,
+                                   double const* pa, double const* pp, double const* pb, double const* box,
+                                   double winding) {
+    if(q == a || q == p || q == b || s->state[q] == CAVE_SIMPLIFY_REMOVED) {
+        return false;
+    }
+    double pq[2] = {s->points2[q].x, s->points2[q].y};
+    if(pq[0] < box[0] || pq[0] > box[1] || pq[1] < box[2] || pq[1] > box[3]) {
+        return false;
+    }
+    //a flat triangle sweeps over its own edges, which the box has already narrowed down to
+    if(winding == 0) {
+        return hidden_cave_orient2d(pa, pp, pq) == 0 || hidden_cave_orient2d(pp, pb, pq) == 0;
+    }
+    double o1 = hidden_cave_orient2d(pa, pp, pq);
+    double o2 = hidden_cave_orient2d(pp, pb, pq);
+    double o3 = hidden_cave_orient2d(pb, pa, pq);
+    return winding > 0 ? (o1 >= 0 && o2 >= 0 && o3 >= 0) : (o1 <= 0 && o2 <= 0 && o3 <= 0);
+}
+
+//a point still in play, other than the three corners, in the closed triangle (a, p, b), or CAVE_SIMPLIFY_NIL.
+//The point that held `p` back last time is tried first, since it usually still does.
+static uint32_t hidden_cave_sweep_blocker(hidden_cave_Simplifier const* s, uint32_t a, uint32_t p, uint32_t b) {
+    double pa[2] = {s->points2[a].x, s->points2[a].y};
+    double pp[2] = {s->points2[p].x, s->points2[p].y};
+    double pb[2] = {s->points2[b].x, s->points2[b].y};
+    double winding = hidden_cave_orient2d(pa, pp, pb);
+    double box[4] = {fmin(pa[0], fmin(pp[0], pb[0])), fmax(pa[0], fmax(pp[0], pb[0])),
+                     fmin(pa[1], fmin(pp[1], pb[1])), fmax(pa[1], fmax(pp[1], pb[1]))};
+    uint32_t col0 = hidden_cave_cell_col(s, box[0]), col1 = hidden_cave_cell_col(s, box[1]);
+    uint32_t row0 = hidden_cave_cell_row(s, box[2]), row1 = hidden_cave_cell_row(s, box[3]);
+    if(s->state[p] == CAVE_SIMPLIFY_HELD &&
+       hidden_cave_sweep_hits(s, a, p, b, s->blocker[p], pa, pp, pb, box, winding)) {
+        return s->blocker[p];
+    }
+    //a triangle over more cells than there are buckets is quicker checked against every point filed
+    if((uint64_t) (col1 - col0 + 1) * (row1 - row0 + 1) > s->cell_mask) {
+        for(uint32_t k = 0; k < s->cell_start[s->cell_mask + 1]; k++) {
+            if(hidden_cave_sweep_hits(s, a, p, b, s->cell_points[k], pa, pp, pb, box, winding)) {
+                return s->cell_points[k];
+            }
+        }
+        return CAVE_SIMPLIFY_NIL;
+    }
+    for(uint32_t row = row0; row <= row1; row++) {
+        for(uint32_t col = col0; col <= col1; col++) {
+            uint32_t bucket = hidden_cave_cell_bucket(s, col, row);
+            for(uint32_t k = s->cell_start[bucket]; k < s->cell_start[bucket + 1]; k++) {
+                if(hidden_cave_sweep_hits(s, a, p, b, s->cell_points[k], pa, pp, pb, box, winding)) {
+                    return s->cell_points[k];
+                }
+            }
+        }
+    }
+    return CAVE_SIMPLIFY_NIL;
+}
+
+//links and ranks the points, `ring_count` rings or polylines laid out by `offsets`, and drops all it can
+static CaveError hidden_cave_simplify_run(hidden_cave_Simplifier* s, size_t const* offsets, size_t ring_count) {
+    uint32_t n = s->count;
+    s->prev = malloc(sizeof(uint32_t) * n);
+    s->next = malloc(sizeof(uint32_t) * n);
+    s->ring = malloc(sizeof(uint32_t) * n);
+    s->ring_left = malloc(sizeof(uint32_t) * (ring_count > 0 ? ring_count : 1));
+    s->state = malloc(n);
+    s->cost = malloc(sizeof(double) * n);
+    s->heap = malloc(sizeof(uint32_t) * n);
+    s->heap_pos = malloc(sizeof(uint32_t) * n);
+    hidden_cave_DP_Range* stack = NULL;
+    if(s->method == CAVE_SIMPLIFY_DOUGLAS_PEUCKER) {
+        stack = malloc(sizeof(hidden_cave_DP_Range) * n);
+    }
+    if(s->topology) {
+        uint32_t buckets = 1;
+        while(buckets < n) {
+            buckets *= 2;
+        }
+        s->cell_start = malloc(sizeof(uint32_t) * ((size_t) buckets + 1));
+        s->cell_points = malloc(sizeof(uint32_t) * n);
+        s->blocker = malloc(sizeof(uint32_t) * n);
+    }
+    if(!s->prev || !s->next || !s->ring || !s->ring_left || !s->state || !s->cost || !s->heap || !s->heap_pos ||
+       (s->method == CAVE_SIMPLIFY_DOUGLAS_PEUCKER && !stack) || (s->topology && (!s->cell_start || !s->cell_points || !s->blocker))) {
+        free(stack);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+
+    for(size_t r = 0; r < ring_count; r++) {
+        uint32_t first = (uint32_t) offsets[r], len = (uint32_t) (offsets[r + 1] - offsets[r]);
+        s->ring_left[r] = len;
+        for(uint32_t i = first; i < first + len; i++) {
+            s->prev[i] = i > first ? i - 1 : (s->closed ? first + len - 1 : CAVE_SIMPLIFY_NIL);
+            s->next[i] = i + 1 < first + len ? i + 1 : (s->closed ? first : CAVE_SIMPLIFY_NIL);
+            s->ring[i] = (uint32_t) r;
+            s->heap_pos[i] = CAVE_SIMPLIFY_NIL;
+            s->state[i] = CAVE_SIMPLIFY_LIVE;
+        }
+        //rings too small to lose anything are left as they are
+        if(len <= (s->closed ? 3u : 2u)) {
+            for(uint32_t i = first; i < first + len; i++) {
+                s->state[i] = CAVE_SIMPLIFY_FIXED;
+            }
+            continue;
+        }
+        if(!s->closed) {
+            s->state[first] = CAVE_SIMPLIFY_FIXED;
+            s->state[first + len - 1] = CAVE_SIMPLIFY_FIXED;
+        }
+        if(s->method == CAVE_SIMPLIFY_DOUGLAS_PEUCKER) {
+            hidden_cave_rank_douglas_peucker(s, first, len, stack);
+        }
+        for(uint32_t i = first; i < first + len; i++) {
+            if(s->state[i] == CAVE_SIMPLIFY_LIVE) {
+                if(s->method == CAVE_SIMPLIFY_VISVALINGAM) {
+                    s->cost[i] = hidden_cave_simplify_area(s, i);
+                }
+                //points that matter more than the tolerance only go in once a neighbour's going brings them under
+                if(s->cost[i] <= s->tolerance) {
+                    hidden_cave_heap_place(s, s->heap_len++, i);
+                }
+            }
+        }
+    }
+    free(stack);
+    for(uint32_t at = s->heap_len / 2; at-- > 0;) {
+        hidden_cave_heap_down(s, at);
+    }
+
+    uint32_t live = n;
+    if(s->topology) {
+        hidden_cave_build_grid(s);
+    }
+    while(s->heap_len > 0 && s->cost[s->heap[0]] <= s->tolerance) {
+        uint32_t p = hidden_cave_heap_pop(s);
+        uint32_t a = s->prev[p], b = s->next[p];
+        if(s->closed && s->ring_left[s->ring[p]] <= 3) {
+            continue;
+        }
+        if(s->topology) {
+            uint32_t blocker = hidden_cave_sweep_blocker(s, a, p, b);
+            if(blocker != CAVE_SIMPLIFY_NIL) {
+                s->state[p] = CAVE_SIMPLIFY_HELD;
+                s->blocker[p] = blocker;
+                continue;
+            }
+        }
+        s->next[a] = b;
+        s->prev[b] = a;
+        s->state[p] = CAVE_SIMPLIFY_REMOVED;
+        s->ring_left[s->ring[p]]--;
+        if(s->topology && --live <= s->grid_live / 2) {
+            hidden_cave_build_grid(s);
+        }
+        uint32_t neighbours[2] = {a, b};
+        for(int k = 0; k < 2; k++) {
+            uint32_t q = neighbours[k];
+            if(s->state[q] == CAVE_SIMPLIFY_FIXED || (k == 1 && q == a)) {
+                continue;
+            }
+            if(s->method == CAVE_SIMPLIFY_VISVALINGAM) {
+                double area = hidden_cave_simplify_area(s, q);
+                s->cost[q] = area > s->cost[p] ? area : s->cost[p];
+            }
+            if(s->heap_pos[q] != CAVE_SIMPLIFY_NIL) {
+                hidden_cave_heap_update(s, q);
+            } else if(s->state[q] == CAVE_SIMPLIFY_HELD || s->cost[q] <= s->tolerance) {
+                hidden_cave_heap_push(s, q);
+            }
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+static void hidden_cave_simplify_release(hidden_cave_Simplifier* s) {
+    free(s->prev);
+    free(s->next);
+    free(s->ring);
+    free(s->ring_left);
+    free(s->state);
+    free(s->cost);
+    free(s->heap);
+    free(s->heap_pos);
+    free(s->cell_start);
+    free(s->cell_points);
+    free(s->blocker);
+}
+
+static CaveError hidden_cave_simplify_setup(hidden_cave_Simplifier* s, cave_Simplify_Options const* options,
+                                            size_t point_count) {
+    cave_Simplify_Options opts = {CAVE_SIMPLIFY_DOUGLAS_PEUCKER, 0.0, false, false};
+    if(options) {
+        opts = *options;
+    }
+    if(!(opts.tolerance >= 0) || (opts.method != CAVE_SIMPLIFY_DOUGLAS_PEUCKER &&
+                                  opts.method != CAVE_SIMPLIFY_VISVALINGAM) || point_count >= UINT32_MAX) {
+        return CAVE_DATA_ERROR;
+    }
+    s->count = (uint32_t) point_count;
+    s->method = opts.method;
+    s->tolerance = opts.method == CAVE_SIMPLIFY_DOUGLAS_PEUCKER ? opts.tolerance * opts.tolerance : opts.tolerance;
+    s->closed = opts.closed;
+    s->topology = opts.preserve_topology && s->points2 && point_count > 0;
+    return CAVE_NO_ERROR;
+}
+
+//hands back the indexes of the points `s` kept
+static CaveError hidden_cave_simplify_kept(hidden_cave_Simplifier const* s, size_t** kept, size_t* kept_count) {
+    size_t count = 0;
+    for(uint32_t i = 0; i < s->count; i++) {
+        count += s->state[i] != CAVE_SIMPLIFY_REMOVED;
+    }
+    *kept = malloc(sizeof(size_t) * count);
+    if(!*kept) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    count = 0;
+    for(uint32_t i = 0; i < s->count; i++) {
+        if(s->state[i] != CAVE_SIMPLIFY_REMOVED) {
+            (*kept)[count++] = i;
+        }
+    }
+    *kept_count = count;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_simplify_2d(size_t** kept, size_t* kept_count, cave_2Point const* points, size_t point_count,
+                           cave_Simplify_Options const* options) {
+    if(!kept || !kept_count || (!points && point_count != 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    *kept = NULL;
+    *kept_count = 0;
+    hidden_cave_Simplifier s = {0};
+    s.points2 = points;
+    CaveError err = hidden_cave_simplify_setup(&s, options, point_count);
+    for(size_t i = 0; i < point_count && err == CAVE_NO_ERROR; i++) {
+        if(!isfinite(points[i].x) || !isfinite(points[i].y)) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    if(err != CAVE_NO_ERROR || point_count == 0) {
+        return err;
+    }
+    size_t offsets[2] = {0, point_count};
+    err = hidden_cave_simplify_run(&s, offsets, 1);
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_simplify_kept(&s, kept, kept_count);
+    }
+    hidden_cave_simplify_release(&s);
+    return err;
+}
+
+CaveError cave_simplify_3d(size_t** kept, size_t* kept_count, cave_3Point const* points, size_t point_count,
+                           cave_Simplify_Options const* options) {
+    if(!kept || !kept_count || (!points && point_count != 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    *kept = NULL;
+    *kept_count = 0;
+    hidden_cave_Simplifier s = {0};
+    s.points3 = points;
+    CaveError err = hidden_cave_simplify_setup(&s, options, point_count);
+    for(size_t i = 0; i < point_count && err == CAVE_NO_ERROR; i++) {
+        if(!isfinite(points[i].x) || !isfinite(points[i].y) || !isfinite(points[i].z)) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    if(err != CAVE_NO_ERROR || point_count == 0) {
+        return err;
+    }
+    size_t offsets[2] = {0, point_count};
+    err = hidden_cave_simplify_run(&s, offsets, 1);
+    if(err == CAVE_NO_ERROR) {
+        err = hidden_cave_simplify_kept(&s, kept, kept_count);
+    }
+    hidden_cave_simplify_release(&s);
+    return err;
+}
+
+CaveError cave_simplify_polygon(cave_2d_Polygon* dest, cave_2d_Polygon const* polygon,
+                                cave_Simplify_Options const* options) {
+    if(!dest || !polygon || (polygon->ring_count != 0 && !polygon->ring_offsets)) {
+        return CAVE_DATA_ERROR;
+    }
+    *dest = (cave_2d_Polygon) {NULL, NULL, 0};
+    size_t ring_count = polygon->ring_count;
+    size_t const* offsets = polygon->ring_offsets;
+    for(size_t r = 0; r < ring_count; r++) {
+        if(offsets[r] > offsets[r + 1]) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+    size_t first = ring_count > 0 ? offsets[0] : 0;
+    size_t point_count = ring_count > 0 ? offsets[ring_count] - first : 0;
+    if(!polygon->points && point_count != 0) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //works on the rings' own points, with offsets counted from the first of them
+    cave_2Point const* points = point_count > 0 ? polygon->points + first : NULL;
+    hidden_cave_Simplifier s = {0};
+    s.points2 = points;
+    CaveError err = hidden_cave_simplify_setup(&s, options, point_count);
+    for(size_t i = 0; i < point_count && err == CAVE_NO_ERROR; i++) {
+        if(!isfinite(points[i].x) || !isfinite(points[i].y)) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    s.closed = true;
+    size_t* local = malloc(sizeof(size_t) * (ring_count + 1));
+    dest->ring_offsets = malloc(sizeof(size_t) * (ring_count + 1));
+    if(!local || !dest->ring_offsets) {
+        free(local);
+        free(dest->ring_offsets);
+        dest->ring_offsets = NULL;
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t r = 0; r <= ring_count; r++) {
+        local[r] = offsets[r] - first;
+    }
+    err = point_count > 0 ? hidden_cave_simplify_run(&s, local, ring_count) : CAVE_NO_ERROR;
+    size_t kept = 0;
+    for(uint32_t i = 0; err == CAVE_NO_ERROR && i < s.count; i++) {
+        kept += s.state[i] != CAVE_SIMPLIFY_REMOVED;
+    }
+    if(err == CAVE_NO_ERROR) {
+        dest->points = malloc(sizeof(cave_2Point) * (kept > 0 ? kept : 1));
+        err = dest->points ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(err == CAVE_NO_ERROR) {
+        kept = 0;
+        for(size_t r = 0; r < ring_count; r++) {
+            dest->ring_offsets[r] = kept;
+            for(size_t i = local[r]; i < local[r + 1]; i++) {
+                if(s.state[i] != CAVE_SIMPLIFY_REMOVED) {
+                    dest->points[kept++] = points[i];
+                }
+            }
+        }
+        dest->ring_offsets[ring_count] = kept;
+        dest->ring_count = ring_count;
+    } else {
+        free(dest->ring_offsets);
+        *dest = (cave_2d_Polygon) {NULL, NULL, 0};
+    }
+    free(local);
+    hidden_cave_simplify_release(&s);
+    return err;
+}
@@ -0,0 +1,399 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-slice.h"
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+//triangles per chunk, when finding which layers they cross
+#define CAVE_SLICE_GRAIN (16384)
+#define CAVE_SLICE_NONE (UINT32_MAX)
+
+//an edge cut by a plane, by the positions of its ends below and above it
+typedef struct hidden_cave_Slice_Edge {
+    float below[3];
+    float above[3];
+} hidden_cave_Slice_Edge;
+
+//where a plane crosses a triangle, from the edge it comes in by to the edge it leaves through, seen from above
+//with the outside of the mesh on the right
+typedef struct hidden_cave_Slice_Segment {
+    hidden_cave_Slice_Edge in;
+    hidden_cave_Slice_Edge out;
+    cave_2Point start;
+    uint32_t next;
+    uint32_t flags;
+} hidden_cave_Slice_Segment;
+
+enum {
+    CAVE_SLICE_HAS_PREV = 1,
+    CAVE_SLICE_VISITED = 2,
+};
+
+//what a worker slices a layer with, grown as needed and kept from one layer to the next
+typedef struct hidden_cave_Slice_Scratch {
+    hidden_cave_Slice_Segment* segments;
+    size_t segment_capacity;
+    uint32_t* table;
+    size_t table_capacity;
+    size_t open_rings;
+} hidden_cave_Slice_Scratch;
+
+typedef struct hidden_cave_Slice_Height {
+    float height;
+    uint32_t layer;
+} hidden_cave_Slice_Height;
+
+typedef struct hidden_cave_Slice_Pass {
+    //one of these is set
+    cave_STL_Tri const* stl;
+    cave_Mesh const* mesh;
+    size_t tri_count;
+    //the heights, lowest first, and the layers they are for
+    hidden_cave_Slice_Height* heights;
+    size_t height_count;
+    //for each triangle, the first layer, in order of height, it crosses, and the one after the last
+    uint32_t* spans;
+    //the triangles crossing each layer, in order of height, are from `layer_tris[layer_start[l]]` on
+    size_t* layer_start;
+    uint32_t* layer_tris;
+    hidden_cave_Slice_Scratch* scratch;
+    cave_Slices* dest;
+} hidden_cave_Slice_Pass;
+
+static void hidden_cave_slice_corners(hidden_cave_Slice_Pass const* pass, size_t tri, cave_3Point corners[3]) {
+    if(pass->stl) {
+        corners[0] = pass->stl[tri].a;
+        corners[1] = pass->stl[tri].b;
+        corners[2] = pass->stl[tri].c;
+    } else {
+        cave_Index_Triangle t = pass->mesh->tris[tri];
+        corners[0] = pass->mesh->positions[t.a];
+        corners[1] = pass->mesh->positions[t.b];
+        corners[2] = pass->mesh->positions[t.c];
+    }
+}
+
+static int hidden_cave_slice_height_compare(void const* a, void const* b) {
+    hidden_cave_Slice_Height const* x = a;
+    hidden_cave_Slice_Height const* y = b;
+    if(x->height != y->height) {
+        return x->height < y->height ? -1 : 1;
+    }
+    return x->layer < y->layer ? -1 : x->layer > y->layer;
+}
+
+//the first of the sorted heights above `z`
+static uint32_t hidden_cave_slice_first_above(hidden_cave_Slice_Pass const* pass, float z) {
+    size_t lo = 0, hi = pass->height_count;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(pass->heights[mid].height > z) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return (uint32_t) lo;
+}
+
+//a plane at height h crosses a triangle when some corner is below it and some isn't, min z < h <= max z
+static CaveError hidden_cave_slice_spans_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    (void) worker;
+    hidden_cave_Slice_Pass* pass = arg;
+    for(size_t i = begin; i < end; i++) {
+        cave_3Point c[3];
+        hidden_cave_slice_corners(pass, i, c);
+        float lo = c[0].z < c[1].z ? c[0].z : c[1].z, hi = c[0].z < c[1].z ? c[1].z : c[0].z;
+        lo = c[2].z < lo ? c[2].z : lo;
+        hi = c[2].z > hi ? c[2].z : hi;
+        uint32_t first = 0, last = 0;
+        //NaN corners cross nothing
+        if(lo < hi) {
+            first = hidden_cave_slice_first_above(pass, lo);
+            last = hidden_cave_slice_first_above(pass, hi);
+        }
+        pass->spans[2 * i] = first;
+        pass->spans[2 * i + 1] = last;
+    }
+    return CAVE_NO_ERROR;
+}
+
+static hidden_cave_Slice_Edge hidden_cave_slice_edge(cave_3Point below, cave_3Point above) {
+    //adding 0 turns -0 into 0, so that edges compare equal bitwise whenever their ends do as numbers
+    hidden_cave_Slice_Edge edge = {{below.x + 0.0f, below.y + 0.0f, below.z + 0.0f},
+                                   {above.x + 0.0f, above.y + 0.0f, above.z + 0.0f}};
+    return edge;
+}
+
+static cave_2Point hidden_cave_slice_cut(hidden_cave_Slice_Edge const* edge, float height) {
+    double t = ((double) height - edge->below[2]) / ((double) edge->above[2] - edge->below[2]);
+    cave_2Point p = {(float) (edge->below[0] + t * ((double) edge->above[0] - edge->below[0])),
+                     (float) (edge->below[1] + t * ((double) edge->above[1] - edge->below[1]))};
+    return p;
+}
+
+static size_t hidden_cave_slice_hash(hidden_cave_Slice_Edge const* edge) {
+    uint32_t words[6];
+    memcpy(words, edge, sizeof(words));
+    uint64_t h = 0x9E3779B97F4A7C15u;
+    for(int i = 0; i < 6; i++) {
+        h = (h ^ words[i]) * 0xC2B2AE3D27D4EB4Fu;
+    }
+    return (size_t) (h ^ (h >> 29));
+}
+
+//walking a triangle's edges in winding order, the plane is crossed once going down and once going up. With the
+//triangle wound counter-clockwise seen from outside, the outside is on the right going from the down crossing
+//to the up one, seen from above.
+static void hidden_cave_slice_segment(hidden_cave_Slice_Segment* segment, cave_3Point const c[3], float height) {
+    for(int i = 0; i < 3; i++) {
+        cave_3Point p = c[i], q = c[(i + 1) % 3];
+        bool p_above = p.z >= height, q_above = q.z >= height;
+        if(p_above && !q_above) {
+            segment->in = hidden_cave_slice_edge(q, p);
+        } else if(!p_above && q_above) {
+            segment->out = hidden_cave_slice_edge(p, q);
+        }
+    }
+    segment->start = hidden_cave_slice_cut(&segment->in, height);
+    segment->next = CAVE_SLICE_NONE;
+    segment->flags = 0;
+}
+
+static bool hidden_cave_slice_reserve(void** buf, size_t* capacity, size_t count, size_t size) {
+    if(*capacity >= count) {
+        return true;
+    }
+    size_t grown = *capacity * 2 > count ? *capacity * 2 : count;
+    void* bigger = realloc(*buf, grown * size);
+    if(!bigger) {
+        return false;
+    }
+    *buf = bigger;
+    *capacity = grown;
+    return true;
+}
+
+//slices the layer that is `sorted`th lowest into its polygon
+static CaveError hidden_cave_slice_layer(hidden_cave_Slice_Pass const* pass, hidden_cave_Slice_Scratch* scratch,
+                                         size_t sorted) {
+    float height = pass->heights[sorted].height;
+    cave_2d_Polygon* dest = pass->dest->layers + pass->heights[sorted].layer;
+    size_t begin = pass->layer_start[sorted], count = pass->layer_start[sorted + 1] - begin;
+    size_t table_size = 1;
+    while(table_size < 2 * count) {
+        table_size *= 2;
+    }
+    if(!hidden_cave_slice_reserve((void**) &scratch->segments, &scratch->segment_capacity, count,
+                                  sizeof(hidden_cave_Slice_Segment))
+       || !hidden_cave_slice_reserve((void**) &scratch->table, &scratch->table_capacity, table_size,
+                                     sizeof(uint32_t))) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    dest->ring_offsets = malloc(sizeof(size_t) * (count + 1));
+    dest->points = count > 0 ? malloc(sizeof(cave_2Point) * count) : NULL;
+    if(!dest->ring_offsets || (count > 0 && !dest->points)) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+
+    //cuts the triangles, and hashes each segment by the edge it comes in by. Should more than one come in by the
+    //same edge, which takes an edge shared by more than two triangles, the first is kept.
+    hidden_cave_Slice_Segment* segments = scratch->segments;
+    uint32_t* table = scratch->table;
+    memset(table, 0xFF, sizeof(uint32_t) * table_size);
+    for(size_t s = 0; s < count; s++) {
+        cave_3Point c[3];
+        hidden_cave_slice_corners(pass, pass->layer_tris[begin + s], c);
+        hidden_cave_slice_segment(segments + s, c, height);
+        size_t at = hidden_cave_slice_hash(&segments[s].in) & (table_size - 1);
+        while(table[at] != CAVE_SLICE_NONE && memcmp(&segments[table[at]].in, &segments[s].in,
+                                                     sizeof(hidden_cave_Slice_Edge)) != 0) {
+            at = (at + 1) & (table_size - 1);
+        }
+        if(table[at] == CAVE_SLICE_NONE) {
+            table[at] = (uint32_t) s;
+        }
+    }
+    //each segment is followed by the one coming in by the edge it leaves through
+    for(size_t s = 0; s < count; s++) {
+        size_t at = hidden_cave_slice_hash(&segments[s].out) & (table_size - 1);
+        while(table[at] != CAVE_SLICE_NONE && memcmp(&segments[table[at]].in, &segments[s].out,
+                                                     sizeof(hidden_cave_Slice_Edge)) != 0) {
+            at = (at + 1) & (table_size - 1);
+        }
+        if(table[at] != CAVE_SLICE_NONE) {
+            segments[s].next = table[at];
+            segments[table[at]].flags |= CAVE_SLICE_HAS_PREV;
+        }
+    }
+
+    //follows the chains, those with an open start first so they come out whole, and then the closed loops
+    size_t point_count = 0, ring_count = 0;
+    dest->ring_offsets[0] = 0;
+    for(int round = 0; round < 2; round++) {
+        for(size_t s = 0; s < count; s++) {
+            uint32_t flags = segments[s].flags;
+            if((flags & CAVE_SLICE_VISITED) || (round == 0 && (flags & CAVE_SLICE_HAS_PREV))) {
+                continue;
+            }
+            uint32_t at = (uint32_t) s, last = at;
+            while(at != CAVE_SLICE_NONE && !(segments[at].flags & CAVE_SLICE_VISITED)) {
+                segments[at].flags |= CAVE_SLICE_VISITED;
+                dest->points[point_count++] = segments[at].start;
+                last = at;
+                at = segments[at].next;
+            }
+            if(segments[last].next != (uint32_t) s) {
+                scratch->open_rings++;
+            }
+            dest->ring_offsets[++ring_count] = point_count;
+        }
+    }
+    dest->ring_count = ring_count;
+    size_t* fitted = realloc(dest->ring_offsets, sizeof(size_t) * (ring_count + 1));
+    dest->ring_offsets = fitted ? fitted : dest->ring_offsets;
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_slice_layers_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    hidden_cave_Slice_Pass const* pass = arg;
+    for(size_t l = begin; l < end; l++) {
+        CaveError err = hidden_cave_slice_layer(pass, pass->scratch + worker, l);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+void cave_Slices_release(cave_Slices* slices) {
+    if(!slices) { return; }
+    for(size_t i = 0; slices->layers && i < slices->layer_count; i++) {
+        free(slices->layers[i].points);
+        free(slices->layers[i].ring_offsets);
+    }
+    free(slices->layers);
+    memset(slices, 0, sizeof(cave_Slices));
+}
+
+static CaveError hidden_cave_slice(hidden_cave_Slice_Pass* pass, float const* heights, size_t threads) {
+    cave_Slices* dest = pass->dest;
+    size_t layer_count = pass->height_count;
+    threads = threads > 0 ? threads : cave_thread_hardware_count();
+    dest->layers = calloc(layer_count > 0 ? layer_count : 1, sizeof(cave_2d_Polygon));
+    pass->heights = malloc(sizeof(hidden_cave_Slice_Height) * (layer_count > 0 ? layer_count : 1));
+    pass->spans = malloc(sizeof(uint32_t) * 2 * (pass->tri_count > 0 ? pass->tri_count : 1));
+    pass->layer_start = calloc(layer_count + 1, sizeof(size_t));
+    pass->scratch = calloc(threads, sizeof(hidden_cave_Slice_Scratch));
+    CaveError err = CAVE_NO_ERROR;
+    if(!dest->layers || !pass->heights || !pass->spans || !pass->layer_start || !pass->scratch) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    dest->layer_count = dest->layers ? layer_count : 0;
+
+    if(err == CAVE_NO_ERROR) {
+        for(size_t l = 0; l < layer_count; l++) {
+            pass->heights[l] = (hidden_cave_Slice_Height) {heights[l], (uint32_t) l};
+        }
+        qsort(pass->heights, layer_count, sizeof(hidden_cave_Slice_Height), hidden_cave_slice_height_compare);
+        err = cave_parallel_for(pass->tri_count, CAVE_SLICE_GRAIN, threads, hidden_cave_slice_spans_chunk, pass);
+    }
+    //counting sorts the triangles by layer, a triangle appearing once for each layer it crosses
+    if(err == CAVE_NO_ERROR) {
+        for(size_t i = 0; i < pass->tri_count; i++) {
+            for(uint32_t l = pass->spans[2 * i]; l < pass->spans[2 * i + 1]; l++) {
+                pass->layer_start[l + 1]++;
+            }
+        }
+        for(size_t l = 0; l < layer_count; l++) {
+            pass->layer_start[l + 1] += pass->layer_start[l];
+        }
+        size_t total = pass->layer_start[layer_count];
+        pass->layer_tris = malloc(sizeof(uint32_t) * (total > 0 ? total : 1));
+        err = pass->layer_tris ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(err == CAVE_NO_ERROR) {
+        //each layer's start is moved along as it fills, ending where the next starts, and then moved back
+        for(size_t i = 0; i < pass->tri_count; i++) {
+            for(uint32_t l = pass->spans[2 * i]; l < pass->spans[2 * i + 1]; l++) {
+                pass->layer_tris[pass->layer_start[l]++] = (uint32_t) i;
+            }
+        }
+        memmove(pass->layer_start + 1, pass->layer_start, sizeof(size_t) * layer_count);
+        pass->layer_start[0] = 0;
+        free(pass->spans);
+        pass->spans = NULL;
+        err = cave_parallel_for(layer_count, 1, threads, hidden_cave_slice_layers_chunk, pass);
+    }
+
+    dest->open_rings = 0;
+    for(size_t w = 0; pass->scratch && w < threads; w++) {
+        dest->open_rings += pass->scratch[w].open_rings;
+        free(pass->scratch[w].segments);
+        free(pass->scratch[w].table);
+    }
+    free(pass->scratch);
+    free(pass->heights);
+    free(pass->spans);
+    free(pass->layer_start);
+    free(pass->layer_tris);
+    if(err != CAVE_NO_ERROR) {
+        cave_Slices_release(dest);
+    }
+    return err;
+}
+
+static bool hidden_cave_slice_heights_valid(float const* heights, size_t height_count) {
+    if((!heights && height_count > 0) || height_count >= UINT32_MAX) {
+        return false;
+    }
+    for(size_t l = 0; l < height_count; l++) {
+        if(heights[l] != heights[l]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CaveError cave_STL_Data_slice(cave_Slices* dest, cave_STL_Data const* data, float const* heights,
+                              size_t height_count, size_t threads) {
+    if(!dest || !data || (!data->tris && data->tri_count > 0)
+       || !hidden_cave_slice_heights_valid(heights, height_count)) {
+        return CAVE_DATA_ERROR;
+    }
+    memset(dest, 0, sizeof(cave_Slices));
+    hidden_cave_Slice_Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.stl = data->tris;
+    pass.tri_count = data->tri_count;
+    pass.height_count = height_count;
+    pass.dest = dest;
+    return hidden_cave_slice(&pass, heights, threads);
+}
+
+CaveError cave_Mesh_slice(cave_Slices* dest, cave_Mesh const* mesh, float const* heights, size_t height_count,
+                          size_t threads) {
+    if(!dest || !mesh || (!mesh->tris && mesh->tri_count > 0) || mesh->tri_count >= UINT32_MAX
+       || !hidden_cave_slice_heights_valid(heights, height_count)) {
+        return CAVE_DATA_ERROR;
+    }
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        if(t.a >= mesh->vert_count || t.b >= mesh->vert_count || t.c >= mesh->vert_count) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+    memset(dest, 0, sizeof(cave_Slices));
+    hidden_cave_Slice_Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.mesh = mesh;
+    pass.tri_count = mesh->tri_count;
+    pass.height_count = height_count;
+    pass.dest = dest;
+    return hidden_cave_slice(&pass, heights, threads);
+}
@@ -0,0 +1,237 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+//copy_file_range is a GNU extension
+#define _GNU_SOURCE
+
+#include "cave-writer.h"
+#include "cave-utilities.h"
+#include "cave-vecmath-internal.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#ifdef CAVE_HAS_COPY_FILE_RANGE
+#include <unistd.h>
+#endif
+#ifdef CAVE_HAS_FILE_IDS
+#include <sys/stat.h>
+#endif
+
+//bytes moved per read/write when records have to pass through memory
+#define CAVE_STL_MERGE_CHUNK (50 * 20000)
+
+void hidden_cave_decode_STL_tris(cave_STL_Tri* dest, uint8_t const* bytes, size_t count);
+void hidden_cave_encode_STL_tris(uint8_t* dest, cave_STL_Tri const* src, size_t count);
+
+//normals transform by the inverse transpose of the linear part. The cofactor matrix is that up
+//to a scale factor, which renormalizing takes care of, and it exists even for singular matrices.
+//It is given as a 3x4 affine transform that moves nothing, for the same kernel as the corners.
+static void hidden_cave_normal_matrix(cave_STL_Transform const* t, float* n) {
+    float const* m = t->m;
+    n[0] = m[5] * m[10] - m[6] * m[9];
+    n[1] = m[6] * m[8] - m[4] * m[10];
+    n[2] = m[4] * m[9] - m[5] * m[8];
+    n[3] = 0.0f;
+    n[4] = m[2] * m[9] - m[1] * m[10];
+    n[5] = m[0] * m[10] - m[2] * m[8];
+    n[6] = m[1] * m[8] - m[0] * m[9];
+    n[7] = 0.0f;
+    n[8] = m[1] * m[6] - m[2] * m[5];
+    n[9] = m[2] * m[4] - m[0] * m[6];
+    n[10] = m[0] * m[5] - m[1] * m[4];
+    n[11] = 0.0f;
+}
+
+//runs the corners of `count` decoded records through `t`, and their normals through `normal_matrix`, with the
+//vector kernels bound for this machine
+static void hidden_cave_transform_tris(cave_STL_Transform const* t, float const* normal_matrix,
+                                       cave_STL_Tri* tris, size_t count) {
+    hidden_cave_Vecmath_Kernels const* kernels = hidden_cave_vecmath_kernels();
+    size_t const stride = sizeof(cave_STL_Tri) / sizeof(float);
+    cave_Vec3_Array corners[3] = {
+            {&tris->a.x, &tris->a.y, &tris->a.z, stride},
+            {&tris->b.x, &tris->b.y, &tris->b.z, stride},
+            {&tris->c.x, &tris->c.y, &tris->c.z, stride},
+    };
+    for(int k = 0; k < 3; k++) {
+        kernels->affine3(corners + k, corners + k, t->m, count);
+    }
+    cave_Vec3_Array normals = {&tris->normal.x, &tris->normal.y, &tris->normal.z, stride};
+    kernels->affine3(&normals, &normals, normal_matrix, count);
+    kernels->normalize3(&normals, &normals, count);
+}
+
+//whether paths `a` and `b` name the same file. Without file ids to go by, only the same path does.
+static bool hidden_cave_same_file(char const* a, char const* b) {
+    if(strcmp(a, b) == 0) {
+        return true;
+    }
+#ifdef CAVE_HAS_FILE_IDS
+    struct stat sa, sb;
+    return stat(a, &sa) == 0 && stat(b, &sb) == 0 && sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+#else
+    return false;
+#endif
+}
+
+//checks that `fp` holds a binary STL file, and returns its triangle count through `tri_count`.
+static CaveError hidden_cave_validate_STL_file(FILE* fp, uint32_t* tri_count) {
+    long file_len = cave_file_len(fp);
+    if(file_len < 0) {
+        return CAVE_FILE_ERROR;
+    }
+    if(file_len < 84 || (file_len - 84) % 50 != 0) {
+        return CAVE_DATA_ERROR;
+    }
+    uint8_t count_bytes[4];
+    if(fseek(fp, 80, SEEK_SET) != 0 || fread(count_bytes, 1, 4, fp) != 4) {
+        return CAVE_FILE_ERROR;
+    }
+    memcpy(tri_count, count_bytes, 4);
+    if(*tri_count != (unsigned long) (file_len - 84) / 50) {
+        return CAVE_DATA_ERROR;
+    }
+    return CAVE_NO_ERROR;
+}
+
+#ifdef CAVE_HAS_COPY_FILE_RANGE
+//lets the kernel move the records without them passing through user space. Returns the number
+//of bytes copied, which is less than `len` if the filesystem doesn't support it.
+static size_t hidden_cave_copy_in_kernel(FILE* dest, FILE* src, size_t len) {
+    if(fflush(dest) != 0) {
+        return 0;
+    }
+    loff_t in_off = 84;
+    loff_t out_off = ftell(dest);
+    if(out_off < 0) {
+        return 0;
+    }
+    size_t copied = 0;
+    while(copied < len) {
+        ssize_t ret = copy_file_range(fileno(src), &in_off, fileno(dest), &out_off, len - copied, 0);
+        if(ret <= 0) {
+            break;
+        }
+        copied += (size_t) ret;
+    }
+    fseek(dest, 0, SEEK_END);
+    return copied;
+}
+#endif
+
+static CaveError hidden_cave_copy_records(FILE* dest, FILE* src, uint32_t tri_count,
+                                          cave_STL_Transform const* transform, uint8_t* chunk, cave_STL_Tri* tris) {
+    size_t remaining = (size_t) tri_count * 50;
+    size_t skip = 0;
+#ifdef CAVE_HAS_COPY_FILE_RANGE
+    if(!transform) {
+        skip = hidden_cave_copy_in_kernel(dest, src, remaining);
+        remaining -= skip;
+    }
+#endif
+    if(fseek(src, 84 + (long) skip, SEEK_SET) != 0) {
+        return CAVE_FILE_ERROR;
+    }
+
+    float normal_matrix[12] = {0};
+    if(transform) {
+        hidden_cave_normal_matrix(transform, normal_matrix);
+    }
+    while(remaining > 0) {
+        size_t len = remaining < CAVE_STL_MERGE_CHUNK ? remaining : CAVE_STL_MERGE_CHUNK;
+        if(fread(chunk, 1, len, src) != len) {
+            return CAVE_FILE_ERROR;
+        }
+        //records are only decoded when they have to be changed
+        if(transform) {
+            hidden_cave_decode_STL_tris(tris, chunk, len / 50);
+            hidden_cave_transform_tris(transform, normal_matrix, tris, len / 50);
+            hidden_cave_encode_STL_tris(chunk, tris, len / 50);
+        }
+        if(fwrite(chunk, 1, len, dest) != len) {
+            return CAVE_FILE_ERROR;
+        }
+        remaining -= len;
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_STL_merge_files(char const* dest_path, char const* const* src_paths, size_t src_count,
+                               cave_STL_Transform const* const* transforms, uint8_t const* header) {
+    if(!dest_path || (!src_paths && src_count != 0)) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //every input is checked before the output is touched, and none may be the output, which is truncated
+    //before they are read
+    uint32_t* counts = malloc(sizeof(uint32_t) * (src_count ? src_count : 1));
+    if(!counts) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    uint32_t total = 0;
+    CaveError err = CAVE_NO_ERROR;
+    for(size_t i = 0; i < src_count && err == CAVE_NO_ERROR; i++) {
+        if(!src_paths[i] || hidden_cave_same_file(dest_path, src_paths[i])) {
+            err = CAVE_DATA_ERROR;
+            break;
+        }
+        FILE* fp = fopen(src_paths[i], "rb");
+        if(!fp) {
+            err = CAVE_FILE_ERROR;
+            break;
+        }
+        err = hidden_cave_validate_STL_file(fp, counts + i);
+        fclose(fp);
+        if(err == CAVE_NO_ERROR && counts[i] > UINT32_MAX - total) {
+            err = CAVE_DATA_ERROR;
+        }
+        if(err == CAVE_NO_ERROR) {
+            total += counts[i];
+        }
+    }
+    if(err != CAVE_NO_ERROR) {
+        free(counts);
+        return err;
+    }
+
+    FILE* dest = fopen(dest_path, "wb");
+    uint8_t* chunk = malloc(CAVE_STL_MERGE_CHUNK);
+    cave_STL_Tri* tris = malloc(sizeof(cave_STL_Tri) * (CAVE_STL_MERGE_CHUNK / 50));
+    if(!dest || !chunk || !tris) {
+        err = dest ? CAVE_INSUFFICIENT_MEMORY_ERROR : CAVE_FILE_ERROR;
+    } else {
+        uint8_t start[84];
+        memset(start, 0, 80);
+        if(header) {
+            memcpy(start, header, 80);
+        }
+        memcpy(start + 80, &total, 4);
+        if(fwrite(start, 1, 84, dest) != 84) {
+            err = CAVE_FILE_ERROR;
+        }
+    }
+
+    for(size_t i = 0; i < src_count && err == CAVE_NO_ERROR; i++) {
+        FILE* src = fopen(src_paths[i], "rb");
+        if(!src) {
+            err = CAVE_FILE_ERROR;
+            break;
+        }
+        cave_STL_Transform const* transform = transforms ? transforms[i] : NULL;
+        err = hidden_cave_copy_records(dest, src, counts[i], transform, chunk, tris);
+        fclose(src);
+    }
+
+    if(dest && fclose(dest) != 0 && err == CAVE_NO_ERROR) {
+        err = CAVE_FILE_ERROR;
+    }
+    if(err != CAVE_NO_ERROR && dest) {
+        remove(dest_path);
+    }
+    free(chunk);
+    free(tris);
+    free(counts);
+    return err;
+}
@@ -0,0 +1,188 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef CAVE_HAS_THREADS
+#include <unistd.h>
+
+bool cave_threads_available(void) {
+    return true;
+}
+
+size_t cave_thread_hardware_count(void) {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t) count : 1;
+}
+
+CaveError cave_thread_start(cave_Thread* thread, CAVE_THREAD_FN fn, void* arg) {
+    return pthread_create(thread, NULL, fn, arg) == 0 ? CAVE_NO_ERROR : CAVE_UNKNOWN_ERROR;
+}
+
+void cave_thread_join(cave_Thread thread) {
+    pthread_join(thread, NULL);
+}
+
+CaveError cave_mutex_init(cave_Mutex* mutex) {
+    return pthread_mutex_init(mutex, NULL) == 0 ? CAVE_NO_ERROR : CAVE_UNKNOWN_ERROR;
+}
+
+void cave_mutex_destroy(cave_Mutex* mutex) { pthread_mutex_destroy(mutex); }
+void cave_mutex_lock(cave_Mutex* mutex) { pthread_mutex_lock(mutex); }
+void cave_mutex_unlock(cave_Mutex* mutex) { pthread_mutex_unlock(mutex); }
+
+CaveError cave_cond_init(cave_Cond* cond) {
+    return pthread_cond_init(cond, NULL) == 0 ? CAVE_NO_ERROR : CAVE_UNKNOWN_ERROR;
+}
+
+void cave_cond_destroy(cave_Cond* cond) { pthread_cond_destroy(cond); }
+void cave_cond_wait(cave_Cond* cond, cave_Mutex* mutex) { pthread_cond_wait(cond, mutex); }
+void cave_cond_broadcast(cave_Cond* cond) { pthread_cond_broadcast(cond); }
+
+void cave_once(cave_Once* once, void (*fn)(void)) { pthread_once(once, fn); }
+
+#else
+
+bool cave_threads_available(void) {
+    return false;
+}
+
+size_t cave_thread_hardware_count(void) {
+    return 1;
+}
+
+CaveError cave_thread_start(cave_Thread* thread, CAVE_THREAD_FN fn, void* arg) {
+    (void) thread;
+    (void) fn;
+    (void) arg;
+    return CAVE_UNKNOWN_ERROR;
+}
+
+void cave_thread_join(cave_Thread thread) { (void) thread; }
+
+CaveError cave_mutex_init(cave_Mutex* mutex) {
+    *mutex = 0;
+    return CAVE_NO_ERROR;
+}
+
+void cave_mutex_destroy(cave_Mutex* mutex) { (void) mutex; }
+void cave_mutex_lock(cave_Mutex* mutex) { (void) mutex; }
+void cave_mutex_unlock(cave_Mutex* mutex) { (void) mutex; }
+
+CaveError cave_cond_init(cave_Cond* cond) {
+    *cond = 0;
+    return CAVE_NO_ERROR;
+}
+
+void cave_cond_destroy(cave_Cond* cond) { (void) cond; }
+void cave_cond_wait(cave_Cond* cond, cave_Mutex* mutex) { (void) cond; (void) mutex; }
+void cave_cond_broadcast(cave_Cond* cond) { (void) cond; }
+
+void cave_once(cave_Once* once, void (*fn)(void)) {
+    if(!*once) {
+        *once = 1;
+        fn();
+    }
+}
+
+#endif
+
+typedef struct hidden_cave_Parallel_For {
+    size_t count;
+    size_t grain;
+    size_t next;
+    CaveError err;
+    CAVE_PARALLEL_FN fn;
+    void* arg;
+    cave_Mutex lock;
+} hidden_cave_Parallel_For;
+
+typedef struct hidden_cave_Parallel_Worker {
+    hidden_cave_Parallel_For* job;
+    size_t index;
+} hidden_cave_Parallel_Worker;
+
+static void* hidden_cave_parallel_worker(void* arg) {
+    hidden_cave_Parallel_Worker* worker = arg;
+    hidden_cave_Parallel_For* job = worker->job;
+    while(true) {
+        cave_mutex_lock(&job->lock);
+        size_t begin = job->next;
+        bool done = job->err != CAVE_NO_ERROR || begin >= job->count;
+        if(!done) {
+            job->next = job->count - begin > job->grain ? begin + job->grain : job->count;
+        }
+        size_t end = job->next;
+        cave_mutex_unlock(&job->lock);
+        if(done) {
+            break;
+        }
+
+        CaveError err = job->fn(job->arg, worker->index, begin, end);
+        if(err != CAVE_NO_ERROR) {
+            cave_mutex_lock(&job->lock);
+            if(job->err == CAVE_NO_ERROR) {
+                job->err = err;
+            }
+            cave_mutex_unlock(&job->lock);
+        }
+    }
+    return NULL;
+}
+
+CaveError cave_parallel_for(size_t count, size_t grain, size_t threads, CAVE_PARALLEL_FN fn, void* arg) {
+    if(count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    grain = grain > 0 ? grain : 1;
+    size_t chunks = (count + grain - 1) / grain;
+    threads = threads < chunks ? threads : chunks;
+    if(threads <= 1 || !cave_threads_available()) {
+        for(size_t begin = 0; begin < count; begin += grain) {
+            CaveError err = fn(arg, 0, begin, count - begin > grain ? begin + grain : count);
+            if(err != CAVE_NO_ERROR) {
+                return err;
+            }
+        }
+        return CAVE_NO_ERROR;
+    }
+
+    hidden_cave_Parallel_For job;
+    memset(&job, 0, sizeof(job));
+    job.count = count;
+    job.grain = grain;
+    job.err = CAVE_NO_ERROR;
+    job.fn = fn;
+    job.arg = arg;
+    if(cave_mutex_init(&job.lock) != CAVE_NO_ERROR) {
+        return CAVE_UNKNOWN_ERROR;
+    }
+    cave_Thread* helpers = malloc(sizeof(cave_Thread) * (threads - 1));
+    hidden_cave_Parallel_Worker* workers = malloc(sizeof(hidden_cave_Parallel_Worker) * threads);
+    if(!helpers || !workers) {
+        free(helpers);
+        free(workers);
+        cave_mutex_destroy(&job.lock);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    //the calling thread is worker 0
+    size_t started = 0;
+    for(size_t i = 0; i < threads; i++) {
+        workers[i] = (hidden_cave_Parallel_Worker) {&job, i};
+    }
+    while(started + 1 < threads &&
+          cave_thread_start(helpers + started, hidden_cave_parallel_worker, workers + started + 1) == CAVE_NO_ERROR) {
+        started += 1;
+    }
+    hidden_cave_parallel_worker(workers);
+    for(size_t i = 0; i < started; i++) {
+        cave_thread_join(helpers[i]);
+    }
+    free(helpers);
+    free(workers);
+    cave_mutex_destroy(&job.lock);
+    return job.err;
+}
@@ -0,0 +1,71 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_THREADS_H
+#define CAVE_THREADS_H
+
+#include "cave-error.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * A thin, internal wrapper over the host's threads. Cave is built with threads when the
+ * `CAVE_USE_THREADS` CMake option is on and pthreads is found, in which case `CAVE_HAS_THREADS`
+ * is defined. Without threads, `cave_thread_start` always fails and callers are expected to
+ * fall back to doing the work on the calling thread; the mutex and condition variable
+ * functions become no-ops so that code using them needs no #ifdefs of its own.
+ */
+
+#ifdef CAVE_HAS_THREADS
+#include <pthread.h>
+typedef pthread_t cave_Thread;
+typedef pthread_mutex_t cave_Mutex;
+typedef pthread_cond_t cave_Cond;
+typedef pthread_once_t cave_Once;
+#define CAVE_ONCE_INIT PTHREAD_ONCE_INIT
+#else
+typedef int cave_Thread;
+typedef int cave_Mutex;
+typedef int cave_Cond;
+typedef int cave_Once;
+#define CAVE_ONCE_INIT 0
+#endif
+
+typedef void* (*CAVE_THREAD_FN)(void* arg);
+
+//true if this build of Cave can start threads.
+bool cave_threads_available(void);
+
+//the number of hardware threads, or 1 if that can't be determined or Cave was built without threads.
+size_t cave_thread_hardware_count(void);
+
+//returns CAVE_UNKNOWN_ERROR if the thread couldn't be started, including when Cave is built without threads.
+CaveError cave_thread_start(cave_Thread* thread, CAVE_THREAD_FN fn, void* arg);
+void cave_thread_join(cave_Thread thread);
+
+CaveError cave_mutex_init(cave_Mutex* mutex);
+void cave_mutex_destroy(cave_Mutex* mutex);
+void cave_mutex_lock(cave_Mutex* mutex);
+void cave_mutex_unlock(cave_Mutex* mutex);
+
+CaveError cave_cond_init(cave_Cond* cond);
+void cave_cond_destroy(cave_Cond* cond);
+void cave_cond_wait(cave_Cond* cond, cave_Mutex* mutex);
+void cave_cond_broadcast(cave_Cond* cond);
+
+//calls `fn` the first time it's called with `once`, which starts as `CAVE_ONCE_INIT`. Threads calling it at the
+//same time wait for that call to finish, and everything `fn` stored is then visible to all of them. Without
+//threads it is just a flag.
+void cave_once(cave_Once* once, void (*fn)(void));
+
+typedef CaveError (*CAVE_PARALLEL_FN)(void* arg, size_t worker, size_t begin, size_t end);
+
+//Calls `fn` on consecutive chunks of at most `grain` items covering `[0, count)`, spread over up to `threads`
+//workers, the calling thread being one of them. Workers take the next chunk as they finish one, so uneven
+//chunks still balance out. `worker` is below `threads` and no two workers share one, so it can index
+//per-worker state. Once a chunk fails no more are started, and the first error is returned.
+//Without threads, or if none can be started, every chunk runs on the calling thread as worker 0.
+CaveError cave_parallel_for(size_t count, size_t grain, size_t threads, CAVE_PARALLEL_FN fn, void* arg);
+
+#endif //CAVE_THREADS_H
@@ -3,6 +3,7 @@
 //
 
 #include "cave-utilities.h"
+#include <string.h>
 
 long cave_file_len(FILE* file){
     fseek(file, 0, SEEK_END);
@@ -11,3 +12,91 @@ long cave_file_len(FILE* file){
     return byte_count;
 }
 
+
+#define CAVE_HASH_P1 (11400714785074694791ull)
+#define CAVE_HASH_P2 (14029467366897019727ull)
+#define CAVE_HASH_P3 (1609587929392839161ull)
+#define CAVE_HASH_P4 (9650029242287828579ull)
+#define CAVE_HASH_P5 (2870177450012600261ull)
+
+static uint64_t hidden_cave_rotl64(uint64_t v, int r) {
+    return (v << r) | (v >> (64 - r));
+}
+
+//like the STL code, assumes a little endian host
+static uint64_t hidden_cave_read64(uint8_t const* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static uint32_t hidden_cave_read32(uint8_t const* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static uint64_t hidden_cave_hash_round(uint64_t acc, uint64_t input) {
+    acc += input * CAVE_HASH_P2;
+    acc = hidden_cave_rotl64(acc, 31);
+    return acc * CAVE_HASH_P1;
+}
+
+static uint64_t hidden_cave_hash_merge(uint64_t acc, uint64_t v) {
+    acc ^= hidden_cave_hash_round(0, v);
+    return acc * CAVE_HASH_P1 + CAVE_HASH_P4;
+}
+
+uint64_t cave_hash64(void const* bytes, size_t len, uint64_t seed) {
+    uint8_t const* p = bytes;
+    uint8_t const* const end = p + len;
+    uint64_t h;
+
+    if(len >= 32) {
+        //four independent lanes keep the multipliers busy
+        uint64_t v1 = seed + CAVE_HASH_P1 + CAVE_HASH_P2;
+        uint64_t v2 = seed + CAVE_HASH_P2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - CAVE_HASH_P1;
+        uint8_t const* const limit = end - 32;
+        do {
+            v1 = hidden_cave_hash_round(v1, hidden_cave_read64(p));
+            v2 = hidden_cave_hash_round(v2, hidden_cave_read64(p + 8));
+            v3 = hidden_cave_hash_round(v3, hidden_cave_read64(p + 16));
+            v4 = hidden_cave_hash_round(v4, hidden_cave_read64(p + 24));
+            p += 32;
+        } while(p <= limit);
+        h = hidden_cave_rotl64(v1, 1) + hidden_cave_rotl64(v2, 7) +
+            hidden_cave_rotl64(v3, 12) + hidden_cave_rotl64(v4, 18);
+        h = hidden_cave_hash_merge(h, v1);
+        h = hidden_cave_hash_merge(h, v2);
+        h = hidden_cave_hash_merge(h, v3);
+        h = hidden_cave_hash_merge(h, v4);
+    } else {
+        h = seed + CAVE_HASH_P5;
+    }
+    h += (uint64_t) len;
+
+    while(end - p >= 8) {
+        h ^= hidden_cave_hash_round(0, hidden_cave_read64(p));
+        h = hidden_cave_rotl64(h, 27) * CAVE_HASH_P1 + CAVE_HASH_P4;
+        p += 8;
+    }
+    if(end - p >= 4) {
+        h ^= (uint64_t) hidden_cave_read32(p) * CAVE_HASH_P1;
+        h = hidden_cave_rotl64(h, 23) * CAVE_HASH_P2 + CAVE_HASH_P3;
+        p += 4;
+    }
+    while(p < end) {
+        h ^= (uint64_t) (*p) * CAVE_HASH_P5;
+        h = hidden_cave_rotl64(h, 11) * CAVE_HASH_P1;
+        p += 1;
+    }
+
+    h ^= h >> 33;
+    h *= CAVE_HASH_P2;
+    h ^= h >> 29;
+    h *= CAVE_HASH_P3;
+    h ^= h >> 32;
+    return h;
+}
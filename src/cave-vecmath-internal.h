@@ -0,0 +1,61 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#ifndef CAVE_VECMATH_INTERNAL_H
+#define CAVE_VECMATH_INTERNAL_H
+
+#include "cave-vecmath.h"
+#include "cave-cpu-internal.h"
+#include <stddef.h>
+
+//The kernels behind cave-vecmath.h, one table of them per instruction set. Arguments have been checked by the
+//time a kernel sees them, and `count` may be 0. The SIMD kernels do whole blocks and hand what's left over to
+//the scalar ones, so every table gives exactly the same results.
+
+typedef struct hidden_cave_Vecmath_Kernels {
+    char const* name;
+    //over plain arrays of floats
+    void (*add)(float* dest, float const* a, float const* b, size_t count);
+    void (*sub)(float* dest, float const* a, float const* b, size_t count);
+    //`a[i] < b[i] ? a[i] : b[i]` and `a[i] > b[i] ? a[i] : b[i]`, which is what minps and maxps do
+    void (*min)(float* dest, float const* a, float const* b, size_t count);
+    void (*max)(float* dest, float const* a, float const* b, size_t count);
+    void (*scale)(float* dest, float const* src, float scale, size_t count);
+    void (*dot3)(float* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b, size_t count);
+    void (*cross3)(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b, size_t count);
+    //(b - a) x (c - a), the normal of triangle abc, as long as twice its area
+    void (*tri_cross3)(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                       cave_Vec3_Array const* c, size_t count);
+    void (*normalize3)(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, size_t count);
+    //folds the points into `min` and `max`, three floats each
+    void (*bounds3)(float* min, float* max, cave_Vec3_Array const* src, size_t count);
+    void (*affine3)(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, float const* m, size_t count);
+    void (*project3)(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, float const* m, size_t count);
+    void (*dot2)(float* dest, cave_2Point const* a, cave_2Point const* b, size_t count);
+    //folds the points into `min` and `max`, two floats each
+    void (*bounds2)(float* min, float* max, cave_2Point const* src, size_t count);
+    void (*affine2)(cave_2Point* dest, cave_2Point const* src, float const* m, size_t count);
+} hidden_cave_Vecmath_Kernels;
+
+extern hidden_cave_Vecmath_Kernels const hidden_cave_vecmath_scalar;
+#ifdef CAVE_CPU_X86
+extern hidden_cave_Vecmath_Kernels const hidden_cave_vecmath_sse2;
+extern hidden_cave_Vecmath_Kernels const hidden_cave_vecmath_avx2;
+#endif
+
+//the table bound for the cave_Cpu_Path in use
+hidden_cave_Vecmath_Kernels const* hidden_cave_vecmath_kernels(void);
+
+//how an array's elements are laid out, which decides how SIMD kernels load them
+enum {
+    CAVE_VEC3_GATHERED, //any other stride, a float at a time
+    CAVE_VEC3_STREAMS, //stride 1, x, y and z each contiguous
+    CAVE_VEC3_PACKED, //stride 3 with y and z right after x, as cave_3Points are
+};
+int hidden_cave_vec3_layout(cave_Vec3_Array const* array);
+
+//`array` starting from its element `index`
+cave_Vec3_Array hidden_cave_vec3_from(cave_Vec3_Array const* array, size_t index);
+
+#endif //CAVE_VECMATH_INTERNAL_H
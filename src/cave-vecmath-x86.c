@@ -0,0 +1,662 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-vecmath-internal.h"
+
+//SSE2 and AVX kernels, each function built for its instruction set with a target attribute, so that this file
+//compiles with default flags and nothing in it runs unless the host has been checked for it.
+//
+//Kernels work on x, y and z held in separate registers, four or eight vectors at a time. Streams load
+//straight into them. Packed cave_3Points are loaded as three registers of interleaved floats and shuffled
+//apart, as in Intel's "3D Vector Normalization Using 256-Bit Intel AVX", and other strides are gathered a float
+//at a time. Each kernel does as many whole blocks as it can and leaves the rest to the scalar kernels.
+//
+//Sums are taken in the same order as the scalar kernels take them, and nothing is fused, so results agree.
+
+#ifdef CAVE_CPU_X86
+
+#include <immintrin.h>
+
+#define CAVE_SSE2 __attribute__((target("sse2")))
+#define CAVE_AVX2 __attribute__((target("avx2")))
+
+/*
+ * SSE2, four at a time
+ */
+
+CAVE_SSE2 static void hidden_cave_sse2_load3(cave_Vec3_Array const* array, int layout, size_t i, __m128* x,
+                                             __m128* y, __m128* z) {
+    if(layout == CAVE_VEC3_STREAMS) {
+        *x = _mm_loadu_ps(array->x + i);
+        *y = _mm_loadu_ps(array->y + i);
+        *z = _mm_loadu_ps(array->z + i);
+    } else if(layout == CAVE_VEC3_PACKED) {
+        float const* p = array->x + 3 * i;
+        __m128 m0 = _mm_loadu_ps(p); //x0 y0 z0 x1
+        __m128 m1 = _mm_loadu_ps(p + 4); //y1 z1 x2 y2
+        __m128 m2 = _mm_loadu_ps(p + 8); //z2 x3 y3 z3
+        __m128 xy = _mm_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+        __m128 yz = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+        *x = _mm_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        *y = _mm_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        *z = _mm_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+    } else {
+        size_t s = array->stride, o = i * s;
+        *x = _mm_setr_ps(array->x[o], array->x[o + s], array->x[o + 2 * s], array->x[o + 3 * s]);
+        *y = _mm_setr_ps(array->y[o], array->y[o + s], array->y[o + 2 * s], array->y[o + 3 * s]);
+        *z = _mm_setr_ps(array->z[o], array->z[o + s], array->z[o + 2 * s], array->z[o + 3 * s]);
+    }
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_store3(cave_Vec3_Array const* array, int layout, size_t i, __m128 x,
+                                              __m128 y, __m128 z) {
+    if(layout == CAVE_VEC3_STREAMS) {
+        _mm_storeu_ps(array->x + i, x);
+        _mm_storeu_ps(array->y + i, y);
+        _mm_storeu_ps(array->z + i, z);
+    } else if(layout == CAVE_VEC3_PACKED) {
+        float* p = array->x + 3 * i;
+        __m128 rxy = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 ryz = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 rzx = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_ps(p, _mm_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(p + 4, _mm_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm_storeu_ps(p + 8, _mm_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1)));
+    } else {
+        float t[3][4];
+        _mm_storeu_ps(t[0], x);
+        _mm_storeu_ps(t[1], y);
+        _mm_storeu_ps(t[2], z);
+        size_t s = array->stride;
+        for(size_t k = 0; k < 4; k++) {
+            array->x[(i + k) * s] = t[0][k];
+            array->y[(i + k) * s] = t[1][k];
+            array->z[(i + k) * s] = t[2][k];
+        }
+    }
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_add(float* dest, float const* a, float const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    hidden_cave_vecmath_scalar.add(dest + i, a + i, b + i, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_sub(float* dest, float const* a, float const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    hidden_cave_vecmath_scalar.sub(dest + i, a + i, b + i, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_min(float* dest, float const* a, float const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_min_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    hidden_cave_vecmath_scalar.min(dest + i, a + i, b + i, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_max(float* dest, float const* a, float const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_max_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    hidden_cave_vecmath_scalar.max(dest + i, a + i, b + i, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_scale(float* dest, float const* src, float scale, size_t count) {
+    __m128 s = _mm_set1_ps(scale);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(dest + i, _mm_mul_ps(_mm_loadu_ps(src + i), s));
+    }
+    hidden_cave_vecmath_scalar.scale(dest + i, src + i, scale, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_dot3(float* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                                            size_t count) {
+    int la = hidden_cave_vec3_layout(a), lb = hidden_cave_vec3_layout(b);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 ax, ay, az, bx, by, bz;
+        hidden_cave_sse2_load3(a, la, i, &ax, &ay, &az);
+        hidden_cave_sse2_load3(b, lb, i, &bx, &by, &bz);
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+        _mm_storeu_ps(dest + i, d);
+    }
+    cave_Vec3_Array ra = hidden_cave_vec3_from(a, i), rb = hidden_cave_vec3_from(b, i);
+    hidden_cave_vecmath_scalar.dot3(dest + i, &ra, &rb, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_cross3(cave_Vec3_Array const* dest, cave_Vec3_Array const* a,
+                                              cave_Vec3_Array const* b, size_t count) {
+    int la = hidden_cave_vec3_layout(a), lb = hidden_cave_vec3_layout(b), ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 ax, ay, az, bx, by, bz;
+        hidden_cave_sse2_load3(a, la, i, &ax, &ay, &az);
+        hidden_cave_sse2_load3(b, lb, i, &bx, &by, &bz);
+        __m128 x = _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(az, bx), _mm_mul_ps(ax, bz));
+        __m128 z = _mm_sub_ps(_mm_mul_ps(ax, by), _mm_mul_ps(ay, bx));
+        hidden_cave_sse2_store3(dest, ld, i, x, y, z);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i);
+    cave_Vec3_Array ra = hidden_cave_vec3_from(a, i), rb = hidden_cave_vec3_from(b, i);
+    hidden_cave_vecmath_scalar.cross3(&rd, &ra, &rb, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_tri_cross3(cave_Vec3_Array const* dest, cave_Vec3_Array const* a,
+                                                 cave_Vec3_Array const* b, cave_Vec3_Array const* c, size_t count) {
+    int la = hidden_cave_vec3_layout(a), lb = hidden_cave_vec3_layout(b), lc = hidden_cave_vec3_layout(c);
+    int ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 ax, ay, az, bx, by, bz, cx, cy, cz;
+        hidden_cave_sse2_load3(a, la, i, &ax, &ay, &az);
+        hidden_cave_sse2_load3(b, lb, i, &bx, &by, &bz);
+        hidden_cave_sse2_load3(c, lc, i, &cx, &cy, &cz);
+        __m128 ux = _mm_sub_ps(bx, ax), uy = _mm_sub_ps(by, ay), uz = _mm_sub_ps(bz, az);
+        __m128 vx = _mm_sub_ps(cx, ax), vy = _mm_sub_ps(cy, ay), vz = _mm_sub_ps(cz, az);
+        __m128 x = _mm_sub_ps(_mm_mul_ps(uy, vz), _mm_mul_ps(uz, vy));
+        __m128 y = _mm_sub_ps(_mm_mul_ps(uz, vx), _mm_mul_ps(ux, vz));
+        __m128 z = _mm_sub_ps(_mm_mul_ps(ux, vy), _mm_mul_ps(uy, vx));
+        hidden_cave_sse2_store3(dest, ld, i, x, y, z);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i), ra = hidden_cave_vec3_from(a, i);
+    cave_Vec3_Array rb = hidden_cave_vec3_from(b, i), rc = hidden_cave_vec3_from(c, i);
+    hidden_cave_vecmath_scalar.tri_cross3(&rd, &ra, &rb, &rc, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_normalize3(cave_Vec3_Array const* dest, cave_Vec3_Array const* src,
+                                                  size_t count) {
+    int ls = hidden_cave_vec3_layout(src), ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        hidden_cave_sse2_load3(src, ls, i, &x, &y, &z);
+        __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+        //zero vectors divide to NaN, which the mask clears back to zero
+        __m128 nonzero = _mm_cmpgt_ps(len, _mm_setzero_ps());
+        x = _mm_and_ps(nonzero, _mm_div_ps(x, len));
+        y = _mm_and_ps(nonzero, _mm_div_ps(y, len));
+        z = _mm_and_ps(nonzero, _mm_div_ps(z, len));
+        hidden_cave_sse2_store3(dest, ld, i, x, y, z);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i), rs = hidden_cave_vec3_from(src, i);
+    hidden_cave_vecmath_scalar.normalize3(&rd, &rs, count - i);
+}
+
+//min and max take their second operand when the first is NaN, just as the scalar comparisons do
+CAVE_SSE2 static void hidden_cave_sse2_bounds3(float* min, float* max, cave_Vec3_Array const* src, size_t count) {
+    int ls = hidden_cave_vec3_layout(src);
+    __m128 lo[3] = {_mm_set1_ps(min[0]), _mm_set1_ps(min[1]), _mm_set1_ps(min[2])};
+    __m128 hi[3] = {_mm_set1_ps(max[0]), _mm_set1_ps(max[1]), _mm_set1_ps(max[2])};
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 p[3];
+        hidden_cave_sse2_load3(src, ls, i, &p[0], &p[1], &p[2]);
+        for(int k = 0; k < 3; k++) {
+            lo[k] = _mm_min_ps(p[k], lo[k]);
+            hi[k] = _mm_max_ps(p[k], hi[k]);
+        }
+    }
+    for(int k = 0; k < 3; k++) {
+        float l[4], h[4];
+        _mm_storeu_ps(l, lo[k]);
+        _mm_storeu_ps(h, hi[k]);
+        for(int lane = 0; lane < 4; lane++) {
+            min[k] = l[lane] < min[k] ? l[lane] : min[k];
+            max[k] = h[lane] > max[k] ? h[lane] : max[k];
+        }
+    }
+    cave_Vec3_Array rs = hidden_cave_vec3_from(src, i);
+    hidden_cave_vecmath_scalar.bounds3(min, max, &rs, count - i);
+}
+
+//one row of a matrix applied to x, y and z, summed left to right
+CAVE_SSE2 static __m128 hidden_cave_sse2_row(float const* m, __m128 x, __m128 y, __m128 z) {
+    __m128 sum = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0]), x), _mm_mul_ps(_mm_set1_ps(m[1]), y));
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(m[2]), z));
+    return _mm_add_ps(sum, _mm_set1_ps(m[3]));
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_affine3(cave_Vec3_Array const* dest, cave_Vec3_Array const* src,
+                                               float const* m, size_t count) {
+    int ls = hidden_cave_vec3_layout(src), ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        hidden_cave_sse2_load3(src, ls, i, &x, &y, &z);
+        __m128 tx = hidden_cave_sse2_row(m, x, y, z);
+        __m128 ty = hidden_cave_sse2_row(m + 4, x, y, z);
+        __m128 tz = hidden_cave_sse2_row(m + 8, x, y, z);
+        hidden_cave_sse2_store3(dest, ld, i, tx, ty, tz);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i), rs = hidden_cave_vec3_from(src, i);
+    hidden_cave_vecmath_scalar.affine3(&rd, &rs, m, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_project3(cave_Vec3_Array const* dest, cave_Vec3_Array const* src,
+                                                float const* m, size_t count) {
+    int ls = hidden_cave_vec3_layout(src), ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 x, y, z;
+        hidden_cave_sse2_load3(src, ls, i, &x, &y, &z);
+        __m128 w = hidden_cave_sse2_row(m + 12, x, y, z);
+        __m128 tx = _mm_div_ps(hidden_cave_sse2_row(m, x, y, z), w);
+        __m128 ty = _mm_div_ps(hidden_cave_sse2_row(m + 4, x, y, z), w);
+        __m128 tz = _mm_div_ps(hidden_cave_sse2_row(m + 8, x, y, z), w);
+        hidden_cave_sse2_store3(dest, ld, i, tx, ty, tz);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i), rs = hidden_cave_vec3_from(src, i);
+    hidden_cave_vecmath_scalar.project3(&rd, &rs, m, count - i);
+}
+
+//splits four cave_2Points into their x and y
+CAVE_SSE2 static void hidden_cave_sse2_load2(cave_2Point const* points, __m128* x, __m128* y) {
+    __m128 m0 = _mm_loadu_ps(&points->x);
+    __m128 m1 = _mm_loadu_ps(&points->x + 4);
+    *x = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(2, 0, 2, 0));
+    *y = _mm_shuffle_ps(m0, m1, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_dot2(float* dest, cave_2Point const* a, cave_2Point const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 ax, ay, bx, by;
+        hidden_cave_sse2_load2(a + i, &ax, &ay);
+        hidden_cave_sse2_load2(b + i, &bx, &by);
+        _mm_storeu_ps(dest + i, _mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)));
+    }
+    hidden_cave_vecmath_scalar.dot2(dest + i, a + i, b + i, count - i);
+}
+
+//lanes alternate x and y, since the points are taken two at a time as they lie
+CAVE_SSE2 static void hidden_cave_sse2_bounds2(float* min, float* max, cave_2Point const* src, size_t count) {
+    __m128 lo = _mm_setr_ps(min[0], min[1], min[0], min[1]);
+    __m128 hi = _mm_setr_ps(max[0], max[1], max[0], max[1]);
+    size_t i = 0;
+    for(; i + 2 <= count; i += 2) {
+        __m128 p = _mm_loadu_ps(&src[i].x);
+        lo = _mm_min_ps(p, lo);
+        hi = _mm_max_ps(p, hi);
+    }
+    float l[4], h[4];
+    _mm_storeu_ps(l, lo);
+    _mm_storeu_ps(h, hi);
+    for(int lane = 0; lane < 4; lane++) {
+        min[lane & 1] = l[lane] < min[lane & 1] ? l[lane] : min[lane & 1];
+        max[lane & 1] = h[lane] > max[lane & 1] ? h[lane] : max[lane & 1];
+    }
+    hidden_cave_vecmath_scalar.bounds2(min, max, src + i, count - i);
+}
+
+CAVE_SSE2 static void hidden_cave_sse2_affine2(cave_2Point* dest, cave_2Point const* src, float const* m,
+                                               size_t count) {
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m128 x, y;
+        hidden_cave_sse2_load2(src + i, &x, &y);
+        __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0]), x), _mm_mul_ps(_mm_set1_ps(m[1]), y)),
+                               _mm_set1_ps(m[2]));
+        __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[3]), x), _mm_mul_ps(_mm_set1_ps(m[4]), y)),
+                               _mm_set1_ps(m[5]));
+        _mm_storeu_ps(&dest[i].x, _mm_unpacklo_ps(tx, ty));
+        _mm_storeu_ps(&dest[i].x + 4, _mm_unpackhi_ps(tx, ty));
+    }
+    hidden_cave_vecmath_scalar.affine2(dest + i, src + i, m, count - i);
+}
+
+hidden_cave_Vecmath_Kernels const hidden_cave_vecmath_sse2 = {
+        "sse2",
+        hidden_cave_sse2_add,
+        hidden_cave_sse2_sub,
+        hidden_cave_sse2_min,
+        hidden_cave_sse2_max,
+        hidden_cave_sse2_scale,
+        hidden_cave_sse2_dot3,
+        hidden_cave_sse2_cross3,
+        hidden_cave_sse2_tri_cross3,
+        hidden_cave_sse2_normalize3,
+        hidden_cave_sse2_bounds3,
+        hidden_cave_sse2_affine3,
+        hidden_cave_sse2_project3,
+        hidden_cave_sse2_dot2,
+        hidden_cave_sse2_bounds2,
+        hidden_cave_sse2_affine2,
+};
+
+/*
+ * AVX2, eight at a time. The 256 bit shuffles work within each 128 bit half, so packed points are loaded with
+ * the first four in the low half and the next four in the high half, and shuffled apart just as for SSE2.
+ */
+
+CAVE_AVX2 static void hidden_cave_avx2_load3(cave_Vec3_Array const* array, int layout, size_t i, __m256* x,
+                                             __m256* y, __m256* z) {
+    if(layout == CAVE_VEC3_STREAMS) {
+        *x = _mm256_loadu_ps(array->x + i);
+        *y = _mm256_loadu_ps(array->y + i);
+        *z = _mm256_loadu_ps(array->z + i);
+    } else if(layout == CAVE_VEC3_PACKED) {
+        float const* p = array->x + 3 * i;
+        __m256 m0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p + 12), 1);
+        __m256 m1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 16), 1);
+        __m256 m2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 8)), _mm_loadu_ps(p + 20), 1);
+        __m256 xy = _mm256_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 1, 3, 2));
+        __m256 yz = _mm256_shuffle_ps(m0, m1, _MM_SHUFFLE(1, 0, 2, 1));
+        *x = _mm256_shuffle_ps(m0, xy, _MM_SHUFFLE(2, 0, 3, 0));
+        *y = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));
+        *z = _mm256_shuffle_ps(yz, m2, _MM_SHUFFLE(3, 0, 3, 1));
+    } else {
+        size_t s = array->stride, o = i * s;
+        float const* c[3] = {array->x + o, array->y + o, array->z + o};
+        __m256* r[3] = {x, y, z};
+        for(int k = 0; k < 3; k++) {
+            *r[k] = _mm256_setr_ps(c[k][0], c[k][s], c[k][2 * s], c[k][3 * s], c[k][4 * s], c[k][5 * s],
+                                   c[k][6 * s], c[k][7 * s]);
+        }
+    }
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_store3(cave_Vec3_Array const* array, int layout, size_t i, __m256 x,
+                                              __m256 y, __m256 z) {
+    if(layout == CAVE_VEC3_STREAMS) {
+        _mm256_storeu_ps(array->x + i, x);
+        _mm256_storeu_ps(array->y + i, y);
+        _mm256_storeu_ps(array->z + i, z);
+    } else if(layout == CAVE_VEC3_PACKED) {
+        float* p = array->x + 3 * i;
+        __m256 rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 r0 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 r1 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 r2 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(p, _mm256_castps256_ps128(r0));
+        _mm_storeu_ps(p + 4, _mm256_castps256_ps128(r1));
+        _mm_storeu_ps(p + 8, _mm256_castps256_ps128(r2));
+        _mm_storeu_ps(p + 12, _mm256_extractf128_ps(r0, 1));
+        _mm_storeu_ps(p + 16, _mm256_extractf128_ps(r1, 1));
+        _mm_storeu_ps(p + 20, _mm256_extractf128_ps(r2, 1));
+    } else {
+        float t[3][8];
+        _mm256_storeu_ps(t[0], x);
+        _mm256_storeu_ps(t[1], y);
+        _mm256_storeu_ps(t[2], z);
+        size_t s = array->stride;
+        for(size_t k = 0; k < 8; k++) {
+            array->x[(i + k) * s] = t[0][k];
+            array->y[(i + k) * s] = t[1][k];
+            array->z[(i + k) * s] = t[2][k];
+        }
+    }
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_add(float* dest, float const* a, float const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    hidden_cave_vecmath_scalar.add(dest + i, a + i, b + i, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_sub(float* dest, float const* a, float const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    hidden_cave_vecmath_scalar.sub(dest + i, a + i, b + i, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_min(float* dest, float const* a, float const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_min_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    hidden_cave_vecmath_scalar.min(dest + i, a + i, b + i, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_max(float* dest, float const* a, float const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_max_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    hidden_cave_vecmath_scalar.max(dest + i, a + i, b + i, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_scale(float* dest, float const* src, float scale, size_t count) {
+    __m256 s = _mm256_set1_ps(scale);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(dest + i, _mm256_mul_ps(_mm256_loadu_ps(src + i), s));
+    }
+    hidden_cave_vecmath_scalar.scale(dest + i, src + i, scale, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_dot3(float* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                                            size_t count) {
+    int la = hidden_cave_vec3_layout(a), lb = hidden_cave_vec3_layout(b);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 ax, ay, az, bx, by, bz;
+        hidden_cave_avx2_load3(a, la, i, &ax, &ay, &az);
+        hidden_cave_avx2_load3(b, lb, i, &bx, &by, &bz);
+        __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)),
+                                 _mm256_mul_ps(az, bz));
+        _mm256_storeu_ps(dest + i, d);
+    }
+    cave_Vec3_Array ra = hidden_cave_vec3_from(a, i), rb = hidden_cave_vec3_from(b, i);
+    hidden_cave_vecmath_scalar.dot3(dest + i, &ra, &rb, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_cross3(cave_Vec3_Array const* dest, cave_Vec3_Array const* a,
+                                              cave_Vec3_Array const* b, size_t count) {
+    int la = hidden_cave_vec3_layout(a), lb = hidden_cave_vec3_layout(b), ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 ax, ay, az, bx, by, bz;
+        hidden_cave_avx2_load3(a, la, i, &ax, &ay, &az);
+        hidden_cave_avx2_load3(b, lb, i, &bx, &by, &bz);
+        __m256 x = _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by));
+        __m256 y = _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz));
+        __m256 z = _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx));
+        hidden_cave_avx2_store3(dest, ld, i, x, y, z);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i);
+    cave_Vec3_Array ra = hidden_cave_vec3_from(a, i), rb = hidden_cave_vec3_from(b, i);
+    hidden_cave_vecmath_scalar.cross3(&rd, &ra, &rb, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_tri_cross3(cave_Vec3_Array const* dest, cave_Vec3_Array const* a,
+                                                 cave_Vec3_Array const* b, cave_Vec3_Array const* c, size_t count) {
+    int la = hidden_cave_vec3_layout(a), lb = hidden_cave_vec3_layout(b), lc = hidden_cave_vec3_layout(c);
+    int ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 ax, ay, az, bx, by, bz, cx, cy, cz;
+        hidden_cave_avx2_load3(a, la, i, &ax, &ay, &az);
+        hidden_cave_avx2_load3(b, lb, i, &bx, &by, &bz);
+        hidden_cave_avx2_load3(c, lc, i, &cx, &cy, &cz);
+        __m256 ux = _mm256_sub_ps(bx, ax), uy = _mm256_sub_ps(by, ay), uz = _mm256_sub_ps(bz, az);
+        __m256 vx = _mm256_sub_ps(cx, ax), vy = _mm256_sub_ps(cy, ay), vz = _mm256_sub_ps(cz, az);
+        __m256 x = _mm256_sub_ps(_mm256_mul_ps(uy, vz), _mm256_mul_ps(uz, vy));
+        __m256 y = _mm256_sub_ps(_mm256_mul_ps(uz, vx), _mm256_mul_ps(ux, vz));
+        __m256 z = _mm256_sub_ps(_mm256_mul_ps(ux, vy), _mm256_mul_ps(uy, vx));
+        hidden_cave_avx2_store3(dest, ld, i, x, y, z);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i), ra = hidden_cave_vec3_from(a, i);
+    cave_Vec3_Array rb = hidden_cave_vec3_from(b, i), rc = hidden_cave_vec3_from(c, i);
+    hidden_cave_vecmath_scalar.tri_cross3(&rd, &ra, &rb, &rc, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_normalize3(cave_Vec3_Array const* dest, cave_Vec3_Array const* src,
+                                                  size_t count) {
+    int ls = hidden_cave_vec3_layout(src), ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 x, y, z;
+        hidden_cave_avx2_load3(src, ls, i, &x, &y, &z);
+        __m256 sq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+        __m256 len = _mm256_sqrt_ps(sq);
+        __m256 nonzero = _mm256_cmp_ps(len, _mm256_setzero_ps(), _CMP_GT_OQ);
+        x = _mm256_and_ps(nonzero, _mm256_div_ps(x, len));
+        y = _mm256_and_ps(nonzero, _mm256_div_ps(y, len));
+        z = _mm256_and_ps(nonzero, _mm256_div_ps(z, len));
+        hidden_cave_avx2_store3(dest, ld, i, x, y, z);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i), rs = hidden_cave_vec3_from(src, i);
+    hidden_cave_vecmath_scalar.normalize3(&rd, &rs, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_bounds3(float* min, float* max, cave_Vec3_Array const* src, size_t count) {
+    int ls = hidden_cave_vec3_layout(src);
+    __m256 lo[3] = {_mm256_set1_ps(min[0]), _mm256_set1_ps(min[1]), _mm256_set1_ps(min[2])};
+    __m256 hi[3] = {_mm256_set1_ps(max[0]), _mm256_set1_ps(max[1]), _mm256_set1_ps(max[2])};
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 p[3];
+        hidden_cave_avx2_load3(src, ls, i, &p[0], &p[1], &p[2]);
+        for(int k = 0; k < 3; k++) {
+            lo[k] = _mm256_min_ps(p[k], lo[k]);
+            hi[k] = _mm256_max_ps(p[k], hi[k]);
+        }
+    }
+    for(int k = 0; k < 3; k++) {
+        float l[8], h[8];
+        _mm256_storeu_ps(l, lo[k]);
+        _mm256_storeu_ps(h, hi[k]);
+        for(int lane = 0; lane < 8; lane++) {
+            min[k] = l[lane] < min[k] ? l[lane] : min[k];
+            max[k] = h[lane] > max[k] ? h[lane] : max[k];
+        }
+    }
+    cave_Vec3_Array rs = hidden_cave_vec3_from(src, i);
+    hidden_cave_vecmath_scalar.bounds3(min, max, &rs, count - i);
+}
+
+CAVE_AVX2 static __m256 hidden_cave_avx2_row(float const* m, __m256 x, __m256 y, __m256 z) {
+    __m256 sum = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[0]), x), _mm256_mul_ps(_mm256_set1_ps(m[1]), y));
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(m[2]), z));
+    return _mm256_add_ps(sum, _mm256_set1_ps(m[3]));
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_affine3(cave_Vec3_Array const* dest, cave_Vec3_Array const* src,
+                                               float const* m, size_t count) {
+    int ls = hidden_cave_vec3_layout(src), ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 x, y, z;
+        hidden_cave_avx2_load3(src, ls, i, &x, &y, &z);
+        __m256 tx = hidden_cave_avx2_row(m, x, y, z);
+        __m256 ty = hidden_cave_avx2_row(m + 4, x, y, z);
+        __m256 tz = hidden_cave_avx2_row(m + 8, x, y, z);
+        hidden_cave_avx2_store3(dest, ld, i, tx, ty, tz);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i), rs = hidden_cave_vec3_from(src, i);
+    hidden_cave_vecmath_scalar.affine3(&rd, &rs, m, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_project3(cave_Vec3_Array const* dest, cave_Vec3_Array const* src,
+                                                float const* m, size_t count) {
+    int ls = hidden_cave_vec3_layout(src), ld = hidden_cave_vec3_layout(dest);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 x, y, z;
+        hidden_cave_avx2_load3(src, ls, i, &x, &y, &z);
+        __m256 w = hidden_cave_avx2_row(m + 12, x, y, z);
+        __m256 tx = _mm256_div_ps(hidden_cave_avx2_row(m, x, y, z), w);
+        __m256 ty = _mm256_div_ps(hidden_cave_avx2_row(m + 4, x, y, z), w);
+        __m256 tz = _mm256_div_ps(hidden_cave_avx2_row(m + 8, x, y, z), w);
+        hidden_cave_avx2_store3(dest, ld, i, tx, ty, tz);
+    }
+    cave_Vec3_Array rd = hidden_cave_vec3_from(dest, i), rs = hidden_cave_vec3_from(src, i);
+    hidden_cave_vecmath_scalar.project3(&rd, &rs, m, count - i);
+}
+
+//splits eight cave_2Points into their x and y, the first four in the low halves and the rest in the high ones
+CAVE_AVX2 static void hidden_cave_avx2_load2(cave_2Point const* points, __m256* x, __m256* y) {
+    float const* p = &points->x;
+    __m256 m0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)), _mm_loadu_ps(p + 8), 1);
+    __m256 m1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p + 4)), _mm_loadu_ps(p + 12), 1);
+    *x = _mm256_shuffle_ps(m0, m1, _MM_SHUFFLE(2, 0, 2, 0));
+    *y = _mm256_shuffle_ps(m0, m1, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_dot2(float* dest, cave_2Point const* a, cave_2Point const* b, size_t count) {
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 ax, ay, bx, by;
+        hidden_cave_avx2_load2(a + i, &ax, &ay);
+        hidden_cave_avx2_load2(b + i, &bx, &by);
+        _mm256_storeu_ps(dest + i, _mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)));
+    }
+    hidden_cave_vecmath_scalar.dot2(dest + i, a + i, b + i, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_bounds2(float* min, float* max, cave_2Point const* src, size_t count) {
+    __m256 lo = _mm256_setr_ps(min[0], min[1], min[0], min[1], min[0], min[1], min[0], min[1]);
+    __m256 hi = _mm256_setr_ps(max[0], max[1], max[0], max[1], max[0], max[1], max[0], max[1]);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4) {
+        __m256 p = _mm256_loadu_ps(&src[i].x);
+        lo = _mm256_min_ps(p, lo);
+        hi = _mm256_max_ps(p, hi);
+    }
+    float l[8], h[8];
+    _mm256_storeu_ps(l, lo);
+    _mm256_storeu_ps(h, hi);
+    for(int lane = 0; lane < 8; lane++) {
+        min[lane & 1] = l[lane] < min[lane & 1] ? l[lane] : min[lane & 1];
+        max[lane & 1] = h[lane] > max[lane & 1] ? h[lane] : max[lane & 1];
+    }
+    hidden_cave_vecmath_scalar.bounds2(min, max, src + i, count - i);
+}
+
+CAVE_AVX2 static void hidden_cave_avx2_affine2(cave_2Point* dest, cave_2Point const* src, float const* m,
+                                               size_t count) {
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8) {
+        __m256 x, y;
+        hidden_cave_avx2_load2(src + i, &x, &y);
+        __m256 tx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[0]), x),
+                                                _mm256_mul_ps(_mm256_set1_ps(m[1]), y)), _mm256_set1_ps(m[2]));
+        __m256 ty = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(m[3]), x),
+                                                _mm256_mul_ps(_mm256_set1_ps(m[4]), y)), _mm256_set1_ps(m[5]));
+        __m256 lo = _mm256_unpacklo_ps(tx, ty);
+        __m256 hi = _mm256_unpackhi_ps(tx, ty);
+        float* p = &dest[i].x;
+        _mm_storeu_ps(p, _mm256_castps256_ps128(lo));
+        _mm_storeu_ps(p + 4, _mm256_castps256_ps128(hi));
+        _mm_storeu_ps(p + 8, _mm256_extractf128_ps(lo, 1));
+        _mm_storeu_ps(p + 12, _mm256_extractf128_ps(hi, 1));
+    }
+    hidden_cave_vecmath_scalar.affine2(dest + i, src + i, m, count - i);
+}
+
+hidden_cave_Vecmath_Kernels const hidden_cave_vecmath_avx2 = {
+        "avx2",
+        hidden_cave_avx2_add,
+        hidden_cave_avx2_sub,
+        hidden_cave_avx2_min,
+        hidden_cave_avx2_max,
+        hidden_cave_avx2_scale,
+        hidden_cave_avx2_dot3,
+        hidden_cave_avx2_cross3,
+        hidden_cave_avx2_tri_cross3,
+        hidden_cave_avx2_normalize3,
+        hidden_cave_avx2_bounds3,
+        hidden_cave_avx2_affine3,
+        hidden_cave_avx2_project3,
+        hidden_cave_avx2_dot2,
+        hidden_cave_avx2_bounds2,
+        hidden_cave_avx2_affine2,
+};
+
+#endif //CAVE_CPU_X86
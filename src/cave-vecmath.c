@@ -0,0 +1,543 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-vecmath.h"
+#include "cave-vecmath-internal.h"
+#include <math.h>
+#include <stdbool.h>
+
+//Arguments are checked here and then handed to the table of kernels bound for the host (see cave-cpu.h). Arrays of
+//cave_3Points are described as cave_Vec3_Arrays with a stride of 3, and adding, subtracting, taking minimums
+//and maximums and scaling, which treat every float alike, run over streams and packed points as plain arrays of
+//floats.
+
+int hidden_cave_vec3_layout(cave_Vec3_Array const* array) {
+    if(array->stride == 1) {
+        return CAVE_VEC3_STREAMS;
+    }
+    if(array->stride == 3 && array->y == array->x + 1 && array->z == array->x + 2) {
+        return CAVE_VEC3_PACKED;
+    }
+    return CAVE_VEC3_GATHERED;
+}
+
+cave_Vec3_Array hidden_cave_vec3_from(cave_Vec3_Array const* array, size_t index) {
+    size_t offset = index * array->stride;
+    cave_Vec3_Array from = {array->x + offset, array->y + offset, array->z + offset, array->stride};
+    return from;
+}
+
+//the cast drops const, but kernels only read from their sources
+static cave_Vec3_Array hidden_cave_vec3_points(cave_3Point const* points) {
+    cave_3Point* p = (cave_3Point*) points;
+    cave_Vec3_Array array = {&p->x, &p->y, &p->z, 3};
+    return array;
+}
+
+/*
+ * Scalar kernels
+ */
+
+static void hidden_cave_scalar_add(float* dest, float const* a, float const* b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        dest[i] = a[i] + b[i];
+    }
+}
+
+static void hidden_cave_scalar_sub(float* dest, float const* a, float const* b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        dest[i] = a[i] - b[i];
+    }
+}
+
+static void hidden_cave_scalar_min(float* dest, float const* a, float const* b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        dest[i] = a[i] < b[i] ? a[i] : b[i];
+    }
+}
+
+static void hidden_cave_scalar_max(float* dest, float const* a, float const* b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        dest[i] = a[i] > b[i] ? a[i] : b[i];
+    }
+}
+
+static void hidden_cave_scalar_scale(float* dest, float const* src, float scale, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        dest[i] = src[i] * scale;
+    }
+}
+
+static void hidden_cave_scalar_dot3(float* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        size_t ia = i * a->stride, ib = i * b->stride;
+        dest[i] = a->x[ia] * b->x[ib] + a->y[ia] * b->y[ib] + a->z[ia] * b->z[ib];
+    }
+}
+
+static void hidden_cave_scalar_cross3(cave_Vec3_Array const* dest, cave_Vec3_Array const* a,
+                                      cave_Vec3_Array const* b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        size_t ia = i * a->stride, ib = i * b->stride, id = i * dest->stride;
+        float ax = a->x[ia], ay = a->y[ia], az = a->z[ia];
+        float bx = b->x[ib], by = b->y[ib], bz = b->z[ib];
+        dest->x[id] = ay * bz - az * by;
+        dest->y[id] = az * bx - ax * bz;
+        dest->z[id] = ax * by - ay * bx;
+    }
+}
+
+static void hidden_cave_scalar_tri_cross3(cave_Vec3_Array const* dest, cave_Vec3_Array const* a,
+                                          cave_Vec3_Array const* b, cave_Vec3_Array const* c, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        size_t ia = i * a->stride, ib = i * b->stride, ic = i * c->stride, id = i * dest->stride;
+        float ux = b->x[ib] - a->x[ia], uy = b->y[ib] - a->y[ia], uz = b->z[ib] - a->z[ia];
+        float vx = c->x[ic] - a->x[ia], vy = c->y[ic] - a->y[ia], vz = c->z[ic] - a->z[ia];
+        dest->x[id] = uy * vz - uz * vy;
+        dest->y[id] = uz * vx - ux * vz;
+        dest->z[id] = ux * vy - uy * vx;
+    }
+}
+
+static void hidden_cave_scalar_normalize3(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        size_t is = i * src->stride, id = i * dest->stride;
+        float x = src->x[is], y = src->y[is], z = src->z[is];
+        float len = sqrtf(x * x + y * y + z * z);
+        if(len > 0.0f) {
+            dest->x[id] = x / len;
+            dest->y[id] = y / len;
+            dest->z[id] = z / len;
+        } else {
+            dest->x[id] = 0.0f;
+            dest->y[id] = 0.0f;
+            dest->z[id] = 0.0f;
+        }
+    }
+}
+
+static void hidden_cave_scalar_bounds3(float* min, float* max, cave_Vec3_Array const* src, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        size_t is = i * src->stride;
+        float p[3] = {src->x[is], src->y[is], src->z[is]};
+        for(int k = 0; k < 3; k++) {
+            min[k] = p[k] < min[k] ? p[k] : min[k];
+            max[k] = p[k] > max[k] ? p[k] : max[k];
+        }
+    }
+}
+
+static void hidden_cave_scalar_affine3(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, float const* m,
+                                       size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        size_t is = i * src->stride, id = i * dest->stride;
+        float x = src->x[is], y = src->y[is], z = src->z[is];
+        dest->x[id] = m[0] * x + m[1] * y + m[2] * z + m[3];
+        dest->y[id] = m[4] * x + m[5] * y + m[6] * z + m[7];
+        dest->z[id] = m[8] * x + m[9] * y + m[10] * z + m[11];
+    }
+}
+
+static void hidden_cave_scalar_project3(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, float const* m,
+                                        size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        size_t is = i * src->stride, id = i * dest->stride;
+        float x = src->x[is], y = src->y[is], z = src->z[is];
+        float w = m[12] * x + m[13] * y + m[14] * z + m[15];
+        dest->x[id] = (m[0] * x + m[1] * y + m[2] * z + m[3]) / w;
+        dest->y[id] = (m[4] * x + m[5] * y + m[6] * z + m[7]) / w;
+        dest->z[id] = (m[8] * x + m[9] * y + m[10] * z + m[11]) / w;
+    }
+}
+
+static void hidden_cave_scalar_dot2(float* dest, cave_2Point const* a, cave_2Point const* b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        dest[i] = a[i].x * b[i].x + a[i].y * b[i].y;
+    }
+}
+
+static void hidden_cave_scalar_bounds2(float* min, float* max, cave_2Point const* src, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        min[0] = src[i].x < min[0] ? src[i].x : min[0];
+        min[1] = src[i].y < min[1] ? src[i].y : min[1];
+        max[0] = src[i].x > max[0] ? src[i].x : max[0];
+        max[1] = src[i].y > max[1] ? src[i].y : max[1];
+    }
+}
+
+static void hidden_cave_scalar_affine2(cave_2Point* dest, cave_2Point const* src, float const* m, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        float x = src[i].x, y = src[i].y;
+        dest[i].x = m[0] * x + m[1] * y + m[2];
+        dest[i].y = m[3] * x + m[4] * y + m[5];
+    }
+}
+
+hidden_cave_Vecmath_Kernels const hidden_cave_vecmath_scalar = {
+        "scalar",
+        hidden_cave_scalar_add,
+        hidden_cave_scalar_sub,
+        hidden_cave_scalar_min,
+        hidden_cave_scalar_max,
+        hidden_cave_scalar_scale,
+        hidden_cave_scalar_dot3,
+        hidden_cave_scalar_cross3,
+        hidden_cave_scalar_tri_cross3,
+        hidden_cave_scalar_normalize3,
+        hidden_cave_scalar_bounds3,
+        hidden_cave_scalar_affine3,
+        hidden_cave_scalar_project3,
+        hidden_cave_scalar_dot2,
+        hidden_cave_scalar_bounds2,
+        hidden_cave_scalar_affine2,
+};
+
+hidden_cave_Vecmath_Kernels const* hidden_cave_vecmath_kernels(void) {
+    return hidden_cave_dispatch()->vecmath;
+}
+
+char const* cave_vecmath_path(void) {
+    return hidden_cave_vecmath_kernels()->name;
+}
+
+/*
+ * Checking arguments
+ */
+
+static int hidden_cave_vec3_array_valid(cave_Vec3_Array const* array, size_t count) {
+    return array && (count == 0 || (array->x && array->y && array->z && array->stride != 0));
+}
+
+enum {
+    CAVE_VEC_ADD,
+    CAVE_VEC_SUB,
+    CAVE_VEC_MIN,
+    CAVE_VEC_MAX,
+    CAVE_VEC_SCALE,
+};
+
+//one float of what `op` makes of `a` and `b`, or of `a` and `scale`, as the kernels make it
+static float hidden_cave_vec_op(float a, float b, float scale, int op) {
+    switch(op) {
+        case CAVE_VEC_ADD: return a + b;
+        case CAVE_VEC_SUB: return a - b;
+        case CAVE_VEC_MIN: return a < b ? a : b;
+        case CAVE_VEC_MAX: return a > b ? a : b;
+        default: return a * scale;
+    }
+}
+
+//adds, subtracts, takes the minimums or maximums of, or scales arrays that aren't all streams or all packed points
+static void hidden_cave_vec3_elementwise_gathered(cave_Vec3_Array const* dest, cave_Vec3_Array const* a,
+                                                  cave_Vec3_Array const* b, float scale, size_t count, int op) {
+    float* d[3] = {dest->x, dest->y, dest->z};
+    float const* s[3] = {a->x, a->y, a->z};
+    float const* t[3] = {b ? b->x : NULL, b ? b->y : NULL, b ? b->z : NULL};
+    for(size_t i = 0; i < count; i++) {
+        size_t id = i * dest->stride, ia = i * a->stride, ib = b ? i * b->stride : 0;
+        for(int k = 0; k < 3; k++) {
+            d[k][id] = hidden_cave_vec_op(s[k][ia], t[k] ? t[k][ib] : 0.0f, scale, op);
+        }
+    }
+}
+
+static CaveError hidden_cave_vec3_elementwise(cave_Vec3_Array const* dest, cave_Vec3_Array const* a,
+                                              cave_Vec3_Array const* b, float scale, size_t count, int op) {
+    if(!hidden_cave_vec3_array_valid(dest, count) || !hidden_cave_vec3_array_valid(a, count)
+       || (op != CAVE_VEC_SCALE && !hidden_cave_vec3_array_valid(b, count))) {
+        return CAVE_DATA_ERROR;
+    }
+    if(count == 0) {
+        return CAVE_NO_ERROR;
+    }
+    hidden_cave_Vecmath_Kernels const* kernels = hidden_cave_vecmath_kernels();
+    int layout = hidden_cave_vec3_layout(dest);
+    bool same = layout != CAVE_VEC3_GATHERED && hidden_cave_vec3_layout(a) == layout
+                && (op == CAVE_VEC_SCALE || hidden_cave_vec3_layout(b) == layout);
+    if(!same) {
+        hidden_cave_vec3_elementwise_gathered(dest, a, op == CAVE_VEC_SCALE ? NULL : b, scale, count, op);
+        return CAVE_NO_ERROR;
+    }
+    //packed points are one run of 3 * count floats, and streams are three runs of count
+    size_t runs = layout == CAVE_VEC3_PACKED ? 1 : 3;
+    size_t len = layout == CAVE_VEC3_PACKED ? 3 * count : count;
+    float* d[3] = {dest->x, dest->y, dest->z};
+    float const* s[3] = {a->x, a->y, a->z};
+    for(size_t k = 0; k < runs; k++) {
+        if(op == CAVE_VEC_SCALE) {
+            kernels->scale(d[k], s[k], scale, len);
+        } else {
+            float const* t[3] = {b->x, b->y, b->z};
+            void (*kernel)(float*, float const*, float const*, size_t) =
+                    op == CAVE_VEC_ADD ? kernels->add : op == CAVE_VEC_SUB ? kernels->sub
+                    : op == CAVE_VEC_MIN ? kernels->min : kernels->max;
+            kernel(d[k], s[k], t[k], len);
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+/*
+ * Arrays laid out any way
+ */
+
+CaveError cave_vec3_array_add(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                              size_t count) {
+    return hidden_cave_vec3_elementwise(dest, a, b, 0.0f, count, CAVE_VEC_ADD);
+}
+
+CaveError cave_vec3_array_sub(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                              size_t count) {
+    return hidden_cave_vec3_elementwise(dest, a, b, 0.0f, count, CAVE_VEC_SUB);
+}
+
+CaveError cave_vec3_array_min(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                              size_t count) {
+    return hidden_cave_vec3_elementwise(dest, a, b, 0.0f, count, CAVE_VEC_MIN);
+}
+
+CaveError cave_vec3_array_max(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                              size_t count) {
+    return hidden_cave_vec3_elementwise(dest, a, b, 0.0f, count, CAVE_VEC_MAX);
+}
+
+CaveError cave_vec3_array_scale(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, float scale,
+                                size_t count) {
+    return hidden_cave_vec3_elementwise(dest, src, NULL, scale, count, CAVE_VEC_SCALE);
+}
+
+CaveError cave_vec3_array_dot(float* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b, size_t count) {
+    if((!dest && count > 0) || !hidden_cave_vec3_array_valid(a, count) || !hidden_cave_vec3_array_valid(b, count)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->dot3(dest, a, b, count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_array_cross(cave_Vec3_Array const* dest, cave_Vec3_Array const* a, cave_Vec3_Array const* b,
+                                size_t count) {
+    if(!hidden_cave_vec3_array_valid(dest, count) || !hidden_cave_vec3_array_valid(a, count)
+       || !hidden_cave_vec3_array_valid(b, count)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->cross3(dest, a, b, count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_array_normalize(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, size_t count) {
+    if(!hidden_cave_vec3_array_valid(dest, count) || !hidden_cave_vec3_array_valid(src, count)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->normalize3(dest, src, count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_array_bounds(cave_3Point* min, cave_3Point* max, cave_Vec3_Array const* points, size_t count) {
+    if(!min || !max || !hidden_cave_vec3_array_valid(points, count)) {
+        return CAVE_DATA_ERROR;
+    }
+    float lo[3] = {INFINITY, INFINITY, INFINITY};
+    float hi[3] = {-INFINITY, -INFINITY, -INFINITY};
+    hidden_cave_vecmath_kernels()->bounds3(lo, hi, points, count);
+    *min = (cave_3Point) {lo[0], lo[1], lo[2]};
+    *max = (cave_3Point) {hi[0], hi[1], hi[2]};
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_array_transform_affine(cave_Vec3_Array const* dest, cave_Vec3_Array const* src,
+                                           float const* matrix, size_t count) {
+    if(!matrix || !hidden_cave_vec3_array_valid(dest, count) || !hidden_cave_vec3_array_valid(src, count)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->affine3(dest, src, matrix, count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_array_transform(cave_Vec3_Array const* dest, cave_Vec3_Array const* src, float const* matrix,
+                                    size_t count) {
+    if(!matrix || !hidden_cave_vec3_array_valid(dest, count) || !hidden_cave_vec3_array_valid(src, count)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->project3(dest, src, matrix, count);
+    return CAVE_NO_ERROR;
+}
+
+/*
+ * Arrays of cave_3Points
+ */
+
+CaveError cave_vec3_add(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->add(&dest->x, &a->x, &b->x, 3 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_sub(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->sub(&dest->x, &a->x, &b->x, 3 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_min(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->min(&dest->x, &a->x, &b->x, 3 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_max(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->max(&dest->x, &a->x, &b->x, 3 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_scale(cave_3Point* dest, cave_3Point const* src, float scale, size_t count) {
+    if(count == 0 || !dest || !src) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->scale(&dest->x, &src->x, scale, 3 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_dot(float* dest, cave_3Point const* a, cave_3Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    cave_Vec3_Array va = hidden_cave_vec3_points(a), vb = hidden_cave_vec3_points(b);
+    hidden_cave_vecmath_kernels()->dot3(dest, &va, &vb, count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_cross(cave_3Point* dest, cave_3Point const* a, cave_3Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    cave_Vec3_Array vd = hidden_cave_vec3_points(dest), va = hidden_cave_vec3_points(a);
+    cave_Vec3_Array vb = hidden_cave_vec3_points(b);
+    hidden_cave_vecmath_kernels()->cross3(&vd, &va, &vb, count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_normalize(cave_3Point* dest, cave_3Point const* src, size_t count) {
+    if(count == 0 || !dest || !src) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    cave_Vec3_Array vd = hidden_cave_vec3_points(dest), vs = hidden_cave_vec3_points(src);
+    hidden_cave_vecmath_kernels()->normalize3(&vd, &vs, count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_bounds(cave_3Point* min, cave_3Point* max, cave_3Point const* points, size_t count) {
+    if(!points && count > 0) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_Vec3_Array vs = {NULL, NULL, NULL, 3};
+    if(count > 0) {
+        vs = hidden_cave_vec3_points(points);
+    }
+    return cave_vec3_array_bounds(min, max, &vs, count);
+}
+
+CaveError cave_vec3_transform_affine(cave_3Point* dest, cave_3Point const* src, float const* matrix,
+                                     size_t count) {
+    if(!matrix || (count > 0 && (!dest || !src))) {
+        return CAVE_DATA_ERROR;
+    }
+    if(count > 0) {
+        cave_Vec3_Array vd = hidden_cave_vec3_points(dest), vs = hidden_cave_vec3_points(src);
+        hidden_cave_vecmath_kernels()->affine3(&vd, &vs, matrix, count);
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec3_transform(cave_3Point* dest, cave_3Point const* src, float const* matrix, size_t count) {
+    if(!matrix || (count > 0 && (!dest || !src))) {
+        return CAVE_DATA_ERROR;
+    }
+    if(count > 0) {
+        cave_Vec3_Array vd = hidden_cave_vec3_points(dest), vs = hidden_cave_vec3_points(src);
+        hidden_cave_vecmath_kernels()->project3(&vd, &vs, matrix, count);
+    }
+    return CAVE_NO_ERROR;
+}
+
+/*
+ * Arrays of cave_2Points
+ */
+
+CaveError cave_vec2_add(cave_2Point* dest, cave_2Point const* a, cave_2Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->add(&dest->x, &a->x, &b->x, 2 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec2_sub(cave_2Point* dest, cave_2Point const* a, cave_2Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->sub(&dest->x, &a->x, &b->x, 2 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec2_min(cave_2Point* dest, cave_2Point const* a, cave_2Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->min(&dest->x, &a->x, &b->x, 2 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec2_max(cave_2Point* dest, cave_2Point const* a, cave_2Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->max(&dest->x, &a->x, &b->x, 2 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec2_scale(cave_2Point* dest, cave_2Point const* src, float scale, size_t count) {
+    if(count == 0 || !dest || !src) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->scale(&dest->x, &src->x, scale, 2 * count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec2_dot(float* dest, cave_2Point const* a, cave_2Point const* b, size_t count) {
+    if(count == 0 || !dest || !a || !b) {
+        return count == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->dot2(dest, a, b, count);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec2_bounds(cave_2Point* min, cave_2Point* max, cave_2Point const* points, size_t count) {
+    if(!min || !max || (!points && count > 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    float lo[2] = {INFINITY, INFINITY};
+    float hi[2] = {-INFINITY, -INFINITY};
+    hidden_cave_vecmath_kernels()->bounds2(lo, hi, points, count);
+    *min = (cave_2Point) {lo[0], lo[1]};
+    *max = (cave_2Point) {hi[0], hi[1]};
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_vec2_transform_affine(cave_2Point* dest, cave_2Point const* src, float const* matrix,
+                                     size_t count) {
+    if(!matrix || (count > 0 && (!dest || !src))) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_vecmath_kernels()->affine2(dest, src, matrix, count);
+    return CAVE_NO_ERROR;
+}
@@ -0,0 +1,670 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-voxel.h"
+#include "cave-threads.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+//triangles per chunk, when finding which slabs they reach
+#define CAVE_VOXEL_GRAIN (16384)
+//the most voxels along an axis
+#define CAVE_VOXEL_MAX_SIZE ((size_t) 1 << 31)
+
+//a triangle in voxel coordinates, where voxel (x, y, z) spans from (x, y, z) to (x + 1, y + 1, z + 1), and
+//what's needed to test it against voxels
+typedef struct hidden_cave_Voxel_Tri {
+    double v[3][3];
+    //the lowest and highest voxel it reaches along each axis, before clipping to the grid
+    double lo[3];
+    double hi[3];
+    double normal[3];
+    //the axes to test voxels along: the normal, and the cross products of the edges with the coordinate axes.
+    //Along `axes[i]`, the triangle spans `min[i]` to `max[i]`, and a voxel's center reaches out `reach[i]`.
+    double axes[10][3];
+    double min[10];
+    double max[10];
+    double reach[10];
+    int axis_count;
+} hidden_cave_Voxel_Tri;
+
+//what a worker voxelizes a slab with, kept from one slab to the next
+typedef struct hidden_cave_Voxel_Scratch {
+    //the slab's surface voxels, for a sparse grid, and the crossings along its rows, when filling
+    uint64_t* surface;
+    uint64_t* parity;
+} hidden_cave_Voxel_Scratch;
+
+//the mixed bricks of a slab of a sparse grid, which are gathered into one array once every slab is done
+typedef struct hidden_cave_Voxel_Pool {
+    uint64_t* words;
+    size_t count;
+    size_t capacity;
+} hidden_cave_Voxel_Pool;
+
+typedef struct hidden_cave_Voxel_Pass {
+    //one of these is set
+    cave_3d_Triangle const* tris;
+    cave_STL_Tri const* stl;
+    size_t tri_count;
+    cave_Voxel_Options const* options;
+    float inv_size;
+    size_t slab_count;
+    size_t slab_words;
+    //for each triangle, the first slab it reaches and the one after the last
+    uint32_t* spans;
+    //the triangles reaching each slab are from `slab_tris[slab_start[s]]` on
+    size_t* slab_start;
+    uint32_t* slab_tris;
+    hidden_cave_Voxel_Scratch* scratch;
+    hidden_cave_Voxel_Pool* pools;
+    cave_Voxels* dest;
+} hidden_cave_Voxel_Pass;
+
+static void hidden_cave_voxel_corners(hidden_cave_Voxel_Pass const* pass, size_t tri, cave_3Point corners[3]) {
+    if(pass->tris) {
+        corners[0] = pass->tris[tri].a;
+        corners[1] = pass->tris[tri].b;
+        corners[2] = pass->tris[tri].c;
+    } else {
+        corners[0] = pass->stl[tri].a;
+        corners[1] = pass->stl[tri].b;
+        corners[2] = pass->stl[tri].c;
+    }
+}
+
+//the triangle in voxel coordinates, or false if a corner isn't finite. Corners are converted in floats, the same
+//way wherever they appear, so triangles sharing a corner agree on where it is.
+static bool hidden_cave_voxel_tri_corners(hidden_cave_Voxel_Pass const* pass, size_t tri, hidden_cave_Voxel_Tri* t) {
+    cave_3Point c[3];
+    hidden_cave_voxel_corners(pass, tri, c);
+    cave_3Point o = pass->options->origin;
+    for(int i = 0; i < 3; i++) {
+        float v[3] = {(c[i].x - o.x) * pass->inv_size, (c[i].y - o.y) * pass->inv_size,
+                      (c[i].z - o.z) * pass->inv_size};
+        for(int k = 0; k < 3; k++) {
+            if(!isfinite(v[k])) {
+                return false;
+            }
+            t->v[i][k] = v[k];
+        }
+    }
+    for(int k = 0; k < 3; k++) {
+        double lo = t->v[0][k] < t->v[1][k] ? t->v[0][k] : t->v[1][k];
+        double hi = t->v[0][k] < t->v[1][k] ? t->v[1][k] : t->v[0][k];
+        t->lo[k] = floor(t->v[2][k] < lo ? t->v[2][k] : lo);
+        t->hi[k] = floor(t->v[2][k] > hi ? t->v[2][k] : hi);
+    }
+    return true;
+}
+
+static double hidden_cave_voxel_dot(double const a[3], double const b[3]) {
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static void hidden_cave_voxel_add_axis(hidden_cave_Voxel_Tri* t, double const axis[3]) {
+    if(axis[0] == 0.0 && axis[1] == 0.0 && axis[2] == 0.0) {
+        return;
+    }
+    int i = t->axis_count++;
+    memcpy(t->axes[i], axis, sizeof(double) * 3);
+    double p[3] = {hidden_cave_voxel_dot(axis, t->v[0]), hidden_cave_voxel_dot(axis, t->v[1]),
+                   hidden_cave_voxel_dot(axis, t->v[2])};
+    t->min[i] = p[0] < p[1] ? (p[0] < p[2] ? p[0] : p[2]) : (p[1] < p[2] ? p[1] : p[2]);
+    t->max[i] = p[0] > p[1] ? (p[0] > p[2] ? p[0] : p[2]) : (p[1] > p[2] ? p[1] : p[2]);
+    t->reach[i] = 0.5 * (fabs(axis[0]) + fabs(axis[1]) + fabs(axis[2]));
+}
+
+//sets up the separating axis test of Akenine-Moller, "Fast 3D Triangle-Box Overlap Testing". The box's own axes
+//are left out, since only voxels within the triangle's bounds are ever tested.
+static void hidden_cave_voxel_tri_axes(hidden_cave_Voxel_Tri* t) {
+    double e[3][3];
+    for(int i = 0; i < 3; i++) {
+        for(int k = 0; k < 3; k++) {
+            e[i][k] = t->v[(i + 1) % 3][k] - t->v[i][k];
+        }
+    }
+    t->normal[0] = e[0][1] * e[1][2] - e[0][2] * e[1][1];
+    t->normal[1] = e[0][2] * e[1][0] - e[0][0] * e[1][2];
+    t->normal[2] = e[0][0] * e[1][1] - e[0][1] * e[1][0];
+    t->axis_count = 0;
+    hidden_cave_voxel_add_axis(t, t->normal);
+    for(int i = 0; i < 3; i++) {
+        double x[3] = {0.0, e[i][2], -e[i][1]};
+        double y[3] = {-e[i][2], 0.0, e[i][0]};
+        double z[3] = {e[i][1], -e[i][0], 0.0};
+        hidden_cave_voxel_add_axis(t, x);
+        hidden_cave_voxel_add_axis(t, y);
+        hidden_cave_voxel_add_axis(t, z);
+    }
+}
+
+static bool hidden_cave_voxel_overlaps(hidden_cave_Voxel_Tri const* t, double x, double y, double z) {
+    double center[3] = {x + 0.5, y + 0.5, z + 0.5};
+    for(int i = 0; i < t->axis_count; i++) {
+        double s = hidden_cave_voxel_dot(t->axes[i], center);
+        if(t->min[i] - s > t->reach[i] || t->max[i] - s < -t->reach[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//the voxels from `lo` to `hi` along each axis, clipped to the grid and to slab [z0, z1)
+static bool hidden_cave_voxel_clip(hidden_cave_Voxel_Pass const* pass, hidden_cave_Voxel_Tri const* t, size_t z0,
+                                   size_t z1, size_t lo[3], size_t hi[3]) {
+    double limit_lo[3] = {0.0, 0.0, (double) z0};
+    double limit_hi[3] = {(double) pass->options->size_x - 1.0, (double) pass->options->size_y - 1.0,
+                          (double) z1 - 1.0};
+    for(int k = 0; k < 3; k++) {
+        double a = t->lo[k] > limit_lo[k] ? t->lo[k] : limit_lo[k];
+        double b = t->hi[k] < limit_hi[k] ? t->hi[k] : limit_hi[k];
+        if(a > b) {
+            return false;
+        }
+        lo[k] = (size_t) a;
+        hi[k] = (size_t) b;
+    }
+    return true;
+}
+
+static void hidden_cave_voxel_set(hidden_cave_Voxel_Pass const* pass, uint64_t* slab, size_t z0, size_t x, size_t y,
+                                  size_t z) {
+    size_t row = (z - z0) * pass->options->size_y + y;
+    slab[row * pass->dest->words_per_row + x / 64] |= (uint64_t) 1 << (x % 64);
+}
+
+//marks the voxels of the slab the triangle touches. Rather than test every voxel in its bounds, it walks the
+//columns along whichever axis its normal is nearest, and only tests the voxels its plane passes through in each.
+static void hidden_cave_voxel_surface(hidden_cave_Voxel_Pass const* pass, hidden_cave_Voxel_Tri const* t,
+                                      uint64_t* slab, size_t z0, size_t z1) {
+    size_t lo[3], hi[3];
+    if(!hidden_cave_voxel_clip(pass, t, z0, z1, lo, hi)) {
+        return;
+    }
+    double const* n = t->normal;
+    int d = fabs(n[0]) > fabs(n[1]) ? (fabs(n[0]) > fabs(n[2]) ? 0 : 2) : (fabs(n[1]) > fabs(n[2]) ? 1 : 2);
+    int u = (d + 1) % 3, w = (d + 2) % 3;
+    double k = hidden_cave_voxel_dot(n, t->v[0]);
+    size_t at[3];
+    for(at[u] = lo[u]; at[u] <= hi[u]; at[u]++) {
+        for(at[w] = lo[w]; at[w] <= hi[w]; at[w]++) {
+            size_t first = lo[d], last = hi[d];
+            if(n[d] != 0.0) {
+                //where the plane crosses the column, at its four edges
+                double span_lo = INFINITY, span_hi = -INFINITY;
+                for(int corner = 0; corner < 4; corner++) {
+                    double pu = (double) at[u] + (corner & 1), pw = (double) at[w] + (corner >> 1);
+                    double pd = (k - n[u] * pu - n[w] * pw) / n[d];
+                    span_lo = pd < span_lo ? pd : span_lo;
+                    span_hi = pd > span_hi ? pd : span_hi;
+                }
+                span_lo = floor(span_lo);
+                span_hi = floor(span_hi);
+                if(span_hi < (double) first || span_lo > (double) last) {
+                    continue;
+                }
+                first = span_lo > (double) first ? (size_t) span_lo : first;
+                last = span_hi < (double) last ? (size_t) span_hi : last;
+            }
+            for(at[d] = first; at[d] <= last; at[d]++) {
+                if(hidden_cave_voxel_overlaps(t, (double) at[0], (double) at[1], (double) at[2])) {
+                    hidden_cave_voxel_set(pass, slab, z0, at[0], at[1], at[2]);
+                }
+            }
+        }
+    }
+}
+
+//whether the edge from `a` to `b` is ordered the same way from either triangle sharing it
+static bool hidden_cave_voxel_edge_ordered(double const a[3], double const b[3]) {
+    if(a[1] != b[1]) {
+        return a[1] < b[1];
+    }
+    if(a[2] != b[2]) {
+        return a[2] < b[2];
+    }
+    return a[0] <= b[0];
+}
+
+//which side of the edge through `a` and `b`, projected onto the yz plane, (y, z) is on
+static double hidden_cave_voxel_edge_side(double const a[3], double const b[3], double y, double z) {
+    return (b[1] - a[1]) * (z - a[2]) - (b[2] - a[2]) * (y - a[1]);
+}
+
+//toggles, along each row of the slab whose center the triangle covers seen along x, the first voxel whose center
+//is past the triangle. Whether a center on an edge is covered is decided from the edge alone, ordering its ends
+//the same way whichever triangle it is seen from, so that of two triangles side by side exactly one covers it.
+static void hidden_cave_voxel_parity(hidden_cave_Voxel_Pass const* pass, hidden_cave_Voxel_Tri const* t,
+                                     uint64_t* slab, size_t z0, size_t z1) {
+    if(t->normal[0] == 0.0) {
+        return;
+    }
+    double const* edge_a[3];
+    double const* edge_b[3];
+    double inner[3];
+    bool top_left[3];
+    for(int i = 0; i < 3; i++) {
+        double const* p = t->v[i];
+        double const* q = t->v[(i + 1) % 3];
+        bool ordered = hidden_cave_voxel_edge_ordered(p, q);
+        edge_a[i] = ordered ? p : q;
+        edge_b[i] = ordered ? q : p;
+        double const* opposite = t->v[(i + 2) % 3];
+        inner[i] = hidden_cave_voxel_edge_side(edge_a[i], edge_b[i], opposite[1], opposite[2]);
+        if(inner[i] == 0.0) {
+            return;
+        }
+        double dy = edge_b[i][1] - edge_a[i][1], dz = edge_b[i][2] - edge_a[i][2];
+        top_left[i] = dy > 0.0 || (dy == 0.0 && dz > 0.0);
+    }
+    //the rows with centers in the triangle's bounds
+    double lo_y = t->lo[1] > 0.0 ? t->lo[1] : 0.0, lo_z = (double) z0;
+    double hi_y = (double) pass->options->size_y - 1.0, hi_z = (double) z1 - 1.0;
+    double y_max = t->v[0][1] > t->v[1][1] ? t->v[0][1] : t->v[1][1];
+    double z_min = t->v[0][2] < t->v[1][2] ? t->v[0][2] : t->v[1][2];
+    double z_max = t->v[0][2] > t->v[1][2] ? t->v[0][2] : t->v[1][2];
+    y_max = t->v[2][1] > y_max ? t->v[2][1] : y_max;
+    z_min = t->v[2][2] < z_min ? t->v[2][2] : z_min;
+    z_max = t->v[2][2] > z_max ? t->v[2][2] : z_max;
+    hi_y = floor(y_max - 0.5) < hi_y ? floor(y_max - 0.5) : hi_y;
+    lo_z = ceil(z_min - 0.5) > lo_z ? ceil(z_min - 0.5) : lo_z;
+    hi_z = floor(z_max - 0.5) < hi_z ? floor(z_max - 0.5) : hi_z;
+    if(lo_y > hi_y || lo_z > hi_z) {
+        return;
+    }
+    double const* n = t->normal;
+    for(size_t z = (size_t) lo_z; z <= (size_t) hi_z; z++) {
+        double cz = (double) z + 0.5;
+        for(size_t y = (size_t) lo_y; y <= (size_t) hi_y; y++) {
+            double cy = (double) y + 0.5;
+            bool covered = true;
+            for(int i = 0; i < 3 && covered; i++) {
+                double side = hidden_cave_voxel_edge_side(edge_a[i], edge_b[i], cy, cz);
+                covered = side == 0.0 ? (inner[i] > 0.0) == top_left[i] : (side > 0.0) == (inner[i] > 0.0);
+            }
+            if(!covered) {
+                continue;
+            }
+            double x = t->v[0][0] - (n[1] * (cy - t->v[0][1]) + n[2] * (cz - t->v[0][2])) / n[0];
+            double first = ceil(x - 0.5);
+            if(first >= (double) pass->options->size_x) {
+                continue;
+            }
+            //two crossings before the same voxel cancel out
+            size_t x_at = first > 0.0 ? (size_t) first : 0;
+            size_t row = (z - z0) * pass->options->size_y + y;
+            slab[row * pass->dest->words_per_row + x_at / 64] ^= (uint64_t) 1 << (x_at % 64);
+        }
+    }
+}
+
+//turns each row's toggles into the voxels past an odd number of them, and adds those to the surface
+static void hidden_cave_voxel_fill(hidden_cave_Voxel_Pass const* pass, uint64_t* surface, uint64_t* parity,
+                                   size_t rows) {
+    size_t words = pass->dest->words_per_row, size_x = pass->options->size_x;
+    uint64_t tail = size_x % 64 == 0 ? ~(uint64_t) 0 : ((uint64_t) 1 << (size_x % 64)) - 1;
+    for(size_t r = 0; r < rows; r++) {
+        uint64_t carry = 0;
+        for(size_t i = 0; i < words; i++) {
+            //a prefix xor within the word, each bit becoming the xor of it and every bit below it
+            uint64_t x = parity[r * words + i];
+            x ^= x << 1;
+            x ^= x << 2;
+            x ^= x << 4;
+            x ^= x << 8;
+            x ^= x << 16;
+            x ^= x << 32;
+            x ^= carry;
+            carry = (x >> 63) ? ~(uint64_t) 0 : 0;
+            surface[r * words + i] |= i + 1 == words ? x & tail : x;
+        }
+    }
+}
+
+static bool hidden_cave_voxel_pool_add(hidden_cave_Voxel_Pool* pool, uint64_t const words[CAVE_VOXEL_BRICK]) {
+    if(pool->count == pool->capacity) {
+        size_t grown = pool->capacity > 0 ? pool->capacity * 2 : 64;
+        uint64_t* bigger = realloc(pool->words, sizeof(uint64_t) * CAVE_VOXEL_BRICK * grown);
+        if(!bigger) {
+            return false;
+        }
+        pool->words = bigger;
+        pool->capacity = grown;
+    }
+    memcpy(pool->words + CAVE_VOXEL_BRICK * pool->count++, words, sizeof(uint64_t) * CAVE_VOXEL_BRICK);
+    return true;
+}
+
+//cuts the slab's voxels into bricks, mapping each that is empty or full and pooling the rest
+static CaveError hidden_cave_voxel_bricks(hidden_cave_Voxel_Pass const* pass, uint64_t const* surface, size_t slab) {
+    cave_Voxels* dest = pass->dest;
+    size_t size_y = dest->size_y, z0 = slab * CAVE_VOXEL_BRICK;
+    size_t layers = dest->size_z - z0 < CAVE_VOXEL_BRICK ? dest->size_z - z0 : CAVE_VOXEL_BRICK;
+    hidden_cave_Voxel_Pool* pool = pass->pools + slab;
+    for(size_t by = 0; by < dest->bricks_y; by++) {
+        for(size_t bx = 0; bx < dest->bricks_x; bx++) {
+            uint64_t words[CAVE_VOXEL_BRICK] = {0};
+            bool empty = true, full = true;
+            for(size_t lz = 0; lz < CAVE_VOXEL_BRICK; lz++) {
+                for(size_t ly = 0; ly < CAVE_VOXEL_BRICK && lz < layers; ly++) {
+                    size_t y = by * CAVE_VOXEL_BRICK + ly;
+                    if(y >= size_y) {
+                        break;
+                    }
+                    uint64_t row = surface[(lz * size_y + y) * dest->words_per_row + bx / 8];
+                    words[lz] |= (row >> (8 * (bx % 8)) & 0xFF) << (8 * ly);
+                }
+                empty = empty && words[lz] == 0;
+                full = full && words[lz] == ~(uint64_t) 0;
+            }
+            uint32_t* entry = dest->brick_map + (slab * dest->bricks_y + by) * dest->bricks_x + bx;
+            if(empty || full) {
+                *entry = empty ? CAVE_VOXEL_EMPTY : CAVE_VOXEL_FULL;
+            } else {
+                //numbered within the slab for now
+                *entry = (uint32_t) pool->count;
+                if(!hidden_cave_voxel_pool_add(pool, words)) {
+                    return CAVE_INSUFFICIENT_MEMORY_ERROR;
+                }
+            }
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+static CaveError hidden_cave_voxel_slab(hidden_cave_Voxel_Pass const* pass, hidden_cave_Voxel_Scratch* scratch,
+                                        size_t slab) {
+    cave_Voxels* dest = pass->dest;
+    size_t z0 = slab * CAVE_VOXEL_BRICK;
+    size_t z1 = z0 + CAVE_VOXEL_BRICK < dest->size_z ? z0 + CAVE_VOXEL_BRICK : dest->size_z;
+    size_t rows = (z1 - z0) * dest->size_y;
+    //a dense grid is written straight into, its slabs not overlapping
+    uint64_t* surface = dest->bits ? dest->bits + z0 * dest->size_y * dest->words_per_row : scratch->surface;
+    if(!dest->bits) {
+        memset(surface, 0, sizeof(uint64_t) * pass->slab_words);
+    }
+    if(pass->options->fill) {
+        memset(scratch->parity, 0, sizeof(uint64_t) * pass->slab_words);
+    }
+    for(size_t i = pass->slab_start[slab]; i < pass->slab_start[slab + 1]; i++) {
+        hidden_cave_Voxel_Tri t;
+        if(!hidden_cave_voxel_tri_corners(pass, pass->slab_tris[i], &t)) {
+            continue;
+        }
+        hidden_cave_voxel_tri_axes(&t);
+        hidden_cave_voxel_surface(pass, &t, surface, z0, z1);
+        if(pass->options->fill) {
+            hidden_cave_voxel_parity(pass, &t, scratch->parity, z0, z1);
+        }
+    }
+    if(pass->options->fill) {
+        hidden_cave_voxel_fill(pass, surface, scratch->parity, rows);
+    }
+    return dest->bits ? CAVE_NO_ERROR : hidden_cave_voxel_bricks(pass, surface, slab);
+}
+
+static CaveError hidden_cave_voxel_slabs_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    hidden_cave_Voxel_Pass const* pass = arg;
+    hidden_cave_Voxel_Scratch* scratch = pass->scratch + worker;
+    //scratch is only allocated by workers that get a slab
+    if(pass->options->sparse && !scratch->surface) {
+        scratch->surface = malloc(sizeof(uint64_t) * pass->slab_words);
+        if(!scratch->surface) {
+            return CAVE_INSUFFICIENT_MEMORY_ERROR;
+        }
+    }
+    if(pass->options->fill && !scratch->parity) {
+        scratch->parity = malloc(sizeof(uint64_t) * pass->slab_words);
+        if(!scratch->parity) {
+            return CAVE_INSUFFICIENT_MEMORY_ERROR;
+        }
+    }
+    for(size_t s = begin; s < end; s++) {
+        CaveError err = hidden_cave_voxel_slab(pass, scratch, s);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+//a triangle reaches the slabs its bounds in z do, unless it's wholly off the grid. Triangles wholly below x = 0
+//are kept, since they still count when filling.
+static CaveError hidden_cave_voxel_spans_chunk(void* arg, size_t worker, size_t begin, size_t end) {
+    (void) worker;
+    hidden_cave_Voxel_Pass* pass = arg;
+    cave_Voxel_Options const* options = pass->options;
+    for(size_t i = begin; i < end; i++) {
+        hidden_cave_Voxel_Tri t;
+        uint32_t first = 0, last = 0;
+        if(hidden_cave_voxel_tri_corners(pass, i, &t) && t.hi[1] >= 0.0 && t.lo[1] < (double) options->size_y
+           && t.hi[2] >= 0.0 && t.lo[2] < (double) options->size_z && t.lo[0] < (double) options->size_x) {
+            double lo = t.lo[2] > 0.0 ? t.lo[2] : 0.0;
+            double hi = t.hi[2] < (double) options->size_z - 1.0 ? t.hi[2] : (double) options->size_z - 1.0;
+            first = (uint32_t) ((size_t) lo / CAVE_VOXEL_BRICK);
+            last = (uint32_t) ((size_t) hi / CAVE_VOXEL_BRICK + 1);
+        }
+        pass->spans[2 * i] = first;
+        pass->spans[2 * i + 1] = last;
+    }
+    return CAVE_NO_ERROR;
+}
+
+//numbers the pooled bricks of every slab one after another, and gathers them into one array
+static CaveError hidden_cave_voxel_gather(hidden_cave_Voxel_Pass* pass) {
+    cave_Voxels* dest = pass->dest;
+    size_t total = 0;
+    for(size_t s = 0; s < pass->slab_count; s++) {
+        total += pass->pools[s].count;
+    }
+    if(total >= CAVE_VOXEL_FULL) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    dest->bricks = malloc(sizeof(uint64_t) * CAVE_VOXEL_BRICK * (total > 0 ? total : 1));
+    if(!dest->bricks) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    size_t offset = 0, per_slab = dest->bricks_x * dest->bricks_y;
+    for(size_t s = 0; s < pass->slab_count; s++) {
+        hidden_cave_Voxel_Pool* pool = pass->pools + s;
+        if(pool->count > 0) {
+            memcpy(dest->bricks + CAVE_VOXEL_BRICK * offset, pool->words,
+                   sizeof(uint64_t) * CAVE_VOXEL_BRICK * pool->count);
+        }
+        uint32_t* entries = dest->brick_map + s * per_slab;
+        for(size_t i = 0; i < per_slab; i++) {
+            if(entries[i] < CAVE_VOXEL_FULL) {
+                entries[i] += (uint32_t) offset;
+            }
+        }
+        offset += pool->count;
+    }
+    dest->brick_count = total;
+    return CAVE_NO_ERROR;
+}
+
+void cave_Voxels_release(cave_Voxels* voxels) {
+    if(!voxels) { return; }
+    free(voxels->bits);
+    free(voxels->brick_map);
+    free(voxels->bricks);
+    memset(voxels, 0, sizeof(cave_Voxels));
+}
+
+static CaveError hidden_cave_voxelize(hidden_cave_Voxel_Pass* pass) {
+    cave_Voxel_Options const* options = pass->options;
+    cave_Voxels* dest = pass->dest;
+    memset(dest, 0, sizeof(cave_Voxels));
+    dest->origin = options->origin;
+    dest->voxel_size = options->voxel_size;
+    dest->size_x = options->size_x;
+    dest->size_y = options->size_y;
+    dest->size_z = options->size_z;
+    dest->words_per_row = (options->size_x + 63) / 64;
+    pass->inv_size = 1.0f / options->voxel_size;
+    pass->slab_count = (options->size_z + CAVE_VOXEL_BRICK - 1) / CAVE_VOXEL_BRICK;
+    pass->slab_words = CAVE_VOXEL_BRICK * options->size_y * dest->words_per_row;
+    size_t threads = options->threads > 0 ? options->threads : cave_thread_hardware_count();
+
+    //the grid itself, which is checked against overflowing first
+    CaveError err = CAVE_NO_ERROR;
+    if(options->sparse) {
+        dest->bricks_x = (options->size_x + CAVE_VOXEL_BRICK - 1) / CAVE_VOXEL_BRICK;
+        dest->bricks_y = (options->size_y + CAVE_VOXEL_BRICK - 1) / CAVE_VOXEL_BRICK;
+        dest->bricks_z = pass->slab_count;
+        double entries = (double) dest->bricks_x * (double) dest->bricks_y * (double) dest->bricks_z;
+        dest->brick_map = entries < (double) (SIZE_MAX / sizeof(uint32_t))
+                          ? malloc(sizeof(uint32_t) * dest->bricks_x * dest->bricks_y * dest->bricks_z) : NULL;
+        pass->pools = calloc(pass->slab_count, sizeof(hidden_cave_Voxel_Pool));
+        err = dest->brick_map && pass->pools ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    } else {
+        double words = (double) dest->words_per_row * (double) options->size_y * (double) options->size_z;
+        dest->bits = words < (double) (SIZE_MAX / sizeof(uint64_t))
+                     ? calloc(dest->words_per_row * options->size_y * options->size_z, sizeof(uint64_t)) : NULL;
+        err = dest->bits ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    pass->spans = malloc(sizeof(uint32_t) * 2 * (pass->tri_count > 0 ? pass->tri_count : 1));
+    pass->slab_start = calloc(pass->slab_count + 1, sizeof(size_t));
+    pass->scratch = calloc(threads, sizeof(hidden_cave_Voxel_Scratch));
+    if(!pass->spans || !pass->slab_start || !pass->scratch) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+
+    //counting sorts the triangles by slab, a triangle appearing once for each slab it reaches
+    if(err == CAVE_NO_ERROR) {
+        err = cave_parallel_for(pass->tri_count, CAVE_VOXEL_GRAIN, threads, hidden_cave_voxel_spans_chunk, pass);
+    }
+    if(err == CAVE_NO_ERROR) {
+        for(size_t i = 0; i < pass->tri_count; i++) {
+            for(uint32_t s = pass->spans[2 * i]; s < pass->spans[2 * i + 1]; s++) {
+                pass->slab_start[s + 1]++;
+            }
+        }
+        for(size_t s = 0; s < pass->slab_count; s++) {
+            pass->slab_start[s + 1] += pass->slab_start[s];
+        }
+        size_t total = pass->slab_start[pass->slab_count];
+        pass->slab_tris = malloc(sizeof(uint32_t) * (total > 0 ? total : 1));
+        err = pass->slab_tris ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(err == CAVE_NO_ERROR) {
+        //each slab's start is moved along as it fills, ending where the next starts, and then moved back
+        for(size_t i = 0; i < pass->tri_count; i++) {
+            for(uint32_t s = pass->spans[2 * i]; s < pass->spans[2 * i + 1]; s++) {
+                pass->slab_tris[pass->slab_start[s]++] = (uint32_t) i;
+            }
+        }
+        memmove(pass->slab_start + 1, pass->slab_start, sizeof(size_t) * pass->slab_count);
+        pass->slab_start[0] = 0;
+        free(pass->spans);
+        pass->spans = NULL;
+        err = cave_parallel_for(pass->slab_count, 1, threads, hidden_cave_voxel_slabs_chunk, pass);
+    }
+    if(err == CAVE_NO_ERROR && options->sparse) {
+        err = hidden_cave_voxel_gather(pass);
+    }
+
+    for(size_t w = 0; pass->scratch && w < threads; w++) {
+        free(pass->scratch[w].surface);
+        free(pass->scratch[w].parity);
+    }
+    for(size_t s = 0; pass->pools && s < pass->slab_count; s++) {
+        free(pass->pools[s].words);
+    }
+    free(pass->scratch);
+    free(pass->pools);
+    free(pass->spans);
+    free(pass->slab_start);
+    free(pass->slab_tris);
+    if(err != CAVE_NO_ERROR) {
+        cave_Voxels_release(dest);
+    }
+    return err;
+}
+
+static bool hidden_cave_voxel_options_valid(cave_Voxel_Options const* options) {
+    return options && options->voxel_size > 0.0f && isfinite(options->voxel_size)
+           && isfinite(1.0f / options->voxel_size) && options->size_x > 0 && options->size_y > 0
+           && options->size_z > 0 && options->size_x <= CAVE_VOXEL_MAX_SIZE
+           && options->size_y <= CAVE_VOXEL_MAX_SIZE && options->size_z <= CAVE_VOXEL_MAX_SIZE;
+}
+
+CaveError cave_voxelize(cave_Voxels* dest, cave_3d_Triangle const* tris, size_t tri_count,
+                        cave_Voxel_Options const* options) {
+    if(!dest || (!tris && tri_count > 0) || tri_count >= UINT32_MAX || !hidden_cave_voxel_options_valid(options)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_Voxel_Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.tris = tris;
+    pass.tri_count = tri_count;
+    pass.options = options;
+    pass.dest = dest;
+    return hidden_cave_voxelize(&pass);
+}
+
+CaveError cave_STL_Data_voxelize(cave_Voxels* dest, cave_STL_Data const* data, cave_Voxel_Options const* options) {
+    if(!dest || !data || (!data->tris && data->tri_count > 0) || !hidden_cave_voxel_options_valid(options)) {
+        return CAVE_DATA_ERROR;
+    }
+    hidden_cave_Voxel_Pass pass;
+    memset(&pass, 0, sizeof(pass));
+    pass.stl = data->tris;
+    pass.tri_count = data->tri_count;
+    pass.options = options;
+    pass.dest = dest;
+    return hidden_cave_voxelize(&pass);
+}
+
+bool cave_Voxels_get(cave_Voxels const* voxels, size_t x, size_t y, size_t z) {
+    if(!voxels || x >= voxels->size_x || y >= voxels->size_y || z >= voxels->size_z) {
+        return false;
+    }
+    if(voxels->bits) {
+        uint64_t word = voxels->bits[(z * voxels->size_y + y) * voxels->words_per_row + x / 64];
+        return (word >> (x % 64)) & 1;
+    }
+    size_t brick = (z / CAVE_VOXEL_BRICK * voxels->bricks_y + y / CAVE_VOXEL_BRICK) * voxels->bricks_x
+                   + x / CAVE_VOXEL_BRICK;
+    uint32_t entry = voxels->brick_map[brick];
+    if(entry == CAVE_VOXEL_EMPTY || entry == CAVE_VOXEL_FULL) {
+        return entry == CAVE_VOXEL_FULL;
+    }
+    uint64_t word = voxels->bricks[(size_t) entry * CAVE_VOXEL_BRICK + z % CAVE_VOXEL_BRICK];
+    return (word >> (x % CAVE_VOXEL_BRICK + CAVE_VOXEL_BRICK * (y % CAVE_VOXEL_BRICK))) & 1;
+}
+
+static size_t hidden_cave_popcount(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555u);
+    x = (x & 0x3333333333333333u) + ((x >> 2) & 0x3333333333333333u);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+    return (size_t) ((x * 0x0101010101010101u) >> 56);
+}
+
+size_t cave_Voxels_count(cave_Voxels const* voxels) {
+    if(!voxels) {
+        return 0;
+    }
+    size_t count = 0;
+    if(voxels->bits) {
+        size_t words = voxels->words_per_row * voxels->size_y * voxels->size_z;
+        for(size_t i = 0; i < words; i++) {
+            count += hidden_cave_popcount(voxels->bits[i]);
+        }
+        return count;
+    }
+    size_t entries = voxels->bricks_x * voxels->bricks_y * voxels->bricks_z;
+    for(size_t i = 0; i < entries; i++) {
+        //a full brick is never at an edge of the grid that cuts through it, so all of it is in the grid
+        if(voxels->brick_map[i] == CAVE_VOXEL_FULL) {
+            count += CAVE_VOXEL_BRICK * CAVE_VOXEL_BRICK * CAVE_VOXEL_BRICK;
+        }
+    }
+    for(size_t i = 0; i < voxels->brick_count * CAVE_VOXEL_BRICK; i++) {
+        count += hidden_cave_popcount(voxels->bricks[i]);
+    }
+    return count;
+}
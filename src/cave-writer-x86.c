@@ -0,0 +1,61 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-cpu-internal.h"
+#include <string.h>
+
+//STL triangle records are the four points of a cave_STL_Tri, 48 bytes of floats laid out just as the struct
+//lays them out, followed by the 2 byte attribute, so records are decoded and encoded a register at a time
+//rather than a float at a time. Like the rest of the STL code, this assumes a little endian host.
+
+#ifdef CAVE_CPU_X86
+
+#include <immintrin.h>
+
+#define CAVE_SSE2 __attribute__((target("sse2")))
+#define CAVE_AVX2 __attribute__((target("avx2")))
+
+CAVE_SSE2 void hidden_cave_sse2_decode_STL_tris(cave_STL_Tri* dest, uint8_t const* bytes, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        uint8_t const* record = bytes + i * 50;
+        uint8_t* tri = (uint8_t*) (dest + i);
+        _mm_storeu_si128((__m128i*) tri, _mm_loadu_si128((__m128i const*) record));
+        _mm_storeu_si128((__m128i*) (tri + 16), _mm_loadu_si128((__m128i const*) (record + 16)));
+        _mm_storeu_si128((__m128i*) (tri + 32), _mm_loadu_si128((__m128i const*) (record + 32)));
+        memcpy(&dest[i].attribute, record + 48, 2);
+    }
+}
+
+CAVE_SSE2 void hidden_cave_sse2_encode_STL_tris(uint8_t* dest, cave_STL_Tri const* src, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        uint8_t* record = dest + i * 50;
+        uint8_t const* tri = (uint8_t const*) (src + i);
+        _mm_storeu_si128((__m128i*) record, _mm_loadu_si128((__m128i const*) tri));
+        _mm_storeu_si128((__m128i*) (record + 16), _mm_loadu_si128((__m128i const*) (tri + 16)));
+        _mm_storeu_si128((__m128i*) (record + 32), _mm_loadu_si128((__m128i const*) (tri + 32)));
+        memcpy(record + 48, &src[i].attribute, 2);
+    }
+}
+
+CAVE_AVX2 void hidden_cave_avx2_decode_STL_tris(cave_STL_Tri* dest, uint8_t const* bytes, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        uint8_t const* record = bytes + i * 50;
+        uint8_t* tri = (uint8_t*) (dest + i);
+        _mm256_storeu_si256((__m256i*) tri, _mm256_loadu_si256((__m256i const*) record));
+        _mm_storeu_si128((__m128i*) (tri + 32), _mm_loadu_si128((__m128i const*) (record + 32)));
+        memcpy(&dest[i].attribute, record + 48, 2);
+    }
+}
+
+CAVE_AVX2 void hidden_cave_avx2_encode_STL_tris(uint8_t* dest, cave_STL_Tri const* src, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        uint8_t* record = dest + i * 50;
+        uint8_t const* tri = (uint8_t const*) (src + i);
+        _mm256_storeu_si256((__m256i*) record, _mm256_loadu_si256((__m256i const*) tri));
+        _mm_storeu_si128((__m128i*) (record + 32), _mm_loadu_si128((__m128i const*) (tri + 32)));
+        memcpy(record + 48, &src[i].attribute, 2);
+    }
+}
+
+#endif //CAVE_CPU_X86
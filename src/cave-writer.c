@@ -3,8 +3,12 @@
 //
 
 #include "cave-writer.h"
+#include "cave-utilities.h"
+#include "cave-threads.h"
+#include "cave-cpu-internal.h"
 #include <stdlib.h>
 #include <strings.h>
+#include <string.h>
 
 void hidden_cave_bytes_to_3point(cave_3Point* dest, uint8_t* bytes) {
     memcpy( &(dest->x), bytes, 4);
@@ -18,6 +22,43 @@ void hidden_cave_3point_to_bytes(uint8_t* dest, cave_3Point src) {
     memcpy(dest + 8, &src.z, 4);
 }
 
+//decodes `count` consecutive 50 byte STL triangle records from `bytes` into `dest`.
+void hidden_cave_scalar_decode_STL_tris(cave_STL_Tri* dest, uint8_t const* bytes, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        //every triangle in the STL format is 50 bytes.
+        uint8_t* curr_pos = (uint8_t*) bytes + (i * 50);
+        cave_STL_Tri* curr_tri = dest + i;
+
+        hidden_cave_bytes_to_3point( &(curr_tri->normal), curr_pos);
+        hidden_cave_bytes_to_3point( &(curr_tri->a), curr_pos + 12);
+        hidden_cave_bytes_to_3point( &(curr_tri->b), curr_pos + 24);
+        hidden_cave_bytes_to_3point( &(curr_tri->c), curr_pos + 36);
+        memcpy( &curr_tri->attribute, curr_pos + 48, 2);
+    }
+}
+
+//encodes `count` triangles from `src` as consecutive 50 byte STL triangle records into `dest`.
+void hidden_cave_scalar_encode_STL_tris(uint8_t* dest, cave_STL_Tri const* src, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        uint8_t* curr_pos = dest + (i * 50);
+        cave_STL_Tri const* curr_tri = src + i;
+        hidden_cave_3point_to_bytes(curr_pos, curr_tri->normal);
+        hidden_cave_3point_to_bytes(curr_pos + 12, curr_tri->a);
+        hidden_cave_3point_to_bytes(curr_pos + 24, curr_tri->b);
+        hidden_cave_3point_to_bytes(curr_pos + 36, curr_tri->c);
+        memcpy(curr_pos + 48, &curr_tri->attribute, 2);
+    }
+}
+
+//the STL kernels bound for the host, which the rest of Cave calls
+void hidden_cave_decode_STL_tris(cave_STL_Tri* dest, uint8_t const* bytes, size_t count) {
+    hidden_cave_dispatch()->decode_STL_tris(dest, bytes, count);
+}
+
+void hidden_cave_encode_STL_tris(uint8_t* dest, cave_STL_Tri const* src, size_t count) {
+    hidden_cave_dispatch()->encode_STL_tris(dest, src, count);
+}
+
 void cave_STL_Data_release(cave_STL_Data* data) {
     free(data->tris);
 }
@@ -48,19 +89,7 @@ CaveError cave_bytes_to_STL_Data(cave_STL_Data* dest, uint8_t* bytes, size_t byt
         return CAVE_INSUFFICIENT_MEMORY_ERROR;
     }
 
-    uint8_t* triangle_start = bytes + 84;
-    for(size_t i = 0; i < dest->tri_count; i++) {
-        //again, every triangle in the STL format is 50 bytes.
-        uint8_t* curr_pos = triangle_start + (i * 50);
-        cave_STL_Tri* curr_tri = dest->tris + i;
-
-        hidden_cave_bytes_to_3point( &(curr_tri->normal), curr_pos);
-        hidden_cave_bytes_to_3point( &(curr_tri->a), curr_pos + 12);
-        hidden_cave_bytes_to_3point( &(curr_tri->b), curr_pos + 24);
-        hidden_cave_bytes_to_3point( &(curr_tri->c), curr_pos + 36);
-        memcpy( &curr_tri->attribute, curr_pos + 48, 2);
-    }
-
+    hidden_cave_decode_STL_tris(dest->tris, bytes + 84, dest->tri_count);
     return CAVE_NO_ERROR;
 }
 
@@ -86,15 +115,343 @@ CaveError cave_STL_Data_to_Bytes(uint8_t** dest, cave_STL_Data* src) {
     memcpy(bytes, src->header, 80);
     memcpy(bytes+80, &src->tri_count, 4);
 
-    for(size_t i = 0; i < src->tri_count; i++) {
-        uint8_t* curr_pos = bytes + 84 + (i * 50);
-        cave_STL_Tri* curr_tri = src->tris + i;
-        hidden_cave_3point_to_bytes(curr_pos, curr_tri->normal);
-        hidden_cave_3point_to_bytes(curr_pos + 12, curr_tri->a);
-        hidden_cave_3point_to_bytes(curr_pos + 24, curr_tri->b);
-        hidden_cave_3point_to_bytes(curr_pos + 36, curr_tri->c);
-        memcpy(curr_pos + 48, &curr_tri->attribute, 2);
+    hidden_cave_encode_STL_tris(bytes + 84, src->tris, src->tri_count);
+    return CAVE_NO_ERROR;
+}
+
+/*
+ * Pipelined loading
+ */
+
+enum {
+    CAVE_STL_SLOT_EMPTY = 0,
+    CAVE_STL_SLOT_FILLED,
+    CAVE_STL_SLOT_DECODING,
+};
+
+typedef struct hidden_cave_STL_Pipeline {
+    FILE* fp;
+    cave_STL_Tri* tris;
+    size_t tri_count;
+    size_t tris_per_buffer;
+    size_t buffer_count;
+    uint8_t* buffers;
+    int* slot_state;
+    size_t chunk_count;
+    size_t next_decode;
+    CaveError err;
+    cave_Mutex lock;
+    cave_Cond changed;
+} hidden_cave_STL_Pipeline;
+
+static size_t hidden_cave_pipeline_chunk_tris(hidden_cave_STL_Pipeline const* p, size_t chunk) {
+    size_t start = chunk * p->tris_per_buffer;
+    size_t remaining = p->tri_count - start;
+    return remaining < p->tris_per_buffer ? remaining : p->tris_per_buffer;
+}
+
+static uint8_t* hidden_cave_pipeline_slot(hidden_cave_STL_Pipeline const* p, size_t chunk) {
+    return p->buffers + (chunk % p->buffer_count) * (p->tris_per_buffer * 50);
+}
+
+//the reader fills the ring in order, waiting whenever the next slot is still being decoded.
+static void* hidden_cave_pipeline_reader(void* arg) {
+    hidden_cave_STL_Pipeline* p = arg;
+    for(size_t chunk = 0; chunk < p->chunk_count; chunk++) {
+        int* state = p->slot_state + (chunk % p->buffer_count);
+        cave_mutex_lock(&p->lock);
+        while(*state != CAVE_STL_SLOT_EMPTY && p->err == CAVE_NO_ERROR) {
+            cave_cond_wait(&p->changed, &p->lock);
+        }
+        bool failed = p->err != CAVE_NO_ERROR;
+        cave_mutex_unlock(&p->lock);
+        if(failed) {
+            break;
+        }
+
+        //nobody else touches an empty slot, so the read happens outside the lock
+        size_t len = hidden_cave_pipeline_chunk_tris(p, chunk) * 50;
+        size_t read = fread(hidden_cave_pipeline_slot(p, chunk), 1, len, p->fp);
+
+        cave_mutex_lock(&p->lock);
+        if(read != len) {
+            p->err = CAVE_FILE_ERROR;
+        } else {
+            *state = CAVE_STL_SLOT_FILLED;
+        }
+        cave_cond_broadcast(&p->changed);
+        cave_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
+
+//decoders take filled chunks in order, so chunk `k` is always the one sitting in slot `k % buffer_count`.
+static void* hidden_cave_pipeline_decoder(void* arg) {
+    hidden_cave_STL_Pipeline* p = arg;
+    cave_mutex_lock(&p->lock);
+    while(true) {
+        while(p->err == CAVE_NO_ERROR && p->next_decode < p->chunk_count &&
+              p->slot_state[p->next_decode % p->buffer_count] != CAVE_STL_SLOT_FILLED) {
+            cave_cond_wait(&p->changed, &p->lock);
+        }
+        if(p->err != CAVE_NO_ERROR || p->next_decode >= p->chunk_count) {
+            break;
+        }
+        size_t chunk = p->next_decode;
+        p->next_decode += 1;
+        int* state = p->slot_state + (chunk % p->buffer_count);
+        *state = CAVE_STL_SLOT_DECODING;
+        cave_mutex_unlock(&p->lock);
+
+        hidden_cave_decode_STL_tris(p->tris + chunk * p->tris_per_buffer,
+                                    hidden_cave_pipeline_slot(p, chunk),
+                                    hidden_cave_pipeline_chunk_tris(p, chunk));
+
+        cave_mutex_lock(&p->lock);
+        *state = CAVE_STL_SLOT_EMPTY;
+        cave_cond_broadcast(&p->changed);
     }
+    cave_mutex_unlock(&p->lock);
+    return NULL;
+}
 
+//without threads, the ring degenerates to a single buffer that is read into and then decoded.
+static CaveError hidden_cave_pipeline_run_serial(hidden_cave_STL_Pipeline* p) {
+    for(size_t chunk = 0; chunk < p->chunk_count; chunk++) {
+        size_t count = hidden_cave_pipeline_chunk_tris(p, chunk);
+        if(fread(p->buffers, 1, count * 50, p->fp) != count * 50) {
+            return CAVE_FILE_ERROR;
+        }
+        hidden_cave_decode_STL_tris(p->tris + chunk * p->tris_per_buffer, p->buffers, count);
+    }
     return CAVE_NO_ERROR;
-}
\ No newline at end of file
+}
+
+static CaveError hidden_cave_pipeline_run_threaded(hidden_cave_STL_Pipeline* p, size_t decode_threads) {
+    if(cave_mutex_init(&p->lock) != CAVE_NO_ERROR) {
+        return CAVE_UNKNOWN_ERROR;
+    }
+    if(cave_cond_init(&p->changed) != CAVE_NO_ERROR) {
+        cave_mutex_destroy(&p->lock);
+        return CAVE_UNKNOWN_ERROR;
+    }
+
+    cave_Thread reader;
+    if(cave_thread_start(&reader, hidden_cave_pipeline_reader, p) != CAVE_NO_ERROR) {
+        cave_cond_destroy(&p->changed);
+        cave_mutex_destroy(&p->lock);
+        return hidden_cave_pipeline_run_serial(p);
+    }
+    //the calling thread is one of the decoders
+    cave_Thread* decoders = malloc(sizeof(cave_Thread) * decode_threads);
+    size_t started = 0;
+    while(decoders && started + 1 < decode_threads &&
+          cave_thread_start(decoders + started, hidden_cave_pipeline_decoder, p) == CAVE_NO_ERROR) {
+        started += 1;
+    }
+    hidden_cave_pipeline_decoder(p);
+    for(size_t i = 0; i < started; i++) {
+        cave_thread_join(decoders[i]);
+    }
+    cave_thread_join(reader);
+    free(decoders);
+
+    cave_cond_destroy(&p->changed);
+    cave_mutex_destroy(&p->lock);
+    return p->err;
+}
+
+CaveError cave_file_to_STL_Data(cave_STL_Data* dest, char const* path, cave_STL_Load_Options const* options) {
+    if(!dest || !path) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_STL_Load_Options opts = {0, 0, 0};
+    if(options) {
+        opts = *options;
+    }
+    if(opts.buffer_size == 0) { opts.buffer_size = CAVE_STL_LOAD_DEFAULT_BUFFER_SIZE; }
+    if(opts.buffer_count == 0) { opts.buffer_count = CAVE_STL_LOAD_DEFAULT_BUFFER_COUNT; }
+    if(opts.decode_threads == 0) {
+        size_t hardware = cave_thread_hardware_count();
+        opts.decode_threads = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    FILE* fp = fopen(path, "rb");
+    if(!fp) {
+        return CAVE_FILE_ERROR;
+    }
+    long file_len = cave_file_len(fp);
+    uint8_t header[84];
+    if(file_len < 84 || fread(header, 1, 84, fp) != 84) {
+        fclose(fp);
+        return file_len < 0 ? CAVE_FILE_ERROR : CAVE_DATA_ERROR;
+    }
+    memcpy(dest->header, header, 80);
+    memcpy(&dest->tri_count, header + 80, 4);
+    if((file_len - 84) % 50 != 0 || dest->tri_count != (size_t) (file_len - 84) / 50) {
+        fclose(fp);
+        return CAVE_DATA_ERROR;
+    }
+    if(dest->tri_count == 0) {
+        dest->tris = NULL;
+        fclose(fp);
+        return CAVE_NO_ERROR;
+    }
+
+    hidden_cave_STL_Pipeline p;
+    memset(&p, 0, sizeof(p));
+    p.fp = fp;
+    p.tri_count = dest->tri_count;
+    p.tris_per_buffer = opts.buffer_size / 50 ? opts.buffer_size / 50 : 1;
+    p.chunk_count = (p.tri_count + p.tris_per_buffer - 1) / p.tris_per_buffer;
+    bool threaded = cave_threads_available() && p.chunk_count > 1;
+    p.buffer_count = threaded ? opts.buffer_count : 1;
+    if(p.buffer_count > p.chunk_count) {
+        p.buffer_count = p.chunk_count;
+    }
+    p.tris = malloc(sizeof(cave_STL_Tri) * p.tri_count);
+    p.buffers = malloc(p.buffer_count * p.tris_per_buffer * 50);
+    p.slot_state = calloc(p.buffer_count, sizeof(int));
+    CaveError err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    if(p.tris && p.buffers && p.slot_state) {
+        err = threaded ? hidden_cave_pipeline_run_threaded(&p, opts.decode_threads)
+                       : hidden_cave_pipeline_run_serial(&p);
+    }
+    fclose(fp);
+    free(p.buffers);
+    free(p.slot_state);
+    if(err != CAVE_NO_ERROR) {
+        free(p.tris);
+        return err;
+    }
+    dest->tris = p.tris;
+    return CAVE_NO_ERROR;
+}
+
+
+/*
+ * Appending
+ */
+
+//buffered triangles are only counted once they are written. A write that fails may have left part of them on
+//disk, so the appender fails from then on rather than patch in a count that may not match the file.
+static CaveError hidden_cave_appender_write_buffer(cave_STL_Appender* app) {
+    if(app->buffered == 0) {
+        return CAVE_NO_ERROR;
+    }
+    if(fwrite(app->buffer, 50, app->buffered, app->fp) != app->buffered) {
+        app->failed = true;
+        return CAVE_FILE_ERROR;
+    }
+    app->tri_count += (uint32_t) app->buffered;
+    app->buffered = 0;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_STL_Appender_open(cave_STL_Appender* app, char const* path, uint8_t const* header, bool resume) {
+    if(!app || !path) {
+        return CAVE_DATA_ERROR;
+    }
+    memset(app, 0, sizeof(cave_STL_Appender));
+
+    FILE* fp = resume ? fopen(path, "r+b") : NULL;
+    if(fp) {
+        long file_len = cave_file_len(fp);
+        if(file_len < 84 || (file_len - 84) % 50 != 0 || (unsigned long) (file_len - 84) / 50 > UINT32_MAX) {
+            fclose(fp);
+            return CAVE_DATA_ERROR;
+        }
+        //the records on disk win over the header. If a writer died between writing records and
+        //patching the count, this picks up every whole triangle it wrote.
+        app->tri_count = (uint32_t) ((file_len - 84) / 50);
+        if(fseek(fp, 0, SEEK_END) != 0) {
+            fclose(fp);
+            return CAVE_FILE_ERROR;
+        }
+    } else {
+        fp = fopen(path, "w+b");
+        if(!fp) {
+            return CAVE_FILE_ERROR;
+        }
+        uint8_t start[84];
+        memset(start, 0, 84);
+        if(header) {
+            memcpy(start, header, 80);
+        }
+        if(fwrite(start, 1, 84, fp) != 84) {
+            fclose(fp);
+            return CAVE_FILE_ERROR;
+        }
+    }
+
+    app->buffer = malloc(50 * CAVE_STL_APPENDER_BUFFER_TRIS);
+    if(!app->buffer) {
+        fclose(fp);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    app->fp = fp;
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_STL_Appender_append(cave_STL_Appender* app, cave_STL_Tri const* tris, size_t count) {
+    if(!app || !app->fp || (!tris && count != 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    if(app->failed) {
+        return CAVE_FILE_ERROR;
+    }
+    if(count > UINT32_MAX - app->tri_count - app->buffered) {
+        return CAVE_DATA_ERROR;
+    }
+    while(count > 0) {
+        size_t room = CAVE_STL_APPENDER_BUFFER_TRIS - app->buffered;
+        size_t batch = count < room ? count : room;
+        hidden_cave_encode_STL_tris(app->buffer + (app->buffered * 50), tris, batch);
+        app->buffered += batch;
+        tris += batch;
+        count -= batch;
+        if(app->buffered == CAVE_STL_APPENDER_BUFFER_TRIS) {
+            CaveError err = hidden_cave_appender_write_buffer(app);
+            if(err != CAVE_NO_ERROR) {
+                return err;
+            }
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_STL_Appender_flush(cave_STL_Appender* app) {
+    if(!app || !app->fp) {
+        return CAVE_DATA_ERROR;
+    }
+    if(app->failed) {
+        return CAVE_FILE_ERROR;
+    }
+    CaveError err = hidden_cave_appender_write_buffer(app);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    //records first, then the count, so the count never claims triangles that aren't on disk
+    if(fflush(app->fp) != 0 ||
+       fseek(app->fp, 80, SEEK_SET) != 0 ||
+       fwrite(&app->tri_count, 4, 1, app->fp) != 1 ||
+       fseek(app->fp, 0, SEEK_END) != 0 ||
+       fflush(app->fp) != 0) {
+        app->failed = true;
+        return CAVE_FILE_ERROR;
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError cave_STL_Appender_close(cave_STL_Appender* app) {
+    if(!app || !app->fp) {
+        return CAVE_DATA_ERROR;
+    }
+    CaveError err = cave_STL_Appender_flush(app);
+    if(fclose(app->fp) != 0 && err == CAVE_NO_ERROR) {
+        err = CAVE_FILE_ERROR;
+    }
+    free(app->buffer);
+    memset(app, 0, sizeof(cave_STL_Appender));
+    return err;
+}
@@ -8,6 +8,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 //#include <string.h>
 //#include <inttypes.h>
 //#include <stdlib.h>
@@ -1,9 +1,1415 @@
 //
 // Created by David Sullivan on 11/17/22.
 //
+#include "test-utilities.h"
+#include "cave-polytri.h"
+#include "cave-predicates.h"
+#include "cave-simplify.h"
+#include "cave-boolean.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
 
-#include "cave-writer.h"
+static double polygon_area(cave_2Point const* points, size_t count) {
+    double sum = 0.0;
+    for(size_t i = 0, j = count - 1; i < count; j = i++) {
+        sum += (double) points[j].x * points[i].y - (double) points[i].x * points[j].y;
+    }
+    return sum / 2;
+}
+
+static double triangle_area(cave_2Point a, cave_2Point b, cave_2Point c) {
+    return (((double) b.x - a.x) * ((double) c.y - a.y) - ((double) c.x - a.x) * ((double) b.y - a.y)) / 2;
+}
+
+//checks that every triangle is counter-clockwise and that together they cover the polygon's area
+static bool triangulation_covers(cave_Index_Triangle const* tris, size_t tri_count,
+                                 cave_2Point const* points, size_t point_count) {
+    double sum = 0.0;
+    for(size_t i = 0; i < tri_count; i++) {
+        if(tris[i].a >= point_count || tris[i].b >= point_count || tris[i].c >= point_count) {
+            return false;
+        }
+        double area = triangle_area(points[tris[i].a], points[tris[i].b], points[tris[i].c]);
+        if(area < 0) {
+            return false;
+        }
+        sum += area;
+    }
+    double expected = fabs(polygon_area(points, point_count));
+    return fabs(sum - expected) <= 1e-6 * expected;
+}
+
+//a wavy outline with `count` points, with some noise on top, like a traced contour
+static cave_2Point* make_outline(size_t count) {
+    cave_2Point* points = malloc(sizeof(cave_2Point) * count);
+    if(!points) {
+        return NULL;
+    }
+    for(size_t i = 0; i < count; i++) {
+        double angle = 2 * M_PI * (double) i / (double) count;
+        double noise = (double) ((i * 2654435761u) % 1000) / 1000.0 - 0.5;
+        double radius = 100.0 + 5.0 * sin(angle * 37) + 0.01 * noise;
+        points[i].x = (float) (radius * cos(angle));
+        points[i].y = (float) (radius * sin(angle));
+    }
+    return points;
+}
+
+CaveError triangulate_simple_shapes() {
+    cave_2Point square[4] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    cave_Index_Triangle* tris;
+    size_t tri_count;
+    CaveError err = cave_polytri_triangulate(&tris, &tri_count, square, 4);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    if(tri_count != 2 || !triangulation_covers(tris, tri_count, square, 4)) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_2d_Triangle expanded[2];
+    err = cave_polytri_to_2d_Triangles(expanded, tris, tri_count, square, 4);
+    free(tris);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    if(triangle_area(expanded[0].a, expanded[0].b, expanded[0].c) != 0.5) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //clockwise, concave, with a repeated point and a collinear one
+    cave_2Point comb[] = {{0, 0}, {0, 3}, {1, 3}, {1, 1}, {2, 1}, {2, 3}, {3, 3}, {3, 3}, {3, 1.5f}, {3, 0}};
+    size_t comb_count = sizeof(comb) / sizeof(comb[0]);
+    err = cave_polytri_triangulate(&tris, &tri_count, comb, comb_count);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    bool correct = tri_count <= comb_count - 2 && triangulation_covers(tris, tri_count, comb, comb_count);
+    free(tris);
+    return correct ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+}
+
+CaveError triangulate_degenerate_input() {
+    cave_Index_Triangle* tris;
+    size_t tri_count;
+    cave_2Point line[4] = {{0, 0}, {1, 1}, {2, 2}, {3, 3}};
+    CaveError err = cave_polytri_triangulate(&tris, &tri_count, line, 4);
+    if(err != CAVE_NO_ERROR || tri_count != 0 || tris != NULL) {
+        return CAVE_DATA_ERROR;
+    }
+    err = cave_polytri_triangulate(&tris, &tri_count, line, 2);
+    if(err != CAVE_NO_ERROR || tri_count != 0) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_2Point bad[3] = {{0, 0}, {NAN, 1}, {1, 0}};
+    if(cave_polytri_triangulate(&tris, &tri_count, bad, 3) != CAVE_DATA_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_Index_Triangle out_of_range = {0, 1, 7};
+    cave_2d_Triangle expanded;
+    if(cave_polytri_to_2d_Triangles(&expanded, &out_of_range, 1, line, 4) != CAVE_INDEX_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+    return CAVE_NO_ERROR;
+}
+
+typedef CaveError (*triangulator)(cave_Index_Triangle** dest, size_t* tri_count,
+                                  cave_2Point const* points, size_t point_count);
+
+//random star shaped polygons, which are always simple, on both sides of the hashing threshold
+CaveError triangulate_random_polygons() {
+    triangulator methods[2] = {cave_polytri_triangulate, cave_polytri_triangulate_monotone};
+    unsigned seed = 12345;
+    cave_2Point points[300];
+    for(int round = 0; round < 200; round++) {
+        size_t count = 3 + (size_t) (round * 37) % 290;
+        for(size_t i = 0; i < count; i++) {
+            seed = seed * 1103515245u + 12345u;
+            double radius = 10.0 + (double) ((seed >> 8) % 1000) / 10.0;
+            double angle = 2 * M_PI * (double) i / (double) count;
+            points[i].x = (float) (radius * cos(angle));
+            points[i].y = (float) (radius * sin(angle));
+        }
+        for(int method = 0; method < 2; method++) {
+            cave_Index_Triangle* tris;
+            size_t tri_count;
+            CaveError err = methods[method](&tris, &tri_count, points, count);
+            if(err != CAVE_NO_ERROR) {
+                return err;
+            }
+            bool correct = tri_count == count - 2 && triangulation_covers(tris, tri_count, points, count);
+            free(tris);
+            if(!correct) {
+                printf("method %d failed on a polygon of %zu points\n", method, count);
+                return CAVE_DATA_ERROR;
+            }
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError triangulate_large_polygon() {
+    //well past `CAVE_POLYTRI_HASH_THRESHOLD`, so that ears are found through the z-order hash
+    size_t count = 20000;
+    cave_2Point* outline = make_outline(count);
+    if(!outline) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    cave_Index_Triangle* tris;
+    size_t tri_count;
+    CaveError err = cave_polytri_triangulate(&tris, &tri_count, outline, count);
+    if(err != CAVE_NO_ERROR) {
+        free(outline);
+        return err;
+    }
+    bool correct = tri_count == count - 2 && triangulation_covers(tris, tri_count, outline, count);
+    free(tris);
+    free(outline);
+    return correct ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+}
+
+//a comb with deep teeth is the worst case for ear clipping, which has to wade through the other teeth
+CaveError triangulate_monotone_comb() {
+    size_t teeth = 5000;
+    size_t count = 4 * teeth;
+    cave_2Point* comb = malloc(sizeof(cave_2Point) * count);
+    if(!comb) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < teeth; i++) {
+        comb[4 * i] = (cave_2Point) {(float) (2 * i), 0.0f};
+        comb[4 * i + 1] = (cave_2Point) {(float) (2 * i) + 1.0f, 0.0f};
+        comb[4 * i + 2] = (cave_2Point) {(float) (2 * i) + 1.0f, 1000.0f};
+        comb[4 * i + 3] = (cave_2Point) {(float) (2 * i) + 2.0f, 1000.0f};
+    }
+    //closes the comb along its back
+    comb[count - 1] = (cave_2Point) {(float) (2 * teeth), -10.0f};
+    comb[count - 2] = (cave_2Point) {(float) (2 * teeth), 1000.0f};
+    comb[0].y = -10.0f;
+
+    cave_Index_Triangle* tris;
+    size_t tri_count;
+    CaveError err = cave_polytri_triangulate_monotone(&tris, &tri_count, comb, count);
+    if(err != CAVE_NO_ERROR) {
+        free(comb);
+        return err;
+    }
+    bool correct = tri_count == count - 2 && triangulation_covers(tris, tri_count, comb, count);
+    free(tris);
+    free(comb);
+    return correct ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+}
+
+//a square ring around (x, y) with sides `size` long, counter-clockwise for an outline or clockwise for a hole
+static void add_square(cave_2Point* points, size_t* offsets, size_t* ring_count, float x, float y, float size,
+                       bool hole) {
+    cave_2Point* at = points + offsets[*ring_count];
+    at[0] = (cave_2Point) {x, y};
+    at[hole ? 3 : 1] = (cave_2Point) {x + size, y};
+    at[2] = (cave_2Point) {x + size, y + size};
+    at[hole ? 1 : 3] = (cave_2Point) {x, y + size};
+    offsets[*ring_count + 1] = offsets[*ring_count] + 4;
+    (*ring_count)++;
+}
+
+//like `triangulation_covers()`, against the area of every outline less that of its holes
+static bool polygon_triangulation_covers(cave_Index_Triangle const* tris, size_t tri_count,
+                                         cave_2d_Polygon const* polygon, double expected) {
+    size_t point_count = polygon->ring_offsets[polygon->ring_count];
+    double sum = 0.0;
+    for(size_t i = 0; i < tri_count; i++) {
+        if(tris[i].a >= point_count || tris[i].b >= point_count || tris[i].c >= point_count) {
+            return false;
+        }
+        double area = triangle_area(polygon->points[tris[i].a], polygon->points[tris[i].b],
+                                    polygon->points[tris[i].c]);
+        if(area < 0) {
+            return false;
+        }
+        sum += area;
+    }
+    return fabs(sum - expected) <= 1e-6 * expected;
+}
+
+typedef CaveError (*polygon_triangulator)(cave_Index_Triangle** dest, size_t* tri_count,
+                                          cave_2d_Polygon const* polygon);
+
+//a plate drilled with a grid of square holes, like a perforated slice
+CaveError triangulate_polygon_holes() {
+    size_t side = 30;
+    size_t hole_count = side * side;
+    size_t ring_count = 0;
+    cave_2Point* points = malloc(sizeof(cave_2Point) * 4 * (hole_count + 1));
+    size_t* offsets = malloc(sizeof(size_t) * (hole_count + 2));
+    if(!points || !offsets) {
+        free(points);
+        free(offsets);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    offsets[0] = 0;
+    add_square(points, offsets, &ring_count, 0.0f, 0.0f, (float) (2 * side + 1), false);
+    for(size_t i = 0; i < side; i++) {
+        for(size_t j = 0; j < side; j++) {
+            //staggered, so holes in a column don't line up with each other
+            float y = (float) (2 * j + 1) + (i % 2 ? 0.25f : 0.0f);
+            add_square(points, offsets, &ring_count, (float) (2 * i + 1), y, 0.5f, true);
+        }
+    }
+    cave_2d_Polygon polygon = {points, offsets, ring_count};
+    double expected = (double) (2 * side + 1) * (double) (2 * side + 1) - 0.25 * (double) hole_count;
+
+    polygon_triangulator methods[2] = {cave_polytri_triangulate_polygon, cave_polytri_triangulate_polygon_monotone};
+    CaveError err = CAVE_NO_ERROR;
+    for(int method = 0; method < 2 && err == CAVE_NO_ERROR; method++) {
+        cave_Index_Triangle* tris;
+        size_t tri_count;
+        err = methods[method](&tris, &tri_count, &polygon);
+        if(err != CAVE_NO_ERROR) {
+            break;
+        }
+        size_t point_count = offsets[ring_count];
+        if(tri_count > point_count + 2 * hole_count - 2 ||
+           !polygon_triangulation_covers(tris, tri_count, &polygon, expected)) {
+            err = CAVE_DATA_ERROR;
+        }
+        free(tris);
+    }
+    free(points);
+    free(offsets);
+    return err;
+}
+
+CaveError triangulate_polygon_outlines() {
+    cave_2Point points[6 * 4];
+    size_t offsets[7] = {0};
+    size_t ring_count = 0;
+    //two outlines with a hole in each, and an island in the first hole
+    add_square(points, offsets, &ring_count, 0.0f, 0.0f, 4.0f, false);
+    add_square(points, offsets, &ring_count, 10.0f, 0.0f, 4.0f, false);
+    add_square(points, offsets, &ring_count, 1.0f, 1.0f, 2.0f, true);
+    add_square(points, offsets, &ring_count, 11.0f, 1.0f, 1.0f, true);
+    add_square(points, offsets, &ring_count, 1.5f, 1.5f, 1.0f, false);
+    double expected = 16.0 - 4.0 + 1.0 + 16.0 - 1.0;
+    //a hole outside every outline, which only ear clipping can be given
+    add_square(points, offsets, &ring_count, 100.0f, 100.0f, 1.0f, true);
+
+    polygon_triangulator methods[2] = {cave_polytri_triangulate_polygon, cave_polytri_triangulate_polygon_monotone};
+    for(int method = 0; method < 2; method++) {
+        cave_2d_Polygon polygon = {points, offsets, method == 0 ? ring_count : ring_count - 1};
+        cave_Index_Triangle* tris;
+        size_t tri_count;
+        CaveError err = methods[method](&tris, &tri_count, &polygon);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+        bool correct = polygon_triangulation_covers(tris, tri_count, &polygon, expected);
+        free(tris);
+        if(!correct) {
+            printf("method %d failed on separate outlines\n", method);
+            return CAVE_DATA_ERROR;
+        }
+    }
+
+    cave_Index_Triangle* tris;
+    size_t tri_count;
+    cave_2d_Polygon empty = {NULL, NULL, 0};
+    CaveError err = cave_polytri_triangulate_polygon(&tris, &tri_count, &empty);
+    if(err != CAVE_NO_ERROR || tris != NULL || tri_count != 0) {
+        return CAVE_DATA_ERROR;
+    }
+    size_t backwards[3] = {0, 8, 4};
+    cave_2d_Polygon bad = {points, backwards, 2};
+    if(cave_polytri_triangulate_polygon(&tris, &tri_count, &bad) != CAVE_DATA_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+    return CAVE_NO_ERROR;
+}
+
+//many small polygons, some with a hole, triangulated in one batch and then one at a time
+CaveError triangulate_polygon_batch() {
+    //enough points for several of the default chunks
+    size_t polygon_count = 4000;
+    cave_2Point* points = malloc(sizeof(cave_2Point) * 48 * polygon_count);
+    size_t* ring_offsets = malloc(sizeof(size_t) * (2 * polygon_count + 1));
+    size_t* polygon_rings = malloc(sizeof(size_t) * (polygon_count + 1));
+    if(!points || !ring_offsets || !polygon_rings) {
+        free(points);
+        free(ring_offsets);
+        free(polygon_rings);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    unsigned seed = 777;
+    size_t ring_count = 0;
+    ring_offsets[0] = 0;
+    polygon_rings[0] = 0;
+    for(size_t i = 0; i < polygon_count; i++) {
+        double cx = (double) (i % 200) * 50.0, cy = (double) (i / 200) * 50.0;
+        size_t count = 3 + i % 38;
+        cave_2Point* at = points + ring_offsets[ring_count];
+        for(size_t k = 0; k < count; k++) {
+            seed = seed * 1103515245u + 12345u;
+            double radius = 10.0 + (double) ((seed >> 8) % 1000) / 100.0;
+            double angle = 2 * M_PI * (double) k / (double) count;
+            at[k] = (cave_2Point) {(float) (cx + radius * cos(angle)), (float) (cy + radius * sin(angle))};
+        }
+        ring_offsets[ring_count + 1] = ring_offsets[ring_count] + count;
+        ring_count++;
+        if(i % 4 == 0) {
+            at = points + ring_offsets[ring_count];
+            at[0] = (cave_2Point) {(float) cx, (float) cy};
+            at[1] = (cave_2Point) {(float) cx, (float) cy + 3.0f};
+            at[2] = (cave_2Point) {(float) cx + 3.0f, (float) cy};
+            ring_offsets[ring_count + 1] = ring_offsets[ring_count] + 3;
+            ring_count++;
+        }
+        polygon_rings[i + 1] = ring_count;
+    }
+    cave_2d_Polygon rings = {points, ring_offsets, ring_count};
+
+    cave_Index_Triangle* tris[2] = {NULL, NULL};
+    size_t* tri_offsets[2] = {NULL, NULL};
+    cave_PolyTri_Batch_Options single = {1, 0};
+    cave_PolyTri_Batch_Options const* options[2] = {NULL, &single};
+    CaveError err = CAVE_NO_ERROR;
+    for(int run = 0; run < 2 && err == CAVE_NO_ERROR; run++) {
+        err = cave_polytri_triangulate_batch(tris + run, tri_offsets + run, &rings, polygon_rings, polygon_count,
+                                             options[run]);
+    }
+
+    //the same triangles as triangulating each polygon by itself, whatever the threading
+    for(size_t i = 0; i < polygon_count && err == CAVE_NO_ERROR; i++) {
+        cave_2d_Polygon polygon = {points, ring_offsets + polygon_rings[i], polygon_rings[i + 1] - polygon_rings[i]};
+        cave_Index_Triangle* alone;
+        size_t alone_count;
+        err = cave_polytri_triangulate_polygon(&alone, &alone_count, &polygon);
+        if(err != CAVE_NO_ERROR) {
+            break;
+        }
+        for(int run = 0; run < 2; run++) {
+            size_t first = tri_offsets[run][i];
+            if(tri_offsets[run][i + 1] - first != alone_count ||
+               (alone_count > 0 && memcmp(tris[run] + first, alone, sizeof(cave_Index_Triangle) * alone_count) != 0)) {
+                printf("polygon %zu differs from the batch\n", i);
+                err = CAVE_DATA_ERROR;
+            }
+        }
+        free(alone);
+    }
+    for(int run = 0; run < 2; run++) {
+        free(tris[run]);
+        free(tri_offsets[run]);
+    }
+
+    if(err == CAVE_NO_ERROR) {
+        points[ring_offsets[polygon_rings[polygon_count / 2]]].x = NAN;
+        cave_Index_Triangle* bad_tris;
+        size_t* bad_offsets;
+        if(cave_polytri_triangulate_batch(&bad_tris, &bad_offsets, &rings, polygon_rings, polygon_count, NULL) !=
+           CAVE_DATA_ERROR || bad_tris != NULL || bad_offsets != NULL) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    free(points);
+    free(ring_offsets);
+    free(polygon_rings);
+    return err;
+}
+
+//true if no point lies strictly inside any triangle's circumcircle, checked by brute force
+static bool triangulation_is_delaunay(cave_Index_Triangle const* tris, size_t tri_count,
+                                      cave_2Point const* points, size_t point_count) {
+    for(size_t i = 0; i < tri_count; i++) {
+        cave_2Point a = points[tris[i].a], b = points[tris[i].b], c = points[tris[i].c];
+        for(size_t k = 0; k < point_count; k++) {
+            double adx = (double) a.x - points[k].x, ady = (double) a.y - points[k].y;
+            double bdx = (double) b.x - points[k].x, bdy = (double) b.y - points[k].y;
+            double cdx = (double) c.x - points[k].x, cdy = (double) c.y - points[k].y;
+            double det = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy) -
+                         (bdx * bdx + bdy * bdy) * (adx * cdy - cdx * ady) +
+                         (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+            if(det > 1e-9) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool triangulation_has_edge(cave_Index_Triangle const* tris, size_t tri_count, size_t a, size_t b) {
+    for(size_t i = 0; i < tri_count; i++) {
+        size_t v[3] = {tris[i].a, tris[i].b, tris[i].c};
+        for(int k = 0; k < 3; k++) {
+            if((v[k] == a && v[(k + 1) % 3] == b) || (v[k] == b && v[(k + 1) % 3] == a)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+CaveError triangulate_cdt() {
+    //scattered points, with a breakline across them that plain Delaunay wouldn't have
+    size_t count = 400;
+    cave_2Point points[400];
+    unsigned seed = 4242;
+    for(size_t i = 0; i < count; i++) {
+        seed = seed * 1103515245u + 12345u;
+        points[i].x = (float) ((seed >> 8) % 10000) / 100.0f;
+        seed = seed * 1103515245u + 12345u;
+        points[i].y = (float) ((seed >> 8) % 10000) / 100.0f;
+    }
+    points[0] = (cave_2Point) {-1.0f, 50.0f};
+    points[1] = (cave_2Point) {101.0f, 50.5f};
+    cave_Index_Triangle* tris;
+    size_t tri_count;
+    CaveError err = cave_polytri_triangulate_cdt(&tris, &tri_count, points, count, NULL, 0, false);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    bool correct = triangulation_is_delaunay(tris, tri_count, points, count) &&
+                   !triangulation_has_edge(tris, tri_count, 0, 1);
+    free(tris);
+    if(!correct) {
+        printf("unconstrained triangulation isn't Delaunay\n");
+        return CAVE_DATA_ERROR;
+    }
+    cave_Index_Edge breakline = {0, 1};
+    err = cave_polytri_triangulate_cdt(&tris, &tri_count, points, count, &breakline, 1, false);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    correct = triangulation_has_edge(tris, tri_count, 0, 1);
+    for(size_t i = 0; i < tri_count && correct; i++) {
+        correct = triangle_area(points[tris[i].a], points[tris[i].b], points[tris[i].c]) > 0;
+    }
+    free(tris);
+    if(!correct) {
+        printf("constrained triangulation lost its breakline\n");
+        return CAVE_DATA_ERROR;
+    }
+    cave_Index_Edge crossing[2] = {{0, 1}, {2, 3}};
+    points[2] = (cave_2Point) {50.0f, -1.0f};
+    points[3] = (cave_2Point) {50.5f, 101.0f};
+    if(cave_polytri_triangulate_cdt(&tris, &tri_count, points, count, crossing, 2, false) != CAVE_DATA_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_Index_Edge out_of_range = {0, count};
+    if(cave_polytri_triangulate_cdt(&tris, &tri_count, points, count, &out_of_range, 1, false) !=
+       CAVE_INDEX_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //the same rings as the ear clipping test, where filling finds the holes by nesting
+    cave_2Point ring_points[5 * 4];
+    size_t offsets[6] = {0};
+    size_t ring_count = 0;
+    add_square(ring_points, offsets, &ring_count, 0.0f, 0.0f, 4.0f, false);
+    add_square(ring_points, offsets, &ring_count, 10.0f, 0.0f, 4.0f, false);
+    add_square(ring_points, offsets, &ring_count, 1.0f, 1.0f, 2.0f, true);
+    add_square(ring_points, offsets, &ring_count, 11.0f, 1.0f, 1.0f, false);
+    add_square(ring_points, offsets, &ring_count, 1.5f, 1.5f, 1.0f, false);
+    cave_2d_Polygon polygon = {ring_points, offsets, ring_count};
+    err = cave_polytri_triangulate_polygon_cdt(&tris, &tri_count, &polygon);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    correct = polygon_triangulation_covers(tris, tri_count, &polygon, 16.0 - 4.0 + 1.0 + 16.0 - 1.0);
+    free(tris);
+    if(!correct) {
+        printf("constrained triangulation filled the wrong rings\n");
+        return CAVE_DATA_ERROR;
+    }
+
+    size_t large_count = 20000;
+    cave_2Point* outline = make_outline(large_count);
+    if(!outline) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    size_t outline_offsets[2] = {0, large_count};
+    cave_2d_Polygon large = {outline, outline_offsets, 1};
+    err = cave_polytri_triangulate_polygon_cdt(&tris, &tri_count, &large);
+    if(err == CAVE_NO_ERROR) {
+        if(tri_count != large_count - 2 || !triangulation_covers(tris, tri_count, outline, large_count)) {
+            err = CAVE_DATA_ERROR;
+        }
+        free(tris);
+    }
+    free(outline);
+    return err;
+}
+
+static int sign_of(double value) {
+    return (value > 0) - (value < 0);
+}
+
+//points a few float ulps from the line y = x, with the other two on it much further out, where a plain double
+//determinant gets the sign wrong. With `b` and `c` on the line, the determinant is (b.x - c.x) * (a.x - a.y).
+CaveError robust_predicates() {
+    cave_2Point b = {1.1e9f, 1.1e9f}, c = {2.9e9f, 2.9e9f};
+    size_t side = 64, count = side * side;
+    cave_2Point* as = malloc(sizeof(cave_2Point) * count);
+    cave_2Point* bs = malloc(sizeof(cave_2Point) * count);
+    cave_2Point* cs = malloc(sizeof(cave_2Point) * count);
+    double* results = malloc(sizeof(double) * count);
+    if(!as || !bs || !cs || !results) {
+        free(as);
+        free(bs);
+        free(cs);
+        free(results);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    CaveError err = CAVE_NO_ERROR;
+    size_t naive_wrong = 0;
+    cave_2Point a = {1.0f, 1.0f};
+    for(size_t i = 0; i < side; i++, a.x = nextafterf(a.x, 2.0f)) {
+        a.y = 1.0f;
+        for(size_t j = 0; j < side; j++, a.y = nextafterf(a.y, 2.0f)) {
+            int expected = (a.x < a.y) - (a.x > a.y);
+            double naive = ((double) a.x - c.x) * ((double) b.y - c.y) - ((double) a.y - c.y) * ((double) b.x - c.x);
+            naive_wrong += sign_of(naive) != expected;
+            if(sign_of(cave_orient2d(a, b, c)) != expected) {
+                err = CAVE_DATA_ERROR;
+            }
+            as[i * side + j] = a;
+            bs[i * side + j] = b;
+            cs[i * side + j] = c;
+        }
+    }
+    if(err != CAVE_NO_ERROR) {
+        printf("orient2d got a sign wrong near a line\n");
+    }
+    //the batch agrees with the single point version, and is just as right
+    if(err == CAVE_NO_ERROR) {
+        err = cave_orient2d_batch(results, as, bs, cs, count);
+        for(size_t i = 0; i < count && err == CAVE_NO_ERROR; i++) {
+            if(sign_of(results[i]) != sign_of(cave_orient2d(as[i], bs[i], cs[i]))) {
+                printf("orient2d batch disagrees at %zu\n", i);
+                err = CAVE_DATA_ERROR;
+            }
+        }
+    }
+    printf("plain doubles got %zu of %zu orientations near a line wrong\n", naive_wrong, count);
+
+    //points on a circle of radius 25 far from the origin, then one nudged a float ulp in and out of it
+    cave_2Point center = {4096.0f, -2048.0f};
+    cave_2Point ring[4] = {{center.x + 7, center.y + 24}, {center.x - 15, center.y + 20},
+                           {center.x - 24, center.y - 7}, {center.x + 20, center.y - 15}};
+    cave_2Point inside = {nextafterf(ring[3].x, center.x), ring[3].y};
+    cave_2Point outside = {nextafterf(ring[3].x, 1e9f), ring[3].y};
+    if(err == CAVE_NO_ERROR && (cave_incircle(ring[0], ring[1], ring[2], ring[3]) != 0 ||
+                                cave_incircle(ring[0], ring[1], ring[2], inside) <= 0 ||
+                                cave_incircle(ring[0], ring[1], ring[2], outside) >= 0 ||
+                                cave_incircle(ring[0], ring[2], ring[1], inside) >= 0)) {
+        printf("incircle got a sign wrong on a circle\n");
+        err = CAVE_DATA_ERROR;
+    }
+    if(err == CAVE_NO_ERROR) {
+        cave_2Point ia[3] = {ring[0], ring[0], ring[0]}, ib[3] = {ring[1], ring[1], ring[1]};
+        cave_2Point ic[3] = {ring[2], ring[2], ring[2]}, id[3] = {ring[3], inside, outside};
+        err = cave_incircle_batch(results, ia, ib, ic, id, 3);
+        if(err == CAVE_NO_ERROR && (results[0] != 0 || results[1] <= 0 || results[2] >= 0)) {
+            printf("incircle batch got a sign wrong on a circle\n");
+            err = CAVE_DATA_ERROR;
+        }
+    }
+
+    //points on the plane z = x + 2y, then one nudged a float ulp above and below it
+    cave_3Point plane[4] = {{1000, 3000, 7000}, {1024, 3000, 7024}, {1000, 3072, 7144}, {1500, 2900, 7300}};
+    cave_3Point above = {plane[3].x, plane[3].y, nextafterf(plane[3].z, 1e9f)};
+    cave_3Point below = {plane[3].x, plane[3].y, nextafterf(plane[3].z, -1e9f)};
+    if(err == CAVE_NO_ERROR && (cave_orient3d(plane[0], plane[1], plane[2], plane[3]) != 0 ||
+                                cave_orient3d(plane[0], plane[1], plane[2], above) >= 0 ||
+                                cave_orient3d(plane[0], plane[1], plane[2], below) <= 0)) {
+        printf("orient3d got a sign wrong on a plane\n");
+        err = CAVE_DATA_ERROR;
+    }
+    if(err == CAVE_NO_ERROR) {
+        cave_3Point pa[3] = {plane[0], plane[0], plane[0]}, pb[3] = {plane[1], plane[1], plane[1]};
+        cave_3Point pc[3] = {plane[2], plane[2], plane[2]}, pd[3] = {plane[3], above, below};
+        err = cave_orient3d_batch(results, pa, pb, pc, pd, 3);
+        if(err == CAVE_NO_ERROR && (results[0] != 0 || results[1] >= 0 || results[2] <= 0)) {
+            printf("orient3d batch got a sign wrong on a plane\n");
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    if(err == CAVE_NO_ERROR && cave_orient2d_batch(NULL, as, bs, cs, 1) != CAVE_DATA_ERROR) {
+        err = CAVE_DATA_ERROR;
+    }
+    free(as);
+    free(bs);
+    free(cs);
+    free(results);
+    return err;
+}
+
+//puts the 2D points in the plane through `origin` spanned by the orthonormal `u` and `v`
+static void embed_points(cave_3Point* dest, cave_2Point const* src, size_t count, cave_3Point origin,
+                         cave_3Point u, cave_3Point v) {
+    for(size_t i = 0; i < count; i++) {
+        dest[i].x = origin.x + src[i].x * u.x + src[i].y * v.x;
+        dest[i].y = origin.y + src[i].x * u.y + src[i].y * v.y;
+        dest[i].z = origin.z + src[i].x * u.z + src[i].y * v.z;
+    }
+}
+
+//checks that every triangle faces along `normal` (or against it, if `flipped`) and that together they cover
+//`expected` area
+static bool triangulation_covers_3d(cave_Index_Triangle const* tris, size_t tri_count, cave_3Point const* points,
+                                    cave_3Point normal, bool flipped, double expected) {
+    double sum = 0.0;
+    for(size_t i = 0; i < tri_count; i++) {
+        cave_3Point a = points[tris[i].a], b = points[tris[i].b], c = points[tris[i].c];
+        double e1[3] = {(double) b.x - a.x, (double) b.y - a.y, (double) b.z - a.z};
+        double e2[3] = {(double) c.x - a.x, (double) c.y - a.y, (double) c.z - a.z};
+        double cross[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                           e1[0] * e2[1] - e1[1] * e2[0]};
+        double along = cross[0] * normal.x + cross[1] * normal.y + cross[2] * normal.z;
+        if(flipped ? along > 0 : along < 0) {
+            return false;
+        }
+        sum += fabs(along) / 2;
+    }
+    return fabs(sum - expected) <= 1e-4 * expected;
+}
+
+CaveError triangulate_3d_faces() {
+    //a square plate with a square hole, tilted so no axis plane is close to it, and far from the origin
+    cave_2Point flat[8];
+    size_t offsets[3] = {0};
+    size_t ring_count = 0;
+    add_square(flat, offsets, &ring_count, 0.0f, 0.0f, 4.0f, false);
+    add_square(flat, offsets, &ring_count, 1.0f, 1.0f, 2.0f, true);
+    cave_3Point u = {1.0f / 3, 2.0f / 3, 2.0f / 3}, v = {2.0f / 3, 1.0f / 3, -2.0f / 3};
+    cave_3Point normal = {-2.0f / 3, 2.0f / 3, -1.0f / 3};
+    cave_3Point origin = {1000.0f, -2000.0f, 500.0f};
+    cave_3Point points[8];
+    embed_points(points, flat, 8, origin, u, v);
+    cave_3d_Polygon face = {points, offsets, ring_count};
+    cave_Index_Triangle* tris;
+    size_t tri_count;
+    CaveError err = cave_polytri_triangulate_3d(&tris, &tri_count, &face);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    bool correct = tri_count == 8 && triangulation_covers_3d(tris, tri_count, points, normal, false, 12.0);
+    free(tris);
+    if(!correct) {
+        printf("a tilted face with a hole came out wrong\n");
+        return CAVE_DATA_ERROR;
+    }
+    //wound the other way, the triangles turn over with it
+    for(size_t r = 0; r < ring_count; r++) {
+        for(size_t i = offsets[r], j = offsets[r + 1] - 1; i < j; i++, j--) {
+            cave_3Point swap = points[i];
+            points[i] = points[j];
+            points[j] = swap;
+        }
+    }
+    err = cave_polytri_triangulate_3d(&tris, &tri_count, &face);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    correct = tri_count == 8 && triangulation_covers_3d(tris, tri_count, points, normal, true, 12.0);
+    free(tris);
+    if(!correct) {
+        printf("a tilted face wound clockwise came out wrong\n");
+        return CAVE_DATA_ERROR;
+    }
+    cave_3Point line[4] = {{0, 0, 0}, {1, 1, 1}, {2, 2, 2}, {3, 3, 3}};
+    size_t line_offsets[2] = {0, 4};
+    cave_3d_Polygon collinear = {line, line_offsets, 1};
+    err = cave_polytri_triangulate_3d(&tris, &tri_count, &collinear);
+    if(err != CAVE_NO_ERROR || tri_count != 0 || tris != NULL) {
+        return CAVE_DATA_ERROR;
+    }
+    line[2].z = NAN;
+    if(cave_polytri_triangulate_3d(&tris, &tri_count, &collinear) != CAVE_DATA_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //a pile of small faces facing every which way, in one batch and then one at a time
+    size_t face_count = 10000;
+    cave_3Point* face_points = malloc(sizeof(cave_3Point) * 16 * face_count);
+    size_t* ring_offsets = malloc(sizeof(size_t) * (2 * face_count + 1));
+    size_t* face_rings = malloc(sizeof(size_t) * (face_count + 1));
+    if(!face_points || !ring_offsets || !face_rings) {
+        free(face_points);
+        free(ring_offsets);
+        free(face_rings);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    unsigned seed = 99;
+    ring_count = 0;
+    ring_offsets[0] = 0;
+    face_rings[0] = 0;
+    for(size_t i = 0; i < face_count; i++) {
+        double angles[2];
+        for(int k = 0; k < 2; k++) {
+            seed = seed * 1103515245u + 12345u;
+            angles[k] = 2 * M_PI * (double) ((seed >> 8) % 1000) / 1000.0;
+        }
+        //an orthonormal pair turned by both angles
+        cave_3Point fu = {(float) cos(angles[0]), (float) sin(angles[0]), 0.0f};
+        cave_3Point fv = {(float) (-sin(angles[0]) * cos(angles[1])), (float) (cos(angles[0]) * cos(angles[1])),
+                          (float) sin(angles[1])};
+        cave_3Point at = {(float) (i % 100) * 10.0f, (float) (i / 100 % 100) * 10.0f, (float) (i / 10000) * 10.0f};
+        size_t count = 3 + i % 10;
+        cave_2Point ring[12];
+        for(size_t k = 0; k < count; k++) {
+            double angle = 2 * M_PI * (double) k / (double) count;
+            ring[k] = (cave_2Point) {(float) (3.0 * cos(angle)), (float) (3.0 * sin(angle))};
+        }
+        embed_points(face_points + ring_offsets[ring_count], ring, count, at, fu, fv);
+        ring_offsets[ring_count + 1] = ring_offsets[ring_count] + count;
+        ring_count++;
+        if(i % 5 == 0) {
+            cave_2Point hole[3] = {{-0.5f, -0.5f}, {-0.5f, 0.5f}, {0.5f, -0.5f}};
+            embed_points(face_points + ring_offsets[ring_count], hole, 3, at, fu, fv);
+            ring_offsets[ring_count + 1] = ring_offsets[ring_count] + 3;
+            ring_count++;
+        }
+        face_rings[i + 1] = ring_count;
+    }
+    cave_3d_Polygon rings = {face_points, ring_offsets, ring_count};
+    cave_Index_Triangle* batch_tris;
+    size_t* tri_offsets;
+    err = cave_polytri_triangulate_3d_batch(&batch_tris, &tri_offsets, &rings, face_rings, face_count, NULL);
+    if(err == CAVE_NO_ERROR) {
+        for(size_t i = 0; i < face_count && err == CAVE_NO_ERROR; i++) {
+            cave_3d_Polygon single = {face_points, ring_offsets + face_rings[i], face_rings[i + 1] - face_rings[i]};
+            err = cave_polytri_triangulate_3d(&tris, &tri_count, &single);
+            if(err == CAVE_NO_ERROR && (tri_offsets[i + 1] - tri_offsets[i] != tri_count || tri_count == 0 ||
+                                        memcmp(batch_tris + tri_offsets[i], tris,
+                                               sizeof(cave_Index_Triangle) * tri_count) != 0)) {
+                printf("face %zu differs from the batch\n", i);
+                err = CAVE_DATA_ERROR;
+            }
+            free(tris);
+        }
+        free(batch_tris);
+        free(tri_offsets);
+    }
+    free(face_points);
+    free(ring_offsets);
+    free(face_rings);
+    return err;
+}
+
+//true if every point dropped from the ring is within `tolerance` of the edge that replaced it
+static bool simplified_within(cave_2Point const* points, size_t count, size_t const* kept, size_t kept_count,
+                              double tolerance) {
+    for(size_t k = 0; k < kept_count; k++) {
+        cave_2Point a = points[kept[k]], b = points[kept[(k + 1) % kept_count]];
+        size_t end = k + 1 < kept_count ? kept[k + 1] : kept[0] + count;
+        for(size_t i = kept[k] + 1; i < end; i++) {
+            cave_2Point p = points[i % count];
+            double abx = (double) b.x - a.x, aby = (double) b.y - a.y;
+            double apx = (double) p.x - a.x, apy = (double) p.y - a.y;
+            double len2 = abx * abx + aby * aby;
+            double t = len2 > 0 ? (apx * abx + apy * aby) / len2 : 0.0;
+            t = t < 0 ? 0 : (t > 1 ? 1 : t);
+            if(hypot(apx - t * abx, apy - t * aby) > tolerance * (1 + 1e-9)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool point_in_ring(cave_2Point const* ring, size_t count, cave_2Point q) {
+    bool inside = false;
+    for(size_t i = 0, j = count - 1; i < count; j = i++) {
+        if((ring[i].y > q.y) != (ring[j].y > q.y) &&
+           q.x < (ring[j].x - ring[i].x) * (q.y - ring[i].y) / (ring[j].y - ring[i].y) + ring[i].x) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+CaveError simplify_contours() {
+    //a traced contour with far more points than its wiggles need
+    size_t count = 20000;
+    cave_2Point* outline = make_outline(count);
+    if(!outline) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    double area = polygon_area(outline, count);
+    cave_Simplify_Options options[2] = {{CAVE_SIMPLIFY_DOUGLAS_PEUCKER, 0.05, true, false},
+                                        {CAVE_SIMPLIFY_VISVALINGAM, 0.05, true, false}};
+    char const* names[2] = {"Douglas-Peucker", "Visvalingam-Whyatt"};
+    CaveError err = CAVE_NO_ERROR;
+    for(int method = 0; method < 2 && err == CAVE_NO_ERROR; method++) {
+        size_t* kept;
+        size_t kept_count;
+        err = cave_simplify_2d(&kept, &kept_count, outline, count, options + method);
+        if(err != CAVE_NO_ERROR) {
+            break;
+        }
+        cave_2Point* simplified = malloc(sizeof(cave_2Point) * kept_count);
+        if(!simplified) {
+            free(kept);
+            err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+            break;
+        }
+        for(size_t i = 0; i < kept_count; i++) {
+            simplified[i] = outline[kept[i]];
+        }
+        if(kept_count * 10 > count || fabs(polygon_area(simplified, kept_count) - area) > 0.01 * area ||
+           (method == 0 && !simplified_within(outline, count, kept, kept_count, options[method].tolerance))) {
+            printf("%s simplified the contour too much or too little\n", names[method]);
+            err = CAVE_DATA_ERROR;
+        }
+        free(simplified);
+        free(kept);
+    }
+    free(outline);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    //a plate with a gently arched top and a hole tucked under the arch, which a loose tolerance flattens
+    //right through unless topology is preserved
+    size_t arch = 201;
+    cave_2Point points[201 + 2 + 4];
+    for(size_t i = 0; i < arch; i++) {
+        double x = 100.0 - (double) i / (double) (arch - 1) * 100.0;
+        points[i] = (cave_2Point) {(float) x, (float) (10.0 + 2.0 * sin(M_PI * x / 100.0))};
+    }
+    points[arch] = (cave_2Point) {0.0f, 0.0f};
+    points[arch + 1] = (cave_2Point) {100.0f, 0.0f};
+    cave_2Point hole[4] = {{49.0f, 10.5f}, {49.0f, 11.5f}, {51.0f, 11.5f}, {51.0f, 10.5f}};
+    for(size_t i = 0; i < 4; i++) {
+        points[arch + 2 + i] = hole[i];
+    }
+    size_t offsets[3] = {0, arch + 2, arch + 6};
+    cave_2d_Polygon plate = {points, offsets, 2};
+    for(int preserve = 0; preserve < 2; preserve++) {
+        cave_Simplify_Options loose = {CAVE_SIMPLIFY_DOUGLAS_PEUCKER, 3.0, false, preserve == 1};
+        cave_2d_Polygon simplified;
+        err = cave_simplify_polygon(&simplified, &plate, &loose);
+        if(err != CAVE_NO_ERROR) {
+            return err;
+        }
+        size_t outline_count = simplified.ring_offsets[1];
+        bool hole_inside = true;
+        for(size_t i = 0; i < 4; i++) {
+            hole_inside = hole_inside && point_in_ring(simplified.points, outline_count, hole[i]);
+        }
+        if(preserve == 1 && hole_inside) {
+            cave_Index_Triangle* tris;
+            size_t tri_count;
+            err = cave_polytri_triangulate_polygon(&tris, &tri_count, &simplified);
+            if(err == CAVE_NO_ERROR) {
+                //the hole may have lost a corner too
+                double expected = polygon_area(simplified.points, outline_count) +
+                                  polygon_area(simplified.points + outline_count,
+                                               simplified.ring_offsets[2] - outline_count);
+                if(!polygon_triangulation_covers(tris, tri_count, &simplified, expected)) {
+                    err = CAVE_DATA_ERROR;
+                }
+                free(tris);
+            }
+            printf("simplified an arched plate from %zu points to %zu, keeping its hole inside\n", offsets[2],
+                   simplified.ring_offsets[2]);
+        }
+        free(simplified.points);
+        free(simplified.ring_offsets);
+        //without preserving topology, the flattened arch is expected to leave the hole outside
+        if(err != CAVE_NO_ERROR || hole_inside != (preserve == 1)) {
+            printf("simplifying the plate %s its topology went wrong\n", preserve ? "preserving" : "ignoring");
+            return err != CAVE_NO_ERROR ? err : CAVE_DATA_ERROR;
+        }
+    }
+
+    //a helix in 3D, where only its turns need keeping
+    cave_3Point helix[2000];
+    for(size_t i = 0; i < 2000; i++) {
+        double angle = (double) i / 100.0;
+        helix[i] = (cave_3Point) {(float) (10 * cos(angle)), (float) (10 * sin(angle)), (float) angle};
+    }
+    cave_Simplify_Options helix_options = {CAVE_SIMPLIFY_DOUGLAS_PEUCKER, 0.1, false, false};
+    size_t* kept;
+    size_t kept_count;
+    err = cave_simplify_3d(&kept, &kept_count, helix, 2000, &helix_options);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    bool correct = kept_count < 400 && kept[0] == 0 && kept[kept_count - 1] == 1999;
+    free(kept);
+    if(!correct) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_Simplify_Options negative = {CAVE_SIMPLIFY_VISVALINGAM, -1.0, false, false};
+    if(cave_simplify_3d(&kept, &kept_count, helix, 2000, &negative) != CAVE_DATA_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+    return CAVE_NO_ERROR;
+}
+
+//gathers what a sink hands on, in `tris`, which has room for `cap`, failing with `fail_with` once it has
+//`fail_after` batches
+typedef struct collected_triangles {
+    cave_Index_Triangle* tris;
+    size_t cap;
+    size_t count;
+    size_t batches;
+    size_t fail_after;
+    CaveError fail_with;
+} collected_triangles;
+
+static CaveError collect_triangles(void* user, cave_Index_Triangle const* tris, size_t tri_count) {
+    collected_triangles* collected = user;
+    if(tri_count == 0 || tri_count > CAVE_POLYTRI_SINK_BATCH || collected->count + tri_count > collected->cap) {
+        return CAVE_INDEX_ERROR;
+    }
+    memcpy(collected->tris + collected->count, tris, sizeof(cave_Index_Triangle) * tri_count);
+    collected->count += tri_count;
+    return ++collected->batches == collected->fail_after ? collected->fail_with : CAVE_NO_ERROR;
+}
+
+//a perforated plate, triangulated every frame into a sink, with working memory from an arena
+CaveError triangulate_to_sink() {
+    size_t side = 10;
+    cave_2Point points[4 * 101];
+    size_t offsets[102] = {0};
+    size_t ring_count = 0;
+    add_square(points, offsets, &ring_count, 0.0f, 0.0f, (float) (2 * side + 1), false);
+    for(size_t i = 0; i < side; i++) {
+        for(size_t j = 0; j < side; j++) {
+            add_square(points, offsets, &ring_count, (float) (2 * i + 1), (float) (2 * j + 1), 0.5f, true);
+        }
+    }
+    cave_2d_Polygon polygon = {points, offsets, ring_count};
+    cave_Index_Triangle* expected;
+    size_t expected_count;
+    CaveError err = cave_polytri_triangulate_polygon(&expected, &expected_count, &polygon);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    cave_Index_Triangle buffer[4 * 101 + 2 * 101];
+    size_t bytes = 0;
+    char* memory = NULL;
+    cave_PolyTri_Arena arena = {NULL, 0, 0, 0};
+    cave_PolyTri_Sink sink = {NULL, NULL, buffer, sizeof(buffer) / sizeof(buffer[0]), 0};
+
+    //an arena that is too small says how far it got, and is grown until it's big enough
+    int tries = 0;
+    while((err = cave_polytri_triangulate_to_sink(&sink, &polygon, &arena)) == CAVE_INSUFFICIENT_MEMORY_ERROR &&
+          arena.peak > arena.capacity && tries++ < 64) {
+        bytes = arena.peak;
+        char* grown = realloc(memory, bytes);
+        if(!grown) {
+            err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+            break;
+        }
+        memory = grown;
+        arena.memory = memory;
+        arena.capacity = bytes;
+    }
+    bool correct = err == CAVE_NO_ERROR && arena.used == 0 && sink.tri_count == expected_count &&
+                   memcmp(buffer, expected, sizeof(cave_Index_Triangle) * expected_count) == 0;
+    if(!correct) {
+        printf("triangulating into a buffer, from an arena, didn't match triangulating into an array\n");
+        err = CAVE_DATA_ERROR;
+    }
+
+    //once big enough, the same arena serves every frame after
+    for(int frame = 0; frame < 3 && err == CAVE_NO_ERROR; frame++) {
+        err = cave_polytri_triangulate_to_sink(&sink, &polygon, &arena);
+        if(err == CAVE_NO_ERROR && (arena.used != 0 || sink.tri_count != expected_count)) {
+            printf("a reused arena didn't serve another frame\n");
+            err = CAVE_DATA_ERROR;
+        }
+    }
+
+    //batches go to a callback, which can stop them
+    cave_Index_Triangle gathered[4 * 101 + 2 * 101];
+    collected_triangles collected = {gathered, sizeof(gathered) / sizeof(gathered[0]), 0, 0, 0, CAVE_NO_ERROR};
+    cave_PolyTri_Sink callback = {collect_triangles, &collected, NULL, 0, 0};
+    if(err == CAVE_NO_ERROR) {
+        err = cave_polytri_triangulate_to_sink(&callback, &polygon, &arena);
+        if(err == CAVE_NO_ERROR && (collected.count != expected_count || callback.tri_count != expected_count ||
+                                    collected.batches != (expected_count + CAVE_POLYTRI_SINK_BATCH - 1) /
+                                                         CAVE_POLYTRI_SINK_BATCH ||
+                                    memcmp(gathered, expected, sizeof(cave_Index_Triangle) * expected_count) != 0)) {
+            printf("triangulating into a callback didn't match triangulating into an array\n");
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    if(err == CAVE_NO_ERROR) {
+        collected.count = 0;
+        collected.batches = 0;
+        collected.fail_after = 1;
+        collected.fail_with = CAVE_FILE_ERROR;
+        if(cave_polytri_triangulate_to_sink(&callback, &polygon, NULL) != CAVE_FILE_ERROR || collected.batches != 1) {
+            printf("a callback's error didn't stop triangulation\n");
+            err = CAVE_DATA_ERROR;
+        }
+    }
+
+    //a buffer that overflows keeps the first triangles and counts the rest
+    cave_PolyTri_Sink small = {NULL, NULL, buffer, 5, 0};
+    if(err == CAVE_NO_ERROR &&
+       (cave_polytri_triangulate_to_sink(&small, &polygon, &arena) != CAVE_INSUFFICIENT_MEMORY_ERROR ||
+        small.tri_count != expected_count || memcmp(buffer, expected, sizeof(cave_Index_Triangle) * 5) != 0)) {
+        printf("an overflowing buffer wasn't reported\n");
+        err = CAVE_DATA_ERROR;
+    }
+    cave_PolyTri_Sink nowhere = {NULL, NULL, NULL, 5, 0};
+    if(err == CAVE_NO_ERROR && cave_polytri_triangulate_to_sink(&nowhere, &polygon, NULL) != CAVE_DATA_ERROR) {
+        err = CAVE_DATA_ERROR;
+    }
+    free(expected);
+
+    //a face in 3D goes through the same way, its indexes into the 3D points
+    cave_3Point lifted[4 * 101];
+    cave_3Point u = {1.0f / 3, 2.0f / 3, 2.0f / 3}, v = {2.0f / 3, 1.0f / 3, -2.0f / 3};
+    embed_points(lifted, points, offsets[ring_count], (cave_3Point) {-50.0f, 20.0f, 7.0f}, u, v);
+    size_t face_offsets[3] = {offsets[1], offsets[2], offsets[3]};
+    cave_3d_Polygon face = {lifted, face_offsets, 2};
+    if(err == CAVE_NO_ERROR) {
+        err = cave_polytri_triangulate_3d(&expected, &expected_count, &face);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_polytri_triangulate_3d_to_sink(&sink, &face, &arena);
+        if(err == CAVE_NO_ERROR && (sink.tri_count != expected_count || arena.used != 0 ||
+                                    memcmp(buffer, expected, sizeof(cave_Index_Triangle) * expected_count) != 0)) {
+            printf("triangulating a 3D face into a sink didn't match triangulating it into an array\n");
+            err = CAVE_DATA_ERROR;
+        }
+        free(expected);
+    }
+    free(memory);
+    return err;
+}
+
+//the area a polygon covers, outlines counting for and holes against
+static double rings_area(cave_2d_Polygon const* polygon) {
+    double sum = 0.0;
+    for(size_t r = 0; r < polygon->ring_count; r++) {
+        size_t start = polygon->ring_offsets[r];
+        sum += polygon_area(polygon->points + start, polygon->ring_offsets[r + 1] - start);
+    }
+    return sum;
+}
+
+//combines two polygons, checking the result covers `expected` both by its rings and by triangulating them
+static CaveError check_boolean(cave_2d_Polygon const* subject, cave_2d_Polygon const* clip,
+                               cave_Boolean_Operation operation, double expected, double tolerance,
+                               cave_2d_Polygon* result) {
+    cave_2d_Polygon combined;
+    CaveError err = cave_polygon_boolean(&combined, subject, clip, operation);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    double area = rings_area(&combined);
+    bool correct = fabs(area - expected) <= tolerance;
+    if(correct && combined.ring_count > 0) {
+        cave_Index_Triangle* tris;
+        size_t tri_count;
+        err = cave_polytri_triangulate_polygon(&tris, &tri_count, &combined);
+        correct = err == CAVE_NO_ERROR && polygon_triangulation_covers(tris, tri_count, &combined, area);
+        if(err == CAVE_NO_ERROR) {
+            free(tris);
+        }
+    }
+    if(!correct) {
+        printf("operation %d covered %f rather than %f\n", (int) operation, area, expected);
+        err = err != CAVE_NO_ERROR ? err : CAVE_DATA_ERROR;
+    }
+    if(result && err == CAVE_NO_ERROR) {
+        *result = combined;
+    } else {
+        free(combined.points);
+        free(combined.ring_offsets);
+    }
+    return err;
+}
+
+//a star with `count` points at random distances from (cx, cy), wound counter-clockwise
+static void random_star(cave_2Point* points, size_t count, float cx, float cy, unsigned* seed) {
+    for(size_t i = 0; i < count; i++) {
+        *seed = *seed * 1103515245u + 12345u;
+        double radius = 1.0 + (double) (*seed >> 8 & 0xffff) / 65536.0 * 4.0;
+        double angle = 2 * M_PI * (double) i / (double) count;
+        points[i].x = cx + (float) (radius * cos(angle));
+        points[i].y = cy + (float) (radius * sin(angle));
+    }
+}
+
+CaveError polygon_booleans() {
+    //two overlapping squares
+    cave_2Point squares[12];
+    size_t square_offsets[4] = {0};
+    size_t ring_count = 0;
+    add_square(squares, square_offsets, &ring_count, 0.0f, 0.0f, 2.0f, false);
+    add_square(squares, square_offsets, &ring_count, 1.0f, 1.0f, 2.0f, false);
+    size_t second[2] = {4, 8};
+    cave_2d_Polygon a = {squares, square_offsets, 1}, b = {squares, second, 1};
+    cave_Boolean_Operation operations[4] = {CAVE_BOOLEAN_UNION, CAVE_BOOLEAN_INTERSECTION, CAVE_BOOLEAN_DIFFERENCE,
+                                            CAVE_BOOLEAN_XOR};
+    double expected[4] = {7.0, 1.0, 3.0, 6.0};
+    CaveError err = CAVE_NO_ERROR;
+    for(int op = 0; op < 4 && err == CAVE_NO_ERROR; op++) {
+        err = check_boolean(&a, &b, operations[op], expected[op], 1e-9, NULL);
+    }
+    //the same squares as one polygon merge where they overlap
+    cave_2d_Polygon both = {squares, square_offsets, 2}, none = {NULL, NULL, 0};
+    if(err == CAVE_NO_ERROR) {
+        err = check_boolean(&both, &none, CAVE_BOOLEAN_UNION, 7.0, 1e-9, NULL);
+    }
+
+    //squares side by side share an edge, which goes, along with the corners either end of it
+    cave_2d_Polygon merged = {NULL, NULL, 0};
+    add_square(squares, square_offsets, &ring_count, 2.0f, 0.0f, 2.0f, false);
+    size_t beside[2] = {8, 12};
+    cave_2d_Polygon c = {squares, beside, 1};
+    if(err == CAVE_NO_ERROR) {
+        err = check_boolean(&a, &c, CAVE_BOOLEAN_UNION, 8.0, 1e-9, &merged);
+        if(err == CAVE_NO_ERROR && (merged.ring_count != 1 || merged.ring_offsets[1] != 4)) {
+            printf("squares sharing an edge didn't merge into one rectangle\n");
+            err = CAVE_DATA_ERROR;
+        }
+        free(merged.points);
+        free(merged.ring_offsets);
+    }
+    //a polygon with itself
+    double self[4] = {4.0, 4.0, 0.0, 0.0};
+    for(int op = 0; op < 4 && err == CAVE_NO_ERROR; op++) {
+        err = check_boolean(&a, &a, operations[op], self[op], 1e-9, NULL);
+    }
+
+    //a bar cut out of a plate, across its hole, leaves two pieces, each with a notch
+    cave_2Point plate[8];
+    size_t plate_offsets[3] = {0};
+    size_t plate_rings = 0;
+    add_square(plate, plate_offsets, &plate_rings, 0.0f, 0.0f, 6.0f, false);
+    add_square(plate, plate_offsets, &plate_rings, 2.0f, 2.0f, 2.0f, true);
+    cave_2Point bar[4] = {{-1.0f, 2.5f}, {7.0f, 2.5f}, {7.0f, 3.5f}, {-1.0f, 3.5f}};
+    size_t bar_offsets[2] = {0, 4};
+    cave_2d_Polygon holed = {plate, plate_offsets, plate_rings}, cut = {bar, bar_offsets, 1};
+    if(err == CAVE_NO_ERROR) {
+        err = check_boolean(&holed, &cut, CAVE_BOOLEAN_DIFFERENCE, 36.0 - 4.0 - 4.0, 1e-9, &merged);
+        if(err == CAVE_NO_ERROR && merged.ring_count != 2) {
+            printf("cutting a plate in two made %zu rings\n", merged.ring_count);
+            err = CAVE_DATA_ERROR;
+        }
+        free(merged.points);
+        free(merged.ring_offsets);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = check_boolean(&holed, &cut, CAVE_BOOLEAN_UNION, 32.0 + 8.0 - 4.0, 1e-9, NULL);
+    }
+
+    //random stars, whose edges cross all over, have to add up: A + B = (A or B) + (A and B), and so on
+    unsigned seed = 7;
+    cave_2Point stars[80];
+    size_t star_offsets[2] = {0, 40}, star_offsets_b[2] = {40, 80};
+    cave_2d_Polygon sa = {stars, star_offsets, 1}, sb = {stars, star_offsets_b, 1};
+    for(int trial = 0; trial < 200 && err == CAVE_NO_ERROR; trial++) {
+        random_star(stars, 40, 0.0f, 0.0f, &seed);
+        random_star(stars + 40, 40, (float) (trial % 5), (float) (trial % 3), &seed);
+        double area_a = polygon_area(stars, 40), area_b = polygon_area(stars + 40, 40);
+        cave_2d_Polygon both_ways;
+        err = cave_polygon_boolean(&both_ways, &sa, &sb, CAVE_BOOLEAN_INTERSECTION);
+        if(err != CAVE_NO_ERROR) {
+            break;
+        }
+        double shared = rings_area(&both_ways);
+        free(both_ways.points);
+        free(both_ways.ring_offsets);
+        double sums[4] = {area_a + area_b - shared, shared, area_a - shared, area_a + area_b - 2 * shared};
+        for(int op = 0; op < 4 && err == CAVE_NO_ERROR; op++) {
+            err = check_boolean(&sa, &sb, operations[op], sums[op], 1e-4 * (area_a + area_b), NULL);
+        }
+    }
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    //two big wiggly contours a little apart, crossing each other many times
+    size_t count = 20000;
+    cave_2Point* outlines = malloc(sizeof(cave_2Point) * 2 * count);
+    cave_2Point* outline = make_outline(count);
+    if(!outlines || !outline) {
+        free(outlines);
+        free(outline);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < count; i++) {
+        outlines[i] = outline[i];
+        double angle = 0.01;
+        outlines[count + i].x = (float) (outline[i].x * cos(angle) - outline[i].y * sin(angle)) + 0.5f;
+        outlines[count + i].y = (float) (outline[i].x * sin(angle) + outline[i].y * cos(angle));
+    }
+    free(outline);
+    size_t big_a[2] = {0, count}, big_b[2] = {count, 2 * count};
+    cave_2d_Polygon pa = {outlines, big_a, 1}, pb = {outlines, big_b, 1};
+    double area_a = polygon_area(outlines, count), area_b = polygon_area(outlines + count, count);
+    double shared = 0.0;
+    char const* names[4] = {"union", "intersection", "difference", "xor"};
+    for(int op = 0; op < 4 && err == CAVE_NO_ERROR; op++) {
+        cave_2d_Polygon result;
+        err = cave_polygon_boolean(&result, &pa, &pb, operations[op]);
+        if(err != CAVE_NO_ERROR) {
+            break;
+        }
+        double area = rings_area(&result);
+        free(result.points);
+        free(result.ring_offsets);
+        shared = op == 1 ? area : shared;
+        double want = op == 0 ? area_a + area_b - shared : op == 1 ? area : op == 2 ? area_a - shared
+                                                                              : area_a + area_b - 2 * shared;
+        //the union comes first, before the intersection it's checked against, so it is checked last
+        if(op > 0 && fabs(area - want) > 1e-4 * area_a) {
+            printf("the %s covered %f rather than %f\n", names[op], area, want);
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = check_boolean(&pa, &pb, CAVE_BOOLEAN_UNION, area_a + area_b - shared, 1e-4 * area_a, NULL);
+    }
+    free(outlines);
+
+    if(err == CAVE_NO_ERROR && cave_polygon_boolean(&merged, &a, NULL, CAVE_BOOLEAN_UNION) != CAVE_DATA_ERROR) {
+        err = CAVE_DATA_ERROR;
+    }
+    return err;
+}
+
+//how many times the rings of `polygon` wind counter-clockwise around `q`, less the times they wind clockwise
+static int winding_number(cave_2d_Polygon const* polygon, double qx, double qy) {
+    int winding = 0;
+    for(size_t r = 0; r < polygon->ring_count; r++) {
+        size_t start = polygon->ring_offsets[r], end = polygon->ring_offsets[r + 1];
+        for(size_t i = start; i < end; i++) {
+            cave_2Point p = polygon->points[i], n = polygon->points[i + 1 < end ? i + 1 : start];
+            double side = ((double) n.x - p.x) * (qy - p.y) - (qx - p.x) * ((double) n.y - p.y);
+            if(p.y <= qy && n.y > qy && side > 0) {
+                winding++;
+            } else if(p.y > qy && n.y <= qy && side < 0) {
+                winding--;
+            }
+        }
+    }
+    return winding;
+}
+
+//how far `q` is from the nearest edge of `polygon`
+static double edge_distance(cave_2d_Polygon const* polygon, double qx, double qy) {
+    double nearest = INFINITY;
+    for(size_t r = 0; r < polygon->ring_count; r++) {
+        size_t start = polygon->ring_offsets[r], end = polygon->ring_offsets[r + 1];
+        for(size_t i = start; i < end; i++) {
+            cave_2Point p = polygon->points[i], n = polygon->points[i + 1 < end ? i + 1 : start];
+            double dx = (double) n.x - p.x, dy = (double) n.y - p.y, length = dx * dx + dy * dy;
+            double t = length > 0 ? ((qx - p.x) * dx + (qy - p.y) * dy) / length : 0.0;
+            t = t < 0 ? 0 : t > 1 ? 1 : t;
+            nearest = fmin(nearest, hypot(p.x + t * dx - qx, p.y + t * dy - qy));
+        }
+    }
+    return nearest;
+}
+
+CaveError polygon_booleans_touching() {
+    cave_Boolean_Operation operations[4] = {CAVE_BOOLEAN_UNION, CAVE_BOOLEAN_INTERSECTION, CAVE_BOOLEAN_DIFFERENCE,
+                                            CAVE_BOOLEAN_XOR};
+    //a square in a diamond, its corners on the middles of the diamond's edges
+    cave_2Point inscribed[8] = {{0, 0}, {2, 0}, {2, 2}, {0, 2}, {1, -1}, {3, 1}, {1, 3}, {-1, 1}};
+    //a square beside another, sharing half of an edge
+    cave_2Point offset[8] = {{0, 0}, {2, 0}, {2, 2}, {0, 2}, {2, 1}, {4, 1}, {4, 3}, {2, 3}};
+    //a square in the corner of another, sharing two half edges
+    cave_2Point cornered[8] = {{0, 0}, {2, 0}, {2, 2}, {0, 2}, {0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    //bars on top of each other, each with a corner part way along the other's edge
+    cave_2Point stacked[8] = {{0, 0}, {2, 0}, {2, 1}, {0, 1}, {1, 1}, {3, 1}, {3, 2}, {1, 2}};
+    cave_2Point* pairs[4] = {inscribed, offset, cornered, stacked};
+    double expected[4][4] = {{8.0, 4.0, 0.0, 4.0}, {8.0, 0.0, 4.0, 8.0}, {4.0, 1.0, 3.0, 3.0}, {4.0, 0.0, 2.0, 4.0}};
+    size_t first[2] = {0, 4}, second[2] = {4, 8};
+    CaveError err = CAVE_NO_ERROR;
+    for(int pair = 0; pair < 4 && err == CAVE_NO_ERROR; pair++) {
+        cave_2d_Polygon a = {pairs[pair], first, 1}, b = {pairs[pair], second, 1};
+        for(int op = 0; op < 4 && err == CAVE_NO_ERROR; op++) {
+            err = check_boolean(&a, &b, operations[op], expected[pair][op], 1e-9, NULL);
+            if(err == CAVE_NO_ERROR && op != 2) {
+                err = check_boolean(&b, &a, operations[op], expected[pair][op], 1e-9, NULL);
+            }
+        }
+    }
+
+    //a T-junction within one polygon: a post standing on a bar merges with it into one ring
+    cave_2Point tee[8] = {{0, 0}, {4, 0}, {4, 1}, {0, 1}, {1, 1}, {2, 1}, {2, 3}, {1, 3}};
+    size_t tee_offsets[3] = {0, 4, 8};
+    cave_2d_Polygon t = {tee, tee_offsets, 2}, none = {NULL, NULL, 0}, merged;
+    if(err == CAVE_NO_ERROR) {
+        err = check_boolean(&t, &none, CAVE_BOOLEAN_UNION, 6.0, 1e-9, &merged);
+        if(err == CAVE_NO_ERROR && merged.ring_count != 1) {
+            printf("a post on a bar made %zu rings\n", merged.ring_count);
+            err = CAVE_DATA_ERROR;
+        }
+        if(err == CAVE_NO_ERROR) {
+            free(merged.points);
+            free(merged.ring_offsets);
+        }
+    }
+
+    //random polygons snapped to a coarse grid, their corners landing on each other's edges all the time, whose
+    //results have to wind around every point just as the operation says
+    unsigned seed = 11;
+    cave_2Point grid[16];
+    size_t grid_a[2] = {0, 8}, grid_b[2] = {8, 16};
+    cave_2d_Polygon ga = {grid, grid_a, 1}, gb = {grid, grid_b, 1};
+    for(int trial = 0; trial < 300 && err == CAVE_NO_ERROR; trial++) {
+        for(int i = 0; i < 16; i++) {
+            seed = seed * 1103515245u + 12345u;
+            grid[i].x = (float) ((seed >> 8) % 7);
+            seed = seed * 1103515245u + 12345u;
+            grid[i].y = (float) ((seed >> 8) % 7);
+        }
+        for(int op = 0; op < 4 && err == CAVE_NO_ERROR; op++) {
+            cave_2d_Polygon result;
+            err = cave_polygon_boolean(&result, &ga, &gb, operations[op]);
+            if(err != CAVE_NO_ERROR) {
+                break;
+            }
+            for(int i = 0; i < 28 * 28 && err == CAVE_NO_ERROR; i++) {
+                double qx = (i % 28) * 0.25 - 0.5 + 0.0731, qy = (i / 28) * 0.25 - 0.5 + 0.1373;
+                if(edge_distance(&ga, qx, qy) < 1e-4 || edge_distance(&gb, qx, qy) < 1e-4) {
+                    continue;
+                }
+                bool in_a = winding_number(&ga, qx, qy) > 0, in_b = winding_number(&gb, qx, qy) > 0;
+                bool want = op == 0 ? in_a || in_b : op == 1 ? in_a && in_b : op == 2 ? in_a && !in_b : in_a != in_b;
+                int winding = winding_number(&result, qx, qy);
+                if(winding != (want ? 1 : 0)) {
+                    printf("trial %d, operation %d wound %d times around (%f, %f)\n", trial, op, winding, qx, qy);
+                    err = CAVE_DATA_ERROR;
+                }
+            }
+            free(result.points);
+            free(result.ring_offsets);
+        }
+    }
+    return err;
+}
 
 int main(int argc, char* argv[]) {
-    return 0;
-}
\ No newline at end of file
+    int test_fails = 0;
+    RUN_TEST(triangulate_simple_shapes, test_fails);
+    RUN_TEST(triangulate_degenerate_input, test_fails);
+    RUN_TEST(triangulate_random_polygons, test_fails);
+    RUN_TEST(triangulate_large_polygon, test_fails);
+    RUN_TEST(triangulate_monotone_comb, test_fails);
+    RUN_TEST(triangulate_polygon_holes, test_fails);
+    RUN_TEST(triangulate_polygon_outlines, test_fails);
+    RUN_TEST(triangulate_polygon_batch, test_fails);
+    RUN_TEST(triangulate_cdt, test_fails);
+    RUN_TEST(robust_predicates, test_fails);
+    RUN_TEST(triangulate_3d_faces, test_fails);
+    RUN_TEST(simplify_contours, test_fails);
+    RUN_TEST(triangulate_to_sink, test_fails);
+    RUN_TEST(polygon_booleans, test_fails);
+    RUN_TEST(polygon_booleans_touching, test_fails);
+    return test_fails;
+}
@@ -4,10 +4,26 @@
 #include "test-utilities.h"
 #include "cave-writer.h"
 #include "cave-utilities.h"
+#include "cave-mesh.h"
+#include "cave-cmsh.h"
+#include "cave-lz.h"
+#include "cave-cache.h"
+#include "cave-vecmath.h"
+#include "cave-cpu.h"
+#include "cave-measure.h"
+#include "cave-bvh.h"
+#include "cave-grid.h"
+#include "cave-slice.h"
+#include "cave-voxel.h"
+#include "cave-decimate.h"
+#include "cave-reorder.h"
 #include <stdio.h>
 #include <inttypes.h>
 #include <stdlib.h>
 #include <strings.h>
+#include <string.h>
+#include <math.h>
+#include <stdbool.h>
 
 int read_and_write_STL() {
     printf("testing reading and writing STL files\n");
@@ -87,6 +103,2274 @@ int read_and_write_STL() {
     return 0;
 }
 
+//reads and parses the teapot asset. On success, `dest` must be released by the caller.
+CaveError load_teapot(cave_STL_Data* dest) {
+    FILE* fp = fopen("assets/utah_teapot.stl", "rb");
+    if(!fp) {
+        return CAVE_FILE_ERROR;
+    }
+    long file_len = cave_file_len(fp);
+    uint8_t* file_contents = malloc(file_len);
+    if(!file_contents) {
+        fclose(fp);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(file_len != fread(file_contents, 1, file_len, fp)) {
+        free(file_contents);
+        fclose(fp);
+        return CAVE_FILE_ERROR;
+    }
+    fclose(fp);
+    CaveError err = cave_bytes_to_STL_Data(dest, file_contents, file_len);
+    free(file_contents);
+    return err;
+}
+
+CaveError lz_round_trip() {
+    size_t len = 200000;
+    uint8_t* src = malloc(len);
+    uint8_t* compressed = malloc(cave_lz_compress_bound(len));
+    uint8_t* decompressed = malloc(len);
+    if(!src || !compressed || !decompressed) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    //a mix of runs, repeated phrases and noise
+    uint32_t state = 12345;
+    for(size_t i = 0; i < len; i++) {
+        state = state * 1103515245u + 12345u;
+        if((i / 1000) % 3 == 0) {
+            src[i] = 7;
+        } else if((i / 1000) % 3 == 1) {
+            src[i] = (uint8_t) (i % 17);
+        } else {
+            src[i] = (uint8_t) (state >> 16);
+        }
+    }
+
+    size_t compressed_len = 0;
+    CaveError err = cave_lz_compress(compressed, cave_lz_compress_bound(len), &compressed_len, src, len);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    if(compressed_len >= len) {
+        printf("lz did not compress compressible data\n");
+        return CAVE_DATA_ERROR;
+    }
+    err = cave_lz_decompress(decompressed, len, compressed, compressed_len);
+    if(err != CAVE_NO_ERROR || memcmp(src, decompressed, len) != 0) {
+        return CAVE_DATA_ERROR;
+    }
+    //a truncated block must be rejected, not overrun
+    if(cave_lz_decompress(decompressed, len, compressed, compressed_len / 2) != CAVE_DATA_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+    //too small a destination is reported rather than overrun
+    if(cave_lz_compress(compressed, 16, &compressed_len, src, len) != CAVE_INDEX_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+
+    free(src);
+    free(compressed);
+    free(decompressed);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cmsh_round_trip() {
+    cave_STL_Data teapot;
+    CaveError err = load_teapot(&teapot);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    cave_Mesh mesh;
+    err = cave_STL_Data_to_Mesh(&mesh, &teapot);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    if(mesh.tri_count != teapot.tri_count || mesh.vert_count == 0 || mesh.vert_count >= 3 * mesh.tri_count) {
+        printf("welding did not merge shared corners\n");
+        return CAVE_DATA_ERROR;
+    }
+    err = cave_Mesh_compute_vertex_normals(&mesh);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    uint8_t* encoded = NULL;
+    size_t encoded_len = 0;
+    err = cave_Mesh_to_CMSH_Bytes(&encoded, &encoded_len, &mesh, 16, 12);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    size_t stl_len = cave_Sizeof_STL_Data(&teapot);
+    printf("teapot is %zu bytes as STL and %zu bytes as CMSH\n", stl_len, encoded_len);
+    if(encoded_len * 5 > stl_len) {
+        printf("CMSH file is less than 5x smaller than the STL file\n");
+        return CAVE_DATA_ERROR;
+    }
+
+    cave_Mesh decoded;
+    err = cave_CMSH_Bytes_to_Mesh(&decoded, encoded, encoded_len);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    if(decoded.vert_count != mesh.vert_count || decoded.tri_count != mesh.tri_count || !decoded.normals) {
+        return CAVE_DATA_ERROR;
+    }
+    if(memcmp(decoded.tris, mesh.tris, sizeof(cave_Index_Triangle) * mesh.tri_count) != 0) {
+        printf("triangle indexes did not survive the round trip\n");
+        return CAVE_DATA_ERROR;
+    }
+
+    float min[3] = {mesh.positions[0].x, mesh.positions[0].y, mesh.positions[0].z};
+    float max[3] = {min[0], min[1], min[2]};
+    for(size_t i = 0; i < mesh.vert_count; i++) {
+        float p[3] = {mesh.positions[i].x, mesh.positions[i].y, mesh.positions[i].z};
+        for(int k = 0; k < 3; k++) {
+            min[k] = p[k] < min[k] ? p[k] : min[k];
+            max[k] = p[k] > max[k] ? p[k] : max[k];
+        }
+    }
+    for(size_t i = 0; i < mesh.vert_count; i++) {
+        float p[3] = {mesh.positions[i].x, mesh.positions[i].y, mesh.positions[i].z};
+        float q[3] = {decoded.positions[i].x, decoded.positions[i].y, decoded.positions[i].z};
+        for(int k = 0; k < 3; k++) {
+            //half a quantization step, with a little room for float rounding
+            float tolerance = (max[k] - min[k]) / 65535.0f * 0.5f + 1e-5f;
+            if(fabsf(p[k] - q[k]) > tolerance) {
+                printf("position %zu is off by %f\n", i, fabsf(p[k] - q[k]));
+                return CAVE_DATA_ERROR;
+            }
+        }
+        cave_3Point n = mesh.normals[i];
+        cave_3Point m = decoded.normals[i];
+        float n_len = n.x * n.x + n.y * n.y + n.z * n.z;
+        if(n_len > 0.5f && n.x * m.x + n.y * m.y + n.z * m.z < 0.999f) {
+            printf("normal %zu did not survive the round trip\n", i);
+            return CAVE_DATA_ERROR;
+        }
+    }
+
+    //corruption is caught rather than decoded
+    encoded[encoded_len / 2] ^= 0x5A;
+    encoded[encoded_len / 2 + 1] ^= 0xA5;
+    cave_Mesh corrupt;
+    if(cave_CMSH_Bytes_to_Mesh(&corrupt, encoded, encoded_len) == CAVE_NO_ERROR) {
+        cave_Mesh_release(&corrupt);
+    }
+    if(cave_CMSH_Bytes_to_Mesh(&corrupt, encoded, 40) != CAVE_DATA_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+
+    free(encoded);
+    cave_Mesh_release(&decoded);
+    cave_Mesh_release(&mesh);
+    cave_STL_Data_release(&teapot);
+    return CAVE_NO_ERROR;
+}
+
+CaveError cmsh_hostile_streams() {
+    cave_3Point positions[3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+    cave_Index_Triangle tris[1] = {{0, 1, 2}};
+    cave_Mesh mesh = {positions, NULL, 3, tris, 1};
+    uint8_t* encoded = NULL;
+    size_t encoded_len = 0;
+    CaveError err = cave_Mesh_to_CMSH_Bytes(&encoded, &encoded_len, &mesh, 16, 12);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    //the index stream's entry in the stream table, after the 64 byte header and two other entries
+    size_t entry = 64 + 2 * 24;
+    size_t hostile_len = ((encoded_len + 15) & ~(size_t) 15) + 32;
+    uint8_t* hostile = calloc(hostile_len, 1);
+    if(!hostile) {
+        free(encoded);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    cave_Mesh decoded;
+
+    //a length the stored blocks don't add up to is refused before anything is allocated for it
+    memcpy(hostile, encoded, encoded_len);
+    uint64_t stored, raw;
+    memcpy(&stored, hostile + entry + 8, 8);
+    raw = (stored / 8) * CAVE_CMSH_BLOCK_SIZE;
+    uint64_t tri_count = raw / 3;
+    memcpy(hostile + entry + 16, &raw, 8);
+    memcpy(hostile + 32, &tri_count, 8);
+    if(cave_CMSH_Bytes_to_Mesh(&decoded, hostile, encoded_len) != CAVE_DATA_ERROR) {
+        err = CAVE_DATA_ERROR;
+    }
+
+    //an index delta far past the vertex count is refused, down to the largest code a varint holds
+    memcpy(hostile, encoded, encoded_len);
+    uint64_t offset = (encoded_len + 15) & ~(size_t) 15;
+    uint8_t block[20] = {10, 0, 0, 0, 10, 0, 0, 0x80,
+                         0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0, 0};
+    memcpy(hostile + offset, block, sizeof(block));
+    stored = sizeof(block);
+    raw = 10;
+    memcpy(hostile + entry, &offset, 8);
+    memcpy(hostile + entry + 8, &stored, 8);
+    memcpy(hostile + entry + 16, &raw, 8);
+    if(cave_CMSH_Bytes_to_Mesh(&decoded, hostile, hostile_len) != CAVE_DATA_ERROR) {
+        err = CAVE_DATA_ERROR;
+    }
+    free(hostile);
+    free(encoded);
+    return err;
+}
+
+CaveError cmsh_large_grid_round_trip() {
+    //a regular grid delta codes and compresses to less than a byte per vertex, which must still decode
+    size_t side = 1000;
+    cave_Mesh mesh = {0};
+    mesh.vert_count = side * side;
+    mesh.tri_count = 2 * (side - 1) * (side - 1);
+    mesh.positions = malloc(sizeof(cave_3Point) * mesh.vert_count);
+    mesh.tris = malloc(sizeof(cave_Index_Triangle) * mesh.tri_count);
+    if(!mesh.positions || !mesh.tris) {
+        cave_Mesh_release(&mesh);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t y = 0; y < side; y++) {
+        for(size_t x = 0; x < side; x++) {
+            mesh.positions[y * side + x] = (cave_3Point) {(float) x, (float) y, 0.0f};
+        }
+    }
+    size_t t = 0;
+    for(size_t y = 0; y + 1 < side; y++) {
+        for(size_t x = 0; x + 1 < side; x++) {
+            size_t v = y * side + x;
+            mesh.tris[t++] = (cave_Index_Triangle) {v, v + 1, v + side};
+            mesh.tris[t++] = (cave_Index_Triangle) {v + 1, v + side + 1, v + side};
+        }
+    }
+
+    uint8_t* encoded = NULL;
+    size_t encoded_len = 0;
+    CaveError err = cave_Mesh_to_CMSH_Bytes(&encoded, &encoded_len, &mesh, 16, 12);
+    if(err != CAVE_NO_ERROR) {
+        cave_Mesh_release(&mesh);
+        return err;
+    }
+    printf("%zu vertex grid is %zu bytes as CMSH\n", mesh.vert_count, encoded_len);
+
+    cave_Mesh decoded;
+    err = cave_CMSH_Bytes_to_Mesh(&decoded, encoded, encoded_len);
+    free(encoded);
+    if(err != CAVE_NO_ERROR) {
+        cave_Mesh_release(&mesh);
+        return err;
+    }
+    if(decoded.vert_count != mesh.vert_count || decoded.tri_count != mesh.tri_count ||
+       memcmp(decoded.tris, mesh.tris, sizeof(cave_Index_Triangle) * mesh.tri_count) != 0) {
+        printf("grid did not survive the round trip\n");
+        err = CAVE_DATA_ERROR;
+    }
+    for(size_t i = 0; i < mesh.vert_count && err == CAVE_NO_ERROR; i++) {
+        //the grid spans 999 units in 65535 steps, so half a step is under 0.008
+        if(fabsf(decoded.positions[i].x - mesh.positions[i].x) > 0.01f ||
+           fabsf(decoded.positions[i].y - mesh.positions[i].y) > 0.01f || decoded.positions[i].z != 0.0f) {
+            printf("grid position %zu is off\n", i);
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    cave_Mesh_release(&decoded);
+    cave_Mesh_release(&mesh);
+    return err;
+}
+
+CaveError hash64_known_values() {
+    //reference values of XXH64 with seed 0
+    if(cave_hash64(NULL, 0, 0) != 0xEF46DB3751D8E999ull) {
+        return CAVE_DATA_ERROR;
+    }
+    if(cave_hash64("abc", 3, 0) != 0x44BC2CF5AD770999ull) {
+        return CAVE_DATA_ERROR;
+    }
+    uint8_t bytes[100];
+    for(int i = 0; i < 100; i++) {
+        bytes[i] = (uint8_t) i;
+    }
+    if(cave_hash64(bytes, 100, 0) == cave_hash64(bytes, 100, 1) ||
+       cave_hash64(bytes, 100, 0) == cave_hash64(bytes, 99, 0)) {
+        return CAVE_DATA_ERROR;
+    }
+    return CAVE_NO_ERROR;
+}
+
+//reads the raw bytes of the teapot asset.
+CaveError read_teapot_bytes(uint8_t** bytes, size_t* len) {
+    FILE* fp = fopen("assets/utah_teapot.stl", "rb");
+    if(!fp) {
+        return CAVE_FILE_ERROR;
+    }
+    *len = cave_file_len(fp);
+    *bytes = malloc(*len);
+    if(!*bytes) {
+        fclose(fp);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    size_t read = fread(*bytes, 1, *len, fp);
+    fclose(fp);
+    return read == *len ? CAVE_NO_ERROR : CAVE_FILE_ERROR;
+}
+
+CaveError mesh_cache_hits_and_evicts() {
+    uint8_t* bytes;
+    size_t len;
+    CaveError err = read_teapot_bytes(&bytes, &len);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    //the test runs from the build's tests directory, so keep the cache there
+    cave_Mesh_Cache cache;
+    err = cave_Mesh_Cache_open(&cache, ".", 0);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    cave_Mesh cold, warm;
+    err = cave_Mesh_Cache_load_STL(&cache, &cold, bytes, len);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    err = cave_Mesh_Cache_load_STL(&cache, &warm, bytes, len);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    bool correct =
+            cache.misses == 1 &&
+            cache.hits == 1 &&
+            cache.entries.len == 1 &&
+            warm.vert_count == cold.vert_count &&
+            warm.tri_count == cold.tri_count &&
+            warm.normals != NULL &&
+            memcmp(warm.positions, cold.positions, sizeof(cave_3Point) * cold.vert_count) == 0 &&
+            memcmp(warm.normals, cold.normals, sizeof(cave_3Point) * cold.vert_count) == 0 &&
+            memcmp(warm.tris, cold.tris, sizeof(cave_Index_Triangle) * cold.tri_count) == 0;
+    if(!correct) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_Mesh_release(&warm);
+    err = cave_Mesh_Cache_close(&cache);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    //the index survives closing, and the entry can be used in place
+    err = cave_Mesh_Cache_open(&cache, ".", 0);
+    if(err != CAVE_NO_ERROR || cache.entries.len != 1) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_Mesh_Cache_Entry* entry = cave_vec_at_unchecked(&cache.entries, 0);
+    char path[64];
+    snprintf(path, sizeof(path), "./%016llx" CAVE_MESH_CACHE_ENTRY_EXT, (unsigned long long) entry->key);
+    FILE* fp = fopen(path, "rb");
+    if(!fp) {
+        return CAVE_FILE_ERROR;
+    }
+    long entry_len = cave_file_len(fp);
+    uint8_t* entry_bytes = malloc(entry_len);
+    if(!entry_bytes || fread(entry_bytes, 1, entry_len, fp) != (size_t) entry_len) {
+        return CAVE_FILE_ERROR;
+    }
+    fclose(fp);
+    cave_Mesh view;
+    err = cave_Mesh_Cache_entry_view(&view, entry_bytes, entry_len);
+    if(err != CAVE_NO_ERROR || view.tri_count != cold.tri_count ||
+       memcmp(view.tris, cold.tris, sizeof(cave_Index_Triangle) * cold.tri_count) != 0) {
+        return CAVE_DATA_ERROR;
+    }
+    free(entry_bytes);
+
+    //with room for only one entry, a second file pushes the first one out
+    cache.max_bytes = entry->size;
+    bytes[0] ^= 1;
+    cave_Mesh other;
+    err = cave_Mesh_Cache_load_STL(&cache, &other, bytes, len);
+    if(err != CAVE_NO_ERROR || cache.misses != 1 || cache.evictions != 1 || cache.entries.len != 1) {
+        return CAVE_DATA_ERROR;
+    }
+    fp = fopen(path, "rb");
+    if(fp) {
+        fclose(fp);
+        printf("evicted entry was not deleted\n");
+        return CAVE_DATA_ERROR;
+    }
+    cave_Mesh_release(&other);
+
+    //an entry whose counts don't fit the file is a miss, not a huge allocation
+    entry = cave_vec_at_unchecked(&cache.entries, 0);
+    snprintf(path, sizeof(path), "./%016llx" CAVE_MESH_CACHE_ENTRY_EXT, (unsigned long long) entry->key);
+    fp = fopen(path, "r+b");
+    uint64_t huge_count = (uint64_t) 1 << 40;
+    if(!fp || fseek(fp, 40, SEEK_SET) != 0 || fwrite(&huge_count, 8, 1, fp) != 1) {
+        return CAVE_FILE_ERROR;
+    }
+    fclose(fp);
+    err = cave_Mesh_Cache_load_STL(&cache, &other, bytes, len);
+    if(err != CAVE_NO_ERROR || cache.misses != 2 || other.tri_count != cold.tri_count) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_Mesh_release(&other);
+
+    //clean up after ourselves
+    entry = cave_vec_at_unchecked(&cache.entries, 0);
+    snprintf(path, sizeof(path), "./%016llx" CAVE_MESH_CACHE_ENTRY_EXT, (unsigned long long) entry->key);
+    remove(path);
+    cave_Mesh_Cache_close(&cache);
+    remove("./" CAVE_MESH_CACHE_INDEX_NAME);
+
+    cave_Mesh_release(&cold);
+    free(bytes);
+    return CAVE_NO_ERROR;
+}
+
+//compares triangles member by member, as `cave_STL_Tri` has padding that memcmp would see.
+bool stl_tris_equal(cave_STL_Tri const* a, cave_STL_Tri const* b, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        if(memcmp(&a[i].normal, &b[i].normal, sizeof(cave_3Point)) != 0 ||
+           memcmp(&a[i].a, &b[i].a, sizeof(cave_3Point)) != 0 ||
+           memcmp(&a[i].b, &b[i].b, sizeof(cave_3Point)) != 0 ||
+           memcmp(&a[i].c, &b[i].c, sizeof(cave_3Point)) != 0 ||
+           a[i].attribute != b[i].attribute) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CaveError pipelined_STL_load() {
+    cave_STL_Data reference;
+    CaveError err = load_teapot(&reference);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    //small buffers so that the ring wraps around many times, with a partial last chunk
+    cave_STL_Load_Options options = {50 * 97, 3, 3};
+    cave_STL_Data loaded;
+    err = cave_file_to_STL_Data(&loaded, "assets/utah_teapot.stl", &options);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    bool correct =
+            loaded.tri_count == reference.tri_count &&
+            memcmp(loaded.header, reference.header, 80) == 0 &&
+            stl_tris_equal(loaded.tris, reference.tris, reference.tri_count);
+    if(!correct) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_STL_Data_release(&loaded);
+
+    //defaults, with the whole file in a single chunk
+    err = cave_file_to_STL_Data(&loaded, "assets/utah_teapot.stl", NULL);
+    if(err != CAVE_NO_ERROR ||
+       !stl_tris_equal(loaded.tris, reference.tris, reference.tri_count)) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_STL_Data_release(&loaded);
+
+    if(cave_file_to_STL_Data(&loaded, "assets/does_not_exist.stl", NULL) != CAVE_FILE_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+    cave_STL_Data_release(&reference);
+    return CAVE_NO_ERROR;
+}
+
+CaveError append_STL_in_batches() {
+    cave_STL_Data teapot;
+    CaveError err = load_teapot(&teapot);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    //written in uneven batches, with the first half flushed and closed before resuming
+    char const* path = "appended.stl";
+    size_t half = teapot.tri_count / 2;
+    cave_STL_Appender app;
+    err = cave_STL_Appender_open(&app, path, teapot.header, false);
+    for(size_t i = 0; i < half && err == CAVE_NO_ERROR; i += 333) {
+        size_t count = half - i < 333 ? half - i : 333;
+        err = cave_STL_Appender_append(&app, teapot.tris + i, count);
+    }
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    err = cave_STL_Appender_close(&app);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    err = cave_STL_Appender_open(&app, path, NULL, true);
+    if(err != CAVE_NO_ERROR || app.tri_count != half) {
+        return CAVE_DATA_ERROR;
+    }
+    err = cave_STL_Appender_append(&app, teapot.tris + half, teapot.tri_count - half);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    err = cave_STL_Appender_close(&app);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    cave_STL_Data appended;
+    err = cave_file_to_STL_Data(&appended, path, NULL);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    bool correct =
+            appended.tri_count == teapot.tri_count &&
+            memcmp(appended.header, teapot.header, 80) == 0 &&
+            stl_tris_equal(appended.tris, teapot.tris, teapot.tri_count);
+    if(!correct) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //a failed write fails the appender for good, rather than counting triangles that never made it to disk.
+    //Skipped where there is no /dev/full to run out of space on.
+    if(cave_STL_Appender_open(&app, "/dev/full", NULL, false) == CAVE_NO_ERROR) {
+        err = cave_STL_Appender_append(&app, teapot.tris, teapot.tri_count);
+        if(teapot.tri_count < CAVE_STL_APPENDER_BUFFER_TRIS || err != CAVE_FILE_ERROR || app.tri_count != 0 ||
+           cave_STL_Appender_append(&app, teapot.tris, 1) != CAVE_FILE_ERROR ||
+           cave_STL_Appender_flush(&app) != CAVE_FILE_ERROR || cave_STL_Appender_close(&app) != CAVE_FILE_ERROR) {
+            printf("appending to a full disk did not fail for good\n");
+            return CAVE_DATA_ERROR;
+        }
+    }
+
+    remove(path);
+    cave_STL_Data_release(&appended);
+    cave_STL_Data_release(&teapot);
+    return CAVE_NO_ERROR;
+}
+
+CaveError merge_STL_files() {
+    cave_STL_Data teapot;
+    CaveError err = load_teapot(&teapot);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    char const* inputs[3] = {"assets/utah_teapot.stl", "assets/utah_teapot.stl", "assets/utah_teapot.stl"};
+    cave_STL_Transform shift = {{1, 0, 0, 10,
+                                 0, 1, 0, -5,
+                                 0, 0, 1, 2}};
+    cave_STL_Transform const* transforms[3] = {NULL, &shift, NULL};
+    char const* path = "merged.stl";
+    err = cave_STL_merge_files(path, inputs, 3, transforms, teapot.header);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    cave_STL_Data merged;
+    err = cave_file_to_STL_Data(&merged, path, NULL);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    size_t n = teapot.tri_count;
+    bool correct =
+            merged.tri_count == 3 * n &&
+            stl_tris_equal(merged.tris, teapot.tris, n) &&
+            stl_tris_equal(merged.tris + 2 * n, teapot.tris, n);
+    if(!correct) {
+        return CAVE_DATA_ERROR;
+    }
+    for(size_t i = 0; i < n; i++) {
+        cave_STL_Tri const* moved = merged.tris + n + i;
+        cave_STL_Tri const* orig = teapot.tris + i;
+        float len = sqrtf(orig->normal.x * orig->normal.x + orig->normal.y * orig->normal.y +
+                          orig->normal.z * orig->normal.z);
+        if(fabsf(moved->a.x - (orig->a.x + 10)) > 1e-4f ||
+           fabsf(moved->b.y - (orig->b.y - 5)) > 1e-4f ||
+           fabsf(moved->c.z - (orig->c.z + 2)) > 1e-4f ||
+           (len > 0.0f && fabsf(moved->normal.x - orig->normal.x / len) > 1e-5f) ||
+           moved->attribute != orig->attribute) {
+            return CAVE_DATA_ERROR;
+        }
+    }
+    cave_STL_Data_release(&merged);
+
+    //the output can't be one of the inputs, by any name, as it would be emptied before being read
+    char const* own_inputs[2] = {"assets/utah_teapot.stl", "./merged.stl"};
+    if(cave_STL_merge_files(path, own_inputs, 2, NULL, NULL) != CAVE_DATA_ERROR ||
+       cave_file_to_STL_Data(&merged, path, NULL) != CAVE_NO_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+    correct = merged.tri_count == 3 * n;
+    cave_STL_Data_release(&merged);
+    if(!correct) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //a bad input is caught before anything is written
+    char const* bad_inputs[2] = {"assets/utah_teapot.stl", "assets/does_not_exist.stl"};
+    if(cave_STL_merge_files(path, bad_inputs, 2, NULL, NULL) != CAVE_FILE_ERROR) {
+        return CAVE_DATA_ERROR;
+    }
+
+    remove(path);
+    cave_STL_Data_release(&teapot);
+    return CAVE_NO_ERROR;
+}
+
+static bool same_floats(float const* a, float const* b, size_t count) {
+    return memcmp(a, b, count * sizeof(float)) == 0;
+}
+
+//checks every kernel over packed points, separate streams and the corners of STL triangles against plain loops
+static CaveError check_vector_kernels() {
+    //odd, so that every kernel has a tail left over after its blocks
+    size_t const count = 1003;
+    cave_3Point* a = malloc(sizeof(cave_3Point) * count);
+    cave_3Point* b = malloc(sizeof(cave_3Point) * count);
+    cave_3Point* got = malloc(sizeof(cave_3Point) * count);
+    cave_3Point* want = malloc(sizeof(cave_3Point) * count);
+    float* streams = malloc(sizeof(float) * 9 * count);
+    cave_STL_Tri* tris = malloc(sizeof(cave_STL_Tri) * count);
+    float* dots = malloc(sizeof(float) * 2 * count);
+    if(!a || !b || !got || !want || !streams || !tris || !dots) {
+        free(a), free(b), free(got), free(want), free(streams), free(tris), free(dots);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    uint32_t seed = 12345;
+    for(size_t i = 0; i < count; i++) {
+        float v[6];
+        for(int k = 0; k < 6; k++) {
+            seed = seed * 1664525u + 1013904223u;
+            v[k] = (float) (seed >> 8) / (float) (1 << 24) * 200.0f - 100.0f;
+        }
+        a[i] = (cave_3Point) {v[0], v[1], v[2]};
+        b[i] = (cave_3Point) {v[3], v[4], v[5]};
+    }
+    b[5] = (cave_3Point) {0.0f, 0.0f, 0.0f};
+    //zeros of opposite sign, which minimums and maximums have to settle the same way on every path
+    a[6].x = 0.0f;
+    b[6].x = -0.0f;
+
+    //a and b as streams, and a again as the first corners of triangles
+    float* sa = streams;
+    float* sb = streams + 3 * count;
+    float* sd = streams + 6 * count;
+    for(size_t i = 0; i < count; i++) {
+        sa[i] = a[i].x, sa[count + i] = a[i].y, sa[2 * count + i] = a[i].z;
+        sb[i] = b[i].x, sb[count + i] = b[i].y, sb[2 * count + i] = b[i].z;
+        tris[i].a = a[i];
+    }
+    cave_Vec3_Array va = {sa, sa + count, sa + 2 * count, 1}, vb = {sb, sb + count, sb + 2 * count, 1};
+    cave_Vec3_Array vd = {sd, sd + count, sd + 2 * count, 1};
+    size_t tri_stride = sizeof(cave_STL_Tri) / sizeof(float);
+    cave_Vec3_Array vt = {&tris->a.x, &tris->a.y, &tris->a.z, tri_stride};
+    cave_Vec3_Array vn = {&tris->normal.x, &tris->normal.y, &tris->normal.z, tri_stride};
+    float affine[12] = {0.5f, -1.25f, 2.0f, 3.0f, 1.5f, 0.25f, -0.75f, -4.0f, 0.0f, 1.0f, 1.0f, 0.5f};
+    float projective[16] = {1.0f, 0.0f, 0.5f, 1.0f, 0.0f, 2.0f, 0.0f, -1.0f, 0.25f, 0.0f, 1.0f, 0.0f,
+                            0.001f, 0.002f, 0.003f, 1.0f};
+
+    CaveError err = CAVE_NO_ERROR;
+    for(int op = 0; op < 9 && err == CAVE_NO_ERROR; op++) {
+        for(size_t i = 0; i < count; i++) {
+            float x = a[i].x, y = a[i].y, z = a[i].z;
+            float len = sqrtf(x * x + y * y + z * z);
+            cave_3Point w = {0.0f, 0.0f, 0.0f};
+            switch(op) {
+                case 0: w = (cave_3Point) {x + b[i].x, y + b[i].y, z + b[i].z}; break;
+                case 1: w = (cave_3Point) {x - b[i].x, y - b[i].y, z - b[i].z}; break;
+                case 2: w = (cave_3Point) {x * 0.3f, y * 0.3f, z * 0.3f}; break;
+                case 3:
+                    w = (cave_3Point) {y * b[i].z - z * b[i].y, z * b[i].x - x * b[i].z, x * b[i].y - y * b[i].x};
+                    break;
+                case 4: w = len > 0.0f ? (cave_3Point) {x / len, y / len, z / len} : w; break;
+                case 5:
+                    w.x = affine[0] * x + affine[1] * y + affine[2] * z + affine[3];
+                    w.y = affine[4] * x + affine[5] * y + affine[6] * z + affine[7];
+                    w.z = affine[8] * x + affine[9] * y + affine[10] * z + affine[11];
+                    break;
+                case 7:
+                    w = (cave_3Point) {x < b[i].x ? x : b[i].x, y < b[i].y ? y : b[i].y, z < b[i].z ? z : b[i].z};
+                    break;
+                case 8:
+                    w = (cave_3Point) {x > b[i].x ? x : b[i].x, y > b[i].y ? y : b[i].y, z > b[i].z ? z : b[i].z};
+                    break;
+                default: {
+                    float const* m = projective;
+                    float pw = m[12] * x + m[13] * y + m[14] * z + m[15];
+                    w.x = (m[0] * x + m[1] * y + m[2] * z + m[3]) / pw;
+                    w.y = (m[4] * x + m[5] * y + m[6] * z + m[7]) / pw;
+                    w.z = (m[8] * x + m[9] * y + m[10] * z + m[11]) / pw;
+                }
+            }
+            want[i] = w;
+        }
+        //packed, then streams, then from triangle corners into triangle normals
+        for(int layout = 0; layout < 3 && err == CAVE_NO_ERROR; layout++) {
+            cave_Vec3_Array const* src = layout == 1 ? &va : &vt;
+            cave_Vec3_Array const* dest = layout == 1 ? &vd : &vn;
+            CaveError e;
+            switch(op) {
+                case 0: e = layout == 0 ? cave_vec3_add(got, a, b, count) : cave_vec3_array_add(dest, src, &vb, count);
+                    break;
+                case 1: e = layout == 0 ? cave_vec3_sub(got, a, b, count) : cave_vec3_array_sub(dest, src, &vb, count);
+                    break;
+                case 2: e = layout == 0 ? cave_vec3_scale(got, a, 0.3f, count)
+                                        : cave_vec3_array_scale(dest, src, 0.3f, count);
+                    break;
+                case 3: e = layout == 0 ? cave_vec3_cross(got, a, b, count)
+                                        : cave_vec3_array_cross(dest, src, &vb, count);
+                    break;
+                case 4: e = layout == 0 ? cave_vec3_normalize(got, a, count)
+                                        : cave_vec3_array_normalize(dest, src, count);
+                    break;
+                case 5: e = layout == 0 ? cave_vec3_transform_affine(got, a, affine, count)
+                                        : cave_vec3_array_transform_affine(dest, src, affine, count);
+                    break;
+                case 7: e = layout == 0 ? cave_vec3_min(got, a, b, count) : cave_vec3_array_min(dest, src, &vb, count);
+                    break;
+                case 8: e = layout == 0 ? cave_vec3_max(got, a, b, count) : cave_vec3_array_max(dest, src, &vb, count);
+                    break;
+                default: e = layout == 0 ? cave_vec3_transform(got, a, projective, count)
+                                         : cave_vec3_array_transform(dest, src, projective, count);
+            }
+            for(size_t i = 0; layout > 0 && i < count; i++) {
+                got[i] = layout == 1 ? (cave_3Point) {sd[i], sd[count + i], sd[2 * count + i]} : tris[i].normal;
+            }
+            if(e != CAVE_NO_ERROR || !same_floats(&got->x, &want->x, 3 * count)) {
+                printf("vector kernel %d differs from a plain loop over layout %d\n", op, layout);
+                err = e != CAVE_NO_ERROR ? e : CAVE_DATA_ERROR;
+            }
+        }
+    }
+
+    //dot products and bounds, which reduce
+    for(size_t i = 0; i < count; i++) {
+        dots[count + i] = a[i].x * b[i].x + a[i].y * b[i].y + a[i].z * b[i].z;
+    }
+    cave_3Point lo, hi, slo, shi;
+    if(err == CAVE_NO_ERROR && (cave_vec3_dot(dots, a, b, count) != CAVE_NO_ERROR
+                                || !same_floats(dots, dots + count, count)
+                                || cave_vec3_array_dot(dots, &va, &vb, count) != CAVE_NO_ERROR
+                                || !same_floats(dots, dots + count, count))) {
+        printf("dot products differ from a plain loop\n");
+        err = CAVE_DATA_ERROR;
+    }
+    cave_3Point want_lo = a[0], want_hi = a[0];
+    for(size_t i = 1; i < count; i++) {
+        want_lo = (cave_3Point) {fminf(want_lo.x, a[i].x), fminf(want_lo.y, a[i].y), fminf(want_lo.z, a[i].z)};
+        want_hi = (cave_3Point) {fmaxf(want_hi.x, a[i].x), fmaxf(want_hi.y, a[i].y), fmaxf(want_hi.z, a[i].z)};
+    }
+    if(err == CAVE_NO_ERROR && (cave_vec3_bounds(&lo, &hi, a, count) != CAVE_NO_ERROR
+                                || cave_vec3_array_bounds(&slo, &shi, &vt, count) != CAVE_NO_ERROR
+                                || memcmp(&lo, &want_lo, sizeof(lo)) != 0 || memcmp(&hi, &want_hi, sizeof(hi)) != 0
+                                || memcmp(&slo, &lo, sizeof(lo)) != 0 || memcmp(&shi, &hi, sizeof(hi)) != 0)) {
+        printf("bounds differ from a plain loop\n");
+        err = CAVE_DATA_ERROR;
+    }
+    if(err == CAVE_NO_ERROR && (cave_vec3_bounds(&lo, &hi, NULL, 0) != CAVE_NO_ERROR || lo.x != INFINITY
+                                || hi.z != -INFINITY)) {
+        err = CAVE_DATA_ERROR;
+    }
+
+    //2D points, taking a and b's floats two at a time
+    cave_2Point* a2 = (cave_2Point*) streams;
+    cave_2Point* b2 = (cave_2Point*) (streams + 3 * count);
+    cave_2Point* d2 = (cave_2Point*) (streams + 6 * count);
+    size_t count2 = count + count / 2;
+    float affine2[6] = {0.5f, -2.0f, 1.0f, 3.0f, 0.75f, -0.5f};
+    for(int op = 0; op < 6 && err == CAVE_NO_ERROR; op++) {
+        CaveError e = op == 0 ? cave_vec2_add(d2, a2, b2, count2) : op == 1 ? cave_vec2_sub(d2, a2, b2, count2)
+                      : op == 2 ? cave_vec2_scale(d2, a2, -1.5f, count2)
+                      : op == 3 ? cave_vec2_transform_affine(d2, a2, affine2, count2)
+                      : op == 4 ? cave_vec2_min(d2, a2, b2, count2) : cave_vec2_max(d2, a2, b2, count2);
+        for(size_t i = 0; i < count2 && e == CAVE_NO_ERROR; i++) {
+            float x = a2[i].x, y = a2[i].y;
+            cave_2Point w = op == 0 ? (cave_2Point) {x + b2[i].x, y + b2[i].y}
+                            : op == 1 ? (cave_2Point) {x - b2[i].x, y - b2[i].y}
+                            : op == 2 ? (cave_2Point) {x * -1.5f, y * -1.5f}
+                            : op == 3 ? (cave_2Point) {affine2[0] * x + affine2[1] * y + affine2[2],
+                                                       affine2[3] * x + affine2[4] * y + affine2[5]}
+                            : op == 4 ? (cave_2Point) {x < b2[i].x ? x : b2[i].x, y < b2[i].y ? y : b2[i].y}
+                            : (cave_2Point) {x > b2[i].x ? x : b2[i].x, y > b2[i].y ? y : b2[i].y};
+            e = memcmp(&w, &d2[i], sizeof(w)) == 0 ? CAVE_NO_ERROR : CAVE_DATA_ERROR;
+        }
+        if(e != CAVE_NO_ERROR) {
+            printf("2D vector kernel %d differs from a plain loop\n", op);
+            err = e;
+        }
+    }
+    cave_2Point lo2, hi2;
+    if(err == CAVE_NO_ERROR && (cave_vec2_dot(dots, a2, b2, count2) != CAVE_NO_ERROR
+                                || cave_vec2_bounds(&lo2, &hi2, a2, count2) != CAVE_NO_ERROR)) {
+        err = CAVE_DATA_ERROR;
+    }
+    for(size_t i = 0; i < count2 && err == CAVE_NO_ERROR; i++) {
+        if(dots[i] != a2[i].x * b2[i].x + a2[i].y * b2[i].y || a2[i].x < lo2.x || a2[i].y > hi2.y) {
+            printf("2D dot products or bounds differ from a plain loop\n");
+            err = CAVE_DATA_ERROR;
+        }
+    }
+
+    //normalizing in place, and bad arguments
+    cave_Vec3_Array no_stride = {sa, sa, sa, 0};
+    if(err == CAVE_NO_ERROR) {
+        memcpy(got, a, sizeof(cave_3Point) * count);
+        cave_vec3_normalize(want, a, count);
+        if(cave_vec3_normalize(got, got, count) != CAVE_NO_ERROR || !same_floats(&got->x, &want->x, 3 * count)
+           || cave_vec3_add(NULL, a, b, count) != CAVE_DATA_ERROR
+           || cave_vec3_array_dot(dots, &no_stride, &vb, count) != CAVE_DATA_ERROR
+           || cave_vec3_transform(got, a, NULL, count) != CAVE_DATA_ERROR
+           || cave_vec3_add(NULL, NULL, NULL, 0) != CAVE_NO_ERROR) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    free(a), free(b), free(got), free(want), free(streams), free(tris), free(dots);
+    return err;
+}
+
+CaveError vector_math_kernels() {
+    printf("vector math starts out on the %s path\n", cave_cpu_path_name(cave_cpu_path()));
+    //every path the host can run has to give the same answers
+    CaveError err = CAVE_NO_ERROR;
+    for(int path = CAVE_CPU_PATH_SCALAR; path <= (int) cave_cpu_best_path() && err == CAVE_NO_ERROR; path++) {
+        cave_cpu_set_path((cave_Cpu_Path) path);
+        err = check_vector_kernels();
+        if(err != CAVE_NO_ERROR) {
+            printf("vector math kernels failed on the %s path\n", cave_cpu_path_name((cave_Cpu_Path) path));
+        }
+    }
+    cave_cpu_set_path(cave_cpu_best_path());
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    //a mesh's vertexes, transformed in place
+    float affine[12] = {0.5f, -1.25f, 2.0f, 3.0f, 1.5f, 0.25f, -0.75f, -4.0f, 0.0f, 1.0f, 1.0f, 0.5f};
+    size_t count = 10003;
+    cave_3Point* points = malloc(sizeof(cave_3Point) * count);
+    if(!points) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < count; i++) {
+        points[i] = (cave_3Point) {(float) (i % 100), (float) (i / 100 % 100), (float) (i / 10000)};
+    }
+    err = cave_vec3_transform_affine(points, points, affine, count);
+    if(err == CAVE_NO_ERROR && points[count - 1].x != affine[0] * 2.0f + affine[1] * 0.0f + affine[2] * 1.0f
+                                                      + affine[3]) {
+        err = CAVE_DATA_ERROR;
+    }
+    free(points);
+    return err;
+}
+
+CaveError cpu_dispatch() {
+    cave_Cpu_Path best = cave_cpu_best_path();
+    unsigned features = cave_cpu_features();
+    printf("host supports %s, with features 0x%x\n", cave_cpu_path_name(best), features);
+    if(best >= CAVE_CPU_PATH_AVX2 && !(features & CAVE_CPU_AVX2)) {
+        return CAVE_DATA_ERROR;
+    }
+    if((best < CAVE_CPU_PATH_AVX512 && cave_cpu_set_path((cave_Cpu_Path) (best + 1)) != CAVE_DATA_ERROR)
+       || cave_cpu_set_path((cave_Cpu_Path) -1) != CAVE_DATA_ERROR || cave_cpu_path() != best
+       || strcmp(cave_cpu_path_name((cave_Cpu_Path) 99), "unknown") != 0) {
+        return CAVE_DATA_ERROR;
+    }
+
+    //every path decodes the teapot into the same triangles, and encodes them back into the same bytes
+    FILE* file = fopen("assets/utah_teapot.stl", "rb");
+    if(!file) {
+        return CAVE_FILE_ERROR;
+    }
+    long len = cave_file_len(file);
+    uint8_t* bytes = malloc((size_t) len);
+    uint8_t* encoded = NULL;
+    if(!bytes || fread(bytes, 1, (size_t) len, file) != (size_t) len) {
+        fclose(file);
+        free(bytes);
+        return bytes ? CAVE_FILE_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    fclose(file);
+    cave_STL_Data first = {0}, data;
+    CaveError err = CAVE_NO_ERROR;
+    for(int path = CAVE_CPU_PATH_SCALAR; path <= (int) best && err == CAVE_NO_ERROR; path++) {
+        err = cave_cpu_set_path((cave_Cpu_Path) path);
+        if(err == CAVE_NO_ERROR) {
+            err = cave_bytes_to_STL_Data(path == 0 ? &first : &data, bytes, (size_t) len);
+        }
+        if(err != CAVE_NO_ERROR || path == 0) {
+            continue;
+        }
+        for(uint32_t i = 0; i < data.tri_count && err == CAVE_NO_ERROR; i++) {
+            cave_STL_Tri const* x = &first.tris[i];
+            cave_STL_Tri const* y = &data.tris[i];
+            if(memcmp(x, y, offsetof(cave_STL_Tri, attribute)) != 0 || x->attribute != y->attribute) {
+                printf("the %s path decoded triangle %u differently\n", cave_cpu_path_name(path), i);
+                err = CAVE_DATA_ERROR;
+            }
+        }
+        if(err == CAVE_NO_ERROR) {
+            err = cave_STL_Data_to_Bytes(&encoded, &data);
+        }
+        if(err == CAVE_NO_ERROR && memcmp(encoded, bytes, (size_t) len) != 0) {
+            printf("the %s path encoded the teapot differently\n", cave_cpu_path_name(path));
+            err = CAVE_DATA_ERROR;
+        }
+        free(encoded);
+        encoded = NULL;
+        cave_STL_Data_release(&data);
+    }
+    cave_STL_Data_release(&first);
+    free(bytes);
+    if(cave_cpu_set_path(best) != CAVE_NO_ERROR) {
+        return CAVE_UNKNOWN_ERROR;
+    }
+    return err;
+}
+
+//a unit cube welded into 8 corners, two triangles a face, wound outwards
+static void make_cube(cave_Mesh* cube, cave_3Point* positions, cave_Index_Triangle* tris) {
+    for(uint32_t i = 0; i < 8; i++) {
+        positions[i] = (cave_3Point) {(float) (i & 1), (float) (i >> 1 & 1), (float) (i >> 2 & 1)};
+    }
+    cave_Index_Triangle const faces[12] = {{0, 2, 1}, {1, 2, 3}, {4, 5, 6}, {5, 7, 6}, {0, 1, 4}, {1, 5, 4},
+                                           {2, 6, 3}, {3, 6, 7}, {0, 4, 2}, {2, 4, 6}, {1, 3, 5}, {3, 7, 5}};
+    memcpy(tris, faces, sizeof(faces));
+    *cube = (cave_Mesh) {positions, NULL, 8, tris, 12};
+}
+
+CaveError repair_normals() {
+    cave_STL_Data teapot;
+    CaveError err = load_teapot(&teapot);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    //a tolerance of 0 replaces every normal, after which none is off
+    cave_Normal_Options options = {0.0f, false, CAVE_NORMAL_WEIGHT_AREA, 0};
+    size_t replaced = 0;
+    err = cave_STL_Data_repair_normals(&teapot, &options, &replaced);
+    if(err != CAVE_NO_ERROR || replaced != teapot.tri_count) {
+        cave_STL_Data_release(&teapot);
+        return err != CAVE_NO_ERROR ? err : CAVE_DATA_ERROR;
+    }
+    options.tolerance = 0.1f;
+    err = cave_STL_Data_repair_normals(&teapot, &options, &replaced);
+    if(err != CAVE_NO_ERROR || replaced != 0) {
+        cave_STL_Data_release(&teapot);
+        return err != CAVE_NO_ERROR ? err : CAVE_DATA_ERROR;
+    }
+
+    //zeroed, NaN, flipped and sideways normals are off, and one a hundredth of a radian out isn't
+    size_t corrupt[5];
+    size_t found = 0;
+    for(size_t i = 0; i < teapot.tri_count && found < 5; i += teapot.tri_count / 7) {
+        cave_3Point n = teapot.tris[i].normal;
+        if(n.x != 0.0f || n.y != 0.0f || n.z != 0.0f) {
+            corrupt[found++] = i;
+        }
+    }
+    if(found < 5) {
+        cave_STL_Data_release(&teapot);
+        return CAVE_DATA_ERROR;
+    }
+    cave_3Point* n = &teapot.tris[corrupt[0]].normal;
+    *n = (cave_3Point) {0.0f, 0.0f, 0.0f};
+    n = &teapot.tris[corrupt[1]].normal;
+    n->y = NAN;
+    n = &teapot.tris[corrupt[2]].normal;
+    *n = (cave_3Point) {-n->x, -n->y, -n->z};
+    n = &teapot.tris[corrupt[3]].normal;
+    *n = (cave_3Point) {n->y - n->z, n->z - n->x, n->x - n->y};
+    n = &teapot.tris[corrupt[4]].normal;
+    cave_3Point nudged = {n->x + 0.01f * n->y, n->y - 0.01f * n->x, n->z};
+    *n = nudged;
+
+    cave_STL_Data copy = {{0}, teapot.tri_count, malloc(sizeof(cave_STL_Tri) * teapot.tri_count)};
+    if(!copy.tris) {
+        cave_STL_Data_release(&teapot);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    memcpy(copy.tris, teapot.tris, sizeof(cave_STL_Tri) * teapot.tri_count);
+    options.check_only = true;
+    err = cave_STL_Data_repair_normals(&copy, &options, &replaced);
+    size_t tris_len = sizeof(cave_STL_Tri) * teapot.tri_count;
+    if(err == CAVE_NO_ERROR && (replaced != 4 || memcmp(copy.tris, teapot.tris, tris_len) != 0)) {
+        printf("checking found %zu bad normals, and should have found 4 without changing any\n", replaced);
+        err = CAVE_DATA_ERROR;
+    }
+    //the same fixes come out whatever the number of threads
+    options.check_only = false;
+    options.threads = 1;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Data_repair_normals(&copy, &options, &replaced);
+    }
+    size_t replaced_threaded = 0;
+    options.threads = 8;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Data_repair_normals(&teapot, &options, &replaced_threaded);
+    }
+    if(err == CAVE_NO_ERROR && (replaced != 4 || replaced_threaded != 4
+                                || memcmp(copy.tris, teapot.tris, tris_len) != 0
+                                || memcmp(&teapot.tris[corrupt[4]].normal, &nudged, sizeof(nudged)) != 0)) {
+        printf("repairing fixed %zu and %zu bad normals, and should have fixed 4 the same way\n", replaced,
+               replaced_threaded);
+        err = CAVE_DATA_ERROR;
+    }
+    cave_Normal_Options bad = {-1.0f, false, CAVE_NORMAL_WEIGHT_AREA, 0};
+    if(err == CAVE_NO_ERROR && (cave_STL_Data_repair_normals(&copy, &bad, NULL) != CAVE_DATA_ERROR
+                                || cave_STL_Data_repair_normals(NULL, NULL, NULL) != CAVE_DATA_ERROR)) {
+        err = CAVE_DATA_ERROR;
+    }
+    cave_STL_Data_release(&copy);
+
+    //vertex normals are the same with 1 thread as with 8, and area weighting is what it always was
+    cave_Mesh mesh = {0}, threaded = {0};
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Data_to_Mesh(&mesh, &teapot);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Data_to_Mesh(&threaded, &teapot);
+    }
+    for(int weighting = CAVE_NORMAL_WEIGHT_AREA; weighting <= CAVE_NORMAL_WEIGHT_ANGLE && err == CAVE_NO_ERROR;
+        weighting++) {
+        cave_Normal_Options serial = {0.0f, false, (cave_Normal_Weighting) weighting, 1};
+        cave_Normal_Options parallel = {0.0f, false, (cave_Normal_Weighting) weighting, 8};
+        err = cave_Mesh_compute_weighted_normals(&mesh, &serial);
+        if(err == CAVE_NO_ERROR) {
+            err = cave_Mesh_compute_weighted_normals(&threaded, &parallel);
+        }
+        if(err == CAVE_NO_ERROR
+           && memcmp(mesh.normals, threaded.normals, sizeof(cave_3Point) * mesh.vert_count) != 0) {
+            printf("vertex normals differ between 1 and 8 threads\n");
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    //area weighting sums each face's cross product and normalizes, as the scalar code before it did
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_compute_vertex_normals(&mesh);
+    }
+    cave_3Point* sums = calloc(mesh.vert_count, sizeof(cave_3Point));
+    if(err == CAVE_NO_ERROR && !sums) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < mesh.tri_count && err == CAVE_NO_ERROR; i++) {
+        cave_Index_Triangle t = mesh.tris[i];
+        cave_3Point a = mesh.positions[t.a], b = mesh.positions[t.b], c = mesh.positions[t.c];
+        float ux = b.x - a.x, uy = b.y - a.y, uz = b.z - a.z;
+        float vx = c.x - a.x, vy = c.y - a.y, vz = c.z - a.z;
+        cave_3Point n = {uy * vz - uz * vy, uz * vx - ux * vz, ux * vy - uy * vx};
+        size_t corners[3] = {t.a, t.b, t.c};
+        for(int k = 0; k < 3; k++) {
+            sums[corners[k]].x += n.x;
+            sums[corners[k]].y += n.y;
+            sums[corners[k]].z += n.z;
+        }
+    }
+    for(size_t i = 0; i < mesh.vert_count && err == CAVE_NO_ERROR; i++) {
+        cave_3Point v = sums[i];
+        float len = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+        if(len > 0.0f) {
+            v = (cave_3Point) {v.x / len, v.y / len, v.z / len};
+        }
+        if(memcmp(&v, &mesh.normals[i], sizeof(v)) != 0) {
+            printf("vertex %zu's area weighted normal changed\n", i);
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    free(sums);
+    cave_Mesh_release(&mesh);
+    cave_Mesh_release(&threaded);
+
+    //a cube's corners weigh each of their three faces by a right angle, and point straight out diagonally
+    cave_3Point positions[8];
+    cave_Index_Triangle tris[12];
+    cave_Mesh cube;
+    make_cube(&cube, positions, tris);
+    cave_Normal_Options by_angle = {0.0f, false, CAVE_NORMAL_WEIGHT_ANGLE, 0};
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_compute_weighted_normals(&cube, &by_angle);
+    }
+    for(size_t i = 0; i < 8 && err == CAVE_NO_ERROR; i++) {
+        cave_3Point want = {positions[i].x - 0.5f, positions[i].y - 0.5f, positions[i].z - 0.5f};
+        float scale = 2.0f / sqrtf(3.0f);
+        cave_3Point got = cube.normals[i];
+        if(fabsf(got.x - want.x * scale) > 1e-6f || fabsf(got.y - want.y * scale) > 1e-6f
+           || fabsf(got.z - want.z * scale) > 1e-6f) {
+            printf("cube corner %zu has normal (%f, %f, %f)\n", i, got.x, got.y, got.z);
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    by_angle.weighting = (cave_Normal_Weighting) 7;
+    if(err == CAVE_NO_ERROR && cave_Mesh_compute_weighted_normals(&cube, &by_angle) != CAVE_DATA_ERROR) {
+        err = CAVE_DATA_ERROR;
+    }
+    free(cube.normals);
+    cave_STL_Data_release(&teapot);
+    return err;
+}
+
+//compares measures member by member, as `cave_Mesh_Measures` has padding that memcmp would see.
+static bool measures_equal(cave_Mesh_Measures const* a, cave_Mesh_Measures const* b) {
+    return memcmp(&a->min, &b->min, sizeof(cave_3Point)) == 0 && memcmp(&a->max, &b->max, sizeof(cave_3Point)) == 0
+           && memcmp(&a->area, &b->area, sizeof(double)) == 0 && memcmp(&a->volume, &b->volume, sizeof(double)) == 0
+           && memcmp(&a->centroid, &b->centroid, sizeof(cave_3Point)) == 0;
+}
+
+CaveError measure_STL() {
+    //a 2 x 3 x 4 box away from the origin, from a welded unit cube
+    cave_3Point positions[8];
+    cave_Index_Triangle tris[12];
+    cave_Mesh cube;
+    make_cube(&cube, positions, tris);
+    for(size_t i = 0; i < 8; i++) {
+        positions[i] = (cave_3Point) {100.0f + 2.0f * positions[i].x, -50.0f + 3.0f * positions[i].y,
+                                      1000.0f + 4.0f * positions[i].z};
+    }
+    cave_STL_Data box;
+    CaveError err = cave_Mesh_to_STL_Data(&box, &cube);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    cave_Mesh_Measures got;
+    err = cave_STL_Data_measure(&got, &box, 0);
+    if(err == CAVE_NO_ERROR && (got.min.x != 100.0f || got.max.y != -47.0f || got.max.z != 1004.0f
+                                || fabs(got.area - 52.0) > 1e-9 || fabs(got.volume - 24.0) > 1e-9
+                                || got.centroid.x != 101.0f || got.centroid.y != -48.5f || got.centroid.z != 1002.0f)) {
+        printf("the box measured area %f, volume %f, centroid (%f, %f, %f)\n", got.area, got.volume, got.centroid.x,
+               got.centroid.y, got.centroid.z);
+        err = CAVE_DATA_ERROR;
+    }
+    //just its bottom encloses nothing, so the centroid is the surface's
+    box.tri_count = 2;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Data_measure(&got, &box, 0);
+    }
+    if(err == CAVE_NO_ERROR && (got.volume != 0.0 || fabs(got.area - 6.0) > 1e-9 || got.centroid.x != 101.0f
+                                || got.centroid.y != -48.5f || got.centroid.z != 1000.0f)) {
+        err = CAVE_DATA_ERROR;
+    }
+    cave_STL_Data_release(&box);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+
+    //the teapot measures the same decoded or not, with any number of threads, on any path
+    cave_STL_Data teapot;
+    err = load_teapot(&teapot);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    uint8_t* bytes = NULL;
+    err = cave_STL_Data_to_Bytes(&bytes, &teapot);
+    size_t bytes_len = cave_Sizeof_STL_Data(&teapot);
+    cave_Mesh_Measures want;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Data_measure(&want, &teapot, 1);
+    }
+    for(int path = CAVE_CPU_PATH_SCALAR; path <= (int) cave_cpu_best_path() && err == CAVE_NO_ERROR; path++) {
+        cave_cpu_set_path((cave_Cpu_Path) path);
+        cave_Mesh_Measures threaded, mapped;
+        err = cave_STL_Data_measure(&threaded, &teapot, 8);
+        if(err == CAVE_NO_ERROR) {
+            err = cave_STL_Bytes_measure(&mapped, bytes, bytes_len, 3);
+        }
+        if(err == CAVE_NO_ERROR && (!measures_equal(&threaded, &want) || !measures_equal(&mapped, &want))) {
+            printf("the teapot measured differently on the %s path\n", cave_cpu_path_name((cave_Cpu_Path) path));
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    cave_cpu_set_path(cave_cpu_best_path());
+    //and close to what a plain loop in long double finds
+    long double area = 0.0L, volume = 0.0L;
+    for(uint32_t i = 0; i < teapot.tri_count; i++) {
+        cave_STL_Tri t = teapot.tris[i];
+        long double ux = t.b.x - t.a.x, uy = t.b.y - t.a.y, uz = t.b.z - t.a.z;
+        long double vx = t.c.x - t.a.x, vy = t.c.y - t.a.y, vz = t.c.z - t.a.z;
+        long double nx = uy * vz - uz * vy, ny = uz * vx - ux * vz, nz = ux * vy - uy * vx;
+        area += sqrtl(nx * nx + ny * ny + nz * nz) / 2.0L;
+        volume += (t.a.x * nx + t.a.y * ny + t.a.z * nz) / 6.0L;
+    }
+    printf("the teapot has area %f and volume %f, centered at (%f, %f, %f)\n", want.area, want.volume,
+           want.centroid.x, want.centroid.y, want.centroid.z);
+    if(err == CAVE_NO_ERROR
+       && (fabsl(want.area - area) > 1e-5L * area || fabsl(want.volume - volume) > 1e-4L * fabsl(volume))) {
+        printf("the teapot should have area %Lf and volume %Lf\n", area, volume);
+        err = CAVE_DATA_ERROR;
+    }
+    if(err == CAVE_NO_ERROR && (cave_STL_Bytes_measure(&got, bytes, bytes_len - 50, 0) != CAVE_DATA_ERROR
+                                || cave_STL_Data_measure(&got, NULL, 0) != CAVE_DATA_ERROR)) {
+        err = CAVE_DATA_ERROR;
+    }
+    free(bytes);
+
+    //many copies of it, measured straight from their file bytes
+    size_t copies = 20;
+    cave_STL_Data big = {{0}, (uint32_t) (teapot.tri_count * copies), NULL};
+    big.tris = malloc(sizeof(cave_STL_Tri) * big.tri_count);
+    if(err == CAVE_NO_ERROR && !big.tris) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < copies && err == CAVE_NO_ERROR; i++) {
+        memcpy(big.tris + i * teapot.tri_count, teapot.tris, sizeof(cave_STL_Tri) * teapot.tri_count);
+    }
+    bytes = NULL;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Data_to_Bytes(&bytes, &big);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Bytes_measure(&got, bytes, cave_Sizeof_STL_Data(&big), 0);
+    }
+    if(err == CAVE_NO_ERROR && fabs(got.volume - want.volume * (double) copies) > 1e-6 * fabs(got.volume)) {
+        err = CAVE_DATA_ERROR;
+    }
+    free(bytes);
+    free(big.tris);
+    cave_STL_Data_release(&teapot);
+    return err;
+}
+
+//a float between 0 and 1 from an LCG
+static float next_unit(unsigned* seed) {
+    *seed = *seed * 1103515245u + 12345u;
+    return (float) ((*seed >> 8) % 100000) / 100000.0f;
+}
+
+//where a ray hits a triangle, or infinity, by Moller-Trumbore in double
+static double brute_ray_triangle(cave_Ray const* ray, cave_3d_Triangle const* t) {
+    double e1[3] = {t->b.x - t->a.x, t->b.y - t->a.y, t->b.z - t->a.z};
+    double e2[3] = {t->c.x - t->a.x, t->c.y - t->a.y, t->c.z - t->a.z};
+    double d[3] = {ray->dir.x, ray->dir.y, ray->dir.z};
+    double p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+    double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+    if(det == 0.0) {
+        return INFINITY;
+    }
+    double s[3] = {ray->origin.x - t->a.x, ray->origin.y - t->a.y, ray->origin.z - t->a.z};
+    double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / det;
+    double q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+    double v = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) / det;
+    double hit = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+    if(u < 0.0 || v < 0.0 || u + v > 1.0 || hit < ray->t_min || hit > ray->t_max) {
+        return INFINITY;
+    }
+    return hit;
+}
+
+static double brute_segment_dist2(double const* p, double const* a, double const* b) {
+    double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+    double len2 = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+    double s = len2 > 0.0 ? ((p[0] - a[0]) * ab[0] + (p[1] - a[1]) * ab[1] + (p[2] - a[2]) * ab[2]) / len2 : 0.0;
+    s = s < 0.0 ? 0.0 : (s > 1.0 ? 1.0 : s);
+    double d[3] = {a[0] + s * ab[0] - p[0], a[1] + s * ab[1] - p[1], a[2] + s * ab[2] - p[2]};
+    return d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+}
+
+//the squared distance from a point to a triangle: to its plane if the point projects inside, else to an edge
+static double brute_point_triangle(cave_3Point point, cave_3d_Triangle const* t) {
+    double p[3] = {point.x, point.y, point.z};
+    double a[3] = {t->a.x, t->a.y, t->a.z}, b[3] = {t->b.x, t->b.y, t->b.z}, c[3] = {t->c.x, t->c.y, t->c.z};
+    double e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]}, e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+    double n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+    double n2 = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+    if(n2 > 0.0) {
+        double ap[3] = {p[0] - a[0], p[1] - a[1], p[2] - a[2]};
+        double h = (ap[0] * n[0] + ap[1] * n[1] + ap[2] * n[2]) / n2;
+        double f[3] = {ap[0] - h * n[0], ap[1] - h * n[1], ap[2] - h * n[2]};
+        double c1[3] = {e1[1] * f[2] - e1[2] * f[1], e1[2] * f[0] - e1[0] * f[2], e1[0] * f[1] - e1[1] * f[0]};
+        double c2[3] = {f[1] * e2[2] - f[2] * e2[1], f[2] * e2[0] - f[0] * e2[2], f[0] * e2[1] - f[1] * e2[0]};
+        double v = (c1[0] * n[0] + c1[1] * n[1] + c1[2] * n[2]) / n2;
+        double u = (c2[0] * n[0] + c2[1] * n[1] + c2[2] * n[2]) / n2;
+        if(u >= 0.0 && v >= 0.0 && u + v <= 1.0) {
+            return h * h * n2;
+        }
+    }
+    double d = brute_segment_dist2(p, a, b);
+    double e = brute_segment_dist2(p, b, c);
+    double f = brute_segment_dist2(p, c, a);
+    return d < e ? (d < f ? d : f) : (e < f ? e : f);
+}
+
+CaveError bvh_queries() {
+    cave_STL_Data teapot;
+    CaveError err = load_teapot(&teapot);
+    if(err != CAVE_NO_ERROR) {
+        return err;
+    }
+    size_t n = teapot.tri_count;
+    cave_3d_Triangle* tris = malloc(sizeof(cave_3d_Triangle) * n);
+    if(!tris) {
+        cave_STL_Data_release(&teapot);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < n; i++) {
+        tris[i] = (cave_3d_Triangle) {teapot.tris[i].a, teapot.tris[i].b, teapot.tris[i].c};
+    }
+
+    //the tree doesn't depend on the number of threads, and holds every triangle once
+    cave_BVH bvh = {0}, threaded = {0};
+    err = cave_BVH_build_STL(&bvh, &teapot, 1);
+    if(err == CAVE_NO_ERROR) {
+        err = cave_BVH_build(&threaded, tris, n, 8);
+    }
+    if(err == CAVE_NO_ERROR && (bvh.node_count != threaded.node_count || bvh.tri_count != n
+                                || memcmp(bvh.nodes, threaded.nodes, sizeof(cave_BVH_Node) * bvh.node_count) != 0
+                                || memcmp(bvh.tri_ids, threaded.tri_ids, sizeof(uint32_t) * n) != 0)) {
+        printf("the teapot's tree changed with the number of threads\n");
+        err = CAVE_DATA_ERROR;
+    }
+    cave_BVH_release(&threaded);
+    bool* seen = calloc(n, sizeof(bool));
+    if(err == CAVE_NO_ERROR && !seen) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < n && err == CAVE_NO_ERROR; i++) {
+        uint32_t id = bvh.tri_ids[i];
+        if(id >= n || seen[id] || memcmp(&bvh.tris[i], &tris[id], sizeof(cave_3d_Triangle)) != 0) {
+            err = CAVE_DATA_ERROR;
+        } else {
+            seen[id] = true;
+        }
+    }
+    free(seen);
+    if(err == CAVE_NO_ERROR) {
+        printf("the teapot's %zu triangles took %zu nodes\n", n, bvh.node_count);
+    }
+
+    //rays from all around, at points in and around the teapot, hit what testing every triangle does
+    cave_3Point min, max;
+    cave_vec3_bounds(&min, &max, &tris->a, n * 3);
+    cave_3Point center = {(min.x + max.x) / 2, (min.y + max.y) / 2, (min.z + max.z) / 2};
+    float size = max.x - min.x + max.y - min.y + max.z - min.z;
+    unsigned seed = 2024;
+    size_t ray_count = 2000, hit_count = 0;
+    cave_Ray* rays = malloc(sizeof(cave_Ray) * ray_count);
+    cave_Ray_Hit* hits = malloc(sizeof(cave_Ray_Hit) * ray_count);
+    bool* any = malloc(sizeof(bool) * ray_count);
+    if(err == CAVE_NO_ERROR && (!rays || !hits || !any)) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < ray_count && err == CAVE_NO_ERROR; i++) {
+        cave_3Point from = {center.x + size * (next_unit(&seed) - 0.5f), center.y + size * (next_unit(&seed) - 0.5f),
+                            center.z + size * (next_unit(&seed) - 0.5f)};
+        cave_3Point to = {min.x + (max.x - min.x) * next_unit(&seed), min.y + (max.y - min.y) * next_unit(&seed),
+                          min.z + (max.z - min.z) * next_unit(&seed)};
+        rays[i] = (cave_Ray) {from, {to.x - from.x, to.y - from.y, to.z - from.z}, 0.0f, i % 2 ? INFINITY : 1.0f};
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_BVH_first_hits(&bvh, rays, ray_count, hits, 0);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_BVH_any_hits(&bvh, rays, ray_count, any, 3);
+    }
+    for(size_t i = 0; i < ray_count && err == CAVE_NO_ERROR; i++) {
+        double want = INFINITY;
+        for(size_t k = 0; k < n; k++) {
+            double t = brute_ray_triangle(&rays[i], &tris[k]);
+            want = t < want ? t : want;
+        }
+        bool hit = hits[i].tri != SIZE_MAX;
+        hit_count += hit;
+        if(hit != (want != INFINITY) || any[i] != hit || (hit && fabs(hits[i].t - want) > 1e-4 * (1.0 + want))) {
+            printf("ray %zu hit at %f, and should have at %f\n", i, hit ? hits[i].t : INFINITY, want);
+            err = CAVE_DATA_ERROR;
+        }
+        cave_Ray_Hit single;
+        if(err == CAVE_NO_ERROR && (cave_BVH_first_hit(&bvh, &rays[i], &single) != hit
+                                    || single.tri != hits[i].tri || single.t != hits[i].t)) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+
+    //the same mesh, welded, gives the same hits
+    cave_Mesh mesh = {0};
+    cave_BVH welded = {0};
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Data_to_Mesh(&mesh, &teapot);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_BVH_build_Mesh(&welded, &mesh, 0);
+    }
+    for(size_t i = 0; i < ray_count && err == CAVE_NO_ERROR; i++) {
+        cave_Ray_Hit hit;
+        cave_BVH_first_hit(&welded, &rays[i], &hit);
+        if(hit.t != hits[i].t) {
+            printf("ray %zu hit the welded teapot at %f instead of %f\n", i, hit.t, hits[i].t);
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    cave_BVH_release(&welded);
+    cave_Mesh_release(&mesh);
+
+    //and the nearest points are as near as any point on any triangle
+    size_t point_count = 300;
+    cave_3Point* points = malloc(sizeof(cave_3Point) * point_count);
+    cave_Closest_Hit* closest = malloc(sizeof(cave_Closest_Hit) * point_count);
+    if(err == CAVE_NO_ERROR && (!points || !closest)) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < point_count && err == CAVE_NO_ERROR; i++) {
+        points[i] = (cave_3Point) {center.x + size * (next_unit(&seed) - 0.5f) * 0.6f,
+                                   center.y + size * (next_unit(&seed) - 0.5f) * 0.6f,
+                                   center.z + size * (next_unit(&seed) - 0.5f) * 0.6f};
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_BVH_closest_points(&bvh, points, point_count, INFINITY, closest, 0);
+    }
+    for(size_t i = 0; i < point_count && err == CAVE_NO_ERROR; i++) {
+        double want = INFINITY;
+        for(size_t k = 0; k < n; k++) {
+            double d2 = brute_point_triangle(points[i], &tris[k]);
+            want = d2 < want ? d2 : want;
+        }
+        want = sqrt(want);
+        size_t tri = closest[i].tri;
+        double on_tri = tri < n ? sqrt(brute_point_triangle(closest[i].point, &tris[tri])) : 1.0;
+        if(fabs(closest[i].distance - want) > 1e-4 * (1.0 + want) || on_tri > 1e-4) {
+            printf("point %zu is %f from the teapot, and should be %f\n", i, closest[i].distance, want);
+            err = CAVE_DATA_ERROR;
+        }
+        cave_Closest_Hit near;
+        if(err == CAVE_NO_ERROR && (cave_BVH_closest_point(&bvh, points[i], (float) want * 0.5f, &near)
+                                    || near.tri != SIZE_MAX)) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    if(err == CAVE_NO_ERROR) {
+        printf("%zu of %zu rays hit the teapot\n", hit_count, ray_count);
+    }
+    free(points);
+    free(closest);
+    free(rays);
+    free(hits);
+    free(any);
+    cave_BVH_release(&bvh);
+    free(tris);
+    cave_STL_Data_release(&teapot);
+    return err;
+}
+
+static int compare_ids(void const* a, void const* b) {
+    uint32_t x = *(uint32_t const*) a, y = *(uint32_t const*) b;
+    return x < y ? -1 : x > y;
+}
+
+static float grid_dist2(cave_3Point a, cave_3Point b) {
+    float dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+//checks `count` ids found near `q` against testing every point, sorting the ids on the way
+static bool grid_found_all(cave_3Point const* points, size_t n, cave_3Point q, float radius, uint32_t* ids,
+                           size_t count) {
+    size_t expected = 0;
+    for(size_t i = 0; i < n; i++) {
+        expected += grid_dist2(points[i], q) <= radius * radius;
+    }
+    qsort(ids, count, sizeof(uint32_t), compare_ids);
+    for(size_t i = 0; i < count; i++) {
+        if(ids[i] >= n || (i > 0 && ids[i] == ids[i - 1]) || grid_dist2(points[ids[i]], q) > radius * radius) {
+            return false;
+        }
+    }
+    return count == expected;
+}
+
+CaveError grid_queries() {
+    //a cloud with clumps of repeated points, and one far off
+    size_t n = 20000;
+    float radius = 0.03f;
+    cave_3Point* points = malloc(sizeof(cave_3Point) * n);
+    cave_3Point* queries = malloc(sizeof(cave_3Point) * n);
+    uint32_t* ids = malloc(sizeof(uint32_t) * n);
+    cave_Grid_Nearest* nearest = malloc(sizeof(cave_Grid_Nearest) * n);
+    if(!points || !queries || !ids || !nearest) {
+        free(points);
+        free(queries);
+        free(ids);
+        free(nearest);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    unsigned seed = 46;
+    for(size_t i = 0; i < n; i++) {
+        if(i % 10 == 9) {
+            points[i] = points[i - 1 - (size_t) (next_unit(&seed) * 8.0f)];
+        } else {
+            points[i] = (cave_3Point) {next_unit(&seed), next_unit(&seed), next_unit(&seed)};
+        }
+    }
+    points[n / 2] = (cave_3Point) {1e30f, -1e30f, 1e30f};
+    size_t query_count = 2000;
+    for(size_t i = 0; i < query_count; i++) {
+        if(i % 4 == 0) {
+            queries[i] = points[i * 7];
+        } else {
+            queries[i] = (cave_3Point) {1.2f * next_unit(&seed) - 0.1f, 1.2f * next_unit(&seed) - 0.1f,
+                                        1.2f * next_unit(&seed) - 0.1f};
+        }
+    }
+
+    cave_Point_Grid grid = {0};
+    CaveError err = cave_Point_Grid_build(&grid, points, n, radius);
+    if(err == CAVE_NO_ERROR && cave_Point_Grid_build(&grid, points, n, 0.0f) != CAVE_DATA_ERROR) {
+        err = CAVE_DATA_ERROR;
+    }
+
+    //what's within the radius is what testing every point finds, once each, and so is the nearest point
+    size_t total = 0;
+    for(size_t q = 0; q < query_count && err == CAVE_NO_ERROR; q++) {
+        size_t count = cave_Point_Grid_within(&grid, queries[q], radius, ids, n);
+        if(count != cave_Point_Grid_within(&grid, queries[q], radius, NULL, 0)
+           || !grid_found_all(points, n, queries[q], radius, ids, count)) {
+            printf("query %zu found the wrong points\n", q);
+            err = CAVE_DATA_ERROR;
+        }
+        total += count;
+        for(int pass = 0; pass < 2 && err == CAVE_NO_ERROR; pass++) {
+            float max_distance = pass == 0 ? INFINITY : radius / 2;
+            size_t best = SIZE_MAX;
+            float best_d2 = INFINITY;
+            for(size_t i = 0; i < n; i++) {
+                float d2 = grid_dist2(points[i], queries[q]);
+                if(d2 <= max_distance * max_distance && d2 < best_d2) {
+                    best = i;
+                    best_d2 = d2;
+                }
+            }
+            cave_Grid_Nearest found;
+            bool any = cave_Point_Grid_nearest(&grid, queries[q], max_distance, &found);
+            if(any != (best != SIZE_MAX) || found.id != best) {
+                printf("query %zu found the wrong nearest point\n", q);
+                err = CAVE_DATA_ERROR;
+            }
+        }
+    }
+    if(err == CAVE_NO_ERROR) {
+        printf("%zu queries found %zu points within %g\n", query_count, total, radius);
+    }
+    if(err == CAVE_NO_ERROR && (cave_Point_Grid_within(&grid, queries[1], INFINITY, NULL, 0) != n
+                                || cave_Point_Grid_within(&grid, points[n / 2], radius, ids, n) != 1
+                                || ids[0] != n / 2)) {
+        err = CAVE_DATA_ERROR;
+    }
+
+    //batches come out the same on any number of threads, and match the single queries
+    cave_Grid_Neighbors neighbors = {0}, threaded = {0};
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Point_Grid_neighbors(&grid, queries, query_count, radius, &neighbors, 1);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Point_Grid_neighbors(&grid, queries, query_count, radius, &threaded, 4);
+    }
+    if(err == CAVE_NO_ERROR && (neighbors.id_count != total || threaded.id_count != total
+                                || memcmp(neighbors.offsets, threaded.offsets,
+                                          sizeof(size_t) * (query_count + 1)) != 0
+                                || memcmp(neighbors.ids, threaded.ids, sizeof(uint32_t) * total) != 0)) {
+        printf("batched neighbors changed with the number of threads\n");
+        err = CAVE_DATA_ERROR;
+    }
+    for(size_t q = 0; q < query_count && err == CAVE_NO_ERROR; q++) {
+        size_t count = cave_Point_Grid_within(&grid, queries[q], radius, ids, n);
+        if(count != neighbors.offsets[q + 1] - neighbors.offsets[q]
+           || memcmp(ids, neighbors.ids + neighbors.offsets[q], sizeof(uint32_t) * count) != 0) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Point_Grid_nearests(&grid, queries, query_count, INFINITY, nearest, 4);
+    }
+    for(size_t q = 0; q < query_count && err == CAVE_NO_ERROR; q++) {
+        cave_Grid_Nearest found;
+        cave_Point_Grid_nearest(&grid, queries[q], INFINITY, &found);
+        if(found.id != nearest[q].id || found.distance != nearest[q].distance) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    cave_Grid_Neighbors_release(&threaded);
+
+    //rebuilding over fewer points reuses the grid's memory
+    cave_3Point* kept = grid.points;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Point_Grid_build(&grid, points, n / 4, radius);
+    }
+    if(err == CAVE_NO_ERROR && grid.points != kept) {
+        printf("rebuilding the grid reallocated it\n");
+        err = CAVE_DATA_ERROR;
+    }
+    for(size_t q = 0; q < query_count && err == CAVE_NO_ERROR; q++) {
+        size_t count = cave_Point_Grid_within(&grid, queries[q], radius, ids, n);
+        if(!grid_found_all(points, n / 4, queries[q], radius, ids, count)) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    free(points);
+    free(queries);
+    free(ids);
+    free(nearest);
+    cave_Grid_Neighbors_release(&neighbors);
+    cave_Point_Grid_release(&grid);
+    return err;
+}
+
+//a torus around the z axis, `around` quads by `across`, wound counter-clockwise seen from outside
+static CaveError make_torus(cave_Mesh* torus, float major, float minor, size_t around, size_t across) {
+    *torus = (cave_Mesh) {malloc(sizeof(cave_3Point) * around * across), NULL, around * across,
+                          malloc(sizeof(cave_Index_Triangle) * around * across * 2), around * across * 2};
+    if(!torus->positions || !torus->tris) {
+        cave_Mesh_release(torus);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    double const tau = 6.283185307179586;
+    for(size_t i = 0; i < around; i++) {
+        for(size_t j = 0; j < across; j++) {
+            double u = tau * (double) i / (double) around, v = tau * (double) j / (double) across;
+            double r = major + minor * cos(v);
+            torus->positions[i * across + j] = (cave_3Point) {(float) (r * cos(u)), (float) (r * sin(u)),
+                                                              (float) (minor * sin(v))};
+            size_t a = i * across + j, b = (i + 1) % around * across + j;
+            size_t c = (i + 1) % around * across + (j + 1) % across, d = i * across + (j + 1) % across;
+            torus->tris[2 * a] = (cave_Index_Triangle) {a, b, c};
+            torus->tris[2 * a + 1] = (cave_Index_Triangle) {a, c, d};
+        }
+    }
+    return CAVE_NO_ERROR;
+}
+
+static double ring_area(cave_2d_Polygon const* polygon, size_t ring) {
+    double area = 0.0;
+    size_t begin = polygon->ring_offsets[ring], end = polygon->ring_offsets[ring + 1];
+    for(size_t i = begin; i < end; i++) {
+        cave_2Point p = polygon->points[i], q = polygon->points[i + 1 < end ? i + 1 : begin];
+        area += (double) p.x * q.y - (double) q.x * p.y;
+    }
+    return area / 2.0;
+}
+
+static bool same_slices(cave_Slices const* a, cave_Slices const* b) {
+    if(a->layer_count != b->layer_count || a->open_rings != b->open_rings) {
+        return false;
+    }
+    for(size_t l = 0; l < a->layer_count; l++) {
+        cave_2d_Polygon const* x = a->layers + l;
+        cave_2d_Polygon const* y = b->layers + l;
+        if(x->ring_count != y->ring_count
+           || memcmp(x->ring_offsets, y->ring_offsets, sizeof(size_t) * (x->ring_count + 1)) != 0) {
+            return false;
+        }
+        //an empty layer may have no points array to compare
+        size_t point_count = x->ring_offsets[x->ring_count];
+        if(point_count > 0 && memcmp(x->points, y->points, sizeof(cave_2Point) * point_count) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CaveError slice_meshes() {
+    //a unit cube is cut into unit squares wound counter-clockwise, and planes at its bottom or off it cut nothing
+    cave_Mesh cube;
+    cave_3Point positions[8];
+    cave_Index_Triangle cube_tris[12];
+    make_cube(&cube, positions, cube_tris);
+    float cube_heights[6] = {0.5f, -1.0f, 0.25f, 1.0f, 0.0f, 2.0f};
+    size_t cube_rings[6] = {1, 0, 1, 1, 0, 0};
+    cave_Slices slices = {0}, other = {0};
+    CaveError err = cave_Mesh_slice(&slices, &cube, cube_heights, 6, 1);
+    for(size_t l = 0; l < 6 && err == CAVE_NO_ERROR; l++) {
+        cave_2d_Polygon const* layer = slices.layers + l;
+        if(layer->ring_count != cube_rings[l] || (layer->ring_count == 1 && fabs(ring_area(layer, 0) - 1.0) > 1e-6)) {
+            printf("the cube's slice at %f is wrong\n", cube_heights[l]);
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    if(err == CAVE_NO_ERROR && slices.open_rings != 0) {
+        err = CAVE_DATA_ERROR;
+    }
+    cave_Slices_release(&slices);
+
+    //through the middle of a torus, an outline and a hole, and the same from its STL data on any number of threads
+    cave_Mesh torus;
+    cave_STL_Data torus_stl = {{0}, 0, NULL};
+    if(err == CAVE_NO_ERROR) {
+        err = make_torus(&torus, 3.0f, 1.0f, 96, 48);
+    } else {
+        torus = (cave_Mesh) {0};
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_to_STL_Data(&torus_stl, &torus);
+    }
+    float torus_heights[40];
+    for(size_t l = 0; l < 40; l++) {
+        torus_heights[l] = -1.0f + (float) l * 0.05f;
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_slice(&slices, &torus, torus_heights, 40, 1);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_STL_Data_slice(&other, &torus_stl, torus_heights, 40, 4);
+    }
+    if(err == CAVE_NO_ERROR && (!same_slices(&slices, &other) || slices.open_rings != 0)) {
+        printf("the torus sliced differently from its STL data\n");
+        err = CAVE_DATA_ERROR;
+    }
+    cave_2d_Polygon const* middle = slices.layers + 20;
+    if(err == CAVE_NO_ERROR && middle->ring_count != 2) {
+        err = CAVE_DATA_ERROR;
+    }
+    if(err == CAVE_NO_ERROR) {
+        double first = ring_area(middle, 0), second = ring_area(middle, 1);
+        double outer = first > second ? first : second, inner = first > second ? second : first;
+        //the rings are polygons with a corner for every quad around, so a little smaller than circles
+        double want = 3.141592653589793 * (16.0 - 4.0);
+        printf("the torus's middle slice has area %f of about %f\n", outer + inner, want);
+        if(outer <= 0.0 || inner >= 0.0 || fabs(outer + inner - want) > 0.01 * want) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    cave_Slices_release(&slices);
+    cave_Slices_release(&other);
+    cave_STL_Data_release(&torus_stl);
+    cave_Mesh_release(&torus);
+
+    //the teapot isn't closed, but slices the same on any number of threads
+    cave_STL_Data teapot;
+    if(err == CAVE_NO_ERROR) {
+        err = load_teapot(&teapot);
+    }
+    if(err == CAVE_NO_ERROR) {
+        float teapot_heights[100];
+        for(size_t l = 0; l < 100; l++) {
+            teapot_heights[l] = 0.0f + (float) l * 0.032f;
+        }
+        err = cave_STL_Data_slice(&slices, &teapot, teapot_heights, 100, 1);
+        if(err == CAVE_NO_ERROR) {
+            err = cave_STL_Data_slice(&other, &teapot, teapot_heights, 100, 3);
+        }
+        if(err == CAVE_NO_ERROR && !same_slices(&slices, &other)) {
+            err = CAVE_DATA_ERROR;
+        }
+        size_t rings = 0;
+        for(size_t l = 0; l < slices.layer_count; l++) {
+            rings += slices.layers[l].ring_count;
+        }
+        if(err == CAVE_NO_ERROR) {
+            printf("the teapot sliced into %zu rings, %zu of them open\n", rings, slices.open_rings);
+        }
+        cave_Slices_release(&slices);
+        cave_Slices_release(&other);
+        cave_STL_Data_release(&teapot);
+    }
+
+    //a finer torus, 30 mm tall, at 0.1 mm layers, closes every ring
+    if(err == CAVE_NO_ERROR) {
+        err = make_torus(&torus, 40.0f, 15.0f, 200, 100);
+    }
+    float* heights = malloc(sizeof(float) * 300);
+    if(err == CAVE_NO_ERROR && !heights) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t l = 0; l < 300 && err == CAVE_NO_ERROR; l++) {
+        heights[l] = -15.0f + 0.05f + 0.1f * (float) l;
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_slice(&slices, &torus, heights, 300, 0);
+    }
+    if(err == CAVE_NO_ERROR && slices.open_rings != 0) {
+        err = CAVE_DATA_ERROR;
+    }
+    cave_Slices_release(&slices);
+    cave_Mesh_release(&torus);
+    free(heights);
+    return err;
+}
+
+static bool same_voxels(cave_Voxels const* a, cave_Voxels const* b) {
+    for(size_t z = 0; z < a->size_z; z++) {
+        for(size_t y = 0; y < a->size_y; y++) {
+            for(size_t x = 0; x < a->size_x; x++) {
+                if(cave_Voxels_get(a, x, y, z) != cave_Voxels_get(b, x, y, z)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return cave_Voxels_count(a) == cave_Voxels_count(b);
+}
+
+static cave_3d_Triangle* mesh_triangles(cave_Mesh const* mesh) {
+    cave_3d_Triangle* tris = malloc(sizeof(cave_3d_Triangle) * (mesh->tri_count > 0 ? mesh->tri_count : 1));
+    for(size_t i = 0; tris && i < mesh->tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        tris[i] = (cave_3d_Triangle) {mesh->positions[t.a], mesh->positions[t.b], mesh->positions[t.c]};
+    }
+    return tris;
+}
+
+CaveError voxelize_meshes() {
+    //a cube from 3 to 13 on a grid of unit voxels is a shell of the voxels from 3 to 13, and filled, all of them
+    cave_Mesh cube;
+    cave_3Point positions[8];
+    cave_Index_Triangle cube_tris[12];
+    make_cube(&cube, positions, cube_tris);
+    for(size_t i = 0; i < 8; i++) {
+        positions[i] = (cave_3Point) {positions[i].x * 10 + 3, positions[i].y * 10 + 3, positions[i].z * 10 + 3};
+    }
+    cave_3d_Triangle* tris = mesh_triangles(&cube);
+    if(!tris) {
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    cave_Voxel_Options options = {{0.0f, 0.0f, 0.0f}, 1.0f, 16, 17, 18, false, false, 1};
+    cave_Voxels shell = {0}, solid = {0}, sparse = {0};
+    CaveError err = cave_voxelize(&shell, tris, 12, &options);
+    options.fill = true;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_voxelize(&solid, tris, 12, &options);
+    }
+    options.sparse = true;
+    options.threads = 3;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_voxelize(&sparse, tris, 12, &options);
+    }
+    for(size_t z = 0; z < 18 && err == CAVE_NO_ERROR; z++) {
+        for(size_t y = 0; y < 17 && err == CAVE_NO_ERROR; y++) {
+            for(size_t x = 0; x < 16 && err == CAVE_NO_ERROR; x++) {
+                bool in = x >= 3 && x <= 13 && y >= 3 && y <= 13 && z >= 3 && z <= 13;
+                bool on = in && (x == 3 || x == 13 || y == 3 || y == 13 || z == 3 || z == 13);
+                if(cave_Voxels_get(&shell, x, y, z) != on || cave_Voxels_get(&solid, x, y, z) != in) {
+                    printf("the cube's voxel (%zu, %zu, %zu) is wrong\n", x, y, z);
+                    err = CAVE_DATA_ERROR;
+                }
+            }
+        }
+    }
+    if(err == CAVE_NO_ERROR && (cave_Voxels_count(&shell) != 602 || cave_Voxels_count(&solid) != 1331
+                                || !same_voxels(&solid, &sparse) || sparse.brick_count == 0)) {
+        err = CAVE_DATA_ERROR;
+    }
+    cave_Voxels_release(&shell);
+    cave_Voxels_release(&solid);
+    cave_Voxels_release(&sparse);
+    free(tris);
+
+    //a torus is filled wherever it's well inside and empty wherever it's well outside, even cut off by the grid,
+    //the same dense or sparse and on any number of threads
+    cave_Mesh torus;
+    if(err == CAVE_NO_ERROR) {
+        err = make_torus(&torus, 3.0f, 1.0f, 96, 48);
+    } else {
+        torus = (cave_Mesh) {0};
+    }
+    tris = err == CAVE_NO_ERROR ? mesh_triangles(&torus) : NULL;
+    if(err == CAVE_NO_ERROR && !tris) {
+        err = CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    float size = 0.05f;
+    for(int clipped = 0; clipped < 2 && err == CAVE_NO_ERROR; clipped++) {
+        options = (cave_Voxel_Options) {{-4.2f, -4.2f, -1.2f}, size, 168, 168, 48, true, false, 1};
+        if(clipped) {
+            options.origin = (cave_3Point) {0.01f, -4.2f, -0.6f};
+            options.size_x = 100;
+        }
+        err = cave_voxelize(&solid, tris, torus.tri_count, &options);
+        options.sparse = true;
+        options.threads = 4;
+        if(err == CAVE_NO_ERROR) {
+            err = cave_voxelize(&sparse, tris, torus.tri_count, &options);
+        }
+        if(err == CAVE_NO_ERROR && !same_voxels(&solid, &sparse)) {
+            printf("the torus voxelized differently dense and sparse\n");
+            err = CAVE_DATA_ERROR;
+        }
+        size_t wrong = 0;
+        for(size_t z = 0; z < options.size_z && err == CAVE_NO_ERROR; z++) {
+            for(size_t y = 0; y < options.size_y; y++) {
+                for(size_t x = 0; x < options.size_x; x++) {
+                    float px = options.origin.x + size * ((float) x + 0.5f);
+                    float py = options.origin.y + size * ((float) y + 0.5f);
+                    float pz = options.origin.z + size * ((float) z + 0.5f);
+                    float ring = sqrtf(px * px + py * py) - 3.0f;
+                    float depth = sqrtf(ring * ring + pz * pz) - 1.0f;
+                    bool got = cave_Voxels_get(&solid, x, y, z);
+                    wrong += (depth < -1.5f * size && !got) || (depth > 1.5f * size && got);
+                }
+            }
+        }
+        if(err == CAVE_NO_ERROR) {
+            double volume = 2.0 * 3.141592653589793 * 3.141592653589793 * 3.0;
+            printf("voxelized the torus into %zu voxels, about %.0f inside it, %zu of %zu bricks stored\n",
+                   cave_Voxels_count(&solid), volume / (size * size * size) / (clipped ? 2.0 : 1.0),
+                   sparse.brick_count, sparse.bricks_x * sparse.bricks_y * sparse.bricks_z);
+        }
+        if(err == CAVE_NO_ERROR && wrong > 0) {
+            printf("%zu voxels were on the wrong side of the torus\n", wrong);
+            err = CAVE_DATA_ERROR;
+        }
+        cave_Voxels_release(&solid);
+        cave_Voxels_release(&sparse);
+    }
+    free(tris);
+    cave_Mesh_release(&torus);
+    return err;
+}
+
+static int compare_edges(void const* a, void const* b) {
+    uint64_t x = *(uint64_t const*) a, y = *(uint64_t const*) b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+//whether every edge of `mesh` is shared by exactly two triangles, and if so, how many edges there are
+static bool closed_manifold(cave_Mesh const* mesh, size_t* edge_count) {
+    uint64_t* edges = malloc(sizeof(uint64_t) * (mesh->tri_count * 3 + 1));
+    if(!edges) {
+        return false;
+    }
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        size_t t[3] = {mesh->tris[i].a, mesh->tris[i].b, mesh->tris[i].c};
+        for(int k = 0; k < 3; k++) {
+            uint64_t a = t[k], b = t[(k + 1) % 3];
+            edges[3 * i + k] = a < b ? a << 32 | b : b << 32 | a;
+        }
+    }
+    qsort(edges, mesh->tri_count * 3, sizeof(uint64_t), compare_edges);
+    bool closed = true;
+    *edge_count = 0;
+    for(size_t i = 0; i < mesh->tri_count * 3; i += 2) {
+        closed &= i + 1 < mesh->tri_count * 3 && edges[i] == edges[i + 1]
+                  && (i + 2 >= mesh->tri_count * 3 || edges[i + 2] != edges[i]);
+        *edge_count += 1;
+    }
+    free(edges);
+    return closed;
+}
+
+//how far the furthest vertex of `mesh` is from the surface of a torus around z
+static double torus_distance(cave_Mesh const* mesh, double major, double minor) {
+    double furthest = 0.0;
+    for(size_t i = 0; i < mesh->vert_count; i++) {
+        cave_3Point p = mesh->positions[i];
+        double ring = sqrt((double) p.x * p.x + (double) p.y * p.y) - major;
+        double distance = fabs(sqrt(ring * ring + (double) p.z * p.z) - minor);
+        furthest = distance > furthest ? distance : furthest;
+    }
+    return furthest;
+}
+
+//a torus stays a closed torus, close to the surface it was, with one fewer edge than it has vertexes and
+//triangles between them
+static CaveError check_decimated_torus(cave_Mesh const* mesh, size_t target, double tolerance, char const* what) {
+    size_t edge_count = 0;
+    bool closed = closed_manifold(mesh, &edge_count);
+    double distance = torus_distance(mesh, 3.0, 1.0);
+    printf("%s decimation left %zu triangles, at most %.4f from the torus\n", what, mesh->tri_count, distance);
+    if(mesh->tri_count > target || mesh->tri_count + 4 < target || !closed
+       || mesh->vert_count + mesh->tri_count != edge_count || distance > tolerance) {
+        printf("%s decimation didn't leave a torus\n", what);
+        return CAVE_DATA_ERROR;
+    }
+    return CAVE_NO_ERROR;
+}
+
+CaveError decimate_meshes() {
+    //a torus of 40,000 triangles, taken down to 2,000, and the same with normals weighed in
+    cave_Mesh torus = {0}, decimated = {0};
+    CaveError err = make_torus(&torus, 3.0f, 1.0f, 200, 100);
+    cave_Decimate_Options options = {2000, 0.0f, false, 0.0f, false, 1};
+    float error = 0.0f;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_decimate(&decimated, &torus, &options, &error);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = check_decimated_torus(&decimated, 2000, 0.03, "exact");
+    }
+    if(err == CAVE_NO_ERROR && (!(error > 0.0f) || error > 0.03f)) {
+        printf("the error of decimation was %f\n", error);
+        err = CAVE_DATA_ERROR;
+    }
+    cave_Mesh_release(&decimated);
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_compute_vertex_normals(&torus);
+    }
+    options.normal_weight = 0.1f;
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_decimate(&decimated, &torus, &options, NULL);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = check_decimated_torus(&decimated, 2000, 0.03, "normal weighed");
+    }
+    for(size_t i = 0; err == CAVE_NO_ERROR && i < decimated.vert_count; i++) {
+        cave_3Point p = decimated.positions[i], n = decimated.normals[i];
+        double ring = sqrt((double) p.x * p.x + (double) p.y * p.y);
+        double toward[3] = {p.x - 3.0 * p.x / ring, p.y - 3.0 * p.y / ring, p.z};
+        double len = sqrt(toward[0] * toward[0] + toward[1] * toward[1] + toward[2] * toward[2]);
+        if((toward[0] * n.x + toward[1] * n.y + toward[2] * n.z) / len < 0.95) {
+            printf("the normal at (%f, %f, %f) is off\n", p.x, p.y, p.z);
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    cave_Mesh_release(&decimated);
+    cave_Mesh_release(&torus);
+
+    //a flat grid collapses to next to nothing, losing nothing, and with its boundary preserved, keeps every
+    //vertex of it where it was
+    size_t side = 41;
+    cave_3Point grid_positions[41 * 41];
+    cave_Index_Triangle grid_tris[40 * 40 * 2];
+    for(size_t y = 0; y < side; y++) {
+        for(size_t x = 0; x < side; x++) {
+            grid_positions[y * side + x] = (cave_3Point) {(float) x, (float) y, 1.0f};
+            if(x + 1 < side && y + 1 < side) {
+                size_t a = y * side + x, i = y * (side - 1) + x;
+                grid_tris[2 * i] = (cave_Index_Triangle) {a, a + 1, a + side + 1};
+                grid_tris[2 * i + 1] = (cave_Index_Triangle) {a, a + side + 1, a + side};
+            }
+        }
+    }
+    cave_Mesh grid = {grid_positions, NULL, side * side, grid_tris, 40 * 40 * 2};
+    options = (cave_Decimate_Options) {0, 1e-4f, false, 0.0f, false, 1};
+    for(int preserve = 0; preserve < 2 && err == CAVE_NO_ERROR; preserve++) {
+        options.preserve_boundary = preserve;
+        err = cave_Mesh_decimate(&decimated, &grid, &options, &error);
+        size_t on_boundary = 0;
+        double area = 0.0;
+        for(size_t i = 0; err == CAVE_NO_ERROR && i < decimated.vert_count; i++) {
+            cave_3Point p = decimated.positions[i];
+            on_boundary += p.x == 0.0f || p.y == 0.0f || p.x == 40.0f || p.y == 40.0f;
+            if(p.z != 1.0f) {
+                err = CAVE_DATA_ERROR;
+            }
+        }
+        for(size_t i = 0; err == CAVE_NO_ERROR && i < decimated.tri_count; i++) {
+            cave_3Point a = decimated.positions[decimated.tris[i].a], b = decimated.positions[decimated.tris[i].b];
+            cave_3Point c = decimated.positions[decimated.tris[i].c];
+            area += ((double) (b.x - a.x) * (c.y - a.y) - (double) (c.x - a.x) * (b.y - a.y)) / 2;
+        }
+        printf("a flat grid decimated to %zu triangles, %zu vertexes on its boundary\n", decimated.tri_count,
+               on_boundary);
+        if(err == CAVE_NO_ERROR && (fabs(area - 1600.0) > 1e-3 || error > 1e-4f
+                                    || (preserve ? on_boundary != 160 || decimated.vert_count != 160
+                                                 : decimated.tri_count > 8))) {
+            err = CAVE_DATA_ERROR;
+        }
+        cave_Mesh_release(&decimated);
+    }
+
+    //90,000 triangles, exactly and approximately, which comes out the same on any number of threads, and can be
+    //written back out as STL
+    if(err == CAVE_NO_ERROR) {
+        err = make_torus(&torus, 3.0f, 1.0f, 300, 150);
+    }
+    options = (cave_Decimate_Options) {8000, 0.0f, false, 0.0f, false, 0};
+    for(int approximate = 0; approximate < 2 && err == CAVE_NO_ERROR; approximate++) {
+        options.approximate = approximate;
+        err = cave_Mesh_decimate(&decimated, &torus, &options, &error);
+        if(err == CAVE_NO_ERROR) {
+            err = check_decimated_torus(&decimated, 8000, 0.01, approximate ? "approximate" : "exact");
+        }
+        if(err == CAVE_NO_ERROR && approximate) {
+            cave_Mesh again = {0};
+            options.threads = 3;
+            err = cave_Mesh_decimate(&again, &torus, &options, NULL);
+            bool same = again.tri_count == decimated.tri_count && again.vert_count == decimated.vert_count;
+            same = same && memcmp(again.tris, decimated.tris, sizeof(cave_Index_Triangle) * again.tri_count) == 0;
+            same = same && memcmp(again.positions, decimated.positions, sizeof(cave_3Point) * again.vert_count) == 0;
+            if(err == CAVE_NO_ERROR && !same) {
+                printf("approximate decimation depended on the number of threads\n");
+                err = CAVE_DATA_ERROR;
+            }
+            cave_Mesh_release(&again);
+        }
+        cave_STL_Data stl = {0};
+        if(err == CAVE_NO_ERROR) {
+            err = cave_Mesh_to_STL_Data(&stl, &decimated);
+        }
+        if(err == CAVE_NO_ERROR && stl.tri_count != decimated.tri_count) {
+            err = CAVE_DATA_ERROR;
+        }
+        cave_STL_Data_release(&stl);
+        cave_Mesh_release(&decimated);
+    }
+    cave_Mesh_release(&torus);
+    return err;
+}
+
+//puts the triangles and vertexes of `mesh` in a random order
+static CaveError shuffle_mesh(cave_Mesh* mesh, unsigned seed) {
+    size_t* moved = malloc(sizeof(size_t) * mesh->vert_count);
+    cave_3Point* positions = malloc(sizeof(cave_3Point) * mesh->vert_count);
+    if(!moved || !positions) {
+        free(moved);
+        free(positions);
+        return CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    for(size_t i = 0; i < mesh->vert_count; i++) {
+        moved[i] = i;
+    }
+    for(size_t i = mesh->vert_count; i-- > 1;) {
+        seed = seed * 1103515245u + 12345u;
+        size_t j = (seed >> 8) % (i + 1), swap = moved[i];
+        moved[i] = moved[j];
+        moved[j] = swap;
+    }
+    for(size_t i = 0; i < mesh->vert_count; i++) {
+        positions[moved[i]] = mesh->positions[i];
+    }
+    for(size_t i = 0; i < mesh->tri_count; i++) {
+        cave_Index_Triangle t = mesh->tris[i];
+        mesh->tris[i] = (cave_Index_Triangle) {moved[t.a], moved[t.b], moved[t.c]};
+    }
+    for(size_t i = mesh->tri_count; i-- > 1;) {
+        seed = seed * 1103515245u + 12345u;
+        size_t j = (seed >> 8) % (i + 1);
+        cave_Index_Triangle swap = mesh->tris[i];
+        mesh->tris[i] = mesh->tris[j];
+        mesh->tris[j] = swap;
+    }
+    free(mesh->positions);
+    mesh->positions = positions;
+    free(moved);
+    return CAVE_NO_ERROR;
+}
+
+static int compare_index_triangles(void const* a, void const* b) {
+    cave_Index_Triangle const* x = a;
+    cave_Index_Triangle const* y = b;
+    if(x->a != y->a) {
+        return x->a < y->a ? -1 : 1;
+    }
+    if(x->b != y->b) {
+        return x->b < y->b ? -1 : 1;
+    }
+    return x->c < y->c ? -1 : (x->c > y->c ? 1 : 0);
+}
+
+CaveError reorder_meshes() {
+    //a shuffled torus gets most of its vertexes from the cache once its triangles are reordered, with every
+    //triangle still there as it was
+    cave_Mesh torus = {0};
+    CaveError err = make_torus(&torus, 3.0f, 1.0f, 200, 100);
+    if(err == CAVE_NO_ERROR) {
+        err = shuffle_mesh(&torus, 7);
+    }
+    cave_Index_Triangle* before = NULL;
+    cave_Index_Triangle* after = NULL;
+    if(err == CAVE_NO_ERROR) {
+        before = malloc(sizeof(cave_Index_Triangle) * torus.tri_count);
+        after = malloc(sizeof(cave_Index_Triangle) * torus.tri_count);
+        err = before && after ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    cave_Vertex_Cache_Stats shuffled = {0}, ordered = {0}, larger = {0};
+    if(err == CAVE_NO_ERROR) {
+        memcpy(before, torus.tris, sizeof(cave_Index_Triangle) * torus.tri_count);
+        err = cave_Mesh_vertex_cache_stats(&shuffled, &torus, 16);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_optimize_vertex_cache(&torus, 0);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_vertex_cache_stats(&ordered, &torus, 16);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_vertex_cache_stats(&larger, &torus, 32);
+    }
+    if(err == CAVE_NO_ERROR) {
+        printf("reordering took the ACMR from %.3f to %.3f, %.3f with 32 entries, and the ATVR from %.3f to %.3f\n",
+               shuffled.acmr, ordered.acmr, larger.acmr, shuffled.atvr, ordered.atvr);
+        memcpy(after, torus.tris, sizeof(cave_Index_Triangle) * torus.tri_count);
+        qsort(before, torus.tri_count, sizeof(cave_Index_Triangle), compare_index_triangles);
+        qsort(after, torus.tri_count, sizeof(cave_Index_Triangle), compare_index_triangles);
+        if(shuffled.acmr < 2.5f || ordered.acmr > 0.8f || larger.acmr > ordered.acmr || ordered.atvr > 1.6f
+           || memcmp(before, after, sizeof(cave_Index_Triangle) * torus.tri_count) != 0) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+
+    //and once its vertexes are renumbered, the triangles use them in order, with the same positions as before
+    size_t* remap = NULL;
+    cave_3Point* positions = NULL;
+    cave_Vertex_Cache_Stats fetched = {0};
+    if(err == CAVE_NO_ERROR) {
+        remap = malloc(sizeof(size_t) * torus.vert_count);
+        positions = malloc(sizeof(cave_3Point) * torus.vert_count);
+        err = remap && positions ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(err == CAVE_NO_ERROR) {
+        memcpy(positions, torus.positions, sizeof(cave_3Point) * torus.vert_count);
+        memcpy(before, torus.tris, sizeof(cave_Index_Triangle) * torus.tri_count);
+        err = cave_Mesh_optimize_vertex_fetch(&torus, remap);
+    }
+    if(err == CAVE_NO_ERROR) {
+        err = cave_Mesh_vertex_cache_stats(&fetched, &torus, 16);
+    }
+    if(err == CAVE_NO_ERROR) {
+        printf("renumbering vertexes took the overfetch from %.3f to %.3f\n", ordered.overfetch, fetched.overfetch);
+        size_t next = 0;
+        for(size_t i = 0; i < torus.tri_count && err == CAVE_NO_ERROR; i++) {
+            size_t corners[3] = {torus.tris[i].a, torus.tris[i].b, torus.tris[i].c};
+            size_t old[3] = {before[i].a, before[i].b, before[i].c};
+            for(int k = 0; k < 3; k++) {
+                if(corners[k] > next || corners[k] != remap[old[k]]
+                   || memcmp(torus.positions + corners[k], positions + old[k], sizeof(cave_3Point)) != 0) {
+                    err = CAVE_DATA_ERROR;
+                }
+                next += corners[k] == next;
+            }
+        }
+        if(fetched.misses != ordered.misses || fetched.overfetch > 1.5f || fetched.overfetch >= ordered.overfetch) {
+            err = CAVE_DATA_ERROR;
+        }
+    }
+    free(before);
+    free(after);
+    free(remap);
+    free(positions);
+    if(err == CAVE_NO_ERROR && (cave_Mesh_optimize_vertex_cache(&torus, 2) != CAVE_DATA_ERROR
+                                || cave_Mesh_vertex_cache_stats(&fetched, &torus, 0) != CAVE_DATA_ERROR)) {
+        err = CAVE_DATA_ERROR;
+    }
+    cave_Mesh_release(&torus);
+
+    //a shuffled fan, where every triangle shares the middle vertex, is reordered around its rim
+    size_t fan_tris = 10000;
+    cave_Mesh fan = {0};
+    cave_Index_Triangle* fan_before = NULL;
+    cave_Index_Triangle* fan_after = NULL;
+    if(err == CAVE_NO_ERROR) {
+        fan.vert_count = fan_tris + 2;
+        fan.tri_count = fan_tris;
+        fan.positions = malloc(sizeof(cave_3Point) * fan.vert_count);
+        fan.tris = malloc(sizeof(cave_Index_Triangle) * fan.tri_count);
+        fan_before = malloc(sizeof(cave_Index_Triangle) * fan.tri_count);
+        fan_after = malloc(sizeof(cave_Index_Triangle) * fan.tri_count);
+        err = fan.positions && fan.tris && fan_before && fan_after ? CAVE_NO_ERROR : CAVE_INSUFFICIENT_MEMORY_ERROR;
+    }
+    if(err == CAVE_NO_ERROR) {
+        fan.positions[0] = (cave_3Point) {0.0f, 0.0f, 0.0f};
+        for(size_t i = 1; i < fan.vert_count; i++) {
+            float angle = 6.2831853f * (float) i / (float) fan.vert_count;
+            fan.positions[i] = (cave_3Point) {cosf(angle), sinf(angle), 0.0f};
+        }
+        for(size_t i = 0; i < fan_tris; i++) {
+            fan.tris[i] = (cave_Index_Triangle) {0, i + 1, i + 2};
+        }
+        err = shuffle_mesh(&fan, 13);
+    }
+    if(err == CAVE_NO_ERROR) {
+        memcpy(fan_before, fan.tris, sizeof(cave_Index_Triangle) * fan.tri_count);
+        err = cave_Mesh_optimize_vertex_cache(&fan, 0);
+        if(err == CAVE_NO_ERROR) {
+            err = cave_Mesh_vertex_cache_stats(&fetched, &fan, 16);
+        }
+        if(err == CAVE_NO_ERROR) {
+            qsort(fan_before, fan.tri_count, sizeof(cave_Index_Triangle), compare_index_triangles);
+            memcpy(fan_after, fan.tris, sizeof(cave_Index_Triangle) * fan.tri_count);
+            qsort(fan_after, fan.tri_count, sizeof(cave_Index_Triangle), compare_index_triangles);
+            if(fetched.acmr > 1.1f || memcmp(fan_before, fan_after, sizeof(cave_Index_Triangle) * fan.tri_count) != 0) {
+                err = CAVE_DATA_ERROR;
+            }
+        }
+    }
+    free(fan_before);
+    free(fan_after);
+    cave_Mesh_release(&fan);
+    return err;
+}
+
 int main(int argc, char* argv[]) {
     int test_fails = 0;
 //    if(0 == read_and_write_STL()) {
@@ -96,5 +2380,24 @@ int main(int argc, char* argv[]) {
 //        test_fails += 1;
 //    }
     RUN_TEST(read_and_write_STL, test_fails);
+    RUN_TEST(lz_round_trip, test_fails);
+    RUN_TEST(cmsh_round_trip, test_fails);
+    RUN_TEST(cmsh_large_grid_round_trip, test_fails);
+    RUN_TEST(cmsh_hostile_streams, test_fails);
+    RUN_TEST(hash64_known_values, test_fails);
+    RUN_TEST(mesh_cache_hits_and_evicts, test_fails);
+    RUN_TEST(pipelined_STL_load, test_fails);
+    RUN_TEST(append_STL_in_batches, test_fails);
+    RUN_TEST(merge_STL_files, test_fails);
+    RUN_TEST(vector_math_kernels, test_fails);
+    RUN_TEST(cpu_dispatch, test_fails);
+    RUN_TEST(repair_normals, test_fails);
+    RUN_TEST(measure_STL, test_fails);
+    RUN_TEST(bvh_queries, test_fails);
+    RUN_TEST(grid_queries, test_fails);
+    RUN_TEST(slice_meshes, test_fails);
+    RUN_TEST(voxelize_meshes, test_fails);
+    RUN_TEST(decimate_meshes, test_fails);
+    RUN_TEST(reorder_meshes, test_fails);
     return test_fails;
 }
\ No newline at end of file
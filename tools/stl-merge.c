@@ -0,0 +1,86 @@
+//
+// Created by David Sullivan on 10/19/26.
+//
+
+#include "cave-writer.h"
+#include "cave-error.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//Merges binary STL files into one.
+//Usage: CAVE_STL_MERGE output.stl [-t dx dy dz] input.stl [[-t dx dy dz] input.stl ...]
+//`-t` translates the input that follows it. Inputs without `-t` are copied verbatim.
+
+static void print_usage(char const* name) {
+    fprintf(stderr, "usage: %s output.stl [-t dx dy dz] input.stl [[-t dx dy dz] input.stl ...]\n", name);
+}
+
+//reads all of `text` as a number, refusing anything with something else after it.
+static bool parse_float(char const* text, float* value) {
+    char* end;
+    *value = strtof(text, &end);
+    return end != text && *end == '\0';
+}
+
+int main(int argc, char* argv[]) {
+    if(argc < 3) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    //there are at most as many inputs and transforms as arguments
+    char const** inputs = malloc(sizeof(char const*) * argc);
+    cave_STL_Transform* transforms = malloc(sizeof(cave_STL_Transform) * argc);
+    cave_STL_Transform const** transform_ptrs = malloc(sizeof(cave_STL_Transform const*) * argc);
+    int status = 0;
+    if(!inputs || !transforms || !transform_ptrs) {
+        fprintf(stderr, "not enough memory\n");
+        status = 1;
+    }
+
+    size_t input_count = 0;
+    bool any_transform = false;
+    cave_STL_Transform const* pending = NULL;
+    for(int i = 2; i < argc && status == 0; i++) {
+        if(strcmp(argv[i], "-t") == 0) {
+            cave_STL_Transform* t = transforms + input_count;
+            memset(t, 0, sizeof(cave_STL_Transform));
+            t->m[0] = 1.0f;
+            t->m[5] = 1.0f;
+            t->m[10] = 1.0f;
+            if(i + 3 >= argc || !parse_float(argv[i + 1], t->m + 3) || !parse_float(argv[i + 2], t->m + 7) ||
+               !parse_float(argv[i + 3], t->m + 11)) {
+                print_usage(argv[0]);
+                status = 1;
+                break;
+            }
+            pending = t;
+            any_transform = true;
+            i += 3;
+        } else {
+            inputs[input_count] = argv[i];
+            transform_ptrs[input_count] = pending;
+            input_count += 1;
+            pending = NULL;
+        }
+    }
+    if(status == 0 && (input_count == 0 || pending)) {
+        print_usage(argv[0]);
+        status = 1;
+    }
+
+    if(status == 0) {
+        CaveError err = cave_STL_merge_files(argv[1], inputs, input_count, any_transform ? transform_ptrs : NULL,
+                                             NULL);
+        if(err != CAVE_NO_ERROR) {
+            fprintf(stderr, "merging failed: %s\n", cave_error_string(err));
+            status = 1;
+        }
+    }
+
+    free(inputs);
+    free(transforms);
+    free(transform_ptrs);
+    return status;
+}